@@ -218,6 +218,25 @@ public:
   itkSetMacro(EncodeParameters, bool);
   itkGetConstMacro(EncodeParameters, bool);
 
+  /**
+  * \brief Cache for the intensity ranges that is passed to the quantifier.
+  *
+  * Set the same cache for all feature classes that are calculated for one image
+  * and mask, so that the ranges are calculated only once (see mitk::IntensityRangeCache).
+  */
+  itkSetMacro(RangeCache, IntensityRangeCache::Pointer);
+  itkGetConstMacro(RangeCache, IntensityRangeCache::Pointer);
+
+  /**
+  * \brief Cache for quantised images and neighbourhoods that texture feature classes can use instead of
+  * quantising the image themselves.
+  *
+  * Set the same cache for all feature classes that are calculated for one image and mask
+  * (see mitk::QuantizedImageCache). Without a cache, each class does its own pass.
+  */
+  itkSetMacro(QuantizedImageCache, QuantizedImageCache::Pointer);
+  itkGetConstMacro(QuantizedImageCache, QuantizedImageCache::Pointer);
+
   std::string GetOptionPrefix() const
   {
     if (m_Prefix.length() > 0)
@@ -281,6 +300,8 @@ private:
   bool m_IgnoreMask = false;
 
   mitk::Image::Pointer m_MorphMask = nullptr;
+  IntensityRangeCache::Pointer m_RangeCache = nullptr;
+  QuantizedImageCache::Pointer m_QuantizedImageCache = nullptr;
 //#endif // Skip Doxygen
 
 };
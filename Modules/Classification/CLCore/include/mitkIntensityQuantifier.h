@@ -23,8 +23,116 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkBaseData.h>
 #include <mitkImage.h>
 
+#include <mutex>
+#include <vector>
+
 namespace mitk
 {
+/**
+* \brief Shares the intensity ranges of images and masked image regions between quantifiers.
+*
+* Initializing a quantifier from an image needs a pass over the whole image. If
+* several feature classes are calculated for the same image and mask, they can
+* share one cache so that every range is calculated only once. The cache can
+* be used from several threads.
+*/
+class MITKCLCORE_EXPORT IntensityRangeCache : public itk::Object
+{
+public:
+  mitkClassMacroItkParent(IntensityRangeCache, itk::Object)
+    itkFactorylessNewMacro(Self)
+
+  /** \brief Minimum and maximum intensity of the whole image. */
+  void GetImageRange(const mitk::Image::Pointer &image, double &minimum, double &maximum);
+  /** \brief Minimum and maximum intensity of the image inside the mask. */
+  void GetImageRegionRange(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask, double &minimum, double &maximum);
+
+  void Clear();
+
+private:
+  struct Range
+  {
+    mitk::Image::Pointer Image;
+    mitk::Image::Pointer Mask;
+    itk::ModifiedTimeType ImageMTime;
+    itk::ModifiedTimeType MaskMTime;
+    double Minimum;
+    double Maximum;
+  };
+
+  std::mutex m_Mutex;
+  std::vector<Range> m_Ranges;
+};
+
+/**
+* \brief Shares quantised images and the radius 1 neighbourhoods of their voxels between feature classes.
+*
+* Texture feature classes map every voxel to the bin floor((intensity - minimum) / binsize) of
+* their quantisation, usually several times per voxel while walking the neighbourhoods. If the
+* classes are calculated for the same image and mask, they can share one cache so that each
+* quantisation and each neighbourhood pass is done only once. The cache can be used from several
+* threads; an entry that is requested by several threads at the same time is calculated once.
+*/
+class MITKCLCORE_EXPORT QuantizedImageCache : public itk::Object
+{
+public:
+  mitkClassMacroItkParent(QuantizedImageCache, itk::Object)
+    itkFactorylessNewMacro(Self)
+
+  /** \brief Bin index of voxels with the intensity NaN. No other voxel has this index. */
+  static const int NaNIndex;
+
+  /**
+  * \brief Image of the pixel type int with the bin index floor((intensity - minimum) / binsize) of every voxel.
+  *
+  * The index is not clamped to the number of bins, voxels with intensities outside of the range get
+  * indices below 0 or above the last bin.
+  */
+  mitk::Image::Pointer GetQuantizedImage(const mitk::Image::Pointer &image, double minimum, double binsize);
+
+  /**
+  * \brief Radius 1 neighbourhoods of all voxels inside the mask, as images of the pixel type unsigned int.
+  *
+  * Bit k of a voxel stands for the k-th offset of an itk::Neighborhood with radius 1, skipping the center.
+  * In maskedNeighbours, the bit is set if the neighbour is inside the image and the mask and its intensity
+  * is not NaN. In equalNeighbours, it is additionally required that the neighbour has the same bin index
+  * (see GetQuantizedImage()). Both are 0 for voxels outside of the mask and for voxels with the intensity NaN.
+  */
+  void GetNeighbourhoods(const mitk::Image::Pointer &image,
+                         const mitk::Image::Pointer &mask,
+                         double minimum,
+                         double binsize,
+                         mitk::Image::Pointer &maskedNeighbours,
+                         mitk::Image::Pointer &equalNeighbours);
+
+  void Clear();
+
+private:
+  struct QuantizedImage
+  {
+    mitk::Image::Pointer Image;
+    itk::ModifiedTimeType ImageMTime;
+    double Minimum;
+    double Binsize;
+    mitk::Image::Pointer Quantized;
+  };
+
+  struct Neighbourhoods
+  {
+    mitk::Image::Pointer Quantized;
+    mitk::Image::Pointer Mask;
+    itk::ModifiedTimeType MaskMTime;
+    mitk::Image::Pointer MaskedNeighbours;
+    mitk::Image::Pointer EqualNeighbours;
+  };
+
+  mitk::Image::Pointer GetQuantizedImageUnlocked(const mitk::Image::Pointer &image, double minimum, double binsize);
+
+  std::mutex m_Mutex;
+  std::vector<QuantizedImage> m_QuantizedImages;
+  std::vector<Neighbourhoods> m_Neighbourhoods;
+};
+
 class MITKCLCORE_EXPORT IntensityQuantifier : public BaseData
 {
 public:
@@ -61,6 +169,10 @@ public:
   itkGetConstMacro(Minimum, double);
   itkGetConstMacro(Maximum, double);
 
+  /** \brief If set, the ranges of images and masks are taken from this cache. */
+  itkSetMacro(RangeCache, IntensityRangeCache::Pointer);
+  itkGetConstMacro(RangeCache, IntensityRangeCache::Pointer);
+
 public:
 
 //#ifndef DOXYGEN_SKIP
@@ -83,6 +195,10 @@ public:
 
 
 private:
+  void GetImageRange(const mitk::Image::Pointer &image, double &minimum, double &maximum);
+  void GetImageRegionRange(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask, double &minimum, double &maximum);
+
+  IntensityRangeCache::Pointer m_RangeCache;
   bool m_Initialized;
   unsigned int m_Bins;
   double m_Binsize;
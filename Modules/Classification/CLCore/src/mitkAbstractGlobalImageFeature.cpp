@@ -234,6 +234,7 @@ void  mitk::AbstractGlobalImageFeature::InitializeQuantifier(const Image::Pointe
   MITK_INFO << GetUseMinimumIntensity() << " " << GetUseMaximumIntensity() << " " << GetUseBins() << " " << GetUseBinsize();
 
   m_Quantifier = IntensityQuantifier::New();
+  m_Quantifier->SetRangeCache(m_RangeCache);
   if (GetUseMinimumIntensity() && GetUseMaximumIntensity() && GetUseBinsize())
     m_Quantifier->InitializeByBinsizeAndMaximum(GetMinimumIntensity(), GetMaximumIntensity(), GetBinsize());
   else if (GetUseMinimumIntensity() && GetUseBins() && GetUseBinsize())
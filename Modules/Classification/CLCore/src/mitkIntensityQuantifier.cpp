@@ -17,12 +17,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIntensityQuantifier.h>
 
 // STD
+#include <cmath>
+#include <limits>
 #include <numeric>
 
 // ITK
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+#include <itkNeighborhood.h>
 
 // MITK
+#include <mitkITKImageImport.h>
 #include <mitkImageCast.h>
 #include <mitkImageAccessByItk.h>
 
@@ -73,6 +79,192 @@ CalculateImageRegionMinMax(itk::Image<TPixel, VImageDimension>* itkImage, mitk::
   }
 }
 
+template<typename TPixel, unsigned int VImageDimension>
+static void
+QuantizeImage(itk::Image<TPixel, VImageDimension>* itkImage, double minimum, double binsize, mitk::Image::Pointer &output)
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<int, VImageDimension> IndexImageType;
+
+  typename IndexImageType::Pointer indexImage = IndexImageType::New();
+  indexImage->CopyInformation(itkImage);
+  indexImage->SetRegions(itkImage->GetLargestPossibleRegion());
+  indexImage->Allocate();
+
+  itk::ImageRegionConstIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<IndexImageType> indexIter(indexImage, indexImage->GetLargestPossibleRegion());
+
+  while (!iter.IsAtEnd())
+  {
+    // the same calculation as in the matrix holders of the feature classes, so that the indices are identical
+    double intensity = iter.Get();
+    if (intensity != intensity)
+      indexIter.Set(mitk::QuantizedImageCache::NaNIndex);
+    else
+      indexIter.Set(static_cast<int>(std::floor((intensity - minimum) / binsize)));
+    ++iter;
+    ++indexIter;
+  }
+
+  output = mitk::GrabItkImageMemory(indexImage);
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+CalculateNeighbourhoods(itk::Image<TPixel, VImageDimension>* quantized, mitk::Image::Pointer mask,
+                        mitk::Image::Pointer &maskedNeighbours, mitk::Image::Pointer &equalNeighbours)
+{
+  typedef itk::Image<TPixel, VImageDimension> IndexImageType;
+  typedef itk::Image<unsigned short, VImageDimension> MaskType;
+  typedef itk::Image<unsigned int, VImageDimension> NeighbourhoodImageType;
+
+  typename MaskType::Pointer itkMask = MaskType::New();
+  mitk::CastToItkImage(mask, itkMask);
+
+  // the 3^VImageDimension - 1 neighbours have to fit into the bits of one unsigned int
+  itk::Neighborhood<TPixel, VImageDimension> hood;
+  hood.SetRadius(1);
+  std::vector<itk::Offset<VImageDimension> > offsets;
+  for (unsigned int k = 0; k < hood.Size(); ++k)
+  {
+    if (k != hood.GetCenterNeighborhoodIndex())
+      offsets.push_back(hood.GetOffset(k));
+  }
+
+  const typename IndexImageType::RegionType region = quantized->GetLargestPossibleRegion();
+
+  typename NeighbourhoodImageType::Pointer masked = NeighbourhoodImageType::New();
+  masked->CopyInformation(quantized);
+  masked->SetRegions(region);
+  masked->Allocate();
+  masked->FillBuffer(0);
+  typename NeighbourhoodImageType::Pointer equal = NeighbourhoodImageType::New();
+  equal->CopyInformation(quantized);
+  equal->SetRegions(region);
+  equal->Allocate();
+  equal->FillBuffer(0);
+
+  itk::ImageRegionConstIteratorWithIndex<IndexImageType> iter(quantized, region);
+  while (!iter.IsAtEnd())
+  {
+    const typename IndexImageType::IndexType index = iter.GetIndex();
+    const TPixel center = iter.Get();
+    if (center != mitk::QuantizedImageCache::NaNIndex && itkMask->GetPixel(index) > 0)
+    {
+      unsigned int maskedBits = 0;
+      unsigned int equalBits = 0;
+      for (unsigned int k = 0; k < offsets.size(); ++k)
+      {
+        const typename IndexImageType::IndexType neighbour = index + offsets[k];
+        if (!region.IsInside(neighbour) || itkMask->GetPixel(neighbour) < 1)
+          continue;
+        const TPixel value = quantized->GetPixel(neighbour);
+        if (value == mitk::QuantizedImageCache::NaNIndex)
+          continue;
+        maskedBits |= 1u << k;
+        if (value == center)
+          equalBits |= 1u << k;
+      }
+      masked->SetPixel(index, maskedBits);
+      equal->SetPixel(index, equalBits);
+    }
+    ++iter;
+  }
+
+  maskedNeighbours = mitk::GrabItkImageMemory(masked);
+  equalNeighbours = mitk::GrabItkImageMemory(equal);
+}
+
+void mitk::IntensityRangeCache::GetImageRange(const mitk::Image::Pointer &image, double &minimum, double &maximum)
+{
+  GetImageRegionRange(image, nullptr, minimum, maximum);
+}
+
+void mitk::IntensityRangeCache::GetImageRegionRange(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask, double &minimum, double &maximum)
+{
+  // The lock is held during the calculation, so that a range requested by
+  // several threads at the same time is calculated only once.
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  itk::ModifiedTimeType maskMTime = mask.IsNotNull() ? mask->GetMTime() : 0;
+  for (const auto &range : m_Ranges)
+  {
+    if (range.Image == image && range.Mask == mask && range.ImageMTime == image->GetMTime() && range.MaskMTime == maskMTime)
+    {
+      minimum = range.Minimum;
+      maximum = range.Maximum;
+      return;
+    }
+  }
+
+  if (mask.IsNull())
+  {
+    AccessByItk_2(image, CalculateImageMinMax, minimum, maximum);
+  }
+  else
+  {
+    AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, maximum);
+  }
+  m_Ranges.push_back({ image, mask, image->GetMTime(), maskMTime, minimum, maximum });
+}
+
+void mitk::IntensityRangeCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Ranges.clear();
+}
+
+const int mitk::QuantizedImageCache::NaNIndex = std::numeric_limits<int>::min();
+
+mitk::Image::Pointer mitk::QuantizedImageCache::GetQuantizedImage(const mitk::Image::Pointer &image, double minimum, double binsize)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return GetQuantizedImageUnlocked(image, minimum, binsize);
+}
+
+mitk::Image::Pointer mitk::QuantizedImageCache::GetQuantizedImageUnlocked(const mitk::Image::Pointer &image, double minimum, double binsize)
+{
+  for (const auto &entry : m_QuantizedImages)
+  {
+    if (entry.Image == image && entry.ImageMTime == image->GetMTime() && entry.Minimum == minimum && entry.Binsize == binsize)
+      return entry.Quantized;
+  }
+
+  mitk::Image::Pointer quantized;
+  AccessByItk_3(image, QuantizeImage, minimum, binsize, quantized);
+  m_QuantizedImages.push_back({ image, image->GetMTime(), minimum, binsize, quantized });
+  return quantized;
+}
+
+void mitk::QuantizedImageCache::GetNeighbourhoods(const mitk::Image::Pointer &image,
+                                                  const mitk::Image::Pointer &mask,
+                                                  double minimum,
+                                                  double binsize,
+                                                  mitk::Image::Pointer &maskedNeighbours,
+                                                  mitk::Image::Pointer &equalNeighbours)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  mitk::Image::Pointer quantized = GetQuantizedImageUnlocked(image, minimum, binsize);
+  for (const auto &entry : m_Neighbourhoods)
+  {
+    if (entry.Quantized == quantized && entry.Mask == mask && entry.MaskMTime == mask->GetMTime())
+    {
+      maskedNeighbours = entry.MaskedNeighbours;
+      equalNeighbours = entry.EqualNeighbours;
+      return;
+    }
+  }
+
+  AccessFixedPixelTypeByItk_n(quantized, CalculateNeighbourhoods, (int), (mask, maskedNeighbours, equalNeighbours));
+  m_Neighbourhoods.push_back({ quantized, mask, mask->GetMTime(), maskedNeighbours, equalNeighbours });
+}
+
+void mitk::QuantizedImageCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_QuantizedImages.clear();
+  m_Neighbourhoods.clear();
+}
+
 mitk::IntensityQuantifier::IntensityQuantifier() :
       m_Initialized(false),
       m_Bins(0),
@@ -107,76 +299,96 @@ void mitk::IntensityQuantifier::InitializeByBinsizeAndMaximum(double minimum, do
 
 void mitk::IntensityQuantifier::InitializeByImage(mitk::Image::Pointer image, unsigned int bins) {
   double minimum, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, maximum);
+  GetImageRange(image, minimum, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndMinimum(mitk::Image::Pointer image, double minimum, unsigned int bins) {
   double tmp, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, tmp, maximum);
+  GetImageRange(image, tmp, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndMaximum(mitk::Image::Pointer image, double maximum, unsigned int bins) {
   double minimum, tmp;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, tmp);
+  GetImageRange(image, minimum, tmp);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegion(mitk::Image::Pointer image, mitk::Image::Pointer mask, unsigned int bins) {
   double minimum, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, maximum);
+  GetImageRegionRange(image, mask, minimum, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndMinimum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double minimum, unsigned int bins) {
   double tmp, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, tmp, maximum);
+  GetImageRegionRange(image, mask, tmp, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndMaximum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double maximum, unsigned int bins) {
   double minimum, tmp;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, tmp);
+  GetImageRegionRange(image, mask, minimum, tmp);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndBinsize(mitk::Image::Pointer image, double binsize) {
   double minimum, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, maximum);
+  GetImageRange(image, minimum, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndBinsizeAndMinimum(mitk::Image::Pointer image, double minimum, double binsize) {
   double tmp, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, tmp, maximum);
+  GetImageRange(image, tmp, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndBinsizeAndMaximum(mitk::Image::Pointer image, double maximum, double binsize) {
   double minimum, tmp;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, tmp);
+  GetImageRange(image, minimum, tmp);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndBinsize(mitk::Image::Pointer image, mitk::Image::Pointer mask, double binsize) {
   double minimum, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, maximum);
+  GetImageRegionRange(image, mask, minimum, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndBinsizeAndMinimum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double minimum, double binsize) {
   double tmp, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, tmp, maximum);
+  GetImageRegionRange(image, mask, tmp, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndBinsizeAndMaximum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double maximum, double binsize) {
   double minimum, tmp;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, tmp);
+  GetImageRegionRange(image, mask, minimum, tmp);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
+void mitk::IntensityQuantifier::GetImageRange(const mitk::Image::Pointer &image, double &minimum, double &maximum)
+{
+  if (m_RangeCache.IsNotNull())
+  {
+    m_RangeCache->GetImageRange(image, minimum, maximum);
+    return;
+  }
+  AccessByItk_2(image, CalculateImageMinMax, minimum, maximum);
+}
+
+void mitk::IntensityQuantifier::GetImageRegionRange(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask, double &minimum, double &maximum)
+{
+  if (m_RangeCache.IsNotNull())
+  {
+    m_RangeCache->GetImageRegionRange(image, mask, minimum, maximum);
+    return;
+  }
+  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, maximum);
+}
+
 unsigned int mitk::IntensityQuantifier::IntensityToIndex(double intensity)
 {
   double index = std::floor((intensity - m_Minimum) / m_Binsize);
@@ -41,6 +41,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkGIFIntensityVolumeHistogramFeatures.h>
 #include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
 #include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+#include <mitkGlobalImageFeatureEngine.h>
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkITKImageImport.h>
@@ -415,6 +416,8 @@ int main(int argc, char* argv[])
   parser.addArgument("direction", "dir", mitkCommandLineParser::String, "Int", "Allows to specify the direction for Cooc and RL. 0: All directions, 1: Only single direction (Test purpose), 2,3,4... Without dimension 0,1,2... ", us::Any());
   parser.addArgument("slice-wise", "slice", mitkCommandLineParser::String, "Int", "Allows to specify if the image is processed slice-wise (number giving direction) ", us::Any());
   parser.addArgument("output-mode", "omode", mitkCommandLineParser::Int, "Int", "Defines if the results of an image / slice are written in a single row (0 , default) or column (1).");
+  parser.addArgument("threads", "threads", mitkCommandLineParser::Int, "Int", "Number of feature classes that are calculated in parallel (Default: number of cores)", us::Any());
+  parser.addArgument("crop-to-mask", "crop", mitkCommandLineParser::Bool, "Bool", "Crops the image to the bounding box of the mask before calculating the features. Faster for small masks, but changes image description features, quantisations that use the image range and neighbourhood features that reach beyond the mask.", us::Any());
 
   // Miniapp Infos
   parser.setCategory("Classification Tools");
@@ -600,6 +603,20 @@ int main(int argc, char* argv[])
     cFeature->SetEncodeParameters(param.encodeParameter);
   }
 
+  mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+  for (auto cFeature : features)
+  {
+    engine->AddFeatureClass(cFeature);
+  }
+  if (parsedArgs.count("threads"))
+  {
+    engine->SetNumberOfThreads(us::any_cast<int>(parsedArgs["threads"]));
+  }
+  if (parsedArgs.count("crop-to-mask"))
+  {
+    engine->SetCropToMask(us::any_cast<bool>(parsedArgs["crop-to-mask"]));
+  }
+
   bool addDescription = parsedArgs.count("description");
   mitk::cl::FeatureResultWritter writer(param.outputPath, writeDirection);
 
@@ -666,11 +683,11 @@ int main(int argc, char* argv[])
 
     mitk::AbstractGlobalImageFeature::FeatureListType stats;
 
-    for (auto cFeature : features)
+    engine->SetMorphMask(cMorphMask);
+    engine->CalculateFeaturesUsingParameters(cImage, cMask, cMaskNoNaN, stats);
+    for (auto timing : engine->GetTimings())
     {
-      log << " Calculating " << cFeature->GetFeatureClassName() << " -";
-      cFeature->SetMorphMask(cMorphMask);
-      cFeature->CalculateFeaturesUsingParameters(cImage, cMask, cMaskNoNaN, stats);
+      log << " Calculated " << timing.first << " in " << timing.second << " s -";
     }
 
     for (std::size_t i = 0; i < stats.size(); ++i)
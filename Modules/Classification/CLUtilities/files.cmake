@@ -27,6 +27,7 @@ set(CPP_FILES
   GlobalImageFeatures/mitkGIFIntensityVolumeHistogramFeatures.cpp
   GlobalImageFeatures/mitkGIFNeighbourhoodGreyToneDifferenceFeatures.cpp
   GlobalImageFeatures/mitkGIFCurvatureStatistic.cpp
+  GlobalImageFeatures/mitkGlobalImageFeatureEngine.cpp
 
   MiniAppUtils/mitkGlobalImageFeaturesParameter.cpp
   MiniAppUtils/mitkSplitParameterToVector.cpp
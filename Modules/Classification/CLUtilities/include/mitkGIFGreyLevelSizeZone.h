@@ -108,6 +108,10 @@ namespace mitk
       double MaximumIntensity;
       int Bins;
       std::string prefix;
+
+      // From the shared QuantizedImageCache, null if the zones are searched on the image itself
+      mitk::Image::Pointer QuantizedImage;
+      mitk::Image::Pointer EqualNeighbours;
     };
   };
 
@@ -141,6 +141,11 @@ namespace mitk
       double MaximumIntensity;
       int Bins;
       std::string FeatureEncoding;
+
+      // From the shared QuantizedImageCache, null if the neighbourhoods are walked on the image itself
+      mitk::Image::Pointer QuantizedImage;
+      mitk::Image::Pointer MaskedNeighbours;
+      mitk::Image::Pointer EqualNeighbours;
     };
 
     private:
@@ -0,0 +1,137 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkGlobalImageFeatureEngine_h
+#define mitkGlobalImageFeatureEngine_h
+
+#include <mitkAbstractGlobalImageFeature.h>
+#include <mitkIntensityQuantifier.h>
+#include <MitkCLUtilitiesExports.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Calculates several global image feature classes for one image and mask.
+  *
+  * The engine prepares the input once for all feature classes that were added:
+  * - On request, the image and the masks are cropped to the bounding box of the mask (see SetCropToMask()).
+  * - The masks are converted to unsigned short, the type that most feature classes
+  *   cast the mask to. The casts inside the feature classes then do not copy the mask.
+  * - All feature classes share one mitk::IntensityRangeCache, so the intensity range
+  *   of the image and of the masked region is calculated only once.
+  * - All feature classes share one mitk::QuantizedImageCache. Texture feature classes with the
+  *   same quantisation (e.g. mitk::GIFNeighbouringGreyLevelDependenceFeature and mitk::GIFGreyLevelSizeZone)
+  *   use one quantised image and one pass over the radius 1 neighbourhoods instead of one each.
+  *   The quantisation settings are only known inside the classes, so an entry is calculated
+  *   by the first class that needs it.
+  *
+  * The feature classes are then calculated in parallel, each class by one thread.
+  * The results are returned in the order in which the classes were added, so they
+  * are identical to calculating the classes one after the other. The time spent on
+  * each class is available with GetTimings() after the calculation.
+  */
+  class MITKCLUTILITIES_EXPORT GlobalImageFeatureEngine : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(GlobalImageFeatureEngine, itk::Object)
+      itkFactorylessNewMacro(Self)
+
+    typedef AbstractGlobalImageFeature::FeatureListType FeatureListType;
+    typedef std::vector<AbstractGlobalImageFeature::Pointer> FeatureClassListType;
+    typedef std::vector<std::pair<std::string, double> > TimingListType;
+
+    void AddFeatureClass(AbstractGlobalImageFeature *featureClass);
+    const FeatureClassListType &GetFeatureClasses() const { return m_FeatureClasses; }
+
+    /** \brief Maximum number of feature classes that are calculated at the same time. Defaults to the number of cores. */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+    * \brief Crop the image and the masks to the bounding box of the mask before calculating the features.
+    *
+    * Reduces the memory traffic for small masks in large images. Default is false, because the
+    * results of several feature classes change with the cropped image:
+    * - features that describe the whole image, e.g. the image dimensions of mitk::GIFImageDescriptionFeatures,
+    * - quantisations that take their range from the image (mitk::IntensityQuantifier::InitializeByImageAndBinsize()),
+    *   e.g. mitk::GIFFirstOrderStatistics without a fixed minimum and maximum,
+    * - neighbourhoods that reach further than the crop margin, e.g. the 6.2 mm
+    *   neighbourhood of mitk::GIFLocalIntensity.
+    * Only enable it if the results of all added feature classes do not depend on voxels outside
+    * the mask and the margin, e.g. texture features with a fixed quantisation range.
+    */
+    itkSetMacro(CropToMask, bool);
+    itkGetConstMacro(CropToMask, bool);
+    itkBooleanMacro(CropToMask);
+
+    /** \brief Number of voxels that are kept around the mask when cropping. Default is 2. */
+    itkSetMacro(CropMargin, unsigned int);
+    itkGetConstMacro(CropMargin, unsigned int);
+
+    /** \brief Morphological mask that is passed to all feature classes. If not set, the mask is passed. */
+    itkSetMacro(MorphMask, mitk::Image::Pointer);
+    itkGetConstMacro(MorphMask, mitk::Image::Pointer);
+
+    /** \brief Calculates the features of all classes with their current settings. */
+    FeatureListType CalculateFeatures(const Image::Pointer &image, const Image::Pointer &mask);
+
+    /**
+    * \brief Calculates the features of all classes that are enabled by their parameters
+    * and appends them to featureList.
+    */
+    void CalculateFeaturesUsingParameters(const Image::Pointer &image,
+                                          const Image::Pointer &mask,
+                                          const Image::Pointer &maskNoNAN,
+                                          FeatureListType &featureList);
+
+    /** \brief Feature class name and calculation time in seconds for each class of the last calculation. */
+    const TimingListType &GetTimings() const { return m_Timings; }
+
+  protected:
+    GlobalImageFeatureEngine();
+    ~GlobalImageFeatureEngine() override;
+
+    struct PreparedInput
+    {
+      mitk::Image::Pointer FeatureImage;
+      mitk::Image::Pointer Mask;
+      mitk::Image::Pointer MaskNoNAN;
+      mitk::Image::Pointer MorphMask;
+      IntensityRangeCache::Pointer RangeCache;
+      QuantizedImageCache::Pointer QuantizedImages;
+    };
+
+    PreparedInput PrepareInput(const Image::Pointer &image,
+                               const Image::Pointer &mask,
+                               const Image::Pointer &maskNoNAN) const;
+
+    void Calculate(const PreparedInput &input, bool useParameters, FeatureListType &featureList);
+
+  private:
+    FeatureClassListType m_FeatureClasses;
+    TimingListType m_Timings;
+    unsigned int m_NumberOfThreads;
+    bool m_CropToMask;
+    unsigned int m_CropMargin;
+    mitk::Image::Pointer m_MorphMask;
+  };
+}
+
+#endif //mitkGlobalImageFeatureEngine_h
@@ -198,6 +198,82 @@ CalculateGlSZMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
   return largestRegion;
 }
 
+/**
+* Same zones as CalculateGlSZMatrix with all offsets of the radius 1 neighbourhood, searched along the
+* neighbours with equal bins from the mitk::QuantizedImageCache.
+*/
+template<unsigned int VImageDimension>
+static int
+CalculateGlSZMatrixFromNeighbourhoods(itk::Image<int, VImageDimension>* quantized,
+                    itk::Image<unsigned short, VImageDimension>* mask,
+                    itk::Image<unsigned int, VImageDimension>* equalNeighbours,
+                    bool estimateLargestRegion,
+                    mitk::GreyLevelSizeZoneMatrixHolder &holder)
+{
+  typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
+  typedef typename MaskImageType::IndexType IndexType;
+
+  // the same bit order as in mitk::QuantizedImageCache::GetNeighbourhoods
+  itk::Neighborhood<int, VImageDimension> hood;
+  hood.SetRadius(1);
+  std::vector<itk::Offset<VImageDimension> > offsets;
+  for (unsigned int k = 0; k < hood.Size(); ++k)
+  {
+    if (k != hood.GetCenterNeighborhoodIndex())
+      offsets.push_back(hood.GetOffset(k));
+  }
+
+  auto region = mask->GetLargestPossibleRegion();
+  typename MaskImageType::Pointer visitedImage = MaskImageType::New();
+  visitedImage->SetRegions(region);
+  visitedImage->Allocate();
+  visitedImage->FillBuffer(0);
+
+  int largestRegion = 0;
+
+  itk::ImageRegionIteratorWithIndex<MaskImageType> maskIter(mask, region);
+  for (; !maskIter.IsAtEnd(); ++maskIter)
+  {
+    if (maskIter.Value() < 1 || visitedImage->GetPixel(maskIter.GetIndex()) > 0)
+    {
+      continue;
+    }
+
+    std::vector<IndexType> indices;
+    indices.push_back(maskIter.GetIndex());
+    visitedImage->SetPixel(maskIter.GetIndex(), 1);
+    unsigned int steps = 0;
+
+    while (indices.size() > 0)
+    {
+      auto currentIndex = indices.back();
+      indices.pop_back();
+      ++steps;
+
+      unsigned int equalBits = equalNeighbours->GetPixel(currentIndex);
+      for (unsigned int k = 0; k < offsets.size(); ++k)
+      {
+        if ((equalBits & (1u << k)) == 0)
+          continue;
+        auto newIndex = currentIndex + offsets[k];
+        if (visitedImage->GetPixel(newIndex) < 1)
+        {
+          visitedImage->SetPixel(newIndex, 1);
+          indices.push_back(newIndex);
+        }
+      }
+    }
+
+    largestRegion = std::max<int>(steps, largestRegion);
+    steps = std::min<unsigned int>(steps, holder.m_MaximumSize);
+    if (!estimateLargestRegion)
+    {
+      holder.m_Matrix(quantized->GetPixel(maskIter.GetIndex()), steps - 1) += 1;
+    }
+  }
+  return largestRegion;
+}
+
 static void CalculateFeatures(
   mitk::GreyLevelSizeZoneMatrixHolder &holder,
   mitk::GreyLevelSizeZoneFeatures & results
@@ -335,6 +411,23 @@ CalculateGreyLevelSizeZoneFeatures(itk::Image<TPixel, VImageDimension>* itkImage
 
   std::vector<mitk::GreyLevelSizeZoneFeatures> resultVector;
   mitk::GreyLevelSizeZoneMatrixHolder tmpHolder(rangeMin, rangeMax, numberOfBins, 3);
+  if (config.EqualNeighbours.IsNotNull())
+  {
+    typename itk::Image<int, VImageDimension>::Pointer quantized;
+    typename itk::Image<unsigned int, VImageDimension>::Pointer equalNeighbours;
+    mitk::CastToItkImage(config.QuantizedImage, quantized);
+    mitk::CastToItkImage(config.EqualNeighbours, equalNeighbours);
+
+    int largestRegion = CalculateGlSZMatrixFromNeighbourhoods<VImageDimension>(quantized, maskImage, equalNeighbours, true, tmpHolder);
+    mitk::GreyLevelSizeZoneMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins, largestRegion);
+    mitk::GreyLevelSizeZoneFeatures overallFeature;
+    CalculateGlSZMatrixFromNeighbourhoods<VImageDimension>(quantized, maskImage, equalNeighbours, false, holderOverall);
+    CalculateFeatures(holderOverall, overallFeature);
+
+    MatrixFeaturesTo(overallFeature, config.prefix, featureList);
+    return;
+  }
+
   int largestRegion = CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, true, tmpHolder);
   mitk::GreyLevelSizeZoneMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins,largestRegion);
   mitk::GreyLevelSizeZoneFeatures overallFeature;
@@ -391,6 +484,16 @@ mitk::GIFGreyLevelSizeZone::FeatureListType mitk::GIFGreyLevelSizeZone::Calculat
   config.Bins = GetQuantifier()->GetBins();
   config.prefix = FeatureDescriptionPrefix();
 
+  // The zones of the shared neighbourhoods connect all voxels of the radius 1 neighbourhood
+  auto cache = GetQuantizedImageCache();
+  if (cache.IsNotNull() && config.direction == 0)
+  {
+    double binsize = (config.MaximumIntensity - config.MinimumIntensity) / (config.Bins);
+    mitk::Image::Pointer maskedNeighbours;
+    config.QuantizedImage = cache->GetQuantizedImage(image, config.MinimumIntensity, binsize);
+    cache->GetNeighbourhoods(image, mask, config.MinimumIntensity, binsize, maskedNeighbours, config.EqualNeighbours);
+  }
+
   AccessByItk_3(image, CalculateGreyLevelSizeZoneFeatures, mask, featureList, config);
 
   return featureList;
@@ -12,6 +12,7 @@
 #include <itkImageRegionConstIterator.h>
 
 // STL
+#include <bitset>
 #include <sstream>
 
 namespace mitk
@@ -234,6 +235,55 @@ CalculateNGLDMMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
 
 }
 
+/**
+* Same matrix as CalculateNGLDMMatrix for alpha 0 and range 1, counted from the neighbourhoods of the
+* mitk::QuantizedImageCache instead of walking the neighbourhood of every voxel.
+*/
+template<unsigned int VImageDimension>
+void
+CalculateNGLDMMatrixFromNeighbourhoods(itk::Image<int, VImageDimension>* quantized,
+                    itk::Image<unsigned short, VImageDimension>* mask,
+                    itk::Image<unsigned int, VImageDimension>* maskedNeighbours,
+                    itk::Image<unsigned int, VImageDimension>* equalNeighbours,
+                    mitk::NGLDMMatrixHolder &holder)
+{
+  holder.m_NumberOfCompleteNeighbourhoods = 0;
+  holder.m_NumberOfNeighbourhoods = 0;
+  holder.m_NumberOfNeighbourVoxels = 0;
+  holder.m_NumberOfDependenceNeighbourVoxels = 0;
+
+  unsigned int neighbourhoodSize = 1;
+  for (unsigned int d = 0; d < VImageDimension; ++d)
+    neighbourhoodSize *= 3;
+  holder.m_NeighbourhoodSize = neighbourhoodSize - 1;
+
+  auto region = mask->GetLargestPossibleRegion();
+  itk::ImageRegionConstIterator<itk::Image<int, VImageDimension> > quantizedIter(quantized, region);
+  itk::ImageRegionConstIterator<itk::Image<unsigned short, VImageDimension> > maskIter(mask, region);
+  itk::ImageRegionConstIterator<itk::Image<unsigned int, VImageDimension> > maskedIter(maskedNeighbours, region);
+  itk::ImageRegionConstIterator<itk::Image<unsigned int, VImageDimension> > equalIter(equalNeighbours, region);
+
+  for (; !maskIter.IsAtEnd(); ++quantizedIter, ++maskIter, ++maskedIter, ++equalIter)
+  {
+    int i = quantizedIter.Get();
+    if ((i == mitk::QuantizedImageCache::NaNIndex) || (maskIter.Get() < 1))
+    {
+      continue;
+    }
+
+    auto neighbourVoxels = std::bitset<32>(maskedIter.Get()).count();
+    auto sameValues = std::bitset<32>(equalIter.Get()).count();
+    holder.m_NumberOfNeighbourVoxels += neighbourVoxels;
+    holder.m_NumberOfDependenceNeighbourVoxels += sameValues;
+    holder.m_Matrix(i, sameValues) += 1;
+    holder.m_NumberOfNeighbourhoods += 1;
+    if (neighbourVoxels == static_cast<std::size_t>(holder.m_NeighbourhoodSize))
+    {
+      holder.m_NumberOfCompleteNeighbourhoods += 1;
+    }
+  }
+}
+
 void LocalCalculateFeatures(
   mitk::NGLDMMatrixHolder &holder,
   mitk::NGLDMMatrixFeatures & results
@@ -357,7 +407,21 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
 
   mitk::NGLDMMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins, numberofDependency);
   mitk::NGLDMMatrixFeatures overallFeature;
-  CalculateNGLDMMatrix<TPixel, VImageDimension>(itkImage, maskImage, config.alpha, config.range, config.direction, holderOverall);
+  if (config.EqualNeighbours.IsNotNull())
+  {
+    typedef itk::Image<unsigned int, VImageDimension> NeighbourhoodImageType;
+    typename itk::Image<int, VImageDimension>::Pointer quantized;
+    typename NeighbourhoodImageType::Pointer maskedNeighbours;
+    typename NeighbourhoodImageType::Pointer equalNeighbours;
+    mitk::CastToItkImage(config.QuantizedImage, quantized);
+    mitk::CastToItkImage(config.MaskedNeighbours, maskedNeighbours);
+    mitk::CastToItkImage(config.EqualNeighbours, equalNeighbours);
+    CalculateNGLDMMatrixFromNeighbourhoods<VImageDimension>(quantized, maskImage, maskedNeighbours, equalNeighbours, holderOverall);
+  }
+  else
+  {
+    CalculateNGLDMMatrix<TPixel, VImageDimension>(itkImage, maskImage, config.alpha, config.range, config.direction, holderOverall);
+  }
   LocalCalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config.FeatureEncoding, featureList);
@@ -423,6 +487,15 @@ mitk::GIFNeighbouringGreyLevelDependenceFeature::FeatureListType mitk::GIFNeighb
 
   config.FeatureEncoding = FeatureDescriptionPrefix();
 
+  // The shared neighbourhoods have radius 1 in all directions and count equal bins only
+  auto cache = GetQuantizedImageCache();
+  if (cache.IsNotNull() && static_cast<int>(config.range) == 1 && config.direction < 2 && config.alpha == 0)
+  {
+    double binsize = (config.MaximumIntensity - config.MinimumIntensity) / (config.Bins);
+    config.QuantizedImage = cache->GetQuantizedImage(image, config.MinimumIntensity, binsize);
+    cache->GetNeighbourhoods(image, mask, config.MinimumIntensity, binsize, config.MaskedNeighbours, config.EqualNeighbours);
+  }
+
   AccessByItk_3(image, CalculateCoocurenceFeatures, mask, featureList,config);
 
   return featureList;
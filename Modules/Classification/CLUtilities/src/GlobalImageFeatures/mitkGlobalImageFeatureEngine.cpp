@@ -0,0 +1,249 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkGlobalImageFeatureEngine.h>
+
+// MITK
+#include <mitkITKImageImport.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkParallelFor.h>
+
+// ITK
+#include <itkCastImageFilter.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkRegionOfInterestImageFilter.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+namespace
+{
+  typedef std::vector<itk::IndexValueType> IndexListType;
+  typedef std::vector<itk::SizeValueType> SizeListType;
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void ConvertMaskToUnsignedShort(itk::Image<TPixel, VImageDimension> *itkMask, mitk::Image::Pointer &output)
+  {
+    typedef itk::Image<TPixel, VImageDimension> InputType;
+    typedef itk::Image<unsigned short, VImageDimension> MaskType;
+    typedef itk::CastImageFilter<InputType, MaskType> CastFilterType;
+
+    typename CastFilterType::Pointer castFilter = CastFilterType::New();
+    castFilter->SetInput(itkMask);
+    castFilter->Update();
+    output = mitk::GrabItkImageMemory(castFilter->GetOutput());
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void GetMaskBoundingBox(itk::Image<TPixel, VImageDimension> *itkMask, unsigned int margin, IndexListType &index, SizeListType &size)
+  {
+    typedef itk::Image<TPixel, VImageDimension> MaskType;
+
+    const typename MaskType::RegionType largestRegion = itkMask->GetLargestPossibleRegion();
+    typename MaskType::IndexType minIndex;
+    typename MaskType::IndexType maxIndex;
+    minIndex.Fill(itk::NumericTraits<itk::IndexValueType>::max());
+    maxIndex.Fill(itk::NumericTraits<itk::IndexValueType>::NonpositiveMin());
+
+    bool found = false;
+    itk::ImageRegionConstIteratorWithIndex<MaskType> iter(itkMask, largestRegion);
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      if (iter.Value() == 0)
+        continue;
+      found = true;
+      const typename MaskType::IndexType current = iter.GetIndex();
+      for (unsigned int d = 0; d < VImageDimension; ++d)
+      {
+        minIndex[d] = std::min(minIndex[d], current[d]);
+        maxIndex[d] = std::max(maxIndex[d], current[d]);
+      }
+    }
+
+    index.clear();
+    size.clear();
+    if (!found)
+      return;
+
+    for (unsigned int d = 0; d < VImageDimension; ++d)
+    {
+      const itk::IndexValueType first = largestRegion.GetIndex(d);
+      const itk::IndexValueType last = first + static_cast<itk::IndexValueType>(largestRegion.GetSize(d)) - 1;
+      const itk::IndexValueType lower = std::max(first, minIndex[d] - static_cast<itk::IndexValueType>(margin));
+      const itk::IndexValueType upper = std::min(last, maxIndex[d] + static_cast<itk::IndexValueType>(margin));
+      index.push_back(lower);
+      size.push_back(static_cast<itk::SizeValueType>(upper - lower + 1));
+    }
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void CropImage(itk::Image<TPixel, VImageDimension> *itkImage,
+                 const IndexListType &index,
+                 const SizeListType &size,
+                 mitk::Image::Pointer &output)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::RegionOfInterestImageFilter<ImageType, ImageType> FilterType;
+
+    typename ImageType::RegionType region;
+    for (unsigned int d = 0; d < VImageDimension; ++d)
+    {
+      region.SetIndex(d, index[d]);
+      region.SetSize(d, size[d]);
+    }
+
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(itkImage);
+    filter->SetRegionOfInterest(region);
+    filter->Update();
+    output = mitk::GrabItkImageMemory(filter->GetOutput());
+  }
+
+  mitk::Image::Pointer ToUnsignedShortMask(const mitk::Image::Pointer &mask)
+  {
+    if (mask.IsNull() || mask->GetPixelType().GetComponentType() == itk::ImageIOBase::USHORT)
+      return mask;
+
+    mitk::Image::Pointer result;
+    AccessByItk_1(mask, ConvertMaskToUnsignedShort, result);
+    return result;
+  }
+
+  mitk::Image::Pointer Crop(const mitk::Image::Pointer &image, const IndexListType &index, const SizeListType &size)
+  {
+    if (image.IsNull())
+      return image;
+
+    mitk::Image::Pointer result;
+    AccessByItk_3(image, CropImage, index, size, result);
+    return result;
+  }
+}
+
+mitk::GlobalImageFeatureEngine::GlobalImageFeatureEngine()
+  : m_NumberOfThreads(std::max(std::thread::hardware_concurrency(), 1u)), m_CropToMask(false), m_CropMargin(2)
+{
+}
+
+mitk::GlobalImageFeatureEngine::~GlobalImageFeatureEngine()
+{
+}
+
+void mitk::GlobalImageFeatureEngine::AddFeatureClass(AbstractGlobalImageFeature *featureClass)
+{
+  m_FeatureClasses.push_back(featureClass);
+  this->Modified();
+}
+
+mitk::GlobalImageFeatureEngine::FeatureListType mitk::GlobalImageFeatureEngine::CalculateFeatures(
+  const Image::Pointer &image, const Image::Pointer &mask)
+{
+  FeatureListType featureList;
+  Calculate(PrepareInput(image, mask, nullptr), false, featureList);
+  return featureList;
+}
+
+void mitk::GlobalImageFeatureEngine::CalculateFeaturesUsingParameters(const Image::Pointer &image,
+                                                                      const Image::Pointer &mask,
+                                                                      const Image::Pointer &maskNoNAN,
+                                                                      FeatureListType &featureList)
+{
+  Calculate(PrepareInput(image, mask, maskNoNAN), true, featureList);
+}
+
+mitk::GlobalImageFeatureEngine::PreparedInput mitk::GlobalImageFeatureEngine::PrepareInput(
+  const Image::Pointer &image, const Image::Pointer &mask, const Image::Pointer &maskNoNAN) const
+{
+  PreparedInput input;
+  input.FeatureImage = image;
+  input.Mask = ToUnsignedShortMask(mask);
+  input.MaskNoNAN = (maskNoNAN == mask) ? input.Mask : ToUnsignedShortMask(maskNoNAN);
+  input.MorphMask = m_MorphMask.IsNull() || m_MorphMask == mask ? input.Mask : ToUnsignedShortMask(m_MorphMask);
+  input.RangeCache = IntensityRangeCache::New();
+  input.QuantizedImages = QuantizedImageCache::New();
+
+  if (!m_CropToMask || image->GetDimension() != input.Mask->GetDimension())
+    return input;
+
+  IndexListType index;
+  SizeListType size;
+  AccessByItk_3(input.Mask, GetMaskBoundingBox, m_CropMargin, index, size);
+  if (index.empty())
+  {
+    MITK_WARN << "Mask is empty, the image is not cropped.";
+    return input;
+  }
+
+  const Image::Pointer mask16 = input.Mask;
+  input.FeatureImage = Crop(input.FeatureImage, index, size);
+  input.Mask = Crop(mask16, index, size);
+  input.MaskNoNAN = (input.MaskNoNAN == mask16) ? input.Mask : Crop(input.MaskNoNAN, index, size);
+  input.MorphMask = (input.MorphMask == mask16) ? input.Mask : Crop(input.MorphMask, index, size);
+  return input;
+}
+
+void mitk::GlobalImageFeatureEngine::Calculate(const PreparedInput &input, bool useParameters, FeatureListType &featureList)
+{
+  const std::size_t numberOfClasses = m_FeatureClasses.size();
+
+  for (auto featureClass : m_FeatureClasses)
+  {
+    featureClass->SetRangeCache(input.RangeCache);
+    featureClass->SetQuantizedImageCache(input.QuantizedImages);
+    featureClass->SetMorphMask(input.MorphMask);
+  }
+
+  std::vector<FeatureListType> results(numberOfClasses);
+  std::vector<double> seconds(numberOfClasses, 0.0);
+  std::vector<std::exception_ptr> errors(numberOfClasses);
+
+  // The errors are kept per class, so all classes finish and the caches are released before one is rethrown
+  mitk::ParallelFor(numberOfClasses,
+                    [&](std::size_t i) {
+                      const auto start = std::chrono::steady_clock::now();
+                      try
+                      {
+                        if (useParameters)
+                          m_FeatureClasses[i]->CalculateFeaturesUsingParameters(input.FeatureImage, input.Mask, input.MaskNoNAN, results[i]);
+                        else
+                          results[i] = m_FeatureClasses[i]->CalculateFeatures(input.FeatureImage, input.Mask);
+                      }
+                      catch (...)
+                      {
+                        errors[i] = std::current_exception();
+                      }
+                      seconds[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    },
+                    std::max(m_NumberOfThreads, 1u));
+
+  for (auto featureClass : m_FeatureClasses)
+  {
+    featureClass->SetRangeCache(nullptr);
+    featureClass->SetQuantizedImageCache(nullptr);
+  }
+
+  m_Timings.clear();
+  for (std::size_t i = 0; i < numberOfClasses; ++i)
+  {
+    if (errors[i])
+      std::rethrow_exception(errors[i]);
+    m_Timings.push_back(std::make_pair(m_FeatureClasses[i]->GetFeatureClassName(), seconds[i]));
+    featureList.insert(featureList.end(), results[i].begin(), results[i].end());
+  }
+}
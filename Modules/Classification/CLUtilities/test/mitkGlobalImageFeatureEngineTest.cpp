@@ -0,0 +1,166 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+#include <cmath>
+
+#include <mitkGIFFirstOrderStatistics.h>
+#include <mitkGIFGreyLevelSizeZone.h>
+#include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+#include <mitkGIFVolumetricStatistics.h>
+#include <mitkGlobalImageFeatureEngine.h>
+
+class mitkGlobalImageFeatureEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGlobalImageFeatureEngineTestSuite);
+
+  MITK_TEST(CalculateFeatures_SameAsSequential);
+  MITK_TEST(CalculateFeatures_CroppedSameAsSequential);
+  MITK_TEST(CalculateFeatures_SharedQuantizationSameAsSequential);
+  MITK_TEST(CropToMask_DefaultOff);
+  MITK_TEST(CalculateFeatures_Timings);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Large;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
+
+  mitk::GIFGreyLevelSizeZone::Pointer CreateSizeZoneCalculator()
+  {
+    mitk::GIFGreyLevelSizeZone::Pointer featureCalculator = mitk::GIFGreyLevelSizeZone::New();
+    featureCalculator->SetUseBinsize(true);
+    featureCalculator->SetBinsize(1.0);
+    featureCalculator->SetUseMinimumIntensity(true);
+    featureCalculator->SetUseMaximumIntensity(true);
+    featureCalculator->SetMinimumIntensity(0.5);
+    featureCalculator->SetMaximumIntensity(6.5);
+    return featureCalculator;
+  }
+
+  mitk::GIFNeighbouringGreyLevelDependenceFeature::Pointer CreateDependenceCalculator()
+  {
+    mitk::GIFNeighbouringGreyLevelDependenceFeature::Pointer featureCalculator = mitk::GIFNeighbouringGreyLevelDependenceFeature::New();
+    featureCalculator->SetUseBinsize(true);
+    featureCalculator->SetBinsize(1.0);
+    featureCalculator->SetUseMinimumIntensity(true);
+    featureCalculator->SetUseMaximumIntensity(true);
+    featureCalculator->SetMinimumIntensity(0.5);
+    featureCalculator->SetMaximumIntensity(6.5);
+    return featureCalculator;
+  }
+
+  void CompareFeatureLists(const mitk::AbstractGlobalImageFeature::FeatureListType &expected,
+                           const mitk::AbstractGlobalImageFeature::FeatureListType &actual)
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Engine should calculate the same number of features", expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Features should be in the same order", expected[i].first, actual[i].first);
+      bool bothNaN = std::isnan(expected[i].second) && std::isnan(actual[i].second);
+      CPPUNIT_ASSERT_MESSAGE(expected[i].first + " should be identical", bothNaN || expected[i].second == actual[i].second);
+    }
+  }
+
+public:
+
+  void setUp(void) override
+  {
+    m_IBSI_Phantom_Image_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Large.nrrd"));
+    m_IBSI_Phantom_Mask_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Large.nrrd"));
+  }
+
+  void CalculateFeatures_SameAsSequential()
+  {
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> featureClasses;
+    featureClasses.push_back(CreateSizeZoneCalculator().GetPointer());
+    featureClasses.push_back(mitk::GIFFirstOrderStatistics::New().GetPointer());
+    featureClasses.push_back(mitk::GIFVolumetricStatistics::New().GetPointer());
+
+    mitk::AbstractGlobalImageFeature::FeatureListType expected;
+    for (auto featureClass : featureClasses)
+    {
+      auto features = featureClass->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+      expected.insert(expected.end(), features.begin(), features.end());
+    }
+
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->SetNumberOfThreads(2);
+    for (auto featureClass : featureClasses)
+    {
+      engine->AddFeatureClass(featureClass);
+    }
+    auto featureList = engine->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    CompareFeatureLists(expected, featureList);
+  }
+
+  void CalculateFeatures_CroppedSameAsSequential()
+  {
+    mitk::GIFGreyLevelSizeZone::Pointer featureCalculator = CreateSizeZoneCalculator();
+    auto expected = featureCalculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->AddFeatureClass(featureCalculator);
+    engine->CropToMaskOn();
+    engine->SetCropMargin(1);
+    auto featureList = engine->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    CompareFeatureLists(expected, featureList);
+  }
+
+  void CalculateFeatures_SharedQuantizationSameAsSequential()
+  {
+    // Both classes use the same quantisation, so they share the quantised image and the neighbourhoods
+    auto expected = CreateDependenceCalculator()->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    auto sizeZoneFeatures = CreateSizeZoneCalculator()->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    expected.insert(expected.end(), sizeZoneFeatures.begin(), sizeZoneFeatures.end());
+
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->SetNumberOfThreads(2);
+    engine->AddFeatureClass(CreateDependenceCalculator());
+    engine->AddFeatureClass(CreateSizeZoneCalculator());
+    auto featureList = engine->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    CompareFeatureLists(expected, featureList);
+    CPPUNIT_ASSERT_MESSAGE("The shared cache should be released after the calculation",
+                           engine->GetFeatureClasses()[0]->GetQuantizedImageCache().IsNull());
+  }
+
+  void CropToMask_DefaultOff()
+  {
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    CPPUNIT_ASSERT_MESSAGE("Images should not be cropped to the mask by default", !engine->GetCropToMask());
+  }
+
+  void CalculateFeatures_Timings()
+  {
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->AddFeatureClass(CreateSizeZoneCalculator());
+    engine->AddFeatureClass(mitk::GIFFirstOrderStatistics::New());
+    engine->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    auto timings = engine->GetTimings();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("There should be one timing per feature class", std::size_t(2), timings.size());
+    CPPUNIT_ASSERT_EQUAL(engine->GetFeatureClasses()[0]->GetFeatureClassName(), timings[0].first);
+    CPPUNIT_ASSERT_EQUAL(engine->GetFeatureClasses()[1]->GetFeatureClassName(), timings[1].first);
+    CPPUNIT_ASSERT_MESSAGE("Timings should not be negative", timings[0].second >= 0.0 && timings[1].second >= 0.0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGlobalImageFeatureEngine)
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageAccessorBase.h"
 #include "mitkImageDataItem.h"
 #include "mitkImageDescriptor.h"
+#include "mitkImageVolumeProvider.h"
 #include "mitkImageVtkAccessor.h"
 #include "mitkLevelWindow.h"
 #include "mitkPlaneGeometry.h"
@@ -35,6 +36,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkHistogram.h>
 #endif
 
+#include <array>
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
 class vtkImageData;
 
 namespace itk
@@ -184,6 +192,30 @@ namespace mitk
     //## @brief Check whether the channel @a n is set
     bool IsChannelSet(int n = 0) const override;
 
+    //##Documentation
+    //## @brief Set a provider that loads the volumes (time steps) of the image on demand.
+    //##
+    //## Volumes that are not resident are allocated and filled by @a provider as soon as
+    //## they are requested, e.g. by an image accessor. Volumes loaded this way are kept in
+    //## least-recently-used order and released again as soon as their total size exceeds
+    //## @a memoryBudget bytes (0 means unlimited). The most recently used volume, volumes
+    //## still referenced by accessors, slices or vtkImageData objects and volumes that were
+    //## written to are never released.
+    //##
+    //## Requesting the complete data of a channel (e.g. GetData() or an accessor without
+    //## ImageDataItem) loads all its volumes and keeps them resident.
+    //## @warning Data written via the deprecated ImageDataItem::GetData() of a provided
+    //## volume is not tracked and may be lost. Use ImageWriteAccessor instead.
+    void SetVolumeProvider(ImageVolumeProvider *provider, size_t memoryBudget = 0);
+
+    //##Documentation
+    //## @brief Get the provider set by SetVolumeProvider() or nullptr.
+    ImageVolumeProvider *GetVolumeProvider() const;
+
+    //##Documentation
+    //## @brief Get the number of bytes currently held by volumes loaded via the volume provider.
+    size_t GetProvidedVolumesMemorySize() const;
+
     //##Documentation
     //## @brief Set @a data as slice @a s at time @a t in channel @a n. It is in
     //## the responsibility of the caller to ensure that the data vector @a data
@@ -730,6 +762,19 @@ namespace mitk
     bool IsVolumeSet_unlocked(int t, int n) const;
     bool IsChannelSet_unlocked(int n) const;
 
+    /** Returns volume t of channel n if it is provided, loading it via m_VolumeProvider if it is not resident.
+        m_ImageDataArraysLock must not be held, it is released while the provider loads. Returns nullptr for
+        images without provider and volumes of complete channels. */
+    ImageDataItemPointer LoadProvidedVolume(int t, int n) const;
+    /** Moves a provided volume to the front of the least-recently-used list */
+    void TouchProvidedVolume_unlocked(int pos) const;
+    /** Releases least recently used provided volumes until m_VolumeMemoryBudget is met */
+    void ReleaseProvidedVolumes_unlocked() const;
+    /** Excludes the provided volume containing @a item from being released again */
+    void PinProvidedVolume(const ImageDataItem *item) const;
+    /** Excludes the provided volumes of channel @a n from being released again */
+    void PinProvidedChannel_unlocked(int n) const;
+
     /** Stores all existing ImageReadAccessors */
     mutable std::vector<ImageAccessorBase *> m_Readers;
     /** Stores all existing ImageWriteAccessors */
@@ -741,6 +786,23 @@ namespace mitk
     itk::SimpleFastMutexLock m_ReadWriteLock;
     /** A mutex, which needs to be locked to manage m_VtkReaders */
     itk::SimpleFastMutexLock m_VtkReadersLock;
+
+    /** Returns the bucket of fast path ImageReadAccessors used by the calling thread */
+    ImageAccessorReaderShard &GetReaderShardOfCurrentThread() const;
+
+    /** Number of existing or waiting ImageWriteAccessors. Read accessors take the fast path only while it is zero. */
+    mutable std::atomic<unsigned int> m_PendingWriters;
+    /** Read accessors that were granted access without locking m_ReadWriteLock, bucketed by thread */
+    mutable std::array<ImageAccessorReaderShard, 16> m_ReaderShards;
+
+    /** Loads non-resident volumes on demand, may be nullptr */
+    ImageVolumeProvider::Pointer m_VolumeProvider;
+    /** Maximum number of bytes of released-capable provided volumes, 0 means unlimited */
+    size_t m_VolumeMemoryBudget;
+    /** Volume indices of resident provided volumes, most recently used first (guarded by m_ImageDataArraysLock) */
+    mutable std::list<int> m_ProvidedVolumes;
+    /** Held while a provided volume is loaded, so that each volume is loaded once (guarded by m_ImageDataArraysLock) */
+    mutable std::map<int, std::shared_ptr<std::mutex>> m_ProvidedVolumeLoadLocks;
   };
 
   /**
@@ -25,6 +25,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkImageDataItem.h"
 
+#include <mutex>
+#include <vector>
+
 namespace mitk
 {
   //##Documentation
@@ -44,6 +47,22 @@ namespace mitk
     itk::SimpleFastMutexLock m_Mutex;
   };
 
+  class ImageAccessorBase;
+
+  /** \brief A bucket of read accessors that were granted access on the fast path.
+    *
+    * As long as no write accessor exists for an image, read accessors only register in the bucket
+    * of their thread instead of the image-wide lists, so concurrent readers rarely contend.
+    */
+  struct ImageAccessorReaderShard
+  {
+    /** \brief Guards m_Readers and the m_WaiterCount of the contained accessors. */
+    std::mutex m_Mutex;
+
+    /** \brief The read accessors of this bucket. */
+    std::vector<ImageAccessorBase *> m_Readers;
+  };
+
 // Defs to assure dead lock prevention only in case of possible thread handling.
 #if defined(ITK_USE_SPROC) || defined(ITK_USE_PTHREADS) || defined(ITK_USE_WIN32_THREADS)
 #define MITK_USE_RECURSIVE_MUTEX_PREVENTION
@@ -145,6 +164,9 @@ namespace mitk
     /** \brief Prevents a recursive mutex lock by comparing thread ids of competing image accessors */
     void PreventRecursiveMutexLock(ImageAccessorBase *iAB);
 
+    /** \brief Checks if the competing image accessor was created by the current thread */
+    bool IsRecursiveAccess(const ImageAccessorBase *iAB);
+
     virtual const Image *GetImage() const = 0;
 
   private:
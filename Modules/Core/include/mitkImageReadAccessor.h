@@ -67,10 +67,21 @@ namespace mitk
     /** \brief manages a consistent read access and locks the ordered image part */
     void OrganizeReadAccess();
 
+    /** \brief registers the accessor in the reader bucket of its thread if no write accessor exists
+      * \return false if a write accessor exists and OrganizeReadAccess() has to take the locked path
+      */
+    bool OrganizeFastReadAccess();
+
     ImageReadAccessor &operator=(const ImageReadAccessor &); // Not implemented on purpose.
     ImageReadAccessor(const ImageReadAccessor &);
 
     ImageConstPointer m_Image;
+
+    /** Keeps the accessed image part alive, e.g. a volume loaded via an ImageVolumeProvider */
+    itk::SmartPointer<const ImageDataItem> m_ImageDataItem;
+
+    /** \brief bucket the accessor is registered in, nullptr if it is registered in the image lists */
+    ImageAccessorReaderShard *m_ReaderShard;
   };
 }
 
@@ -0,0 +1,58 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkImageVolumeProvider_h
+#define mitkImageVolumeProvider_h
+
+#include <MitkCoreExports.h>
+#include <itkObjectFactory.h>
+#include <mitkCommon.h>
+
+namespace mitk
+{
+  /** \brief Base class for sources that fill volumes (time steps) of an mitk::Image on demand.
+
+    An image with a volume provider (see Image::SetVolumeProvider()) only keeps the volumes resident
+    that were requested recently. Whenever a volume is accessed that is not resident, the image allocates
+    the memory of the volume and asks the provider to fill it, e.g. by reading it from disk or by
+    decompressing it.
+
+    LoadVolume() may be called from several threads concurrently for different volumes of the same
+    image, so implementations have to synchronize access to shared resources themselves.
+    */
+  class MITKCORE_EXPORT ImageVolumeProvider : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(ImageVolumeProvider, itk::LightObject);
+
+    /** \brief Fills buffer with the pixel data of time step t of channel n.
+      *
+      * The buffer is large enough to hold exactly one volume of the image.
+      * \throws mitk::Exception if the volume cannot be provided.
+      */
+    virtual void LoadVolume(unsigned int t, unsigned int n, void *buffer) = 0;
+
+  protected:
+    ImageVolumeProvider();
+    ~ImageVolumeProvider() override;
+
+  private:
+    ImageVolumeProvider(const Self &other);
+    Self &operator=(const Self &other);
+  };
+}
+
+#endif
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK Rendering
 #include "mitkBaseRenderer.h"
 #include "mitkExtractSliceFilter.h"
+#include "mitkPlaneGeometry.h"
 #include "mitkVtkMapper.h"
 
 // VTK
@@ -176,6 +177,13 @@ namespace mitk
       mitk::ExtractSliceFilter::Pointer m_Reslicer;
       /** \brief Filter for thick slices */
       vtkSmartPointer<vtkMitkThickSlicesFilter> m_TSFilter;
+      /** \brief Plane geometry and settings of the last thick slab. If only the plane is moved
+          by one slice, just the new slice is resliced and the slab of m_TSFilter is shifted. */
+      mitk::PlaneGeometry::Pointer m_SlabGeometry;
+      itk::ModifiedTimeType m_SlabImageMTime;
+      int m_SlabTimeStep;
+      int m_SlabNumberOfSlices;
+      int m_SlabInterpolationMode;
       /** \brief PolyData object containg all lines/points needed for outlining the contour.
             This container is used to save a computed contour for the next rendering execution.
             For instance, if you zoom or pann, there is no need to recompute the contour. */
@@ -30,6 +30,17 @@ namespace mitk
    * Instantiating this class with a given itk::ImageIOBase instance
    * will register corresponding MITK reader/writer services for that
    * ITK ImageIO object.
+   *
+   * If the reader option OPTION_STREAMING_READ() is enabled and the wrapped
+   * ITK ImageIO supports streamed reading, the image is read time step by
+   * time step in slabs of at most OPTION_STREAMING_MEMORY_BUDGET() megabytes
+   * directly into the memory of the resulting mitk::Image. ImageIOs that
+   * cannot stream fall back to reading the whole file at once.
+   *
+   * If additionally OPTION_ON_DEMAND_TIME_STEPS() is enabled, time steps of
+   * 3D+t images are not read up front at all. They are loaded by an
+   * mitk::ImageVolumeProvider when they are accessed for the first time and
+   * released again if they exceed OPTION_RESIDENT_MEMORY_BUDGET().
    */
   class MITKCORE_EXPORT ItkImageIO : public AbstractFileIO
   {
@@ -37,6 +48,15 @@ namespace mitk
     ItkImageIO(itk::ImageIOBase::Pointer imageIO);
     ItkImageIO(const CustomMimeType &mimeType, itk::ImageIOBase::Pointer imageIO, int rank);
 
+    /** Reader option (bool) that enables the region-wise streaming read mode. */
+    static std::string OPTION_STREAMING_READ();
+    /** Reader option (int) that limits the size of a single streamed slab in megabytes. */
+    static std::string OPTION_STREAMING_MEMORY_BUDGET();
+    /** Reader option (bool) that defers loading of time steps until they are accessed. */
+    static std::string OPTION_ON_DEMAND_TIME_STEPS();
+    /** Reader option (int) that limits the memory of on-demand loaded time steps in megabytes, 0 means unlimited. */
+    static std::string OPTION_RESIDENT_MEMORY_BUDGET();
+
     // -------------- AbstractFileReader -------------
 
     using AbstractFileReader::Read;
@@ -56,6 +76,9 @@ namespace mitk
     // Fills the m_DefaultMetaDataKeys vector with default values
     virtual void InitializeDefaultMetaDataKeys();
 
+    // Sets the default values of the streaming reader options
+    virtual void InitializeDefaultReaderOptions();
+
   private:
     ItkImageIO(const ItkImageIO &other);
 
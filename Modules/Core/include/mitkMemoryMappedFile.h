@@ -0,0 +1,66 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_MemoryMappedFile_H
+#define _MITK_MemoryMappedFile_H
+
+#include <MitkCoreExports.h>
+#include <cstddef>
+#include <string>
+
+namespace mitk {
+
+  /**
+   * \brief Read-only memory mapping of a complete file.
+   *
+   * Used by readers that parse large files without one read call per value, e.g. the tractogram readers
+   * and mitk::NavigationDataBinaryFile. Other processes may still append to the file, the mapping covers
+   * its size at the time of Open(). The mapping is released on destruction.
+   */
+  class MITKCORE_EXPORT MemoryMappedFile
+  {
+  public:
+
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    /**
+     * \brief Maps the given file. Throws an mitk::Exception if the file can not be mapped.
+     * @param sequentialAccess tells the operating system that the file is read front to back
+     */
+    void Open(const std::string& filename, bool sequentialAccess = true);
+    void Close();
+
+    const char* GetData() const { return m_Data; }
+    std::size_t GetSize() const { return m_Size; }
+
+  private:
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    const char* m_Data;
+    std::size_t m_Size;
+#ifdef _WIN32
+    void* m_File;
+    void* m_Mapping;
+#else
+    int m_File;
+#endif
+  };
+}
+
+#endif
@@ -38,6 +38,9 @@ namespace mitk
 
     bool CheckNode(const mitk::DataNode *node) const override;
 
+    /** \brief Returns the UID the predicate compares to. */
+    const Identifiable::UIDType &GetUID() const { return m_UID; }
+
   protected:
     explicit NodePredicateDataUID(const Identifiable::UIDType &uid);
 
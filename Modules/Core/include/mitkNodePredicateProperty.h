@@ -48,6 +48,18 @@ namespace mitk
     //## @brief Checks, if the nodes contains a property that is equal to m_ValidProperty
     bool CheckNode(const mitk::DataNode *node) const override;
 
+    //##Documentation
+    //## @brief Returns the key of the property that is checked
+    const std::string &GetValidPropertyName() const { return m_ValidPropertyName; }
+
+    //##Documentation
+    //## @brief Returns the property value that is compared to (nullptr if only the existence is checked)
+    const mitk::BaseProperty *GetValidProperty() const { return m_ValidProperty; }
+
+    //##Documentation
+    //## @brief Returns the renderer whose property list is checked (nullptr for the common property list)
+    const mitk::BaseRenderer *GetRenderer() const { return m_Renderer; }
+
   protected:
     //##Documentation
     //## @brief Constructor to check for a named property
@@ -0,0 +1,42 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKPARALLELFOR_H
+#define MITKPARALLELFOR_H
+
+#include <MitkCoreExports.h>
+
+#include <cstddef>
+#include <functional>
+
+namespace mitk
+{
+  /**
+    \brief Calls function(i) for all i in [0, numberOfItems) from several threads.
+
+    The items are handed out one at a time, so items of different cost are balanced between the threads. The
+    calling thread processes items as well. If function throws, no further items are started and the first
+    exception is rethrown after all threads finished.
+
+    \param numberOfThreads Maximum number of threads including the calling one. 0 uses
+           std::thread::hardware_concurrency(), 1 processes the items in order in the calling thread.
+  */
+  MITKCORE_EXPORT void ParallelFor(std::size_t numberOfItems,
+                                   const std::function<void(std::size_t)> &function,
+                                   unsigned int numberOfThreads = 0);
+}
+
+#endif
@@ -21,6 +21,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDataStorage.h"
 #include "mitkMessage.h"
 #include <map>
+#include <set>
+#include <unordered_map>
 
 namespace mitk
 {
@@ -36,6 +38,14 @@ namespace mitk
   //## Thus, nodes are stored in a noncyclical directed graph data structure.
   //## It is derived from mitk::DataStorage and implements its interface,
   //## including AddNodeEvent and RemoveNodeEvent.
+  //##
+  //## Besides the relation graph, secondary indexes by node name, data type (class name of the
+  //## data object) and data UID are maintained. They are updated on Add() and Remove() and whenever
+  //## a node or its "name" property is modified. GetSubset() (and thus GetNamedNode() and GetNode())
+  //## uses these indexes to narrow down the candidate nodes if the predicate tree contains a
+  //## NodePredicateDataType, NodePredicateDataUID or NodePredicateProperty("name", StringProperty).
+  //## The candidates are always checked against the complete predicate, so results are identical
+  //## to a full scan.
   //## @ingroup StandaloneDataStorage
   class MITKCORE_EXPORT StandaloneDataStorage : public mitk::DataStorage
   {
@@ -91,6 +101,13 @@ namespace mitk
     //##
     SetOfObjects::ConstPointer GetAll() const override;
 
+    //##Documentation
+    //## @brief returns a set of data objects that meet the given condition(s)
+    //##
+    //## Uses the secondary node indexes if the condition allows it, otherwise falls back to
+    //## DataStorage::GetSubset().
+    SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const override;
+
     /*ITK Mutex */
     mutable itk::SimpleFastMutexLock m_Mutex;
 
@@ -99,6 +116,27 @@ namespace mitk
     //## @brief noncyclical directed graph data structure to store the nodes with their relation
     typedef std::map<mitk::DataNode::ConstPointer, SetOfObjects::ConstPointer> AdjacencyList;
 
+    //##Documentation
+    //## @brief set of nodes sharing an index key, ordered like the nodes in GetAll()
+    typedef std::set<const mitk::DataNode *> NodeIndexBucket;
+    typedef std::unordered_map<std::string, NodeIndexBucket> NodeIndex;
+
+    //##Documentation
+    //## @brief index keys of a node and the observers that keep them up to date
+    struct NodeIndexEntry
+    {
+      NodeIndexEntry() : HasName(false), HasData(false), NodeObserverTag(0), NamePropertyObserverTag(0) {}
+
+      bool HasName;
+      std::string Name;
+      bool HasData;
+      std::string DataType;
+      std::string DataUID;
+      BaseProperty::Pointer NameProperty;
+      unsigned long NodeObserverTag;
+      unsigned long NamePropertyObserverTag;
+    };
+
     //##Documentation
     //## @brief Standard Constructor for ::New() instantiation
     StandaloneDataStorage();
@@ -121,6 +159,37 @@ namespace mitk
     //## @brief deletes all references to a node in a given relation (used in Remove() and TreeListener)
     void RemoveFromRelation(const mitk::DataNode *node, AdjacencyList &relation);
 
+    //##Documentation
+    //## @brief inserts node into the secondary indexes and registers the observers that keep them up to date.
+    //## m_Mutex has to be locked by the caller.
+    void AddToIndex(const mitk::DataNode *node);
+
+    //##Documentation
+    //## @brief removes node from the secondary indexes and unregisters its observers.
+    //## m_Mutex has to be locked by the caller.
+    void RemoveFromIndex(const mitk::DataNode *node);
+
+    //##Documentation
+    //## @brief recomputes the index keys of node and moves it to the matching buckets.
+    //## m_Mutex has to be locked by the caller.
+    void UpdateIndex(const mitk::DataNode *node, NodeIndexEntry &entry);
+
+    //##Documentation
+    //## @brief Collects candidate nodes for condition from the secondary indexes
+    //##
+    //## Returns false if the predicate tree contains no indexed predicate that restricts the result;
+    //## in this case all nodes have to be checked. Otherwise, candidates is a superset of the nodes
+    //## that fulfill condition. m_Mutex has to be locked by the caller.
+    bool CollectIndexedCandidates(const NodePredicateBase *condition, NodeIndexBucket &candidates) const;
+
+    //##Documentation
+    //## @brief Listens to modified events of stored nodes and updates their index keys
+    void OnIndexedNodeModified(const itk::Object *caller, const itk::EventObject &event);
+
+    //##Documentation
+    //## @brief Listens to modified events of the "name" properties of stored nodes and updates the name index
+    void OnIndexedNamePropertyModified(const itk::Object *caller, const itk::EventObject &event);
+
     //##Documentation
     //## @brief Prints the contents of the StandaloneDataStorage to os. Do not call directly, call ->Print() instead
     void PrintSelf(std::ostream &os, itk::Indent indent) const override;
@@ -131,6 +200,26 @@ namespace mitk
     //##Documentation
     //## @brief Nodes are stored in reverse relation for easier traversal in the opposite direction of the relation
     AdjacencyList m_DerivedNodes;
+
+    //##Documentation
+    //## @brief Index keys of every stored node
+    std::map<const mitk::DataNode *, NodeIndexEntry> m_NodeIndexEntries;
+    //##Documentation
+    //## @brief Nodes by the value of their "name" StringProperty
+    NodeIndex m_NameIndex;
+    //##Documentation
+    //## @brief Nodes without an own "name" property. Their name may be provided by the property list of their
+    //## data, which is not observed, so they are candidates for every name query.
+    NodeIndexBucket m_UnnamedNodes;
+    //##Documentation
+    //## @brief Nodes by the class name of their data
+    NodeIndex m_DataTypeIndex;
+    //##Documentation
+    //## @brief Nodes by the UID of their data
+    NodeIndex m_DataUIDIndex;
+    //##Documentation
+    //## @brief Stored nodes that use a given property as their "name" property
+    std::multimap<const BaseProperty *, const mitk::DataNode *> m_NamePropertyOwners;
   };
 } // namespace mitk
 #endif /* MITKSTANDALONEDATASTORAGE_H_HEADER_INCLUDED_ */
@@ -31,6 +31,8 @@ class vtkLookupTable;
 class vtkGlyph3D;
 class vtkArrowSource;
 class vtkReverseSense;
+class vtkTransformPolyDataFilter;
+class vtkMitkPlaneIntersectingCellsFilter;
 
 namespace mitk
 {
@@ -42,7 +44,9 @@ namespace mitk
     * The mapper uses a vtkCutter filter to cut out slices (contours) of the 3D
     * volume and render these slices as vtkPolyData. The data is transformed
     * according to its geometry before cutting, to support the geometry concept
-    * of MITK.
+    * of MITK. The transformed data is kept until the surface or its geometry
+    * changes, and a vtkMitkPlaneIntersectingCellsFilter passes only the cells
+    * that intersect the plane to the cutter.
     *
     * Properties:
     * \b Surface.2D.Line Width: Thickness of the rendered lines in 2D.
@@ -107,6 +111,14 @@ namespace mitk
          * @brief m_Cutter Filter to cut out the 2D slice.
          */
       vtkSmartPointer<vtkCutter> m_Cutter;
+      /**
+         * @brief m_TransformFilter Transforms the data according to its geometry before cutting.
+         */
+      vtkSmartPointer<vtkTransformPolyDataFilter> m_TransformFilter;
+      /**
+         * @brief m_IntersectingCells Passes only the cells that intersect the cutting plane to the cutter.
+         */
+      vtkSmartPointer<vtkMitkPlaneIntersectingCellsFilter> m_IntersectingCells;
       /**
          * @brief m_CuttingPlane The plane where to cut off the 2D slice.
          */
@@ -0,0 +1,97 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __vtkMitkPlaneIntersectingCellsFilter_h
+#define __vtkMitkPlaneIntersectingCellsFilter_h
+
+#include <MitkCoreExports.h>
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+
+#include <vector>
+
+class vtkPlane;
+
+/** Documentation
+* \brief Extracts the cells of a vtkPolyData that intersect a plane.
+*
+* The output contains only the cells whose extent along the plane normal
+* contains the plane, together with the points they use. It is meant to be put
+* in front of a vtkCutter, which then only has to process these cells instead
+* of the whole surface.
+*
+* The extents of all cells along the normal are sorted into equally sized
+* buckets. This index is built on the first update and kept as long as the
+* input and the direction of the plane normal do not change, so moving the
+* plane along its normal (i.e. scrolling through slices) only visits the cells
+* of one bucket. Cells that span many buckets are kept in a separate list that
+* is checked on every update.
+*
+* \ingroup Renderer
+*/
+class MITKCORE_EXPORT vtkMitkPlaneIntersectingCellsFilter : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkMitkPlaneIntersectingCellsFilter *New();
+  vtkTypeMacro(vtkMitkPlaneIntersectingCellsFilter, vtkPolyDataAlgorithm);
+
+  /** \brief The plane that selects the cells. Usually the cut function of the following vtkCutter. */
+  void SetPlane(vtkPlane *plane);
+  vtkPlane *GetPlane();
+
+  /** \brief Includes the modification time of the plane. */
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkMitkPlaneIntersectingCellsFilter();
+  ~vtkMitkPlaneIntersectingCellsFilter() override;
+
+  int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
+
+  /** \brief Computes the extents of all cells along the normal and sorts them into buckets. */
+  void BuildIndex(vtkPolyData *input, const double normal[3]);
+
+  vtkSmartPointer<vtkPlane> m_Plane;
+
+  /** \brief Input, its modification time and normal the index was built for */
+  vtkPolyData *m_IndexedInput;
+  vtkMTimeType m_IndexedInputMTime;
+  double m_IndexedNormal[3];
+
+  /** \brief Cell array (0: verts, 1: lines, 2: polys, 3: strips) and traversal location of every cell */
+  std::vector<unsigned char> m_CellTypes;
+  std::vector<vtkIdType> m_CellLocations;
+  /** \brief Extent of every cell along the normal */
+  std::vector<double> m_CellMin;
+  std::vector<double> m_CellMax;
+
+  double m_RangeMin;
+  double m_BucketWidth;
+  /** \brief Cells of bucket i are m_BucketCells[m_BucketOffsets[i]] to m_BucketCells[m_BucketOffsets[i + 1] - 1] */
+  std::vector<vtkIdType> m_BucketOffsets;
+  std::vector<vtkIdType> m_BucketCells;
+  std::vector<vtkIdType> m_LargeCells;
+
+  /** \brief Maps input to output point ids during an update, -1 for unused points */
+  std::vector<vtkIdType> m_PointMap;
+
+private:
+  vtkMitkPlaneIntersectingCellsFilter(const vtkMitkPlaneIntersectingCellsFilter &); // Not implemented.
+  void operator=(const vtkMitkPlaneIntersectingCellsFilter &);                   // Not implemented.
+};
+
+#endif
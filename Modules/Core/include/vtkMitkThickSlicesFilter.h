@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <MitkCoreExports.h>
 
+#include "vtkSmartPointer.h"
 #include "vtkThreadedImageAlgorithm.h"
 
 class MITKCORE_EXPORT vtkMitkThickSlicesFilter : public vtkThreadedImageAlgorithm
@@ -50,6 +51,22 @@ public:
   vtkGetMacro(HandleBoundaries, int);
   vtkBooleanMacro(HandleBoundaries, int);
 
+  // Description:
+  // Get/Set whether the filter keeps a copy of the last input slab. If
+  // enabled, ShiftSlab() can move the slab by one slice.
+  vtkSetMacro(SlidingWindow, int);
+  vtkGetMacro(SlidingWindow, int);
+  vtkBooleanMacro(SlidingWindow, int);
+
+  // Description:
+  // Moves the cached slab by one slice: for direction > 0 the first slice
+  // is dropped and the given slice is appended, for direction < 0 the last
+  // slice is dropped and the given slice is inserted in front. Only the
+  // dropped slice is overwritten, the other slices are not copied. The next
+  // Update() projects the shifted slab. Returns 0 if there is no cached slab
+  // or the slice does not match it; a complete slab has to be set as input then.
+  int ShiftSlab(vtkImageData *slice, int direction);
+
   enum
   {
     MIP = 0,
@@ -80,6 +97,10 @@ protected:
 
   int m_CurrentMode;
 
+  int SlidingWindow;
+  vtkSmartPointer<vtkImageData> m_Slab;
+  int m_SlabStart;
+
 private:
   vtkMitkThickSlicesFilter(const vtkMitkThickSlicesFilter &); // Not implemented.
   void operator=(const vtkMitkThickSlicesFilter &);           // Not implemented.
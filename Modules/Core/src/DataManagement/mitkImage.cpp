@@ -30,7 +30,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkMutexLockHolder.h>
 
 // Other
+#include <algorithm>
 #include <cmath>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #define FILL_C_ARRAY(_arr, _size, _value)                                                                              \
   for (unsigned int i = 0u; i < _size; i++)                                                                            \
@@ -45,7 +51,9 @@ mitk::Image::Image()
     m_ImageDescriptor(nullptr),
     m_OffsetTable(nullptr),
     m_CompleteData(nullptr),
-    m_ImageStatistics(nullptr)
+    m_ImageStatistics(nullptr),
+    m_PendingWriters(0),
+    m_VolumeMemoryBudget(0)
 {
   m_Dimensions = new unsigned int[MAX_IMAGE_DIMENSIONS];
   FILL_C_ARRAY(m_Dimensions, MAX_IMAGE_DIMENSIONS, 0u);
@@ -60,7 +68,9 @@ mitk::Image::Image(const Image &other)
     m_ImageDescriptor(nullptr),
     m_OffsetTable(nullptr),
     m_CompleteData(nullptr),
-    m_ImageStatistics(nullptr)
+    m_ImageStatistics(nullptr),
+    m_PendingWriters(0),
+    m_VolumeMemoryBudget(0)
 {
   m_Dimensions = new unsigned int[MAX_IMAGE_DIMENSIONS];
   FILL_C_ARRAY(m_Dimensions, MAX_IMAGE_DIMENSIONS, 0u);
@@ -247,6 +257,9 @@ const vtkImageData *mitk::Image::GetVtkImageData(int t, int n) const
 mitk::Image::ImageDataItemPointer mitk::Image::GetSliceData(
   int s, int t, int n, void *data, ImportMemoryManagementType importMemoryManagement) const
 {
+  // a provided volume is loaded before the data arrays are locked and kept resident by this reference
+  ImageDataItemPointer providedVolume = IsValidSlice(s, t, n) ? LoadProvidedVolume(t, n) : nullptr;
+
   MutexHolder lock(m_ImageDataArraysLock);
   return GetSliceData_unlocked(s, t, n, data, importMemoryManagement);
 }
@@ -332,6 +345,9 @@ mitk::Image::ImageDataItemPointer mitk::Image::GetVolumeData(int t,
                                                              void *data,
                                                              ImportMemoryManagementType importMemoryManagement) const
 {
+  // a provided volume is loaded before the data arrays are locked and kept resident by this reference
+  ImageDataItemPointer providedVolume = IsValidVolume(t, n) ? LoadProvidedVolume(t, n) : nullptr;
+
   MutexHolder lock(m_ImageDataArraysLock);
   return GetVolumeData_unlocked(t, n, data, importMemoryManagement);
 }
@@ -347,7 +363,11 @@ mitk::Image::ImageDataItemPointer mitk::Image::GetVolumeData_unlocked(
   int pos = GetVolumeIndex(t, n);
   vol = m_Volumes[pos];
   if ((vol.GetPointer() != nullptr) && (vol->IsComplete()))
+  {
+    if (m_VolumeProvider.IsNotNull())
+      TouchProvidedVolume_unlocked(pos);
     return vol;
+  }
 
   const size_t ptypeSize = this->m_ImageDescriptor->GetChannelTypeById(n).GetSize();
 
@@ -462,6 +482,16 @@ mitk::Image::ImageDataItemPointer mitk::Image::GetChannelData(int n,
                                                               void *data,
                                                               ImportMemoryManagementType importMemoryManagement) const
 {
+  // provided volumes are loaded before the data arrays are locked and kept resident by these references
+  std::vector<ImageDataItemPointer> providedVolumes;
+  if (GetVolumeProvider() != nullptr && IsValidChannel(n))
+  {
+    for (unsigned int t = 0; t < m_Dimensions[3]; ++t)
+    {
+      providedVolumes.push_back(LoadProvidedVolume(t, n));
+    }
+  }
+
   MutexHolder lock(m_ImageDataArraysLock);
   return GetChannelData_unlocked(n, data, importMemoryManagement);
 }
@@ -539,6 +569,11 @@ mitk::Image::ImageDataItemPointer mitk::Image::GetChannelData_unlocked(
       //   if(ch->GetPicDescriptor()->info->tags_head==nullptr)
       //     mitkIpFuncCopyTags(ch->GetPicDescriptor(), m_Volumes[GetVolumeIndex(0,n)]->GetPicDescriptor());
     }
+
+    // the channel now holds the data of all provided volumes, they must stay resident
+    if (m_VolumeProvider.IsNotNull())
+      PinProvidedChannel_unlocked(n);
+
     return m_Channels[n] = ch;
   }
 
@@ -600,7 +635,9 @@ bool mitk::Image::IsSliceSet_unlocked(int s, int t, int n) const
   {
     return true;
   }
-  return false;
+
+  // slice can be loaded on demand as part of its volume
+  return m_VolumeProvider.IsNotNull();
 }
 
 bool mitk::Image::IsVolumeSet(int t, int n) const
@@ -625,6 +662,10 @@ bool mitk::Image::IsVolumeSet_unlocked(int t, int n) const
   if ((ch.GetPointer() != nullptr) && (ch->IsComplete()))
     return true;
 
+  // volume can be loaded on demand?
+  if (m_VolumeProvider.IsNotNull())
+    return true;
+
   // let's see if all slices of the volume are set, so that we can (could) combine them to a volume
   unsigned int s;
   for (s = 0; s < m_Dimensions[2]; ++s)
@@ -664,6 +705,184 @@ bool mitk::Image::IsChannelSet_unlocked(int n) const
   return true;
 }
 
+mitk::ImageAccessorReaderShard &mitk::Image::GetReaderShardOfCurrentThread() const
+{
+  const size_t hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return m_ReaderShards[hash % m_ReaderShards.size()];
+}
+
+void mitk::Image::SetVolumeProvider(ImageVolumeProvider *provider, size_t memoryBudget)
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+
+  m_VolumeProvider = provider;
+  m_VolumeMemoryBudget = memoryBudget;
+
+  if (m_VolumeProvider.IsNull())
+  {
+    // volumes loaded so far simply stay resident
+    m_ProvidedVolumes.clear();
+  }
+  else
+  {
+    ReleaseProvidedVolumes_unlocked();
+  }
+}
+
+mitk::ImageVolumeProvider *mitk::Image::GetVolumeProvider() const
+{
+  return m_VolumeProvider;
+}
+
+size_t mitk::Image::GetProvidedVolumesMemorySize() const
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+
+  size_t size = 0;
+  for (int pos : m_ProvidedVolumes)
+  {
+    size += m_Volumes[pos]->GetSize();
+  }
+  return size;
+}
+
+mitk::Image::ImageDataItemPointer mitk::Image::LoadProvidedVolume(int t, int n) const
+{
+  const int pos = GetVolumeIndex(t, n);
+  ImageVolumeProvider::Pointer provider;
+  std::shared_ptr<std::mutex> loadLock;
+  {
+    MutexHolder lock(m_ImageDataArraysLock);
+    if (m_VolumeProvider.IsNull())
+      return nullptr;
+
+    ImageDataItemPointer vol = m_Volumes[pos];
+    if ((vol.GetPointer() != nullptr) && (vol->IsComplete()))
+    {
+      TouchProvidedVolume_unlocked(pos);
+      return vol;
+    }
+
+    // the volume is part of a complete channel, nothing to load
+    if ((m_Channels[n].GetPointer() != nullptr) && (m_Channels[n]->IsComplete()))
+      return nullptr;
+
+    provider = m_VolumeProvider;
+    std::shared_ptr<std::mutex> &volumeLoadLock = m_ProvidedVolumeLoadLocks[pos];
+    if (!volumeLoadLock)
+      volumeLoadLock = std::make_shared<std::mutex>();
+    loadLock = volumeLoadLock;
+  }
+
+  // only one thread loads a volume, the others wait for it. Other volumes stay accessible meanwhile.
+  std::lock_guard<std::mutex> loadLockHolder(*loadLock);
+  {
+    MutexHolder lock(m_ImageDataArraysLock);
+    ImageDataItemPointer vol = m_Volumes[pos];
+    if ((vol.GetPointer() != nullptr) && (vol->IsComplete()))
+    {
+      TouchProvidedVolume_unlocked(pos);
+      return vol;
+    }
+  }
+
+  mitk::PixelType chPixelType = this->m_ImageDescriptor->GetChannelTypeById(n);
+  ImageDataItemPointer vol = new ImageDataItem(chPixelType, t, 3, m_Dimensions, nullptr, true);
+  provider->LoadVolume(t, n, vol->m_Data);
+  vol->SetComplete(true);
+
+  MutexHolder lock(m_ImageDataArraysLock);
+  // the volume may have been set meanwhile, e.g. by SetImportVolume()
+  ImageDataItemPointer &published = m_Volumes[pos];
+  if ((published.GetPointer() != nullptr) && (published->IsComplete()))
+    return published;
+
+  published = vol;
+  m_ProvidedVolumes.push_front(pos);
+  ReleaseProvidedVolumes_unlocked();
+
+  return vol;
+}
+
+void mitk::Image::TouchProvidedVolume_unlocked(int pos) const
+{
+  auto iter = std::find(m_ProvidedVolumes.begin(), m_ProvidedVolumes.end(), pos);
+  if (iter != m_ProvidedVolumes.end() && iter != m_ProvidedVolumes.begin())
+  {
+    m_ProvidedVolumes.splice(m_ProvidedVolumes.begin(), m_ProvidedVolumes, iter);
+  }
+}
+
+void mitk::Image::ReleaseProvidedVolumes_unlocked() const
+{
+  if (m_VolumeMemoryBudget == 0 || m_ProvidedVolumes.size() < 2)
+    return;
+
+  size_t residentSize = 0;
+  for (int pos : m_ProvidedVolumes)
+  {
+    residentSize += m_Volumes[pos]->GetSize();
+  }
+
+  // walk from the least recently used volume towards the front, but never release
+  // the most recently used one: it has just been requested
+  auto iter = std::prev(m_ProvidedVolumes.end());
+  while (residentSize > m_VolumeMemoryBudget && iter != m_ProvidedVolumes.begin())
+  {
+    const int pos = *iter;
+    const int t = pos % m_Dimensions[3];
+    const int n = pos / m_Dimensions[3];
+    ImageDataItemPointer &vol = m_Volumes[pos];
+
+    // a volume may only be released if nobody but the image (and its own slices) references it
+    bool releasable = vol->m_VtkImageData == nullptr;
+    int sliceReferences = 0;
+    for (unsigned int s = 0; s < m_Dimensions[2] && releasable; ++s)
+    {
+      const ImageDataItemPointer &sl = m_Slices[GetSliceIndex(s, t, n)];
+      if (sl.GetPointer() != nullptr && sl->m_Parent.GetPointer() == vol.GetPointer())
+      {
+        releasable = sl->GetReferenceCount() == 1 && sl->m_VtkImageData == nullptr;
+        ++sliceReferences;
+      }
+    }
+    releasable = releasable && vol->GetReferenceCount() == 1 + sliceReferences;
+
+    if (releasable)
+    {
+      for (unsigned int s = 0; s < m_Dimensions[2]; ++s)
+      {
+        ImageDataItemPointer &sl = m_Slices[GetSliceIndex(s, t, n)];
+        if (sl.GetPointer() != nullptr && sl->m_Parent.GetPointer() == vol.GetPointer())
+          sl = nullptr;
+      }
+      residentSize -= vol->GetSize();
+      vol = nullptr;
+      iter = m_ProvidedVolumes.erase(iter);
+    }
+    --iter;
+  }
+}
+
+void mitk::Image::PinProvidedVolume(const ImageDataItem *item) const
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+
+  if (m_ProvidedVolumes.empty() || item == nullptr)
+    return;
+
+  // the item is either a provided volume itself or a slice of it
+  const ImageDataItem *volume = item->GetDimension() == 2 ? item->m_Parent.GetPointer() : item;
+
+  m_ProvidedVolumes.remove_if([this, volume](int pos) { return m_Volumes[pos].GetPointer() == volume; });
+}
+
+void mitk::Image::PinProvidedChannel_unlocked(int n) const
+{
+  const int dimT = m_Dimensions[3];
+  m_ProvidedVolumes.remove_if([n, dimT](int pos) { return pos / dimT == n; });
+}
+
 bool mitk::Image::SetSlice(const void *data, int s, int t, int n)
 {
   // const_cast is no risk for ImportMemoryManagementType == CopyMemory
@@ -692,6 +911,7 @@ bool mitk::Image::SetImportSlice(void *data, int s, int t, int n, ImportMemoryMa
   if (IsSliceSet(s, t, n))
   {
     sl = GetSliceData(s, t, n, data, importMemoryManagement);
+    PinProvidedVolume(sl);
     if (sl->GetManageMemory() == false)
     {
       sl = AllocateSliceData(s, t, n, data, importMemoryManagement);
@@ -727,6 +947,7 @@ bool mitk::Image::SetImportVolume(void *data, int t, int n, ImportMemoryManageme
   if (IsVolumeSet(t, n))
   {
     vol = GetVolumeData(t, n, data, importMemoryManagement);
+    PinProvidedVolume(vol);
     if (vol->GetManageMemory() == false)
     {
       vol = AllocateVolumeData(t, n, data, importMemoryManagement);
@@ -821,6 +1042,10 @@ void mitk::Image::Initialize()
   }
   m_CompleteData = nullptr;
 
+  m_VolumeProvider = nullptr;
+  m_ProvidedVolumes.clear();
+  m_ProvidedVolumeLoadLocks.clear();
+
   if (m_ImageStatistics == nullptr)
   {
     m_ImageStatistics = new mitk::ImageStatisticsHolder(this);
@@ -173,6 +173,15 @@ void mitk::ImageAccessorBase::WaitForReleaseOf(ImageAccessorWaitLock *wL)
   }
 }
 
+bool mitk::ImageAccessorBase::IsRecursiveAccess(const mitk::ImageAccessorBase *iAB)
+{
+#ifdef MITK_USE_RECURSIVE_MUTEX_PREVENTION
+  return CompareThreadHandles(CurrentThreadHandle(), iAB->m_Thread);
+#else
+  return false;
+#endif
+}
+
 void mitk::ImageAccessorBase::PreventRecursiveMutexLock(mitk::ImageAccessorBase *iAB)
 {
 #ifdef MITK_USE_RECURSIVE_MUTEX_PREVENTION
@@ -18,8 +18,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkImage.h"
 
+#include <algorithm>
+
 mitk::ImageReadAccessor::ImageReadAccessor(ImageConstPointer image, const mitk::ImageDataItem *iDI, int OptionFlags)
-  : ImageAccessorBase(image, iDI, OptionFlags), m_Image(image)
+  : ImageAccessorBase(image, iDI, OptionFlags), m_Image(image), m_ImageDataItem(iDI), m_ReaderShard(nullptr)
 {
   if (!(OptionFlags & ImageAccessorBase::IgnoreLock))
   {
@@ -36,7 +38,7 @@ mitk::ImageReadAccessor::ImageReadAccessor(ImageConstPointer image, const mitk::
 }
 
 mitk::ImageReadAccessor::ImageReadAccessor(ImagePointer image, const mitk::ImageDataItem *iDI, int OptionFlags)
-  : ImageAccessorBase(image.GetPointer(), iDI, OptionFlags), m_Image(image.GetPointer())
+  : ImageAccessorBase(image.GetPointer(), iDI, OptionFlags), m_Image(image.GetPointer()), m_ImageDataItem(iDI), m_ReaderShard(nullptr)
 {
   if (!(OptionFlags & ImageAccessorBase::IgnoreLock))
   {
@@ -53,14 +55,33 @@ mitk::ImageReadAccessor::ImageReadAccessor(ImagePointer image, const mitk::Image
 }
 
 mitk::ImageReadAccessor::ImageReadAccessor(const mitk::Image *image, const ImageDataItem *iDI)
-  : ImageAccessorBase(image, iDI, ImageAccessorBase::DefaultBehavior), m_Image(image)
+  : ImageAccessorBase(image, iDI, ImageAccessorBase::DefaultBehavior), m_Image(image), m_ImageDataItem(iDI), m_ReaderShard(nullptr)
 {
   OrganizeReadAccess();
 }
 
 mitk::ImageReadAccessor::~ImageReadAccessor()
 {
-  if (!(m_Options & ImageAccessorBase::IgnoreLock))
+  if (m_ReaderShard != nullptr)
+  {
+    std::lock_guard<std::mutex> lock(m_ReaderShard->m_Mutex);
+
+    // delete self from the reader bucket
+    auto it = std::find(m_ReaderShard->m_Readers.begin(), m_ReaderShard->m_Readers.end(), this);
+    m_ReaderShard->m_Readers.erase(it);
+
+    // delete lock, if there are no waiting ImageAccessors
+    if (m_WaitLock->m_WaiterCount <= 0)
+    {
+      m_WaitLock->m_Mutex.Unlock();
+      delete m_WaitLock;
+    }
+    else
+    {
+      m_WaitLock->m_Mutex.Unlock();
+    }
+  }
+  else if (!(m_Options & ImageAccessorBase::IgnoreLock))
   {
     // Future work: In case of non-coherent memory, copied area needs to be deleted
 
@@ -94,8 +115,56 @@ const mitk::Image *mitk::ImageReadAccessor::GetImage() const
   return m_Image.GetPointer();
 }
 
+bool mitk::ImageReadAccessor::OrganizeFastReadAccess()
+{
+  if (m_Image->m_PendingWriters != 0)
+  {
+    return false;
+  }
+
+  ImageAccessorReaderShard &shard = m_Image->GetReaderShardOfCurrentThread();
+
+  {
+    std::lock_guard<std::mutex> lock(shard.m_Mutex);
+    m_WaitLock->m_Mutex.Lock();
+    shard.m_Readers.push_back(this);
+  }
+
+  // A write accessor announces itself before it inspects the reader buckets. So either it
+  // finds this accessor in the bucket or we see the announcement here and step back.
+  if (m_Image->m_PendingWriters == 0)
+  {
+    m_ReaderShard = &shard;
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(shard.m_Mutex);
+
+  auto it = std::find(shard.m_Readers.begin(), shard.m_Readers.end(), this);
+  shard.m_Readers.erase(it);
+
+  if (m_WaitLock->m_WaiterCount <= 0)
+  {
+    m_WaitLock->m_Mutex.Unlock();
+  }
+  else
+  {
+    // the waiting write accessor owns the old lock now and deletes it when done
+    m_WaitLock->m_Mutex.Unlock();
+    m_WaitLock = new ImageAccessorWaitLock();
+    m_WaitLock->m_WaiterCount = 0;
+  }
+
+  return false;
+}
+
 void mitk::ImageReadAccessor::OrganizeReadAccess()
 {
+  if (OrganizeFastReadAccess())
+  {
+    return;
+  }
+
   m_Image->m_ReadWriteLock.Lock();
 
   // Check, if there is any Write-Access going on
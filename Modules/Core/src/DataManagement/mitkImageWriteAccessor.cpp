@@ -20,7 +20,22 @@ mitk::ImageWriteAccessor::ImageWriteAccessor(ImagePointer image, const mitk::Ima
   : ImageAccessorBase(image.GetPointer(), iDI, OptionFlags), m_Image(image)
 
 {
-  OrganizeWriteAccess();
+  // announce the write access, so that new read accessors do not take the fast path anymore
+  ++m_Image->m_PendingWriters;
+
+  try
+  {
+    OrganizeWriteAccess();
+  }
+  catch (...)
+  {
+    --m_Image->m_PendingWriters;
+    delete m_WaitLock;
+    throw;
+  }
+
+  // written volumes must not be released and re-loaded by a volume provider
+  m_Image->PinProvidedVolume(iDI);
 }
 
 mitk::ImageWriteAccessor::~ImageWriteAccessor()
@@ -46,6 +61,8 @@ mitk::ImageWriteAccessor::~ImageWriteAccessor()
   }
 
   m_Image->m_ReadWriteLock.Unlock();
+
+  --m_Image->m_PendingWriters;
 }
 
 const mitk::Image *mitk::ImageWriteAccessor::GetImage() const
@@ -112,6 +129,48 @@ void mitk::ImageWriteAccessor::OrganizeWriteAccess()
     }   // for
   }     // if
 
+  // Check the read accessors which were granted access on the fast path before this write access was announced
+  if (!readOverlap && !writeOverlap)
+  {
+    for (auto &shard : m_Image->m_ReaderShards)
+    {
+      std::unique_lock<std::mutex> shardLock(shard.m_Mutex);
+
+      for (ImageAccessorBase *r : shard.m_Readers)
+      {
+        if ((r->m_Options & IgnoreLock) == 0 && Overlap(r))
+        {
+          if (IsRecursiveAccess(r))
+          {
+            shardLock.unlock();
+            m_Image->m_ReadWriteLock.Unlock();
+            mitkThrow() << "Prohibited image access: the requested image part is already in use and cannot be "
+                           "requested recursively!";
+          }
+
+          if (m_Options & ExceptionIfLocked)
+          {
+            shardLock.unlock();
+            m_Image->m_ReadWriteLock.Unlock();
+            mitkThrowException(mitk::MemoryIsLockedException)
+              << "The image part being ordered by the ImageAccessor is already in use and locked";
+          }
+
+          // WAIT (the waiter count of fast path readers is guarded by the bucket mutex)
+          ImageAccessorWaitLock *readerLock = r->m_WaitLock;
+          readerLock->m_WaiterCount += 1;
+          shardLock.unlock();
+          m_Image->m_ReadWriteLock.Unlock();
+          ImageAccessorBase::WaitForReleaseOf(readerLock);
+
+          // after waiting for the ImageAccessor, start this method again
+          OrganizeWriteAccess();
+          return;
+        }
+      }
+    }
+  }
+
   if (readOverlap || writeOverlap)
   {
     // Throw an exception or wait for the WriteAccessor w until it is released and start again with the request
@@ -16,13 +16,36 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkStandaloneDataStorage.h"
 
+#include "itkCommand.h"
 #include "itkMutexLockHolder.h"
 #include "itkSimpleFastMutexLock.h"
 #include "mitkDataNode.h"
 #include "mitkGroupTagProperty.h"
+#include "mitkNodePredicateAnd.h"
 #include "mitkNodePredicateBase.h"
+#include "mitkNodePredicateDataType.h"
+#include "mitkNodePredicateDataUID.h"
+#include "mitkNodePredicateOr.h"
 #include "mitkNodePredicateProperty.h"
 #include "mitkProperties.h"
+#include "mitkStringProperty.h"
+
+#include <unordered_set>
+
+namespace
+{
+  template <typename TNodeIndex>
+  void RemoveFromNodeIndex(TNodeIndex &index, const std::string &key, const mitk::DataNode *node)
+  {
+    auto bucketIter = index.find(key);
+    if (bucketIter == index.end())
+      return;
+
+    bucketIter->second.erase(node);
+    if (bucketIter->second.empty())
+      index.erase(bucketIter);
+  }
+}
 
 mitk::StandaloneDataStorage::StandaloneDataStorage() : mitk::DataStorage()
 {
@@ -34,6 +57,13 @@ mitk::StandaloneDataStorage::~StandaloneDataStorage()
   {
     this->RemoveListeners(it->first);
   }
+
+  for (auto it = m_NodeIndexEntries.begin(); it != m_NodeIndexEntries.end(); ++it)
+  {
+    const_cast<mitk::DataNode *>(it->first)->RemoveObserver(it->second.NodeObserverTag);
+    if (it->second.NameProperty.IsNotNull())
+      it->second.NameProperty->RemoveObserver(it->second.NamePropertyObserverTag);
+  }
 }
 
 bool mitk::StandaloneDataStorage::IsInitialized() const
@@ -85,6 +115,8 @@ void mitk::StandaloneDataStorage::Add(mitk::DataNode *node, const mitk::DataStor
 
     // register for ITK changed events
     this->AddListeners(node);
+
+    this->AddToIndex(node);
   }
 
   /* Notify observers */
@@ -116,6 +148,8 @@ void mitk::StandaloneDataStorage::Remove(const mitk::DataNode *node)
     /* remove node from both relation adjacency lists */
     this->RemoveFromRelation(node, m_SourceNodes);
     this->RemoveFromRelation(node, m_DerivedNodes);
+
+    this->RemoveFromIndex(node);
   }
 }
 
@@ -184,17 +218,20 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
       return this->FilterSetOfObjects(it->second, condition);
   }
 
-  /* Or traverse adjacency list to collect all related nodes */
-  std::vector<mitk::DataNode::ConstPointer> resultset;
-  std::vector<mitk::DataNode::ConstPointer> openlist;
+  /* Or traverse adjacency list to collect all related nodes. All nodes are kept alive by the adjacency
+     list while the caller holds m_Mutex, so plain pointers are sufficient here */
+  std::vector<const mitk::DataNode *> resultset;
+  std::vector<const mitk::DataNode *> openlist;
+  std::unordered_set<const mitk::DataNode *> visited; // nodes that are either in resultset or in openlist
 
   /* Initialize openlist with node. this will add node to resultset,
      but that is necessary to detect circular relations that would lead to endless recursion */
   openlist.push_back(node);
+  visited.insert(node);
 
   while (openlist.size() > 0)
   {
-    mitk::DataNode::ConstPointer current = openlist.back();    // get element that needs to be processed
+    const mitk::DataNode *current = openlist.back();           // get element that needs to be processed
     openlist.pop_back();                                       // remove last element, because it gets processed now
     resultset.push_back(current);                              // add current element to resultset
     auto it = relation.find(current); // get parents of current node
@@ -208,12 +245,9 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
       for (SetOfObjects::ConstIterator parentIt = it->second->Begin(); parentIt != it->second->End();
            ++parentIt) // for each parent of current node
       {
-        mitk::DataNode::ConstPointer p = parentIt.Value().GetPointer();
-        if (!(std::find(resultset.cbegin(), resultset.cend(), p) !=
-              resultset.end()) // if it is not already in resultset
-            &&
-            !(std::find(openlist.cbegin(), openlist.cend(), p) != openlist.cend())) // and not already in openlist
-          openlist.push_back(p); // then add it to openlist, so that it can be processed
+        const mitk::DataNode *p = parentIt.Value().GetPointer();
+        if (visited.insert(p).second) // if it is neither in resultset nor in openlist
+          openlist.push_back(p);      // then add it to openlist, so that it can be processed
       }
   }
 
@@ -227,7 +261,7 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
          ++resultIt)
       if ((*resultIt != node) && (condition->CheckNode(*resultIt) == true))
         realResultset->InsertElement(realResultset->Size(),
-                                     mitk::DataNode::Pointer(const_cast<mitk::DataNode *>((*resultIt).GetPointer())));
+                                     mitk::DataNode::Pointer(const_cast<mitk::DataNode *>(*resultIt)));
   }
   else
   {
@@ -236,7 +270,7 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
          ++resultIt)
       if (*resultIt != node)
         realResultset->InsertElement(realResultset->Size(),
-                                     mitk::DataNode::Pointer(const_cast<mitk::DataNode *>((*resultIt).GetPointer())));
+                                     mitk::DataNode::Pointer(const_cast<mitk::DataNode *>(*resultIt)));
   }
   return SetOfObjects::ConstPointer(realResultset);
 }
@@ -244,15 +278,285 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSources(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectSources) const
 {
-  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
-  return this->GetRelations(node, m_SourceNodes, condition, onlyDirectSources);
+  SetOfObjects::ConstPointer sources;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    sources = this->GetRelations(node, m_SourceNodes, nullptr, onlyDirectSources);
+  }
+  // evaluate the condition without holding m_Mutex: predicates may trigger modified events of the
+  // nodes, which are handled by OnIndexedNodeModified()
+  return this->FilterSetOfObjects(sources, condition);
 }
 
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetDerivations(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectDerivations) const
 {
+  SetOfObjects::ConstPointer derivations;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    derivations = this->GetRelations(node, m_DerivedNodes, nullptr, onlyDirectDerivations);
+  }
+  return this->FilterSetOfObjects(derivations, condition);
+}
+
+mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSubset(
+  const NodePredicateBase *condition) const
+{
+  if (condition == nullptr)
+    return Superclass::GetSubset(condition);
+
+  SetOfObjects::Pointer candidates = SetOfObjects::New();
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    NodeIndexBucket indexedCandidates;
+    if (this->CollectIndexedCandidates(condition, indexedCandidates))
+    {
+      for (auto it = indexedCandidates.cbegin(); it != indexedCandidates.cend(); ++it)
+        candidates->InsertElement(candidates->Size(), const_cast<mitk::DataNode *>(*it));
+    }
+    else
+    {
+      candidates = nullptr;
+    }
+  }
+
+  if (candidates.IsNull())
+    return Superclass::GetSubset(condition);
+
+  /* the index only narrows down the candidates, the complete condition is checked for each of them */
+  return this->FilterSetOfObjects(candidates, condition);
+}
+
+bool mitk::StandaloneDataStorage::CollectIndexedCandidates(const NodePredicateBase *condition,
+                                                           NodeIndexBucket &candidates) const
+{
+  if (const auto *dataTypePredicate = dynamic_cast<const NodePredicateDataType *>(condition))
+  {
+    auto bucketIter = m_DataTypeIndex.find(dataTypePredicate->GetValidDataType());
+    if (bucketIter != m_DataTypeIndex.cend())
+      candidates = bucketIter->second;
+    return true;
+  }
+
+  if (const auto *uidPredicate = dynamic_cast<const NodePredicateDataUID *>(condition))
+  {
+    /* SetUID() does not emit any event, so a UID that is not indexed could have been assigned after
+       the node was added. Fall back to checking all nodes in this case. */
+    auto bucketIter = m_DataUIDIndex.find(uidPredicate->GetUID());
+    if (bucketIter == m_DataUIDIndex.cend())
+      return false;
+    candidates = bucketIter->second;
+    return true;
+  }
+
+  if (const auto *propertyPredicate = dynamic_cast<const NodePredicateProperty *>(condition))
+  {
+    const auto *validName = dynamic_cast<const StringProperty *>(propertyPredicate->GetValidProperty());
+    if (validName == nullptr || propertyPredicate->GetRenderer() != nullptr ||
+        propertyPredicate->GetValidPropertyName() != "name")
+      return false;
+
+    candidates = m_UnnamedNodes;
+    auto bucketIter = m_NameIndex.find(validName->GetValue());
+    if (bucketIter != m_NameIndex.cend())
+      candidates.insert(bucketIter->second.cbegin(), bucketIter->second.cend());
+    return true;
+  }
+
+  if (const auto *andPredicate = dynamic_cast<const NodePredicateAnd *>(condition))
+  {
+    /* a conjunction is restricted by its most selective indexed child */
+    bool restricted = false;
+    const NodePredicateCompositeBase::ChildPredicates children = andPredicate->GetPredicates();
+    for (auto it = children.cbegin(); it != children.cend(); ++it)
+    {
+      NodeIndexBucket childCandidates;
+      if (this->CollectIndexedCandidates(*it, childCandidates) &&
+          (!restricted || childCandidates.size() < candidates.size()))
+      {
+        candidates.swap(childCandidates);
+        restricted = true;
+      }
+    }
+    return restricted;
+  }
+
+  if (const auto *orPredicate = dynamic_cast<const NodePredicateOr *>(condition))
+  {
+    /* a disjunction is only restricted if all of its children are */
+    const NodePredicateCompositeBase::ChildPredicates children = orPredicate->GetPredicates();
+    if (children.empty())
+      return false;
+
+    for (auto it = children.cbegin(); it != children.cend(); ++it)
+    {
+      NodeIndexBucket childCandidates;
+      if (!this->CollectIndexedCandidates(*it, childCandidates))
+        return false;
+      candidates.insert(childCandidates.cbegin(), childCandidates.cend());
+    }
+    return true;
+  }
+
+  return false;
+}
+
+void mitk::StandaloneDataStorage::AddToIndex(const mitk::DataNode *node)
+{
+  if (node == nullptr)
+    return;
+
+  NodeIndexEntry &entry = m_NodeIndexEntries[node];
+
+  itk::MemberCommand<mitk::StandaloneDataStorage>::Pointer nodeModifiedCommand =
+    itk::MemberCommand<mitk::StandaloneDataStorage>::New();
+  nodeModifiedCommand->SetCallbackFunction(this, &mitk::StandaloneDataStorage::OnIndexedNodeModified);
+  entry.NodeObserverTag =
+    const_cast<mitk::DataNode *>(node)->AddObserver(itk::ModifiedEvent(), nodeModifiedCommand);
+
+  this->UpdateIndex(node, entry);
+}
+
+void mitk::StandaloneDataStorage::RemoveFromIndex(const mitk::DataNode *node)
+{
+  auto entryIter = m_NodeIndexEntries.find(node);
+  if (entryIter == m_NodeIndexEntries.end())
+    return;
+
+  NodeIndexEntry &entry = entryIter->second;
+  const_cast<mitk::DataNode *>(node)->RemoveObserver(entry.NodeObserverTag);
+
+  if (entry.NameProperty.IsNotNull())
+  {
+    entry.NameProperty->RemoveObserver(entry.NamePropertyObserverTag);
+    auto owners = m_NamePropertyOwners.equal_range(entry.NameProperty.GetPointer());
+    for (auto ownerIter = owners.first; ownerIter != owners.second; ++ownerIter)
+      if (ownerIter->second == node)
+      {
+        m_NamePropertyOwners.erase(ownerIter);
+        break;
+      }
+  }
+
+  if (entry.HasName)
+    RemoveFromNodeIndex(m_NameIndex, entry.Name, node);
+  if (entry.HasData)
+  {
+    RemoveFromNodeIndex(m_DataTypeIndex, entry.DataType, node);
+    RemoveFromNodeIndex(m_DataUIDIndex, entry.DataUID, node);
+  }
+  m_UnnamedNodes.erase(node);
+
+  m_NodeIndexEntries.erase(entryIter);
+}
+
+void mitk::StandaloneDataStorage::UpdateIndex(const mitk::DataNode *node, NodeIndexEntry &entry)
+{
+  /* Only the node's own "name" property is indexed and observed. It takes precedence over
+     a "name" property of the data, which is only used if the node has none. */
+  BaseProperty *nameProperty = node->GetPropertyList()->GetProperty("name");
+
+  if (nameProperty != entry.NameProperty.GetPointer())
+  {
+    if (entry.NameProperty.IsNotNull())
+    {
+      entry.NameProperty->RemoveObserver(entry.NamePropertyObserverTag);
+      auto owners = m_NamePropertyOwners.equal_range(entry.NameProperty.GetPointer());
+      for (auto ownerIter = owners.first; ownerIter != owners.second; ++ownerIter)
+        if (ownerIter->second == node)
+        {
+          m_NamePropertyOwners.erase(ownerIter);
+          break;
+        }
+    }
+
+    entry.NameProperty = nameProperty;
+
+    if (nameProperty != nullptr)
+    {
+      itk::MemberCommand<mitk::StandaloneDataStorage>::Pointer namePropertyModifiedCommand =
+        itk::MemberCommand<mitk::StandaloneDataStorage>::New();
+      namePropertyModifiedCommand->SetCallbackFunction(this,
+                                                       &mitk::StandaloneDataStorage::OnIndexedNamePropertyModified);
+      entry.NamePropertyObserverTag = nameProperty->AddObserver(itk::ModifiedEvent(), namePropertyModifiedCommand);
+      m_NamePropertyOwners.insert(std::make_pair(nameProperty, node));
+    }
+  }
+
+  if (nameProperty == nullptr)
+    m_UnnamedNodes.insert(node);
+  else
+    m_UnnamedNodes.erase(node);
+
+  const auto *nameStringProperty = dynamic_cast<const StringProperty *>(nameProperty);
+  const bool hasName = nameStringProperty != nullptr;
+  const std::string name = hasName ? nameStringProperty->GetValue() : "";
+
+  if (hasName != entry.HasName || name != entry.Name)
+  {
+    if (entry.HasName)
+      RemoveFromNodeIndex(m_NameIndex, entry.Name, node);
+    if (hasName)
+      m_NameIndex[name].insert(node);
+    entry.HasName = hasName;
+    entry.Name = name;
+  }
+
+  const BaseData *data = node->GetData();
+  const bool hasData = data != nullptr;
+  const std::string dataType = hasData ? data->GetNameOfClass() : "";
+  const std::string dataUID = hasData ? data->GetUID() : "";
+
+  if (hasData != entry.HasData || dataType != entry.DataType || dataUID != entry.DataUID)
+  {
+    if (entry.HasData)
+    {
+      RemoveFromNodeIndex(m_DataTypeIndex, entry.DataType, node);
+      RemoveFromNodeIndex(m_DataUIDIndex, entry.DataUID, node);
+    }
+    if (hasData)
+    {
+      m_DataTypeIndex[dataType].insert(node);
+      m_DataUIDIndex[dataUID].insert(node);
+    }
+    entry.HasData = hasData;
+    entry.DataType = dataType;
+    entry.DataUID = dataUID;
+  }
+}
+
+void mitk::StandaloneDataStorage::OnIndexedNodeModified(const itk::Object *caller, const itk::EventObject &)
+{
+  const auto *node = dynamic_cast<const mitk::DataNode *>(caller);
+  if (node == nullptr)
+    return;
+
   itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
-  return this->GetRelations(node, m_DerivedNodes, condition, onlyDirectDerivations);
+  auto entryIter = m_NodeIndexEntries.find(node);
+  if (entryIter != m_NodeIndexEntries.end())
+    this->UpdateIndex(node, entryIter->second);
+}
+
+void mitk::StandaloneDataStorage::OnIndexedNamePropertyModified(const itk::Object *caller, const itk::EventObject &)
+{
+  const auto *property = dynamic_cast<const BaseProperty *>(caller);
+  if (property == nullptr)
+    return;
+
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+
+  /* UpdateIndex() may change m_NamePropertyOwners, so collect the owners first */
+  std::vector<const mitk::DataNode *> owners;
+  auto ownerRange = m_NamePropertyOwners.equal_range(property);
+  for (auto ownerIter = ownerRange.first; ownerIter != ownerRange.second; ++ownerIter)
+    owners.push_back(ownerIter->second);
+
+  for (auto ownerIter = owners.cbegin(); ownerIter != owners.cend(); ++ownerIter)
+  {
+    auto entryIter = m_NodeIndexEntries.find(*ownerIter);
+    if (entryIter != m_NodeIndexEntries.end())
+      this->UpdateIndex(*ownerIter, entryIter->second);
+  }
 }
 
 void mitk::StandaloneDataStorage::PrintSelf(std::ostream &os, itk::Indent indent) const
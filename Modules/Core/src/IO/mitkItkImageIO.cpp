@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIPropertyPersistence.h>
 #include <mitkImage.h>
 #include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
 #include <mitkLocaleSwitch.h>
 
 #include <itkImage.h>
@@ -30,6 +31,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImageIOFactory.h>
 #include <itkImageIORegion.h>
 #include <itkMetaDataObject.h>
+#include <itkMutexLockHolder.h>
+#include <itkSimpleFastMutexLock.h>
 
 #include <algorithm>
 
@@ -124,6 +127,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultReaderOptions();
 
     std::vector<std::string> readExtensions = m_ImageIO->GetSupportedReadExtensions();
 
@@ -209,6 +213,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultReaderOptions();
 
     if (rank)
     {
@@ -219,6 +224,114 @@ namespace mitk
     this->RegisterService();
   }
 
+  std::string ItkImageIO::OPTION_STREAMING_READ()
+  {
+    static std::string s = "Streaming read";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_STREAMING_MEMORY_BUDGET()
+  {
+    static std::string s = "Streaming memory budget (MB)";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_ON_DEMAND_TIME_STEPS()
+  {
+    static std::string s = "Load time steps on demand";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_RESIDENT_MEMORY_BUDGET()
+  {
+    static std::string s = "Resident time steps budget (MB)";
+    return s;
+  }
+
+  namespace
+  {
+    /**Helper function that reads one time step of the file currently associated with imageIO
+     * into buffer. The time step is requested slab-wise via the IO region, each slab covering
+     * as many slices as fit into maxSlabBytes (but at least one slice).
+     * The imageIO must support streamed reading and ReadImageInformation() must have been called.*/
+    void ReadTimeStepSlabWise(itk::ImageIOBase *imageIO,
+                              unsigned int ndim,
+                              unsigned int timeStep,
+                              std::size_t maxSlabBytes,
+                              void *buffer)
+    {
+      itk::ImageIORegion ioRegion(ndim);
+      itk::ImageIORegion::SizeType ioSize = ioRegion.GetSize();
+      itk::ImageIORegion::IndexType ioStart = ioRegion.GetIndex();
+
+      for (unsigned int i = 0; i < ndim; ++i)
+      {
+        ioStart[i] = 0;
+        ioSize[i] = imageIO->GetDimensions(i);
+      }
+
+      if (ndim > 3)
+      {
+        ioStart[3] = timeStep;
+        ioSize[3] = 1;
+      }
+
+      const std::size_t sliceBytes = static_cast<std::size_t>(imageIO->GetComponentSize()) *
+                                     imageIO->GetNumberOfComponents() * imageIO->GetDimensions(0) *
+                                     imageIO->GetDimensions(1);
+      const unsigned int numberOfSlices = ndim > 2 ? imageIO->GetDimensions(2) : 1;
+
+      std::size_t slicesPerSlab = sliceBytes > 0 ? maxSlabBytes / sliceBytes : numberOfSlices;
+      slicesPerSlab = std::max<std::size_t>(1, std::min<std::size_t>(slicesPerSlab, numberOfSlices));
+
+      auto *target = static_cast<unsigned char *>(buffer);
+
+      for (unsigned int slice = 0; slice < numberOfSlices; slice += slicesPerSlab)
+      {
+        if (ndim > 2)
+        {
+          ioStart[2] = slice;
+          ioSize[2] = std::min<std::size_t>(slicesPerSlab, numberOfSlices - slice);
+        }
+
+        ioRegion.SetSize(ioSize);
+        ioRegion.SetIndex(ioStart);
+
+        imageIO->SetIORegion(ioRegion);
+        imageIO->Read(target + slice * sliceBytes);
+      }
+    }
+
+    /**Volume provider that streams single time steps of a file on demand. It uses its own
+     * clone of the ITK ImageIO, so it is independent of the reader that created it.*/
+    class ItkImageIOVolumeProvider : public ImageVolumeProvider
+    {
+    public:
+      mitkClassMacro(ItkImageIOVolumeProvider, ImageVolumeProvider);
+      mitkNewMacro3Param(Self, const itk::ImageIOBase *, const std::string &, std::size_t);
+
+      void LoadVolume(unsigned int t, unsigned int, void *buffer) override
+      {
+        itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+        ReadTimeStepSlabWise(m_ImageIO, m_ImageIO->GetNumberOfDimensions(), t, m_MaxSlabBytes, buffer);
+      }
+
+    protected:
+      ItkImageIOVolumeProvider(const itk::ImageIOBase *imageIO, const std::string &path, std::size_t maxSlabBytes)
+        : m_ImageIO(dynamic_cast<itk::ImageIOBase *>(imageIO->Clone().GetPointer())), m_MaxSlabBytes(maxSlabBytes)
+      {
+        m_ImageIO->SetFileName(path);
+        m_ImageIO->ReadImageInformation();
+        m_ImageIO->SetUseStreamedReading(true);
+      }
+
+    private:
+      itk::ImageIOBase::Pointer m_ImageIO;
+      std::size_t m_MaxSlabBytes;
+      itk::SimpleFastMutexLock m_Mutex;
+    };
+  }
+
   /**Helper function that converts the content of a meta data into a time point vector.
    * If MetaData is not valid or cannot be converted an empty vector is returned.*/
   std::vector<TimePointType> ConvertMetaDataObjectToTimePointList(const itk::MetaDataObjectBase *data)
@@ -266,7 +379,8 @@ namespace mitk
     m_ImageIO->SetFileName(path);
     m_ImageIO->ReadImageInformation();
 
-    unsigned int ndim = m_ImageIO->GetNumberOfDimensions();
+    const unsigned int fileDimension = m_ImageIO->GetNumberOfDimensions();
+    unsigned int ndim = fileDimension;
     if (ndim < MINDIM || ndim > MAXDIM)
     {
       MITK_WARN << "Sorry, only dimensions 2, 3 and 4 are supported. The given file has " << ndim
@@ -314,13 +428,68 @@ namespace mitk
     ioRegion.SetSize(ioSize);
     ioRegion.SetIndex(ioStart);
 
-    MITK_INFO << "ioRegion: " << ioRegion << std::endl;
-    m_ImageIO->SetIORegion(ioRegion);
-    void *buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
-    m_ImageIO->Read(buffer);
+    bool streamingRead = false;
+    int streamingMemoryBudget = 0;
+    bool onDemandTimeSteps = false;
+    int residentMemoryBudget = 0;
+
+    try
+    {
+      streamingRead = us::any_cast<bool>(this->GetReaderOption(OPTION_STREAMING_READ()));
+      streamingMemoryBudget = us::any_cast<int>(this->GetReaderOption(OPTION_STREAMING_MEMORY_BUDGET()));
+      onDemandTimeSteps = us::any_cast<bool>(this->GetReaderOption(OPTION_ON_DEMAND_TIME_STEPS()));
+      residentMemoryBudget = us::any_cast<int>(this->GetReaderOption(OPTION_RESIDENT_MEMORY_BUDGET()));
+    }
+    catch (const us::BadAnyCastException &e)
+    {
+      MITK_WARN << "Unexpected error: " << e.what();
+    }
+
+    if (streamingRead && (fileDimension != ndim || ndim < 3 || !m_ImageIO->CanStreamRead()))
+    {
+      MITK_INFO << "ITK ImageIO " << m_ImageIO->GetNameOfClass()
+                << " cannot stream this file. Falling back to reading the whole image at once.";
+      streamingRead = false;
+    }
 
     image->Initialize(MakePixelType(m_ImageIO), ndim, dimensions);
-    image->SetImportChannel(buffer, 0, Image::ManageMemory);
+
+    if (streamingRead && onDemandTimeSteps && ndim > 3)
+    {
+      const std::size_t maxSlabBytes = static_cast<std::size_t>(std::max(1, streamingMemoryBudget)) * 1024 * 1024;
+      const std::size_t residentBytes = static_cast<std::size_t>(std::max(0, residentMemoryBudget)) * 1024 * 1024;
+
+      MITK_INFO << "loading " << dimensions[3] << " time steps on demand" << std::endl;
+
+      // Nothing is read here. Each time step is streamed from the file as soon as it is accessed.
+      image->SetVolumeProvider(ItkImageIOVolumeProvider::New(m_ImageIO, path, maxSlabBytes), residentBytes);
+    }
+    else if (streamingRead)
+    {
+      const std::size_t maxSlabBytes = static_cast<std::size_t>(std::max(1, streamingMemoryBudget)) * 1024 * 1024;
+      const unsigned int timeSteps = ndim > 3 ? dimensions[3] : 1;
+
+      MITK_INFO << "streaming " << timeSteps << " time step(s) in slabs of at most " << maxSlabBytes << " bytes"
+                << std::endl;
+      m_ImageIO->SetUseStreamedReading(true);
+
+      // Every time step is read directly into its own volume of the image. No buffer for the
+      // whole file is allocated and each volume is complete as soon as its last slab arrived.
+      for (unsigned int t = 0; t < timeSteps; ++t)
+      {
+        ImageWriteAccessor accessor(image, image->GetVolumeData(t));
+        ReadTimeStepSlabWise(m_ImageIO, ndim, t, maxSlabBytes, accessor.GetData());
+      }
+    }
+    else
+    {
+      MITK_INFO << "ioRegion: " << ioRegion << std::endl;
+      m_ImageIO->SetIORegion(ioRegion);
+      void *buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
+      m_ImageIO->Read(buffer);
+
+      image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    }
 
     const itk::MetaDataDictionary &dictionary = m_ImageIO->GetMetaDataDictionary();
 
@@ -410,7 +579,6 @@ namespace mitk
 
     image->SetTimeGeometry(timeGeometry);
 
-    buffer = nullptr;
     MITK_INFO << "number of image components: " << image->GetPixelType().GetNumberOfComponents() << std::endl;
 
     for (auto iter = dictionary.Begin(), iterEnd = dictionary.End(); iter != iterEnd;
@@ -700,4 +868,16 @@ namespace mitk
     this->m_DefaultMetaDataKeys.push_back(PROPERTY_NAME_TIMEGEOMETRY_TIMEPOINTS);
     this->m_DefaultMetaDataKeys.push_back("ITK.InputFilterName");
   }
+
+  void ItkImageIO::InitializeDefaultReaderOptions()
+  {
+    Options defaultOptions;
+
+    defaultOptions[OPTION_STREAMING_READ()] = us::Any(false);
+    defaultOptions[OPTION_STREAMING_MEMORY_BUDGET()] = us::Any(256);
+    defaultOptions[OPTION_ON_DEMAND_TIME_STEPS()] = us::Any(false);
+    defaultOptions[OPTION_RESIDENT_MEMORY_BUDGET()] = us::Any(0);
+
+    this->SetDefaultReaderOptions(defaultOptions);
+  }
 }
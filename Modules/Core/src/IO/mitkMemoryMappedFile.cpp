@@ -0,0 +1,124 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkMemoryMappedFile.h"
+#include <mitkExceptionMacro.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mitk::MemoryMappedFile::MemoryMappedFile()
+  : m_Data(nullptr)
+  , m_Size(0)
+#ifdef _WIN32
+  , m_File(INVALID_HANDLE_VALUE)
+  , m_Mapping(nullptr)
+#else
+  , m_File(-1)
+#endif
+{
+}
+
+mitk::MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Close();
+}
+
+void mitk::MemoryMappedFile::Open(const std::string& filename, bool sequentialAccess)
+{
+  this->Close();
+
+#ifdef _WIN32
+  m_File = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                       sequentialAccess ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_File == INVALID_HANDLE_VALUE)
+    mitkThrow() << "Unable to open file " << filename;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_File, &size))
+  {
+    this->Close();
+    mitkThrow() << "Unable to determine size of file " << filename;
+  }
+  m_Size = static_cast<std::size_t>(size.QuadPart);
+  if (m_Size == 0)
+    return;
+
+  m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_Mapping == nullptr)
+  {
+    this->Close();
+    mitkThrow() << "Unable to map file " << filename;
+  }
+  m_Data = static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+  m_File = open(filename.c_str(), O_RDONLY);
+  if (m_File < 0)
+    mitkThrow() << "Unable to open file " << filename;
+
+  struct stat fileStatus;
+  if (fstat(m_File, &fileStatus) != 0)
+  {
+    this->Close();
+    mitkThrow() << "Unable to determine size of file " << filename;
+  }
+  m_Size = static_cast<std::size_t>(fileStatus.st_size);
+  if (m_Size == 0)
+    return;
+
+  void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+  if (data != MAP_FAILED)
+  {
+    m_Data = static_cast<const char*>(data);
+    if (sequentialAccess)
+      madvise(data, m_Size, MADV_SEQUENTIAL);
+  }
+#endif
+
+  if (m_Data == nullptr)
+  {
+    this->Close();
+    mitkThrow() << "Unable to map file " << filename;
+  }
+}
+
+void mitk::MemoryMappedFile::Close()
+{
+#ifdef _WIN32
+  if (m_Data != nullptr)
+    UnmapViewOfFile(m_Data);
+  if (m_Mapping != nullptr)
+    CloseHandle(m_Mapping);
+  if (m_File != INVALID_HANDLE_VALUE)
+    CloseHandle(m_File);
+  m_Mapping = nullptr;
+  m_File = INVALID_HANDLE_VALUE;
+#else
+  if (m_Data != nullptr)
+    munmap(const_cast<char*>(m_Data), m_Size);
+  if (m_File >= 0)
+    close(m_File);
+  m_File = -1;
+#endif
+  m_Data = nullptr;
+  m_Size = 0;
+}
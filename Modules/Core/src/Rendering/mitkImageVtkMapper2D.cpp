@@ -59,6 +59,28 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkRGBAPixel.h>
 #include <mitkRenderingModeProperty.h>
 
+#include <algorithm>
+
+namespace
+{
+  // Returns 1 or -1 if the current plane is the previous one moved by step or -step, 0 otherwise.
+  int GetSlabStep(const mitk::PlaneGeometry *previous, const mitk::PlaneGeometry *current, const mitk::Vector3D &step)
+  {
+    const mitk::ScalarType tolerance = 1e-3 * step.GetNorm();
+    if (previous->GetReferenceGeometry() != current->GetReferenceGeometry() ||
+        !mitk::Equal(previous->GetAxisVector(0), current->GetAxisVector(0), tolerance) ||
+        !mitk::Equal(previous->GetAxisVector(1), current->GetAxisVector(1), tolerance))
+      return 0;
+
+    mitk::Vector3D shift = current->GetOrigin() - previous->GetOrigin();
+    if (mitk::Equal(shift, step, tolerance))
+      return 1;
+    if (mitk::Equal(shift, -step, tolerance))
+      return -1;
+    return 0;
+  }
+}
+
 mitk::ImageVtkMapper2D::ImageVtkMapper2D()
 {
 }
@@ -164,12 +186,12 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
 
   // Initialize the interpolation mode for resampling; switch to nearest
   // neighbor if the input image is too small.
+  int interpolationMode = VTK_RESLICE_NEAREST;
   if ((image->GetDimension() >= 3) && (image->GetDimension(2) > 1))
   {
     VtkResliceInterpolationProperty *resliceInterpolationProperty;
     datanode->GetProperty(resliceInterpolationProperty, "reslice interpolation", renderer);
 
-    int interpolationMode = VTK_RESLICE_NEAREST;
     if (resliceInterpolationProperty != nullptr)
     {
       interpolationMode = resliceInterpolationProperty->GetInterpolation();
@@ -254,24 +276,63 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
 
     localStorage->m_Reslicer->SetOutputDimensionality(3);
     localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
-
-    // Do the reslicing. Modified() is called to make sure that the reslicer is
-    // executed even though the input geometry information did not change; this
-    // is necessary when the input /em data, but not the /em geometry changes.
     localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
-    localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
 
-    // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
-    localStorage->m_Reslicer->Modified();
-    localStorage->m_Reslicer->Update();
+    // If the plane was moved by exactly one slice and nothing else changed, only the
+    // slice that enters the slab is resliced and the cached slab of the filter is shifted.
+    const itk::ModifiedTimeType imageMTime = std::max(
+      image->GetMTime(), image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->GetMTime());
+    bool slabShifted = false;
+    if (planeGeometry != nullptr && abstractGeometry == nullptr && localStorage->m_SlabGeometry.IsNotNull() &&
+        localStorage->m_SlabImageMTime == imageMTime && localStorage->m_SlabTimeStep == this->GetTimestep() &&
+        localStorage->m_SlabNumberOfSlices == thickSlicesNum &&
+        localStorage->m_SlabInterpolationMode == interpolationMode)
+    {
+      int step = GetSlabStep(localStorage->m_SlabGeometry, planeGeometry, normal * dataZSpacing);
+      if (step != 0)
+      {
+        localStorage->m_Reslicer->SetOutputExtentZDirection(step * thickSlicesNum, step * thickSlicesNum);
+        localStorage->m_Reslicer->Modified();
+        localStorage->m_Reslicer->Update();
+        slabShifted = localStorage->m_TSFilter->ShiftSlab(localStorage->m_Reslicer->GetVtkOutput(), step) != 0;
+      }
+    }
+
+    if (!slabShifted)
+    {
+      localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
+
+      // Do the reslicing. Modified() is called to make sure that the reslicer is
+      // executed even though the input geometry information did not change; this
+      // is necessary when the input /em data, but not the /em geometry changes.
+      localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
+
+      // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
+      localStorage->m_Reslicer->Modified();
+      localStorage->m_Reslicer->Update();
+    }
 
     localStorage->m_TSFilter->Modified();
     localStorage->m_TSFilter->Update();
     localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
+
+    if (planeGeometry != nullptr && abstractGeometry == nullptr)
+    {
+      localStorage->m_SlabGeometry = planeGeometry->Clone();
+      localStorage->m_SlabImageMTime = imageMTime;
+      localStorage->m_SlabTimeStep = this->GetTimestep();
+      localStorage->m_SlabNumberOfSlices = thickSlicesNum;
+      localStorage->m_SlabInterpolationMode = interpolationMode;
+    }
+    else
+    {
+      localStorage->m_SlabGeometry = nullptr;
+    }
   }
   else
   {
+    localStorage->m_SlabGeometry = nullptr;
+
     // this is needed when thick mode was enable bevore. These variable have to be reset to default values
     localStorage->m_Reslicer->SetOutputDimensionality(2);
     localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
@@ -1098,6 +1159,11 @@ mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
   // the following actions are always the same and thus can be performed
   // in the constructor for each image (i.e. the image-corresponding local storage)
   m_TSFilter->ReleaseDataFlagOn();
+  m_TSFilter->SlidingWindowOn();
+  m_SlabImageMTime = 0;
+  m_SlabTimeStep = 0;
+  m_SlabNumberOfSlices = 0;
+  m_SlabInterpolationMode = VTK_RESLICE_NEAREST;
 
   mitk::LookupTable::Pointer mitkLUT = mitk::LookupTable::New();
   // built a default lookuptable
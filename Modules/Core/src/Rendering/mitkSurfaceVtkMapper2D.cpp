@@ -41,6 +41,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkReverseSense.h>
 #include <vtkTransformPolyDataFilter.h>
 
+#include "vtkMitkPlaneIntersectingCellsFilter.h"
+
 // constructor LocalStorage
 mitk::SurfaceVtkMapper2D::LocalStorage::LocalStorage()
 {
@@ -50,8 +52,13 @@ mitk::SurfaceVtkMapper2D::LocalStorage::LocalStorage()
   m_PropAssembly = vtkSmartPointer<vtkAssembly>::New();
   m_PropAssembly->AddPart(m_Actor);
   m_CuttingPlane = vtkSmartPointer<vtkPlane>::New();
+  m_TransformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  m_IntersectingCells = vtkSmartPointer<vtkMitkPlaneIntersectingCellsFilter>::New();
+  m_IntersectingCells->SetPlane(m_CuttingPlane);
+  m_IntersectingCells->SetInputConnection(m_TransformFilter->GetOutputPort());
   m_Cutter = vtkSmartPointer<vtkCutter>::New();
   m_Cutter->SetCutFunction(m_CuttingPlane);
+  m_Cutter->SetInputConnection(m_IntersectingCells->GetOutputPort());
   m_Mapper->SetInputConnection(m_Cutter->GetOutputPort());
 
   m_NormalGlyph = vtkSmartPointer<vtkGlyph3D>::New();
@@ -216,11 +223,11 @@ void mitk::SurfaceVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rende
   localStorage->m_CuttingPlane->SetNormal(normal);
   // Transform the data according to its geometry.
   // See UpdateVtkTransform documentation for details.
+  // The transform filter is only executed again if the data or the transform changed,
+  // so the cell index of m_IntersectingCells stays valid while scrolling through slices.
   vtkSmartPointer<vtkLinearTransform> vtktransform = GetDataNode()->GetVtkTransform(this->GetTimestep());
-  vtkSmartPointer<vtkTransformPolyDataFilter> filter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  filter->SetTransform(vtktransform);
-  filter->SetInputData(inputPolyData);
-  localStorage->m_Cutter->SetInputConnection(filter->GetOutputPort());
+  localStorage->m_TransformFilter->SetTransform(vtktransform);
+  localStorage->m_TransformFilter->SetInputData(inputPolyData);
   localStorage->m_Cutter->Update();
 
   bool generateNormals = false;
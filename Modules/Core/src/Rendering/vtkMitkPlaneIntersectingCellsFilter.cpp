@@ -0,0 +1,296 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "vtkMitkPlaneIntersectingCellsFilter.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <cmath>
+
+vtkStandardNewMacro(vtkMitkPlaneIntersectingCellsFilter);
+
+namespace
+{
+  // cells that span more buckets are checked on every update
+  const vtkIdType MaximumBucketsPerCell = 16;
+
+  vtkCellArray *GetCellArray(vtkPolyData *polyData, unsigned char type)
+  {
+    switch (type)
+    {
+      case 0:
+        return polyData->GetVerts();
+      case 1:
+        return polyData->GetLines();
+      case 2:
+        return polyData->GetPolys();
+      default:
+        return polyData->GetStrips();
+    }
+  }
+}
+
+vtkMitkPlaneIntersectingCellsFilter::vtkMitkPlaneIntersectingCellsFilter()
+  : m_IndexedInput(nullptr), m_IndexedInputMTime(0), m_RangeMin(0.0), m_BucketWidth(1.0)
+{
+  m_IndexedNormal[0] = m_IndexedNormal[1] = m_IndexedNormal[2] = 0.0;
+}
+
+vtkMitkPlaneIntersectingCellsFilter::~vtkMitkPlaneIntersectingCellsFilter()
+{
+}
+
+void vtkMitkPlaneIntersectingCellsFilter::SetPlane(vtkPlane *plane)
+{
+  if (m_Plane != plane)
+  {
+    m_Plane = plane;
+    this->Modified();
+  }
+}
+
+vtkPlane *vtkMitkPlaneIntersectingCellsFilter::GetPlane()
+{
+  return m_Plane;
+}
+
+vtkMTimeType vtkMitkPlaneIntersectingCellsFilter::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (m_Plane)
+    mTime = std::max(mTime, m_Plane->GetMTime());
+  return mTime;
+}
+
+void vtkMitkPlaneIntersectingCellsFilter::BuildIndex(vtkPolyData *input, const double normal[3])
+{
+  m_IndexedInput = input;
+  m_IndexedInputMTime = input->GetMTime();
+  std::copy(normal, normal + 3, m_IndexedNormal);
+
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  const vtkIdType numberOfCells = input->GetNumberOfCells();
+
+  // distance of every point along the normal
+  std::vector<double> pointDistances(numberOfPoints);
+  double point[3];
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    input->GetPoint(i, point);
+    pointDistances[i] = vtkMath::Dot(normal, point);
+  }
+
+  m_CellTypes.resize(numberOfCells);
+  m_CellLocations.resize(numberOfCells);
+  m_CellMin.resize(numberOfCells);
+  m_CellMax.resize(numberOfCells);
+
+  double rangeMin = VTK_DOUBLE_MAX;
+  double rangeMax = VTK_DOUBLE_MIN;
+  vtkIdType cellId = 0;
+  for (unsigned char type = 0; type < 4; ++type)
+  {
+    vtkCellArray *cells = GetCellArray(input, type);
+    vtkIdType npts;
+    vtkIdType *pts;
+    cells->InitTraversal();
+    vtkIdType location = cells->GetTraversalLocation();
+    while (cells->GetNextCell(npts, pts))
+    {
+      double cellMin = VTK_DOUBLE_MAX;
+      double cellMax = VTK_DOUBLE_MIN;
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        cellMin = std::min(cellMin, pointDistances[pts[i]]);
+        cellMax = std::max(cellMax, pointDistances[pts[i]]);
+      }
+      m_CellTypes[cellId] = type;
+      m_CellLocations[cellId] = location;
+      m_CellMin[cellId] = cellMin;
+      m_CellMax[cellId] = cellMax;
+      rangeMin = std::min(rangeMin, cellMin);
+      rangeMax = std::max(rangeMax, cellMax);
+
+      location = cells->GetTraversalLocation();
+      ++cellId;
+    }
+  }
+
+  // sort the cells into buckets along the normal with a counting sort
+  vtkIdType numberOfBuckets = std::min<vtkIdType>(std::max<vtkIdType>(numberOfCells / 8, 1), 1 << 18);
+  m_RangeMin = rangeMin;
+  m_BucketWidth = (rangeMax - rangeMin) / numberOfBuckets;
+  if (!(m_BucketWidth > 0.0))
+  {
+    numberOfBuckets = 1;
+    m_BucketWidth = 1.0;
+  }
+
+  auto bucketOf = [this, numberOfBuckets](double distance) {
+    vtkIdType bucket = static_cast<vtkIdType>((distance - m_RangeMin) / m_BucketWidth);
+    return std::min(std::max<vtkIdType>(bucket, 0), numberOfBuckets - 1);
+  };
+
+  m_LargeCells.clear();
+  m_BucketOffsets.assign(numberOfBuckets + 1, 0);
+  for (vtkIdType i = 0; i < cellId; ++i)
+  {
+    const vtkIdType first = bucketOf(m_CellMin[i]);
+    const vtkIdType last = bucketOf(m_CellMax[i]);
+    if (last - first >= MaximumBucketsPerCell)
+    {
+      m_LargeCells.push_back(i);
+      continue;
+    }
+    for (vtkIdType bucket = first; bucket <= last; ++bucket)
+      ++m_BucketOffsets[bucket + 1];
+  }
+  for (vtkIdType bucket = 0; bucket < numberOfBuckets; ++bucket)
+    m_BucketOffsets[bucket + 1] += m_BucketOffsets[bucket];
+
+  m_BucketCells.resize(m_BucketOffsets[numberOfBuckets]);
+  std::vector<vtkIdType> fill(m_BucketOffsets.begin(), m_BucketOffsets.end() - 1);
+  for (vtkIdType i = 0; i < cellId; ++i)
+  {
+    const vtkIdType first = bucketOf(m_CellMin[i]);
+    const vtkIdType last = bucketOf(m_CellMax[i]);
+    if (last - first >= MaximumBucketsPerCell)
+      continue;
+    for (vtkIdType bucket = first; bucket <= last; ++bucket)
+      m_BucketCells[fill[bucket]++] = i;
+  }
+
+  m_PointMap.assign(numberOfPoints, -1);
+}
+
+int vtkMitkPlaneIntersectingCellsFilter::RequestData(vtkInformation *,
+                                                     vtkInformationVector **inputVector,
+                                                     vtkInformationVector *outputVector)
+{
+  vtkPolyData *input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData *output = vtkPolyData::GetData(outputVector);
+  if (!input || !output)
+    return 0;
+
+  output->Initialize();
+  if (!m_Plane)
+  {
+    output->ShallowCopy(input);
+    return 1;
+  }
+
+  if (input->GetNumberOfPoints() < 1 || input->GetNumberOfCells() < 1)
+    return 1;
+
+  double normal[3];
+  m_Plane->GetNormal(normal);
+  if (vtkMath::Normalize(normal) == 0.0)
+    return 1;
+
+  if (input != m_IndexedInput || input->GetMTime() != m_IndexedInputMTime || normal[0] != m_IndexedNormal[0] ||
+      normal[1] != m_IndexedNormal[1] || normal[2] != m_IndexedNormal[2])
+  {
+    this->BuildIndex(input, normal);
+  }
+
+  // collect the cells that contain the plane
+  const double distance = vtkMath::Dot(normal, m_Plane->GetOrigin());
+  const vtkIdType numberOfBuckets = static_cast<vtkIdType>(m_BucketOffsets.size()) - 1;
+  const double bucketPosition = std::floor((distance - m_RangeMin) / m_BucketWidth);
+
+  std::vector<vtkIdType> cellIds;
+  if (bucketPosition >= 0.0 && bucketPosition <= static_cast<double>(numberOfBuckets))
+  {
+    const vtkIdType bucket = std::min(static_cast<vtkIdType>(bucketPosition), numberOfBuckets - 1);
+    for (vtkIdType i = m_BucketOffsets[bucket]; i < m_BucketOffsets[bucket + 1]; ++i)
+    {
+      const vtkIdType cellId = m_BucketCells[i];
+      if (m_CellMin[cellId] <= distance && distance <= m_CellMax[cellId])
+        cellIds.push_back(cellId);
+    }
+  }
+  for (vtkIdType cellId : m_LargeCells)
+  {
+    if (m_CellMin[cellId] <= distance && distance <= m_CellMax[cellId])
+      cellIds.push_back(cellId);
+  }
+
+  // keep the order of the input
+  std::sort(cellIds.begin(), cellIds.end());
+
+  vtkPoints *inputPoints = input->GetPoints();
+  auto outputPoints = vtkSmartPointer<vtkPoints>::New();
+  outputPoints->SetDataType(inputPoints->GetDataType());
+
+  vtkPointData *inputPointData = input->GetPointData();
+  vtkPointData *outputPointData = output->GetPointData();
+  outputPointData->CopyAllocate(inputPointData);
+  vtkCellData *inputCellData = input->GetCellData();
+  vtkCellData *outputCellData = output->GetCellData();
+  outputCellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(cellIds.size()));
+
+  vtkSmartPointer<vtkCellArray> outputCells[4];
+  for (auto &cells : outputCells)
+    cells = vtkSmartPointer<vtkCellArray>::New();
+
+  std::vector<vtkIdType> usedPoints;
+  std::vector<vtkIdType> cellPoints;
+  vtkIdType outputCellId = 0;
+  for (vtkIdType cellId : cellIds)
+  {
+    const unsigned char type = m_CellTypes[cellId];
+    vtkIdType npts;
+    vtkIdType *pts;
+    GetCellArray(input, type)->GetCell(m_CellLocations[cellId], npts, pts);
+
+    cellPoints.resize(npts);
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      vtkIdType &pointId = m_PointMap[pts[i]];
+      if (pointId < 0)
+      {
+        pointId = outputPoints->InsertNextPoint(inputPoints->GetPoint(pts[i]));
+        outputPointData->CopyData(inputPointData, pts[i], pointId);
+        usedPoints.push_back(pts[i]);
+      }
+      cellPoints[i] = pointId;
+    }
+
+    outputCells[type]->InsertNextCell(npts, cellPoints.data());
+    outputCellData->CopyData(inputCellData, cellId, outputCellId++);
+  }
+
+  for (vtkIdType pointId : usedPoints)
+    m_PointMap[pointId] = -1;
+
+  output->SetPoints(outputPoints);
+  output->SetVerts(outputCells[0]);
+  output->SetLines(outputCells[1]);
+  output->SetPolys(outputCells[2]);
+  output->SetStrips(outputCells[3]);
+
+  return 1;
+}
@@ -25,7 +25,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <cmath>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 vtkStandardNewMacro(vtkMitkThickSlicesFilter);
 
@@ -38,6 +40,9 @@ vtkMitkThickSlicesFilter::vtkMitkThickSlicesFilter()
 
   this->m_CurrentMode = MIP;
 
+  this->SlidingWindow = 0;
+  this->m_SlabStart = 0;
+
   // by default process active point scalars
   this->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, vtkDataSetAttributes::SCALARS);
 }
@@ -48,6 +53,55 @@ void vtkMitkThickSlicesFilter::PrintSelf(ostream &os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "HandleBoundaries: " << this->HandleBoundaries << "\n";
   os << indent << "Dimensionality: " << this->Dimensionality << "\n";
+  os << indent << "SlidingWindow: " << this->SlidingWindow << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkMitkThickSlicesFilter::ShiftSlab(vtkImageData *slice, int direction)
+{
+  if (!this->SlidingWindow || !m_Slab || !slice || direction == 0 || !m_Slab->GetPointData()->GetScalars() ||
+      !slice->GetPointData()->GetScalars())
+  {
+    return 0;
+  }
+
+  int *slabExt = m_Slab->GetExtent();
+  int *sliceExt = slice->GetExtent();
+  double *slabSpacing = m_Slab->GetSpacing();
+  double *sliceSpacing = slice->GetSpacing();
+
+  // the slice has to fit into the cached slab, otherwise a complete slab has to be set as input
+  if (slabExt[0] != sliceExt[0] || slabExt[1] != sliceExt[1] || slabExt[2] != sliceExt[2] ||
+      slabExt[3] != sliceExt[3] || sliceExt[4] != sliceExt[5] || slabSpacing[0] != sliceSpacing[0] ||
+      slabSpacing[1] != sliceSpacing[1] || slice->GetScalarType() != m_Slab->GetScalarType() ||
+      slice->GetNumberOfScalarComponents() != 1)
+  {
+    return 0;
+  }
+
+  // the slab is a ring of slices, m_SlabStart is the first slice of the slab
+  const int numberOfSlices = slabExt[5] - slabExt[4] + 1;
+  int slot;
+  if (direction > 0)
+  {
+    // the first slice leaves the slab, the new slice is appended at the end
+    slot = m_SlabStart;
+    m_SlabStart = (m_SlabStart + 1) % numberOfSlices;
+  }
+  else
+  {
+    // the last slice leaves the slab, the new slice is inserted at the front
+    m_SlabStart = (m_SlabStart + numberOfSlices - 1) % numberOfSlices;
+    slot = m_SlabStart;
+  }
+
+  const vtkIdType sliceSize = m_Slab->GetIncrements()[2] * m_Slab->GetScalarSize();
+  memcpy(static_cast<char *>(m_Slab->GetScalarPointer()) + slot * sliceSize, slice->GetScalarPointer(), sliceSize);
+  m_Slab->Modified();
+
+  this->SetInputData(m_Slab);
+  this->Modified();
+  return 1;
 }
 
 //----------------------------------------------------------------------------
@@ -109,9 +163,11 @@ int vtkMitkThickSlicesFilter::RequestUpdateExtent(vtkInformation *,
 }
 
 //----------------------------------------------------------------------------
-// This execute method handles boundaries.
-// it handles boundaries. Pixels are just replicated to get values
-// out of extent.
+// The projection is computed row by row: for every slice of the slab, the
+// input row is combined with an accumulator row. All inner loops run over
+// contiguous memory, so they are vectorized by the compiler, and every slice
+// row is read only once. The slices are read in the order of the slab, which
+// starts at slabStart if the input is a cached ring slab (see ShiftSlab()).
 template <class T>
 void vtkMitkThickSlicesFilterExecute(vtkMitkThickSlicesFilter *self,
                                      vtkImageData *inData,
@@ -119,225 +175,150 @@ void vtkMitkThickSlicesFilterExecute(vtkMitkThickSlicesFilter *self,
                                      vtkImageData *outData,
                                      T *outPtr,
                                      int outExt[6],
-                                     int /*id*/)
+                                     int slabStart)
 {
-  int idxX, idxY;
-  int maxX, maxY;
-  vtkIdType inIncX, inIncY, inIncZ;
   vtkIdType outIncX, outIncY, outIncZ;
-  // int axesNum;
   int *inExt = inData->GetExtent();
-  int *wholeExtent;
-  vtkIdType *inIncs;
-  // int useYMin, useYMax, useXMin, useXMax;
+  vtkIdType *inIncs = inData->GetIncrements();
 
   // find the region to loop over
-  maxX = outExt[1] - outExt[0];
-  maxY = outExt[3] - outExt[2];
-
-  //  maxZ = outExt[5] - outExt[4];
-
-  // Get the dimensionality of the gradient.
-  // axesNum = self->GetDimensionality();
+  const int maxX = outExt[1] - outExt[0];
+  const int maxY = outExt[3] - outExt[2];
 
-  // Get increments to march through data
-  inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
   outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
-  /*
-// The data spacing is important for computing the gradient.
-// central differences (2 * ratio).
-// Negative because below we have (min - max) for dx ...
-inData->GetSpacing(r);
-r[0] = -0.5 / r[0];
-r[1] = -0.5 / r[1];
-r[2] = -0.5 / r[2];
-    */
-  // get some other info we need
-  inIncs = inData->GetIncrements();
-  wholeExtent = inData->GetExtent();
-
-  // Move the pointer to the correct starting position.
-  inPtr += (outExt[0] - inExt[0]) * inIncs[0] + (outExt[2] - inExt[2]) * inIncs[1] + (outExt[4] - inExt[4]) * inIncs[2];
-
-  // Loop through ouput pixels
 
-  int _minZ = /*-5 + outExt[4];  if( _minZ  < wholeExtent[4]) _minZ=*/wholeExtent[4];
-  int _maxZ = /* 5 + outExt[4];  if( _maxZ  > wholeExtent[5]) _maxZ=*/wholeExtent[5];
+  const int _minZ = inExt[4];
+  const int _maxZ = inExt[5];
 
   if (_maxZ < _minZ)
     return;
 
-  double invNum = 1.0 / (_maxZ - _minZ + 1);
+  const int numberOfSlices = _maxZ - _minZ + 1;
+  const int mode = self->GetThickSliceMode();
 
-  switch (self->GetThickSliceMode())
+  // Move the pointer to the first pixel of the output extent in the first slice.
+  inPtr += (outExt[0] - inExt[0]) * inIncs[0] + (outExt[2] - inExt[2]) * inIncs[1];
+
+  // offsets of the slices in the order of the slab
+  std::vector<vtkIdType> sliceOffsets(numberOfSlices);
+  for (int z = 0; z < numberOfSlices; ++z)
+    sliceOffsets[z] = ((z + slabStart) % numberOfSlices) * inIncs[2];
+
+  // weights of the slices; the first slice is not part of the weighted projection
+  const int size = _maxZ - _minZ;
+  std::vector<double> weights(size);
+  if (mode == vtkMitkThickSlicesFilter::WEIGHTED)
   {
-    default:
-    case vtkMitkThickSlicesFilter::MIP:
+    double mean = 0.5 * double(_minZ + _maxZ);
+    double sigma_sq = double(size) / 6.0;
+    sigma_sq *= sigma_sq;
+    double sum = 0;
+    int i = 0;
+    for (int z = _minZ + 1; z <= _maxZ; z++)
     {
-      // MIP
-      for (idxY = 0; idxY <= maxY; idxY++)
-      {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          T mip = inPtr[_minZ * inIncs[2]];
-
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            if (value > mip)
-              mip = value;
-          }
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
-      }
+      double val = exp(-(((double)z - mean) / sigma_sq));
+      weights[i++] = val;
+      sum += val;
     }
-    break;
-
-    case vtkMitkThickSlicesFilter::SUM:
+    for (i = 0; i < size; i++)
     {
-      // MIP
-      for (idxY = 0; idxY <= maxY; idxY++)
-      {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          double sum = 0;
+      weights[i] /= sum;
+    }
+  }
 
-          for (int z = _minZ; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            sum += value;
-          }
+  const double invNum = 1.0 / numberOfSlices;
+  const int rowLength = maxX + 1;
+  std::vector<double> accumulator;
+  if (mode == vtkMitkThickSlicesFilter::SUM || mode == vtkMitkThickSlicesFilter::WEIGHTED)
+    accumulator.resize(rowLength);
+  double *acc = accumulator.data();
 
-          // do X axis
-          *outPtr = static_cast<T>(invNum * sum);
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
-      }
-    }
-    break;
+  for (int idxY = 0; idxY <= maxY; idxY++)
+  {
+    const T *inRow = inPtr + idxY * inIncs[1];
+    T *outRow = outPtr;
 
-    case vtkMitkThickSlicesFilter::WEIGHTED:
+    switch (mode)
     {
-      const int size = _maxZ - _minZ;
-      std::vector<double> weights(size);
-      double mean = 0.5 * double(_minZ + _maxZ);
-      double sigma_sq = double(size) / 6.0;
-      sigma_sq *= sigma_sq;
-      double sum = 0;
-      int i = 0;
-      for (int z = _minZ + 1; z <= _maxZ; z++)
+      default:
+      case vtkMitkThickSlicesFilter::MIP:
       {
-        double val = exp(-(((double)z - mean) / sigma_sq));
-        weights[i++] = val;
-        sum += val;
+        const T *row = inRow + sliceOffsets[0];
+        for (int x = 0; x < rowLength; ++x)
+          outRow[x] = row[x];
+        for (int z = 1; z < numberOfSlices; ++z)
+        {
+          row = inRow + sliceOffsets[z];
+          for (int x = 0; x < rowLength; ++x)
+            outRow[x] = row[x] > outRow[x] ? row[x] : outRow[x];
+        }
       }
-      for (i = 0; i < size; i++)
+      break;
+
+      case vtkMitkThickSlicesFilter::SUM:
       {
-        weights[i] /= sum;
+        for (int x = 0; x < rowLength; ++x)
+          acc[x] = 0.0;
+        for (int z = 0; z < numberOfSlices; ++z)
+        {
+          const T *row = inRow + sliceOffsets[z];
+          for (int x = 0; x < rowLength; ++x)
+            acc[x] += row[x];
+        }
+        for (int x = 0; x < rowLength; ++x)
+          outRow[x] = static_cast<T>(invNum * acc[x]);
       }
+      break;
 
-      for (idxY = 0; idxY <= maxY; idxY++)
+      case vtkMitkThickSlicesFilter::WEIGHTED:
       {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
+        for (int x = 0; x < rowLength; ++x)
+          acc[x] = 0.0;
+        for (int z = 1; z < numberOfSlices; ++z)
         {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          T mip = inPtr[_minZ * inIncs[2]];
-          i = 0;
-          double mymip = 0;
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            double value = inPtr[z * inIncs[2]];
-            mymip += value * weights[i++];
-          }
-          mip = static_cast<T>(mymip);
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
+          const T *row = inRow + sliceOffsets[z];
+          const double weight = weights[z - 1];
+          for (int x = 0; x < rowLength; ++x)
+            acc[x] += static_cast<double>(row[x]) * weight;
         }
-        outPtr += outIncY;
-        inPtr += inIncY;
+        for (int x = 0; x < rowLength; ++x)
+          outRow[x] = static_cast<T>(acc[x]);
       }
-    }
-    break;
+      break;
 
-    case vtkMitkThickSlicesFilter::MINIP:
-    {
-      for (idxY = 0; idxY <= maxY; idxY++)
+      case vtkMitkThickSlicesFilter::MINIP:
       {
-        for (idxX = 0; idxX <= maxX; idxX++)
+        const T *row = inRow + sliceOffsets[0];
+        for (int x = 0; x < rowLength; ++x)
+          outRow[x] = row[x];
+        for (int z = 1; z < numberOfSlices; ++z)
         {
-          T mip = inPtr[_minZ * inIncs[2]];
-
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            if (value < mip)
-              mip = value;
-          }
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
+          row = inRow + sliceOffsets[z];
+          for (int x = 0; x < rowLength; ++x)
+            outRow[x] = row[x] < outRow[x] ? row[x] : outRow[x];
         }
-        outPtr += outIncY;
-        inPtr += inIncY;
       }
-    }
-    break;
+      break;
 
-    case vtkMitkThickSlicesFilter::MEAN:
-    {
-      const int size = _maxZ - _minZ;
-
-      // MEAN
-      for (idxY = 0; idxY <= maxY; idxY++)
+      case vtkMitkThickSlicesFilter::MEAN:
       {
-        for (idxX = 0; idxX <= maxX; idxX++)
+        // the sum is accumulated in the pixel type and divided by the number of slices minus one
+        for (int x = 0; x < rowLength; ++x)
+          outRow[x] = 0;
+        for (int z = 0; z < numberOfSlices; ++z)
         {
-          T sum = 0;
-          for (int z = _minZ; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            sum += value;
-          }
-
-          T mip = sum / size;
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
+          const T *row = inRow + sliceOffsets[z];
+          for (int x = 0; x < rowLength; ++x)
+            outRow[x] += row[x];
         }
-        outPtr += outIncY;
-        inPtr += inIncY;
+        const int divisor = size > 0 ? size : 1;
+        for (int x = 0; x < rowLength; ++x)
+          outRow[x] = outRow[x] / divisor;
       }
+      break;
     }
-    break;
+
+    outPtr += rowLength + outIncY;
   }
 }
 
@@ -345,6 +326,16 @@ int vtkMitkThickSlicesFilter::RequestData(vtkInformation *request,
                                           vtkInformationVector **inputVector,
                                           vtkInformationVector *outputVector)
 {
+  vtkImageData *input = vtkImageData::GetData(inputVector[0]);
+  if (this->SlidingWindow && input && input != m_Slab)
+  {
+    // keep the slab for ShiftSlab()
+    if (!m_Slab)
+      m_Slab = vtkSmartPointer<vtkImageData>::New();
+    m_Slab->DeepCopy(input);
+    m_SlabStart = 0;
+  }
+
   if (!this->Superclass::RequestData(request, inputVector, outputVector))
   {
     return 0;
@@ -372,7 +363,7 @@ void vtkMitkThickSlicesFilter::ThreadedRequestData(vtkInformation *,
                                                    vtkImageData ***inData,
                                                    vtkImageData **outData,
                                                    int outExt[6],
-                                                   int threadId)
+                                                   int)
 {
   // Get the input and output data objects.
   vtkImageData *input = inData[0][0];
@@ -409,10 +400,13 @@ void vtkMitkThickSlicesFilter::ThreadedRequestData(vtkInformation *,
   void *inPtr = inputArray->GetVoidPointer(0);
   void *outPtr = output->GetScalarPointerForExtent(outExt);
 
+  // a cached slab is a ring whose first slice is m_SlabStart
+  int slabStart = (input == m_Slab.GetPointer()) ? m_SlabStart : 0;
+
   switch (inputArray->GetDataType())
   {
     vtkTemplateMacro(vtkMitkThickSlicesFilterExecute(
-      this, input, static_cast<VTK_TT *>(inPtr), output, static_cast<VTK_TT *>(outPtr), outExt, threadId));
+      this, input, static_cast<VTK_TT *>(inPtr), output, static_cast<VTK_TT *>(outPtr), outExt, slabStart));
     default:
       vtkErrorMacro("Execute: Unknown ScalarType " << input->GetScalarType());
       return;
@@ -31,6 +31,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNodePredicateAnd.h"
 #include "mitkNodePredicateData.h"
 #include "mitkNodePredicateDataType.h"
+#include "mitkNodePredicateDataUID.h"
 #include "mitkNodePredicateDimension.h"
 #include "mitkNodePredicateNot.h"
 #include "mitkNodePredicateOr.h"
@@ -41,6 +42,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTestingMacros.h"
 
 void TestDataStorage(mitk::DataStorage *ds, std::string filename);
+void TestStandaloneDataStorageIndexes();
 
 namespace mitk
 {
@@ -150,9 +152,10 @@ int mitkDataStorageTest(int argc, char *argv[])
   MITK_TEST_OUTPUT(<< "Testing StandaloneDataStorage: ");
   MITK_TEST_CONDITION_REQUIRED(argc > 1, "Testing correct test invocation");
   TestDataStorage(sds, argv[1]);
-  // TODO: Add specific StandaloneDataStorage Tests here
   sds = nullptr;
 
+  TestStandaloneDataStorageIndexes();
+
   MITK_TEST_END();
 }
 
@@ -876,3 +879,87 @@ void TestDataStorage(mitk::DataStorage *ds, std::string filename)
   ds->Remove(ds->GetAll());
   MITK_TEST_CONDITION(ds->GetAll()->Size() == 0, "Checking Clear DataStorage");
 }
+
+//##Documentation
+//## @brief Checks that queries answered from the node indexes of StandaloneDataStorage
+//## follow modifications of the stored nodes
+void TestStandaloneDataStorageIndexes()
+{
+  mitk::StandaloneDataStorage::Pointer ds = mitk::StandaloneDataStorage::New();
+
+  mitk::Image::Pointer image = mitk::Image::New();
+  mitk::Surface::Pointer surface = mitk::Surface::New();
+
+  mitk::DataNode::Pointer imageNode = mitk::DataNode::New();
+  imageNode->SetName("image");
+  imageNode->SetData(image);
+  mitk::DataNode::Pointer surfaceNode = mitk::DataNode::New();
+  surfaceNode->SetName("surface");
+  surfaceNode->SetData(surface);
+  mitk::DataNode::Pointer emptyNode = mitk::DataNode::New();
+  emptyNode->SetName("empty");
+
+  ds->Add(imageNode);
+  ds->Add(surfaceNode, imageNode);
+  ds->Add(emptyNode, surfaceNode);
+
+  MITK_TEST_CONDITION(ds->GetNamedNode("image") == imageNode, "Indexed lookup by name");
+  MITK_TEST_CONDITION(ds->GetNamedNode("unknown") == nullptr, "Indexed lookup by unknown name");
+
+  imageNode->SetName("renamed image");
+  MITK_TEST_CONDITION(ds->GetNamedNode("image") == nullptr && ds->GetNamedNode("renamed image") == imageNode,
+                      "Indexed lookup by name after SetName()");
+
+  auto *nameProperty = dynamic_cast<mitk::StringProperty *>(surfaceNode->GetProperty("name"));
+  MITK_TEST_CONDITION_REQUIRED(nameProperty != nullptr, "Name property is a StringProperty");
+  nameProperty->SetValue("changed surface");
+  MITK_TEST_CONDITION(ds->GetNamedNode("surface") == nullptr && ds->GetNamedNode("changed surface") == surfaceNode,
+                      "Indexed lookup by name after changing the name property in place");
+
+  mitk::DataNode::Pointer unnamedNode = mitk::DataNode::New();
+  mitk::Image::Pointer namedImage = mitk::Image::New();
+  namedImage->SetProperty("name", mitk::StringProperty::New("data name"));
+  unnamedNode->SetData(namedImage);
+  ds->Add(unnamedNode);
+  MITK_TEST_CONDITION(ds->GetNamedNode("data name") == unnamedNode,
+                      "Indexed lookup by name provided by the data of a node");
+
+  mitk::NodePredicateDataType::Pointer isImage = mitk::NodePredicateDataType::New("Image");
+  mitk::NodePredicateDataType::Pointer isSurface = mitk::NodePredicateDataType::New("Surface");
+  MITK_TEST_CONDITION(ds->GetSubset(isImage)->Size() == 2, "Indexed lookup by data type");
+
+  imageNode->SetData(mitk::Surface::New());
+  MITK_TEST_CONDITION(ds->GetSubset(isImage)->Size() == 1 && ds->GetSubset(isSurface)->Size() == 2,
+                      "Indexed lookup by data type after SetData()");
+
+  mitk::NodePredicateDataUID::Pointer hasSurfaceUID = mitk::NodePredicateDataUID::New(surface->GetUID());
+  MITK_TEST_CONDITION(ds->GetNode(hasSurfaceUID) == surfaceNode, "Indexed lookup by data UID");
+
+  image->SetUID("changed image UID");
+  emptyNode->SetData(image);
+  MITK_TEST_CONDITION(ds->GetNode(mitk::NodePredicateDataUID::New("changed image UID")) == emptyNode,
+                      "Indexed lookup by data UID after SetData()");
+
+  mitk::NodePredicateProperty::Pointer isNamedSurface =
+    mitk::NodePredicateProperty::New("name", mitk::StringProperty::New("changed surface"));
+  MITK_TEST_CONDITION(ds->GetSubset(mitk::NodePredicateAnd::New(isSurface, isNamedSurface))->Size() == 1,
+                      "Indexed lookup with conjunction");
+  MITK_TEST_CONDITION(ds->GetSubset(mitk::NodePredicateOr::New(isImage, isNamedSurface))->Size() == 3,
+                      "Indexed lookup with disjunction");
+  MITK_TEST_CONDITION(
+    ds->GetSubset(mitk::NodePredicateOr::New(isImage, mitk::NodePredicateNot::New(isSurface).GetPointer()))->Size() ==
+      2,
+    "Lookup with disjunction that cannot be indexed");
+
+  MITK_TEST_CONDITION(ds->GetDerivations(imageNode, nullptr, false)->Size() == 2, "Indirect derivations");
+  MITK_TEST_CONDITION(ds->GetSources(emptyNode, isSurface, false)->Size() == 2,
+                      "Indirect sources with condition");
+
+  ds->Remove(surfaceNode);
+  MITK_TEST_CONDITION(ds->GetNamedNode("changed surface") == nullptr && ds->GetNode(hasSurfaceUID) == nullptr &&
+                        ds->GetSubset(isSurface)->Size() == 1,
+                      "Indexed lookup after Remove()");
+
+  nameProperty->SetValue("surface");
+  MITK_TEST_CONDITION(ds->GetNamedNode("surface") == nullptr, "Removed nodes are not indexed anymore");
+}
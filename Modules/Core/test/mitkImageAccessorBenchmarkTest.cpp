@@ -0,0 +1,156 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkImage.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * Micro-benchmark for the acquisition throughput of image accessors.
+ *
+ * Each thread repeatedly creates short-lived accessors on slices of the same image. The number of
+ * acquisitions per second is reported for an increasing number of threads. The test only fails if
+ * an accessor could not be acquired or data written by a write accessor got lost.
+ */
+class mitkImageAccessorBenchmarkTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageAccessorBenchmarkTestSuite);
+  MITK_TEST(BenchmarkConcurrentReadAccessors);
+  MITK_TEST(BenchmarkMixedReadWriteAccessors);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  unsigned int m_AcquisitionsPerThread;
+
+  std::vector<unsigned int> GetThreadCounts() const
+  {
+    std::vector<unsigned int> threadCounts = {1, 2, 4};
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    if (hardwareThreads > 4)
+      threadCounts.push_back(hardwareThreads);
+    return threadCounts;
+  }
+
+  /** Runs accessFunction(threadIndex, iteration) on numberOfThreads threads and returns acquisitions per second */
+  template <typename TFunction>
+  double MeasureThroughput(unsigned int numberOfThreads, TFunction accessFunction)
+  {
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([this, i, &accessFunction]() {
+        for (unsigned int j = 0; j < m_AcquisitionsPerThread; ++j)
+          accessFunction(i, j);
+      });
+    }
+
+    for (auto &thread : threads)
+      thread.join();
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return (numberOfThreads * m_AcquisitionsPerThread) / std::max(elapsed.count(), 1e-9);
+  }
+
+public:
+  void setUp() override
+  {
+    std::array<unsigned int, 3> dimensions = {64, 64, 64};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<unsigned int>(), 3, dimensions.data());
+
+    // make sure all slice items exist, so that the benchmark does not measure their allocation
+    for (unsigned int s = 0; s < dimensions[2]; ++s)
+    {
+      mitk::ImageWriteAccessor accessor(m_Image, m_Image->GetSliceData(s));
+      *static_cast<unsigned int *>(accessor.GetData()) = 0;
+    }
+
+    m_AcquisitionsPerThread = 20000;
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void BenchmarkConcurrentReadAccessors()
+  {
+    std::atomic<unsigned int> failures(0);
+
+    for (auto numberOfThreads : this->GetThreadCounts())
+    {
+      const double throughput = MeasureThroughput(numberOfThreads, [this, &failures](unsigned int, unsigned int j) {
+        mitk::ImageReadAccessor accessor(m_Image, m_Image->GetSliceData(j % m_Image->GetDimension(2)));
+        if (accessor.GetData() == nullptr)
+          ++failures;
+      });
+
+      MITK_INFO << "read accessors, " << numberOfThreads << " thread(s): " << throughput << " acquisitions/s";
+    }
+
+    CPPUNIT_ASSERT_EQUAL(0u, failures.load());
+  }
+
+  void BenchmarkMixedReadWriteAccessors()
+  {
+    const unsigned int numberOfSlices = m_Image->GetDimension(2);
+
+    for (auto numberOfThreads : this->GetThreadCounts())
+    {
+      // every tenth acquisition of a thread writes to the slice owned by this thread, all others read arbitrary slices
+      const double throughput =
+        MeasureThroughput(numberOfThreads, [this, numberOfSlices](unsigned int i, unsigned int j) {
+          if (j % 10 == 0)
+          {
+            mitk::ImageWriteAccessor accessor(m_Image, m_Image->GetSliceData(i % numberOfSlices));
+            ++*static_cast<unsigned int *>(accessor.GetData());
+          }
+          else
+          {
+            mitk::ImageReadAccessor accessor(m_Image, m_Image->GetSliceData(j % numberOfSlices));
+          }
+        });
+
+      MITK_INFO << "mixed accessors, " << numberOfThreads << " thread(s): " << throughput << " acquisitions/s";
+    }
+
+    // all increments of the write accessors must have arrived
+    unsigned int expectedSum = 0;
+    for (auto numberOfThreads : this->GetThreadCounts())
+      expectedSum += numberOfThreads * (m_AcquisitionsPerThread / 10);
+
+    unsigned int sum = 0;
+    for (unsigned int s = 0; s < numberOfSlices; ++s)
+    {
+      mitk::ImageReadAccessor accessor(m_Image, m_Image->GetSliceData(s));
+      sum += *static_cast<const unsigned int *>(accessor.GetData());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(expectedSum, sum);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageAccessorBenchmark)
@@ -0,0 +1,252 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkImage.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageVolumeProvider.h>
+#include <mitkImageWriteAccessor.h>
+
+namespace
+{
+  const unsigned int TimeSteps = 10;
+  const size_t VolumeSize = 16 * 16 * 8;
+
+  /** Fills every volume with its time step and counts how often volumes were loaded */
+  class CountingVolumeProvider : public mitk::ImageVolumeProvider
+  {
+  public:
+    mitkClassMacro(CountingVolumeProvider, mitk::ImageVolumeProvider);
+    mitkNewMacro1Param(Self, size_t);
+
+    void LoadVolume(unsigned int t, unsigned int, void *buffer) override
+    {
+      std::memset(buffer, static_cast<int>(t), m_VolumeSize);
+      ++m_LoadCount;
+    }
+
+    std::atomic<unsigned int> m_LoadCount;
+
+  protected:
+    CountingVolumeProvider(size_t volumeSize) : m_LoadCount(0), m_VolumeSize(volumeSize) {}
+
+  private:
+    size_t m_VolumeSize;
+  };
+
+  /** Loading volume 0 waits until volume 1 was loaded, which is only possible if loads do not block each other */
+  class WaitingVolumeProvider : public CountingVolumeProvider
+  {
+  public:
+    mitkClassMacro(WaitingVolumeProvider, CountingVolumeProvider);
+    mitkNewMacro1Param(Self, size_t);
+
+    void LoadVolume(unsigned int t, unsigned int n, void *buffer) override
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      if (t == 0)
+      {
+        m_Volume0Started = true;
+        m_Condition.notify_all();
+        m_Volume1LoadedMeanwhile =
+          m_Condition.wait_for(lock, std::chrono::seconds(10), [this] { return m_Volume1Loaded; });
+      }
+      else if (t == 1)
+      {
+        m_Volume1Loaded = true;
+        m_Condition.notify_all();
+      }
+      lock.unlock();
+
+      Superclass::LoadVolume(t, n, buffer);
+    }
+
+    void WaitUntilVolume0Started()
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Condition.wait(lock, [this] { return m_Volume0Started; });
+    }
+
+    bool m_Volume1LoadedMeanwhile;
+
+  protected:
+    WaitingVolumeProvider(size_t volumeSize)
+      : CountingVolumeProvider(volumeSize), m_Volume1LoadedMeanwhile(false), m_Volume0Started(false), m_Volume1Loaded(false)
+    {
+    }
+
+  private:
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Volume0Started;
+    bool m_Volume1Loaded;
+  };
+}
+
+class mitkImageVolumeProviderTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageVolumeProviderTestSuite);
+  MITK_TEST(TestVolumesAreLoadedOnDemand);
+  MITK_TEST(TestLeastRecentlyUsedVolumesAreReleased);
+  MITK_TEST(TestWrittenVolumesAreKept);
+  MITK_TEST(TestChannelAccessLoadsAllVolumes);
+  MITK_TEST(TestVolumesAreLoadedConcurrently);
+  MITK_TEST(TestConcurrentRequestsLoadVolumeOnce);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  CountingVolumeProvider::Pointer m_Provider;
+
+  unsigned char ReadFirstVoxel(unsigned int t)
+  {
+    mitk::ImageReadAccessor accessor(m_Image, m_Image->GetVolumeData(t));
+    return *static_cast<const unsigned char *>(accessor.GetData());
+  }
+
+public:
+  void setUp() override
+  {
+    std::array<unsigned int, 4> dimensions = {16, 16, 8, TimeSteps};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 4, dimensions.data());
+    m_Provider = CountingVolumeProvider::New(VolumeSize);
+  }
+
+  void tearDown() override
+  {
+    m_Image = nullptr;
+    m_Provider = nullptr;
+  }
+
+  void TestVolumesAreLoadedOnDemand()
+  {
+    m_Image->SetVolumeProvider(m_Provider);
+
+    CPPUNIT_ASSERT_EQUAL(0u, m_Provider->m_LoadCount.load());
+    CPPUNIT_ASSERT(m_Image->IsVolumeSet(3));
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(3), ReadFirstVoxel(3));
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(3), ReadFirstVoxel(3));
+    CPPUNIT_ASSERT_EQUAL(1u, m_Provider->m_LoadCount.load());
+
+    mitk::ImageReadAccessor sliceAccessor(m_Image, m_Image->GetSliceData(2, 5));
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(5), *static_cast<const unsigned char *>(sliceAccessor.GetData()));
+    CPPUNIT_ASSERT_EQUAL(2u, m_Provider->m_LoadCount.load());
+  }
+
+  void TestLeastRecentlyUsedVolumesAreReleased()
+  {
+    m_Image->SetVolumeProvider(m_Provider, 2 * VolumeSize);
+
+    for (unsigned int t = 0; t < TimeSteps; ++t)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(t), ReadFirstVoxel(t));
+      CPPUNIT_ASSERT(m_Image->GetProvidedVolumesMemorySize() <= 2 * VolumeSize);
+    }
+    CPPUNIT_ASSERT_EQUAL(TimeSteps, m_Provider->m_LoadCount.load());
+
+    // the last two time steps are still resident, the first one has to be loaded again
+    ReadFirstVoxel(TimeSteps - 1);
+    ReadFirstVoxel(TimeSteps - 2);
+    CPPUNIT_ASSERT_EQUAL(TimeSteps, m_Provider->m_LoadCount.load());
+    ReadFirstVoxel(0);
+    CPPUNIT_ASSERT_EQUAL(TimeSteps + 1, m_Provider->m_LoadCount.load());
+  }
+
+  void TestWrittenVolumesAreKept()
+  {
+    m_Image->SetVolumeProvider(m_Provider, VolumeSize);
+
+    {
+      mitk::ImageWriteAccessor accessor(m_Image, m_Image->GetVolumeData(1));
+      *static_cast<unsigned char *>(accessor.GetData()) = 42;
+    }
+
+    for (unsigned int t = 2; t < TimeSteps; ++t)
+    {
+      ReadFirstVoxel(t);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(42), ReadFirstVoxel(1));
+    CPPUNIT_ASSERT_EQUAL(TimeSteps - 1, m_Provider->m_LoadCount.load());
+  }
+
+  void TestChannelAccessLoadsAllVolumes()
+  {
+    m_Image->SetVolumeProvider(m_Provider, VolumeSize);
+
+    mitk::ImageReadAccessor accessor(m_Image);
+    const auto *data = static_cast<const unsigned char *>(accessor.GetData());
+
+    for (unsigned int t = 0; t < TimeSteps; ++t)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(t), data[t * VolumeSize]);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), m_Image->GetProvidedVolumesMemorySize());
+  }
+
+  void TestVolumesAreLoadedConcurrently()
+  {
+    WaitingVolumeProvider::Pointer provider = WaitingVolumeProvider::New(VolumeSize);
+    m_Image->SetVolumeProvider(provider);
+
+    unsigned char firstVoxel = 255;
+    std::thread loader([this, &firstVoxel] { firstVoxel = ReadFirstVoxel(0); });
+    provider->WaitUntilVolume0Started();
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(1), ReadFirstVoxel(1));
+    loader.join();
+
+    CPPUNIT_ASSERT_MESSAGE("Loading a volume blocked loading another one", provider->m_Volume1LoadedMeanwhile);
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(0), firstVoxel);
+  }
+
+  void TestConcurrentRequestsLoadVolumeOnce()
+  {
+    m_Image->SetVolumeProvider(m_Provider);
+
+    std::vector<std::thread> threads;
+    std::atomic<unsigned int> wrongValues(0);
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+      threads.emplace_back([this, &wrongValues] {
+        if (ReadFirstVoxel(4) != 4)
+          ++wrongValues;
+      });
+    }
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+
+    CPPUNIT_ASSERT_EQUAL(0u, wrongValues.load());
+    CPPUNIT_ASSERT_EQUAL(1u, m_Provider->m_LoadCount.load());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageVolumeProvider)
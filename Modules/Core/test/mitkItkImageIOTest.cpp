@@ -24,8 +24,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkExtractSliceFilter.h>
 
 #include "itksys/SystemTools.hxx"
+#include <itkImageFileWriter.h>
+#include <itkImageIOFactory.h>
 #include <itkImageRegionIterator.h>
 
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 
@@ -47,6 +50,7 @@ class mitkItkImageIOTestSuite : public mitk::TestFixture
   MITK_TEST(TestWrite3DImageWithTwoPlanes);
   MITK_TEST(TestWrite3DplusT_ArbitraryTG);
   MITK_TEST(TestWrite3DplusT_ProportionalTG);
+  MITK_TEST(TestStreamedRead3DplusT);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -66,6 +70,58 @@ public:
     TestImageWriter("3D+t-ITKIO-TestData/LinearModel_4D_prop_time_geometry.nrrd");
   }
 
+  void TestStreamedRead3DplusT()
+  {
+    // NRRD cannot be read streamed, an uncompressed MetaImage file can
+    typedef itk::Image<short, 4> ImageType4D;
+    ImageType4D::SizeType size;
+    size[0] = 128;
+    size[1] = 128;
+    size[2] = 40;
+    size[3] = 3;
+    ImageType4D::Pointer itkImage = ImageType4D::New();
+    itkImage->SetRegions(size);
+    itkImage->Allocate();
+
+    short value = 0;
+    itk::ImageRegionIterator<ImageType4D> it(itkImage, itkImage->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      it.Set(value++);
+    }
+
+    const std::string sourcefile = mitk::IOUtil::CreateTemporaryFile("StreamedRead3DplusT-XXXXXX.mha");
+
+    typedef itk::ImageFileWriter<ImageType4D> WriterType;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName(sourcefile);
+    writer->SetInput(itkImage);
+    writer->SetUseCompression(false);
+    writer->Update();
+
+    // ItkImageIO only falls back to reading the whole file if the ImageIO cannot stream it
+    itk::ImageIOBase::Pointer imageIO =
+      itk::ImageIOFactory::CreateImageIO(sourcefile.c_str(), itk::ImageIOFactory::ReadMode);
+    CPPUNIT_ASSERT_MESSAGE("Test file can be read", imageIO.IsNotNull());
+    imageIO->SetFileName(sourcefile);
+    imageIO->ReadImageInformation();
+    CPPUNIT_ASSERT_MESSAGE("Test file can be read streamed", imageIO->CanStreamRead());
+
+    mitk::Image::Pointer reference = mitk::IOUtil::Load<mitk::Image>(sourcefile);
+
+    // a time step has 1.25 MB, so a budget of 1 MB reads it in two slabs
+    mitk::IFileReader::Options options;
+    options["Streaming read"] = us::Any(true);
+    options["Streaming memory budget (MB)"] = us::Any(1);
+
+    mitk::Image::Pointer streamed = mitk::IOUtil::Load<mitk::Image>(sourcefile, options);
+    std::remove(sourcefile.c_str());
+
+    CPPUNIT_ASSERT_MESSAGE("Streamed image is loaded", streamed.IsNotNull());
+    CPPUNIT_ASSERT_MESSAGE("Streamed image equals the image read at once",
+                           mitk::Equal(*reference, *streamed, mitk::eps, true));
+  }
+
   void TestImageWriterSimple()
   {
     // TODO
@@ -0,0 +1,78 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkParallelFor.h>
+#include <mitkTestFixture.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+class mitkParallelForTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkParallelForTestSuite);
+  MITK_TEST(ParallelFor_EachItemProcessedOnce);
+  MITK_TEST(ParallelFor_OneThread_ItemsInOrder);
+  MITK_TEST(ParallelFor_NoItems_FunctionNotCalled);
+  MITK_TEST(ParallelFor_Exception_Rethrown);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void ParallelFor_EachItemProcessedOnce()
+  {
+    const std::size_t numberOfItems = 10000;
+    std::vector<std::atomic<int>> calls(numberOfItems);
+    for (auto &count : calls)
+      count = 0;
+
+    mitk::ParallelFor(numberOfItems, [&](std::size_t i) { ++calls[i]; }, 4);
+
+    for (std::size_t i = 0; i < numberOfItems; ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Each item is processed exactly once", 1, calls[i].load());
+    }
+  }
+
+  void ParallelFor_OneThread_ItemsInOrder()
+  {
+    std::vector<std::size_t> items;
+    mitk::ParallelFor(5, [&](std::size_t i) { items.push_back(i); }, 1);
+
+    const std::vector<std::size_t> expected = {0, 1, 2, 3, 4};
+    CPPUNIT_ASSERT_MESSAGE("One thread processes the items in order", items == expected);
+  }
+
+  void ParallelFor_NoItems_FunctionNotCalled()
+  {
+    bool called = false;
+    mitk::ParallelFor(0, [&](std::size_t) { called = true; });
+    CPPUNIT_ASSERT_MESSAGE("Function is not called without items", !called);
+  }
+
+  void ParallelFor_Exception_Rethrown()
+  {
+    CPPUNIT_ASSERT_THROW(mitk::ParallelFor(100,
+                                           [](std::size_t i) {
+                                             if (i == 42)
+                                               throw std::runtime_error("item failed");
+                                           },
+                                           4),
+                         std::runtime_error);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkParallelFor)
@@ -0,0 +1,103 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+
+#include <vtkMitkPlaneIntersectingCellsFilter.h>
+
+#include <vtkCutter.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+
+class vtkMitkPlaneIntersectingCellsFilterTestHelper
+{
+public:
+  static void CompareCuts(vtkPolyData *expected, vtkPolyData *result, const char *plane)
+  {
+    MITK_TEST_CONDITION_REQUIRED(expected->GetNumberOfLines() == result->GetNumberOfLines(),
+                                 "Cut of the intersecting cells has the same number of lines (" << plane << " plane, expected "
+                                   << expected->GetNumberOfLines() << ", actual " << result->GetNumberOfLines() << ")");
+    MITK_TEST_CONDITION_REQUIRED(expected->GetNumberOfPoints() == result->GetNumberOfPoints(),
+                                 "Cut of the intersecting cells has the same number of points (" << plane << " plane, expected "
+                                   << expected->GetNumberOfPoints() << ", actual " << result->GetNumberOfPoints() << ")");
+  }
+};
+
+/**
+*  Test for vtkMitkPlaneIntersectingCellsFilter.
+*
+*  The cut of the extracted cells has to be the same as the cut of the whole surface.
+*/
+int vtkMitkPlaneIntersectingCellsFilterTest(int, char *[])
+{
+  // always start with this!
+  MITK_TEST_BEGIN("vtkMitkPlaneIntersectingCellsFilterTest")
+
+  auto sphere = vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetRadius(10.0);
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+  sphere->Update();
+
+  auto plane = vtkSmartPointer<vtkPlane>::New();
+
+  auto cutter = vtkSmartPointer<vtkCutter>::New();
+  cutter->SetCutFunction(plane);
+  cutter->SetInputConnection(sphere->GetOutputPort());
+
+  auto filter = vtkSmartPointer<vtkMitkPlaneIntersectingCellsFilter>::New();
+  filter->SetPlane(plane);
+  filter->SetInputConnection(sphere->GetOutputPort());
+
+  auto filteredCutter = vtkSmartPointer<vtkCutter>::New();
+  filteredCutter->SetCutFunction(plane);
+  filteredCutter->SetInputConnection(filter->GetOutputPort());
+
+  // scroll through axial planes, the index is built once
+  plane->SetNormal(0.0, 0.0, 1.0);
+  for (double z = -11.0; z <= 11.0; z += 0.7)
+  {
+    plane->SetOrigin(0.0, 0.0, z);
+    cutter->Update();
+    filteredCutter->Update();
+    vtkMitkPlaneIntersectingCellsFilterTestHelper::CompareCuts(cutter->GetOutput(), filteredCutter->GetOutput(), "axial");
+  }
+
+  MITK_TEST_CONDITION_REQUIRED(filter->GetOutput()->GetNumberOfCells() < sphere->GetOutput()->GetNumberOfCells(),
+                               "Only a part of the cells is passed to the cutter");
+
+  // an oblique plane rebuilds the index
+  plane->SetNormal(1.0, 2.0, 3.0);
+  for (double x = -9.0; x <= 9.0; x += 1.3)
+  {
+    plane->SetOrigin(x, 0.0, 0.0);
+    cutter->Update();
+    filteredCutter->Update();
+    vtkMitkPlaneIntersectingCellsFilterTestHelper::CompareCuts(cutter->GetOutput(), filteredCutter->GetOutput(), "oblique");
+  }
+
+  // modifying the surface rebuilds the index
+  sphere->SetRadius(5.0);
+  plane->SetOrigin(0.0, 0.0, 4.0);
+  cutter->Update();
+  filteredCutter->Update();
+  vtkMitkPlaneIntersectingCellsFilterTestHelper::CompareCuts(cutter->GetOutput(), filteredCutter->GetOutput(), "modified");
+  MITK_TEST_CONDITION_REQUIRED(filteredCutter->GetOutput()->GetNumberOfLines() > 0, "Modified surface is cut");
+
+  MITK_TEST_END()
+}
@@ -153,6 +153,62 @@ int vtkMitkThickSlicesFilterTest(int, char *[])
   thickSliceFilter->Update();
   vtkMitkThickSlicesFilterTestHelper::EvaluateResult(6, thickSliceFilter->GetOutput(), "Mean");
 
+  //////////////////////////////////////////////////////////////////////////
+  // Sliding window: the slab 0, 1, 2 is shifted to 1, 2, 3, back to 0, 1, 2 and then to 7, 0, 1
+  thickSliceFilter->SlidingWindowOn();
+  thickSliceFilter->SetInputData(testImage1->GetVtkImageData());
+  thickSliceFilter->SetThickSliceMode(0);
+  thickSliceFilter->Modified();
+  thickSliceFilter->Update();
+
+  mitk::Image::Pointer nextSlice = vtkMitkThickSlicesFilterTestHelper::CreateTestImage(3, 3);
+  MITK_TEST_CONDITION_REQUIRED(thickSliceFilter->ShiftSlab(nextSlice->GetVtkImageData(), 1),
+                               "Slice is appended to the slab");
+
+  // MaxIP
+  thickSliceFilter->Update();
+  vtkMitkThickSlicesFilterTestHelper::EvaluateResult(3, thickSliceFilter->GetOutput(), "Shifted MaxIP");
+
+  // Sum
+  thickSliceFilter->SetThickSliceMode(1);
+  thickSliceFilter->Modified();
+  thickSliceFilter->Update();
+  vtkMitkThickSlicesFilterTestHelper::EvaluateResult(2, thickSliceFilter->GetOutput(), "Shifted Sum");
+
+  // MinIP
+  thickSliceFilter->SetThickSliceMode(3);
+  thickSliceFilter->Modified();
+  thickSliceFilter->Update();
+  vtkMitkThickSlicesFilterTestHelper::EvaluateResult(1, thickSliceFilter->GetOutput(), "Shifted MinIP");
+
+  // Mean
+  thickSliceFilter->SetThickSliceMode(4);
+  thickSliceFilter->Modified();
+  thickSliceFilter->Update();
+  vtkMitkThickSlicesFilterTestHelper::EvaluateResult(3, thickSliceFilter->GetOutput(), "Shifted Mean");
+
+  mitk::Image::Pointer previousSlice = vtkMitkThickSlicesFilterTestHelper::CreateTestImage(0, 0);
+  MITK_TEST_CONDITION_REQUIRED(thickSliceFilter->ShiftSlab(previousSlice->GetVtkImageData(), -1),
+                               "Slice is inserted in front of the slab");
+  mitk::Image::Pointer firstSlice = vtkMitkThickSlicesFilterTestHelper::CreateTestImage(7, 7);
+  MITK_TEST_CONDITION_REQUIRED(thickSliceFilter->ShiftSlab(firstSlice->GetVtkImageData(), -1),
+                               "Slice is inserted in front of the slab");
+
+  // Weighted depends on the order of the slices
+  thickSliceFilter->SetThickSliceMode(2);
+  thickSliceFilter->Update();
+  vtkMitkThickSlicesFilterTestHelper::EvaluateResult(0, thickSliceFilter->GetOutput(), "Shifted Weighted");
+
+  // MaxIP
+  thickSliceFilter->SetThickSliceMode(0);
+  thickSliceFilter->Modified();
+  thickSliceFilter->Update();
+  vtkMitkThickSlicesFilterTestHelper::EvaluateResult(7, thickSliceFilter->GetOutput(), "Shifted MaxIP");
+
+  // slices that do not fit into the slab are rejected
+  MITK_TEST_CONDITION_REQUIRED(!thickSliceFilter->ShiftSlab(testImage2->GetVtkImageData(), 1),
+                               "Slab is rejected as slice");
+
   thickSliceFilter->Delete();
 
   MITK_TEST_END()
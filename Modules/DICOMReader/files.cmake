@@ -4,6 +4,7 @@ set(CPP_FILES
   mitkBaseDICOMReaderService.cpp
   mitkDICOMFileReader.cpp
   mitkDICOMTagScanner.cpp
+  mitkDICOMTagScanIndex.cpp
   mitkDICOMGDCMTagScanner.cpp
   mitkDICOMDCMTKTagScanner.cpp
   mitkDICOMImageBlockDescriptor.cpp
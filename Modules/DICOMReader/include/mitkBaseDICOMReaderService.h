@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkAbstractFileReader.h>
 #include <mitkDICOMFileReader.h>
+#include <mitkDICOMTagScanIndex.h>
 
 #include "MitkDICOMReaderExports.h"
 
@@ -27,6 +28,10 @@ namespace mitk {
   /**
   Base class for service wrappers that make DICOMFileReader from
   the DICOMReader module usable.
+
+  The scans for the tags of interest are kept in a DICOMTagScanIndex that is shared by all
+  clones of a service, so reading unchanged files again does not parse their headers again.
+  The index is kept in memory only, it is not saved between sessions.
   */
 class MITKDICOMREADER_EXPORT BaseDICOMReaderService : public AbstractFileReader
 {
@@ -50,6 +55,9 @@ protected:
   /** Returns the reader instance that should be used. The descission may be based
    * one the passed relevant file list.*/
   virtual mitk::DICOMFileReader::Pointer GetReader(const mitk::StringList& relevantFiles) const = 0;
+
+  /** Results of the tag scans of previous Read() calls.*/
+  DICOMTagScanIndex::Pointer m_ScanIndex;
 };
 
 }
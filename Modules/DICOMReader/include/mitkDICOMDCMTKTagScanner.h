@@ -30,7 +30,8 @@ namespace mitk
     \ingroup DICOMReaderModule
     \brief Encapsulates the tag scanning process for a set of DICOM files.
 
-    For the scanning process it uses DCMTK functionality.
+    For the scanning process it uses DCMTK functionality. The files are parsed
+    in parallel, each only up to the last top level tag of interest.
   */
   class MITKDICOMREADER_EXPORT DICOMDCMTKTagScanner : public DICOMTagScanner
   {
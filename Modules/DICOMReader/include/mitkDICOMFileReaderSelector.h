@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define mitkDICOMFileReaderSelector_h
 
 #include "mitkDICOMFileReader.h"
+#include "mitkDICOMTagScanIndex.h"
 
 #include <usModuleResource.h>
 
@@ -79,6 +80,11 @@ class MITKDICOMREADER_EXPORT DICOMFileReaderSelector : public itk::LightObject
     /// Input files
     const StringList& GetInputFiles() const;
 
+    /// \brief Optional index of previous tag scans. The tags of files in the index
+    /// are not scanned again, newly scanned files are added to it.
+    void SetScanIndex(DICOMTagScanIndex* index);
+    DICOMTagScanIndex* GetScanIndex() const;
+
     /// Execute the analysis and selection process. The first reader with a minimal number of outputs will be returned.
     DICOMFileReader::Pointer GetFirstReaderWithMinimumNumberOfOutputImages();
 
@@ -96,6 +102,7 @@ class MITKDICOMREADER_EXPORT DICOMFileReaderSelector : public itk::LightObject
     StringList m_PossibleConfigurations;
     StringList m_InputFilenames;
     ReaderList m_Readers;
+    DICOMTagScanIndex::Pointer m_ScanIndex;
 
  };
 
@@ -19,8 +19,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMTagCache.h"
 
+#include <map>
 #include <set>
 #include <memory>
+#include <unordered_map>
 
 #include <gdcmScanner.h>
 
@@ -47,6 +49,18 @@ namespace mitk
 
       void InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles);
 
+      typedef std::map<DICOMTag, std::string> TagValueMapType;
+
+      /**
+        \brief Initializes the cache with the tag values of each input file.
+        The values are copied, the cache does not refer to a gdcm::Scanner then.
+      */
+      void InitCache(const std::set<DICOMTag>& scannedTags, const StringList& inputFiles, const std::vector<TagValueMapType>& values);
+
+      /**
+        \brief Scanner the cache was initialized with.
+        \throw mitk::Exception if the cache was not initialized with a scanner.
+      */
       const gdcm::Scanner& GetScanner() const;
 
   protected:
@@ -60,6 +74,12 @@ namespace mitk
 
       DICOMDatasetAccessingImageFrameList m_ScanResult;
 
+      /** \brief Index of the first frame of every file in m_ScanResult */
+      std::unordered_map<std::string, std::size_t> m_FrameIndex;
+
+      /** \brief Storage of the values if the cache was not initialized with a scanner */
+      std::set<std::string> m_Values;
+
     private:
       DICOMGDCMTagCache(const DICOMGDCMTagCache&);
   };
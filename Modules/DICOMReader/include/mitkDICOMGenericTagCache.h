@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMTagCache.h"
 #include "mitkDICOMGenericImageFrameInfo.h"
 
+#include <unordered_map>
+
 namespace mitk
 {
 
@@ -51,6 +53,9 @@ namespace mitk
 
       DICOMDatasetAccessingImageFrameList m_ScanResult;
 
+      /** \brief Position of every frame info in m_ScanResult */
+      std::unordered_map<const DICOMImageFrameInfo*, std::size_t> m_FrameIndex;
+
     private:
       DICOMGenericTagCache(const DICOMGenericTagCache&);
   };
@@ -0,0 +1,114 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkDICOMTagScanIndex_h
+#define mitkDICOMTagScanIndex_h
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <itkObject.h>
+
+#include "mitkCommon.h"
+#include "mitkDICOMTagPath.h"
+
+namespace mitk
+{
+
+  /**
+    \ingroup DICOMReaderModule
+    \brief Remembers the tag values that a DICOMTagScanner found in files.
+
+    The index stores, for every scanned file, its size and modification time,
+    the tag paths it was scanned for and the values that were found. If a
+    DICOMTagScanner has an index (see DICOMTagScanner::SetScanIndex()), it only
+    parses the files that are not in the index, have changed, or were scanned for
+    fewer tags than requested now, and adds the results to the index.
+
+    The index can be saved to and loaded from a file, so that opening the same
+    set of files again does not parse any file header.
+
+    All methods may be called from several threads at the same time, so several
+    scanners can share one index.
+  */
+  class MITKDICOMREADER_EXPORT DICOMTagScanIndex : public itk::Object
+  {
+    public:
+
+      mitkClassMacroItkParent(DICOMTagScanIndex, itk::Object);
+      itkFactorylessNewMacro( DICOMTagScanIndex );
+
+      typedef std::set<DICOMTagPath> TagPathSetType;
+      typedef std::vector<std::pair<DICOMTagPath, std::string> > TagValueListType;
+
+      /**
+        \brief Returns the stored values of the file, if it has not changed since
+        it was added and was scanned for (at least) the given paths.
+        \param readable is set to false if the file could not be read as DICOM file.
+      */
+      bool Lookup(const std::string& filename, const TagPathSetType& paths, bool& readable, TagValueListType& values) const;
+
+      /**
+        \brief Adds or replaces the scan result of a file.
+      */
+      void Update(const std::string& filename, const TagPathSetType& paths, bool readable, const TagValueListType& values);
+
+      unsigned int GetNumberOfEntries() const;
+
+      void Clear();
+
+      /**
+        \brief Reads an index file written by Save() and replaces the content of the index.
+        \return false if the file does not exist or is no valid index file. The index is empty then.
+      */
+      bool Load(const std::string& indexFilename);
+
+      /**
+        \brief Writes the index to a file.
+        \throw mitk::Exception if the file cannot be written.
+      */
+      void Save(const std::string& indexFilename) const;
+
+    protected:
+
+      DICOMTagScanIndex();
+      ~DICOMTagScanIndex() override;
+
+      struct Entry
+      {
+        unsigned long long FileSize;
+        long long ModifiedTime;
+        bool Readable;
+        TagPathSetType ScannedPaths;
+        TagValueListType Values;
+      };
+
+      /** \brief Size and modification time of a file, false if the file does not exist */
+      static bool GetFileStamp(const std::string& filename, unsigned long long& fileSize, long long& modifiedTime);
+
+      std::map<std::string, Entry> m_Entries;
+      mutable std::mutex m_Mutex;
+
+    private:
+      DICOMTagScanIndex(const DICOMTagScanIndex&);
+  };
+}
+
+#endif
@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMTagPath.h"
 #include "mitkDICOMTagCache.h"
 #include "mitkDICOMDatasetAccessingImageFrameInfo.h"
+#include "mitkDICOMTagScanIndex.h"
 
 namespace mitk
 {
@@ -90,6 +91,20 @@ namespace mitk
       */
       virtual DICOMTagCache::Pointer GetScanCache() const = 0;
 
+      /**
+      \brief Number of threads that parse files in Scan(). Defaults to the number of cores.
+      */
+      itkSetMacro(NumberOfThreads, unsigned int);
+      itkGetConstMacro(NumberOfThreads, unsigned int);
+
+      /**
+      \brief Optional index with the results of previous scans.
+      Files that are found in the index are not parsed again, all parsed
+      files are added to the index by Scan().
+      */
+      itkSetObjectMacro(ScanIndex, DICOMTagScanIndex);
+      itkGetObjectMacro(ScanIndex, DICOMTagScanIndex);
+
     protected:
 
       /** \brief Return active C locale */
@@ -108,6 +123,9 @@ namespace mitk
       DICOMTagScanner();
       ~DICOMTagScanner() override;
 
+      unsigned int m_NumberOfThreads;
+      DICOMTagScanIndex::Pointer m_ScanIndex;
+
     private:
 
       static itk::MutexLock::Pointer s_LocaleMutex;
@@ -23,13 +23,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkGDCMImageIO.h>
 
+#include "MitkDICOMReaderExports.h"
+
 /* Forward deceleration of an DCMTK class. Used in the txx but part of the interface.*/
 class OFDateTime;
 
 namespace mitk
 {
 
-class ITKDICOMSeriesReaderHelper
+class MITKDICOMREADER_EXPORT ITKDICOMSeriesReaderHelper
 {
   public:
 
@@ -83,10 +85,35 @@ class ITKDICOMSeriesReaderHelper
     */
     static TimeGeometry::Pointer GenerateTimeGeometry(const BaseGeometry* templateGeometry, const TimeBoundsList& boundsList);
 
+  protected:
+
+    /** Resamples the volume so that the shear of a gantry tilted acquisition is undone.
+     Protected so that tests can apply it to volumes read by other means.*/
     template <typename ImageType>
     typename ImageType::Pointer
     FixUpTiltedGeometry( ImageType* input, const GantryTiltInformation& tiltInfo );
 
+  private:
+
+    /** Determines origin, spacing, direction and size of the volume that itk::ImageSeriesReader
+     would create from the passed files. Only the image information of the files is read, no pixel data.
+     The returned image has no buffer.*/
+    template <typename ImageType>
+    static typename ImageType::Pointer
+    ReadVolumeInformation( const StringContainer& filenames, itk::GDCMImageIO::Pointer& io );
+
+    /** Decodes the passed files in parallel and copies each of them directly to its position
+     in the volume buffer, i.e. the n-th file fills the n-th slice (block of numberOfPixels/filenames.size() pixels).
+     @throw mitk::Exception if a file does not have the expected number of pixels.*/
+    template <typename PixelType>
+    static void
+    ReadSlicesIntoBuffer( const StringContainer& filenames, PixelType* buffer, std::size_t numberOfPixels );
+
+    /** Passes the buffer of the itk image to the time step of the mitk image without copying it.*/
+    template <typename ImageType>
+    static void
+    TakeOverVolume( Image* image, ImageType* volume, unsigned int timeStep );
+
     template <typename PixelType>
     Image::Pointer
     LoadDICOMByITK( const StringContainer& filenames,
@@ -14,7 +14,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkITKDICOMSeriesReaderHelper.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkParallelFor.h"
 
+#include <itkImageFileReader.h>
 #include <itkImageSeriesReader.h>
 #include <itkResampleImageFilter.h>
 //#include <itkAffineTransform.h>
@@ -23,19 +26,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "dcmtk/ofstd/ofdatime.h"
 
-template <typename PixelType>
-mitk::Image::Pointer
+#include <algorithm>
+
+template <typename ImageType>
+typename ImageType::Pointer
 mitk::ITKDICOMSeriesReaderHelper
-::LoadDICOMByITK(
-    const StringContainer& filenames,
-    bool correctTilt,
-    const GantryTiltInformation& tiltInfo,
-    itk::GDCMImageIO::Pointer& io)
+::ReadVolumeInformation( const StringContainer& filenames, itk::GDCMImageIO::Pointer& io )
 {
-  /******** Normal Case, 3D (also for GDCM < 2 usable) ***************/
-  mitk::Image::Pointer image = mitk::Image::New();
-
-  typedef itk::Image<PixelType, 3> ImageType;
   typedef itk::ImageSeriesReader<ImageType> ReaderType;
 
   io = itk::GDCMImageIO::New();
@@ -49,17 +46,90 @@ mitk::ITKDICOMSeriesReaderHelper
                              // see NormalDirectionConsistencySorter.
 
   reader->SetFileNames(filenames);
-  reader->Update();
-  typename ImageType::Pointer readVolume = reader->GetOutput();
+  reader->UpdateOutputInformation();
+
+  typename ImageType::Pointer volume = ImageType::New();
+  volume->CopyInformation(reader->GetOutput());
+  volume->SetRegions(reader->GetOutput()->GetLargestPossibleRegion());
+  return volume;
+}
+
+template <typename PixelType>
+void
+mitk::ITKDICOMSeriesReaderHelper
+::ReadSlicesIntoBuffer( const StringContainer& filenames, PixelType* buffer, std::size_t numberOfPixels )
+{
+  if (filenames.empty() || numberOfPixels % filenames.size() != 0)
+  {
+    mitkThrow() << "Cannot distribute " << numberOfPixels << " pixels over " << filenames.size() << " DICOM files.";
+  }
+  const std::size_t pixelsPerFile = numberOfPixels / filenames.size();
+
+  // each file is read by its own reader, so the files can be decoded concurrently
+  typedef itk::Image<PixelType, 3> FileImageType;
+  typedef itk::ImageFileReader<FileImageType> FileReaderType;
+
+  mitk::ParallelFor(filenames.size(), [&](std::size_t fileIndex)
+  {
+    typename FileReaderType::Pointer reader = FileReaderType::New();
+    reader->SetImageIO(itk::GDCMImageIO::New());
+    reader->SetFileName(filenames[fileIndex]);
+    reader->Update();
+
+    const FileImageType* fileImage = reader->GetOutput();
+    if (fileImage->GetLargestPossibleRegion().GetNumberOfPixels() != pixelsPerFile)
+    {
+      mitkThrow() << "DICOM file " << filenames[fileIndex] << " has " << fileImage->GetLargestPossibleRegion().GetNumberOfPixels()
+                  << " pixels, expected " << pixelsPerFile << " like all other files of the volume.";
+    }
+
+    std::copy(fileImage->GetBufferPointer(), fileImage->GetBufferPointer() + pixelsPerFile, buffer + fileIndex * pixelsPerFile);
+  });
+}
+
+template <typename ImageType>
+void
+mitk::ITKDICOMSeriesReaderHelper
+::TakeOverVolume( Image* image, ImageType* volume, unsigned int timeStep )
+{
+  image->SetImportVolume(volume->GetBufferPointer(), timeStep, 0, Image::ManageMemory);
+  volume->GetPixelContainer()->ContainerManageMemoryOff();
+}
+
+template <typename PixelType>
+mitk::Image::Pointer
+mitk::ITKDICOMSeriesReaderHelper
+::LoadDICOMByITK(
+    const StringContainer& filenames,
+    bool correctTilt,
+    const GantryTiltInformation& tiltInfo,
+    itk::GDCMImageIO::Pointer& io)
+{
+  /******** Normal Case, 3D (also for GDCM < 2 usable) ***************/
+  mitk::Image::Pointer image = mitk::Image::New();
+
+  typedef itk::Image<PixelType, 3> ImageType;
+
+  typename ImageType::Pointer volume = ReadVolumeInformation<ImageType>(filenames, io);
+  const std::size_t numberOfPixels = volume->GetLargestPossibleRegion().GetNumberOfPixels();
 
   // if we detected that the images are from a tilted gantry acquisition, we need to push some pixels into the right position
   if (correctTilt)
   {
-    readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
-  }
+    volume->Allocate();
+    ReadSlicesIntoBuffer(filenames, volume->GetBufferPointer(), numberOfPixels);
+    volume = FixUpTiltedGeometry( volume.GetPointer(), tiltInfo );
 
-  image->InitializeByItk(readVolume.GetPointer());
-  image->SetImportVolume(readVolume->GetBufferPointer());
+    image->InitializeByItk(volume.GetPointer());
+    TakeOverVolume(image.GetPointer(), volume.GetPointer(), 0);
+  }
+  else
+  {
+    // decode directly into the memory of the mitk image
+    image->InitializeByItk(volume.GetPointer());
+    mitk::ImageWriteAccessor accessor(image, image->GetVolumeData(0));
+    ReadSlicesIntoBuffer(filenames, static_cast<PixelType*>(accessor.GetData()), numberOfPixels);
+  }
 
 #ifdef MBILOG_ENABLE_DEBUG
 
@@ -104,41 +174,18 @@ mitk::ITKDICOMSeriesReaderHelper
   mitk::Image::Pointer image = mitk::Image::New();
 
   typedef itk::Image<PixelType, 4> ImageType;
-  typedef itk::ImageSeriesReader<ImageType> ReaderType;
-
-  io = itk::GDCMImageIO::New();
-  typename ReaderType::Pointer reader = ReaderType::New();
-
-  reader->SetImageIO(io);
-  reader->ReverseOrderOff(); // at this point we require an order of input images so that
-                             // the direction between the origin of the first and the last slice
-                             // is the same direction as the image normals! Otherwise we might
-                             // see images upside down. Unclear whether this is a bug in MITK,
-                             // see NormalDirectionConsistencySorter.
-
-
-  unsigned int currentTimeStep = 0;
-
-#ifdef MBILOG_ENABLE_DEBUG
-  MITK_DEBUG << "Start loading timestep " << currentTimeStep;
-  MITK_DEBUG_OUTPUT_FILELIST( filenamesForTimeSteps.front() )
-#endif // MBILOG_ENABLE_DEBUG
 
-  reader->SetFileNames(filenamesForTimeSteps.front());
-  reader->Update();
-  typename ImageType::Pointer readVolume = reader->GetOutput();
+  // all time steps have the geometry of the first one
+  typename ImageType::Pointer volume = ReadVolumeInformation<ImageType>(filenamesForTimeSteps.front(), io);
+  const std::size_t numberOfPixels = volume->GetLargestPossibleRegion().GetNumberOfPixels();
 
-  // if we detected that the images are from a tilted gantry acquisition, we need to push some pixels into the right position
-  if (correctTilt)
+  if (!correctTilt)
   {
-    readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
+    image->InitializeByItk(volume.GetPointer(), 1, numberOfTimeSteps);
   }
 
-  image->InitializeByItk(readVolume.GetPointer(), 1, numberOfTimeSteps);
-  image->SetImportVolume(readVolume->GetBufferPointer(), currentTimeStep++); // timestep 0
-
-  // for other time-steps
-  for (auto timestepsIter = ++(filenamesForTimeSteps.cbegin()); // start with SECOND entry
+  unsigned int currentTimeStep = 0;
+  for (auto timestepsIter = filenamesForTimeSteps.cbegin();
       timestepsIter != filenamesForTimeSteps.cend();
       ++currentTimeStep, ++timestepsIter)
   {
@@ -147,16 +194,28 @@ mitk::ITKDICOMSeriesReaderHelper
     MITK_DEBUG_OUTPUT_FILELIST( *timestepsIter )
 #endif // MBILOG_ENABLE_DEBUG
 
-    reader->SetFileNames( *timestepsIter );
-    reader->Update();
-    readVolume = reader->GetOutput();
-
+    // if we detected that the images are from a tilted gantry acquisition, we need to push some pixels into the right position
     if (correctTilt)
     {
-      readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
+      typename ImageType::Pointer readVolume = ImageType::New();
+      readVolume->CopyInformation(volume);
+      readVolume->SetRegions(volume->GetLargestPossibleRegion());
+      readVolume->Allocate();
+      ReadSlicesIntoBuffer(*timestepsIter, readVolume->GetBufferPointer(), numberOfPixels);
+      readVolume = FixUpTiltedGeometry( readVolume.GetPointer(), tiltInfo );
+
+      if (currentTimeStep == 0)
+      {
+        image->InitializeByItk(readVolume.GetPointer(), 1, numberOfTimeSteps);
+      }
+      TakeOverVolume(image.GetPointer(), readVolume.GetPointer(), currentTimeStep);
+    }
+    else
+    {
+      // decode directly into the memory of the mitk image
+      mitk::ImageWriteAccessor accessor(image, image->GetVolumeData(currentTimeStep));
+      ReadSlicesIntoBuffer(*timestepsIter, static_cast<PixelType*>(accessor.GetData()), numberOfPixels);
     }
-
-    image->SetImportVolume(readVolume->GetBufferPointer(), currentTimeStep);
   }
 
 #ifdef MBILOG_ENABLE_DEBUG
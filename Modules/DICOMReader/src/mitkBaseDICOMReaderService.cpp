@@ -35,12 +35,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace mitk {
 
   BaseDICOMReaderService::BaseDICOMReaderService(const std::string& description)
-    : AbstractFileReader(CustomMimeType(IOMimeTypes::DICOM_MIMETYPE()), description)
+    : AbstractFileReader(CustomMimeType(IOMimeTypes::DICOM_MIMETYPE()), description),
+      m_ScanIndex(DICOMTagScanIndex::New())
 {
 }
 
   BaseDICOMReaderService::BaseDICOMReaderService(const mitk::CustomMimeType& customType, const std::string& description)
-    : AbstractFileReader(customType, description)
+    : AbstractFileReader(customType, description),
+      m_ScanIndex(DICOMTagScanIndex::New())
   {
   }
 
@@ -129,6 +131,7 @@ std::vector<itk::SmartPointer<BaseData> > BaseDICOMReaderService::Read()
           mitk::DICOMDCMTKTagScanner::Pointer scanner = mitk::DICOMDCMTKTagScanner::New();
           scanner->AddTagPaths(reader->GetTagsOfInterest());
           scanner->SetInputFiles(relevantFiles);
+          scanner->SetScanIndex(m_ScanIndex);
           scanner->Scan();
 
           reader->SetTagCache(scanner->GetScanCache());
@@ -17,6 +17,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMDCMTKTagScanner.h"
 #include "mitkDICOMGenericImageFrameInfo.h"
 
+#include <mitkParallelFor.h>
+
 #include <dcmtk/dcmdata/dcfilefo.h>
 #include <dcmtk/dcmdata/dcpath.h>
 
@@ -102,61 +104,135 @@ mitk::DICOMTagPath DcmPathToTagPath(DcmPath * dcmpath)
   return result;
 }
 
+namespace
+{
+  /** Returns the first top level tag after all tags that are needed for the paths,
+   or DCM_UndefinedTagKey if the whole dataset has to be parsed. */
+  DcmTagKey GetStopTag(const std::set<mitk::DICOMTagPath>& paths)
+  {
+    unsigned int group = 0;
+    unsigned int element = 0;
+    for (const auto& path : paths)
+    {
+      if (path.IsEmpty() || path.GetFirstNode().type == mitk::DICOMTagPath::NodeInfo::NodeType::AnyElement
+          || path.GetFirstNode().type == mitk::DICOMTagPath::NodeInfo::NodeType::Invalid)
+      {
+        return DCM_UndefinedTagKey;
+      }
+      const mitk::DICOMTag& tag = path.GetFirstNode().tag;
+      if (tag.GetGroup() > group || (tag.GetGroup() == group && tag.GetElement() > element))
+      {
+        group = tag.GetGroup();
+        element = tag.GetElement();
+      }
+    }
+
+    if (paths.empty() || group >= 0xFFFF)
+    {
+      return DCM_UndefinedTagKey;
+    }
+    return element < 0xFFFF ? DcmTagKey(group, element + 1) : DcmTagKey(group + 1, 0);
+  }
+
+  struct FileScanResult
+  {
+    bool Readable = false;
+    bool FromIndex = false;
+    mitk::DICOMTagScanIndex::TagValueListType Values;
+  };
+}
+
 void mitk::DICOMDCMTKTagScanner::Scan()
 {
   this->PushLocale();
 
   try
   {
-    DcmPathProcessor processor;
-    processor.setItemWildcardSupport(true);
+    // parsing stops after the last top level tag of interest, pixel data is never read
+    const DcmTagKey stopTag = GetStopTag(this->m_ScannedTags);
+    const DICOMTagScanIndex* index = this->m_ScanIndex;
 
-    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+    std::vector<FileScanResult> results(this->m_InputFilenames.size());
 
-    for (const auto& fileName : this->m_InputFilenames)
+    mitk::ParallelFor(this->m_InputFilenames.size(), [&](std::size_t fileIndex)
     {
+      const std::string& fileName = this->m_InputFilenames[fileIndex];
+      FileScanResult& result = results[fileIndex];
+
+      if (index && index->Lookup(fileName, this->m_ScannedTags, result.Readable, result.Values))
+      {
+        result.FromIndex = true;
+        return;
+      }
+
       DcmFileFormat dfile;
-      OFCondition cond = dfile.loadFile(fileName.c_str());
+      OFCondition cond = dfile.loadFileUntilTag(fileName.c_str(), EXS_Unknown, EGL_noChange, DCM_MaxReadLength, ERM_autoDetect, stopTag);
       if (cond.bad())
       {
-        MITK_ERROR << "Error when scanning for tags. Cannot open given file. File: " << fileName;
+        return;
       }
-      else
-      {
-        DICOMGenericImageFrameInfo::Pointer info = DICOMGenericImageFrameInfo::New(fileName);
+      result.Readable = true;
+
+      DcmPathProcessor processor;
+      processor.setItemWildcardSupport(true);
 
-        for (const auto& path : this->m_ScannedTags)
+      for (const auto& path : this->m_ScannedTags)
+      {
+        std::string tagPath = DICOMTagPathToDCMTKSearchPath(path);
+        cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
+        if (cond.good())
         {
-          std::string tagPath = DICOMTagPathToDCMTKSearchPath(path);
-          cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
-          if (cond.good())
+          OFList< DcmPath * > findings;
+          processor.getResults(findings);
+          for (const auto& finding : findings)
           {
-            OFList< DcmPath * > findings;
-            processor.getResults(findings);
-            for (const auto& finding : findings)
+            auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
+            if (!element)
             {
-              auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
-              if (!element)
+              auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
+              if (item)
               {
-                auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
-                if (item)
-                {
-                  element = item->getElement(finding->back()->m_itemNo);
-                }
+                element = item->getElement(finding->back()->m_itemNo);
               }
+            }
 
-              if (element)
+            if (element)
+            {
+              OFString value;
+              cond = element->getOFStringArray(value);
+              if (cond.good())
               {
-                OFString value;
-                cond = element->getOFStringArray(value);
-                if (cond.good())
-                {
-                  info->SetTagValue(DcmPathToTagPath(finding), std::string(value.c_str()));
-                }
+                result.Values.push_back(std::make_pair(DcmPathToTagPath(finding), std::string(value.c_str())));
               }
             }
           }
         }
+      }
+    }, this->m_NumberOfThreads);
+
+    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+
+    for (std::size_t fileIndex = 0; fileIndex < results.size(); ++fileIndex)
+    {
+      const std::string& fileName = this->m_InputFilenames[fileIndex];
+      const FileScanResult& result = results[fileIndex];
+
+      if (this->m_ScanIndex.IsNotNull() && !result.FromIndex)
+      {
+        this->m_ScanIndex->Update(fileName, this->m_ScannedTags, result.Readable, result.Values);
+      }
+
+      if (!result.Readable)
+      {
+        MITK_ERROR << "Error when scanning for tags. Cannot open given file. File: " << fileName;
+      }
+      else
+      {
+        DICOMGenericImageFrameInfo::Pointer info = DICOMGenericImageFrameInfo::New(fileName);
+        for (const auto& value : result.Values)
+        {
+          info->SetTagValue(value.first, value.second);
+        }
         newCache->AddFrameInfo(info);
       }
     }
@@ -182,6 +182,20 @@ mitk::DICOMFileReaderSelector
   return m_InputFilenames;
 }
 
+void
+mitk::DICOMFileReaderSelector
+::SetScanIndex(DICOMTagScanIndex* index)
+{
+  m_ScanIndex = index;
+}
+
+mitk::DICOMTagScanIndex*
+mitk::DICOMFileReaderSelector
+::GetScanIndex() const
+{
+  return m_ScanIndex;
+}
+
 mitk::DICOMFileReader::Pointer
 mitk::DICOMFileReaderSelector
 ::GetFirstReaderWithMinimumNumberOfOutputImages()
@@ -191,6 +205,7 @@ mitk::DICOMFileReaderSelector
   // do the tag scanning externally and just ONCE
   DICOMGDCMTagScanner::Pointer gdcmScanner = DICOMGDCMTagScanner::New();
   gdcmScanner->SetInputFiles( m_InputFilenames );
+  gdcmScanner->SetScanIndex( m_ScanIndex );
 
   // let all readers analyze the file set
   for ( auto rIter = m_Readers.cbegin(); rIter != m_Readers.cend(); ++rIter )
@@ -30,12 +30,10 @@ mitk::DICOMDatasetFinding mitk::DICOMGDCMTagCache::GetTagValue( DICOMImageFrameI
 {
   assert( frame );
 
-  for ( auto frameIter = m_ScanResult.cbegin(); frameIter != m_ScanResult.cend(); ++frameIter )
+  auto frameIndex = m_FrameIndex.find(frame->Filename);
+  if ( frameIndex != m_FrameIndex.cend() && *m_ScanResult[frameIndex->second] == *frame )
   {
-    if ( **frameIter == *frame )
-    {
-      return (*frameIter)->GetTagValueAsString(tag);
-    }
+    return m_ScanResult[frameIndex->second]->GetTagValueAsString(tag);
   }
 
   if ( m_ScannedTags.find( tag ) != m_ScannedTags.cend() )
@@ -91,18 +89,56 @@ mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const
   m_InputFilenames = inputFiles;
   m_Scanner = scanner;
 
+  m_Values.clear();
   m_ScanResult.clear();
   m_ScanResult.reserve(m_InputFilenames.size());
+  m_FrameIndex.clear();
 
   for (auto inputIter = m_InputFilenames.cbegin(); inputIter != m_InputFilenames.cend(); ++inputIter)
   {
+    m_FrameIndex.insert(std::make_pair(*inputIter, m_ScanResult.size()));
     m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(*inputIter, 0),
       m_Scanner->GetMapping(inputIter->c_str())).GetPointer());
   }
 }
 
+void
+mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const StringList& inputFiles, const std::vector<TagValueMapType>& values)
+{
+  if (values.size() != inputFiles.size())
+  {
+    mitkThrow() << "Invalid call to DICOMGDCMTagCache::InitCache(). Number of value maps does not match number of files.";
+  }
+
+  m_ScannedTags = scannedTags;
+  m_InputFilenames = inputFiles;
+  m_Scanner.reset();
+
+  m_Values.clear();
+  m_ScanResult.clear();
+  m_ScanResult.reserve(m_InputFilenames.size());
+  m_FrameIndex.clear();
+
+  for (std::size_t i = 0; i < m_InputFilenames.size(); ++i)
+  {
+    // DICOMGDCMImageFrameInfo refers to the values, they are kept in m_Values
+    gdcm::Scanner::TagToValue mapping;
+    for (const auto& value : values[i])
+    {
+      mapping[gdcm::Tag(value.first.GetGroup(), value.first.GetElement())] = m_Values.insert(value.second).first->c_str();
+    }
+
+    m_FrameIndex.insert(std::make_pair(m_InputFilenames[i], m_ScanResult.size()));
+    m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(m_InputFilenames[i], 0), mapping).GetPointer());
+  }
+}
+
 const gdcm::Scanner&
 mitk::DICOMGDCMTagCache::GetScanner() const
 {
+  if (!m_Scanner)
+  {
+    mitkThrow() << "DICOMGDCMTagCache was not initialized with a gdcm::Scanner.";
+  }
   return *(this->m_Scanner);
 }
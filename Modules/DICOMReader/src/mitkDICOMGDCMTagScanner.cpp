@@ -18,11 +18,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMGDCMTagCache.h"
 #include "mitkDICOMGDCMImageFrameInfo.h"
 
+#include <mitkParallelFor.h>
+
 #include <gdcmScanner.h>
 
+#include <algorithm>
+
 mitk::DICOMGDCMTagScanner::DICOMGDCMTagScanner()
 {
-  m_GDCMScanner = std::make_shared<gdcm::Scanner>();
 }
 
 mitk::DICOMGDCMTagScanner::~DICOMGDCMTagScanner()
@@ -45,8 +48,6 @@ mitk::DICOMDatasetFinding mitk::DICOMGDCMTagScanner::GetTagValue( DICOMImageFram
 void mitk::DICOMGDCMTagScanner::AddTag( const DICOMTag& tag )
 {
   m_ScannedTags.insert( tag );
-  m_GDCMScanner->AddTag(
-    gdcm::Tag( tag.GetGroup(), tag.GetElement() ) ); // also a set, duplicate calls to AddTag don't hurt
 }
 
 void mitk::DICOMGDCMTagScanner::AddTags( const DICOMTagList& tags )
@@ -97,10 +98,99 @@ void mitk::DICOMGDCMTagScanner::SetInputFiles( const StringList& filenames )
 void mitk::DICOMGDCMTagScanner::Scan()
 {
   // TODO integrate push/pop locale??
-  m_GDCMScanner->Scan( m_InputFilenames );
+  const std::size_t numberOfFiles = m_InputFilenames.size();
+  std::vector<DICOMGDCMTagCache::TagValueMapType> values(numberOfFiles);
+
+  DICOMTagScanIndex::TagPathSetType scannedPaths;
+  for (const auto& tag : m_ScannedTags)
+  {
+    scannedPaths.insert(DICOMTagPath(tag));
+  }
+
+  // every chunk of files is scanned by an own gdcm::Scanner, which reads each file
+  // only up to the last tag of interest
+  const std::size_t chunkSize = std::max<std::size_t>(16, numberOfFiles / (8 * std::max(m_NumberOfThreads, 1u)) + 1);
+  const std::size_t numberOfChunks = (numberOfFiles + chunkSize - 1) / chunkSize;
+  std::vector<char> fromIndex(numberOfFiles, 0);
+  std::vector<char> readable(numberOfFiles, 0);
+  const DICOMTagScanIndex* index = m_ScanIndex;
+
+  mitk::ParallelFor(numberOfChunks, [&](std::size_t chunk)
+  {
+    const std::size_t first = chunk * chunkSize;
+    const std::size_t last = std::min(first + chunkSize, numberOfFiles);
+
+    StringList filesToScan;
+    for (std::size_t i = first; i < last; ++i)
+    {
+      bool isReadable = false;
+      DICOMTagScanIndex::TagValueListType indexedValues;
+      if (index && index->Lookup(m_InputFilenames[i], scannedPaths, isReadable, indexedValues))
+      {
+        fromIndex[i] = 1;
+        readable[i] = isReadable;
+        // the index may hold values of other scans, e.g. of nested tags of a DCMTK scan
+        for (const auto& value : indexedValues)
+        {
+          if (scannedPaths.find(value.first) != scannedPaths.cend())
+          {
+            values[i][value.first.GetFirstNode().tag] = value.second;
+          }
+        }
+      }
+      else
+      {
+        filesToScan.push_back(m_InputFilenames[i]);
+      }
+    }
+
+    if (filesToScan.empty())
+    {
+      return;
+    }
+
+    gdcm::Scanner gdcmScanner;
+    for (const auto& tag : m_ScannedTags)
+    {
+      gdcmScanner.AddTag(gdcm::Tag(tag.GetGroup(), tag.GetElement()));
+    }
+    gdcmScanner.Scan(filesToScan);
+
+    for (std::size_t i = first; i < last; ++i)
+    {
+      if (fromIndex[i])
+      {
+        continue;
+      }
+      readable[i] = gdcmScanner.IsKey(m_InputFilenames[i].c_str());
+      for (const auto& mapping : gdcmScanner.GetMapping(m_InputFilenames[i].c_str()))
+      {
+        if (mapping.second)
+        {
+          values[i][DICOMTag(mapping.first.GetGroup(), mapping.first.GetElement())] = mapping.second;
+        }
+      }
+    }
+  }, m_NumberOfThreads);
+
+  if (m_ScanIndex.IsNotNull())
+  {
+    for (std::size_t i = 0; i < numberOfFiles; ++i)
+    {
+      if (!fromIndex[i])
+      {
+        DICOMTagScanIndex::TagValueListType fileValues;
+        for (const auto& value : values[i])
+        {
+          fileValues.push_back(std::make_pair(DICOMTagPath(value.first), value.second));
+        }
+        m_ScanIndex->Update(m_InputFilenames[i], scannedPaths, readable[i] != 0, fileValues);
+      }
+    }
+  }
 
   DICOMGDCMTagCache::Pointer newCache = DICOMGDCMTagCache::New();
-  newCache->InitCache(m_ScannedTags, m_GDCMScanner, m_InputFilenames);
+  newCache->InitCache(m_ScannedTags, m_InputFilenames, values);
 
   m_Cache = newCache;
 }
@@ -43,12 +43,10 @@ mitk::DICOMGenericTagCache::GetTagValue(DICOMImageFrameInfo* frame, const DICOMT
 {
   FindingsListType result;
 
-  for (auto info : m_ScanResult)
+  auto frameIndex = m_FrameIndex.find(frame);
+  if (frameIndex != m_FrameIndex.cend())
   {
-    if (info == frame)
-    {
-      result = info->GetTagValueAsString(path);
-    }
+    result = m_ScanResult[frameIndex->second]->GetTagValueAsString(path);
   }
   return result;
 }
@@ -61,6 +59,7 @@ mitk::DICOMDatasetAccessingImageFrameList mitk::DICOMGenericTagCache::GetFrameIn
 void
 mitk::DICOMGenericTagCache::AddFrameInfo(DICOMDatasetAccessingImageFrameInfo* info)
 {
+  m_FrameIndex[info] = m_ScanResult.size();
   m_ScanResult.push_back(info);
 };
 
@@ -68,4 +67,5 @@ void
 mitk::DICOMGenericTagCache::Reset()
 {
   m_ScanResult.clear();
+  m_FrameIndex.clear();
 };
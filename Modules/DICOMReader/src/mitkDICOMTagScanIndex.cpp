@@ -0,0 +1,282 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDICOMTagScanIndex.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkLogMacros.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  const char IndexMagic[8] = { 'M', 'I', 'T', 'K', 'D', 'T', 'I', '1' };
+
+  template <typename T>
+  void WriteValue(std::ostream& stream, T value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void WriteString(std::ostream& stream, const std::string& value)
+  {
+    WriteValue<uint32_t>(stream, static_cast<uint32_t>(value.size()));
+    stream.write(value.data(), value.size());
+  }
+
+  template <typename T>
+  bool ReadValue(std::istream& stream, T& value)
+  {
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  bool ReadString(std::istream& stream, std::string& value)
+  {
+    uint32_t length = 0;
+    if (!ReadValue(stream, length))
+    {
+      return false;
+    }
+    value.resize(length);
+    return length == 0 || static_cast<bool>(stream.read(&value[0], length));
+  }
+
+  // paths are stored node by node, parsing their string representation is too slow for large indices
+  void WritePath(std::ostream& stream, const mitk::DICOMTagPath& path)
+  {
+    WriteValue<uint32_t>(stream, static_cast<uint32_t>(path.Size()));
+    for (const auto& node : path.GetNodes())
+    {
+      WriteValue<uint8_t>(stream, static_cast<uint8_t>(node.type));
+      WriteValue<uint16_t>(stream, static_cast<uint16_t>(node.tag.GetGroup()));
+      WriteValue<uint16_t>(stream, static_cast<uint16_t>(node.tag.GetElement()));
+      WriteValue<int32_t>(stream, static_cast<int32_t>(node.selection));
+    }
+  }
+
+  bool ReadPath(std::istream& stream, mitk::DICOMTagPath& path)
+  {
+    uint32_t numberOfNodes = 0;
+    if (!ReadValue(stream, numberOfNodes))
+    {
+      return false;
+    }
+    path.Reset();
+    for (uint32_t i = 0; i < numberOfNodes; ++i)
+    {
+      uint8_t type = 0;
+      uint16_t group = 0;
+      uint16_t element = 0;
+      int32_t selection = 0;
+      if (!ReadValue(stream, type) || !ReadValue(stream, group) || !ReadValue(stream, element) || !ReadValue(stream, selection))
+      {
+        return false;
+      }
+      path.AddNode(mitk::DICOMTagPath::NodeInfo(mitk::DICOMTag(group, element),
+                                               static_cast<mitk::DICOMTagPath::NodeInfo::NodeType>(type),
+                                               selection));
+    }
+    return true;
+  }
+}
+
+mitk::DICOMTagScanIndex::DICOMTagScanIndex()
+{
+}
+
+mitk::DICOMTagScanIndex::~DICOMTagScanIndex()
+{
+}
+
+bool mitk::DICOMTagScanIndex::GetFileStamp(const std::string& filename, unsigned long long& fileSize, long long& modifiedTime)
+{
+  if (!itksys::SystemTools::FileExists(filename.c_str(), true))
+  {
+    return false;
+  }
+  fileSize = itksys::SystemTools::FileLength(filename);
+  modifiedTime = itksys::SystemTools::ModifiedTime(filename);
+  return true;
+}
+
+bool mitk::DICOMTagScanIndex::Lookup(const std::string& filename, const TagPathSetType& paths, bool& readable, TagValueListType& values) const
+{
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto finding = m_Entries.find(filename);
+    if (finding == m_Entries.cend())
+    {
+      return false;
+    }
+
+    if (!std::includes(finding->second.ScannedPaths.cbegin(), finding->second.ScannedPaths.cend(), paths.cbegin(), paths.cend()))
+    {
+      return false;
+    }
+    entry = finding->second;
+  }
+
+  // the file is checked without holding the lock
+  unsigned long long fileSize = 0;
+  long long modifiedTime = 0;
+  if (!GetFileStamp(filename, fileSize, modifiedTime) || fileSize != entry.FileSize || modifiedTime != entry.ModifiedTime)
+  {
+    return false;
+  }
+
+  readable = entry.Readable;
+  values = entry.Values;
+  return true;
+}
+
+void mitk::DICOMTagScanIndex::Update(const std::string& filename, const TagPathSetType& paths, bool readable, const TagValueListType& values)
+{
+  Entry entry;
+  if (!GetFileStamp(filename, entry.FileSize, entry.ModifiedTime))
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.erase(filename);
+    return;
+  }
+  entry.Readable = readable;
+  entry.ScannedPaths = paths;
+  entry.Values = values;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries[filename] = entry;
+  }
+  this->Modified();
+}
+
+unsigned int mitk::DICOMTagScanIndex::GetNumberOfEntries() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return static_cast<unsigned int>(m_Entries.size());
+}
+
+void mitk::DICOMTagScanIndex::Clear()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.clear();
+  }
+  this->Modified();
+}
+
+bool mitk::DICOMTagScanIndex::Load(const std::string& indexFilename)
+{
+  this->Clear();
+
+  std::ifstream stream(indexFilename.c_str(), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+
+  char magic[sizeof(IndexMagic)];
+  uint32_t numberOfEntries = 0;
+  if (!stream.read(magic, sizeof(magic)) || std::memcmp(magic, IndexMagic, sizeof(IndexMagic)) != 0 ||
+      !ReadValue(stream, numberOfEntries))
+  {
+    MITK_WARN << "Ignoring invalid DICOM tag scan index " << indexFilename;
+    return false;
+  }
+
+  std::map<std::string, Entry> entries;
+  for (uint32_t i = 0; i < numberOfEntries; ++i)
+  {
+    std::string filename;
+    Entry entry;
+    uint8_t readable = 0;
+    uint32_t numberOfPaths = 0;
+    uint32_t numberOfValues = 0;
+
+    bool valid = ReadString(stream, filename) && ReadValue(stream, entry.FileSize) &&
+                 ReadValue(stream, entry.ModifiedTime) && ReadValue(stream, readable) &&
+                 ReadValue(stream, numberOfPaths);
+    for (uint32_t p = 0; valid && p < numberOfPaths; ++p)
+    {
+      DICOMTagPath path;
+      valid = ReadPath(stream, path);
+      entry.ScannedPaths.insert(path);
+    }
+    valid = valid && ReadValue(stream, numberOfValues);
+    for (uint32_t v = 0; valid && v < numberOfValues; ++v)
+    {
+      DICOMTagPath path;
+      std::string value;
+      valid = ReadPath(stream, path) && ReadString(stream, value);
+      entry.Values.push_back(std::make_pair(path, value));
+    }
+
+    if (!valid)
+    {
+      MITK_WARN << "Ignoring truncated DICOM tag scan index " << indexFilename;
+      return false;
+    }
+    entry.Readable = readable != 0;
+    entries[filename] = entry;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.swap(entries);
+  }
+  this->Modified();
+  return true;
+}
+
+void mitk::DICOMTagScanIndex::Save(const std::string& indexFilename) const
+{
+  std::ofstream stream(indexFilename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!stream)
+  {
+    mitkThrow() << "Cannot write DICOM tag scan index " << indexFilename;
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  stream.write(IndexMagic, sizeof(IndexMagic));
+  WriteValue<uint32_t>(stream, static_cast<uint32_t>(m_Entries.size()));
+  for (const auto& entry : m_Entries)
+  {
+    WriteString(stream, entry.first);
+    WriteValue(stream, entry.second.FileSize);
+    WriteValue(stream, entry.second.ModifiedTime);
+    WriteValue<uint8_t>(stream, entry.second.Readable ? 1 : 0);
+    WriteValue<uint32_t>(stream, static_cast<uint32_t>(entry.second.ScannedPaths.size()));
+    for (const auto& path : entry.second.ScannedPaths)
+    {
+      WritePath(stream, path);
+    }
+    WriteValue<uint32_t>(stream, static_cast<uint32_t>(entry.second.Values.size()));
+    for (const auto& value : entry.second.Values)
+    {
+      WritePath(stream, value.first);
+      WriteString(stream, value.second);
+    }
+  }
+
+  if (!stream)
+  {
+    mitkThrow() << "Cannot write DICOM tag scan index " << indexFilename;
+  }
+}
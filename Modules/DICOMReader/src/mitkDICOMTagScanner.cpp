@@ -16,9 +16,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMTagScanner.h"
 
+#include <algorithm>
+#include <thread>
+
 itk::MutexLock::Pointer mitk::DICOMTagScanner::s_LocaleMutex = itk::MutexLock::New();
 
 mitk::DICOMTagScanner::DICOMTagScanner()
+  : m_NumberOfThreads(std::max(std::thread::hardware_concurrency(), 1u))
 {
 }
 
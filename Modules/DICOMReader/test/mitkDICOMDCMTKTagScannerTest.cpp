@@ -21,6 +21,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTestingMacros.h"
 
 #include "mitkStringProperty.h"
+#include "mitkIOUtil.h"
+
+#include <cstdio>
 
 class mitkDICOMDCMTKTagScannerTestSuite : public mitk::TestFixture
 {
@@ -28,6 +31,7 @@ class mitkDICOMDCMTKTagScannerTestSuite : public mitk::TestFixture
 
   MITK_TEST(DeepScanning);
   MITK_TEST(MultiFileScanning);
+  MITK_TEST(IndexedScanning);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -123,6 +127,61 @@ public:
     CPPUNIT_ASSERT_MESSAGE("Testing value of instance uid finding of frame 3", findings.front().value == "1.2.276.0.99.1.4.8323329.3795.1303917947.940055");
   }
 
+  void IndexedScanning()
+  {
+    mitk::DICOMTagPath instanceUID(0x0008, 0x0018);
+    mitk::DICOMTagPath patientName(0x0010, 0x0010);
+
+    mitk::DICOMTagScanIndex::Pointer index = mitk::DICOMTagScanIndex::New();
+    scanner->SetInputFiles(ctFiles);
+    scanner->AddTagPath(instanceUID);
+    scanner->SetNumberOfThreads(2);
+    scanner->SetScanIndex(index);
+    scanner->Scan();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing that all scanned files are indexed", 4u, index->GetNumberOfEntries());
+
+    std::string indexFile = mitk::IOUtil::CreateTemporaryFile("DICOMTagScanIndex_XXXXXX.idx");
+    index->Save(indexFile);
+
+    mitk::DICOMTagScanIndex::Pointer loadedIndex = mitk::DICOMTagScanIndex::New();
+    CPPUNIT_ASSERT_MESSAGE("Testing DICOMTagScanIndex::Load()", loadedIndex->Load(indexFile));
+    std::remove(indexFile.c_str());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing number of loaded entries", 4u, loadedIndex->GetNumberOfEntries());
+
+    bool readable = false;
+    mitk::DICOMTagScanIndex::TagValueListType values;
+    mitk::DICOMTagScanIndex::TagPathSetType paths;
+    paths.insert(instanceUID);
+    CPPUNIT_ASSERT_MESSAGE("Testing lookup of an indexed file", loadedIndex->Lookup(ctFiles[1], paths, readable, values));
+    CPPUNIT_ASSERT_MESSAGE("Testing readability of an indexed file", readable);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing number of indexed values", std::size_t(1), values.size());
+    CPPUNIT_ASSERT_MESSAGE("Testing indexed path", values.front().first == instanceUID);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing indexed value", std::string("1.2.276.0.99.1.4.8323329.3795.1303917947.940052"), values.front().second);
+
+    paths.insert(patientName);
+    CPPUNIT_ASSERT_MESSAGE("Testing lookup with a tag that was not scanned", !loadedIndex->Lookup(ctFiles[1], paths, readable, values));
+
+    // a second scan with the loaded index has to yield the same result
+    mitk::DICOMDCMTKTagScanner::Pointer indexedScanner = mitk::DICOMDCMTKTagScanner::New();
+    indexedScanner->SetInputFiles(ctFiles);
+    indexedScanner->AddTagPath(instanceUID);
+    indexedScanner->SetScanIndex(loadedIndex);
+    indexedScanner->Scan();
+
+    mitk::DICOMDatasetAccessingImageFrameList frames = scanner->GetFrameInfoList();
+    mitk::DICOMDatasetAccessingImageFrameList indexedFrames = indexedScanner->GetFrameInfoList();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing number of frames of indexed scan", frames.size(), indexedFrames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing file name of indexed scan", frames[i]->GetFilenameIfAvailable(), indexedFrames[i]->GetFilenameIfAvailable());
+      mitk::DICOMDatasetAccess::FindingsListType findings = frames[i]->GetTagValueAsString(instanceUID);
+      mitk::DICOMDatasetAccess::FindingsListType indexedFindings = indexedFrames[i]->GetTagValueAsString(instanceUID);
+      CPPUNIT_ASSERT_MESSAGE("Testing findings of indexed scan", findings.size() == 1 && indexedFindings.size() == 1);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Testing value of indexed scan", findings.front().value, indexedFindings.front().value);
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkDICOMDCMTKTagScanner)
@@ -24,6 +24,9 @@ namespace mitk {
   /**
   Service wrapper that auto selects (using the mitk::DICOMFileReaderSelector) the best DICOMFileReader from
   the DICOMReader module.
+
+  The selection scans are kept in an own DICOMTagScanIndex, because the selector scans with GDCM
+  and the base class scans the tags of interest with DCMTK.
   */
 class AutoSelectingDICOMReaderService : public BaseDICOMReaderService
 {
@@ -38,6 +41,8 @@ protected:
 private:
 
   AutoSelectingDICOMReaderService* Clone() const override;
+
+  DICOMTagScanIndex::Pointer m_SelectionScanIndex;
 };
 
 }
@@ -21,7 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace mitk {
 
 AutoSelectingDICOMReaderService::AutoSelectingDICOMReaderService()
-  : BaseDICOMReaderService("MITK DICOM Reader v2 (autoselect)")
+  : BaseDICOMReaderService("MITK DICOM Reader v2 (autoselect)"), m_SelectionScanIndex(DICOMTagScanIndex::New())
 {
   this->SetRanking(5);
   this->RegisterService();
@@ -34,6 +34,7 @@ DICOMFileReader::Pointer AutoSelectingDICOMReaderService::GetReader(const mitk::
   selector->LoadBuiltIn3DConfigs();
   selector->LoadBuiltIn3DnTConfigs();
   selector->SetInputFiles(relevantFiles);
+  selector->SetScanIndex(m_SelectionScanIndex);
 
   mitk::DICOMFileReader::Pointer reader = selector->GetFirstReaderWithMinimumNumberOfOutputImages();
   if(reader.IsNotNull())
@@ -56,6 +56,29 @@ class MITKDICOMTESTING_EXPORT TestDICOMLoading
     CompareImageInformationDumps( const std::string& reference,
                                   const std::string& test );
 
+    /**
+      \brief Write a synthetic axial CT series (unsigned 16 bit) to a directory.
+
+      All slices belong to one series of one study and form a single volume
+      with 0.5 mm pixel spacing and 1 mm slice distance. The pixel values vary
+      with row, column, slice and time step, so that misplaced slices can be detected.
+
+      \param tiltShift shift of each slice along the image rows (y) relative to its predecessor,
+             a value other than 0 simulates a gantry tilt
+      \param timeStep time step of a 3D+t series: added to the acquisition time (in seconds)
+             and to the file names, so several time steps can be written to one directory
+
+      \return the names of the written files, in slice order
+      \throw mitk::Exception if a file cannot be written
+    */
+    StringList
+    WriteSyntheticCTSeries( const std::string& directory,
+                            unsigned int numberOfSlices,
+                            unsigned int rows = 256,
+                            unsigned int columns = 256,
+                            double tiltShift = 0.0,
+                            unsigned int timeStep = 0 );
+
   private:
 
     typedef std::map<std::string,std::string> KeyValueMap;
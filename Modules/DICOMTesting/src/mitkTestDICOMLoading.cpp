@@ -17,7 +17,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkTestDICOMLoading.h"
 
+#include <mitkExceptionMacro.h>
+
+#include <dcmtk/config/osconfig.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+
+#include <iomanip>
+#include <locale>
+#include <sstream>
 #include <stack>
+#include <vector>
 
 mitk::TestDICOMLoading::TestDICOMLoading()
 :m_PreviousCLocale(nullptr)
@@ -490,3 +501,89 @@ mitk::TestDICOMLoading::ParseDump( const std::string& dump )
   return parsedResult;
 }
 
+mitk::StringList
+mitk::TestDICOMLoading::WriteSyntheticCTSeries( const std::string& directory,
+                                                unsigned int numberOfSlices,
+                                                unsigned int rows,
+                                                unsigned int columns,
+                                                double tiltShift,
+                                                unsigned int timeStep )
+{
+  char studyInstanceUID[100];
+  char seriesInstanceUID[100];
+  char frameOfReferenceUID[100];
+  dcmGenerateUniqueIdentifier(studyInstanceUID, SITE_STUDY_UID_ROOT);
+  dcmGenerateUniqueIdentifier(seriesInstanceUID, SITE_SERIES_UID_ROOT);
+  dcmGenerateUniqueIdentifier(frameOfReferenceUID, SITE_UID_ROOT);
+
+  const double pixelSpacing = 0.5;
+  const double sliceDistance = 1.0;
+
+  std::vector<Uint16> pixels(rows * columns);
+  StringList filenames;
+
+  for (unsigned int slice = 0; slice < numberOfSlices; ++slice)
+  {
+    for (unsigned int row = 0; row < rows; ++row)
+    {
+      for (unsigned int column = 0; column < columns; ++column)
+      {
+        pixels[row * columns + column] = static_cast<Uint16>((row + 2 * column + 7 * slice + 13 * timeStep) % 4096);
+      }
+    }
+
+    // decimal strings must not depend on the user locale
+    std::ostringstream position;
+    position.imbue(std::locale::classic());
+    position << 0.0 << "\\" << slice * tiltShift << "\\" << slice * sliceDistance;
+    std::ostringstream spacing;
+    spacing.imbue(std::locale::classic());
+    spacing << pixelSpacing << "\\" << pixelSpacing;
+
+    std::ostringstream acquisitionTime;
+    acquisitionTime << "1200" << std::setw(2) << std::setfill('0') << timeStep % 60;
+
+    char sopInstanceUID[100];
+    dcmGenerateUniqueIdentifier(sopInstanceUID, SITE_INSTANCE_UID_ROOT);
+
+    DcmFileFormat fileFormat;
+    DcmDataset* dataset = fileFormat.getDataset();
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_CTImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID);
+    dataset->putAndInsertString(DCM_StudyInstanceUID, studyInstanceUID);
+    dataset->putAndInsertString(DCM_SeriesInstanceUID, seriesInstanceUID);
+    dataset->putAndInsertString(DCM_FrameOfReferenceUID, frameOfReferenceUID);
+    dataset->putAndInsertString(DCM_Modality, "CT");
+    dataset->putAndInsertString(DCM_PatientName, "Synthetic^Series");
+    dataset->putAndInsertString(DCM_PatientID, "SYNTHETIC");
+    dataset->putAndInsertString(DCM_SeriesNumber, "1");
+    dataset->putAndInsertString(DCM_InstanceNumber, std::to_string(slice + 1).c_str());
+    dataset->putAndInsertString(DCM_ImagePositionPatient, position.str().c_str());
+    dataset->putAndInsertString(DCM_ImageOrientationPatient, "1\\0\\0\\0\\1\\0");
+    dataset->putAndInsertString(DCM_PixelSpacing, spacing.str().c_str());
+    dataset->putAndInsertString(DCM_SliceThickness, "1");
+    dataset->putAndInsertString(DCM_AcquisitionDate, "20170101");
+    dataset->putAndInsertString(DCM_AcquisitionTime, acquisitionTime.str().c_str());
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_Rows, static_cast<Uint16>(rows));
+    dataset->putAndInsertUint16(DCM_Columns, static_cast<Uint16>(columns));
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset->putAndInsertUint16(DCM_BitsStored, 16);
+    dataset->putAndInsertUint16(DCM_HighBit, 15);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+    dataset->putAndInsertUint16Array(DCM_PixelData, pixels.data(), static_cast<unsigned long>(pixels.size()));
+
+    std::ostringstream filename;
+    filename << directory << "/t" << timeStep << "_slice" << std::setw(5) << std::setfill('0') << slice << ".dcm";
+
+    OFCondition status = fileFormat.saveFile(filename.str().c_str(), EXS_LittleEndianExplicit);
+    if (status.bad())
+    {
+      mitkThrow() << "Cannot write synthetic DICOM file " << filename.str() << ": " << status.text();
+    }
+    filenames.push_back(filename.str());
+  }
+
+  return filenames;
+}
@@ -1,6 +1,11 @@
 
+set(MODULE_TESTS
+  mitkDICOMSeriesLoadingTest.cpp
+)
+
 # tests with no extra command line parameter
 set(MODULE_CUSTOM_TESTS
   mitkDICOMTestingSanityTest.cpp
   mitkDICOMPreloadedVolumeTest.cpp
+  mitkDICOMSeriesLoadingBenchmark.cpp
 )
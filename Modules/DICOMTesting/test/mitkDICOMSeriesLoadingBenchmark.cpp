@@ -0,0 +1,103 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestDICOMLoading.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkIOUtil.h>
+#include <mitkITKDICOMSeriesReaderHelper.h>
+#include <mitkImageReadAccessor.h>
+
+#include <itkGDCMImageIO.h>
+#include <itkImageSeriesReader.h>
+#include <itkTimeProbe.h>
+#include <itksys/SystemTools.hxx>
+
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Times the loading of one large synthetic CT series, written to a temporary directory, by
+ * ITKDICOMSeriesReaderHelper against itk::ImageSeriesReader plus a copy into an mitk::Image.
+ * Both times are printed; the volumes must be identical. The only parameter is the number of slices
+ * of 256x256 pixels. Correctness of tilted and 3D+t loading is covered by mitkDICOMSeriesLoadingTest.
+ */
+int mitkDICOMSeriesLoadingBenchmark(int argc, char* argv[])
+{
+  MITK_TEST_BEGIN("mitkDICOMSeriesLoadingBenchmark")
+
+  MITK_TEST_CONDITION_REQUIRED(argc == 2, "Test is invoked with exactly 1 parameter (number of slices)");
+  const unsigned int numberOfSlices = static_cast<unsigned int>(std::atoi(argv[1]));
+  MITK_TEST_CONDITION_REQUIRED(numberOfSlices > 1, "Series has more than one slice");
+
+  const std::string directory = mitk::IOUtil::CreateTemporaryDirectory("DICOMSeriesLoadingBenchmark-XXXXXX");
+
+  mitk::TestDICOMLoading loader;
+  const mitk::StringList filenames = loader.WriteSyntheticCTSeries(directory, numberOfSlices);
+  MITK_TEST_CONDITION_REQUIRED(filenames.size() == numberOfSlices, "Synthetic series is written");
+
+  // previous implementation: sequential decoding by ImageSeriesReader, then copy into the mitk::Image
+  typedef itk::Image<unsigned short, 3> ImageType;
+  typedef itk::ImageSeriesReader<ImageType> ReaderType;
+
+  itk::TimeProbe seriesReaderProbe;
+  seriesReaderProbe.Start();
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetImageIO(itk::GDCMImageIO::New());
+  reader->ReverseOrderOff();
+  reader->SetFileNames(filenames);
+  reader->Update();
+
+  mitk::Image::Pointer expected = mitk::Image::New();
+  expected->InitializeByItk(reader->GetOutput());
+  expected->SetImportVolume(reader->GetOutput()->GetBufferPointer());
+
+  seriesReaderProbe.Stop();
+
+  itk::TimeProbe helperProbe;
+  helperProbe.Start();
+
+  mitk::ITKDICOMSeriesReaderHelper helper;
+  mitk::Image::Pointer image = helper.Load(filenames, false, mitk::GantryTiltInformation());
+
+  helperProbe.Stop();
+
+  MITK_TEST_OUTPUT(<< numberOfSlices << " slices: ImageSeriesReader " << seriesReaderProbe.GetTotal()
+                   << " s, ITKDICOMSeriesReaderHelper " << helperProbe.GetTotal() << " s");
+
+  MITK_TEST_CONDITION_REQUIRED(image.IsNotNull(), "Series is loaded by ITKDICOMSeriesReaderHelper");
+  MITK_TEST_CONDITION_REQUIRED(image->GetPixelType() == expected->GetPixelType(), "Same pixel type");
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    MITK_TEST_CONDITION_REQUIRED(image->GetDimension(d) == expected->GetDimension(d), "Same size in dimension " << d);
+  }
+  MITK_TEST_CONDITION(mitk::Equal(image->GetGeometry()->GetOrigin(), expected->GetGeometry()->GetOrigin()), "Same origin");
+  MITK_TEST_CONDITION(mitk::Equal(image->GetGeometry()->GetSpacing(), expected->GetGeometry()->GetSpacing()), "Same spacing");
+
+  {
+    mitk::ImageReadAccessor imageAccessor(image);
+    mitk::ImageReadAccessor expectedAccessor(expected);
+    const std::size_t numberOfBytes = image->GetDimension(0) * image->GetDimension(1) * image->GetDimension(2) *
+                                      image->GetPixelType().GetSize();
+    MITK_TEST_CONDITION(std::memcmp(imageAccessor.GetData(), expectedAccessor.GetData(), numberOfBytes) == 0,
+                        "Slices are decoded to the same positions as by ImageSeriesReader");
+  }
+
+  itksys::SystemTools::RemoveADirectory(directory);
+
+  MITK_TEST_END()
+}
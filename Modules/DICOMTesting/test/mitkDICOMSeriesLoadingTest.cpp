@@ -0,0 +1,168 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestDICOMLoading.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkIOUtil.h>
+#include <mitkITKDICOMSeriesReaderHelper.txx>
+#include <mitkImageReadAccessor.h>
+
+#include <itkGDCMImageIO.h>
+#include <itkImageSeriesReader.h>
+#include <itksys/SystemTools.hxx>
+
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+  typedef itk::Image<unsigned short, 3> VolumeType;
+
+  /** Gives the test access to the tilt correction that ITKDICOMSeriesReaderHelper applies after decoding.*/
+  class TestSeriesReaderHelper : public mitk::ITKDICOMSeriesReaderHelper
+  {
+  public:
+    using mitk::ITKDICOMSeriesReaderHelper::FixUpTiltedGeometry;
+  };
+
+  /** Sequential reference: ImageSeriesReader decodes one file after the other.*/
+  VolumeType::Pointer ReadSequentially(const mitk::StringList& filenames)
+  {
+    typedef itk::ImageSeriesReader<VolumeType> ReaderType;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO(itk::GDCMImageIO::New());
+    reader->ReverseOrderOff();
+    reader->SetFileNames(filenames);
+    reader->Update();
+
+    VolumeType::Pointer volume = reader->GetOutput();
+    volume->DisconnectPipeline();
+    return volume;
+  }
+
+  void CheckEqualVolume(mitk::Image* image, unsigned int timeStep, const VolumeType* expected, const std::string& what)
+  {
+    const VolumeType::SizeType size = expected->GetLargestPossibleRegion().GetSize();
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      MITK_TEST_CONDITION_REQUIRED(image->GetDimension(d) == size[d], what << ": same size in dimension " << d);
+    }
+
+    const mitk::BaseGeometry* geometry = image->GetTimeGeometry()->GetGeometryForTimeStep(timeStep);
+    mitk::Point3D expectedOrigin;
+    mitk::Vector3D expectedSpacing;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      expectedOrigin[d] = expected->GetOrigin()[d];
+      expectedSpacing[d] = expected->GetSpacing()[d];
+    }
+    MITK_TEST_CONDITION(mitk::Equal(geometry->GetOrigin(), expectedOrigin, mitk::eps, true), what << ": same origin");
+    MITK_TEST_CONDITION(mitk::Equal(geometry->GetSpacing(), expectedSpacing, mitk::eps, true), what << ": same spacing");
+
+    mitk::ImageReadAccessor accessor(image, image->GetVolumeData(timeStep));
+    const std::size_t numberOfBytes = expected->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(unsigned short);
+    MITK_TEST_CONDITION(std::memcmp(accessor.GetData(), expected->GetBufferPointer(), numberOfBytes) == 0,
+                        what << ": same pixel values");
+  }
+
+  void TestUntiltedVolume(const std::string& directory)
+  {
+    mitk::TestDICOMLoading loader;
+    const mitk::StringList filenames = loader.WriteSyntheticCTSeries(directory, 20, 32, 48);
+
+    mitk::ITKDICOMSeriesReaderHelper helper;
+    mitk::Image::Pointer image = helper.Load(filenames, false, mitk::GantryTiltInformation());
+    MITK_TEST_CONDITION_REQUIRED(image.IsNotNull(), "Untilted series is loaded");
+
+    CheckEqualVolume(image, 0, ReadSequentially(filenames), "Untilted series");
+  }
+
+  void TestTiltedVolume(const std::string& directory)
+  {
+    const unsigned int numberOfSlices = 12;
+    const double tiltShift = 0.25;
+
+    mitk::TestDICOMLoading loader;
+    const mitk::StringList filenames = loader.WriteSyntheticCTSeries(directory, numberOfSlices, 32, 48, tiltShift);
+
+    std::ostringstream lastOrigin;
+    lastOrigin.imbue(std::locale::classic());
+    lastOrigin << "0\\" << (numberOfSlices - 1) * tiltShift << "\\" << numberOfSlices - 1;
+    const mitk::GantryTiltInformation tiltInfo = mitk::GantryTiltInformation::MakeFromTagValues(
+      "0\\0\\0", lastOrigin.str(), "1\\0\\0\\0\\1\\0", numberOfSlices - 1);
+    MITK_TEST_CONDITION_REQUIRED(tiltInfo.IsRegularGantryTilt(), "Synthetic series has a gantry tilt");
+
+    TestSeriesReaderHelper helper;
+    mitk::Image::Pointer image = helper.Load(filenames, true, tiltInfo);
+    MITK_TEST_CONDITION_REQUIRED(image.IsNotNull(), "Tilted series is loaded");
+
+    VolumeType::Pointer sequential = ReadSequentially(filenames);
+    VolumeType::Pointer expected = helper.FixUpTiltedGeometry(sequential.GetPointer(), tiltInfo);
+
+    CheckEqualVolume(image, 0, expected, "Tilted series");
+  }
+
+  void Test3DnT(const std::string& directory)
+  {
+    const unsigned int numberOfTimeSteps = 3;
+
+    mitk::TestDICOMLoading loader;
+    mitk::ITKDICOMSeriesReaderHelper::StringContainerList filenamesOfTimeSteps;
+    for (unsigned int t = 0; t < numberOfTimeSteps; ++t)
+    {
+      filenamesOfTimeSteps.push_back(loader.WriteSyntheticCTSeries(directory, 10, 32, 48, 0.0, t));
+    }
+
+    mitk::ITKDICOMSeriesReaderHelper helper;
+    mitk::Image::Pointer image = helper.Load3DnT(filenamesOfTimeSteps, false, mitk::GantryTiltInformation());
+    MITK_TEST_CONDITION_REQUIRED(image.IsNotNull(), "3D+t series is loaded");
+    MITK_TEST_CONDITION_REQUIRED(image->GetTimeSteps() == numberOfTimeSteps, "3D+t image has all time steps");
+
+    unsigned int t = 0;
+    for (const auto& filenames : filenamesOfTimeSteps)
+    {
+      std::ostringstream what;
+      what << "Time step " << t;
+      CheckEqualVolume(image, t, ReadSequentially(filenames), what.str());
+      ++t;
+    }
+  }
+}
+
+/**
+ * Compares the volumes of ITKDICOMSeriesReaderHelper, which decodes the slices of a volume in parallel,
+ * with those of itk::ImageSeriesReader, which decodes them one after the other. Small synthetic series
+ * cover a plain volume, a gantry tilted volume (tilt correction applied to both) and a 3D+t series.
+ */
+int mitkDICOMSeriesLoadingTest(int /*argc*/, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("mitkDICOMSeriesLoadingTest")
+
+  const std::string directory = mitk::IOUtil::CreateTemporaryDirectory("DICOMSeriesLoadingTest-XXXXXX");
+
+  // every case writes to its own directory, so the file names of the cases cannot collide
+  itksys::SystemTools::MakeDirectory(directory + "/untilted");
+  TestUntiltedVolume(directory + "/untilted");
+  itksys::SystemTools::MakeDirectory(directory + "/tilted");
+  TestTiltedVolume(directory + "/tilted");
+  itksys::SystemTools::MakeDirectory(directory + "/3DnT");
+  Test3DnT(directory + "/3DnT");
+
+  itksys::SystemTools::RemoveADirectory(directory);
+
+  MITK_TEST_END()
+}
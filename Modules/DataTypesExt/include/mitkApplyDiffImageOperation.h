@@ -35,7 +35,8 @@ namespace mitk
    used to keep the image alive -- the purpose of this class is undo and the undo
    stack should not keep things alive forever.
 
-   To save memory, zlib compression is used via CompressedImageContainer.
+   To save memory, the image is compressed via CompressedImageContainer. Do and undo operations
+   usually store the same or similar images, pass one as reference to the other to share the data.
 
    @ingroup Undo
    @ingroup ToolManagerEtAl
@@ -62,13 +63,16 @@ namespace mitk
       \param sliceIndex brief Which slice to extract (first one has index 0).
       \param sliceDimension Number of the dimension which is constant for all pixels of the desired slice (e.g. 0 for
       axial)
+      \param reference Operation with a diff image of the same size, unchanged parts of the compressed data are
+      shared with it (optional).
     */
     ApplyDiffImageOperation(OperationType operationType,
                             Image *image,
                             Image *diffImage,
                             unsigned int timeStep = 0,
                             unsigned int sliceDimension = 2,
-                            unsigned int sliceIndex = 0);
+                            unsigned int sliceIndex = 0,
+                            const ApplyDiffImageOperation *reference = nullptr);
     ~ApplyDiffImageOperation() override;
 
     // Unfortunately cannot use itkGet/SetMacros here, since Operation does not inherit itk::Object
@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObject.h>
 
+#include <memory>
 #include <vector>
 
 namespace mitk
@@ -32,7 +33,15 @@ namespace mitk
   /**
     \brief Holds one (compressed) mitk::Image
 
-    Uses zlib to compress the data of an mitk::Image.
+    The data of each time step is divided into blocks (32x32x32 pixels for 3D images,
+    128x128 pixels for 2D images), which are compressed independently and in parallel:
+     - blocks that contain a single value store only this value
+     - blocks with few runs of equal pixels (e.g. of segmentations) are run length encoded
+     - all other blocks are compressed with zlib (fastest level)
+
+    Undo operations store successive states of the same image. If such a previous state
+    is passed to SetImage() as reference, the blocks that did not change are shared with
+    it instead of being compressed again.
 
     $Author$
   */
@@ -47,8 +56,11 @@ namespace mitk
        *
        * Will not hold any further SmartPointers to the image.
        *
+       * \param reference container of another state of an image with the same size and pixel type (optional).
+       * Blocks that are identical to the blocks of reference are shared with it. A reference of another size
+       * or pixel type is ignored.
        */
-      void SetImage(Image *);
+      void SetImage(Image *, const CompressedImageContainer *reference = nullptr);
 
     /**
      * \brief Creates a full mitk::Image from its compressed version.
@@ -59,10 +71,41 @@ namespace mitk
      */
     Image::Pointer GetImage();
 
+    /**
+     * \brief Creates a 2D image of one slice, only the blocks that contain the slice are uncompressed.
+     *
+     * Meant for inspecting single slices of a stored volume. The undo operations always restore their
+     * complete diff images with GetImage().
+     *
+     * \param sliceDimension Number of the dimension which is constant for all pixels of the slice (e.g. 2 for axial)
+     * \param sliceIndex Which slice to extract (first one has index 0)
+     * \return nullptr, if the container holds no 3D image or the slice is out of range. The image has no other
+     * geometry information than the size of the slice.
+     */
+    Image::Pointer GetSlice(unsigned int sliceDimension, unsigned int sliceIndex, unsigned int timeStep = 0);
+
+    /** \brief Number of blocks of all time steps */
+    unsigned int GetNumberOfBlocks() const;
+
+    /** \brief Number of blocks that are shared with the reference passed to SetImage() */
+    unsigned int GetNumberOfSharedBlocks() const { return m_NumberOfSharedBlocks; }
+
+    /** \brief Size of the compressed data of all blocks, including shared blocks */
+    unsigned long GetCompressedSizeInBytes() const;
+
   protected:
     CompressedImageContainer(); // purposely hidden
     ~CompressedImageContainer() override;
 
+    struct CompressedBlock;
+    typedef std::shared_ptr<const CompressedBlock> BlockPointer;
+
+    /** \brief Size of a block in pixels and number of blocks, for each of the first three dimensions */
+    void InitializeBlocks();
+
+    /** \brief Index region of a block, begin and end (exclusive) in each of the first three dimensions */
+    void GetBlockRegion(unsigned int blockIndex, unsigned int begin[3], unsigned int end[3]) const;
+
     PixelType *m_PixelType;
 
     unsigned int m_ImageDimension;
@@ -72,8 +115,14 @@ namespace mitk
 
     unsigned int m_NumberOfTimeSteps;
 
-    /// one for each timestep. first = pointer to compressed data; second = size of buffer in bytes
-    std::vector<std::pair<unsigned char *, unsigned long>> m_ByteBuffers;
+    unsigned int m_BlockSize[3];
+    unsigned int m_NumberOfBlocksPerDimension[3];
+    unsigned int m_NumberOfBlocksPerTimeStep;
+
+    /// one vector of blocks for each timestep, blocks are ordered by x, then y, then z
+    std::vector<std::vector<BlockPointer>> m_Blocks;
+
+    unsigned int m_NumberOfSharedBlocks;
 
     BaseGeometry::Pointer m_ImageGeometry;
   };
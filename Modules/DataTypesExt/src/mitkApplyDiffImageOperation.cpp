@@ -23,7 +23,8 @@ mitk::ApplyDiffImageOperation::ApplyDiffImageOperation(OperationType operationTy
                                                        Image *diffImage,
                                                        unsigned int timeStep,
                                                        unsigned int sliceDimension,
-                                                       unsigned int sliceIndex)
+                                                       unsigned int sliceIndex,
+                                                       const ApplyDiffImageOperation *reference)
   : Operation(operationType),
     m_Image(image),
     m_SliceIndex(sliceIndex),
@@ -45,7 +46,7 @@ mitk::ApplyDiffImageOperation::ApplyDiffImageOperation(OperationType operationTy
 
     // keep a compressed version of the image
     zlibContainer = CompressedImageContainer::New();
-    zlibContainer->SetImage(diffImage);
+    zlibContainer->SetImage(diffImage, reference ? reference->zlibContainer.GetPointer() : nullptr);
   }
 }
 
@@ -15,51 +15,290 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkCompressedImageContainer.h"
+#include "mitkExceptionMacro.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkParallelFor.h"
 
 #include "itk_zlib.h"
 
-#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 
-mitk::CompressedImageContainer::CompressedImageContainer() : m_PixelType(nullptr), m_ImageGeometry(nullptr)
+struct mitk::CompressedImageContainer::CompressedBlock
 {
+  unsigned char Encoding;
+  uint64_t Hash; // of the uncompressed data, to find blocks that did not change
+  std::vector<unsigned char> Data;
+};
+
+namespace
+{
+  enum BlockEncoding
+  {
+    UNIFORM_BLOCK = 0, // one pixel value
+    RUN_LENGTH_BLOCK,  // pairs of 16 bit run length and pixel value
+    ZLIB_BLOCK,
+    RAW_BLOCK
+  };
+
+  // blocks with more than one run per this number of pixels are compressed with zlib
+  const std::size_t PixelsPerRunForRunLengthEncoding = 16;
+
+  // the run length is stored in 16 bits
+  const std::size_t MaximumRunLength = 65535;
+
+  /** \brief 64 bit FNV-1a hash */
+  uint64_t HashBlock(const unsigned char *data, std::size_t size)
+  {
+    uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      hash ^= data[i];
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  void EncodeBlock(const unsigned char *raw,
+                   std::size_t numberOfPixels,
+                   std::size_t pixelSize,
+                   unsigned char &encoding,
+                   std::vector<unsigned char> &data)
+  {
+    const std::size_t size = numberOfPixels * pixelSize;
+
+    // count runs of equal pixels, stop as soon as run length encoding does not pay off
+    const std::size_t maximumNumberOfRuns = numberOfPixels / PixelsPerRunForRunLengthEncoding;
+    std::size_t numberOfRuns = 1;
+    for (std::size_t p = 1; p < numberOfPixels && numberOfRuns <= maximumNumberOfRuns; ++p)
+    {
+      if (std::memcmp(raw + p * pixelSize, raw + (p - 1) * pixelSize, pixelSize) != 0)
+      {
+        ++numberOfRuns;
+      }
+    }
+
+    if (numberOfRuns == 1)
+    {
+      encoding = UNIFORM_BLOCK;
+      data.assign(raw, raw + pixelSize);
+      return;
+    }
+
+    if (numberOfRuns <= maximumNumberOfRuns)
+    {
+      encoding = RUN_LENGTH_BLOCK;
+      data.clear();
+      data.reserve(numberOfRuns * (2 + pixelSize));
+      std::size_t p = 0;
+      while (p < numberOfPixels)
+      {
+        std::size_t run = 1;
+        while (p + run < numberOfPixels && run < MaximumRunLength &&
+               std::memcmp(raw + (p + run) * pixelSize, raw + p * pixelSize, pixelSize) == 0)
+        {
+          ++run;
+        }
+        data.push_back(static_cast<unsigned char>(run & 0xff));
+        data.push_back(static_cast<unsigned char>(run >> 8));
+        data.insert(data.end(), raw + p * pixelSize, raw + (p + 1) * pixelSize);
+        p += run;
+      }
+      return;
+    }
+
+    ::uLongf destLen(::compressBound(size));
+    data.resize(destLen);
+    if (::compress2(data.data(), &destLen, raw, size, Z_BEST_SPEED) == Z_OK && destLen < size)
+    {
+      encoding = ZLIB_BLOCK;
+      data.resize(destLen);
+      data.shrink_to_fit();
+      return;
+    }
+
+    encoding = RAW_BLOCK;
+    data.assign(raw, raw + size);
+  }
+
+  void DecodeBlock(unsigned char encoding,
+                   const std::vector<unsigned char> &data,
+                   std::size_t numberOfPixels,
+                   std::size_t pixelSize,
+                   unsigned char *raw)
+  {
+    const std::size_t size = numberOfPixels * pixelSize;
+    switch (encoding)
+    {
+      case UNIFORM_BLOCK:
+        for (std::size_t p = 0; p < numberOfPixels; ++p)
+        {
+          std::memcpy(raw + p * pixelSize, data.data(), pixelSize);
+        }
+        break;
+      case RUN_LENGTH_BLOCK:
+      {
+        std::size_t p = 0;
+        for (std::size_t position = 0; position + 2 + pixelSize <= data.size(); position += 2 + pixelSize)
+        {
+          const std::size_t run = data[position] | (static_cast<std::size_t>(data[position + 1]) << 8);
+          for (std::size_t r = 0; r < run && p < numberOfPixels; ++r, ++p)
+          {
+            std::memcpy(raw + p * pixelSize, data.data() + position + 2, pixelSize);
+          }
+        }
+        if (p != numberOfPixels)
+        {
+          mitkThrow() << "Run length encoded image block is corrupted";
+        }
+        break;
+      }
+      case ZLIB_BLOCK:
+      {
+        ::uLongf destLen(size);
+        if (::uncompress(raw, &destLen, data.data(), data.size()) != Z_OK || destLen != size)
+        {
+          mitkThrow() << "Compressed image block is corrupted";
+        }
+        break;
+      }
+      default:
+        std::memcpy(raw, data.data(), size);
+        break;
+    }
+  }
+
+  /** \brief Copies a region of a volume (x fastest) into a contiguous block buffer */
+  void CopyBlockFromVolume(const unsigned char *volume,
+                           const unsigned int dimensions[3],
+                           const unsigned int begin[3],
+                           const unsigned int end[3],
+                           std::size_t pixelSize,
+                           unsigned char *block)
+  {
+    const std::size_t rowSize = (end[0] - begin[0]) * pixelSize;
+    for (unsigned int z = begin[2]; z < end[2]; ++z)
+    {
+      for (unsigned int y = begin[1]; y < end[1]; ++y, block += rowSize)
+      {
+        const std::size_t offset = (static_cast<std::size_t>(z) * dimensions[1] + y) * dimensions[0] + begin[0];
+        std::memcpy(block, volume + offset * pixelSize, rowSize);
+      }
+    }
+  }
+
+  /** \brief Copies a contiguous block buffer into a region of a volume (x fastest) */
+  void CopyBlockToVolume(const unsigned char *block,
+                         const unsigned int dimensions[3],
+                         const unsigned int begin[3],
+                         const unsigned int end[3],
+                         std::size_t pixelSize,
+                         unsigned char *volume)
+  {
+    const std::size_t rowSize = (end[0] - begin[0]) * pixelSize;
+    for (unsigned int z = begin[2]; z < end[2]; ++z)
+    {
+      for (unsigned int y = begin[1]; y < end[1]; ++y, block += rowSize)
+      {
+        const std::size_t offset = (static_cast<std::size_t>(z) * dimensions[1] + y) * dimensions[0] + begin[0];
+        std::memcpy(volume + offset * pixelSize, block, rowSize);
+      }
+    }
+  }
+
+  std::size_t GetNumberOfPixels(const unsigned int begin[3], const unsigned int end[3])
+  {
+    return static_cast<std::size_t>(end[0] - begin[0]) * (end[1] - begin[1]) * (end[2] - begin[2]);
+  }
 }
 
-mitk::CompressedImageContainer::~CompressedImageContainer()
+mitk::CompressedImageContainer::CompressedImageContainer()
+  : m_PixelType(nullptr),
+    m_ImageDimension(0),
+    m_OneTimeStepImageSizeInBytes(0),
+    m_NumberOfTimeSteps(0),
+    m_NumberOfBlocksPerTimeStep(0),
+    m_NumberOfSharedBlocks(0),
+    m_ImageGeometry(nullptr)
 {
-  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  for (unsigned int i = 0; i < 3; ++i)
   {
-    free(iter->first);
+    m_BlockSize[i] = 1;
+    m_NumberOfBlocksPerDimension[i] = 0;
   }
+}
 
+mitk::CompressedImageContainer::~CompressedImageContainer()
+{
   delete m_PixelType;
 }
 
-void mitk::CompressedImageContainer::SetImage(Image *image)
+void mitk::CompressedImageContainer::InitializeBlocks()
 {
-  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  // blocks of about 32k pixels, a 16 bit run length can cover a whole block
+  const unsigned int edgeLength = m_ImageDimension >= 3 ? 32 : (m_ImageDimension == 2 ? 128 : 32768);
+
+  m_NumberOfBlocksPerTimeStep = 1;
+  for (unsigned int i = 0; i < 3; ++i)
   {
-    free(iter->first);
+    const unsigned int size = i < m_ImageDimension ? m_ImageDimensions[i] : 1;
+    m_BlockSize[i] = std::max(1u, std::min(edgeLength, size));
+    m_NumberOfBlocksPerDimension[i] = (size + m_BlockSize[i] - 1) / m_BlockSize[i];
+    m_NumberOfBlocksPerTimeStep *= m_NumberOfBlocksPerDimension[i];
   }
+}
 
-  m_ByteBuffers.clear();
+void mitk::CompressedImageContainer::GetBlockRegion(unsigned int blockIndex,
+                                                    unsigned int begin[3],
+                                                    unsigned int end[3]) const
+{
+  unsigned int blockCoordinates[3];
+  blockCoordinates[0] = blockIndex % m_NumberOfBlocksPerDimension[0];
+  blockIndex /= m_NumberOfBlocksPerDimension[0];
+  blockCoordinates[1] = blockIndex % m_NumberOfBlocksPerDimension[1];
+  blockCoordinates[2] = blockIndex / m_NumberOfBlocksPerDimension[1];
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    const unsigned int size = i < m_ImageDimension ? m_ImageDimensions[i] : 1;
+    begin[i] = blockCoordinates[i] * m_BlockSize[i];
+    end[i] = std::min(begin[i] + m_BlockSize[i], size);
+  }
+}
+
+void mitk::CompressedImageContainer::SetImage(Image *image, const CompressedImageContainer *reference)
+{
+  std::vector<unsigned int> imageDimensions;
+  for (unsigned int i = 0; i < image->GetDimension(); ++i)
+  {
+    imageDimensions.push_back(image->GetDimension(i));
+  }
+
+  // take the blocks of the reference before anything is changed, reference may be this container
+  std::vector<std::vector<BlockPointer>> referenceBlocks;
+  if (reference != nullptr && reference->m_PixelType != nullptr &&
+      *reference->m_PixelType == image->GetPixelType() && reference->m_ImageDimensions == imageDimensions)
+  {
+    referenceBlocks = reference->m_Blocks;
+  }
+
+  m_Blocks.clear();
+  m_NumberOfSharedBlocks = 0;
 
-  // Compress diff image using zlib (will be restored on demand)
   // determine memory size occupied by voxel data
   m_ImageDimension = image->GetDimension();
-  m_ImageDimensions.clear();
+  m_ImageDimensions = imageDimensions;
 
+  delete m_PixelType;
   m_PixelType = new mitk::PixelType(image->GetPixelType());
 
   m_OneTimeStepImageSizeInBytes = m_PixelType->GetSize(); // bits per element divided by 8
-  for (unsigned int i = 0; i < m_ImageDimension; ++i)
+  for (unsigned int i = 0; i < m_ImageDimension && i < 3; ++i)
   {
-    unsigned int currentImageDimension = image->GetDimension(i);
-    m_ImageDimensions.push_back(currentImageDimension);
-    if (i < 3)
-    {
-      m_OneTimeStepImageSizeInBytes *= currentImageDimension; // only the 3D memory size
-    }
+    m_OneTimeStepImageSizeInBytes *= m_ImageDimensions[i]; // only the 3D memory size
   }
 
   m_ImageGeometry = image->GetGeometry();
@@ -70,64 +309,72 @@ void mitk::CompressedImageContainer::SetImage(Image *image)
     m_NumberOfTimeSteps = image->GetDimension(3);
   }
 
+  this->InitializeBlocks();
+
+  unsigned int volumeDimensions[3];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    volumeDimensions[i] = i < m_ImageDimension ? m_ImageDimensions[i] : 1;
+  }
+
+  std::vector<std::unique_ptr<ImageReadAccessor>> accessors;
+  std::vector<const unsigned char *> volumes;
   for (unsigned int timestep = 0; timestep < m_NumberOfTimeSteps; ++timestep)
   {
-    // allocate a buffer as specified by zlib
-    unsigned long bufferSize =
-      m_OneTimeStepImageSizeInBytes + static_cast<unsigned long>(m_OneTimeStepImageSizeInBytes * 0.2) + 12;
-    auto *byteBuffer = (unsigned char *)malloc(bufferSize);
+    accessors.emplace_back(new ImageReadAccessor(image, image->GetVolumeData(timestep)));
+    volumes.push_back(static_cast<const unsigned char *>(accessors.back()->GetData()));
+  }
 
-    if (itk::Object::GetDebug())
-    {
-      // compress image here into a buffer
-      MITK_INFO << "Using ZLib version: '" << zlibVersion() << "'" << std::endl
-                << "Attempting to compress " << m_OneTimeStepImageSizeInBytes << " image bytes into a buffer of size "
-                << bufferSize << std::endl;
-    }
+  const std::size_t pixelSize = m_PixelType->GetSize();
+  const unsigned int numberOfBlocks = m_NumberOfBlocksPerTimeStep;
+  m_Blocks.assign(m_NumberOfTimeSteps, std::vector<BlockPointer>(numberOfBlocks));
+  std::atomic<unsigned int> numberOfSharedBlocks(0);
+
+  mitk::ParallelFor(static_cast<std::size_t>(m_NumberOfTimeSteps) * numberOfBlocks, [&](std::size_t i) {
+    const unsigned int timestep = static_cast<unsigned int>(i / numberOfBlocks);
+    const unsigned int blockIndex = static_cast<unsigned int>(i % numberOfBlocks);
+
+    unsigned int begin[3], end[3];
+    this->GetBlockRegion(blockIndex, begin, end);
+    const std::size_t numberOfPixels = GetNumberOfPixels(begin, end);
 
-    ImageReadAccessor imgAcc(image, image->GetVolumeData(timestep));
-    ::Bytef *dest(byteBuffer);
-    ::uLongf destLen(bufferSize);
-    auto *source((unsigned char *)imgAcc.GetData());
-    ::uLongf sourceLen(m_OneTimeStepImageSizeInBytes);
-    int zlibRetVal = ::compress(dest, &destLen, source, sourceLen);
-    if (itk::Object::GetDebug())
+    std::vector<unsigned char> raw(numberOfPixels * pixelSize);
+    CopyBlockFromVolume(volumes[timestep], volumeDimensions, begin, end, pixelSize, raw.data());
+    const uint64_t hash = HashBlock(raw.data(), raw.size());
+
+    // share blocks that did not change, the hash only selects the candidates
+    if (!referenceBlocks.empty() && referenceBlocks[timestep][blockIndex]->Hash == hash)
     {
-      if (zlibRetVal == Z_OK)
+      const BlockPointer &referenceBlock = referenceBlocks[timestep][blockIndex];
+      std::vector<unsigned char> referenceRaw(raw.size());
+      DecodeBlock(referenceBlock->Encoding, referenceBlock->Data, numberOfPixels, pixelSize, referenceRaw.data());
+      if (referenceRaw == raw)
       {
-        MITK_INFO << "Success, using " << destLen << " bytes of the buffer (ratio "
-                  << ((double)destLen / (double)sourceLen) << ")" << std::endl;
-      }
-      else
-      {
-        switch (zlibRetVal)
-        {
-          case Z_MEM_ERROR:
-            MITK_ERROR << "not enough memory" << std::endl;
-            break;
-          case Z_BUF_ERROR:
-            MITK_ERROR << "output buffer too small" << std::endl;
-            break;
-          default:
-            MITK_ERROR << "other, unspecified error" << std::endl;
-            break;
-        }
+        m_Blocks[timestep][blockIndex] = referenceBlock;
+        ++numberOfSharedBlocks;
+        return;
       }
     }
 
-    // only use the neccessary amount of memory, realloc the buffer!
-    byteBuffer = (unsigned char *)realloc(byteBuffer, destLen);
-    bufferSize = destLen;
-    // MITK_INFO << "Using " << bufferSize << " bytes to store compressed image (" << destLen << " needed)" <<
-    // std::endl;
+    std::shared_ptr<CompressedBlock> block = std::make_shared<CompressedBlock>();
+    block->Hash = hash;
+    EncodeBlock(raw.data(), numberOfPixels, pixelSize, block->Encoding, block->Data);
+    m_Blocks[timestep][blockIndex] = block;
+  });
+
+  m_NumberOfSharedBlocks = numberOfSharedBlocks;
 
-    m_ByteBuffers.push_back(std::pair<unsigned char *, unsigned long>(byteBuffer, bufferSize));
+  if (itk::Object::GetDebug())
+  {
+    MITK_INFO << "Compressed " << m_OneTimeStepImageSizeInBytes * m_NumberOfTimeSteps << " image bytes into "
+              << this->GetNumberOfBlocks() << " blocks (" << m_NumberOfSharedBlocks << " shared) of "
+              << this->GetCompressedSizeInBytes() << " bytes" << std::endl;
   }
 }
 
 mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
 {
-  if (m_ByteBuffers.empty())
+  if (m_Blocks.empty())
     return nullptr;
 
   // uncompress image data, create an Image
@@ -139,44 +386,124 @@ mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
   image->Initialize(*m_PixelType, m_ImageDimension, dims); // this IS needed, right ?? But it does allocate memory ->
                                                            // does create one big lump of memory (also in windows)
 
-  unsigned int timeStep(0);
-  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter, ++timeStep)
+  unsigned int volumeDimensions[3];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    volumeDimensions[i] = i < m_ImageDimension ? m_ImageDimensions[i] : 1;
+  }
+
+  std::vector<std::unique_ptr<ImageWriteAccessor>> accessors;
+  std::vector<unsigned char *> volumes;
+  for (unsigned int timeStep = 0; timeStep < m_NumberOfTimeSteps; ++timeStep)
+  {
+    accessors.emplace_back(new ImageWriteAccessor(image, image->GetVolumeData(timeStep)));
+    volumes.push_back(static_cast<unsigned char *>(accessors.back()->GetData()));
+  }
+
+  // blocks cover disjoint regions and can be written in parallel
+  const std::size_t pixelSize = m_PixelType->GetSize();
+  const unsigned int numberOfBlocks = m_NumberOfBlocksPerTimeStep;
+  mitk::ParallelFor(static_cast<std::size_t>(m_NumberOfTimeSteps) * numberOfBlocks, [&](std::size_t i) {
+    const unsigned int timeStep = static_cast<unsigned int>(i / numberOfBlocks);
+    const unsigned int blockIndex = static_cast<unsigned int>(i % numberOfBlocks);
+
+    unsigned int begin[3], end[3];
+    this->GetBlockRegion(blockIndex, begin, end);
+    const std::size_t numberOfPixels = GetNumberOfPixels(begin, end);
+
+    const BlockPointer &block = m_Blocks[timeStep][blockIndex];
+    std::vector<unsigned char> raw(numberOfPixels * pixelSize);
+    DecodeBlock(block->Encoding, block->Data, numberOfPixels, pixelSize, raw.data());
+    CopyBlockToVolume(raw.data(), volumeDimensions, begin, end, pixelSize, volumes[timeStep]);
+  });
+
+  accessors.clear();
+
+  image->SetGeometry(m_ImageGeometry);
+  image->Modified();
+
+  return image;
+}
+
+mitk::Image::Pointer mitk::CompressedImageContainer::GetSlice(unsigned int sliceDimension,
+                                                              unsigned int sliceIndex,
+                                                              unsigned int timeStep)
+{
+  if (m_Blocks.empty() || m_ImageDimension < 3 || sliceDimension > 2 || timeStep >= m_NumberOfTimeSteps ||
+      sliceIndex >= m_ImageDimensions[sliceDimension])
   {
-    ImageReadAccessor imgAcc(image, image->GetVolumeData(timeStep));
-    auto *dest((unsigned char *)imgAcc.GetData());
-    ::uLongf destLen(m_OneTimeStepImageSizeInBytes);
-    ::Bytef *source(iter->first);
-    ::uLongf sourceLen(iter->second);
-    int zlibRetVal = ::uncompress(dest, &destLen, source, sourceLen);
-    if (itk::Object::GetDebug())
+    return nullptr;
+  }
+
+  // the two dimensions of the slice, in the order of the volume
+  const unsigned int u = sliceDimension == 0 ? 1 : 0;
+  const unsigned int v = sliceDimension == 2 ? 1 : 2;
+  unsigned int sliceDimensions[2] = {m_ImageDimensions[u], m_ImageDimensions[v]};
+
+  Image::Pointer slice = Image::New();
+  slice->Initialize(*m_PixelType, 2, sliceDimensions);
+
+  // only the blocks that contain the slice
+  std::vector<unsigned int> blockIndices;
+  for (unsigned int blockIndex = 0; blockIndex < m_NumberOfBlocksPerTimeStep; ++blockIndex)
+  {
+    unsigned int begin[3], end[3];
+    this->GetBlockRegion(blockIndex, begin, end);
+    if (begin[sliceDimension] <= sliceIndex && sliceIndex < end[sliceDimension])
     {
-      if (zlibRetVal == Z_OK)
-      {
-        MITK_INFO << "Success, destLen now " << destLen << " bytes" << std::endl;
-      }
-      else
+      blockIndices.push_back(blockIndex);
+    }
+  }
+
+  {
+    ImageWriteAccessor accessor(slice);
+    auto *sliceData = static_cast<unsigned char *>(accessor.GetData());
+    const std::size_t pixelSize = m_PixelType->GetSize();
+
+    mitk::ParallelFor(blockIndices.size(), [&](std::size_t i) {
+      unsigned int begin[3], end[3];
+      this->GetBlockRegion(blockIndices[i], begin, end);
+      const std::size_t numberOfPixels = GetNumberOfPixels(begin, end);
+
+      const BlockPointer &block = m_Blocks[timeStep][blockIndices[i]];
+      std::vector<unsigned char> raw(numberOfPixels * pixelSize);
+      DecodeBlock(block->Encoding, block->Data, numberOfPixels, pixelSize, raw.data());
+
+      unsigned int position[3];
+      position[sliceDimension] = sliceIndex;
+      for (position[v] = begin[v]; position[v] < end[v]; ++position[v])
       {
-        switch (zlibRetVal)
+        for (position[u] = begin[u]; position[u] < end[u]; ++position[u])
         {
-          case Z_DATA_ERROR:
-            MITK_ERROR << "compressed data corrupted" << std::endl;
-            break;
-          case Z_MEM_ERROR:
-            MITK_ERROR << "not enough memory" << std::endl;
-            break;
-          case Z_BUF_ERROR:
-            MITK_ERROR << "output buffer too small" << std::endl;
-            break;
-          default:
-            MITK_ERROR << "other, unspecified error" << std::endl;
-            break;
+          const std::size_t blockOffset =
+            (static_cast<std::size_t>(position[2] - begin[2]) * (end[1] - begin[1]) + (position[1] - begin[1])) *
+              (end[0] - begin[0]) +
+            (position[0] - begin[0]);
+          const std::size_t sliceOffset = static_cast<std::size_t>(position[v]) * sliceDimensions[0] + position[u];
+          std::memcpy(sliceData + sliceOffset * pixelSize, raw.data() + blockOffset * pixelSize, pixelSize);
         }
       }
-    }
+    });
   }
 
-  image->SetGeometry(m_ImageGeometry);
-  image->Modified();
+  slice->Modified();
+  return slice;
+}
 
-  return image;
+unsigned int mitk::CompressedImageContainer::GetNumberOfBlocks() const
+{
+  return m_NumberOfTimeSteps * m_NumberOfBlocksPerTimeStep;
+}
+
+unsigned long mitk::CompressedImageContainer::GetCompressedSizeInBytes() const
+{
+  unsigned long size = 0;
+  for (const auto &timeStepBlocks : m_Blocks)
+  {
+    for (const auto &block : timeStepBlocks)
+    {
+      size += block->Data.size();
+    }
+  }
+  return size;
 }
@@ -19,6 +19,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIOUtil.h"
 #include "mitkImageDataItem.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <cstring>
 
 class mitkCompressedImageContainerTestClass
 {
@@ -111,6 +114,123 @@ public:
       }
     }
   }
+
+  static bool HasSameData(mitk::Image *image, mitk::Image *otherImage)
+  {
+    unsigned long oneTimeStepSizeInBytes = image->GetPixelType().GetSize();
+    for (unsigned int dim = 0; dim < image->GetDimension() && dim < 3; ++dim)
+    {
+      oneTimeStepSizeInBytes *= image->GetDimension(dim);
+    }
+
+    unsigned int numberOfTimeSteps = image->GetDimension() > 3 ? image->GetDimension(3) : 1;
+    for (unsigned int timeStep = 0; timeStep < numberOfTimeSteps; ++timeStep)
+    {
+      mitk::ImageReadAccessor imgAcc(image, image->GetVolumeData(timeStep));
+      mitk::ImageReadAccessor otherImgAcc(otherImage, otherImage->GetVolumeData(timeStep));
+      if (std::memcmp(imgAcc.GetData(), otherImgAcc.GetData(), oneTimeStepSizeInBytes) != 0)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// a second state of the image should only store the changed block
+  static void TestReference(mitk::CompressedImageContainer *container, mitk::Image *image, unsigned int &numberFailed)
+  {
+    mitk::CompressedImageContainer::Pointer sameContainer = mitk::CompressedImageContainer::New();
+    sameContainer->SetImage(image, container);
+    if (sameContainer->GetNumberOfSharedBlocks() != sameContainer->GetNumberOfBlocks())
+    {
+      ++numberFailed;
+      std::cerr << "  (EE) Only " << sameContainer->GetNumberOfSharedBlocks() << " of "
+                << sameContainer->GetNumberOfBlocks() << " blocks are shared with an identical image" << std::endl;
+    }
+
+    mitk::Image::Pointer changedImage = image->Clone();
+    {
+      mitk::ImageWriteAccessor changedImgAcc(changedImage, changedImage->GetVolumeData(0));
+      auto *data = static_cast<unsigned char *>(changedImgAcc.GetData());
+      data[0] = static_cast<unsigned char>(data[0] + 1);
+    }
+
+    mitk::CompressedImageContainer::Pointer changedContainer = mitk::CompressedImageContainer::New();
+    changedContainer->SetImage(changedImage, container);
+    if (changedContainer->GetNumberOfSharedBlocks() + 1 != changedContainer->GetNumberOfBlocks())
+    {
+      ++numberFailed;
+      std::cerr << "  (EE) " << changedContainer->GetNumberOfSharedBlocks() << " of "
+                << changedContainer->GetNumberOfBlocks() << " blocks are shared after changing one pixel" << std::endl;
+    }
+
+    mitk::Image::Pointer uncompressedImage = changedContainer->GetImage();
+    if (!HasSameData(changedImage, uncompressedImage))
+    {
+      ++numberFailed;
+      std::cerr << "  (EE) Pixel data of changed image not identical after uncompression" << std::endl;
+    }
+  }
+
+  /// slices of 3D images are uncompressed separately
+  static void TestSlices(mitk::CompressedImageContainer *container, mitk::Image *image, unsigned int &numberFailed)
+  {
+    if (image->GetDimension() < 3)
+    {
+      if (container->GetSlice(2, 0).IsNotNull())
+      {
+        ++numberFailed;
+        std::cerr << "  (EE) Slice of a 2D image should not be available" << std::endl;
+      }
+      return;
+    }
+
+    const std::size_t pixelSize = image->GetPixelType().GetSize();
+    const unsigned int dims[3] = {image->GetDimension(0), image->GetDimension(1), image->GetDimension(2)};
+    mitk::ImageReadAccessor imgAcc(image, image->GetVolumeData(0));
+    auto *volume = static_cast<const unsigned char *>(imgAcc.GetData());
+
+    for (unsigned int sliceDimension = 0; sliceDimension < 3; ++sliceDimension)
+    {
+      const unsigned int sliceIndex = dims[sliceDimension] / 2;
+      mitk::Image::Pointer slice = container->GetSlice(sliceDimension, sliceIndex);
+      const unsigned int u = sliceDimension == 0 ? 1 : 0;
+      const unsigned int v = sliceDimension == 2 ? 1 : 2;
+      if (slice.IsNull() || slice->GetDimension(0) != dims[u] || slice->GetDimension(1) != dims[v])
+      {
+        ++numberFailed;
+        std::cerr << "  (EE) Slice " << sliceIndex << " of dimension " << sliceDimension << " has a wrong size"
+                  << std::endl;
+        continue;
+      }
+
+      mitk::ImageReadAccessor sliceAcc(slice);
+      auto *sliceData = static_cast<const unsigned char *>(sliceAcc.GetData());
+      unsigned long difference(0);
+      unsigned int position[3];
+      position[sliceDimension] = sliceIndex;
+      for (position[v] = 0; position[v] < dims[v]; ++position[v])
+      {
+        for (position[u] = 0; position[u] < dims[u]; ++position[u])
+        {
+          const std::size_t volumeOffset =
+            (static_cast<std::size_t>(position[2]) * dims[1] + position[1]) * dims[0] + position[0];
+          const std::size_t sliceOffset = static_cast<std::size_t>(position[v]) * dims[u] + position[u];
+          if (std::memcmp(volume + volumeOffset * pixelSize, sliceData + sliceOffset * pixelSize, pixelSize) != 0)
+          {
+            ++difference;
+          }
+        }
+      }
+
+      if (difference > 0)
+      {
+        ++numberFailed;
+        std::cerr << "  (EE) Slice " << sliceIndex << " of dimension " << sliceDimension << ": " << difference
+                  << " pixels different." << std::endl;
+      }
+    }
+  }
 };
 
 /// ctest entry point
@@ -165,6 +285,8 @@ int mitkCompressedImageContainerTest(int argc, char *argv[])
 
   // some real work
   mitkCompressedImageContainerTestClass::Test(container, image, numberFailed);
+  mitkCompressedImageContainerTestClass::TestReference(container, image, numberFailed);
+  mitkCompressedImageContainerTestClass::TestSlices(container, image, numberFailed);
 
   std::cout << "Testing destruction" << std::endl;
 
@@ -30,6 +30,8 @@ class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
   MITK_TEST(Denoise_NLMr_shouldReturnTrue);
   MITK_TEST(Denoise_NLMv_shouldReturnTrue);
   MITK_TEST(Denoise_NLMvr_shouldReturnTrue);
+  MITK_TEST(Denoise_NLMgFast_shouldReturnTrue);
+  MITK_TEST(Denoise_NLMvFast_shouldReturnTrue);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -164,6 +166,52 @@ public:
     MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "NLMvr should always return the same result.");
   }
 
+  void Denoise_NLMgFast_shouldReturnTrue()
+  {
+    std::string referenceImagePath = GetTestDataFilePath("DiffusionImaging/Denoising/test_multi_NLMg.dwi");
+    m_ReferenceImage =  mitk::IOUtil::Load<mitk::Image>(referenceImagePath);
+
+    m_DenoisingFilter->SetUseRicianAdaption(false);
+    m_DenoisingFilter->SetUseJointInformation(false);
+    m_DenoisingFilter->SetUseFastAlgorithm(true);
+    try
+    {
+      m_DenoisingFilter->Update();
+    }
+    catch(std::exception& e)
+    {
+      MITK_ERROR << e.what();
+    }
+
+    mitk::GrabItkImageMemory(m_DenoisingFilter->GetOutput(),m_DenoisedImage);
+    m_DenoisedImage->SetPropertyList(m_Image->GetPropertyList()->Clone());
+
+    MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "Fast NLMg should return the same result as NLMg.");
+  }
+
+  void Denoise_NLMvFast_shouldReturnTrue()
+  {
+    std::string referenceImagePath = GetTestDataFilePath("DiffusionImaging/Denoising/test_multi_NLMv.dwi");
+    m_ReferenceImage = mitk::IOUtil::Load<mitk::Image>(referenceImagePath);
+
+    m_DenoisingFilter->SetUseRicianAdaption(false);
+    m_DenoisingFilter->SetUseJointInformation(true);
+    m_DenoisingFilter->SetUseFastAlgorithm(true);
+    try
+    {
+      m_DenoisingFilter->Update();
+    }
+    catch(std::exception& e)
+    {
+      MITK_ERROR << e.what();
+    }
+
+    mitk::GrabItkImageMemory(m_DenoisingFilter->GetOutput(),m_DenoisedImage);
+    m_DenoisedImage->SetPropertyList(m_Image->GetPropertyList()->Clone());
+
+    MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "Fast NLMv should return the same result as NLMv.");
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkNonLocalMeansDenoising)
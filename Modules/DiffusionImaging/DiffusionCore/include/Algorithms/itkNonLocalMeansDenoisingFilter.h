@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImageToImageFilter.h"
 #include "itkVectorImage.h"
 
+#include <vector>
+
 
 namespace itk{
   /** @class NonLocalMeansDenoisingFilter
@@ -83,6 +85,18 @@ namespace itk{
      * If this flag is true the filter uses a method which is optimized for Rician distributed noise.
      */
     itkSetMacro(UseRicianAdaption, bool)
+    /**
+     * @brief Set flag to use the fast algorithm
+     *
+     * If this flag is true the patch distances are calculated blockwise for each offset of the search neighborhood
+     * with separable box sums of the squared differences instead of comparing each pair of patches voxel by voxel.
+     * The weights are accumulated in the same order as in the voxelwise algorithm, so both yield the same result,
+     * except if joint information and Rician adaption are both used: there the voxelwise algorithm stores two
+     * values per weight and thus pairs weights and values incorrectly, while the fast algorithm stores one.
+     * Default is false.
+     */
+    itkSetMacro(UseFastAlgorithm, bool)
+    itkGetMacro(UseFastAlgorithm, bool)
     /**
      * @brief Get the amount of calculated Voxels
      *
@@ -124,6 +138,20 @@ namespace itk{
      */
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType) override;
 
+    /**
+     * @brief Blockwise denoising procedure, used if UseFastAlgorithm is set
+     *
+     * The region is processed in slabs of z-planes. For each offset of the search neighborhood the squared differences
+     * of the slab and its shifted copy are summed over the comparison neighborhood with separable box sums. A first
+     * sweep over all offsets accumulates the sums of the weights, a second one the normalized weighted voxel values.
+     */
+    void ThreadedGenerateDataFast( const OutputImageRegionType &outputRegionForThread);
+
+    /**
+     * @brief Replaces each value by the sum of the values in a window of size 2 * radius + 1 along one axis
+     */
+    static void BoxSum(std::vector<double>& data, int numComponents, const int* size, int radius, int axis);
+
 
 
   private:
@@ -132,6 +160,7 @@ namespace itk{
     int m_ComparisonRadius;                           ///< Radius of the comparisonblock.
     bool m_UseJointInformation;                       ///< Flag to use joint information.
     bool m_UseRicianAdaption;                         ///< Flag to use rician adaption.
+    bool m_UseFastAlgorithm;                          ///< Flag to use the blockwise algorithm.
     unsigned int m_CurrentVoxelCount;                 ///< Amount of processed voxels.
     double m_Variance;                                ///< Estimated noise variance.
     typename MaskImageType::Pointer m_Mask;           ///< Pointer to the mask image.
@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImageRegionIterator.h"
 #include "itkNeighborhoodIterator.h"
 #include <itkImageRegionIteratorWithIndex.h>
+#include <algorithm>
 #include <vector>
 
 namespace itk {
@@ -39,6 +40,7 @@ NonLocalMeansDenoisingFilter< TPixelType >
     m_ComparisonRadius(1),
     m_UseJointInformation(false),
     m_UseRicianAdaption(false),
+    m_UseFastAlgorithm(false),
     m_Variance(1),
     m_Mask(nullptr)
 {
@@ -56,6 +58,7 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "Noisevariance: " << m_Variance;
   MITK_INFO << "Use Rician Adaption: " << std::boolalpha << m_UseRicianAdaption;
   MITK_INFO << "Use Joint Information: " << std::boolalpha << m_UseJointInformation;
+  MITK_INFO << "Use Fast Algorithm: " << std::boolalpha << m_UseFastAlgorithm;
 
 
   typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
@@ -127,7 +130,11 @@ void
 NonLocalMeansDenoisingFilter< TPixelType >
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType )
 {
-
+  if (m_UseFastAlgorithm)
+  {
+    this->ThreadedGenerateDataFast(outputRegionForThread);
+    return;
+  }
 
   // initialize iterators
   typename OutputImageType::Pointer outputImage =
@@ -372,6 +379,304 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "One Thread finished calculation";
 }
 
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::BoxSum(std::vector<double>& data, int numComponents, const int* size, int radius, int axis)
+{
+  const std::size_t strides[3] = { (std::size_t)numComponents,
+                                   (std::size_t)numComponents * size[0],
+                                   (std::size_t)numComponents * size[0] * size[1] };
+  const int axis1 = (axis + 1) % 3;
+  const int axis2 = (axis + 2) % 3;
+  const int length = size[axis];
+
+  std::vector<double> line(length * numComponents);
+  std::vector<double> sum(numComponents);
+
+  for (int a = 0; a < size[axis1]; ++a)
+  {
+    for (int b = 0; b < size[axis2]; ++b)
+    {
+      double* start = data.data() + a * strides[axis1] + b * strides[axis2];
+      for (int k = 0; k < length; ++k)
+      {
+        std::copy(start + k * strides[axis], start + k * strides[axis] + numComponents, line.begin() + k * numComponents);
+      }
+
+      // running sums, exact as long as the values are integers
+      std::fill(sum.begin(), sum.end(), 0.0);
+      for (int k = 0; k < radius && k < length; ++k)
+      {
+        for (int c = 0; c < numComponents; ++c)
+        {
+          sum[c] += line[k * numComponents + c];
+        }
+      }
+      for (int k = 0; k < length; ++k)
+      {
+        if (k + radius < length)
+        {
+          for (int c = 0; c < numComponents; ++c)
+          {
+            sum[c] += line[(k + radius) * numComponents + c];
+          }
+        }
+        if (k - radius - 1 >= 0)
+        {
+          for (int c = 0; c < numComponents; ++c)
+          {
+            sum[c] -= line[(k - radius - 1) * numComponents + c];
+          }
+        }
+        std::copy(sum.begin(), sum.end(), start + k * strides[axis]);
+      }
+    }
+  }
+}
+
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::ThreadedGenerateDataFast(const OutputImageRegionType& outputRegionForThread)
+{
+  typename OutputImageType::Pointer outputImage =
+          static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+
+  // like the voxelwise algorithm, the complete image has to be available
+  const TPixelType* input = inputImagePointer->GetBufferPointer();
+  const typename InputImageType::RegionType imageRegion = inputImagePointer->GetLargestPossibleRegion();
+  const int vectorLength = inputImagePointer->GetVectorLength();
+  const int numWeights = m_UseJointInformation ? 1 : vectorLength;
+
+  // all coordinates are relative to the start of the image
+  int imageSize[3];
+  int regionBegin[3];
+  int regionEnd[3];
+  for (int d = 0; d < 3; ++d)
+  {
+    imageSize[d] = imageRegion.GetSize(d);
+    regionBegin[d] = outputRegionForThread.GetIndex(d) - imageRegion.GetIndex(d);
+    regionEnd[d] = regionBegin[d] + outputRegionForThread.GetSize(d);
+  }
+
+  // the slabs are chosen so that the patch distances of one slab need about 64 MB
+  const std::size_t planeSize = (std::size_t)(std::min(imageSize[0], regionEnd[0] + m_ComparisonRadius) - std::max(0, regionBegin[0] - m_ComparisonRadius)) *
+                                (std::min(imageSize[1], regionEnd[1] + m_ComparisonRadius) - std::max(0, regionBegin[1] - m_ComparisonRadius));
+  const int slabDepth = std::max(1, (int)((std::size_t)(64 * 1024 * 1024) / (planeSize * numWeights * sizeof(double))) - 2 * m_ComparisonRadius);
+
+  for (int slabBegin = regionBegin[2]; slabBegin < regionEnd[2]; slabBegin += slabDepth)
+  {
+    // the slab and the slab extended by the comparison radius
+    int begin[3] = { regionBegin[0], regionBegin[1], slabBegin };
+    int end[3] = { regionEnd[0], regionEnd[1], std::min(regionEnd[2], slabBegin + slabDepth) };
+    int size[3];
+    int extendedBegin[3];
+    int extendedSize[3];
+    for (int d = 0; d < 3; ++d)
+    {
+      size[d] = end[d] - begin[d];
+      extendedBegin[d] = std::max(0, begin[d] - m_ComparisonRadius);
+      extendedSize[d] = std::min(imageSize[d], end[d] + m_ComparisonRadius) - extendedBegin[d];
+    }
+    const std::size_t numVoxels = (std::size_t)size[0] * size[1] * size[2];
+    const std::size_t numExtendedVoxels = (std::size_t)extendedSize[0] * extendedSize[1] * extendedSize[2];
+
+    typename OutputImageType::RegionType slabRegion;
+    for (int d = 0; d < 3; ++d)
+    {
+      slabRegion.SetIndex(d, begin[d] + imageRegion.GetIndex(d));
+      slabRegion.SetSize(d, size[d]);
+    }
+
+    std::vector<char> masked(numVoxels);
+    ImageRegionIterator< MaskImageType > mit(m_Mask, slabRegion);
+    for (std::size_t n = 0; !mit.IsAtEnd(); ++mit, ++n)
+    {
+      masked[n] = mit.Get() != 0;
+    }
+
+    std::vector<double> distances(numExtendedVoxels * numWeights);
+    std::vector<double> counts(numExtendedVoxels);
+    std::vector<double> weightSums(numVoxels * numWeights, 0.0);
+    std::vector<double> values(numVoxels * vectorLength, 0.0);
+
+    bool aborted = false;
+    for (int pass = 0; pass < 2 && !aborted; ++pass)
+    {
+      // same order of the search offsets as in the voxelwise algorithm
+      for (int dx = -m_SearchRadius; dx <= m_SearchRadius && !aborted; ++dx)
+      {
+        for (int dy = -m_SearchRadius; dy <= m_SearchRadius && !aborted; ++dy)
+        {
+          for (int dz = -m_SearchRadius; dz <= m_SearchRadius; ++dz)
+          {
+            if (this->GetAbortGenerateData())
+            {
+              aborted = true;
+              break;
+            }
+
+            // squared differences between the extended slab and the shifted image
+            std::size_t e = 0;
+            for (int z = extendedBegin[2]; z < extendedBegin[2] + extendedSize[2]; ++z)
+            {
+              for (int y = extendedBegin[1]; y < extendedBegin[1] + extendedSize[1]; ++y)
+              {
+                for (int x = extendedBegin[0]; x < extendedBegin[0] + extendedSize[0]; ++x, ++e)
+                {
+                  double* distance = distances.data() + e * numWeights;
+                  const int xj = x + dx;
+                  const int yj = y + dy;
+                  const int zj = z + dz;
+                  if (xj < 0 || yj < 0 || zj < 0 || xj >= imageSize[0] || yj >= imageSize[1] || zj >= imageSize[2])
+                  {
+                    counts[e] = 0;
+                    std::fill(distance, distance + numWeights, 0.0);
+                    continue;
+                  }
+
+                  const TPixelType* pixelI = input + (((std::size_t)z * imageSize[1] + y) * imageSize[0] + x) * vectorLength;
+                  const TPixelType* pixelJ = input + (((std::size_t)zj * imageSize[1] + yj) * imageSize[0] + xj) * vectorLength;
+                  counts[e] = 1;
+                  if (m_UseJointInformation)
+                  {
+                    double sum = 0;
+                    for (int i = 0; i < vectorLength; ++i)
+                    {
+                      const double diff = static_cast<TPixelType>(pixelI[i] - pixelJ[i]);
+                      sum += diff * diff;
+                    }
+                    distance[0] = sum;
+                  }
+                  else
+                  {
+                    for (int i = 0; i < vectorLength; ++i)
+                    {
+                      const int diff = pixelI[i] - pixelJ[i];
+                      distance[i] = (double)(diff * diff);
+                    }
+                  }
+                }
+              }
+            }
+
+            // sums over the comparison neighborhoods
+            for (int axis = 0; axis < 3; ++axis)
+            {
+              BoxSum(distances, numWeights, extendedSize, m_ComparisonRadius, axis);
+              BoxSum(counts, 1, extendedSize, m_ComparisonRadius, axis);
+            }
+
+            std::size_t n = 0;
+            for (int z = begin[2]; z < end[2]; ++z)
+            {
+              for (int y = begin[1]; y < end[1]; ++y)
+              {
+                for (int x = begin[0]; x < end[0]; ++x, ++n)
+                {
+                  const int xj = x + dx;
+                  const int yj = y + dy;
+                  const int zj = z + dz;
+                  if (!masked[n] || xj < 0 || yj < 0 || zj < 0 || xj >= imageSize[0] || yj >= imageSize[1] || zj >= imageSize[2])
+                  {
+                    continue;
+                  }
+
+                  e = ((std::size_t)(z - extendedBegin[2]) * extendedSize[1] + (y - extendedBegin[1])) * extendedSize[0] + (x - extendedBegin[0]);
+                  const double* distance = distances.data() + e * numWeights;
+                  double* weightSum = weightSums.data() + n * numWeights;
+                  double patchSize = counts[e];
+
+                  if (m_UseJointInformation)
+                  {
+                    patchSize *= vectorLength + 1;
+                    const double w = std::exp( - (distance[0] / patchSize) / m_Variance);
+                    if (pass == 0)
+                    {
+                      weightSum[0] += w;
+                      continue;
+                    }
+
+                    const TPixelType* pixelJ = input + (((std::size_t)zj * imageSize[1] + yj) * imageSize[0] + xj) * vectorLength;
+                    double* value = values.data() + n * vectorLength;
+                    const double normalizedWeight = w / weightSum[0];
+                    for (int i = 0; i < vectorLength; ++i)
+                    {
+                      const double p = m_UseRicianAdaption ? (double)(pixelJ[i] * pixelJ[i]) : (double)pixelJ[i];
+                      value[i] += normalizedWeight * p;
+                    }
+                  }
+                  else if (pass == 0)
+                  {
+                    for (int i = 0; i < vectorLength; ++i)
+                    {
+                      weightSum[i] += std::exp( - distance[i] / patchSize / m_Variance);
+                    }
+                  }
+                  else
+                  {
+                    const TPixelType* pixelJ = input + (((std::size_t)zj * imageSize[1] + yj) * imageSize[0] + xj) * vectorLength;
+                    double* value = values.data() + n * vectorLength;
+                    for (int i = 0; i < vectorLength; ++i)
+                    {
+                      const double w = std::exp( - distance[i] / patchSize / m_Variance);
+                      const double p = m_UseRicianAdaption ? (double)(pixelJ[i] * pixelJ[i]) : (double)pixelJ[i];
+                      value[i] += (w / weightSum[i]) * p;
+                    }
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+
+    ImageRegionIterator< OutputImageType > oit(outputImage, slabRegion);
+    typename OutputImageType::PixelType outpix;
+    outpix.SetSize(vectorLength);
+    for (std::size_t n = 0; !oit.IsAtEnd(); ++oit, ++n)
+    {
+      if (!masked[n] || aborted)
+      {
+        outpix.Fill(0);
+      }
+      else
+      {
+        for (int i = 0; i < vectorLength; ++i)
+        {
+          double a = values[n * vectorLength + i];
+          if (m_UseRicianAdaption)
+          {
+            a -= 2 * m_Variance;
+          }
+          if (a < 0)
+          {
+            a = 0;
+          }
+          TPixelType outval;
+          if (m_UseRicianAdaption)
+          {
+            outval = std::floor(std::sqrt(a) + 0.5);
+          }
+          else
+          {
+            outval = std::floor(a + 0.5);
+          }
+          outpix.SetElement(i, outval);
+        }
+      }
+      oit.Set(outpix);
+    }
+
+    m_CurrentVoxelCount += static_cast<unsigned int>(numVoxels);
+  }
+
+  MITK_INFO << "One Thread finished calculation";
+}
+
 template< class TPixelType >
 void NonLocalMeansDenoisingFilter< TPixelType >::SetInputImage(const InputImageType* image)
 {
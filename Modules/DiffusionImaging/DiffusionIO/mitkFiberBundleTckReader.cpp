@@ -32,8 +32,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTrackvis.h>
 #include <mitkCustomMimeType.h>
 #include "mitkDiffusionIOMimeTypes.h"
-#include <vtkTransformPolyDataFilter.h>
+#include <mitkMemoryMappedFile.h>
+#include <vtkIdTypeArray.h>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cstring>
 
 
 mitk::FiberBundleTckReader::FiberBundleTckReader()
@@ -70,19 +73,17 @@ std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleTckReader::Read
     if (ext==".tck")
     {
       MITK_INFO << "Loading tractogram (MRtrix format): " << itksys::SystemTools::GetFilenameName(filename);
-      std::FILE* filePointer = std::fopen(filename.c_str(),"r+b");
-      std::string header = "";
 
-      bool header_end = false;
-      int count = 0;
-      while (!header_end)
-      {
-        char c;
-        count += std::fread(&c, 1, 1, filePointer);
-        header += c;
-        if (header.size() >= 3 && header.compare(header.size() - 3, 3, "END") == 0)
-          header_end = true;
-      }
+      // the mapped file is parsed in one pass into arrays that are large enough for the complete file
+      MemoryMappedFile file;
+      file.Open(filename);
+      const char* data = file.GetData();
+      const std::size_t size = file.GetSize();
+
+      const char* header_end = std::search(data, data + size, "END", "END" + 3);
+      if (header_end == data + size)
+        mitkThrow() << "Could not find end of header in " << filename;
+      std::string header(data, header_end + 3);
       MITK_INFO << "TCK Header:";
       MITK_INFO << header;
 
@@ -103,52 +104,64 @@ std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleTckReader::Read
 
       if (header_size==-1)
         mitkThrow() << "Could not parse header size from " << filename;
-      std::fseek ( filePointer , header_size , SEEK_SET );
 
-      vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-      vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-      vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+      // each triplet is either a point or a fiber delimiter, so it adds at most one value to each array
+      const vtkIdType numTriplets = size > static_cast<std::size_t>(header_size) ? (size - header_size) / 12 : 0;
+
+      vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+      coordinates->SetNumberOfComponents(3);
+      coordinates->SetNumberOfTuples(numTriplets);
+      vtkSmartPointer<vtkIdTypeArray> lines = vtkSmartPointer<vtkIdTypeArray>::New();
+      lines->SetNumberOfValues(numTriplets);
+
+      float* points = coordinates->GetPointer(0);
+      vtkIdType* ids = lines->GetPointer(0);
+      vtkIdType numPoints = 0;
+      vtkIdType numFibers = 0;
+      vtkIdType numIds = 0;
+      vtkIdType fiber_start = 0;
 
       float tmp[3];
-      count = 1;
-      int fiber_length = 0;
-      while (std::fread((char*)tmp, 1, 12, filePointer)==12)
+      const char* triplet = data + header_size;
+      for (vtkIdType i=0; i<numTriplets; ++i, triplet += 12)
       {
-        if (std::isinf(tmp[0]) || std::isinf(tmp[1]) || std::isinf(tmp[1]))
+        std::memcpy(tmp, triplet, 12);
+        if (std::isinf(tmp[0]) || std::isinf(tmp[1]) || std::isinf(tmp[2]))
           break;
         else if (std::isnan(tmp[0]) || std::isnan(tmp[1]) || std::isnan(tmp[2]))
         {
-          count++;
-          fiber_length = 0;
-          vtkNewCells->InsertNextCell(container);
-          container = vtkSmartPointer<vtkPolyLine>::New();
+          // the fiber's points are already in place, only the number of points is missing
+          const vtkIdType fiber_length = numPoints - fiber_start;
+          ids[numIds] = fiber_length;
+          for (vtkIdType j=0; j<fiber_length; ++j)
+            ids[numIds + 1 + j] = fiber_start + j;
+          numIds += fiber_length + 1;
+          fiber_start = numPoints;
+          ++numFibers;
         }
         else
         {
-          fiber_length++;
-          vtkIdType id = vtkNewPoints->InsertNextPoint(tmp);
-          container->GetPointIds()->InsertNextId(id);
+          // transform from RAS (MRtrix) to LPS (MITK)
+          points[3*numPoints] = -tmp[0];
+          points[3*numPoints+1] = -tmp[1];
+          points[3*numPoints+2] = tmp[2];
+          ++numPoints;
         }
       }
 
+      coordinates->SetNumberOfTuples(numPoints);
+      lines->SetNumberOfValues(numIds);
+
+      vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+      vtkNewPoints->SetData(coordinates);
+      vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+      vtkNewCells->SetCells(numFibers, lines);
+
       vtkSmartPointer<vtkPolyData> fiberPolyData = vtkSmartPointer<vtkPolyData>::New();
       fiberPolyData->SetPoints(vtkNewPoints);
       fiberPolyData->SetLines(vtkNewCells);
 
-      // transform polydata from RAS (MRtrix) to LPS (MITK)
-      mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
-      vtkSmartPointer< vtkMatrix4x4 > matrix = vtkSmartPointer< vtkMatrix4x4 >::New();
-      matrix->Identity();
-      matrix->SetElement(0,0,-matrix->GetElement(0,0));
-      matrix->SetElement(1,1,-matrix->GetElement(1,1));
-      geometry->SetIndexToWorldTransformByVtkMatrix(matrix);
-
-      vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-      transformFilter->SetInputData(fiberPolyData);
-      transformFilter->SetTransform(geometry->GetVtkTransform());
-      transformFilter->Update();
-
-      FiberBundle::Pointer fib = FiberBundle::New(transformFilter->GetOutput());
+      FiberBundle::Pointer fib = FiberBundle::New(fiberPolyData);
       result.push_back(fib.GetPointer());
     }
 
@@ -37,11 +37,24 @@ public:
 
   virtual float CalculateDistance(vnl_matrix<float>& s, vnl_matrix<float>& t, bool &flipped) = 0;
 
+  /** Returns a factor c so that CalculateDistance(s, t) >= c * |m_s - m_t| where m_s and m_t are the mean points of the two tracts.
+   *  Metrics without such a lower bound return 0. The clustering uses the bound to skip far away clusters. */
+  virtual float GetMeanPointDistanceFactor() const { return 0; }
+
   float GetScale() const;
   void SetScale(float Scale);
 
 protected:
 
+  /** Euclidean distance between column i of s and column j of t without creating temporary vectors */
+  static float PointDistance(const vnl_matrix<float>& s, unsigned int i, const vnl_matrix<float>& t, unsigned int j)
+  {
+    float dx = s(0,i)-t(0,j);
+    float dy = s(1,i)-t(1,j);
+    float dz = s(2,i)-t(2,j);
+    return std::sqrt(dx*dx + dy*dy + dz*dz);
+  }
+
   float m_Scale;
 
 };
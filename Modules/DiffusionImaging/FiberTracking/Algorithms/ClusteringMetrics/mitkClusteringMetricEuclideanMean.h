@@ -40,8 +40,8 @@ public:
 
     for (unsigned int i=0; i<s.cols(); ++i)
     {
-      d_direct += (s.get_column(i)-t.get_column(i)).magnitude();
-      d_flipped += (s.get_column(i)-t.get_column(s.cols()-i-1)).magnitude();
+      d_direct += PointDistance(s, i, t, i);
+      d_flipped += PointDistance(s, i, t, s.cols()-i-1);
     }
 
     if (d_direct>d_flipped)
@@ -53,6 +53,12 @@ public:
     return m_Scale*d_direct/s.cols();
   }
 
+  /** The mean point distance is not larger than the mean distance of the corresponding points */
+  float GetMeanPointDistanceFactor() const override
+  {
+    return m_Scale;
+  }
+
 protected:
 
 };
@@ -43,10 +43,10 @@ public:
 
     for (unsigned int i=0; i<s.cols(); ++i)
     {
-      dists_d[i] = (s.get_column(i)-t.get_column(i)).magnitude();
+      dists_d[i] = PointDistance(s, i, t, i);
       d_direct += dists_d[i];
 
-      dists_f[i] = (s.get_column(i)-t.get_column(s.cols()-i-1)).magnitude();
+      dists_f[i] = PointDistance(s, i, t, s.cols()-i-1);
       d_flipped += dists_f[i];
     }
 
@@ -68,6 +68,12 @@ public:
     return m_Scale*d/2;
   }
 
+  /** The mean point distance is not larger than the mean distance of the corresponding points, which is at least half of the returned distance */
+  float GetMeanPointDistanceFactor() const override
+  {
+    return m_Scale/2;
+  }
+
 protected:
 
 };
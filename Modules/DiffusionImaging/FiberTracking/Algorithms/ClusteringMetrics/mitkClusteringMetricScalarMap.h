@@ -38,7 +38,6 @@ public:
 
   ClusteringMetricScalarMap()
   {
-    m_Interpolator = itk::LinearInterpolateImageFunction< ItkFloatImgType, float >::New();
     this->m_Scale = 30;
   }
   virtual ~ClusteringMetricScalarMap(){}
@@ -106,25 +105,29 @@ public:
   vnl_vector<float> GetImageValuesAtPoint(itk::Point<float, 3>& itkP)
   {
     vnl_vector<float> vals; vals.set_size(m_ScalarMaps.size());
-    int c = 0;
-    for (auto map : m_ScalarMaps)
-    {
-      m_Interpolator->SetInputImage(map);
-      vals[c] = mitk::imv::GetImageValue<float>(itkP, true, m_Interpolator);
-      ++c;
-    }
+    for (unsigned int c=0; c<m_Interpolators.size(); ++c)
+      vals[c] = mitk::imv::GetImageValue<float>(itkP, true, m_Interpolators.at(c));
     return vals;
   }
 
   void SetImages(const std::vector<ItkFloatImgType::Pointer> &Parcellations)
   {
     m_ScalarMaps = Parcellations;
+
+    // one interpolator per map, so that distances can be calculated in parallel
+    m_Interpolators.clear();
+    for (auto map : m_ScalarMaps)
+    {
+      itk::LinearInterpolateImageFunction< ItkFloatImgType, float >::Pointer interpolator = itk::LinearInterpolateImageFunction< ItkFloatImgType, float >::New();
+      interpolator->SetInputImage(map);
+      m_Interpolators.push_back(interpolator);
+    }
   }
 
 protected:
 
   std::vector< ItkFloatImgType::Pointer > m_ScalarMaps;
-  itk::LinearInterpolateImageFunction< ItkFloatImgType, float >::Pointer   m_Interpolator;
+  std::vector< itk::LinearInterpolateImageFunction< ItkFloatImgType, float >::Pointer >   m_Interpolators;
 };
 
 }
@@ -0,0 +1,143 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __itkFitFibersSparseMatrix_h__
+#define __itkFitFibersSparseMatrix_h__
+
+#include <vnl/vnl_sparse_matrix.h>
+#include <vnl/vnl_vector.h>
+#include <vector>
+
+/**
+* \brief System matrix of the fiber fit (rows: residuals, columns: unknown weights) in compressed sparse column format.
+*
+* The values are stored in double precision like in vnl_sparse_matrix, and the products sum up the entries of a row
+* resp. column in the same order as vnl_sparse_matrix_linear_system. Single precision values would halve the memory
+* traffic, but they change the optimization path and with it which weights end up exactly at zero. Additionally to
+* the columns, the matrix keeps a compressed copy of its rows. Both products A*x and A^T*y are therefore computed in
+* parallel (OpenMP) without write conflicts: each row resp. column is processed by exactly one thread.
+*/
+class FitFibersSparseMatrix
+{
+public:
+
+  FitFibersSparseMatrix() : m_Rows(0), m_Cols(0) {}
+
+  void SetMatrix(vnl_sparse_matrix< double >& A)
+  {
+    m_Rows = A.rows();
+    m_Cols = A.cols();
+
+    // compressed rows, vnl stores the entries of each row sorted by column
+    m_RowStart.assign(m_Rows+1, 0);
+    for (unsigned int r=0; r<m_Rows; ++r)
+      m_RowStart[r+1] = m_RowStart[r] + A.get_row(r).size();
+    m_RowColumns.resize(m_RowStart[m_Rows]);
+    m_RowValues.resize(m_RowStart[m_Rows]);
+
+    std::vector< std::size_t > column_sizes(m_Cols, 0);
+    for (unsigned int r=0; r<m_Rows; ++r)
+    {
+      std::size_t i = m_RowStart[r];
+      for (const auto& entry : A.get_row(r))
+      {
+        m_RowColumns[i] = entry.first;
+        m_RowValues[i] = entry.second;
+        ++column_sizes[entry.first];
+        ++i;
+      }
+    }
+
+    // compressed columns, the row indices of each column are sorted since the rows are visited in order
+    m_ColumnStart.assign(m_Cols+1, 0);
+    for (unsigned int c=0; c<m_Cols; ++c)
+      m_ColumnStart[c+1] = m_ColumnStart[c] + column_sizes[c];
+    m_ColumnRows.resize(m_ColumnStart[m_Cols]);
+    m_ColumnValues.resize(m_ColumnStart[m_Cols]);
+
+    std::vector< std::size_t > next(m_ColumnStart.begin(), m_ColumnStart.end()-1);
+    for (unsigned int r=0; r<m_Rows; ++r)
+    {
+      for (std::size_t i=m_RowStart[r]; i<m_RowStart[r+1]; ++i)
+      {
+        std::size_t j = next[m_RowColumns[i]]++;
+        m_ColumnRows[j] = r;
+        m_ColumnValues[j] = m_RowValues[i];
+      }
+    }
+  }
+
+  unsigned int rows() const { return m_Rows; }
+  unsigned int cols() const { return m_Cols; }
+
+  /** y = A*x */
+  void Multiply(const vnl_vector< double >& x, vnl_vector< double >& y) const
+  {
+    y.set_size(m_Rows);
+#pragma omp parallel for
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      double sum = 0;
+      for (std::size_t i=m_RowStart[r]; i<m_RowStart[r+1]; ++i)
+        sum += m_RowValues[i] * x[m_RowColumns[i]];
+      y[r] = sum;
+    }
+  }
+
+  /** x = A^T*y */
+  void TransposeMultiply(const vnl_vector< double >& y, vnl_vector< double >& x) const
+  {
+    x.set_size(m_Cols);
+#pragma omp parallel for
+    for (int c=0; c<static_cast<int>(m_Cols); ++c)
+    {
+      double sum = 0;
+      for (std::size_t i=m_ColumnStart[c]; i<m_ColumnStart[c+1]; ++i)
+        sum += m_ColumnValues[i] * y[m_ColumnRows[i]];
+      x[c] = sum;
+    }
+  }
+
+  /** Root mean square of A*x-b */
+  double GetRmsError(const vnl_vector< double >& x, const vnl_vector< double >& b) const
+  {
+    vnl_vector< double > d;
+    Multiply(x, d);
+    d -= b;
+    return d.rms();
+  }
+
+  // Structure of the non-zero entries. Used by the regularizations that only depend on which weights contribute to a residual.
+  const std::vector< std::size_t >& GetRowStart() const { return m_RowStart; }
+  const std::vector< unsigned int >& GetRowColumns() const { return m_RowColumns; }
+  const std::vector< std::size_t >& GetColumnStart() const { return m_ColumnStart; }
+  const std::vector< unsigned int >& GetColumnRows() const { return m_ColumnRows; }
+
+private:
+
+  unsigned int                m_Rows;
+  unsigned int                m_Cols;
+
+  std::vector< std::size_t >  m_ColumnStart;
+  std::vector< unsigned int > m_ColumnRows;
+  std::vector< double >       m_ColumnValues;
+
+  std::vector< std::size_t >  m_RowStart;
+  std::vector< unsigned int > m_RowColumns;
+  std::vector< double >       m_RowValues;
+};
+
+#endif // __itkFitFibersSparseMatrix_h__
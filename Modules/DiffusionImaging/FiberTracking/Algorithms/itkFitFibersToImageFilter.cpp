@@ -1,6 +1,7 @@
 #include "itkFitFibersToImageFilter.h"
 
 #include <boost/progress.hpp>
+#include <deque>
 
 namespace itk{
 
@@ -36,6 +37,11 @@ FitFibersToImageFilter::FitFibersToImageFilter()
   , m_MeanSignal(0)
   , fiber_count(0)
   , m_Regularization(VnlCostFunction::REGU::VOXEL_VARIANCE)
+  , m_Solver(LBFGSB)
+  , m_NumIterations(0)
+  , m_NumEvaluations(0)
+  , m_ResidualCost(0)
+  , m_OptimizationTime(0)
 {
   this->SetNumberOfRequiredOutputs(3);
 }
@@ -459,12 +465,11 @@ void FitFibersToImageFilter::GenerateData()
   cost.SetGroupSizes(m_GroupSizes);
   m_Weights.set_size(m_NumUnknowns);
   m_Weights.fill( 1.0/m_NumUnknowns );
-  vnl_lbfgsb minimizer(cost);
-  vnl_vector<double> l; l.set_size(m_NumUnknowns); l.fill(0);
-  vnl_vector<long> bound_selection; bound_selection.set_size(m_NumUnknowns); bound_selection.fill(1);
-  minimizer.set_bound_selection(bound_selection);
-  minimizer.set_lower_bound(l);
-  minimizer.set_projected_gradient_tolerance(m_GradientTolerance);
+
+  if (m_Solver==PROJECTED_GRADIENT)
+    MITK_INFO << "Solver: PROJECTED_GRADIENT";
+  else
+    MITK_INFO << "Solver: LBFGSB";
 
   if (m_Regularization==VnlCostFunction::REGU::MSM)
     MITK_INFO << "Regularization type: MSM";
@@ -484,9 +489,7 @@ void FitFibersToImageFilter::GenerateData()
   if (m_Regularization!=VnlCostFunction::REGU::NONE)  // REMOVE FOR NEW FIT AND SET cost.m_Lambda = m_Lambda
   {
     MITK_INFO << "Estimating regularization";
-    minimizer.set_trace(false);
-    minimizer.set_max_function_evals(2);
-    minimizer.minimize(m_Weights);
+    Minimize(m_Weights, 2, false, -1);
     vnl_vector<double> dx; dx.set_size(m_NumUnknowns); dx.fill(0.0);
     cost.calc_regularization_gradient(m_Weights, dx);
 
@@ -512,10 +515,7 @@ void FitFibersToImageFilter::GenerateData()
   MITK_INFO << "Using regularization factor of " << cost.m_Lambda << " (λ: " << m_Lambda << ")";
 
   MITK_INFO << "Fitting fibers";
-  minimizer.set_trace(m_Verbose);
-
-  minimizer.set_max_function_evals(m_MaxIterations);
-  minimizer.minimize(m_Weights);
+  Minimize(m_Weights, m_MaxIterations, m_Verbose, -1);
 
   std::vector< double > weights;
   if (m_FilterOutliers)
@@ -524,11 +524,7 @@ void FitFibersToImageFilter::GenerateData()
       weights.push_back(w);
     std::sort(weights.begin(), weights.end());
     MITK_INFO << "Setting upper weight bound to " << weights.at(m_NumUnknowns*0.99);
-    vnl_vector<double> u; u.set_size(m_NumUnknowns); u.fill(weights.at(m_NumUnknowns*0.99));
-    minimizer.set_upper_bound(u);
-    bound_selection.fill(2);
-    minimizer.set_bound_selection(bound_selection);
-    minimizer.minimize(m_Weights);
+    Minimize(m_Weights, m_MaxIterations, m_Verbose, weights.at(m_NumUnknowns*0.99));
     weights.clear();
   }
 
@@ -555,10 +551,10 @@ void FitFibersToImageFilter::GenerateData()
   MITK_INFO << "Min: " << m_MinWeight;
   MITK_INFO << "Max: " << m_MaxWeight;
   MITK_INFO << "*************************";
-  MITK_INFO << "NumEvals: " << minimizer.get_num_evaluations();
-  MITK_INFO << "NumIterations: " << minimizer.get_num_iterations();
-  MITK_INFO << "Residual cost: " << minimizer.get_end_error();
-  m_RMSE = cost.S->get_rms_error(m_Weights);
+  MITK_INFO << "NumEvals: " << m_NumEvaluations;
+  MITK_INFO << "NumIterations: " << m_NumIterations;
+  MITK_INFO << "Residual cost: " << m_ResidualCost;
+  m_RMSE = cost.get_rms_error(m_Weights);
   MITK_INFO << "Final RMSE: " << m_RMSE;
 
   clock.Stop();
@@ -588,7 +584,7 @@ void FitFibersToImageFilter::GenerateData()
 
         ++fiber_count;
       }
-      double d_rms = cost.S->get_rms_error(temp_weights) - m_RMSE;
+      double d_rms = cost.get_rms_error(temp_weights) - m_RMSE;
       m_RmsDiffPerBundle[bundle] = d_rms;
       m_Tractograms.at(bundle)->Compress(0.1);
       m_Tractograms.at(bundle)->ColorFibersByFiberWeights(false, true);
@@ -602,7 +598,7 @@ void FitFibersToImageFilter::GenerateData()
       temp_weights.set_size(m_Weights.size());
       temp_weights.copy_in(m_Weights.data_block());
       temp_weights[i] = 0;
-      double d_rms = cost.S->get_rms_error(temp_weights) - m_RMSE;
+      double d_rms = cost.get_rms_error(temp_weights) - m_RMSE;
       m_RmsDiffPerBundle[i] = d_rms;
 
       m_Tractograms.at(i)->SetFiberWeights(m_Weights[i]);
@@ -656,7 +652,7 @@ void FitFibersToImageFilter::GenerateOutputDiffImages()
   m_FittedImageDiff->FillBuffer(pix);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.mult(m_Weights, fitted_b);
 
   itk::ImageRegionIterator<VectorImgType> it1 = itk::ImageRegionIterator<VectorImgType>(m_DiffImage, m_DiffImage->GetLargestPossibleRegion());
   itk::ImageRegionIterator<VectorImgType> it2 = itk::ImageRegionIterator<VectorImgType>(m_FittedImageDiff, m_FittedImageDiff->GetLargestPossibleRegion());
@@ -747,7 +743,7 @@ void FitFibersToImageFilter::GenerateOutputScalarImages()
   m_FittedImageScalar->FillBuffer(0);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.mult(m_Weights, fitted_b);
 
   itk::ImageRegionIterator<DoubleImgType> it1 = itk::ImageRegionIterator<DoubleImgType>(m_ScalarImage, m_ScalarImage->GetLargestPossibleRegion());
   itk::ImageRegionIterator<DoubleImgType> it2 = itk::ImageRegionIterator<DoubleImgType>(m_FittedImageScalar, m_FittedImageScalar->GetLargestPossibleRegion());
@@ -799,6 +795,122 @@ void FitFibersToImageFilter::GenerateOutputScalarImages()
   }
 }
 
+void FitFibersToImageFilter::Minimize(vnl_vector<double>& x, int max_iterations, bool verbose, double upper_bound)
+{
+  itk::TimeProbe clock;
+  clock.Start();
+
+  if (m_Solver==PROJECTED_GRADIENT)
+  {
+    MinimizeProjectedGradient(x, max_iterations, verbose, upper_bound);
+  }
+  else
+  {
+    vnl_lbfgsb minimizer(cost);
+    vnl_vector<double> l; l.set_size(m_NumUnknowns); l.fill(0);
+    vnl_vector<long> bound_selection; bound_selection.set_size(m_NumUnknowns); bound_selection.fill(1);
+    if (upper_bound>=0)
+    {
+      vnl_vector<double> u; u.set_size(m_NumUnknowns); u.fill(upper_bound);
+      minimizer.set_upper_bound(u);
+      bound_selection.fill(2);
+    }
+    minimizer.set_bound_selection(bound_selection);
+    minimizer.set_lower_bound(l);
+    minimizer.set_projected_gradient_tolerance(m_GradientTolerance);
+    minimizer.set_trace(verbose);
+    minimizer.set_max_function_evals(max_iterations);
+    minimizer.minimize(x);
+
+    m_NumIterations = minimizer.get_num_iterations();
+    m_NumEvaluations = minimizer.get_num_evaluations();
+    m_ResidualCost = minimizer.get_end_error();
+  }
+
+  clock.Stop();
+  m_OptimizationTime = clock.GetTotal();
+}
+
+void FitFibersToImageFilter::MinimizeProjectedGradient(vnl_vector<double>& x, int max_iterations, bool verbose, double upper_bound)
+{
+  // Spectral projected gradient method (Birgin, Martinez and Raydan, 2000): projected gradient steps
+  // with Barzilai-Borwein step length and a non-monotone Armijo line search.
+  const unsigned int history_length = 10;
+  const double armijo = 1e-4;
+
+  auto project = [upper_bound](vnl_vector<double>& v)
+  {
+    for (auto& e : v)
+    {
+      if (e<0)
+        e = 0;
+      else if (upper_bound>=0 && e>upper_bound)
+        e = upper_bound;
+    }
+  };
+  auto projected_gradient = [&project](const vnl_vector<double>& x, const vnl_vector<double>& g)
+  {
+    vnl_vector<double> pg = x - g;
+    project(pg);
+    return pg - x;
+  };
+
+  project(x);
+  double f = 0;
+  vnl_vector<double> g;
+  cost.compute(x, &f, &g);
+  unsigned int evaluations = 1;
+  std::deque<double> history(1, f);
+
+  vnl_vector<double> pg = projected_gradient(x, g);
+  double alpha = pg.inf_norm()>0 ? 1.0/pg.inf_norm() : 1.0;
+
+  int iteration = 0;
+  for (; iteration<max_iterations && pg.inf_norm()>m_GradientTolerance; ++iteration)
+  {
+    vnl_vector<double> d = x - alpha*g;
+    project(d);
+    d -= x;
+    const double gd = dot_product(g, d);
+    if (gd>=0)
+      break;
+    const double f_max = *std::max_element(history.begin(), history.end());
+
+    double step = 1.0;
+    double f_new = 0;
+    vnl_vector<double> x_new;
+    vnl_vector<double> g_new;
+    while (true)
+    {
+      x_new = x + step*d;
+      cost.compute(x_new, &f_new, &g_new);
+      ++evaluations;
+      if (f_new <= f_max + armijo*step*gd || step<1e-10)
+        break;
+      step *= 0.5;
+    }
+
+    const vnl_vector<double> s = x_new - x;
+    const double sy = dot_product(s, g_new - g);
+    alpha = sy>0 ? std::min(1e10, std::max(1e-10, s.squared_magnitude()/sy)) : 1e10;
+
+    x = x_new;
+    f = f_new;
+    g = g_new;
+    history.push_back(f);
+    if (history.size()>history_length)
+      history.pop_front();
+
+    pg = projected_gradient(x, g);
+    if (verbose)
+      MITK_INFO << "Iteration " << iteration+1 << ": cost " << f << ", projected gradient " << pg.inf_norm();
+  }
+
+  m_NumIterations = iteration;
+  m_NumEvaluations = evaluations;
+  m_ResidualCost = f;
+}
+
 VnlCostFunction::REGU FitFibersToImageFilter::GetRegularization() const
 {
   return m_Regularization;
@@ -833,7 +945,7 @@ void FitFibersToImageFilter::GenerateOutputPeakImages()
   m_FittedImage->FillBuffer(0.0);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.mult(m_Weights, fitted_b);
 
   for (unsigned int r=0; r<b.size(); r++)
   {
@@ -7,7 +7,7 @@
 #include <mitkPeakImage.h>
 #include <vnl/algo/vnl_lbfgsb.h>
 #include <vnl/vnl_sparse_matrix.h>
-#include <vnl/vnl_sparse_matrix_linear_system.h>
+#include <itkFitFibersSparseMatrix.h>
 #include <itkImageDuplicator.h>
 #include <itkTimeProbe.h>
 #include <itkMersenneTwisterRandomVariateGenerator.h>
@@ -29,9 +29,7 @@ public:
     NONE
   };
 
-  vnl_sparse_matrix_linear_system< double >* S;
-  vnl_sparse_matrix< double > m_A;
-  vnl_sparse_matrix< double > m_A_Ones; // matrix indicating active weights with 1
+  FitFibersSparseMatrix m_Matrix;
   vnl_vector< double > m_b;
   double m_Lambda;  // regularization factor
 
@@ -42,20 +40,15 @@ public:
 
   void SetProblem(vnl_sparse_matrix< double >& A, vnl_vector<double>& b, double lambda, REGU regu)
   {
-    S = new vnl_sparse_matrix_linear_system<double>(A, b);
-    m_A = A;
+    m_Matrix.SetMatrix(A);
     m_b = b;
     m_Lambda = lambda;
 
-    m_A_Ones.set_size(m_A.rows(), m_A.cols());
-    m_A.reset();
-    while (m_A.next())
-      m_A_Ones.put(m_A.getrow(), m_A.getcolumn(), 1);
-
     unsigned int N = m_b.size();
-    vnl_vector<double> ones; ones.set_size(dim); ones.fill(1.0);
+    const std::vector< std::size_t >& row_start = m_Matrix.GetRowStart();
     row_sums.set_size(N);
-    m_A_Ones.mult(ones, row_sums);
+    for (unsigned int r=0; r<N; ++r)
+      row_sums[r] = row_start[r+1] - row_start[r];
     local_weight_means.set_size(N);
     regularization = regu;
   }
@@ -65,14 +58,19 @@ public:
     unsigned int sum = 0;
     for (auto s : sizes)
       sum += s;
-    if (sum!=m_A.cols())
+    if (sum!=m_Matrix.cols())
     {
-      MITK_INFO << "Group sizes do not match number of unknowns (" << sum << " vs. " << m_A.cols() << ")";
+      MITK_INFO << "Group sizes do not match number of unknowns (" << sum << " vs. " << m_Matrix.cols() << ")";
       return;
     }
     group_sizes = sizes;
   }
 
+  double get_rms_error(vnl_vector<double> const &x) const
+  {
+    return m_Matrix.GetRmsError(x, m_b);
+  }
+
   VnlCostFunction(const int NumVars=0) : vnl_cost_function(NumVars)
   {
   }
@@ -118,22 +116,42 @@ public:
     cost += 10000.0*m_Lambda*tx.squared_magnitude()/dim;
   }
 
+  // mean weight of the fibers that contribute to each row
+  void calc_local_weight_means(vnl_vector<double> const &x)
+  {
+    const std::vector< std::size_t >& row_start = m_Matrix.GetRowStart();
+    const std::vector< unsigned int >& row_columns = m_Matrix.GetRowColumns();
+#pragma omp parallel for
+    for (int r=0; r<static_cast<int>(m_Matrix.rows()); ++r)
+    {
+      double sum = 0;
+      for (std::size_t i=row_start[r]; i<row_start[r+1]; ++i)
+        sum += x[row_columns[i]];
+      local_weight_means[r] = sum/row_sums[r];
+    }
+  }
+
   // Regularization: voxel-weise mean squared deaviation of weights from voxel-wise mean weight (enforce locally uniform weights)
   void regu_VoxelVariance(vnl_vector<double> const &x, double& cost)
   {
-    m_A_Ones.mult(x, local_weight_means);
-    local_weight_means = element_quotient(local_weight_means, row_sums);
+    calc_local_weight_means(x);
 
-    m_A_Ones.reset();
+    const std::vector< std::size_t >& row_start = m_Matrix.GetRowStart();
+    const std::vector< unsigned int >& row_columns = m_Matrix.GetRowColumns();
     double regu = 0;
-    while (m_A_Ones.next())
+#pragma omp parallel for reduction(+:regu)
+    for (int r=0; r<static_cast<int>(m_Matrix.rows()); ++r)
     {
-      double d = 0;
-      if (x[m_A_Ones.getcolumn()]>local_weight_means[m_A_Ones.getrow()])
-        d = std::exp(x[m_A_Ones.getcolumn()]) - std::exp(local_weight_means[m_A_Ones.getrow()]);
-      else
-        d = x[m_A_Ones.getcolumn()] - local_weight_means[m_A_Ones.getrow()];
-      regu += d*d;
+      for (std::size_t i=row_start[r]; i<row_start[r+1]; ++i)
+      {
+        unsigned int c = row_columns[i];
+        double d = 0;
+        if (x[c]>local_weight_means[r])
+          d = std::exp(x[c]) - std::exp(local_weight_means[r]);
+        else
+          d = x[c] - local_weight_means[r];
+        regu += d*d;
+      }
     }
     cost += m_Lambda*regu/dim;
   }
@@ -195,23 +213,28 @@ public:
 
   void grad_regu_VoxelVariance(vnl_vector<double> const &x, vnl_vector<double> &dx)
   {
-    m_A_Ones.mult(x, local_weight_means);
-    local_weight_means = element_quotient(local_weight_means, row_sums);
+    calc_local_weight_means(x);
 
     vnl_vector<double> exp_x = x.apply(std::exp);
     vnl_vector<double> exp_means = local_weight_means.apply(std::exp);
 
+    // each column (weight) is handled by one thread
+    const std::vector< std::size_t >& column_start = m_Matrix.GetColumnStart();
+    const std::vector< unsigned int >& column_rows = m_Matrix.GetColumnRows();
     vnl_vector<double> tdx(dim, 0);
-    m_A_Ones.reset();
-    while (m_A_Ones.next())
+#pragma omp parallel for
+    for (int c=0; c<dim; ++c)
     {
-      int c = m_A_Ones.getcolumn();
-      int r = m_A_Ones.getrow();
-
-      if (x[c]>local_weight_means[r])
-        tdx[c] += exp_x[c] * ( exp_x[c] - exp_means[r] );
-      else
-        tdx[c] += x[c] - local_weight_means[r];
+      double sum = 0;
+      for (std::size_t i=column_start[c]; i<column_start[c+1]; ++i)
+      {
+        unsigned int r = column_rows[i];
+        if (x[c]>local_weight_means[r])
+          sum += exp_x[c] * ( exp_x[c] - exp_means[r] );
+        else
+          sum += x[c] - local_weight_means[r];
+      }
+      tdx[c] = sum;
     }
     dx += tdx*2.0*m_Lambda/dim;
   }
@@ -272,35 +295,45 @@ public:
   // cost function
   double f(vnl_vector<double> const &x)
   {
-    // RMS error
-    unsigned int N = m_b.size();
-    vnl_vector<double> d; d.set_size(N);
-    S->multiply(x,d);
-    double cost = (d - m_b).squared_magnitude()/N;
-
-    // regularize
-    calc_regularization(x, cost);
-
+    double cost = 0;
+    compute(x, &cost, nullptr);
     return cost;
   }
 
   // gradient of cost function
   void gradf(vnl_vector<double> const &x, vnl_vector<double> &dx)
   {
-    dx.fill(0.0);
+    compute(x, nullptr, &dx);
+  }
+
+  // cost and gradient share the product A*x
+  void compute(vnl_vector<double> const &x, double *f, vnl_vector<double> *g) override
+  {
     unsigned int N = m_b.size();
 
     // calculate output difference d
-    vnl_vector<double> d; d.set_size(N);
-    S->multiply(x,d);
+    vnl_vector<double> d;
+    m_Matrix.Multiply(x, d);
     d -= m_b;
 
-    // (f(u(x)))' = f'(u(x)) * u'(x)
-    // d/dx_j = 1/N * Sum_i A_i,j * 2*(A_i,j * x_j - b_i)
-    S->transpose_multiply(d, dx);
-    dx *= 2.0/N;
+    if (f)
+    {
+      // RMS error
+      *f = d.squared_magnitude()/N;
+
+      // regularize
+      calc_regularization(x, *f);
+    }
 
-    calc_regularization_gradient(x,dx);
+    if (g)
+    {
+      // (f(u(x)))' = f'(u(x)) * u'(x)
+      // d/dx_j = 1/N * Sum_i A_i,j * 2*(A_i,j * x_j - b_i)
+      m_Matrix.TransposeMultiply(d, *g);
+      *g *= 2.0/N;
+
+      calc_regularization_gradient(x,*g);
+    }
   }
 };
 
@@ -327,6 +360,13 @@ public:
   typedef itk::Image<unsigned char, 3>              UcharImgType;
   typedef itk::Image<double, 3>                     DoubleImgType;
 
+  /** Optimizer used to find the non-negative fiber weights. */
+  enum SOLVER
+  {
+    LBFGSB,             ///< vnl_lbfgsb, MaxIterations limits the number of cost function evaluations
+    PROJECTED_GRADIENT  ///< spectral projected gradient (non-negative least squares), MaxIterations limits the number of iterations
+  };
+
   itkFactorylessNewMacro(Self)
   itkCloneMacro(Self)
   itkTypeMacro( FitFibersToImageFilter, ImageSource )
@@ -357,6 +397,8 @@ public:
   itkGetMacro( DeepCopy, bool)
   itkSetMacro( ResampleFibers, bool)
   itkGetMacro( ResampleFibers, bool)
+  itkSetMacro( Solver, SOLVER)
+  itkGetMacro( Solver, SOLVER)
 
   itkGetMacro( Weights, vnl_vector<double>)
   itkGetMacro( RmsDiffPerBundle, vnl_vector<double>)
@@ -386,6 +428,9 @@ public:
   itkGetMacro( NumUnknowns, unsigned int)
   itkGetMacro( NumResiduals, unsigned int)
   itkGetMacro( NumCoveredDirections, unsigned int)
+  itkGetMacro( NumIterations, unsigned int)     ///< iterations of the last optimization run
+  itkGetMacro( NumEvaluations, unsigned int)    ///< cost function evaluations of the last optimization run
+  itkGetMacro( OptimizationTime, double)        ///< duration of the last optimization run in seconds
 
   void SetTractograms(const std::vector<mitk::FiberBundle::Pointer> &tractograms);
 
@@ -409,6 +454,10 @@ protected:
   void CreateDiffSystem();
   void CreateScalarSystem();
 
+  /** Minimizes the cost function with the selected solver. The weights are bounded by 0 and upper_bound (no upper bound if negative). */
+  void Minimize(vnl_vector<double>& x, int max_iterations, bool verbose, double upper_bound);
+  void MinimizeProjectedGradient(vnl_vector<double>& x, int max_iterations, bool verbose, double upper_bound);
+
   void GenerateOutputPeakImages();
   void GenerateOutputDiffImages();
   void GenerateOutputScalarImages();
@@ -472,6 +521,12 @@ protected:
 
   VnlCostFunction::REGU                       m_Regularization;
   std::vector<unsigned int>                   m_GroupSizes;
+
+  SOLVER                                      m_Solver;
+  unsigned int                                m_NumIterations;
+  unsigned int                                m_NumEvaluations;
+  double                                      m_ResidualCost;
+  double                                      m_OptimizationTime;
 };
 
 }
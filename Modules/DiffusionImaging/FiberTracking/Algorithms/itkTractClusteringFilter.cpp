@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <algorithm>
 #include <boost/progress.hpp>
 #include <vnl/vnl_sparse_matrix.h>
 
@@ -31,6 +32,7 @@ TractClusteringFilter::TractClusteringFilter()
   , m_DoResampling(true)
   , m_FilterMask(nullptr)
   , m_OverlapThreshold(0.0)
+  , m_UseMeanPointGrid(true)
 {
 
 }
@@ -97,40 +99,125 @@ float TractClusteringFilter::CalcOverlap(vnl_matrix<float>& t)
   return overlap;
 }
 
-std::vector<vnl_matrix<float> > TractClusteringFilter::ResampleFibers(mitk::FiberBundle::Pointer tractogram)
+std::vector< float > TractClusteringFilter::ResampleFibers(mitk::FiberBundle::Pointer tractogram)
 {
   mitk::FiberBundle::Pointer temp_fib = tractogram->GetDeepCopy();
   if (m_DoResampling)
     temp_fib->ResampleToNumPoints(m_NumPoints);
 
-  std::vector< vnl_matrix<float> > out_fib;
+  int num_fibers = temp_fib->GetFiberPolyData()->GetNumberOfCells();
+  std::vector< float > out_fib(3*m_NumPoints*num_fibers, 0.0);
 
-  for (int i=0; i<temp_fib->GetFiberPolyData()->GetNumberOfCells(); i++)
+  for (int i=0; i<num_fibers; i++)
   {
     vtkCell* cell = temp_fib->GetFiberPolyData()->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
+    int numPoints = std::min(cell->GetNumberOfPoints(), (vtkIdType)m_NumPoints);
     vtkPoints* points = cell->GetPoints();
 
-    vnl_matrix<float> streamline;
-    streamline.set_size(3, m_NumPoints);
-    streamline.fill(0.0);
-
+    float* streamline = out_fib.data() + 3*m_NumPoints*i;
     for (int j=0; j<numPoints; j++)
     {
       double cand[3];
       points->GetPoint(j, cand);
 
-      vnl_vector_fixed< float, 3 > candV;
-      candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
-      streamline.set_column(j, candV);
+      streamline[j] = cand[0];
+      streamline[m_NumPoints+j] = cand[1];
+      streamline[2*m_NumPoints+j] = cand[2];
     }
-
-    out_fib.push_back(streamline);
   }
 
   return out_fib;
 }
 
+float* TractClusteringFilter::GetFiber(long index)
+{
+  return m_Fibers.data() + 3*m_NumPoints*index;
+}
+
+float TractClusteringFilter::GetMeanPointDistanceFactor() const
+{
+  // the unbounded metrics contribute non-negative distances to the mean
+  float factor = 0;
+  for (auto m : m_Metrics)
+    factor += m->GetMeanPointDistanceFactor();
+  return factor/m_Metrics.size();
+}
+
+TractClusteringFilter::MeanPointGrid::MeanPointGrid(float radius)
+  : m_Radius(radius)
+{
+
+}
+
+long long TractClusteringFilter::MeanPointGrid::GetCellKey(const float* point, int offset_x, int offset_y, int offset_z) const
+{
+  // 21 bits per cell coordinate, cells that do not fit are folded onto other cells which only adds candidates
+  const int offsets[3] = {offset_x, offset_y, offset_z};
+  long long key = 0;
+  for (int d=0; d<3; ++d)
+    key = (key << 21) | (((long long)std::floor(point[d]/m_Radius) + offsets[d]) & 0x1FFFFF);
+  return key;
+}
+
+void TractClusteringFilter::MeanPointGrid::Insert(int cluster, const float* point)
+{
+  long long key = GetCellKey(point);
+  m_Cells[key].push_back(cluster);
+  m_ClusterCells.push_back(key);
+  m_MeanPoints.insert(m_MeanPoints.end(), point, point+3);
+}
+
+void TractClusteringFilter::MeanPointGrid::Move(int cluster, const float* point)
+{
+  std::copy(point, point+3, m_MeanPoints.begin()+3*cluster);
+
+  long long key = GetCellKey(point);
+  if (key == m_ClusterCells[cluster])
+    return;
+
+  std::vector< int >& old_cell = m_Cells[m_ClusterCells[cluster]];
+  old_cell.erase(std::find(old_cell.begin(), old_cell.end(), cluster));
+  m_Cells[key].push_back(cluster);
+  m_ClusterCells[cluster] = key;
+}
+
+bool TractClusteringFilter::MeanPointGrid::IsInRange(int cluster, const float* point) const
+{
+  const float* mean_point = m_MeanPoints.data() + 3*cluster;
+  float dx = mean_point[0]-point[0];
+  float dy = mean_point[1]-point[1];
+  float dz = mean_point[2]-point[2];
+  return dx*dx + dy*dy + dz*dz <= m_Radius*m_Radius;
+}
+
+void TractClusteringFilter::MeanPointGrid::Query(const float* point, std::vector< int >& candidates) const
+{
+  candidates.clear();
+  float radius_squared = m_Radius*m_Radius;
+
+  for (int x=-1; x<=1; ++x)
+    for (int y=-1; y<=1; ++y)
+      for (int z=-1; z<=1; ++z)
+      {
+        auto cell = m_Cells.find(GetCellKey(point, x, y, z));
+        if (cell == m_Cells.end())
+          continue;
+
+        for (int c : cell->second)
+        {
+          const float* mean_point = m_MeanPoints.data() + 3*c;
+          float dx = mean_point[0]-point[0];
+          float dy = mean_point[1]-point[1];
+          float dz = mean_point[2]-point[2];
+          if (dx*dx + dy*dy + dz*dz <= radius_squared)
+            candidates.push_back(c);
+        }
+      }
+
+  // same order as a search over all clusters, so ties are resolved identically
+  std::sort(candidates.begin(), candidates.end());
+}
+
 std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep(std::vector< long > f_indices, std::vector<float> distances)
 {
   float dist_thres = distances.back();
@@ -139,68 +226,179 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep
 
   int N = f_indices.size();
 
-  Cluster c1;
-  c1.I.push_back(f_indices.at(0));
-  c1.h = T[f_indices.at(0)];
-  c1.n = 1;
-  C.push_back(c1);
+  // clusters whose mean point is farther away than the radius cannot be closer than the threshold,
+  // the radius is slightly enlarged to account for rounding errors of the metrics
+  float factor = GetMeanPointDistanceFactor();
+  bool use_grid = m_UseMeanPointGrid && factor>mitk::eps;
+  MeanPointGrid grid(use_grid ? 1.001*dist_thres/factor : 1);
+
+  std::vector< vnl_matrix<float> > centroids;  // C[k].h/C[k].n
+  std::vector< float > mean_point_sums;        // sum of the mean points of the fibers in C[k]
+
+  auto add_cluster = [&](long f)
+  {
+    vnl_matrix_ref<float> t(3, m_NumPoints, GetFiber(f));
+    Cluster c;
+    c.I.push_back(f);
+    c.h = t;
+    c.n = 1;
+    C.push_back(c);
+    centroids.push_back(t);
+
+    const float* p = m_FiberMeanPoints.data() + 3*f;
+    mean_point_sums.insert(mean_point_sums.end(), p, p+3);
+    if (use_grid)
+      grid.Insert(C.size()-1, p);
+  };
+
+  add_cluster(f_indices.at(0));
   if (f_indices.size()==1)
     return C;
 
-  for (int i=1; i<N; ++i)
+  // The fibers are assigned in batches. The distances to the clusters that exist at the start of a batch are
+  // calculated in parallel, with one candidate list per fiber. When the fibers are then assigned in order, only
+  // the clusters that were created or changed by earlier fibers of the batch are compared again, so the result
+  // is the same as if the fibers were assigned one after the other.
+  const int batch_size = 256;
+  std::vector< std::vector< int > > batch_candidates(batch_size);
+  std::vector< std::vector< float > > batch_distances(batch_size);
+  std::vector< std::vector< char > > batch_flips(batch_size);
+  std::vector< char > changed;          // 1 if C[k] was created or changed in the current batch
+  std::vector< int > changed_clusters;
+
+  for (int batch_start=1; batch_start<N; batch_start+=batch_size)
   {
-    vnl_matrix<float> t = T.at(f_indices.at(i));
-
-    int min_cluster_index = -1;
-    float min_cluster_distance = 99999;
-    bool flip = false;
+    int batch_end = std::min(N, batch_start+batch_size);
 
-    for (unsigned int k=0; k<C.size(); ++k)
+#pragma omp parallel for schedule(dynamic)
+    for (int i=batch_start; i<batch_end; ++i)
     {
-      vnl_matrix<float> v = C.at(k).h / C.at(k).n;
-      bool f = false;
-      float d = 0;
-      for (auto m : m_Metrics)
-        d += m->CalculateDistance(t, v, f);
-      d /= m_Metrics.size();
-
-      if (d<min_cluster_distance)
+      long f = f_indices.at(i);
+      vnl_matrix_ref<float> t(3, m_NumPoints, GetFiber(f));
+      std::vector< int >& candidates = batch_candidates[i-batch_start];
+      std::vector< float >& candidate_distances = batch_distances[i-batch_start];
+      std::vector< char >& candidate_flips = batch_flips[i-batch_start];
+
+      if (use_grid)
+        grid.Query(m_FiberMeanPoints.data() + 3*f, candidates);
+      else
+      {
+        candidates.resize(C.size());
+        for (unsigned int k=0; k<C.size(); ++k)
+          candidates[k] = k;
+      }
+
+      candidate_distances.resize(candidates.size());
+      candidate_flips.resize(candidates.size());
+      for (unsigned int j=0; j<candidates.size(); ++j)
       {
-        min_cluster_distance = d;
-        min_cluster_index = k;
-        flip = f;
+        bool flip = false;
+        float d = 0;
+        for (auto m : m_Metrics)
+          d += m->CalculateDistance(t, centroids[candidates[j]], flip);
+        candidate_distances[j] = d/m_Metrics.size();
+        candidate_flips[j] = flip;
       }
     }
 
-    if (min_cluster_index>=0 && min_cluster_distance<dist_thres)
+    changed.assign(C.size(), 0);
+    changed_clusters.clear();
+
+    for (int i=batch_start; i<batch_end; ++i)
     {
-      C[min_cluster_index].I.push_back(f_indices.at(i));
-      if (!flip)
-        C[min_cluster_index].h += t;
+      long f = f_indices.at(i);
+      vnl_matrix_ref<float> t(3, m_NumPoints, GetFiber(f));
+      const float* p = m_FiberMeanPoints.data() + 3*f;
+      const std::vector< int >& candidates = batch_candidates[i-batch_start];
+
+      int min_cluster_index = -1;
+      float min_cluster_distance = 99999;
+      bool flip = false;
+
+      for (unsigned int j=0; j<candidates.size(); ++j)
+      {
+        if (changed[candidates[j]])
+          continue;
+
+        if (batch_distances[i-batch_start][j]<min_cluster_distance)
+        {
+          min_cluster_distance = batch_distances[i-batch_start][j];
+          min_cluster_index = candidates[j];
+          flip = batch_flips[i-batch_start][j];
+        }
+      }
+
+      for (int k : changed_clusters)
+      {
+        if (use_grid && !grid.IsInRange(k, p))
+          continue;
+
+        bool f = false;
+        float d = 0;
+        for (auto m : m_Metrics)
+          d += m->CalculateDistance(t, centroids[k], f);
+        d /= m_Metrics.size();
+
+        // ties are resolved in favour of the lower cluster index, as in a search over all clusters
+        if (d<min_cluster_distance || (d==min_cluster_distance && k<min_cluster_index))
+        {
+          min_cluster_distance = d;
+          min_cluster_index = k;
+          flip = f;
+        }
+      }
+
+      if (min_cluster_index>=0 && min_cluster_distance<dist_thres)
+      {
+        Cluster& c = C[min_cluster_index];
+        c.I.push_back(f);
+        if (!flip)
+          c.h += t;
+        else
+          c.h += t.fliplr();
+        c.n += 1;
+
+        centroids[min_cluster_index] = c.h;
+        centroids[min_cluster_index] /= c.n;
+
+        float* sum = mean_point_sums.data() + 3*min_cluster_index;
+        float mean_point[3];
+        for (int d=0; d<3; ++d)
+        {
+          sum[d] += p[d];
+          mean_point[d] = sum[d]/c.n;
+        }
+        if (use_grid)
+          grid.Move(min_cluster_index, mean_point);
+
+        if (!changed[min_cluster_index])
+        {
+          changed[min_cluster_index] = 1;
+          changed_clusters.push_back(min_cluster_index);
+        }
+      }
       else
-        C[min_cluster_index].h += t.fliplr();
-      C[min_cluster_index].n += 1;
-    }
-    else
-    {
-      Cluster c;
-      c.I.push_back(f_indices.at(i));
-      c.h = t;
-      c.n = 1;
-      C.push_back(c);
+      {
+        add_cluster(f);
+        changed.push_back(1);
+        changed_clusters.push_back(C.size()-1);
+      }
     }
   }
 
   if (!distances.empty())
   {
-    std::vector< Cluster > outC;
-//#pragma omp parallel for
+    // the sub-clusters are collected per cluster and appended in order, so the result does not depend on the threads
+    std::vector< std::vector< Cluster > > subC(C.size());
+#pragma omp parallel for schedule(dynamic)
     for (int c=0; c<(int)C.size(); c++)
     {
+      subC[c] = ClusterStep(C.at(c).I, distances);
+    }
 
-      std::vector< Cluster > tempC = ClusterStep(C.at(c).I, distances);
+    std::vector< Cluster > outC;
+    for (auto& tempC : subC)
       AppendCluster(outC, tempC);
-    }
     return outC;
   }
   else
@@ -230,18 +428,19 @@ void TractClusteringFilter::MergeDuplicateClusters(std::vector< TractClusteringF
     found = false;
     for (int k1=start; k1<(int)clusters.size(); ++k1)
     {
-      Cluster c1 = clusters.at(k1);
+      const Cluster& c1 = clusters.at(k1);
       vnl_matrix<float> t = c1.h / c1.n;
 
-      std::vector< int > merge_indices;
-      std::vector< bool > flip_indices;
+      // the flags are collected per cluster, so the merge order does not depend on the threads
+      std::vector< char > merge_flags(clusters.size(), 0);
+      std::vector< char > flip_flags(clusters.size(), 0);
 
 #pragma omp parallel for
       for (int k2=0; k2<(int)clusters.size(); ++k2)
       {
         if (k1!=k2)
         {
-          Cluster c2 = clusters.at(k2);
+          const Cluster& c2 = clusters.at(k2);
           vnl_matrix<float> v = c2.h / c2.n;
           bool f = false;
 
@@ -250,18 +449,28 @@ void TractClusteringFilter::MergeDuplicateClusters(std::vector< TractClusteringF
             d += m->CalculateDistance(t, v, f);
           d /= m_Metrics.size();
 
-#pragma omp critical
           if (d<m_MergeDuplicateThreshold)
           {
-            merge_indices.push_back(k2);
-            flip_indices.push_back(f);
+            merge_flags[k2] = 1;
+            flip_flags[k2] = f;
           }
         }
       }
 
+      std::vector< int > merge_indices;
+      std::vector< bool > flip_indices;
+      for (int k2=0; k2<(int)clusters.size(); ++k2)
+      {
+        if (merge_flags[k2])
+        {
+          merge_indices.push_back(k2);
+          flip_indices.push_back(flip_flags[k2]);
+        }
+      }
+
       for (unsigned int i=0; i<merge_indices.size(); ++i)
       {
-        Cluster c2 = clusters.at(merge_indices.at(i));
+        const Cluster& c2 = clusters.at(merge_indices.at(i));
         for (int i=0; i<c2.n; ++i)
         {
           clusters[k1].I.push_back(c2.I.at(i));
@@ -273,7 +482,6 @@ void TractClusteringFilter::MergeDuplicateClusters(std::vector< TractClusteringF
           clusters[k1].h += c2.h.fliplr();
       }
 
-      std::sort(merge_indices.begin(), merge_indices.end());
       for (unsigned int i=0; i<merge_indices.size(); ++i)
       {
         clusters.erase (clusters.begin()+merge_indices.at(i)-i);
@@ -293,22 +501,26 @@ std::vector<TractClusteringFilter::Cluster> TractClusteringFilter::AddToKnownClu
   int N = f_indices.size();
 
   std::vector< Cluster > C;
-  vnl_matrix<float> zero_h; zero_h.set_size(T.at(0).rows(), T.at(0).cols()); zero_h.fill(0.0);
+  vnl_matrix<float> zero_h; zero_h.set_size(3, m_NumPoints); zero_h.fill(0.0);
   Cluster no_fit;
   no_fit.h = zero_h;
 
   for (unsigned int i=0; i<centroids.size(); ++i)
   {
     Cluster c;
-    c.h.set_size(T.at(0).rows(), T.at(0).cols()); c.h.fill(0.0);
+    c.h.set_size(3, m_NumPoints); c.h.fill(0.0);
     c.f_id = i;
     C.push_back(c);
   }
 
+  // the assignments are determined in parallel and applied in fiber order afterwards
+  std::vector< int > assignments(N, -1);
+  std::vector< char > flips(N, 0);
+
 #pragma omp parallel for
   for (int i=0; i<N; ++i)
   {
-    vnl_matrix<float> t = T.at(f_indices.at(i));
+    vnl_matrix_ref<float> t(3, m_NumPoints, GetFiber(f_indices.at(i)));
 
     int min_cluster_index = -1;
     float min_cluster_distance = 99999;
@@ -317,7 +529,7 @@ std::vector<TractClusteringFilter::Cluster> TractClusteringFilter::AddToKnownClu
     if (CalcOverlap(t)>=m_OverlapThreshold)
     {
       int c_idx = 0;
-      for (vnl_matrix<float> centroid : centroids)
+      for (vnl_matrix<float>& centroid : centroids)
       {
         bool f = false;
         float d = 0;
@@ -337,23 +549,28 @@ std::vector<TractClusteringFilter::Cluster> TractClusteringFilter::AddToKnownClu
 
     if (min_cluster_index>=0 && min_cluster_distance<dist_thres)
     {
-#pragma omp critical
-      {
-        C[min_cluster_index].I.push_back(f_indices.at(i));
-        if (!flip)
-          C[min_cluster_index].h += t;
-        else
-          C[min_cluster_index].h += t.fliplr();
-        C[min_cluster_index].n += 1;
-      }
+      assignments[i] = min_cluster_index;
+      flips[i] = flip;
+    }
+  }
+
+  for (int i=0; i<N; ++i)
+  {
+    if (assignments[i]>=0)
+    {
+      vnl_matrix_ref<float> t(3, m_NumPoints, GetFiber(f_indices.at(i)));
+      Cluster& c = C[assignments[i]];
+      c.I.push_back(f_indices.at(i));
+      if (!flips[i])
+        c.h += t;
+      else
+        c.h += t.fliplr();
+      c.n += 1;
     }
     else
     {
-#pragma omp critical
-      {
-        no_fit.I.push_back(f_indices.at(i));
-        no_fit.n++;
-      }
+      no_fit.I.push_back(f_indices.at(i));
+      no_fit.n++;
     }
   }
   C.push_back(no_fit);
@@ -374,15 +591,29 @@ void TractClusteringFilter::GenerateData()
     return;
   }
 
-  T = ResampleFibers(m_Tractogram);
-  if (T.empty())
+  m_Fibers = ResampleFibers(m_Tractogram);
+  if (m_Fibers.empty())
   {
     MITK_INFO << "No fibers in tractogram!";
     return;
   }
 
+  long num_fibers = m_Fibers.size()/(3*m_NumPoints);
+  m_FiberMeanPoints.resize(3*num_fibers);
+  for (long i=0; i<num_fibers; ++i)
+  {
+    const float* fiber = GetFiber(i);
+    for (int d=0; d<3; ++d)
+    {
+      float sum = 0;
+      for (unsigned int j=0; j<m_NumPoints; ++j)
+        sum += fiber[d*m_NumPoints+j];
+      m_FiberMeanPoints[3*i+d] = sum/m_NumPoints;
+    }
+  }
+
   std::vector< long > f_indices;
-  for (unsigned int i=0; i<T.size(); ++i)
+  for (long i=0; i<num_fibers; ++i)
     f_indices.push_back(i);
   //  std::random_shuffle(f_indices.begin(), f_indices.end());
 
@@ -398,12 +629,15 @@ void TractClusteringFilter::GenerateData()
   }
   else
   {
-    std::vector<vnl_matrix<float> > centroids = ResampleFibers(m_InCentroids);
-    if (centroids.empty())
+    std::vector< float > centroid_buffer = ResampleFibers(m_InCentroids);
+    if (centroid_buffer.empty())
     {
       MITK_INFO << "No fibers in centroid tractogram!";
       return;
     }
+    std::vector<vnl_matrix<float> > centroids;
+    for (unsigned int i=0; i<centroid_buffer.size(); i+=3*m_NumPoints)
+      centroids.push_back(vnl_matrix<float>(centroid_buffer.data()+i, 3, m_NumPoints));
     MITK_INFO << "Clustering with input centroids";
     clusters = AddToKnownClusters(f_indices, centroids);
     no_match = clusters.back();
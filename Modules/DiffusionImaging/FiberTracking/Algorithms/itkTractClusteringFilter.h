@@ -25,6 +25,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 // ITK
 #include <itkProcessObject.h>
 
+#include <unordered_map>
+
+// VNL
+#include <vnl/vnl_matrix_ref.h>
+
 // VTK
 #include <vtkSmartPointer.h>
 #include <vtkPolyData.h>
@@ -35,7 +40,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace itk{
 
 /**
-* \brief    */
+* \brief  QuickBundles-style clustering of streamlines.
+*
+* The resampled fibers are stored in one contiguous buffer. If all metrics provide a lower bound based on the mean
+* points of the tracts (see mitk::ClusteringMetric::GetMeanPointDistanceFactor), the candidate clusters of a fiber
+* are looked up in a grid of the cluster mean points. The distances of the fibers to the clusters are calculated in
+* parallel in batches of fibers, and the clusters of one distance level are split into the clusters of the next level
+* in parallel. The result does not depend on the number of threads.  */
 
 class TractClusteringFilter : public ProcessObject
 {
@@ -79,6 +90,8 @@ public:
   itkGetMacro(DoResampling, bool) ///< Resample fibers to equal number of points. This is mandatory, but can be performed outside of the filter if desired.
   itkSetMacro(OverlapThreshold, float)  ///< Overlap threshold used in conjunction with the filter mask when clustering around known centroids.
   itkGetMacro(OverlapThreshold, float)  ///< Overlap threshold used in conjunction with the filter mask when clustering around known centroids.
+  itkSetMacro(UseMeanPointGrid, bool)  ///< Look up the candidate clusters of a fiber in the grid of cluster mean points if the metrics allow it. Switching it off compares each fiber with all clusters, which gives the same clusters but is slower.
+  itkGetMacro(UseMeanPointGrid, bool)  ///< Look up the candidate clusters of a fiber in the grid of cluster mean points if the metrics allow it. Switching it off compares each fiber with all clusters, which gives the same clusters but is slower.
 
   itkSetMacro(Tractogram, mitk::FiberBundle::Pointer)   ///< The streamlines to be clustered
   itkSetMacro(InCentroids, mitk::FiberBundle::Pointer)  ///< If a tractogram containing known tract centroids is set, the input fibers are assigned to the closest centroid. If no centroid is found within the specified smallest clustering distance, the fiber is assigned to the no-fit cluster.
@@ -100,9 +113,30 @@ public:
 
 protected:
 
+  /** Uniform grid of cluster mean points with a cell size of the search radius */
+  class MeanPointGrid
+  {
+  public:
+    MeanPointGrid(float radius);
+    void Insert(int cluster, const float* point);
+    void Move(int cluster, const float* point);
+    void Query(const float* point, std::vector< int >& candidates) const;  ///< Candidates are sorted ascendingly
+    bool IsInRange(int cluster, const float* point) const;  ///< True if the cluster would be a candidate of Query()
+
+  private:
+    long long GetCellKey(const float* point, int offset_x=0, int offset_y=0, int offset_z=0) const;
+
+    float                                                 m_Radius;
+    std::unordered_map< long long, std::vector< int > >   m_Cells;
+    std::vector< long long >                              m_ClusterCells;
+    std::vector< float >                                  m_MeanPoints;
+  };
+
   void GenerateData() override;
-  std::vector< vnl_matrix<float> > ResampleFibers(FiberBundle::Pointer tractogram);
+  std::vector< float > ResampleFibers(FiberBundle::Pointer tractogram); ///< 3xNumPoints values per fiber in the row-major order of vnl_matrix
+  float* GetFiber(long index);
   float CalcOverlap(vnl_matrix<float>& t);
+  float GetMeanPointDistanceFactor() const;
 
   std::vector< Cluster > ClusterStep(std::vector< long > f_indices, std::vector< float > distances);
 
@@ -119,7 +153,8 @@ protected:
   mitk::FiberBundle::Pointer                  m_InCentroids;
   std::vector< mitk::FiberBundle::Pointer >   m_OutTractograms;
   std::vector< mitk::FiberBundle::Pointer >   m_OutCentroids;
-  std::vector<vnl_matrix<float> >             T;
+  std::vector< float >                        m_Fibers;
+  std::vector< float >                        m_FiberMeanPoints;
   unsigned int                                m_MinClusterSize;
   unsigned int                                m_MaxClusters;
   float                                       m_MergeDuplicateThreshold;
@@ -127,6 +162,7 @@ protected:
   bool                                        m_DoResampling;
   UcharImageType::Pointer                     m_FilterMask;
   float                                       m_OverlapThreshold;
+  bool                                        m_UseMeanPointGrid;
   std::vector< mitk::ClusteringMetric* >      m_Metrics;
   std::vector< std::vector< long > >          m_OutFiberIndices;
 };
@@ -492,14 +492,16 @@ itk::Point<float, 3> mitk::FiberBundle::GetItkPoint(double point[3])
 }
 
 /*
- * set PolyData (additional flag to recompute fiber geometry, default = true)
+ * set PolyData (additional flag to recompute fiber geometry, default = true; without deep copy the polydata is taken over)
  */
-void mitk::FiberBundle::SetFiberPolyData(vtkSmartPointer<vtkPolyData> fiberPD, bool updateGeometry)
+void mitk::FiberBundle::SetFiberPolyData(vtkSmartPointer<vtkPolyData> fiberPD, bool updateGeometry, bool deepCopy)
 {
   if (fiberPD == nullptr)
     this->m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  else
+  else if (deepCopy)
     m_FiberPolyData->DeepCopy(fiberPD);
+  else
+    m_FiberPolyData = fiberPD;
 
   m_NumFibers = m_FiberPolyData->GetNumberOfLines();
 
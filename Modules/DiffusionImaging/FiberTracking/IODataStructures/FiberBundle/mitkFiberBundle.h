@@ -117,7 +117,7 @@ public:
     void SetFiberWeights(float newWeight);
     void SetFiberWeight(unsigned int fiber, float weight);
     void SetFiberWeights(vtkSmartPointer<vtkFloatArray> weights);
-    void SetFiberPolyData(vtkSmartPointer<vtkPolyData>, bool updateGeometry = true);
+    void SetFiberPolyData(vtkSmartPointer<vtkPolyData>, bool updateGeometry = true, bool deepCopy = true);
     vtkSmartPointer<vtkPolyData> GetFiberPolyData() const;
     itkGetConstMacro( NumFibers, int)
     //itkGetMacro( FiberSampling, int)
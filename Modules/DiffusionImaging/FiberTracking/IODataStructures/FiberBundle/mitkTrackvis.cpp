@@ -1,5 +1,8 @@
 #include <mitkTrackvis.h>
-#include <vtkTransformPolyDataFilter.h>
+#include <mitkMemoryMappedFile.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <cstring>
 
 TrackVisFiberReader::TrackVisFiberReader()  { m_Filename = ""; m_FilePointer = nullptr; }
 
@@ -129,38 +132,58 @@ short TrackVisFiberReader::append(const mitk::FiberBundle *fib)
   return 0;
 }
 
-//// Read one fiber from the file
-//// ----------------------------
+//// Read all fibers from the file
+//// -----------------------------
 short TrackVisFiberReader::read( mitk::FiberBundle* fib )
 {
-  int numPoints;
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
-  while (fread((char*)&numPoints, 1, 4, m_FilePointer)==4)
+  // the mapped file is parsed in one pass into arrays that are large enough for the complete file
+  mitk::MemoryMappedFile file;
+  file.Open(m_Filename);
+  const char* data = file.GetData();
+  const std::size_t size = file.GetSize();
+  std::size_t pos = 1000;
+
+  // every fiber needs at least 4 bytes for its number of points and 12 bytes for one point
+  const std::size_t fiberDataSize = size > pos ? size - pos : 0;
+  const vtkIdType maxPoints = fiberDataSize / 12;
+  const vtkIdType maxFibers = fiberDataSize / 16;
+
+  vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(maxPoints);
+  vtkSmartPointer<vtkIdTypeArray> lines = vtkSmartPointer<vtkIdTypeArray>::New();
+  lines->SetNumberOfValues(maxPoints + maxFibers);
+
+  float* points = coordinates->GetPointer(0);
+  vtkIdType* ids = lines->GetPointer(0);
+  vtkIdType numPoints = 0;
+  vtkIdType numFibers = 0;
+  vtkIdType numIds = 0;
+
+  int numFiberPoints = 0;
+  while (pos + 4 <= size)
   {
-    if ( numPoints <= 0 )
+    std::memcpy(&numFiberPoints, data + pos, 4);
+    pos += 4;
+    if ( numFiberPoints <= 0 )
     {
-      printf( "[ERROR] Trying to read a fiber with %d points!\n", numPoints );
+      printf( "[ERROR] Trying to read a fiber with %d points!\n", numFiberPoints );
       return -1;
     }
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-
-    float tmp[3];
-    for(int i=0; i<numPoints; i++)
+    if ( (size - pos) / 12 < static_cast<std::size_t>(numFiberPoints) )
     {
-      if (fread((char*)tmp, 1, 12, m_FilePointer) == 0)
-        MITK_ERROR << "TrackVis::read: Error during read.";
-
-      vtkIdType id = vtkNewPoints->InsertNextPoint(tmp);
-      container->GetPointIds()->InsertNextId(id);
+      MITK_ERROR << "TrackVis::read: Error during read.";
+      break;
     }
-    vtkNewCells->InsertNextCell(container);
-  }
 
-  vtkSmartPointer<vtkPolyData> fiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  fiberPolyData->SetPoints(vtkNewPoints);
-  fiberPolyData->SetLines(vtkNewCells);
+    std::memcpy(points + 3 * numPoints, data + pos, 12 * static_cast<std::size_t>(numFiberPoints));
+    pos += 12 * static_cast<std::size_t>(numFiberPoints);
+
+    ids[numIds++] = numFiberPoints;
+    for (int i=0; i<numFiberPoints; i++)
+      ids[numIds++] = numPoints++;
+    ++numFibers;
+  }
 
   //    MITK_INFO << "Coordinate convention: " << m_Header.voxel_order;
 
@@ -177,11 +200,30 @@ short TrackVisFiberReader::read( mitk::FiberBundle* fib )
 
   geometry->SetIndexToWorldTransformByVtkMatrix(matrix);
 
-  vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  transformFilter->SetInputData(fiberPolyData);
-  transformFilter->SetTransform(geometry->GetVtkTransform());
-  transformFilter->Update();
-  fib->SetFiberPolyData(transformFilter->GetOutput());
+  // the transform only flips axes, so it is applied to the coordinates directly
+  const float sign[3] = { static_cast<float>(matrix->GetElement(0,0)), static_cast<float>(matrix->GetElement(1,1)), static_cast<float>(matrix->GetElement(2,2)) };
+  if (sign[0]<0 || sign[1]<0 || sign[2]<0)
+  {
+    for (vtkIdType i=0; i<numPoints; i++)
+    {
+      points[3*i] *= sign[0];
+      points[3*i+1] *= sign[1];
+      points[3*i+2] *= sign[2];
+    }
+  }
+
+  coordinates->SetNumberOfTuples(numPoints);
+  lines->SetNumberOfValues(numIds);
+
+  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+  vtkNewPoints->SetData(coordinates);
+  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+  vtkNewCells->SetCells(numFibers, lines);
+
+  vtkSmartPointer<vtkPolyData> fiberPolyData = vtkSmartPointer<vtkPolyData>::New();
+  fiberPolyData->SetPoints(vtkNewPoints);
+  fiberPolyData->SetLines(vtkNewCells);
+  fib->SetFiberPolyData(fiberPolyData, true, false);
 
   mitk::Point3D origin;
   origin[0]=m_Header.origin[0];
@@ -202,7 +244,7 @@ short TrackVisFiberReader::read( mitk::FiberBundle* fib )
     geometry->SetExtentInMM(2, m_Header.voxel_size[2]*m_Header.dim[2]);
     fib->SetReferenceGeometry(dynamic_cast<mitk::BaseGeometry*>(geometry.GetPointer()));
   }
-  return numPoints;
+  return numFiberPoints;
 }
 
 
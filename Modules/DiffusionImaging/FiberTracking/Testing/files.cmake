@@ -9,8 +9,11 @@ SET(MODULE_CUSTOM_TESTS
   mitkFiberfoxSignalGenerationTest.cpp
   mitkMachineLearningTrackingTest.cpp
   mitkFiberProcessingTest.cpp
+  mitkFiberClusteringTest.cpp
   mitkFiberFitTest.cpp
   mitkFiberMapper3DTest.cpp
+  mitkTractogramReaderBenchmarkTest.cpp
+  mitkFiberFitBenchmarkTest.cpp
 )
 
 
@@ -0,0 +1,86 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkFiberBundle.h>
+#include <mitkIOUtil.h>
+#include <itkTractClusteringFilter.h>
+#include <mitkClusteringMetricEuclideanMean.h>
+#include <mitkClusteringMetricEuclideanMax.h>
+#include <omp.h>
+#include "mitkTestFixture.h"
+
+class mitkFiberClusteringTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkFiberClusteringTestSuite);
+  MITK_TEST(Grid_SameAsBruteForce);
+  MITK_TEST(Grid_SeveralDistances_SameAsBruteForce);
+  MITK_TEST(Threads_SameAsOneThread);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::FiberBundle::Pointer  original;
+
+  /** Clusters the test tractogram, the filter takes ownership of the metrics */
+  std::vector< std::vector< long > > Cluster(std::vector< float > distances, bool use_grid, int threads)
+  {
+    omp_set_num_threads(threads);
+
+    itk::TractClusteringFilter::Pointer clusterer = itk::TractClusteringFilter::New();
+    clusterer->SetDistances(distances);
+    clusterer->SetTractogram(original);
+    clusterer->SetMetrics({new mitk::ClusteringMetricEuclideanMean(), new mitk::ClusteringMetricEuclideanMax()});
+    clusterer->SetUseMeanPointGrid(use_grid);
+    clusterer->Update();
+
+    std::vector< std::vector< long > > clusters = clusterer->GetOutFiberIndices();
+    CPPUNIT_ASSERT_MESSAGE("No clusters found", !clusters.empty());
+    return clusters;
+  }
+
+public:
+
+  void setUp() override
+  {
+    original = mitk::IOUtil::Load<mitk::FiberBundle>(GetTestDataFilePath("DiffusionImaging/FiberProcessing/original.fib"));
+  }
+
+  void tearDown() override
+  {
+    original = nullptr;
+    omp_set_num_threads(1);
+  }
+
+  void Grid_SameAsBruteForce()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Grid pruning changed the clusters", Cluster({10}, true, 1)==Cluster({10}, false, 1));
+  }
+
+  void Grid_SeveralDistances_SameAsBruteForce()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Grid pruning changed the clusters", Cluster({5, 10, 20}, true, 1)==Cluster({5, 10, 20}, false, 1));
+  }
+
+  void Threads_SameAsOneThread()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Clusters depend on the number of threads (grid)", Cluster({10}, true, 4)==Cluster({10}, true, 1));
+    CPPUNIT_ASSERT_MESSAGE("Clusters depend on the number of threads (brute force)", Cluster({10}, false, 4)==Cluster({10}, false, 1));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkFiberClustering)
@@ -0,0 +1,196 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkFiberBundle.h>
+#include <itkFitFibersToImageFilter.h>
+
+#include <itkTimeProbe.h>
+#include <vnl/vnl_sparse_matrix_linear_system.h>
+#include <vtkCellArray.h>
+#include <vtkPolyLine.h>
+
+#include <cmath>
+#include <cstdlib>
+
+/**
+ * Compares the cost function evaluation of the fiber fit (compressed sparse matrix, OpenMP) with the previous
+ * evaluation based on vnl_sparse_matrix_linear_system, and fits a synthetic bundle with both solvers. Reports
+ * evaluations resp. iterations per second.
+ *
+ * The bundle consists of argv[1] straight fibers in a peak image with an edge length of argv[2] voxels. The speedup
+ * of the compressed matrix only shows once the system matrix no longer fits into the caches, i.e. with about
+ * 10^5 fibers in a 100^3 image.
+ */
+namespace
+{
+  typedef itk::FitFibersToImageFilter FitterType;
+
+  /** Straight fibers along x at pseudo random y/z positions, each crossing the whole image */
+  mitk::FiberBundle::Pointer CreateBundle(unsigned int numFibers, unsigned int edgeLength)
+  {
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    unsigned int state = 42;
+    for (unsigned int f=0; f<numFibers; ++f)
+    {
+      state = state * 1664525u + 1013904223u;
+      const double y = 0.5 + (edgeLength-1) * static_cast<double>(state >> 16) / 65536.0;
+      state = state * 1664525u + 1013904223u;
+      const double z = 0.5 + (edgeLength-1) * static_cast<double>(state >> 16) / 65536.0;
+
+      vtkSmartPointer<vtkPolyLine> line = vtkSmartPointer<vtkPolyLine>::New();
+      for (unsigned int x=0; x<edgeLength; ++x)
+        line->GetPointIds()->InsertNextId(points->InsertNextPoint(x, y, z));
+      cells->InsertNextCell(line);
+    }
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(cells);
+    return mitk::FiberBundle::New(polyData);
+  }
+
+  /** One peak along x with varying magnitude in each voxel */
+  FitterType::PeakImgType::Pointer CreatePeakImage(unsigned int edgeLength)
+  {
+    FitterType::PeakImgType::RegionType region;
+    for (unsigned int d=0; d<3; ++d)
+      region.SetSize(d, edgeLength);
+    region.SetSize(3, 3);
+
+    FitterType::PeakImgType::Pointer image = FitterType::PeakImgType::New();
+    image->SetRegions(region);
+    image->Allocate();
+    image->FillBuffer(0.0);
+
+    itk::ImageRegionIterator<FitterType::PeakImgType> it(image, region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const FitterType::PeakImgType::IndexType index = it.GetIndex();
+      if (index[3]==0)
+        it.Set(1.0 + 0.5 * std::sin(0.1 * index[1]) * std::cos(0.1 * index[2]));
+    }
+    return image;
+  }
+
+  /** Each column touches a run of consecutive rows, similar to a fiber passing through voxels */
+  void CreateSystem(unsigned int numFibers, unsigned int edgeLength, vnl_sparse_matrix<double>& A, vnl_vector<double>& b)
+  {
+    const unsigned int numRows = edgeLength * edgeLength * edgeLength;
+    A.set_size(numRows, numFibers);
+    unsigned int state = 7;
+    for (unsigned int c=0; c<numFibers; ++c)
+    {
+      state = state * 1664525u + 1013904223u;
+      const unsigned int start = (state >> 8) % (numRows - edgeLength);
+      for (unsigned int i=0; i<edgeLength; ++i)
+        A.put(start + i, c, 0.5 + 0.5 * std::sin(0.3 * i + c));
+    }
+
+    vnl_vector<double> x(numFibers, 1.0);
+    b.set_size(numRows);
+    A.mult(x, b);
+    b *= 0.8;
+  }
+
+  void CompareCostFunctionEvaluation(unsigned int numFibers, unsigned int edgeLength)
+  {
+    const unsigned int numEvaluations = 20;
+
+    vnl_sparse_matrix<double> A;
+    vnl_vector<double> b;
+    CreateSystem(numFibers, edgeLength, A, b);
+    vnl_vector<double> x(numFibers, 0.5);
+    const unsigned int N = b.size();
+
+    // previous implementation: cost and gradient each multiply with the vnl system
+    itk::TimeProbe previousProbe;
+    previousProbe.Start();
+    vnl_sparse_matrix_linear_system<double> system(A, b);
+    vnl_vector<double> previous_g(numFibers);
+    double previous_f = 0;
+    for (unsigned int i=0; i<numEvaluations; ++i)
+    {
+      vnl_vector<double> d(N);
+      system.multiply(x, d);
+      previous_f = (d - b).squared_magnitude()/N;
+
+      system.multiply(x, d);
+      d -= b;
+      system.transpose_multiply(d, previous_g);
+      previous_g *= 2.0/N;
+    }
+    previousProbe.Stop();
+
+    itk::TimeProbe costProbe;
+    costProbe.Start();
+    VnlCostFunction cost(numFibers);
+    cost.SetProblem(A, b, 0, VnlCostFunction::NONE);
+    vnl_vector<double> g(numFibers);
+    double f = 0;
+    for (unsigned int i=0; i<numEvaluations; ++i)
+      cost.compute(x, &f, &g);
+    costProbe.Stop();
+
+    MITK_TEST_OUTPUT(<< numFibers << " fibers, " << N << " residuals: vnl_sparse_matrix_linear_system "
+                     << numEvaluations/previousProbe.GetTotal() << " evaluations/s, FitFibersSparseMatrix "
+                     << numEvaluations/costProbe.GetTotal() << " evaluations/s (including matrix conversion)");
+
+    MITK_TEST_CONDITION(std::fabs(f - previous_f) <= 1e-5 * std::fabs(previous_f), "Cost equals previous implementation");
+    MITK_TEST_CONDITION((g - previous_g).inf_norm() <= 1e-5 * previous_g.inf_norm(), "Gradient equals previous implementation");
+  }
+
+  void FitBundle(unsigned int numFibers, unsigned int edgeLength, FitterType::SOLVER solver, const std::string& name)
+  {
+    std::vector<mitk::FiberBundle::Pointer> tracts;
+    tracts.push_back(CreateBundle(numFibers, edgeLength));
+
+    FitterType::Pointer fitter = FitterType::New();
+    fitter->SetPeakImage(CreatePeakImage(edgeLength));
+    fitter->SetTractograms(tracts);
+    fitter->SetRegularization(VnlCostFunction::NONE);
+    fitter->SetSolver(solver);
+    fitter->SetMaxIterations(50);
+    fitter->SetVerbose(false);
+    fitter->Update();
+
+    MITK_TEST_OUTPUT(<< name << ": " << fitter->GetNumIterations() << " iterations, "
+                     << fitter->GetNumIterations()/fitter->GetOptimizationTime() << " iterations/s, "
+                     << fitter->GetNumEvaluations()/fitter->GetOptimizationTime() << " evaluations/s, RMSE "
+                     << fitter->GetRMSE());
+
+    MITK_TEST_CONDITION(std::isfinite(fitter->GetRMSE()), name << " yields a finite RMSE");
+    MITK_TEST_CONDITION(fitter->GetMinWeight() >= 0, name << " yields non-negative weights");
+  }
+}
+
+int mitkFiberFitBenchmarkTest(int argc, char* argv[])
+{
+  MITK_TEST_BEGIN("mitkFiberFitBenchmarkTest")
+
+  MITK_TEST_CONDITION_REQUIRED(argc == 3, "Test is invoked with exactly 2 parameters (number of fibers, edge length)");
+
+  const unsigned int numFibers = static_cast<unsigned int>(std::atoi(argv[1]));
+  const unsigned int edgeLength = static_cast<unsigned int>(std::atoi(argv[2]));
+  MITK_TEST_CONDITION_REQUIRED(numFibers > 0 && edgeLength > 1, "Valid parameters");
+
+  CompareCostFunctionEvaluation(numFibers, edgeLength);
+  FitBundle(numFibers, edgeLength, FitterType::LBFGSB, "LBFGSB");
+  FitBundle(numFibers, edgeLength, FitterType::PROJECTED_GRADIENT, "PROJECTED_GRADIENT");
+
+  MITK_TEST_END()
+}
@@ -0,0 +1,288 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkFiberBundle.h>
+#include <mitkIOUtil.h>
+#include <mitkTrackvis.h>
+
+#include <itkTimeProbe.h>
+#include <itksys/SystemTools.hxx>
+#include <vtkCellArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPolyLine.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+/**
+ * Compares the memory mapped TrackVis and MRtrix tractogram readers with the previous readers, that read one
+ * point per fread call and inserted it into vtkPoints and vtkPolyLine cells, on synthetic tractograms, and
+ * reports the run times of both.
+ *
+ * The tractogram size is given on the command line (number of streamlines, mean number of points per streamline).
+ * The previous readers need several minutes for a whole-brain tractogram of a million streamlines, which is the
+ * size the memory mapped readers are meant for.
+ */
+namespace
+{
+  /** Helices with slightly varying radius and offset, the number of points varies around the given value */
+  std::vector< std::vector<float> > CreateStreamlines(unsigned int numStreamlines, unsigned int numPoints)
+  {
+    std::vector< std::vector<float> > streamlines(numStreamlines);
+    for (unsigned int s=0; s<numStreamlines; ++s)
+    {
+      const unsigned int n = numPoints/2 + s % (numPoints+1);
+      const float radius = 10.0f + 0.001f * s;
+      streamlines[s].reserve(3*n);
+      for (unsigned int i=0; i<n; ++i)
+      {
+        streamlines[s].push_back(radius * std::cos(0.1f * i) + 0.01f * (s % 97));
+        streamlines[s].push_back(radius * std::sin(0.1f * i) - 0.01f * (s % 89));
+        streamlines[s].push_back(0.5f * i - 20.0f);
+      }
+    }
+    return streamlines;
+  }
+
+  std::string WriteTck(const std::vector< std::vector<float> >& streamlines)
+  {
+    std::ofstream stream;
+    std::string filename = mitk::IOUtil::CreateTemporaryFile(stream, std::ios_base::binary, "tractogram_XXXXXX.tck");
+
+    // the data offset is written with a fixed width, so that the header size is known beforehand
+    std::string header = "mrtrix tracks\ndatatype: Float32LE\ncount: " + std::to_string(streamlines.size()) + "\nfile: . ";
+    const unsigned int offset = header.size() + 10 + 5;
+    char offset_string[16];
+    sprintf(offset_string, "%09u\n", offset);
+    header += std::string(offset_string) + "END\n";
+    header.resize(offset, '\0');
+    stream.write(header.data(), header.size());
+
+    const float delimiter[3] = { std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN() };
+    const float end[3] = { std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+    for (const std::vector<float>& streamline : streamlines)
+    {
+      stream.write(reinterpret_cast<const char*>(streamline.data()), 4*streamline.size());
+      stream.write(reinterpret_cast<const char*>(delimiter), 12);
+    }
+    stream.write(reinterpret_cast<const char*>(end), 12);
+    return filename;
+  }
+
+  std::string WriteTrk(const std::vector< std::vector<float> >& streamlines)
+  {
+    std::ofstream stream;
+    std::string filename = mitk::IOUtil::CreateTemporaryFile(stream, std::ios_base::binary, "tractogram_XXXXXX.trk");
+
+    TrackVis_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::strcpy(header.id_string, "TRACK");
+    std::strcpy(header.voxel_order, "RAS");
+    header.n_count = streamlines.size();
+    header.version = 1;
+    header.hdr_size = 1000;
+    stream.write(reinterpret_cast<const char*>(&header), 1000);
+
+    for (const std::vector<float>& streamline : streamlines)
+    {
+      int numPoints = streamline.size()/3;
+      stream.write(reinterpret_cast<const char*>(&numPoints), 4);
+      stream.write(reinterpret_cast<const char*>(streamline.data()), 4*streamline.size());
+    }
+    return filename;
+  }
+
+  vtkSmartPointer<vtkPolyData> FlipAxes(vtkPolyData* polyData, bool flipX, bool flipY)
+  {
+    vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
+    transform->Scale(flipX ? -1 : 1, flipY ? -1 : 1, 1);
+    vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    transformFilter->SetInputData(polyData);
+    transformFilter->SetTransform(transform);
+    transformFilter->Update();
+    return transformFilter->GetOutput();
+  }
+
+  /** Previous MRtrix reader */
+  vtkSmartPointer<vtkPolyData> ReadTckPerPoint(const std::string& filename, int header_size)
+  {
+    std::FILE* filePointer = std::fopen(filename.c_str(),"rb");
+    std::fseek(filePointer, header_size, SEEK_SET);
+
+    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+
+    float tmp[3];
+    while (std::fread((char*)tmp, 1, 12, filePointer)==12)
+    {
+      if (std::isinf(tmp[0]) || std::isinf(tmp[1]) || std::isinf(tmp[2]))
+        break;
+      else if (std::isnan(tmp[0]) || std::isnan(tmp[1]) || std::isnan(tmp[2]))
+      {
+        vtkNewCells->InsertNextCell(container);
+        container = vtkSmartPointer<vtkPolyLine>::New();
+      }
+      else
+      {
+        vtkIdType id = vtkNewPoints->InsertNextPoint(tmp);
+        container->GetPointIds()->InsertNextId(id);
+      }
+    }
+    std::fclose(filePointer);
+
+    vtkSmartPointer<vtkPolyData> fiberPolyData = vtkSmartPointer<vtkPolyData>::New();
+    fiberPolyData->SetPoints(vtkNewPoints);
+    fiberPolyData->SetLines(vtkNewCells);
+    return FlipAxes(fiberPolyData, true, true);
+  }
+
+  /** Previous TrackVis reader */
+  vtkSmartPointer<vtkPolyData> ReadTrkPerPoint(const std::string& filename)
+  {
+    std::FILE* filePointer = std::fopen(filename.c_str(),"rb");
+    std::fseek(filePointer, 1000, SEEK_SET);
+
+    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+
+    int numPoints;
+    while (std::fread((char*)&numPoints, 1, 4, filePointer)==4)
+    {
+      vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+      float tmp[3];
+      for(int i=0; i<numPoints; i++)
+      {
+        if (std::fread((char*)tmp, 1, 12, filePointer) == 0)
+          break;
+        vtkIdType id = vtkNewPoints->InsertNextPoint(tmp);
+        container->GetPointIds()->InsertNextId(id);
+      }
+      vtkNewCells->InsertNextCell(container);
+    }
+    std::fclose(filePointer);
+
+    vtkSmartPointer<vtkPolyData> fiberPolyData = vtkSmartPointer<vtkPolyData>::New();
+    fiberPolyData->SetPoints(vtkNewPoints);
+    fiberPolyData->SetLines(vtkNewCells);
+    return FlipAxes(fiberPolyData, true, true);
+  }
+
+  bool AreEqual(vtkPolyData* reference, vtkPolyData* polyData)
+  {
+    if (reference->GetNumberOfPoints() != polyData->GetNumberOfPoints() ||
+        reference->GetNumberOfLines() != polyData->GetNumberOfLines())
+      return false;
+
+    for (vtkIdType i=0; i<reference->GetNumberOfPoints(); ++i)
+    {
+      double p[3];
+      double q[3];
+      reference->GetPoint(i, p);
+      polyData->GetPoint(i, q);
+      if (p[0]!=q[0] || p[1]!=q[1] || p[2]!=q[2])
+        return false;
+    }
+
+    vtkSmartPointer<vtkCellArray> referenceLines = reference->GetLines();
+    vtkSmartPointer<vtkCellArray> lines = polyData->GetLines();
+    referenceLines->InitTraversal();
+    lines->InitTraversal();
+    vtkIdType n, m;
+    vtkIdType* ids;
+    vtkIdType* referenceIds;
+    while (referenceLines->GetNextCell(n, referenceIds))
+    {
+      if (!lines->GetNextCell(m, ids) || n!=m || !std::equal(referenceIds, referenceIds + n, ids))
+        return false;
+    }
+    return true;
+  }
+}
+
+int mitkTractogramReaderBenchmarkTest(int argc, char *argv[])
+{
+  MITK_TEST_BEGIN("mitkTractogramReaderBenchmarkTest")
+
+  MITK_TEST_CONDITION_REQUIRED(argc == 3, "Test is invoked with exactly 2 parameters (number of streamlines, number of points)");
+
+  const unsigned int numStreamlines = static_cast<unsigned int>(std::atoi(argv[1]));
+  const unsigned int numPoints = static_cast<unsigned int>(std::atoi(argv[2]));
+
+  std::string tckFile;
+  std::string trkFile;
+  {
+    std::vector< std::vector<float> > streamlines = CreateStreamlines(numStreamlines, numPoints);
+    tckFile = WriteTck(streamlines);
+    trkFile = WriteTrk(streamlines);
+  }
+
+  {
+    itk::TimeProbe previousProbe;
+    previousProbe.Start();
+    std::ifstream header(tckFile.c_str(), std::ios_base::binary);
+    std::string line;
+    int header_size = 0;
+    while (std::getline(header, line) && line != "END")
+      if (line.compare(0, 8, "file: . ") == 0)
+        header_size = std::atoi(line.c_str() + 8);
+    vtkSmartPointer<vtkPolyData> reference = ReadTckPerPoint(tckFile, header_size);
+    previousProbe.Stop();
+
+    itk::TimeProbe mappedProbe;
+    mappedProbe.Start();
+    mitk::FiberBundle::Pointer fib = mitk::IOUtil::Load<mitk::FiberBundle>(tckFile);
+    mappedProbe.Stop();
+
+    MITK_TEST_OUTPUT(<< "MRtrix, " << numStreamlines << " streamlines: previous reader " << previousProbe.GetTotal()
+                     << " s, memory mapped reader " << mappedProbe.GetTotal() << " s (including fiber bundle setup)");
+    MITK_TEST_CONDITION(fib->GetNumFibers() == static_cast<int>(numStreamlines), "All MRtrix streamlines are read");
+    MITK_TEST_CONDITION(AreEqual(reference, fib->GetFiberPolyData()), "MRtrix streamlines equal the previous reader");
+  }
+
+  {
+    itk::TimeProbe previousProbe;
+    previousProbe.Start();
+    vtkSmartPointer<vtkPolyData> reference = ReadTrkPerPoint(trkFile);
+    previousProbe.Stop();
+
+    itk::TimeProbe mappedProbe;
+    mappedProbe.Start();
+    mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New();
+    TrackVisFiberReader reader;
+    reader.open(trkFile);
+    reader.read(fib);
+    mappedProbe.Stop();
+
+    MITK_TEST_OUTPUT(<< "TrackVis, " << numStreamlines << " streamlines: previous reader " << previousProbe.GetTotal()
+                     << " s, memory mapped reader " << mappedProbe.GetTotal() << " s (including fiber bundle setup)");
+    MITK_TEST_CONDITION(fib->GetNumFibers() == static_cast<int>(numStreamlines), "All TrackVis streamlines are read");
+    MITK_TEST_CONDITION(AreEqual(reference, fib->GetFiberPolyData()), "TrackVis streamlines equal the previous reader");
+  }
+
+  itksys::SystemTools::RemoveFile(tckFile);
+  itksys::SystemTools::RemoveFile(trkFile);
+
+  MITK_TEST_END()
+}
@@ -42,6 +42,7 @@ set(H_FILES
   Algorithms/itkEvaluateTractogramDirectionsFilter.h
   Algorithms/itkFiberCurvatureFilter.h
   Algorithms/itkFitFibersToImageFilter.h
+  Algorithms/itkFitFibersSparseMatrix.h
   Algorithms/itkTractClusteringFilter.h
   Algorithms/itkFiberExtractionFilter.h
   Algorithms/itkTdiToVolumeFractionFilter.h
@@ -5,6 +5,7 @@ set(H_FILES
   itkShortestPathCostFunction.h
   itkShortestPathCostFunctionTbss.h
   itkShortestPathNode.h
+  itkShortestPathHeap.h
   itkShortestPathImageFilter.h
   itkShortestPathCostFunctionLiveWire.h
 )
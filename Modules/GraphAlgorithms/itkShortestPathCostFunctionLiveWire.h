@@ -39,6 +39,11 @@ namespace itk
   To compute  the costs of the gradient magnitude dynamically
   an iverted map of the histogram of gradient magnitude image is used.
 
+  The local costs only depend on the target pixel of a link. Initialize()
+  therefore computes them once for the whole image (cost image), GetCost()
+  only looks them up and scales them by the link length. The cost image is
+  reused until the image, the cost map or its usage changes.
+
   */
   template <class TInputImageType>
   class ITK_EXPORT ShortestPathCostFunctionLiveWire : public ShortestPathCostFunction<TInputImageType>
@@ -59,6 +64,7 @@ namespace itk
 
     typedef itk::Image<unsigned char, 2> UnsignedCharImageType;
     typedef itk::Image<float, 2> FloatImageType;
+    typedef itk::Image<double, 2> DoubleImageType;
 
     typedef float ComponentType;
     typedef itk::CovariantVector<ComponentType, 2> OutputPixelType;
@@ -100,14 +106,31 @@ namespace itk
       this->m_CostMap = costMap;
       this->m_UseCostMap = true;
       this->m_MaxMapCosts = -1;
+      this->m_CostImageInitialized = false;
       this->Modified();
     }
 
-    void SetUseCostMap(bool useCostMap) { this->m_UseCostMap = useCostMap; }
+    void SetUseCostMap(bool useCostMap)
+    {
+      if (this->m_UseCostMap != useCostMap)
+      {
+        this->m_UseCostMap = useCostMap;
+        this->m_CostImageInitialized = false;
+        this->Modified();
+      }
+    }
     /**
      \brief Set the maximum of the dynamic cost map to save computation time.
     */
-    void SetCostMapMaximum(double max) { this->m_MaxMapCosts = max; }
+    void SetCostMapMaximum(double max)
+    {
+      if (this->m_MaxMapCosts != max)
+      {
+        this->m_MaxMapCosts = max;
+        this->m_CostImageInitialized = false;
+        this->Modified();
+      }
+    }
     enum Constants
     {
       MAPSCALEFACTOR = 10
@@ -128,6 +151,8 @@ namespace itk
     const FloatImageType *GetGradientMagnitudeImage() { return this->m_GradientMagnitudeImage.GetPointer(); };
     const FloatImageType *GetEdgeImage() { return this->m_EdgeImage.GetPointer(); };
     const VectorOutputImageType *GetGradientImage() { return this->m_GradientImage.GetPointer(); };
+    /** \brief Local costs of all pixels (without link length), valid after Initialize() */
+    const DoubleImageType *GetCostImage() { return this->m_CostImage.GetPointer(); };
   protected:
     ShortestPathCostFunctionLiveWire();
 
@@ -137,6 +162,7 @@ namespace itk
     FloatImageType::Pointer m_EdgeImage;
     UnsignedCharImageType::Pointer m_MaskImage;
     VectorOutputImageType::Pointer m_GradientImage;
+    DoubleImageType::Pointer m_CostImage;
 
     double minCosts;
 
@@ -155,12 +181,20 @@ namespace itk
 
     bool m_Initialized;
 
+    bool m_CostImageInitialized;
+
     std::map<int, int> m_CostMap;
 
     bool m_UseCostMap;
 
     double m_MaxMapCosts;
 
+    /** \brief Computes the local costs of a pixel from gradient magnitude, gradient direction and edge image*/
+    double ComputeLocalCost(const IndexType &index);
+
+    /** \brief Fills m_CostImage with the local costs of all pixels*/
+    void ComputeCostImage();
+
   private:
     double SigmoidFunction(double I, double max, double min, double alpha, double beta);
   };
@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkCastImageFilter.h>
 #include <itkGradientImageFilter.h>
 #include <itkGradientMagnitudeImageFilter.h>
+#include <itkImageRegionIteratorWithIndex.h>
 #include <itkLaplacianImageFilter.h>
 #include <itkStatisticsImageFilter.h>
 #include <itkZeroCrossingImageFilter.h>
@@ -38,6 +39,7 @@ namespace itk
     m_UseRepulsivePoints = false;
     m_GradientMax = 0.0;
     m_Initialized = false;
+    m_CostImageInitialized = false;
     m_UseCostMap = false;
     m_MaxMapCosts = -1.0;
   }
@@ -47,12 +49,14 @@ namespace itk
   {
     this->m_MaskImage->SetPixel(index, 255);
     m_UseRepulsivePoints = true;
+    this->Modified();
   }
 
   template <class TInputImageType>
   void ShortestPathCostFunctionLiveWire<TInputImageType>::RemoveRepulsivePoint(const IndexType &index)
   {
     this->m_MaskImage->SetPixel(index, 0);
+    this->Modified();
   }
 
   template <class TInputImageType>
@@ -73,6 +77,7 @@ namespace itk
 
       this->Modified();
       this->m_Initialized = false;
+      this->m_CostImageInitialized = false;
     }
   }
 
@@ -81,18 +86,12 @@ namespace itk
   {
     m_UseRepulsivePoints = false;
     this->m_MaskImage->FillBuffer(0);
+    this->Modified();
   }
 
   template <class TInputImageType>
   double ShortestPathCostFunctionLiveWire<TInputImageType>::GetCost(IndexType p1, IndexType p2)
   {
-    // local component costs
-    // weights
-    double w1;
-    double w2;
-    double w3;
-    double costs = 0.0;
-
     // if we are on the mask, return asap
     if (m_UseRepulsivePoints)
     {
@@ -100,6 +99,37 @@ namespace itk
         return 1000;
     }
 
+    // local costs of the target pixel, precomputed in Initialize()
+    double costs = this->m_CostImage->GetPixel(p2);
+
+    // scale by euclidian distance
+    double costScale;
+    if (p1[0] == p2[0] || p1[1] == p2[1])
+    {
+      // horizontal or vertical neighbor
+      costScale = 1.0;
+    }
+    else
+    {
+      // diagonal neighbor
+      costScale = sqrt(2.0);
+    }
+
+    costs *= costScale;
+
+    return costs;
+  }
+
+  template <class TInputImageType>
+  double ShortestPathCostFunctionLiveWire<TInputImageType>::ComputeLocalCost(const IndexType &p2)
+  {
+    // local component costs
+    // weights
+    double w1;
+    double w2;
+    double w3;
+    double costs = 0.0;
+
     double gradientX, gradientY;
     gradientX = gradientY = 0.0;
 
@@ -276,22 +306,23 @@ namespace itk
     }
     costs = w1 * laplacianCost + w2 * gradientCost + w3 * gradientDirectionCost;
 
-    // scale by euclidian distance
-    double costScale;
-    if (p1[0] == p2[0] || p1[1] == p2[1])
-    {
-      // horizontal or vertical neighbor
-      costScale = 1.0;
-    }
-    else
+    return costs;
+  }
+
+  template <class TInputImageType>
+  void ShortestPathCostFunctionLiveWire<TInputImageType>::ComputeCostImage()
+  {
+    this->m_CostImage = DoubleImageType::New();
+    this->m_CostImage->CopyInformation(this->m_GradientMagnitudeImage);
+    this->m_CostImage->SetRegions(this->m_GradientMagnitudeImage->GetLargestPossibleRegion());
+    this->m_CostImage->Allocate();
+
+    itk::ImageRegionIteratorWithIndex<DoubleImageType> it(this->m_CostImage,
+                                                          this->m_CostImage->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
     {
-      // diagonal neighbor
-      costScale = sqrt(2.0);
+      it.Set(this->ComputeLocalCost(it.GetIndex()));
     }
-
-    costs *= costScale;
-
-    return costs;
   }
 
   template <class TInputImageType>
@@ -378,6 +409,14 @@ namespace itk
                       // but a different path.
 
       m_Initialized = true;
+      m_CostImageInitialized = false;
+    }
+
+    // the cost image is reused for all searches on this image, until the cost mapping changes
+    if (!m_CostImageInitialized)
+    {
+      this->ComputeCostImage();
+      m_CostImageInitialized = true;
     }
 
     // check start/end point value
@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __itkShortestPathHeap_h_
+#define __itkShortestPathHeap_h_
+
+#include "itkShortestPathNode.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace itk
+{
+  /** \brief Indexed d-ary min-heap of node numbers, used as frontier of ShortestPathImageFilter.
+
+  The heap remembers the position of every node it contains, so the key of a node can be
+  decreased in O(log_d n) without searching for the node (true decrease-key). A larger arity
+  makes the heap flatter, which pays off for the many decrease-key operations of Dijkstra on
+  image graphs.
+  */
+  template <unsigned int VArity = 4>
+  class ShortestPathHeap
+  {
+  public:
+    ShortestPathHeap() {}
+
+    // \brief Removes all nodes and prepares the position table for the given number of nodes
+    void Initialize(NodeNumType numberOfNodes)
+    {
+      m_Entries.clear();
+      m_Positions.assign(numberOfNodes, NotInHeap());
+    }
+
+    bool Empty() const { return m_Entries.empty(); }
+
+    std::size_t Size() const { return m_Entries.size(); }
+
+    bool Contains(NodeNumType node) const { return m_Positions[node] != NotInHeap(); }
+
+    // \brief Inserts a node that is not in the heap yet
+    void Push(NodeNumType node, DistanceType key)
+    {
+      Entry entry;
+      entry.key = key;
+      entry.node = node;
+      m_Entries.push_back(entry);
+      m_Positions[node] = static_cast<NodeNumType>(m_Entries.size() - 1);
+      this->SiftUp(m_Entries.size() - 1);
+    }
+
+    // \brief Lowers the key of a node that is in the heap
+    void DecreaseKey(NodeNumType node, DistanceType key)
+    {
+      const std::size_t position = m_Positions[node];
+      m_Entries[position].key = key;
+      this->SiftUp(position);
+    }
+
+    // \brief Node with the lowest key
+    NodeNumType Top() const { return m_Entries.front().node; }
+
+    // \brief Removes and returns the node with the lowest key
+    NodeNumType Pop()
+    {
+      const NodeNumType top = m_Entries.front().node;
+      m_Positions[top] = NotInHeap();
+
+      const Entry last = m_Entries.back();
+      m_Entries.pop_back();
+      if (!m_Entries.empty())
+      {
+        m_Entries.front() = last;
+        m_Positions[last.node] = 0;
+        this->SiftDown(0);
+      }
+      return top;
+    }
+
+  private:
+    struct Entry
+    {
+      DistanceType key;
+      NodeNumType node;
+    };
+
+    static NodeNumType NotInHeap() { return std::numeric_limits<NodeNumType>::max(); }
+
+    void SiftUp(std::size_t position)
+    {
+      const Entry entry = m_Entries[position];
+      while (position > 0)
+      {
+        const std::size_t parent = (position - 1) / VArity;
+        // note: the comparison is false for NaN keys, such nodes stay where they are
+        if (!(entry.key < m_Entries[parent].key))
+          break;
+        this->Place(position, m_Entries[parent]);
+        position = parent;
+      }
+      this->Place(position, entry);
+    }
+
+    void SiftDown(std::size_t position)
+    {
+      const Entry entry = m_Entries[position];
+      const std::size_t size = m_Entries.size();
+      while (true)
+      {
+        const std::size_t firstChild = position * VArity + 1;
+        if (firstChild >= size)
+          break;
+
+        std::size_t smallest = firstChild;
+        const std::size_t lastChild = std::min(firstChild + VArity, size);
+        for (std::size_t child = firstChild + 1; child < lastChild; ++child)
+        {
+          if (m_Entries[child].key < m_Entries[smallest].key)
+            smallest = child;
+        }
+
+        if (!(m_Entries[smallest].key < entry.key))
+          break;
+        this->Place(position, m_Entries[smallest]);
+        position = smallest;
+      }
+      this->Place(position, entry);
+    }
+
+    void Place(std::size_t position, const Entry &entry)
+    {
+      m_Entries[position] = entry;
+      m_Positions[entry.node] = static_cast<NodeNumType>(position);
+    }
+
+    std::vector<Entry> m_Entries;
+    std::vector<NodeNumType> m_Positions; // position of each node in m_Entries, NotInHeap() if not contained
+  };
+}
+
+#endif
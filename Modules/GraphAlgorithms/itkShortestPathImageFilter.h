@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkImageToImageFilter.h"
 #include "itkShortestPathCostFunction.h"
+#include "itkShortestPathHeap.h"
 #include "itkShortestPathNode.h"
 #include <itkImageRegionIteratorWithIndex.h>
 
@@ -39,6 +40,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 // for GetVectorOrderImage
 // void AddEndIndex(const IndexType & EndIndex) //Optional. By calling this function you can add several endpoints! The
 // algorithm will look for several shortest Pathes. From Start to all Endpoints.
+// void SetKeepShortestPathTree(bool) // Optional (default=false), keep the shortest path tree of the start point between
+// updates. Further updates with the same start point only extend the tree until the end point is reached or just trace
+// the path back (e.g. live wire, where only the end point follows the mouse).
 //
 /// GET FUNCTIONS
 // std::vector< itk::Index<3> > GetVectorPath(); // returns the shortest path as vector
@@ -133,6 +137,13 @@ namespace itk
     itkSetMacro(ActivateTimeOut, bool);
     itkGetMacro(ActivateTimeOut, bool);
 
+    // \brief (default=false), Keep the shortest path tree of the start point between updates. As long as the start
+    // point, the input and the cost function do not change, an update only continues the search until the end point is
+    // reached, or just traces the path back if it already is. The search is a plain Dijkstra in this mode (no A*
+    // estimate), since the end point changes between updates. Not used for multiple end points.
+    itkSetMacro(KeepShortestPathTree, bool);
+    itkGetMacro(KeepShortestPathTree, bool);
+
     // \brief returns shortest Path as vector
     std::vector<IndexType> GetVectorPath();
 
@@ -185,6 +196,13 @@ namespace itk
 
     bool m_ActivateTimeOut; // if true, then i search max. 30 secs. then abort
 
+    bool m_KeepShortestPathTree;
+    NodeNumType m_ShortestPathTreeStartNode; // start node of the kept tree
+    ModifiedTimeType m_ShortestPathTreeTime; // modification time of the inputs when the kept tree was started
+    bool m_ShortestPathTreeValid;
+
+    ShortestPathHeap<> m_Heap; // discovered, but not yet closed nodes
+
     bool m_Initialized;
 
     CostFunctionTypePointer m_CostFunction;
@@ -224,6 +242,9 @@ namespace itk
     // \brief Initializes the graph
     void InitGraph();
 
+    // \brief Returns true, if the kept shortest path tree belongs to the current start point, input and cost function
+    bool IsShortestPathTreeValid();
+
     // \brief Start ShortestPathSearch
     void StartShortestPathSearch();
   };
@@ -37,6 +37,10 @@ namespace itk
       m_CalcAllDistances(false),
       multipleEndPoints(false),
       m_ActivateTimeOut(false),
+      m_KeepShortestPathTree(false),
+      m_ShortestPathTreeStartNode(0),
+      m_ShortestPathTreeTime(0),
+      m_ShortestPathTreeValid(false),
       m_Initialized(false)
   {
     m_endPoints.clear();
@@ -419,6 +423,10 @@ namespace itk
     const typename TInputImageType::IndexType &a)
   {
     // Returns the minimal possible costs for a path from "a" to targetnode.
+    // A kept shortest path tree serves changing end points, so there is no target to estimate.
+    if (m_KeepShortestPathTree && !multipleEndPoints)
+      return 0.0;
+
     itk::Vector<float, 3> v;
     v[0] = m_EndIndex[0] - a[0];
     v[1] = m_EndIndex[1] - a[1];
@@ -445,27 +453,43 @@ namespace itk
       // Initialize mainNodeList with that number
       m_Nodes = new ShortestPathNode[m_Graph_NumberOfNodes];
 
-      // Initialize each node in nodelist
-      for (NodeNumType i = 0; i < m_Graph_NumberOfNodes; i++)
-      {
-        m_Nodes[i].distAndEst = -1;
-        m_Nodes[i].distance = -1;
-        m_Nodes[i].prevNode = -1;
-        m_Nodes[i].mainListIndex = i;
-        m_Nodes[i].closed = false;
-      }
-
       m_Initialized = true;
     }
 
+    // Initialize each node in nodelist
+    for (NodeNumType i = 0; i < m_Graph_NumberOfNodes; i++)
+    {
+      m_Nodes[i].distAndEst = -1;
+      m_Nodes[i].distance = -1;
+      m_Nodes[i].prevNode = -1;
+      m_Nodes[i].mainListIndex = i;
+      m_Nodes[i].closed = false;
+    }
+
     // In the beginning, the Startnode needs a distance of 0
     m_Nodes[m_Graph_StartNode].distance = 0;
     m_Nodes[m_Graph_StartNode].distAndEst = 0;
 
+    // At first, only startNote is discovered.
+    m_Heap.Initialize(m_Graph_NumberOfNodes);
+    m_Heap.Push(m_Graph_StartNode, m_Nodes[m_Graph_StartNode].distAndEst);
+
     // initalize cost function
     m_CostFunction->Initialize();
   }
 
+  template <class TInputImageType, class TOutputImageType>
+  bool ShortestPathImageFilter<TInputImageType, TOutputImageType>::IsShortestPathTreeValid()
+  {
+    if (!m_ShortestPathTreeValid || m_Nodes == nullptr || m_ShortestPathTreeStartNode != m_Graph_StartNode)
+      return false;
+
+    // repulsive points, cost maps etc. modify the cost function
+    ModifiedTimeType time = std::max(this->GetMTime(), m_CostFunction->GetMTime());
+    time = std::max(time, this->GetInput()->GetMTime());
+    return time <= m_ShortestPathTreeTime;
+  }
+
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::StartShortestPathSearch()
   {
@@ -478,45 +502,21 @@ namespace itk
     bool timeout = false;
     NodeNumType mainNodeListIndex = 0;
     DistanceType curNodeDistance = 0;
-    NodeNumType numberOfNodesChecked = 0;
-
-    // Create Multimap (tree structure for fast searching)
-    std::multimap<double, ShortestPathNode *> myMap;
-    std::pair<std::multimap<double, ShortestPathNode *>::iterator, std::multimap<double, ShortestPathNode *>::iterator>
-      ret;
-    std::multimap<double, ShortestPathNode *>::iterator it;
 
-    // At first, only startNote is discovered.
-    myMap.insert(
-      std::pair<double, ShortestPathNode *>(m_Nodes[m_Graph_StartNode].distAndEst, &m_Nodes[m_Graph_StartNode]));
+    // A kept shortest path tree may already contain the end node
+    if (!multipleEndPoints && !m_CalcAllDistances && m_Nodes[m_Graph_EndNode].closed)
+    {
+      return;
+    }
 
     // While there are discovered Nodes, pick the one with lowest distance,
     // update its neighbors and eventually delete it from the discovered Nodes list.
-    while (!myMap.empty())
+    while (!m_Heap.Empty())
     {
-      numberOfNodesChecked++;
-      /*if ( (numberOfNodesChecked % (m_Graph_NumberOfNodes/100)) == 0)
-      {
-        MITK_INFO << "Checked " << ( numberOfNodesChecked / (m_Graph_NumberOfNodes/100) ) << "% List: " << myMap.size()
-      << "\n";
-      }*/
-
-      // Get element with lowest score
-      mainNodeListIndex = myMap.begin()->second->mainListIndex;
-      curNodeDistance = myMap.begin()->second->distance;
-      myMap.begin()->second->closed = true; // close it
-
-      // Debug:
-      // MITK_INFO << "INFO: size " << myMap.size();
-      /*
-      for (it = myMap.begin(); it != myMap.end(); ++it)
-      {
-      MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-      }
-      */
-
-      // Kicks out element with lowest score
-      myMap.erase(myMap.begin());
+      // Get element with lowest score and kick it out of the heap
+      mainNodeListIndex = m_Heap.Pop();
+      curNodeDistance = m_Nodes[mainNodeListIndex].distance;
+      m_Nodes[mainNodeListIndex].closed = true; // close it
 
       // if wanted, store vector order
       if (m_StoreVectorOrder)
@@ -525,13 +525,13 @@ namespace itk
       }
 
       // Check neighbors
+      IndexType coordCurNode = NodeToCoord(mainNodeListIndex);
       std::vector<ShortestPathNode *> neighborNodes = GetNeighbors(mainNodeListIndex, m_Graph_fullNeighbors);
       for (NodeNumType i = 0; i < neighborNodes.size(); i++)
       {
         if (neighborNodes[i]->closed)
           continue; // this nodes is already closed, go to next neighbor
 
-        IndexType coordCurNode = NodeToCoord(mainNodeListIndex);
         IndexType coordNeighborNode = NodeToCoord(neighborNodes[i]->mainListIndex);
 
         // calculate the new Distance to the current neighbor
@@ -540,122 +540,18 @@ namespace itk
         // if it is shorter than any yet known path to this neighbor, than the current path is better. Save that!
         if ((newDistance < neighborNodes[i]->distance) || (neighborNodes[i]->distance == -1))
         {
-          // if that neighbornode is not in discoverednodeList yet, Push it there and update
-          if (neighborNodes[i]->distance == -1)
+          neighborNodes[i]->distance = newDistance;
+          neighborNodes[i]->distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
+          neighborNodes[i]->prevNode = mainNodeListIndex;
+
+          // if that neighbornode is not in the heap yet, push it there, otherwise move it up
+          if (m_Heap.Contains(neighborNodes[i]->mainListIndex))
           {
-            neighborNodes[i]->distance = newDistance;
-            neighborNodes[i]->distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
-            neighborNodes[i]->prevNode = mainNodeListIndex;
-            myMap.insert(std::pair<double, ShortestPathNode *>(m_Nodes[neighborNodes[i]->mainListIndex].distAndEst,
-                                                               &m_Nodes[neighborNodes[i]->mainListIndex]));
-            /*
-            MITK_INFO << "Inserted: " << m_Nodes[neighborNodes[i]->mainListIndex].distAndEst << "|" <<
-            m_Nodes[neighborNodes[i]->mainListIndex].mainListIndex;
-            MITK_INFO << "INFO: size " << myMap.size();
-            for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-            }
-            */
+            m_Heap.DecreaseKey(neighborNodes[i]->mainListIndex, neighborNodes[i]->distAndEst);
           }
-          // or if is already in discoverednodelist, update
           else
           {
-            /*
-            it = myMap.find(neighborNodes[i]->distAndEst);
-            if (it == myMap.end() )
-            {
-            MITK_INFO << "Nothing!";
-            // look further
-            for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            if ((*it).second->mainListIndex == lookForId)
-            {
-            MITK_INFO << "But it is there!!!";
-            MITK_INFO << "Searched for: " << lookFor << "   but had: " << (*it).second->distAndEst;
-            }
-
-            }
-            }
-            */
-
-            // 1st : find and delete old element
-            bool found = false;
-            ret = myMap.equal_range(neighborNodes[i]->distAndEst);
-
-            if ((ret.first == ret.second))
-            {
-              /*+++++++++++++ no exact match +++++++++++++*/
-              // MITK_INFO << "No exact match!"; // if this happens, you are screwed
-              /*
-              MITK_INFO << "Was looking for: " << lookFor << "  ID: " << lookForId;
-              if (ret.first != myMap.end() )
-              {
-              it = ret.first;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              ++it;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              --it;
-              --it;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              }
-
-              // look if that ID is found in the map
-              for (it = myMap.begin(); it != myMap.end(); ++it)
-              {
-              if ((*it).second->mainListIndex == lookForId)
-              {
-              MITK_INFO << "But it is there!!!";
-              MITK_INFO << "Searched dist: " << lookFor << "  found dist: " << (*it).second->distAndEst;
-              }
-
-              }
-              */
-            }
-            else
-            {
-              for (it = ret.first; it != ret.second; ++it)
-              {
-                if (it->second->mainListIndex == neighborNodes[i]->mainListIndex)
-                {
-                  found = true;
-                  myMap.erase(it);
-                  /*
-                  MITK_INFO << "INFO: size " << myMap.size();
-                  MITK_INFO << "Erase: " << it->first << "|" << it->second->mainListIndex;
-
-                  MITK_INFO << "INFO: size " << myMap.size();
-                  for (it = myMap.begin(); it != myMap.end(); ++it)
-                  {
-                  MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-                  }
-                  */
-                  break;
-                }
-              }
-            }
-
-            if (!found)
-            {
-              // MITK_INFO << "Could not find it! :(";
-              continue;
-            }
-
-            // 2nd: update and insert new element
-            neighborNodes[i]->distance = newDistance;
-            neighborNodes[i]->distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
-            neighborNodes[i]->prevNode = mainNodeListIndex;
-            // myMap.insert( std::pair<double,ShortestPathNode*> (neighborNodes[i]->distAndEst, neighborNodes[i]));
-            myMap.insert(std::pair<double, ShortestPathNode *>(m_Nodes[neighborNodes[i]->mainListIndex].distAndEst,
-                                                               &m_Nodes[neighborNodes[i]->mainListIndex]));
-
-            // MITK_INFO << "Re-Inserted: " << m_Nodes[neighborNodes[i]->mainListIndex].distAndEst << "|" <<
-            // m_Nodes[neighborNodes[i]->mainListIndex].mainListIndex;
-            // MITK_INFO << "INFO: size " << myMap.size();
-            /*for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-            }*/
+            m_Heap.Push(neighborNodes[i]->mainListIndex, neighborNodes[i]->distAndEst);
           }
         }
       }
@@ -864,13 +760,33 @@ namespace itk
 
     if (m_Nodes)
       delete[] m_Nodes;
+    m_Nodes = nullptr;
+    m_Initialized = false;
+    m_ShortestPathTreeValid = false;
   }
 
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::GenerateData()
   {
-    // Build Graph
-    InitGraph();
+    if (m_KeepShortestPathTree && !multipleEndPoints)
+    {
+      // Continue the kept tree, if it still belongs to the current start point, input and costs
+      m_CostFunction->Initialize();
+      if (!IsShortestPathTreeValid())
+      {
+        InitGraph();
+        m_ShortestPathTreeStartNode = m_Graph_StartNode;
+        m_ShortestPathTreeTime = std::max(this->GetMTime(), m_CostFunction->GetMTime());
+        m_ShortestPathTreeTime = std::max(m_ShortestPathTreeTime, this->GetInput()->GetMTime());
+        m_ShortestPathTreeValid = true;
+      }
+    }
+    else
+    {
+      // Build Graph
+      m_ShortestPathTreeValid = false;
+      InitGraph();
+    }
 
     // Calc Shortest Parth
     StartShortestPathSearch();
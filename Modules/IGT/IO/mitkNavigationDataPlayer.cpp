@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itksys/SystemTools.hxx>
 #include <mitkIGTTimeStamp.h>
 #include <fstream>
+#include <algorithm>
 
 #include "mitkIGTException.h"
 
@@ -37,6 +38,12 @@ mitk::NavigationDataPlayer::~NavigationDataPlayer()
 
 void mitk::NavigationDataPlayer::GenerateData()
 {
+  if (m_NavigationDataFile.IsNotNull())
+  {
+    this->GenerateDataFromFile();
+    return;
+  }
+
   if ( m_NavigationDataSet->Size() == 0 )
   {
     MITK_WARN << "Cannot do anything with empty set of navigation datas.";
@@ -90,6 +97,46 @@ void mitk::NavigationDataPlayer::GenerateData()
   }
 }
 
+void mitk::NavigationDataPlayer::GenerateDataFromFile()
+{
+  const unsigned int numberOfFrames = m_NavigationDataFile->GetNumberOfFrames();
+  if ( numberOfFrames == 0 )
+  {
+    MITK_WARN << "Cannot do anything with empty set of navigation datas.";
+    return;
+  }
+
+  //Only produce new output if the player is started
+  if (m_CurPlayerState != PlayerRunning)
+  {
+    //The output is not valid anymore
+    this->GraftEmptyOutput();
+    return;
+  }
+
+  // get elapsed time since start of playing
+  m_TimeStampSinceStart = mitk::IGTTimeStamp::GetInstance()->GetElapsed() - m_StartPlayingTimeStamp;
+
+  // same offset as for sets, the first frame is played immediately
+  TimeStampType timeStampSinceStartWithOffset = m_TimeStampSinceStart
+      + m_NavigationDataFile->GetTimeStamp(0);
+
+  // the last frame that is not later than the current time is found with a
+  // binary search, the player never goes back in time
+  m_CurrentFrame = std::max(m_CurrentFrame, m_NavigationDataFile->FindFrame(timeStampSinceStartWithOffset));
+
+  this->GraftFrameOfFile(m_CurrentFrame);
+
+  // stop playing if the last frame was grafted
+  if (m_CurrentFrame + 1 == numberOfFrames)
+  {
+    this->StopPlaying();
+
+    // start playing again if repeat is enabled
+    if ( m_Repeat ) { this->StartPlaying(); }
+  }
+}
+
 void mitk::NavigationDataPlayer::UpdateOutputInformation()
 {
   this->Modified();  // make sure that we need to be updated
@@ -103,7 +150,10 @@ void mitk::NavigationDataPlayer::StartPlaying()
 
   // set state and iterator for playing from start
   m_CurPlayerState = PlayerRunning;
-  m_NavigationDataSetIterator = m_NavigationDataSet->Begin();
+  if (m_NavigationDataFile.IsNotNull())
+    m_CurrentFrame = 0;
+  else
+    m_NavigationDataSetIterator = m_NavigationDataSet->Begin();
 
   // reset playing timestamps
   m_PauseTimeStamp = 0;
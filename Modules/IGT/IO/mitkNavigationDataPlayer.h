@@ -84,6 +84,11 @@ namespace mitk {
     */
     void GenerateData() override;
 
+    /**
+    * \brief GenerateData() for a mitk::NavigationDataBinaryFile, finds the current frame with a binary search.
+    */
+    void GenerateDataFromFile();
+
     PlayerState m_CurPlayerState;
 
     /**
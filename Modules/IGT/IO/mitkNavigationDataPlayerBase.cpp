@@ -20,7 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIGTException.h"
 
 mitk::NavigationDataPlayerBase::NavigationDataPlayerBase()
-  : m_Repeat(false)
+  : m_Repeat(false), m_CurrentFrame(0)
 {
   this->SetName("Navigation Data Player Source");
 }
@@ -37,30 +37,57 @@ void mitk::NavigationDataPlayerBase::UpdateOutputInformation()
 
 bool mitk::NavigationDataPlayerBase::IsAtEnd()
 {
+  if (m_NavigationDataFile.IsNotNull())
+    return m_CurrentFrame >= m_NavigationDataFile->GetNumberOfFrames();
+
   return m_NavigationDataSetIterator == m_NavigationDataSet->End();
 }
 
 void mitk::NavigationDataPlayerBase::SetNavigationDataSet(NavigationDataSet::Pointer navigationDataSet)
 {
+  m_NavigationDataFile = nullptr;
   m_NavigationDataSet = navigationDataSet;
   m_NavigationDataSetIterator = navigationDataSet->Begin();
 
   this->InitPlayer();
 }
 
+void mitk::NavigationDataPlayerBase::SetNavigationDataFile(NavigationDataBinaryFile::Pointer navigationDataFile)
+{
+  m_NavigationDataSet = nullptr;
+  m_NavigationDataFile = navigationDataFile;
+  m_CurrentFrame = 0;
+
+  this->InitPlayer();
+}
+
 unsigned int mitk::NavigationDataPlayerBase::GetNumberOfSnapshots()
 {
+  if (m_NavigationDataFile.IsNotNull())
+    return m_NavigationDataFile->GetNumberOfFrames();
+
   return m_NavigationDataSet.IsNull() ? 0 : m_NavigationDataSet->Size();
 }
 
 unsigned int mitk::NavigationDataPlayerBase::GetCurrentSnapshotNumber()
 {
+  if (m_NavigationDataFile.IsNotNull())
+    return m_CurrentFrame;
+
   return m_NavigationDataSet.IsNull() ? 0 : m_NavigationDataSetIterator - m_NavigationDataSet->Begin();
 }
 
+unsigned int mitk::NavigationDataPlayerBase::GetNumberOfTools()
+{
+  if (m_NavigationDataFile.IsNotNull())
+    return m_NavigationDataFile->GetNumberOfTools();
+
+  return m_NavigationDataSet.IsNull() ? 0 : m_NavigationDataSet->GetNumberOfTools();
+}
+
 void mitk::NavigationDataPlayerBase::InitPlayer()
 {
-  if ( m_NavigationDataSet.IsNull() )
+  if ( m_NavigationDataSet.IsNull() && m_NavigationDataFile.IsNull() )
   {
     mitkThrowException(mitk::IGTException)
       << "NavigationDataSet has to be set before initializing player.";
@@ -68,7 +95,7 @@ void mitk::NavigationDataPlayerBase::InitPlayer()
 
   if (GetNumberOfOutputs() == 0)
   {
-    unsigned int requiredOutputs = m_NavigationDataSet->GetNumberOfTools();
+    unsigned int requiredOutputs = this->GetNumberOfTools();
     this->SetNumberOfRequiredOutputs(requiredOutputs);
 
     for (unsigned int n = this->GetNumberOfOutputs(); n < requiredOutputs; ++n)
@@ -78,7 +105,7 @@ void mitk::NavigationDataPlayerBase::InitPlayer()
       this->Modified();
     }
   }
-  else if (GetNumberOfOutputs() != m_NavigationDataSet->GetNumberOfTools())
+  else if (GetNumberOfOutputs() != this->GetNumberOfTools())
   {
     mitkThrowException(mitk::IGTException)
       << "Number of tools cannot be changed in existing player. Please create "
@@ -91,7 +118,7 @@ void mitk::NavigationDataPlayerBase::InitPlayer()
 
 void mitk::NavigationDataPlayerBase::GraftEmptyOutput()
 {
-  for (unsigned int index = 0; index < m_NavigationDataSet->GetNumberOfTools(); index++)
+  for (unsigned int index = 0; index < this->GetNumberOfTools(); index++)
   {
     mitk::NavigationData* output = this->GetOutput(index);
     assert(output);
@@ -108,3 +135,14 @@ void mitk::NavigationDataPlayerBase::GraftEmptyOutput()
     output->Graft(nd);
   }
 }
+
+void mitk::NavigationDataPlayerBase::GraftFrameOfFile(unsigned int frame)
+{
+  for (unsigned int index = 0; index < this->GetNumberOfOutputs(); index++)
+  {
+    mitk::NavigationData* output = this->GetOutput(index);
+    if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
+
+    m_NavigationDataFile->GetNavigationData(frame, index, output);
+  }
+}
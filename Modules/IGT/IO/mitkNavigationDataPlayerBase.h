@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkNavigationDataSource.h"
 #include "mitkNavigationDataSet.h"
+#include "mitkNavigationDataBinaryFormat.h"
 
 namespace mitk{
   /**
@@ -28,6 +29,10 @@ namespace mitk{
   * Each subclass has to check the state of m_Repeat and do or do not repeat
   * the playing accordingly.
   *
+  * Instead of a set, a mitk::NavigationDataBinaryFile can be played. Its frames
+  * are copied into the outputs directly from the mapped file, so long recordings
+  * do not have to be loaded into memory.
+  *
   * \ingroup IGT
   */
   class MITKIGT_EXPORT NavigationDataPlayerBase
@@ -63,6 +68,15 @@ namespace mitk{
     */
     void SetNavigationDataSet(NavigationDataSet::Pointer navigationDataSet);
 
+    itkGetMacro(NavigationDataFile, NavigationDataBinaryFile::Pointer)
+
+    /**
+    * \brief Set an opened mitk::NavigationDataBinaryFile for playing, replaces a set.
+    * Player is initialized by call to mitk::NavigationDataPlayerBase::InitPlayer()
+    * inside this method.
+    */
+    void SetNavigationDataFile(NavigationDataBinaryFile::Pointer navigationDataFile);
+
     /**
     * \brief Getter for the size of the mitk::NavigationDataSet used in this object.
     *
@@ -101,6 +115,16 @@ namespace mitk{
     */
     void GraftEmptyOutput();
 
+    /**
+    * \brief Returns the number of tools of the set or the file that is played.
+    */
+    unsigned int GetNumberOfTools();
+
+    /**
+    * \brief Copies the given frame of m_NavigationDataFile into the outputs.
+    */
+    void GraftFrameOfFile(unsigned int frame);
+
     /**
     * \brief If the player should repeat outputs. Default is false.
     */
@@ -112,6 +136,13 @@ namespace mitk{
     * \brief Iterator always points to the NavigationData object which is in the outputs at the moment.
     */
     mitk::NavigationDataSet::NavigationDataSetConstIterator m_NavigationDataSetIterator;
+
+    NavigationDataBinaryFile::Pointer m_NavigationDataFile;
+
+    /**
+    * \brief Frame of m_NavigationDataFile which is in the outputs at the moment.
+    */
+    unsigned int m_CurrentFrame;
   };
 } // namespace mitk
 
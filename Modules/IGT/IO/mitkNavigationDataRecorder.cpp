@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkNavigationDataRecorder.h"
 #include <mitkIGTTimeStamp.h>
+#include <mitkIGTException.h>
 
 mitk::NavigationDataRecorder::NavigationDataRecorder()
 {
@@ -25,6 +26,11 @@ mitk::NavigationDataRecorder::NavigationDataRecorder()
   m_StandardizedTimeInitialized = false;
   m_RecordCountLimit = -1;
   m_RecordOnlyValidData = false;
+  m_NumberOfRecordedFrames = 0;
+  m_NumberOfFramesInSet = 0;
+  m_KeepRecordedDataInMemory = true;
+  m_OverwriteRecordingFile = false;
+  m_RecordingFileFinished = false;
 }
 
 mitk::NavigationDataRecorder::~NavigationDataRecorder()
@@ -34,16 +40,13 @@ mitk::NavigationDataRecorder::~NavigationDataRecorder()
 
 void mitk::NavigationDataRecorder::GenerateData()
 {
-  // get each input, lookup the associated BaseData and transfer the data
-  DataObjectPointerArray inputs = this->GetIndexedInputs(); //get all inputs
-
-  //This vector will hold the NavigationDatas that are copied from the inputs
-  std::vector< mitk::NavigationData::Pointer > clonedDatas;
+  // no DataObjectPointerArray here, GenerateData() must not allocate memory
+  const unsigned int numberOfInputs = this->GetNumberOfIndexedInputs();
 
   bool atLeastOneInputIsInvalid = false;
 
   // For each input
-  for (unsigned int index=0; index < inputs.size(); index++)
+  for (unsigned int index=0; index < numberOfInputs; index++)
   {
     // First copy input to output
     this->GetOutput(index)->Graft(this->GetInput(index));
@@ -55,29 +58,125 @@ void mitk::NavigationDataRecorder::GenerateData()
     {
        atLeastOneInputIsInvalid = true;
     }
-
-    // Clone a Navigation Data
-    mitk::NavigationData::Pointer clone = mitk::NavigationData::New();
-    clone->Graft(this->GetInput(index));
-    clonedDatas.push_back(clone);
-
-    if (m_StandardizeTime)
-    {
-      mitk::NavigationData::TimeStampType igtTimestamp = mitk::IGTTimeStamp::GetInstance()->GetElapsed(this);
-      clonedDatas[index]->SetIGTTimeStamp(igtTimestamp);
-    }
   }
 
   // if limitation is set and has been reached, stop recording
-  if ((m_RecordCountLimit > 0) && (m_NavigationDataSet->Size() >= static_cast<unsigned int>(m_RecordCountLimit)))
+  if ((m_RecordCountLimit > 0) && (m_NumberOfRecordedFrames >= static_cast<unsigned int>(m_RecordCountLimit)))
     m_Recording = false;
   // We can skip the rest of the method, if recording is deactivated
   if (!m_Recording) return;
   // We can skip the rest of the method, if we read only valid data
   if (m_RecordOnlyValidData && atLeastOneInputIsInvalid) return;
 
-  // Add data to set
-  m_NavigationDataSet->AddNavigationDatas(clonedDatas);
+  const unsigned int numberOfTools = m_NavigationDataSet->GetNumberOfTools();
+  if (numberOfInputs != numberOfTools)
+  {
+    MITK_WARN("NavigationDataSet") << "Tried to add too many or too few navigation Datas to NavigationDataSet. " << numberOfTools << " required, tried to add " << numberOfInputs << ".";
+    return;
+  }
+
+  // the buffers only grow when the number of tools changed
+  m_TimeStamps.resize(numberOfTools);
+  m_Frame.resize(numberOfTools);
+  for (unsigned int index = 0; index < numberOfTools; index++)
+  {
+    m_Frame[index] = this->GetInput(index);
+    m_TimeStamps[index] = m_StandardizeTime ? mitk::IGTTimeStamp::GetInstance()->GetElapsed(this) : m_Frame[index]->GetIGTTimeStamp();
+
+    // same rule as in NavigationDataSet::AddNavigationDatas()
+    if (m_NumberOfRecordedFrames > 0 && m_TimeStamps[index] <= m_LastTimeStamps[index])
+    {
+      MITK_WARN("NavigationDataSet") << "IGTTimeStamp of new NavigationData should be newer than timestamp of last NavigationData.";
+      return;
+    }
+  }
+  m_LastTimeStamps.swap(m_TimeStamps);
+
+  if (m_NumberOfRecordedFrames == 0)
+  {
+    m_ToolNames.clear();
+    for (unsigned int index = 0; index < numberOfTools; index++)
+      m_ToolNames.push_back(m_Frame[index]->GetName());
+  }
+
+  if (m_KeepRecordedDataInMemory)
+  {
+    const unsigned int segment = m_NumberOfRecordedFrames / FramesPerSegment;
+    if (segment == m_Segments.size())
+      m_Segments.push_back(std::vector<RecordedSample>());
+    // segments of a previous recording are reused
+    if (m_Segments[segment].size() < FramesPerSegment * numberOfTools)
+      m_Segments[segment].resize(FramesPerSegment * numberOfTools);
+
+    RecordedSample* samples = &m_Segments[segment][(m_NumberOfRecordedFrames % FramesPerSegment) * numberOfTools];
+    for (unsigned int index = 0; index < numberOfTools; index++)
+    {
+      const mitk::NavigationData* nd = m_Frame[index];
+      samples[index].TimeStamp = m_LastTimeStamps[index];
+      samples[index].Position = nd->GetPosition();
+      samples[index].Orientation = nd->GetOrientation();
+      samples[index].CovErrorMatrix = nd->GetCovErrorMatrix();
+      samples[index].DataValid = nd->IsDataValid();
+      samples[index].HasPosition = nd->GetHasPosition();
+      samples[index].HasOrientation = nd->GetHasOrientation();
+    }
+  }
+
+  if (!m_RecordingFileName.empty())
+  {
+    if (m_RecordingFileWriter.IsNull())
+      m_RecordingFileWriter = mitk::NavigationDataBinaryWriter::New();
+    // ResetRecording() while recording closes the file, do not truncate it here
+    if (!m_RecordingFileWriter->IsOpen() && m_RecordingFileFinished && !m_OverwriteRecordingFile)
+    {
+      if (m_NumberOfRecordedFrames == 0)
+        MITK_WARN("NavigationDataRecorder") << "Recording file " << m_RecordingFileName << " was already written, frames are not written to it again.";
+    }
+    else
+    {
+      if (!m_RecordingFileWriter->IsOpen())
+      {
+        m_RecordingFileWriter->Open(m_RecordingFileName, m_ToolNames);
+        m_RecordingFileFinished = false;
+      }
+      m_RecordingFileWriter->AddFrame(m_Frame.data(), m_LastTimeStamps.data());
+    }
+  }
+
+  ++m_NumberOfRecordedFrames;
+}
+
+mitk::NavigationDataSet::Pointer mitk::NavigationDataRecorder::GetNavigationDataSet()
+{
+  this->AddRecordedFramesToNavigationDataSet();
+  return m_NavigationDataSet;
+}
+
+void mitk::NavigationDataRecorder::AddRecordedFramesToNavigationDataSet()
+{
+  if (m_NavigationDataSet.IsNull() || !m_KeepRecordedDataInMemory)
+    return;
+
+  const unsigned int numberOfTools = m_NavigationDataSet->GetNumberOfTools();
+  std::vector<mitk::NavigationData::Pointer> navigationDatas(numberOfTools);
+  for (; m_NumberOfFramesInSet < m_NumberOfRecordedFrames; ++m_NumberOfFramesInSet)
+  {
+    const RecordedSample* samples = &m_Segments[m_NumberOfFramesInSet / FramesPerSegment][(m_NumberOfFramesInSet % FramesPerSegment) * numberOfTools];
+    for (unsigned int index = 0; index < numberOfTools; index++)
+    {
+      mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+      nd->SetIGTTimeStamp(samples[index].TimeStamp);
+      nd->SetPosition(samples[index].Position);
+      nd->SetOrientation(samples[index].Orientation);
+      nd->SetCovErrorMatrix(samples[index].CovErrorMatrix);
+      nd->SetDataValid(samples[index].DataValid);
+      nd->SetHasPosition(samples[index].HasPosition);
+      nd->SetHasOrientation(samples[index].HasOrientation);
+      nd->SetName(m_ToolNames[index]);
+      navigationDatas[index] = nd;
+    }
+    m_NavigationDataSet->AddNavigationDatas(navigationDatas);
+  }
 }
 
 void mitk::NavigationDataRecorder::StartRecording()
@@ -87,6 +186,11 @@ void mitk::NavigationDataRecorder::StartRecording()
     MITK_WARN << "Already recording please stop before start new recording session";
     return;
   }
+  if (!m_RecordingFileName.empty() && m_RecordingFileFinished && !m_OverwriteRecordingFile)
+  {
+    mitkThrowException(mitk::IGTException) << "Recording file " << m_RecordingFileName
+      << " was already written. Set a new file name or allow overwriting it.";
+  }
   m_Recording = true;
 
   // The first time this StartRecording is called, we initialize the standardized time.
@@ -106,11 +210,22 @@ void mitk::NavigationDataRecorder::StopRecording()
     return;
   }
   m_Recording = false;
+
+  if (m_RecordingFileWriter.IsNotNull())
+    m_RecordingFileWriter->Flush();
 }
 
 void mitk::NavigationDataRecorder::ResetRecording()
 {
   m_NavigationDataSet = mitk::NavigationDataSet::New(GetNumberOfIndexedInputs());
+  m_NumberOfRecordedFrames = 0;
+  m_NumberOfFramesInSet = 0;
+
+  if (m_RecordingFileWriter.IsNotNull() && m_RecordingFileWriter->IsOpen())
+  {
+    m_RecordingFileWriter->Close();
+    m_RecordingFileFinished = true;
+  }
 
   if (m_Recording)
   {
@@ -119,7 +234,18 @@ void mitk::NavigationDataRecorder::ResetRecording()
   }
 }
 
+void mitk::NavigationDataRecorder::SetRecordingFileName(const std::string& fileName)
+{
+  if (fileName == m_RecordingFileName)
+    return;
+  if (m_RecordingFileWriter.IsNotNull() && m_RecordingFileWriter->IsOpen())
+    m_RecordingFileWriter->Close();
+  m_RecordingFileName = fileName;
+  m_RecordingFileFinished = false;
+  this->Modified();
+}
+
 int mitk::NavigationDataRecorder::GetNumberOfRecordedSteps()
 {
-  return m_NavigationDataSet->Size();
-}
\ No newline at end of file
+  return m_NumberOfRecordedFrames;
+}
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNavigationDataToNavigationDataFilter.h"
 #include "mitkNavigationData.h"
 #include "mitkNavigationDataSet.h"
+#include "mitkNavigationDataBinaryFormat.h"
 
 namespace mitk
 {
@@ -31,6 +32,12 @@ namespace mitk
   * With StopRecording() the stream is stopped, but can be resumed anytime.
   * To start recording to a new NavigationDataSet, call ResetRecording();
   *
+  * Update() copies the recorded values into preallocated segments of plain
+  * samples. The mitk::NavigationData objects of the NavigationDataSet are only
+  * created when GetNavigationDataSet() is called. If a recording file name is
+  * set, the frames are also written to that file in the binary format of
+  * mitk::NavigationDataBinaryFormat while recording.
+  *
   * \warning Do not add inputs while the recorder ist recording. The recorder can't handle that and will cause a nullpointer exception.
   * \ingroup IGT
   */
@@ -51,8 +58,35 @@ namespace mitk
 
     /**
     * \brief Returns the set that contains all of the recorded data.
+    *
+    * Frames that were recorded since the last call are added to the set here.
+    */
+    virtual mitk::NavigationDataSet::Pointer GetNavigationDataSet();
+
+    /**
+    * \brief If not empty, recorded frames are written to this file in the binary format while recording.
+    *
+    * The file is created with the first recorded frame, flushed by StopRecording()
+    * and closed by ResetRecording(). A closed file is not overwritten by a following
+    * recording: set a new file name or call OverwriteRecordingFileOn() before StartRecording().
+    */
+    virtual void SetRecordingFileName(const std::string& fileName);
+    itkGetMacro(RecordingFileName, std::string);
+
+    /**
+    * \brief If set to true, a recording after ResetRecording() truncates the closed recording file
+    * instead of refusing to start. Default is false.
+    */
+    itkSetMacro(OverwriteRecordingFile, bool);
+    itkGetMacro(OverwriteRecordingFile, bool);
+    itkBooleanMacro(OverwriteRecordingFile);
+
+    /**
+    * \brief If set to false, frames are only written to the recording file and
+    * GetNavigationDataSet() returns an empty set. Default is true.
     */
-    itkGetMacro(NavigationDataSet, mitk::NavigationDataSet::Pointer);
+    itkSetMacro(KeepRecordedDataInMemory, bool);
+    itkGetMacro(KeepRecordedDataInMemory, bool);
 
     /**
     * \brief Sets a limit of recorded data sets / frames. Recording will be stopped if the number is reached. values < 1 disable this behaviour. Default is -1.
@@ -83,6 +117,9 @@ namespace mitk
 
     /**
     * \brief Starts recording NavigationData into the NAvigationDataSet
+    *
+    * \throws mitk::IGTException if the recording file was closed by ResetRecording() and
+    * neither a new file name was set nor overwriting is allowed.
     */
     virtual void StartRecording();
 
@@ -128,6 +165,44 @@ namespace mitk
     int m_RecordCountLimit; ///< limits the number of frames, recording will be stopped if the limit is reached. -1 disables the limit
 
     bool m_RecordOnlyValidData; //< indicates whether only valid data is recorded
+
+    /**
+    * \brief Recorded values of one tool in one frame
+    */
+    struct RecordedSample
+    {
+      NavigationData::TimeStampType TimeStamp;
+      NavigationData::PositionType Position;
+      NavigationData::OrientationType Orientation;
+      NavigationData::CovarianceMatrixType CovErrorMatrix;
+      bool DataValid;
+      bool HasPosition;
+      bool HasOrientation;
+    };
+
+    /**
+    * \brief Adds the frames that were recorded since the last call to m_NavigationDataSet
+    */
+    void AddRecordedFramesToNavigationDataSet();
+
+    static const unsigned int FramesPerSegment = 1024;
+
+    /** segments of FramesPerSegment frames, the samples of one frame are stored consecutively. They are kept on ResetRecording(). */
+    std::vector< std::vector<RecordedSample> > m_Segments;
+
+    unsigned int m_NumberOfRecordedFrames; ///< frames recorded since the last reset
+    unsigned int m_NumberOfFramesInSet; ///< frames that were already added to m_NavigationDataSet
+
+    std::vector<NavigationData::TimeStampType> m_TimeStamps; ///< time stamps of the frame that is recorded
+    std::vector<NavigationData::TimeStampType> m_LastTimeStamps; ///< time stamps of the last recorded frame
+    std::vector<const NavigationData*> m_Frame; ///< inputs of the frame that is recorded
+    std::vector<std::string> m_ToolNames; ///< tool names taken from the first recorded frame
+
+    std::string m_RecordingFileName;
+    bool m_KeepRecordedDataInMemory;
+    bool m_OverwriteRecordingFile;
+    bool m_RecordingFileFinished; ///< true if the recording file was closed by ResetRecording() and not renamed since
+    NavigationDataBinaryWriter::Pointer m_RecordingFileWriter;
   };
 }
 #endif // #define _MITK_POINT_SET_SOURCE_H
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itksys/SystemTools.hxx> //for the pause
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 
 //Exceptions
 #include "mitkIGTException.h"
@@ -41,14 +42,56 @@ void mitk::NavigationDataSequentialPlayer::GoToSnapshot(unsigned int i)
   }
 
   // set iterator to given position (modulo for allowing repeat)
-  m_NavigationDataSetIterator = m_NavigationDataSet->Begin() + ( i % this->GetNumberOfSnapshots() );
+  if (m_NavigationDataFile.IsNotNull())
+    m_CurrentFrame = i % this->GetNumberOfSnapshots();
+  else
+    m_NavigationDataSetIterator = m_NavigationDataSet->Begin() + ( i % this->GetNumberOfSnapshots() );
 
   // set outputs to selected snapshot
   this->GenerateData();
 }
 
+mitk::NavigationData::TimeStampType mitk::NavigationDataSequentialPlayer::GetTimeStampOfSnapshot(unsigned int i)
+{
+  if (this->GetNumberOfSnapshots() <= i)
+  {
+    mitkThrowException(mitk::IGTException) << "Snapshot " << i << " does not exist!";
+  }
+
+  if (m_NavigationDataFile.IsNotNull())
+    return m_NavigationDataFile->GetTimeStamp(i);
+
+  return m_NavigationDataSet->GetNavigationDataForIndex(i, 0)->GetIGTTimeStamp();
+}
+
+void mitk::NavigationDataSequentialPlayer::GoToTimeStamp(mitk::NavigationData::TimeStampType timeStamp)
+{
+  if (this->GetNumberOfSnapshots() == 0)
+  {
+    mitkThrowException(mitk::IGTException) << "Cannot go to a time stamp of an empty NavigationDataSet!";
+  }
+
+  if (m_NavigationDataFile.IsNotNull())
+  {
+    m_CurrentFrame = m_NavigationDataFile->FindFrame(timeStamp);
+  }
+  else
+  {
+    // the time stamps of a set are increasing as well
+    auto next = std::upper_bound(m_NavigationDataSet->Begin(), m_NavigationDataSet->End(), timeStamp,
+      [](mitk::NavigationData::TimeStampType t, const std::vector<mitk::NavigationData::Pointer>& step)
+      { return t < step.at(0)->GetIGTTimeStamp(); });
+    m_NavigationDataSetIterator = next == m_NavigationDataSet->Begin() ? next : next - 1;
+  }
+
+  this->GenerateData();
+}
+
 bool mitk::NavigationDataSequentialPlayer::GoToNextSnapshot()
 {
+  if (m_NavigationDataFile.IsNotNull())
+    return this->GoToNextFrameOfFile();
+
   if (m_NavigationDataSetIterator == m_NavigationDataSet->End())
   {
     MITK_WARN("NavigationDataSequentialPlayer") << "Cannot go to next snapshot, already at end of NavigationDataset. Ignoring...";
@@ -71,8 +114,41 @@ bool mitk::NavigationDataSequentialPlayer::GoToNextSnapshot()
   return true;
 }
 
+bool mitk::NavigationDataSequentialPlayer::GoToNextFrameOfFile()
+{
+  if (this->IsAtEnd())
+  {
+    MITK_WARN("NavigationDataSequentialPlayer") << "Cannot go to next snapshot, already at end of NavigationDataset. Ignoring...";
+    return false;
+  }
+  ++m_CurrentFrame;
+  if (this->IsAtEnd())
+  {
+    if ( m_Repeat )
+    {
+      // set data back to start if repeat is enabled
+      m_CurrentFrame = 0;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  this->GenerateData();
+  return true;
+}
+
 void mitk::NavigationDataSequentialPlayer::GenerateData()
 {
+  if (m_NavigationDataFile.IsNotNull())
+  {
+    if (this->IsAtEnd())
+      this->GraftEmptyOutput();
+    else
+      this->GraftFrameOfFile(m_CurrentFrame);
+    return;
+  }
+
   if ( m_NavigationDataSetIterator == m_NavigationDataSet->End() )
   {
     // no more data available
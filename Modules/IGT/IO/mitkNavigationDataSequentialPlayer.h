@@ -57,6 +57,20 @@ namespace mitk
     */
     bool GoToNextSnapshot();
 
+    /**
+    * \brief Returns the time stamp of the first tool in the i-th snapshot.
+    */
+    mitk::NavigationData::TimeStampType GetTimeStampOfSnapshot(unsigned int i);
+
+    /**
+    * \brief Advance the output to the last snapshot whose time stamp of the
+    * first tool is not later than the given one, or to the first snapshot.
+    *
+    * Takes O(log n) when a mitk::NavigationDataBinaryFile is played.
+    * Filter output is updated inside the function.
+    */
+    void GoToTimeStamp(mitk::NavigationData::TimeStampType timeStamp);
+
     /**
     * \brief Used for pipeline update just to tell the pipeline
     * that we always have to update
@@ -73,6 +87,11 @@ namespace mitk
     * for generating next data.
     */
     void GenerateData() override;
+
+    /**
+    * \brief GoToNextSnapshot() for a mitk::NavigationDataBinaryFile
+    */
+    bool GoToNextFrameOfFile();
   };
 } // namespace mitk
 
@@ -0,0 +1,238 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkNavigationDataBinaryFormat.h>
+#include <mitkNavigationDataRecorder.h>
+#include <mitkNavigationDataSequentialPlayer.h>
+#include <mitkNavigationDataSet.h>
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include <mitkIOUtil.h>
+
+#include <cstdio>
+#include <fstream>
+
+//for exceptions
+#include "mitkIGTException.h"
+#include "mitkIGTIOException.h"
+
+class mitkNavigationDataBinaryFormatTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNavigationDataBinaryFormatTestSuite);
+  MITK_TEST(TestRecordToFile);
+  MITK_TEST(TestRecordingFileNotOverwritten);
+  MITK_TEST(TestReadWriteSet);
+  MITK_TEST(TestFindFrame);
+  MITK_TEST(TestPlayFile);
+  MITK_TEST(TestTruncatedFile);
+  MITK_TEST(TestInvalidFile);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::NavigationDataSet::Pointer m_NavigationDataSet;
+  std::string m_FileName;
+
+public:
+
+  void setUp() override
+  {
+    std::string path = GetTestDataFilePath("IGT-Data/RecordedNavigationData.xml");
+    m_NavigationDataSet = dynamic_cast<mitk::NavigationDataSet*> (mitk::IOUtil::Load(path)[0].GetPointer());
+    m_FileName = mitk::IOUtil::CreateTemporaryFile("NavigationDataBinaryFormatTest_XXXXXX.ndb");
+  }
+
+  void tearDown() override
+  {
+    std::remove(m_FileName.c_str());
+  }
+
+  void TestRecordToFile()
+  {
+    mitk::NavigationDataSequentialPlayer::Pointer player = mitk::NavigationDataSequentialPlayer::New();
+    player->SetNavigationDataSet(m_NavigationDataSet);
+
+    mitk::NavigationDataRecorder::Pointer recorder = mitk::NavigationDataRecorder::New();
+    recorder->SetStandardizeTime(false);
+    recorder->SetRecordingFileName(m_FileName);
+    recorder->ConnectTo(player);
+
+    recorder->StartRecording();
+    while (!player->IsAtEnd())
+    {
+      recorder->Update();
+      player->GoToNextSnapshot();
+    }
+    recorder->StopRecording();
+
+    CPPUNIT_ASSERT_MESSAGE("Test if the set of the recorder is complete", CompareToReference(recorder->GetNavigationDataSet()));
+
+    mitk::NavigationDataBinaryFile::Pointer file = mitk::NavigationDataBinaryFile::New();
+    file->Open(m_FileName);
+    CPPUNIT_ASSERT_MESSAGE("Test if the recording file is complete after StopRecording()", CompareToReference(file->CreateNavigationDataSet()));
+  }
+
+  void TestRecordingFileNotOverwritten()
+  {
+    mitk::NavigationDataSequentialPlayer::Pointer player = mitk::NavigationDataSequentialPlayer::New();
+    player->SetNavigationDataSet(m_NavigationDataSet);
+
+    mitk::NavigationDataRecorder::Pointer recorder = mitk::NavigationDataRecorder::New();
+    recorder->SetStandardizeTime(false);
+    recorder->SetRecordingFileName(m_FileName);
+    recorder->ConnectTo(player);
+
+    recorder->StartRecording();
+    recorder->Update();
+    recorder->StopRecording();
+    recorder->ResetRecording();
+
+    CPPUNIT_ASSERT_THROW_MESSAGE("Test if a written recording file is not truncated by a new recording",
+      recorder->StartRecording(), mitk::IGTException);
+
+    recorder->OverwriteRecordingFileOn();
+    CPPUNIT_ASSERT_NO_THROW_MESSAGE("Test if overwriting can be allowed", recorder->StartRecording());
+    recorder->StopRecording();
+    recorder->ResetRecording();
+
+    recorder->OverwriteRecordingFileOff();
+    std::string otherFileName = mitk::IOUtil::CreateTemporaryFile("NavigationDataBinaryFormatTest_XXXXXX.ndb");
+    recorder->SetRecordingFileName(otherFileName);
+    CPPUNIT_ASSERT_NO_THROW_MESSAGE("Test if recording to a new file is possible", recorder->StartRecording());
+    recorder->StopRecording();
+    std::remove(otherFileName.c_str());
+  }
+
+  void TestReadWriteSet()
+  {
+    mitk::IOUtil::Save(m_NavigationDataSet, m_FileName);
+    mitk::NavigationDataSet::Pointer loaded = mitk::IOUtil::Load<mitk::NavigationDataSet>(m_FileName);
+
+    CPPUNIT_ASSERT_MESSAGE("Test if a written and read set equals the original", CompareToReference(loaded));
+  }
+
+  void TestFindFrame()
+  {
+    WriteReference(7);
+    mitk::NavigationDataBinaryFile::Pointer file = mitk::NavigationDataBinaryFile::New();
+    file->Open(m_FileName);
+
+    CPPUNIT_ASSERT_EQUAL(m_NavigationDataSet->Size(), file->GetNumberOfFrames());
+    CPPUNIT_ASSERT_EQUAL(0u, file->FindFrame(file->GetTimeStamp(0) - 1.0));
+    for (unsigned int frame = 0; frame < file->GetNumberOfFrames(); ++frame)
+    {
+      CPPUNIT_ASSERT_EQUAL(frame, file->FindFrame(file->GetTimeStamp(frame)));
+      if (frame + 1 < file->GetNumberOfFrames())
+      {
+        mitk::NavigationData::TimeStampType between = 0.5 * (file->GetTimeStamp(frame) + file->GetTimeStamp(frame + 1));
+        CPPUNIT_ASSERT_EQUAL(frame, file->FindFrame(between));
+      }
+    }
+  }
+
+  void TestPlayFile()
+  {
+    WriteReference(7);
+    mitk::NavigationDataBinaryFile::Pointer file = mitk::NavigationDataBinaryFile::New();
+    file->Open(m_FileName);
+
+    mitk::NavigationDataSequentialPlayer::Pointer player = mitk::NavigationDataSequentialPlayer::New();
+    player->SetNavigationDataFile(file);
+    CPPUNIT_ASSERT_EQUAL(m_NavigationDataSet->Size(), player->GetNumberOfSnapshots());
+
+    unsigned int snapshot = 0;
+    bool equal = true;
+    do
+    {
+      for (unsigned int tool = 0; tool < player->GetNumberOfOutputs(); ++tool)
+        equal = equal && Equal(m_NavigationDataSet->GetNavigationDataForIndex(snapshot, tool), player->GetOutput(tool));
+      ++snapshot;
+    } while (player->GoToNextSnapshot());
+    CPPUNIT_ASSERT_MESSAGE("Test if the player outputs the frames of the file", equal);
+    CPPUNIT_ASSERT_EQUAL(m_NavigationDataSet->Size(), snapshot);
+
+    unsigned int last = m_NavigationDataSet->Size() - 1;
+    player->GoToTimeStamp(file->GetTimeStamp(last) + 1.0);
+    CPPUNIT_ASSERT_EQUAL(last, player->GetCurrentSnapshotNumber());
+  }
+
+  void TestTruncatedFile()
+  {
+    WriteReference(7);
+    std::ifstream in(m_FileName.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream out(m_FileName.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(content.data(), content.size() - 16);
+    out.close();
+
+    mitk::NavigationDataBinaryFile::Pointer file = mitk::NavigationDataBinaryFile::New();
+    file->Open(m_FileName);
+
+    // only the last, incomplete block is lost
+    unsigned int lastBlock = m_NavigationDataSet->Size() % 7 == 0 ? 7 : m_NavigationDataSet->Size() % 7;
+    CPPUNIT_ASSERT_EQUAL(m_NavigationDataSet->Size() - lastBlock, file->GetNumberOfFrames());
+  }
+
+  void TestInvalidFile()
+  {
+    std::ofstream out(m_FileName.c_str(), std::ios::binary | std::ios::trunc);
+    out << "this is not a navigation data file";
+    out.close();
+
+    mitk::NavigationDataBinaryFile::Pointer file = mitk::NavigationDataBinaryFile::New();
+    CPPUNIT_ASSERT_THROW(file->Open(m_FileName), mitk::IGTIOException);
+  }
+
+private:
+
+  void WriteReference(unsigned int framesPerBlock)
+  {
+    std::vector<std::string> toolNames(m_NavigationDataSet->GetNumberOfTools());
+    mitk::NavigationDataBinaryWriter::Pointer writer = mitk::NavigationDataBinaryWriter::New();
+    writer->SetFramesPerBlock(framesPerBlock);
+    writer->Open(m_FileName, toolNames);
+    writer->AddNavigationDataSet(m_NavigationDataSet);
+    writer->Close();
+  }
+
+  bool Equal(const mitk::NavigationData* ref, const mitk::NavigationData* rec)
+  {
+    return ref->GetIGTTimeStamp() == rec->GetIGTTimeStamp()
+      && ref->IsDataValid() == rec->IsDataValid()
+      && ref->GetOrientation().as_vector() == rec->GetOrientation().as_vector()
+      && ref->GetPosition().GetVnlVector() == rec->GetPosition().GetVnlVector();
+  }
+
+  /*
+  * The values are copied without conversion, so they have to be identical.
+  */
+  bool CompareToReference(mitk::NavigationDataSet::Pointer recorded)
+  {
+    if (recorded.IsNull() || recorded->Size() != m_NavigationDataSet->Size() || recorded->GetNumberOfTools() != m_NavigationDataSet->GetNumberOfTools())
+      return false;
+
+    for (unsigned int tool = 0; tool < recorded->GetNumberOfTools(); tool++)
+    {
+      for (unsigned int i = 0; i < recorded->Size(); i++)
+      {
+        if (!Equal(m_NavigationDataSet->GetNavigationDataForIndex(i, tool), recorded->GetNavigationDataForIndex(i, tool)))
+          return false;
+      }
+    }
+    return true;
+  }
+};
+MITK_TEST_SUITE_REGISTRATION(mitkNavigationDataBinaryFormat)
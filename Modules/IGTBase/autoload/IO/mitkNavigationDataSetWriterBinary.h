@@ -0,0 +1,46 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef MITKNavigationDataSetWriterBinary_H_HEADER_INCLUDED_
+#define MITKNavigationDataSetWriterBinary_H_HEADER_INCLUDED_
+
+#include <MitkIGTIOExports.h>
+
+#include <mitkNavigationDataSet.h>
+#include <mitkAbstractFileWriter.h>
+
+namespace mitk {
+  /** This class writes a navigation data set in the binary format described
+   *  in mitk::NavigationDataBinaryFormat.
+   */
+  class MITKIGTIO_EXPORT NavigationDataSetWriterBinary : public AbstractFileWriter
+  {
+  public:
+    NavigationDataSetWriterBinary();
+    ~NavigationDataSetWriterBinary() override;
+
+    using AbstractFileWriter::Write;
+    void Write() override;
+
+  protected:
+    NavigationDataSetWriterBinary(const NavigationDataSetWriterBinary& other);
+
+    mitk::NavigationDataSetWriterBinary* Clone() const override;
+  };
+}
+
+#endif // MITKNavigationDataSetWriterBinary_H_HEADER_INCLUDED_
@@ -0,0 +1,212 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKNAVIGATIONDATABINARYFORMAT_H_HEADER_INCLUDED_
+#define MITKNAVIGATIONDATABINARYFORMAT_H_HEADER_INCLUDED_
+
+#include <MitkIGTBaseExports.h>
+#include "mitkNavigationData.h"
+#include "mitkNavigationDataSet.h"
+#include <mitkMemoryMappedFile.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace mitk {
+
+  /**
+  * \brief Compact binary file format for recorded navigation data.
+  *
+  * The file starts with a header (magic "MITKNDB1", format version, number of
+  * tools and the tool names) followed by any number of blocks. Every block
+  * holds the frames that were recorded since the previous one, stored column
+  * by column for each tool:
+  *
+  * \code
+  * uint32 number of frames n, uint32 reserved
+  * double time stamps      [tools][n]
+  * double positions        [tools][n][3]
+  * double orientations     [tools][n][4]  (x, y, z, r)
+  * uint8  flags            [tools][n]     (valid, has position, has orientation)
+  * padding to a multiple of 8 bytes
+  * \endcode
+  *
+  * Blocks are only appended, so a recording can be written while it is made.
+  * A block that was cut off (e.g. because the application crashed) is ignored
+  * by the reader. The covariance matrix and later changes of the tool names
+  * are not stored.
+  */
+  class MITKIGTBASE_EXPORT NavigationDataBinaryFormat
+  {
+  public:
+    static const char* GetMagicString() { return "MITKNDB1"; }
+    static const unsigned int Version = 1;
+
+    enum Flags
+    {
+      DataValid = 1,
+      HasPosition = 2,
+      HasOrientation = 4
+    };
+
+    /** \brief Number of bytes of a block with the given number of frames and tools, including padding */
+    static std::size_t GetBlockSize(unsigned int numberOfFrames, unsigned int numberOfTools);
+  };
+
+  /**
+  * \brief Writes navigation data to the binary format incrementally.
+  *
+  * Frames are collected in a preallocated block buffer and written with one
+  * call when the block is full, on Flush() and on Close(). AddFrame() does not
+  * allocate memory.
+  */
+  class MITKIGTBASE_EXPORT NavigationDataBinaryWriter : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(NavigationDataBinaryWriter, itk::Object);
+    itkFactorylessNewMacro(Self)
+
+    /**
+    * \brief Number of frames that are buffered before a block is written. Default is 1024.
+    * Has to be set before Open().
+    */
+    itkSetMacro(FramesPerBlock, unsigned int);
+    itkGetMacro(FramesPerBlock, unsigned int);
+
+    /**
+    * \brief Creates the file and writes the header.
+    * @throw mitk::IGTIOException if the file can not be created.
+    */
+    void Open(const std::string& filename, const std::vector<std::string>& toolNames);
+
+    /**
+    * \brief Adds one frame with one mitk::NavigationData per tool.
+    * @param timeStamps if not null, one time stamp per tool that is written instead of the time stamps of the navigation datas
+    */
+    void AddFrame(const NavigationData* const* navigationDatas, const NavigationData::TimeStampType* timeStamps = nullptr);
+
+    /**
+    * \brief Adds all frames of the given set.
+    */
+    void AddNavigationDataSet(const NavigationDataSet* navigationDataSet);
+
+    /**
+    * \brief Writes the buffered frames as a block.
+    */
+    void Flush();
+
+    /**
+    * \brief Writes the buffered frames and closes the file.
+    */
+    void Close();
+
+    bool IsOpen() const;
+
+    unsigned long long GetNumberOfWrittenFrames() const { return m_NumberOfWrittenFrames; }
+
+  protected:
+    NavigationDataBinaryWriter();
+    ~NavigationDataBinaryWriter() override;
+
+    std::ofstream m_Stream;
+    unsigned int m_NumberOfTools;
+    unsigned int m_FramesPerBlock;
+    unsigned int m_NumberOfBufferedFrames;
+    unsigned long long m_NumberOfWrittenFrames;
+
+    /** \brief columns of the block that is written next, [tool][frame] with m_FramesPerBlock frames per tool */
+    std::vector<double> m_TimeStamps;
+    std::vector<double> m_Positions;
+    std::vector<double> m_Orientations;
+    std::vector<unsigned char> m_Flags;
+  };
+
+  /**
+  * \brief Read access to a file in the binary format through a memory mapping.
+  *
+  * Opening a file only reads the block headers. Frames are copied directly from
+  * the mapping into mitk::NavigationData objects, and FindFrame() locates a
+  * time stamp with a binary search over the blocks and inside the block.
+  */
+  class MITKIGTBASE_EXPORT NavigationDataBinaryFile : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(NavigationDataBinaryFile, itk::Object);
+    itkFactorylessNewMacro(Self)
+
+    typedef NavigationData::TimeStampType TimeStampType;
+
+    /**
+    * \brief Maps the given file and indexes its blocks.
+    * @throw mitk::IGTIOException if the file can not be mapped or is not in the binary format.
+    */
+    void Open(const std::string& filename);
+
+    void Close();
+
+    unsigned int GetNumberOfTools() const { return m_NumberOfTools; }
+
+    unsigned int GetNumberOfFrames() const { return m_NumberOfFrames; }
+
+    const std::string& GetToolName(unsigned int toolIndex) const { return m_ToolNames.at(toolIndex); }
+
+    /**
+    * \brief Returns the time stamp of the given tool in the given frame.
+    */
+    TimeStampType GetTimeStamp(unsigned int frame, unsigned int toolIndex = 0) const;
+
+    /**
+    * \brief Copies the data of the given tool in the given frame into navigationData.
+    */
+    void GetNavigationData(unsigned int frame, unsigned int toolIndex, NavigationData* navigationData) const;
+
+    /**
+    * \brief Returns the last frame whose time stamp of the first tool is not larger
+    * than the given one, or 0 if there is none.
+    */
+    unsigned int FindFrame(TimeStampType timeStamp) const;
+
+    /**
+    * \brief Creates a mitk::NavigationDataSet with all frames of the file.
+    */
+    NavigationDataSet::Pointer CreateNavigationDataSet() const;
+
+  protected:
+    NavigationDataBinaryFile();
+    ~NavigationDataBinaryFile() override;
+
+    struct Block
+    {
+      const char* Data;
+      unsigned int FirstFrame;
+      unsigned int NumberOfFrames;
+      TimeStampType FirstTimeStamp;
+    };
+
+    /** \brief Returns the block that contains the frame and the index of the frame inside it */
+    const Block& GetBlock(unsigned int frame, unsigned int& frameInBlock) const;
+
+    MemoryMappedFile m_File;
+
+    unsigned int m_NumberOfTools;
+    unsigned int m_NumberOfFrames;
+    std::vector<std::string> m_ToolNames;
+    std::vector<Block> m_Blocks;
+  };
+}
+
+#endif // MITKNAVIGATIONDATABINARYFORMAT_H_HEADER_INCLUDED_
@@ -0,0 +1,352 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkNavigationDataBinaryFormat.h"
+#include "mitkIGTIOException.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+  // all columns of a block and the block itself start at multiples of 8 bytes
+  std::size_t Align(std::size_t size)
+  {
+    return (size + 7) & ~static_cast<std::size_t>(7);
+  }
+
+  const std::size_t BlockHeaderSize = 8;
+}
+
+std::size_t mitk::NavigationDataBinaryFormat::GetBlockSize(unsigned int numberOfFrames, unsigned int numberOfTools)
+{
+  // time stamp, 3 position and 4 orientation values plus one flag byte per tool and frame
+  std::size_t values = static_cast<std::size_t>(numberOfFrames) * numberOfTools;
+  return Align(BlockHeaderSize + values * (8 * sizeof(double) + 1));
+}
+
+// ----------------------------------------------------------------------------
+// NavigationDataBinaryWriter
+// ----------------------------------------------------------------------------
+
+mitk::NavigationDataBinaryWriter::NavigationDataBinaryWriter()
+  : m_NumberOfTools(0),
+    m_FramesPerBlock(1024),
+    m_NumberOfBufferedFrames(0),
+    m_NumberOfWrittenFrames(0)
+{
+}
+
+mitk::NavigationDataBinaryWriter::~NavigationDataBinaryWriter()
+{
+  this->Close();
+}
+
+void mitk::NavigationDataBinaryWriter::Open(const std::string& filename, const std::vector<std::string>& toolNames)
+{
+  this->Close();
+
+  m_Stream.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_Stream.is_open())
+  {
+    mitkThrowException(mitk::IGTIOException) << "Unable to create file " << filename;
+  }
+
+  m_NumberOfTools = static_cast<unsigned int>(toolNames.size());
+  m_FramesPerBlock = std::max(1u, m_FramesPerBlock);
+  m_NumberOfBufferedFrames = 0;
+  m_NumberOfWrittenFrames = 0;
+
+  std::size_t values = static_cast<std::size_t>(m_FramesPerBlock) * m_NumberOfTools;
+  m_TimeStamps.assign(values, 0.0);
+  m_Positions.assign(3 * values, 0.0);
+  m_Orientations.assign(4 * values, 0.0);
+  m_Flags.assign(values, 0);
+
+  std::uint32_t version = NavigationDataBinaryFormat::Version;
+  std::uint32_t numberOfTools = m_NumberOfTools;
+  m_Stream.write(NavigationDataBinaryFormat::GetMagicString(), 8);
+  m_Stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  m_Stream.write(reinterpret_cast<const char*>(&numberOfTools), sizeof(numberOfTools));
+  std::size_t headerSize = 16;
+  for (const std::string& name : toolNames)
+  {
+    std::uint32_t length = static_cast<std::uint32_t>(name.size());
+    m_Stream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    m_Stream.write(name.data(), length);
+    headerSize += sizeof(length) + length;
+  }
+  const char padding[8] = { 0 };
+  m_Stream.write(padding, Align(headerSize) - headerSize);
+  m_Stream.flush();
+}
+
+bool mitk::NavigationDataBinaryWriter::IsOpen() const
+{
+  return m_Stream.is_open();
+}
+
+void mitk::NavigationDataBinaryWriter::AddFrame(const NavigationData* const* navigationDatas, const NavigationData::TimeStampType* timeStamps)
+{
+  if (!m_Stream.is_open())
+    return;
+
+  for (unsigned int tool = 0; tool < m_NumberOfTools; ++tool)
+  {
+    const NavigationData* nd = navigationDatas[tool];
+    std::size_t index = static_cast<std::size_t>(tool) * m_FramesPerBlock + m_NumberOfBufferedFrames;
+
+    m_TimeStamps[index] = timeStamps != nullptr ? timeStamps[tool] : nd->GetIGTTimeStamp();
+    const NavigationData::PositionType& position = nd->GetPosition();
+    std::copy(position.Begin(), position.End(), &m_Positions[3 * index]);
+    const NavigationData::OrientationType& orientation = nd->GetOrientation();
+    std::copy(orientation.begin(), orientation.end(), &m_Orientations[4 * index]);
+    m_Flags[index] = static_cast<unsigned char>((nd->IsDataValid() ? NavigationDataBinaryFormat::DataValid : 0)
+      | (nd->GetHasPosition() ? NavigationDataBinaryFormat::HasPosition : 0)
+      | (nd->GetHasOrientation() ? NavigationDataBinaryFormat::HasOrientation : 0));
+  }
+
+  if (++m_NumberOfBufferedFrames == m_FramesPerBlock)
+    this->Flush();
+}
+
+void mitk::NavigationDataBinaryWriter::AddNavigationDataSet(const NavigationDataSet* navigationDataSet)
+{
+  std::vector<const NavigationData*> frame(navigationDataSet->GetNumberOfTools());
+  for (auto it = navigationDataSet->Begin(); it != navigationDataSet->End(); ++it)
+  {
+    for (unsigned int tool = 0; tool < frame.size(); ++tool)
+      frame[tool] = it->at(tool);
+    this->AddFrame(frame.data());
+  }
+}
+
+void mitk::NavigationDataBinaryWriter::Flush()
+{
+  if (!m_Stream.is_open() || m_NumberOfBufferedFrames == 0)
+    return;
+
+  const std::size_t n = m_NumberOfBufferedFrames;
+  std::uint32_t header[2] = { static_cast<std::uint32_t>(n), 0 };
+  m_Stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  // the columns of every tool are stored for m_FramesPerBlock frames, only
+  // the first n of them are written
+  for (unsigned int tool = 0; tool < m_NumberOfTools; ++tool)
+    m_Stream.write(reinterpret_cast<const char*>(&m_TimeStamps[tool * m_FramesPerBlock]), n * sizeof(double));
+  for (unsigned int tool = 0; tool < m_NumberOfTools; ++tool)
+    m_Stream.write(reinterpret_cast<const char*>(&m_Positions[3 * tool * m_FramesPerBlock]), 3 * n * sizeof(double));
+  for (unsigned int tool = 0; tool < m_NumberOfTools; ++tool)
+    m_Stream.write(reinterpret_cast<const char*>(&m_Orientations[4 * tool * m_FramesPerBlock]), 4 * n * sizeof(double));
+  for (unsigned int tool = 0; tool < m_NumberOfTools; ++tool)
+    m_Stream.write(reinterpret_cast<const char*>(&m_Flags[tool * m_FramesPerBlock]), n);
+
+  std::size_t written = BlockHeaderSize + n * m_NumberOfTools * (8 * sizeof(double) + 1);
+  const char padding[8] = { 0 };
+  m_Stream.write(padding, Align(written) - written);
+  m_Stream.flush();
+
+  m_NumberOfWrittenFrames += n;
+  m_NumberOfBufferedFrames = 0;
+}
+
+void mitk::NavigationDataBinaryWriter::Close()
+{
+  if (!m_Stream.is_open())
+    return;
+
+  this->Flush();
+  m_Stream.close();
+}
+
+// ----------------------------------------------------------------------------
+// NavigationDataBinaryFile
+// ----------------------------------------------------------------------------
+
+mitk::NavigationDataBinaryFile::NavigationDataBinaryFile()
+  : m_NumberOfTools(0),
+    m_NumberOfFrames(0)
+{
+}
+
+mitk::NavigationDataBinaryFile::~NavigationDataBinaryFile()
+{
+  this->Close();
+}
+
+void mitk::NavigationDataBinaryFile::Open(const std::string& filename)
+{
+  this->Close();
+
+  // frames are read in any order, e.g. by FindFrame()
+  try
+  {
+    m_File.Open(filename, false);
+  }
+  catch (const mitk::Exception& e)
+  {
+    mitkThrowException(mitk::IGTIOException) << e.GetDescription();
+  }
+  const char* data = m_File.GetData();
+  const std::size_t size = m_File.GetSize();
+
+  // header
+  std::uint32_t version = 0;
+  std::uint32_t numberOfTools = 0;
+  if (size < 16 || std::memcmp(data, NavigationDataBinaryFormat::GetMagicString(), 8) != 0)
+  {
+    this->Close();
+    mitkThrowException(mitk::IGTIOException) << filename << " is not a binary navigation data file";
+  }
+  std::memcpy(&version, data + 8, sizeof(version));
+  std::memcpy(&numberOfTools, data + 12, sizeof(numberOfTools));
+  if (version != NavigationDataBinaryFormat::Version || numberOfTools == 0)
+  {
+    this->Close();
+    mitkThrowException(mitk::IGTIOException) << "Unsupported binary navigation data file " << filename;
+  }
+
+  std::size_t offset = 16;
+  for (std::uint32_t tool = 0; tool < numberOfTools; ++tool)
+  {
+    std::uint32_t length = 0;
+    if (offset + sizeof(length) <= size)
+      std::memcpy(&length, data + offset, sizeof(length));
+    offset += sizeof(length);
+    if (offset + length > size)
+    {
+      this->Close();
+      mitkThrowException(mitk::IGTIOException) << "Truncated header in " << filename;
+    }
+    m_ToolNames.push_back(std::string(data + offset, length));
+    offset += length;
+  }
+  offset = Align(offset);
+  m_NumberOfTools = numberOfTools;
+
+  // index the blocks, only their headers are touched
+  while (offset + BlockHeaderSize <= size)
+  {
+    std::uint32_t numberOfFrames = 0;
+    std::memcpy(&numberOfFrames, data + offset, sizeof(numberOfFrames));
+    std::size_t blockSize = NavigationDataBinaryFormat::GetBlockSize(numberOfFrames, m_NumberOfTools);
+    if (numberOfFrames == 0 || offset + blockSize > size)
+    {
+      MITK_WARN("NavigationDataBinaryFile") << "Ignoring incomplete block at the end of " << filename;
+      break;
+    }
+
+    Block block;
+    block.Data = data + offset;
+    block.FirstFrame = m_NumberOfFrames;
+    block.NumberOfFrames = numberOfFrames;
+    std::memcpy(&block.FirstTimeStamp, block.Data + BlockHeaderSize, sizeof(double));
+    m_Blocks.push_back(block);
+
+    m_NumberOfFrames += numberOfFrames;
+    offset += blockSize;
+  }
+}
+
+void mitk::NavigationDataBinaryFile::Close()
+{
+  m_File.Close();
+  m_NumberOfTools = 0;
+  m_NumberOfFrames = 0;
+  m_ToolNames.clear();
+  m_Blocks.clear();
+}
+
+const mitk::NavigationDataBinaryFile::Block& mitk::NavigationDataBinaryFile::GetBlock(unsigned int frame, unsigned int& frameInBlock) const
+{
+  if (frame >= m_NumberOfFrames)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Frame " << frame << " does not exist, the file contains " << m_NumberOfFrames << " frames";
+  }
+
+  auto it = std::upper_bound(m_Blocks.begin(), m_Blocks.end(), frame,
+    [](unsigned int f, const Block& block) { return f < block.FirstFrame; });
+  --it;
+  frameInBlock = frame - it->FirstFrame;
+  return *it;
+}
+
+mitk::NavigationDataBinaryFile::TimeStampType mitk::NavigationDataBinaryFile::GetTimeStamp(unsigned int frame, unsigned int toolIndex) const
+{
+  unsigned int i;
+  const Block& block = this->GetBlock(frame, i);
+  const double* timeStamps = reinterpret_cast<const double*>(block.Data + BlockHeaderSize);
+  return timeStamps[static_cast<std::size_t>(toolIndex) * block.NumberOfFrames + i];
+}
+
+void mitk::NavigationDataBinaryFile::GetNavigationData(unsigned int frame, unsigned int toolIndex, NavigationData* navigationData) const
+{
+  unsigned int i;
+  const Block& block = this->GetBlock(frame, i);
+  const std::size_t values = static_cast<std::size_t>(m_NumberOfTools) * block.NumberOfFrames;
+  const std::size_t index = static_cast<std::size_t>(toolIndex) * block.NumberOfFrames + i;
+
+  const double* timeStamps = reinterpret_cast<const double*>(block.Data + BlockHeaderSize);
+  const double* positions = timeStamps + values;
+  const double* orientations = positions + 3 * values;
+  const unsigned char* flags = reinterpret_cast<const unsigned char*>(orientations + 4 * values);
+
+  NavigationData::PositionType position;
+  position[0] = positions[3 * index];
+  position[1] = positions[3 * index + 1];
+  position[2] = positions[3 * index + 2];
+  const double* orientation = orientations + 4 * index;
+
+  navigationData->SetIGTTimeStamp(timeStamps[index]);
+  navigationData->SetPosition(position);
+  navigationData->SetOrientation(NavigationData::OrientationType(orientation[0], orientation[1], orientation[2], orientation[3]));
+  navigationData->SetDataValid((flags[index] & NavigationDataBinaryFormat::DataValid) != 0);
+  navigationData->SetHasPosition((flags[index] & NavigationDataBinaryFormat::HasPosition) != 0);
+  navigationData->SetHasOrientation((flags[index] & NavigationDataBinaryFormat::HasOrientation) != 0);
+  navigationData->SetName(m_ToolNames[toolIndex].c_str());
+}
+
+unsigned int mitk::NavigationDataBinaryFile::FindFrame(TimeStampType timeStamp) const
+{
+  // last block that starts at or before the time stamp
+  auto block = std::upper_bound(m_Blocks.begin(), m_Blocks.end(), timeStamp,
+    [](TimeStampType t, const Block& b) { return t < b.FirstTimeStamp; });
+  if (block == m_Blocks.begin())
+    return 0;
+  --block;
+
+  // last frame of that block that is not later than the time stamp
+  const double* timeStamps = reinterpret_cast<const double*>(block->Data + BlockHeaderSize);
+  const double* frame = std::upper_bound(timeStamps, timeStamps + block->NumberOfFrames, timeStamp);
+  return block->FirstFrame + static_cast<unsigned int>(frame - timeStamps) - 1;
+}
+
+mitk::NavigationDataSet::Pointer mitk::NavigationDataBinaryFile::CreateNavigationDataSet() const
+{
+  NavigationDataSet::Pointer navigationDataSet = NavigationDataSet::New(m_NumberOfTools);
+  std::vector<NavigationData::Pointer> navigationDatas(m_NumberOfTools);
+  for (unsigned int frame = 0; frame < m_NumberOfFrames; ++frame)
+  {
+    for (unsigned int tool = 0; tool < m_NumberOfTools; ++tool)
+    {
+      navigationDatas[tool] = NavigationData::New();
+      this->GetNavigationData(frame, tool, navigationDatas[tool]);
+    }
+    navigationDataSet->AddNavigationDatas(navigationDatas);
+  }
+  return navigationDataSet;
+}
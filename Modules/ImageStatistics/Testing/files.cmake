@@ -7,5 +7,6 @@ set(MODULE_TESTS
 
 set(MODULE_CUSTOM_TESTS
   mitkImageStatisticsHotspotTest.cpp
+  mitkMultiLabelStatisticsBenchmarkTest.cpp
 #  mitkMultiGaussianTest.cpp # TODO: activate test to generate new test cases for mitkImageStatisticsHotspotTest
 )
@@ -0,0 +1,209 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+
+#include <mitkExtendedLabelStatisticsImageFilter.h>
+#include <mitkMinMaxLabelmageFilterWithIndex.h>
+#include <mitkMultiLabelStatisticsImageFilter.h>
+
+#include <itkImageRegionIterator.h>
+#include <itkTimeProbe.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <typeinfo>
+
+/**
+ * Compares MultiLabelStatisticsImageFilter with the previous combination of MinMaxLabelImageFilterWithIndex
+ * and ExtendedLabelStatisticsImageFilter (as used by ImageStatisticsCalculator) on a synthetic volume and
+ * reports the run times of both.
+ *
+ * argv[1] is the edge length of the cubic volume. argv[2] is the number of labels; it has to be a square number,
+ * since the labels are arranged as a grid of columns along z. Run times are only telling for clinical volume sizes
+ * (e.g. 512 and 100), where the previous implementation spends most of its time in the second sweep.
+ */
+namespace
+{
+  typedef itk::Image<unsigned short, 3> LabelImageType;
+
+  bool AreClose(double a, double b)
+  {
+    if (std::isnan(a) || std::isnan(b))
+    {
+      return std::isnan(a) && std::isnan(b);
+    }
+    return std::abs(a - b) <= 1e-8 * std::max(1., std::max(std::abs(a), std::abs(b)));
+  }
+
+  template <typename TImage>
+  typename TImage::Pointer CreateImage(unsigned int edgeLength)
+  {
+    typename TImage::RegionType region;
+    region.SetSize(0, edgeLength);
+    region.SetSize(1, edgeLength);
+    region.SetSize(2, edgeLength);
+
+    typename TImage::Pointer image = TImage::New();
+    image->SetRegions(region);
+    image->Allocate();
+    return image;
+  }
+
+  /** Noisy values with a slight gradient along z, so that the labels have different ranges */
+  template <typename TImage>
+  void FillValues(TImage *image)
+  {
+    unsigned int state = 42;
+    itk::ImageRegionIterator<TImage> it(image, image->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      state = state * 1664525u + 1013904223u;
+      const double noise = static_cast<double>(state >> 16) / 65536.;
+      it.Set(static_cast<typename TImage::PixelType>(-200. + 800. * noise + 0.5 * it.GetIndex()[2]));
+    }
+  }
+
+  /** Labels form a regular grid of columns along z, numbered from 1 */
+  void FillLabels(LabelImageType *labelImage, unsigned int edgeLength, unsigned int numberOfLabels)
+  {
+    const unsigned int labelsPerAxis = static_cast<unsigned int>(std::sqrt(static_cast<double>(numberOfLabels)));
+    itk::ImageRegionIterator<LabelImageType> it(labelImage, labelImage->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const LabelImageType::IndexType index = it.GetIndex();
+      const unsigned int column = index[0] * labelsPerAxis / edgeLength;
+      const unsigned int row = index[1] * labelsPerAxis / edgeLength;
+      it.Set(static_cast<unsigned short>(1 + column + row * labelsPerAxis));
+    }
+  }
+
+  template <typename TImage>
+  void CompareWithPreviousImplementation(unsigned int edgeLength, unsigned int numberOfLabels)
+  {
+    typedef itk::MinMaxLabelImageFilterWithIndex<TImage, LabelImageType> MinMaxFilterType;
+    typedef itk::ExtendedLabelStatisticsImageFilter<TImage, LabelImageType> ExtendedFilterType;
+    typedef itk::MultiLabelStatisticsImageFilter<TImage, LabelImageType> MultiLabelFilterType;
+    typedef typename TImage::PixelType PixelType;
+
+    typename TImage::Pointer image = CreateImage<TImage>(edgeLength);
+    FillValues(image.GetPointer());
+    LabelImageType::Pointer labelImage = CreateImage<LabelImageType>(edgeLength);
+    FillLabels(labelImage, edgeLength, numberOfLabels);
+
+    // previous implementation: extrema sweep, then statistics sweep with label specific histogram bounds
+    itk::TimeProbe previousProbe;
+    previousProbe.Start();
+
+    typename MinMaxFilterType::Pointer minMaxFilter = MinMaxFilterType::New();
+    minMaxFilter->SetInput(image);
+    minMaxFilter->SetLabelInput(labelImage);
+    minMaxFilter->UpdateLargestPossibleRegion();
+
+    std::map<unsigned short, PixelType> minVals;
+    std::map<unsigned short, PixelType> maxVals;
+    std::map<unsigned short, unsigned int> nBins;
+    for (unsigned short label : minMaxFilter->GetRelevantLabels())
+    {
+      minVals[label] = minMaxFilter->GetMin(label);
+      maxVals[label] = minMaxFilter->GetMax(label);
+      nBins[label] = 100;
+    }
+
+    typename ExtendedFilterType::Pointer extendedFilter = ExtendedFilterType::New();
+    extendedFilter->SetInput(image);
+    extendedFilter->SetLabelInput(labelImage);
+    extendedFilter->SetHistogramParametersForLabels(nBins, minVals, maxVals);
+    extendedFilter->Update();
+
+    previousProbe.Stop();
+
+    itk::TimeProbe multiLabelProbe;
+    multiLabelProbe.Start();
+
+    typename MultiLabelFilterType::Pointer multiLabelFilter = MultiLabelFilterType::New();
+    multiLabelFilter->SetInput(image);
+    multiLabelFilter->SetLabelInput(labelImage);
+    multiLabelFilter->SetNumberOfBins(100);
+    multiLabelFilter->UpdateLargestPossibleRegion();
+
+    multiLabelProbe.Stop();
+
+    MITK_TEST_OUTPUT(<< edgeLength << "^3 voxels, " << numberOfLabels << " labels, pixel type "
+                     << typeid(PixelType).name() << ": previous implementation " << previousProbe.GetTotal()
+                     << " s, MultiLabelStatisticsImageFilter " << multiLabelProbe.GetTotal() << " s");
+
+    const std::vector<unsigned short> labels = multiLabelFilter->GetRelevantLabels();
+    MITK_TEST_CONDITION_REQUIRED(labels == minMaxFilter->GetRelevantLabels(), "Same labels are found");
+    MITK_TEST_CONDITION_REQUIRED(labels.size() == numberOfLabels, "All labels are found");
+
+    unsigned int mismatches = 0;
+    for (unsigned short label : labels)
+    {
+      const typename MultiLabelFilterType::LabelStatistics &statistics = multiLabelFilter->GetLabelStatistics(label);
+
+      bool equal = statistics.m_Count == extendedFilter->GetCount(label) &&
+                   statistics.m_Minimum == minMaxFilter->GetMin(label) &&
+                   statistics.m_Maximum == minMaxFilter->GetMax(label) &&
+                   statistics.m_MinIndex == minMaxFilter->GetMinIndex(label) &&
+                   statistics.m_MaxIndex == minMaxFilter->GetMaxIndex(label) &&
+                   AreClose(statistics.m_Mean, extendedFilter->GetMean(label)) &&
+                   AreClose(statistics.m_Variance, extendedFilter->GetVariance(label)) &&
+                   AreClose(statistics.m_Skewness, extendedFilter->GetSkewness(label)) &&
+                   AreClose(statistics.m_Kurtosis, extendedFilter->GetKurtosis(label)) &&
+                   AreClose(statistics.m_MPP, extendedFilter->GetMPP(label)) &&
+                   statistics.m_Median == extendedFilter->GetMedian(label) &&
+                   AreClose(statistics.m_Entropy, extendedFilter->GetEntropy(label)) &&
+                   AreClose(statistics.m_Uniformity, extendedFilter->GetUniformity(label));
+
+      const itk::Statistics::Histogram<double> *expectedHistogram = extendedFilter->GetHistogram(label);
+      equal = equal && expectedHistogram->GetSize(0) == statistics.m_Histogram->GetSize(0);
+      for (unsigned int bin = 0; equal && bin < expectedHistogram->GetSize(0); ++bin)
+      {
+        equal = expectedHistogram->GetFrequency(bin) == statistics.m_Histogram->GetFrequency(bin);
+      }
+
+      if (!equal)
+      {
+        ++mismatches;
+      }
+    }
+
+    MITK_TEST_CONDITION(mismatches == 0, "Statistics of all labels equal the previous implementation (" << mismatches
+                                                                                                        << " mismatches)");
+  }
+}
+
+int mitkMultiLabelStatisticsBenchmarkTest(int argc, char *argv[])
+{
+  MITK_TEST_BEGIN("mitkMultiLabelStatisticsBenchmarkTest")
+
+  MITK_TEST_CONDITION_REQUIRED(argc == 3, "Test is invoked with exactly 2 parameters (edge length, number of labels)");
+
+  const unsigned int edgeLength = static_cast<unsigned int>(std::atoi(argv[1]));
+  const unsigned int numberOfLabels = static_cast<unsigned int>(std::atoi(argv[2]));
+  const unsigned int labelsPerAxis = static_cast<unsigned int>(std::sqrt(static_cast<double>(numberOfLabels)));
+  MITK_TEST_CONDITION_REQUIRED(labelsPerAxis * labelsPerAxis == numberOfLabels && labelsPerAxis <= edgeLength,
+                               "Number of labels is a square number that fits into the volume");
+
+  // exact value counts, single sweep
+  CompareWithPreviousImplementation<itk::Image<short, 3>>(edgeLength, numberOfLabels);
+  // moments and extrema sweep plus histogram sweep
+  CompareWithPreviousImplementation<itk::Image<float, 3>>(edgeLength, numberOfLabels);
+
+  MITK_TEST_END()
+}
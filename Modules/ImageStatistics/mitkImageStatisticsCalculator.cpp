@@ -19,10 +19,9 @@
 #include <mitkImageAccessByItk.h>
 #include <mitkImageToItk.h>
 #include <mitkExtendedStatisticsImageFilter.h>
-#include <mitkExtendedLabelStatisticsImageFilter.h>
+#include <mitkMultiLabelStatisticsImageFilter.h>
 #include <mitkImageTimeSelector.h>
 #include <mitkMinMaxImageFilterWithIndex.h>
-#include <mitkMinMaxLabelmageFilterWithIndex.h>
 #include <mitkitkMaskImageFilter.h>
 #include <mitkImageCast.h>
 
@@ -291,10 +290,8 @@ namespace mitk
         typedef itk::Image< TPixel, VImageDimension > ImageType;
         typedef itk::Image< MaskPixelType, VImageDimension > MaskType;
         typedef typename MaskType::PixelType LabelPixelType;
-        typedef itk::ExtendedLabelStatisticsImageFilter< ImageType, MaskType > ImageStatisticsFilterType;
+        typedef itk::MultiLabelStatisticsImageFilter< ImageType, MaskType > ImageStatisticsFilterType;
         typedef MaskUtilities< TPixel, VImageDimension > MaskUtilType;
-        typedef typename itk::MinMaxLabelImageFilterWithIndex<ImageType, MaskType> MinMaxLabelFilterType;
-        typedef typename ImageType::PixelType InputImgPixelType;
 
         // workaround: if m_SecondaryMaskGenerator ist not null but m_MaskGenerator is! (this is the case if we request a 'ignore zuero valued pixels'
         // mask in the gui but do not define a primary mask)
@@ -356,65 +353,32 @@ namespace mitk
 
         adaptedImage = maskUtil->ExtractMaskImageRegion(); // this also checks mask sanity
 
-        // find min, max, minindex and maxindex
-        typename MinMaxLabelFilterType::Pointer minMaxFilter = MinMaxLabelFilterType::New();
-        minMaxFilter->SetInput(adaptedImage);
-        minMaxFilter->SetLabelInput(maskImage);
-        minMaxFilter->UpdateLargestPossibleRegion();
-
-        // set histogram parameters for each label individually (min/max may be different for each label)
-        typedef typename std::map<LabelPixelType, InputImgPixelType> MapType;
-        typedef typename std::pair<LabelPixelType, InputImgPixelType> PairType;
-
-        std::vector<LabelPixelType> relevantLabels = minMaxFilter->GetRelevantLabels();
-        MapType minVals;
-        MapType maxVals;
-        std::map<LabelPixelType, unsigned int> nBins;
-
-        for (LabelPixelType label:relevantLabels)
-        {
-            minVals.insert(PairType(label, minMaxFilter->GetMin(label)));
-            maxVals.insert(PairType(label, minMaxFilter->GetMax(label)));
-
-            unsigned int nBinsForHistogram;
-            if (m_UseBinSizeOverNBins)
-            {
-                nBinsForHistogram = std::max(static_cast<double>(std::ceil(minMaxFilter->GetMax(label) - minMaxFilter->GetMin(label))) / m_binSizeForHistogramStatistics, 10.); // do not allow less than 10 bins
-            }
-            else
-            {
-                nBinsForHistogram = m_nBinsForHistogramStatistics;
-            }
-
-            nBins.insert(typename std::pair<LabelPixelType, unsigned int>(label, nBinsForHistogram));
-        }
-
+        // min, max, their indices, moments and histograms of all labels in one multi threaded filter run
         typename ImageStatisticsFilterType::Pointer imageStatisticsFilter = ImageStatisticsFilterType::New();
         imageStatisticsFilter->SetDirectionTolerance(0.001);
         imageStatisticsFilter->SetCoordinateTolerance(0.001);
         imageStatisticsFilter->SetInput(adaptedImage);
         imageStatisticsFilter->SetLabelInput(maskImage);
-        imageStatisticsFilter->SetHistogramParametersForLabels(nBins, minVals, maxVals);
-        imageStatisticsFilter->Update();
+        imageStatisticsFilter->SetNumberOfBins(m_nBinsForHistogramStatistics);
+        imageStatisticsFilter->SetBinSize(m_binSizeForHistogramStatistics);
+        imageStatisticsFilter->SetUseBinSize(m_UseBinSizeOverNBins);
+        imageStatisticsFilter->UpdateLargestPossibleRegion();
 
-        std::list<int> labels = imageStatisticsFilter->GetRelevantLabels();
-        auto it = labels.begin();
+        std::vector<LabelPixelType> labels = imageStatisticsFilter->GetRelevantLabels();
         m_StatisticsByTimeStep[timeStep].resize(0);
 
-        while(it != labels.end())
+        for (LabelPixelType label : labels)
         {
+            const typename ImageStatisticsFilterType::LabelStatistics &labelStatistics = imageStatisticsFilter->GetLabelStatistics(label);
             StatisticsContainer::Pointer statisticsResult = StatisticsContainer::New();
 
-            // find min, max, minindex and maxindex
-            // make sure to only look in the masked region, use a masker for this
-
             vnl_vector<int> minIndex, maxIndex;
             mitk::Point3D worldCoordinateMin;
             mitk::Point3D worldCoordinateMax;
             mitk::Point3D indexCoordinateMin;
             mitk::Point3D indexCoordinateMax;
-            m_InternalImageForStatistics->GetGeometry()->IndexToWorld(minMaxFilter->GetMinIndex(*it), worldCoordinateMin);
-            m_InternalImageForStatistics->GetGeometry()->IndexToWorld(minMaxFilter->GetMaxIndex(*it), worldCoordinateMax);
+            m_InternalImageForStatistics->GetGeometry()->IndexToWorld(labelStatistics.m_MinIndex, worldCoordinateMin);
+            m_InternalImageForStatistics->GetGeometry()->IndexToWorld(labelStatistics.m_MaxIndex, worldCoordinateMax);
             m_Image->GetGeometry()->WorldToIndex(worldCoordinateMin, indexCoordinateMin);
             m_Image->GetGeometry()->WorldToIndex(worldCoordinateMax, indexCoordinateMax);
 
@@ -431,30 +395,25 @@ namespace mitk
             statisticsResult->SetMinIndex(minIndex);
             statisticsResult->SetMaxIndex(maxIndex);
 
-            assert(std::abs(minMaxFilter->GetMax(*it) - imageStatisticsFilter->GetMaximum(*it)) < mitk::eps);
-            assert(std::abs(minMaxFilter->GetMin(*it) - imageStatisticsFilter->GetMinimum(*it)) < mitk::eps);
-
-
-            statisticsResult->SetN(imageStatisticsFilter->GetSum(*it) / (double) imageStatisticsFilter->GetMean(*it));
-            statisticsResult->SetMean(imageStatisticsFilter->GetMean(*it));
-            statisticsResult->SetMin(imageStatisticsFilter->GetMinimum(*it));
-            statisticsResult->SetMax(imageStatisticsFilter->GetMaximum(*it));
-            statisticsResult->SetVariance(imageStatisticsFilter->GetVariance(*it));
-            statisticsResult->SetStd(imageStatisticsFilter->GetSigma(*it));
-            statisticsResult->SetSkewness(imageStatisticsFilter->GetSkewness(*it));
-            statisticsResult->SetKurtosis(imageStatisticsFilter->GetKurtosis(*it));
-            statisticsResult->SetRMS(std::sqrt(std::pow(imageStatisticsFilter->GetMean(*it), 2.) + imageStatisticsFilter->GetVariance(*it))); // variance = sigma^2
-            statisticsResult->SetMPP(imageStatisticsFilter->GetMPP(*it));
-            statisticsResult->SetLabel(*it);
-
-            statisticsResult->SetEntropy(imageStatisticsFilter->GetEntropy(*it));
-            statisticsResult->SetMedian(imageStatisticsFilter->GetMedian(*it));
-            statisticsResult->SetUniformity(imageStatisticsFilter->GetUniformity(*it));
-            statisticsResult->SetUPP(imageStatisticsFilter->GetUPP(*it));
-            statisticsResult->SetHistogram(imageStatisticsFilter->GetHistogram(*it));
+            statisticsResult->SetN(static_cast<long>(labelStatistics.m_Count));
+            statisticsResult->SetMean(labelStatistics.m_Mean);
+            statisticsResult->SetMin(labelStatistics.m_Minimum);
+            statisticsResult->SetMax(labelStatistics.m_Maximum);
+            statisticsResult->SetVariance(labelStatistics.m_Variance);
+            statisticsResult->SetStd(labelStatistics.m_Sigma);
+            statisticsResult->SetSkewness(labelStatistics.m_Skewness);
+            statisticsResult->SetKurtosis(labelStatistics.m_Kurtosis);
+            statisticsResult->SetRMS(std::sqrt(std::pow(labelStatistics.m_Mean, 2.) + labelStatistics.m_Variance)); // variance = sigma^2
+            statisticsResult->SetMPP(labelStatistics.m_MPP);
+            statisticsResult->SetLabel(label);
+
+            statisticsResult->SetEntropy(labelStatistics.m_Entropy);
+            statisticsResult->SetMedian(labelStatistics.m_Median);
+            statisticsResult->SetUniformity(labelStatistics.m_Uniformity);
+            statisticsResult->SetUPP(labelStatistics.m_UPP);
+            statisticsResult->SetHistogram(labelStatistics.m_Histogram);
 
             m_StatisticsByTimeStep[timeStep].push_back(statisticsResult);
-            ++it;
         }
 
         // swap maskGenerators back
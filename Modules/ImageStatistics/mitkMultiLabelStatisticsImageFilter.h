@@ -0,0 +1,261 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITK_MULTILABELSTATISTICSIMAGEFILTER_H
+#define MITK_MULTILABELSTATISTICSIMAGEFILTER_H
+
+#include <itkHistogram.h>
+#include <itkImage.h>
+#include <itkImageToImageFilter.h>
+
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace itk
+{
+  /**
+   * \brief Computes the statistics of all labels of a label image in one multi threaded sweep.
+   *
+   * Replaces the combination of MinMaxLabelImageFilterWithIndex and ExtendedLabelStatisticsImageFilter
+   * (which needs the extrema of each label before the histograms can be filled). Each thread accumulates
+   * partial moments, extrema with their indices and value counts for all labels of its region, the partial
+   * results are merged afterwards.
+   *
+   * For integral pixel types of at most 16 bit the exact frequency of each value is counted per label. The
+   * histograms (bounds = extrema of the label) as well as all moments are derived from these counts, so the
+   * input is read exactly once. For all other pixel types a second, histogram only sweep is done after
+   * the extrema are known.
+   *
+   * The results are identical to those of ExtendedLabelStatisticsImageFilter with label specific histogram
+   * parameters (as used by ImageStatisticsCalculator).
+   */
+  template <typename TInputImage, typename TLabelImage>
+  class MultiLabelStatisticsImageFilter : public ImageToImageFilter<TInputImage, TInputImage>
+  {
+  public:
+    /** Standard Self typedef */
+    typedef MultiLabelStatisticsImageFilter Self;
+    typedef ImageToImageFilter<TInputImage, TInputImage> Superclass;
+    typedef SmartPointer<Self> Pointer;
+    typedef SmartPointer<const Self> ConstPointer;
+
+    /** Method for creation through the object factory. */
+    itkNewMacro(Self);
+
+    /** Runtime information support. */
+    itkTypeMacro(MultiLabelStatisticsImageFilter, ImageToImageFilter);
+
+    typedef typename TInputImage::RegionType RegionType;
+    typedef typename TInputImage::IndexType IndexType;
+    typedef typename TInputImage::PixelType PixelType;
+    typedef typename NumericTraits<PixelType>::RealType RealType;
+    typedef typename TLabelImage::PixelType LabelPixelType;
+    typedef Statistics::Histogram<double> HistogramType;
+
+    /** Statistics of one label */
+    class LabelStatistics
+    {
+    public:
+      LabelStatistics()
+        : m_Count(0),
+          m_PositivePixelCount(0),
+          m_Sum(0),
+          m_SumOfPositivePixels(0),
+          m_Minimum(0),
+          m_Maximum(0),
+          m_Mean(0),
+          m_Variance(0),
+          m_Sigma(0),
+          m_Skewness(0),
+          m_Kurtosis(0),
+          m_MPP(0),
+          m_Median(0),
+          m_Uniformity(0),
+          m_UPP(0),
+          m_Entropy(0)
+      {
+      }
+
+      SizeValueType m_Count;
+      SizeValueType m_PositivePixelCount;
+      RealType m_Sum;
+      RealType m_SumOfPositivePixels;
+      PixelType m_Minimum;
+      PixelType m_Maximum;
+      IndexType m_MinIndex;
+      IndexType m_MaxIndex;
+      RealType m_Mean;
+      RealType m_Variance;
+      RealType m_Sigma;
+      RealType m_Skewness;
+      RealType m_Kurtosis;
+      RealType m_MPP;
+      RealType m_Median;
+      RealType m_Uniformity;
+      RealType m_UPP;
+      RealType m_Entropy;
+      HistogramType::Pointer m_Histogram;
+    };
+
+    /** Set the label image */
+    void SetLabelInput(const TLabelImage *input)
+    {
+      // Process object is not const-correct so the const casting is required.
+      this->SetNthInput(1, const_cast<TLabelImage *>(input));
+    }
+
+    /** Get the label image */
+    const TLabelImage *GetLabelInput() const
+    {
+      return itkDynamicCastInDebugMode<TLabelImage *>(const_cast<DataObject *>(this->ProcessObject::GetInput(1)));
+    }
+
+    /** Number of histogram bins per label (used if UseBinSize is false) */
+    itkSetMacro(NumberOfBins, unsigned int);
+    itkGetConstMacro(NumberOfBins, unsigned int);
+
+    /** Width of the histogram bins; the number of bins of a label is derived from its range but is at least 10
+     * (used if UseBinSize is true) */
+    itkSetMacro(BinSize, double);
+    itkGetConstMacro(BinSize, double);
+
+    itkSetMacro(UseBinSize, bool);
+    itkGetConstMacro(UseBinSize, bool);
+    itkBooleanMacro(UseBinSize);
+
+    /** Returns all labels that occur in the label image, in ascending order */
+    std::vector<LabelPixelType> GetRelevantLabels() const;
+
+    /** Returns true if label occurs in the label image */
+    bool HasLabel(LabelPixelType label) const { return m_LabelStatistics.find(label) != m_LabelStatistics.end(); }
+
+    /** Returns the statistics of label. Throws if the label does not occur in the label image. */
+    const LabelStatistics &GetLabelStatistics(LabelPixelType label) const;
+
+  protected:
+    MultiLabelStatisticsImageFilter();
+    ~MultiLabelStatisticsImageFilter() override {}
+
+    void AllocateOutputs() override;
+
+    void GenerateData() override;
+
+    void ThreadedGenerateData(const RegionType &outputRegionForThread, ThreadIdType threadId) override;
+
+  private:
+    /** Exact value counts are used for integral pixel types of at most 16 bit */
+    static const bool UseValueCounts = std::is_integral<PixelType>::value && sizeof(PixelType) <= 2;
+
+    /** Equally spaced histogram bins of a label, bin boundaries are the ones of the itk::Statistics::Histogram */
+    class BinLayout
+    {
+    public:
+      std::vector<double> m_BinMin;
+      std::vector<double> m_BinMax;
+      double m_LowerBound;
+      double m_BinWidth;
+
+      void Initialize(const HistogramType *histogram);
+
+      /** Same bin as HistogramType::GetIndex() for values between the lower and upper bound */
+      SizeValueType GetBin(double value) const;
+    };
+
+    /** Partial results of one label in one thread */
+    class LabelAccumulator
+    {
+    public:
+      LabelAccumulator()
+        : m_Count(0),
+          m_PositivePixelCount(0),
+          m_Sum(0),
+          m_SumOfSquares(0),
+          m_SumOfCubes(0),
+          m_SumOfQuadruples(0),
+          m_SumOfPositivePixels(0),
+          m_Minimum(0),
+          m_Maximum(0),
+          m_ValueCountsOffset(0),
+          m_BinLayout(nullptr)
+      {
+      }
+
+      SizeValueType m_Count;
+      SizeValueType m_PositivePixelCount;
+      RealType m_Sum;
+      RealType m_SumOfSquares;
+      RealType m_SumOfCubes;
+      RealType m_SumOfQuadruples;
+      RealType m_SumOfPositivePixels;
+      PixelType m_Minimum;
+      PixelType m_Maximum;
+      IndexType m_MinIndex;
+      IndexType m_MaxIndex;
+
+      /** m_ValueCounts[i] is the frequency of value i + m_ValueCountsOffset (only if UseValueCounts) */
+      long m_ValueCountsOffset;
+      std::vector<SizeValueType> m_ValueCounts;
+
+      /** Frequencies of the histogram bins (only during the histogram sweep) */
+      const BinLayout *m_BinLayout;
+      std::vector<SizeValueType> m_Frequencies;
+    };
+
+    /** Partial results of all labels in one thread */
+    class ThreadAccumulator
+    {
+    public:
+      std::unordered_map<LabelPixelType, std::size_t> m_Slots;
+      std::vector<LabelPixelType> m_Labels;
+      std::vector<LabelAccumulator> m_Accumulators;
+    };
+
+    void ExecuteThreaded();
+
+    void MergeThreadAccumulators();
+
+    void InitializeHistograms();
+
+    /** Derives moments and histograms from the merged value counts (only if UseValueCounts) */
+    void EvaluateValueCounts();
+
+    void MergeThreadHistograms();
+
+    void ComputeDerivedStatistics();
+
+    static void AddValueCount(LabelAccumulator &accumulator, PixelType value);
+
+    static void MergeValueCounts(LabelAccumulator &target, const LabelAccumulator &source);
+
+    unsigned int m_NumberOfBins;
+    double m_BinSize;
+    bool m_UseBinSize;
+
+    bool m_HistogramSweep;
+    std::vector<ThreadAccumulator> m_ThreadAccumulators;
+    std::map<LabelPixelType, LabelAccumulator> m_MergedAccumulators;
+    std::map<LabelPixelType, BinLayout> m_BinLayouts;
+    std::map<LabelPixelType, LabelStatistics> m_LabelStatistics;
+  };
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "mitkMultiLabelStatisticsImageFilter.hxx"
+#endif
+
+#endif
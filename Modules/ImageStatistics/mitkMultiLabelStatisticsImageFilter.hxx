@@ -0,0 +1,552 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITK_MULTILABELSTATISTICSIMAGEFILTER_HXX
+#define MITK_MULTILABELSTATISTICSIMAGEFILTER_HXX
+
+#include "mitkMultiLabelStatisticsImageFilter.h"
+
+#include <itkImageScanlineConstIterator.h>
+#include <mitkHistogramStatisticsCalculator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace itk
+{
+  template <typename TInputImage, typename TLabelImage>
+  MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::MultiLabelStatisticsImageFilter()
+    : m_NumberOfBins(100), m_BinSize(10), m_UseBinSize(false), m_HistogramSweep(false)
+  {
+    this->SetNumberOfRequiredInputs(2);
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  std::vector<typename MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::LabelPixelType>
+    MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::GetRelevantLabels() const
+  {
+    std::vector<LabelPixelType> labels;
+    labels.reserve(m_LabelStatistics.size());
+    for (auto it = m_LabelStatistics.cbegin(); it != m_LabelStatistics.cend(); ++it)
+    {
+      labels.push_back(it->first);
+    }
+    return labels;
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  const typename MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::LabelStatistics &
+    MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::GetLabelStatistics(LabelPixelType label) const
+  {
+    auto it = m_LabelStatistics.find(label);
+    if (it == m_LabelStatistics.end())
+    {
+      itkExceptionMacro(<< "Label " << static_cast<double>(label) << " does not occur in the label image.");
+    }
+    return it->second;
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::AllocateOutputs()
+  {
+    // Pass the input through as the output
+    typename TInputImage::Pointer image = const_cast<TInputImage *>(this->GetInput());
+
+    this->GraftOutput(image);
+
+    // Nothing that needs to be allocated for the remaining outputs
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::GenerateData()
+  {
+    this->AllocateOutputs();
+
+    m_MergedAccumulators.clear();
+    m_BinLayouts.clear();
+    m_LabelStatistics.clear();
+    m_ThreadAccumulators.clear();
+    m_ThreadAccumulators.resize(this->GetNumberOfThreads());
+
+    // sweep 1: moments, extrema and (if possible) value counts of all labels
+    m_HistogramSweep = false;
+    this->ExecuteThreaded();
+    this->MergeThreadAccumulators();
+    this->InitializeHistograms();
+
+    if (UseValueCounts)
+    {
+      this->EvaluateValueCounts();
+    }
+    else
+    {
+      // sweep 2: histograms, now that the bounds of each label are known
+      m_HistogramSweep = true;
+      this->ExecuteThreaded();
+      this->MergeThreadHistograms();
+    }
+
+    m_ThreadAccumulators.clear();
+    this->ComputeDerivedStatistics();
+    m_MergedAccumulators.clear();
+    m_BinLayouts.clear();
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::ExecuteThreaded()
+  {
+    typename Superclass::ThreadStruct str;
+    str.Filter = this;
+
+    this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+    this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::ThreadedGenerateData(
+    const RegionType &outputRegionForThread, ThreadIdType threadId)
+  {
+    if (outputRegionForThread.GetNumberOfPixels() == 0)
+    {
+      return;
+    }
+
+    ThreadAccumulator &threadAccumulator = m_ThreadAccumulators[threadId];
+
+    ImageScanlineConstIterator<TInputImage> it(this->GetInput(), outputRegionForThread);
+    ImageScanlineConstIterator<TLabelImage> labelIt(this->GetLabelInput(), outputRegionForThread);
+
+    // consecutive pixels mostly share their label, so the accumulator is only looked up if the label changes
+    LabelAccumulator *accumulator = nullptr;
+    LabelPixelType currentLabel = LabelPixelType();
+
+    while (!it.IsAtEnd())
+    {
+      while (!it.IsAtEndOfLine())
+      {
+        const PixelType value = it.Get();
+        const LabelPixelType label = labelIt.Get();
+
+        if (accumulator == nullptr || label != currentLabel)
+        {
+          currentLabel = label;
+
+          auto slotIt = threadAccumulator.m_Slots.find(label);
+          if (slotIt == threadAccumulator.m_Slots.end())
+          {
+            slotIt = threadAccumulator.m_Slots.insert(std::make_pair(label, threadAccumulator.m_Accumulators.size())).first;
+            threadAccumulator.m_Labels.push_back(label);
+            threadAccumulator.m_Accumulators.push_back(LabelAccumulator());
+
+            LabelAccumulator &newAccumulator = threadAccumulator.m_Accumulators.back();
+            newAccumulator.m_Minimum = value;
+            newAccumulator.m_Maximum = value;
+            newAccumulator.m_MinIndex = it.GetIndex();
+            newAccumulator.m_MaxIndex = newAccumulator.m_MinIndex;
+          }
+
+          accumulator = &threadAccumulator.m_Accumulators[slotIt->second];
+
+          if (m_HistogramSweep && accumulator->m_BinLayout == nullptr)
+          {
+            accumulator->m_BinLayout = &m_BinLayouts.find(label)->second;
+            accumulator->m_Frequencies.assign(accumulator->m_BinLayout->m_BinMin.size(), 0);
+          }
+        }
+
+        if (m_HistogramSweep)
+        {
+          if (!accumulator->m_Frequencies.empty())
+          {
+            ++accumulator->m_Frequencies[accumulator->m_BinLayout->GetBin(static_cast<double>(value))];
+          }
+        }
+        else
+        {
+          // strict comparisons keep the first occurrence of an extremum
+          if (value < accumulator->m_Minimum)
+          {
+            accumulator->m_Minimum = value;
+            accumulator->m_MinIndex = it.GetIndex();
+          }
+          else if (value > accumulator->m_Maximum)
+          {
+            accumulator->m_Maximum = value;
+            accumulator->m_MaxIndex = it.GetIndex();
+          }
+
+          if (UseValueCounts)
+          {
+            AddValueCount(*accumulator, value);
+          }
+          else
+          {
+            const RealType realValue = static_cast<RealType>(value);
+            const RealType square = realValue * realValue;
+
+            ++accumulator->m_Count;
+            accumulator->m_Sum += realValue;
+            accumulator->m_SumOfSquares += square;
+            accumulator->m_SumOfCubes += square * realValue;
+            accumulator->m_SumOfQuadruples += square * square;
+
+            if (realValue > 0)
+            {
+              ++accumulator->m_PositivePixelCount;
+              accumulator->m_SumOfPositivePixels += realValue;
+            }
+          }
+        }
+
+        ++it;
+        ++labelIt;
+      }
+      it.NextLine();
+      labelIt.NextLine();
+    }
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::AddValueCount(LabelAccumulator &accumulator,
+                                                                                 PixelType value)
+  {
+    const long longValue = static_cast<long>(value);
+    long position = longValue - accumulator.m_ValueCountsOffset;
+
+    if (position < 0 || position >= static_cast<long>(accumulator.m_ValueCounts.size()))
+    {
+      // grow the table with some headroom in the direction of the new value
+      const long oldBegin = accumulator.m_ValueCountsOffset;
+      const long oldEnd = oldBegin + static_cast<long>(accumulator.m_ValueCounts.size());
+      const long headroom = std::max(64L, (oldEnd - oldBegin) / 2);
+
+      long newBegin = oldBegin;
+      long newEnd = oldEnd;
+      if (accumulator.m_ValueCounts.empty())
+      {
+        newBegin = longValue - headroom / 2;
+        newEnd = longValue + headroom / 2;
+      }
+      else if (position < 0)
+      {
+        newBegin = longValue - headroom;
+      }
+      else
+      {
+        newEnd = longValue + 1 + headroom;
+      }
+      newBegin = std::max(newBegin, static_cast<long>(std::numeric_limits<PixelType>::lowest()));
+      newEnd = std::min(newEnd, static_cast<long>(std::numeric_limits<PixelType>::max()) + 1);
+
+      std::vector<SizeValueType> newCounts(newEnd - newBegin, 0);
+      if (!accumulator.m_ValueCounts.empty())
+      {
+        std::copy(accumulator.m_ValueCounts.begin(), accumulator.m_ValueCounts.end(), newCounts.begin() + (oldBegin - newBegin));
+      }
+      accumulator.m_ValueCounts.swap(newCounts);
+      accumulator.m_ValueCountsOffset = newBegin;
+      position = longValue - newBegin;
+    }
+
+    ++accumulator.m_ValueCounts[position];
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::MergeValueCounts(LabelAccumulator &target,
+                                                                                    const LabelAccumulator &source)
+  {
+    if (source.m_ValueCounts.empty())
+    {
+      return;
+    }
+
+    if (target.m_ValueCounts.empty())
+    {
+      target.m_ValueCounts = source.m_ValueCounts;
+      target.m_ValueCountsOffset = source.m_ValueCountsOffset;
+      return;
+    }
+
+    const long sourceBegin = source.m_ValueCountsOffset;
+    const long sourceEnd = sourceBegin + static_cast<long>(source.m_ValueCounts.size());
+    const long targetBegin = target.m_ValueCountsOffset;
+    const long targetEnd = targetBegin + static_cast<long>(target.m_ValueCounts.size());
+
+    if (sourceBegin < targetBegin || sourceEnd > targetEnd)
+    {
+      const long newBegin = std::min(sourceBegin, targetBegin);
+      const long newEnd = std::max(sourceEnd, targetEnd);
+
+      std::vector<SizeValueType> newCounts(newEnd - newBegin, 0);
+      std::copy(target.m_ValueCounts.begin(), target.m_ValueCounts.end(), newCounts.begin() + (targetBegin - newBegin));
+      target.m_ValueCounts.swap(newCounts);
+      target.m_ValueCountsOffset = newBegin;
+    }
+
+    const long shift = sourceBegin - target.m_ValueCountsOffset;
+    for (std::size_t i = 0; i < source.m_ValueCounts.size(); ++i)
+    {
+      target.m_ValueCounts[shift + i] += source.m_ValueCounts[i];
+    }
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::MergeThreadAccumulators()
+  {
+    // threads are merged in the order of their regions, so that ties of extrema are resolved
+    // in favor of the first occurrence like in a sequential sweep
+    for (auto &threadAccumulator : m_ThreadAccumulators)
+    {
+      for (std::size_t i = 0; i < threadAccumulator.m_Labels.size(); ++i)
+      {
+        const LabelPixelType label = threadAccumulator.m_Labels[i];
+        LabelAccumulator &partial = threadAccumulator.m_Accumulators[i];
+
+        auto mergedIt = m_MergedAccumulators.find(label);
+        if (mergedIt == m_MergedAccumulators.end())
+        {
+          m_MergedAccumulators.insert(std::make_pair(label, partial));
+        }
+        else
+        {
+          LabelAccumulator &merged = mergedIt->second;
+          merged.m_Count += partial.m_Count;
+          merged.m_PositivePixelCount += partial.m_PositivePixelCount;
+          merged.m_Sum += partial.m_Sum;
+          merged.m_SumOfSquares += partial.m_SumOfSquares;
+          merged.m_SumOfCubes += partial.m_SumOfCubes;
+          merged.m_SumOfQuadruples += partial.m_SumOfQuadruples;
+          merged.m_SumOfPositivePixels += partial.m_SumOfPositivePixels;
+
+          if (partial.m_Minimum < merged.m_Minimum)
+          {
+            merged.m_Minimum = partial.m_Minimum;
+            merged.m_MinIndex = partial.m_MinIndex;
+          }
+          if (partial.m_Maximum > merged.m_Maximum)
+          {
+            merged.m_Maximum = partial.m_Maximum;
+            merged.m_MaxIndex = partial.m_MaxIndex;
+          }
+
+          MergeValueCounts(merged, partial);
+        }
+
+        // the value counts of the threads are not needed anymore
+        std::vector<SizeValueType>().swap(partial.m_ValueCounts);
+      }
+    }
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::InitializeHistograms()
+  {
+    for (auto it = m_MergedAccumulators.cbegin(); it != m_MergedAccumulators.cend(); ++it)
+    {
+      const LabelAccumulator &accumulator = it->second;
+
+      unsigned int numberOfBins = m_NumberOfBins;
+      if (m_UseBinSize)
+      {
+        // do not allow less than 10 bins
+        numberOfBins = static_cast<unsigned int>(
+          std::max(static_cast<double>(std::ceil(accumulator.m_Maximum - accumulator.m_Minimum)) / m_BinSize, 10.));
+      }
+
+      HistogramType::Pointer histogram = HistogramType::New();
+      typename HistogramType::SizeType size;
+      typename HistogramType::MeasurementVectorType lowerBound;
+      typename HistogramType::MeasurementVectorType upperBound;
+      size.SetSize(1);
+      lowerBound.SetSize(1);
+      upperBound.SetSize(1);
+      histogram->SetMeasurementVectorSize(1);
+      size[0] = numberOfBins;
+      lowerBound[0] = static_cast<RealType>(accumulator.m_Minimum);
+      upperBound[0] = static_cast<RealType>(accumulator.m_Maximum);
+      histogram->Initialize(size, lowerBound, upperBound);
+
+      m_LabelStatistics[it->first].m_Histogram = histogram;
+      m_BinLayouts[it->first].Initialize(histogram);
+    }
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::EvaluateValueCounts()
+  {
+    for (auto it = m_MergedAccumulators.begin(); it != m_MergedAccumulators.end(); ++it)
+    {
+      LabelAccumulator &accumulator = it->second;
+      const BinLayout &binLayout = m_BinLayouts[it->first];
+      HistogramType *histogram = m_LabelStatistics[it->first].m_Histogram;
+
+      for (std::size_t i = 0; i < accumulator.m_ValueCounts.size(); ++i)
+      {
+        const SizeValueType frequency = accumulator.m_ValueCounts[i];
+        if (frequency == 0)
+        {
+          continue;
+        }
+
+        const RealType value = static_cast<RealType>(accumulator.m_ValueCountsOffset + static_cast<long>(i));
+        const RealType realFrequency = static_cast<RealType>(frequency);
+        const RealType square = value * value;
+
+        accumulator.m_Count += frequency;
+        accumulator.m_Sum += realFrequency * value;
+        accumulator.m_SumOfSquares += realFrequency * square;
+        accumulator.m_SumOfCubes += realFrequency * square * value;
+        accumulator.m_SumOfQuadruples += realFrequency * square * square;
+
+        if (value > 0)
+        {
+          accumulator.m_PositivePixelCount += frequency;
+          accumulator.m_SumOfPositivePixels += realFrequency * value;
+        }
+
+        if (!binLayout.m_BinMin.empty())
+        {
+          histogram->IncreaseFrequency(binLayout.GetBin(value), frequency);
+        }
+      }
+
+      std::vector<SizeValueType>().swap(accumulator.m_ValueCounts);
+    }
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::MergeThreadHistograms()
+  {
+    for (auto &threadAccumulator : m_ThreadAccumulators)
+    {
+      for (std::size_t i = 0; i < threadAccumulator.m_Labels.size(); ++i)
+      {
+        const LabelAccumulator &partial = threadAccumulator.m_Accumulators[i];
+        HistogramType *histogram = m_LabelStatistics[threadAccumulator.m_Labels[i]].m_Histogram;
+
+        for (std::size_t bin = 0; bin < partial.m_Frequencies.size(); ++bin)
+        {
+          if (partial.m_Frequencies[bin] > 0)
+          {
+            histogram->IncreaseFrequency(bin, partial.m_Frequencies[bin]);
+          }
+        }
+      }
+    }
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::ComputeDerivedStatistics()
+  {
+    for (auto it = m_MergedAccumulators.cbegin(); it != m_MergedAccumulators.cend(); ++it)
+    {
+      const LabelAccumulator &accumulator = it->second;
+      LabelStatistics &statistics = m_LabelStatistics[it->first];
+
+      statistics.m_Count = accumulator.m_Count;
+      statistics.m_PositivePixelCount = accumulator.m_PositivePixelCount;
+      statistics.m_Sum = accumulator.m_Sum;
+      statistics.m_SumOfPositivePixels = accumulator.m_SumOfPositivePixels;
+      statistics.m_Minimum = accumulator.m_Minimum;
+      statistics.m_Maximum = accumulator.m_Maximum;
+      statistics.m_MinIndex = accumulator.m_MinIndex;
+      statistics.m_MaxIndex = accumulator.m_MaxIndex;
+
+      const RealType count = static_cast<RealType>(accumulator.m_Count);
+
+      statistics.m_Mean = accumulator.m_Sum / count;
+      statistics.m_MPP = accumulator.m_SumOfPositivePixels / static_cast<RealType>(accumulator.m_PositivePixelCount);
+
+      // same estimators as ExtendedLabelStatisticsImageFilter
+      statistics.m_Variance = (accumulator.m_SumOfSquares - accumulator.m_Sum * accumulator.m_Sum / count) / count;
+
+      const RealType secondMoment = accumulator.m_SumOfSquares / count;
+      const RealType thirdMoment = accumulator.m_SumOfCubes / count;
+      const RealType fourthMoment = accumulator.m_SumOfQuadruples / count;
+      const RealType mean = statistics.m_Mean;
+
+      statistics.m_Skewness = (thirdMoment - 3. * secondMoment * mean + 2. * std::pow(mean, 3.)) /
+                              std::pow(secondMoment - std::pow(mean, 2.), 1.5);
+      statistics.m_Kurtosis = (fourthMoment - 4. * thirdMoment * mean + 6. * secondMoment * std::pow(mean, 2.) -
+                               3. * std::pow(mean, 4.)) /
+                              std::pow(secondMoment - std::pow(mean, 2.), 2.);
+      statistics.m_Sigma = std::sqrt(statistics.m_Variance);
+
+      mitk::HistogramStatisticsCalculator histogramStatisticsCalculator;
+      histogramStatisticsCalculator.SetHistogram(statistics.m_Histogram);
+      histogramStatisticsCalculator.CalculateStatistics();
+      statistics.m_Median = histogramStatisticsCalculator.GetMedian();
+      statistics.m_Entropy = histogramStatisticsCalculator.GetEntropy();
+      statistics.m_Uniformity = histogramStatisticsCalculator.GetUniformity();
+      statistics.m_UPP = histogramStatisticsCalculator.GetUPP();
+    }
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  void MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::BinLayout::Initialize(const HistogramType *histogram)
+  {
+    const SizeValueType numberOfBins = histogram->GetSize(0);
+
+    m_BinMin.resize(numberOfBins);
+    m_BinMax.resize(numberOfBins);
+    for (SizeValueType bin = 0; bin < numberOfBins; ++bin)
+    {
+      m_BinMin[bin] = histogram->GetBinMin(0, bin);
+      m_BinMax[bin] = histogram->GetBinMax(0, bin);
+    }
+
+    m_LowerBound = numberOfBins > 0 ? m_BinMin.front() : 0.;
+    m_BinWidth = numberOfBins > 0 ? (m_BinMax.back() - m_BinMin.front()) / numberOfBins : 0.;
+  }
+
+  template <typename TInputImage, typename TLabelImage>
+  SizeValueType MultiLabelStatisticsImageFilter<TInputImage, TLabelImage>::BinLayout::GetBin(double value) const
+  {
+    const SizeValueType lastBin = m_BinMin.size() - 1;
+
+    // all values of the label are equal, HistogramType puts them into the last bin
+    if (!(m_BinWidth > 0))
+    {
+      return lastBin;
+    }
+
+    // estimate the bin arithmetically, then correct rounding errors with the actual bin boundaries
+    const double position = (value - m_LowerBound) / m_BinWidth;
+    SizeValueType bin = 0;
+    if (position >= lastBin)
+    {
+      bin = lastBin;
+    }
+    else if (position > 0)
+    {
+      bin = static_cast<SizeValueType>(position);
+    }
+
+    while (bin > 0 && value < m_BinMin[bin])
+    {
+      --bin;
+    }
+    while (bin < lastBin && value >= m_BinMax[bin])
+    {
+      ++bin;
+    }
+    return bin;
+  }
+}
+
+#endif
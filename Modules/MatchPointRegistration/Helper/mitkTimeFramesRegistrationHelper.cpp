@@ -19,10 +19,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTimeFramesRegistrationHelper.h"
 #include <mitkImageTimeSelector.h>
 #include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkParallelFor.h>
 
 #include <mitkMaskedAlgorithmHelper.h>
 #include <mitkAlgorithmHelper.h>
 
+#include <mapMetaPropertyAlgorithmInterface.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
 mitk::Image::Pointer
 mitk::TimeFramesRegistrationHelper::GetFrameImage(const mitk::Image* image,
     mitk::TimePointType timePoint) const
@@ -44,8 +52,6 @@ mitk::TimeFramesRegistrationHelper::Generate()
   //prepare processing
   mitk::Image::Pointer targetFrame = GetFrameImage(this->m_4DImage, 0);
 
-  this->m_Registered4DImage = this->m_4DImage->Clone();
-
   Image::ConstPointer mask;
 
   if (m_TargetMask.IsNotNull())
@@ -60,51 +66,215 @@ mitk::TimeFramesRegistrationHelper::Generate()
     }
   }
 
-  double progressDelta = 1.0 / ((this->m_4DImage->GetTimeSteps() - 1) * 3.0);
+  const unsigned int timeSteps = this->m_4DImage->GetTimeSteps();
+
+  double progressDelta = 1.0 / ((timeSteps - 1) * 3.0);
   m_Progress = 0.0;
 
-  //process the frames
-  for (unsigned int i = 1; i < this->m_4DImage->GetTimeSteps(); ++i)
+  std::vector<mitk::TimeStepType> frames;
+  for (unsigned int i = 1; i < timeSteps; ++i)
   {
-    Image::Pointer movingFrame = GetFrameImage(this->m_4DImage, i);
-    Image::Pointer mappedFrame;
+    if (std::find(m_IgnoreList.begin(), m_IgnoreList.end(), i) == m_IgnoreList.end())
+    {
+      frames.push_back(i);
+    }
+  }
+
+  //the result is allocated without copying the input, only the frames that are not registered are copied.
+  Image::Pointer registered4DImage = Image::New();
+  registered4DImage->Initialize(this->m_4DImage);
+  registered4DImage->SetPropertyList(this->m_4DImage->GetPropertyList()->Clone());
 
-    IgnoreListType::iterator finding = std::find(m_IgnoreList.begin(), m_IgnoreList.end(), i);
+  const std::size_t frameSize = this->m_4DImage->GetPixelType().GetSize() * this->m_4DImage->GetDimension(0) *
+    this->m_4DImage->GetDimension(1) * this->m_4DImage->GetDimension(2);
 
+  std::vector<BaseGeometry::Pointer> frameGeometries(timeSteps);
+
+  {
+    mitk::ImageWriteAccessor outputAccessor(registered4DImage);
+    char* outputBuffer = static_cast<char*>(outputAccessor.GetData());
 
-    if (finding == m_IgnoreList.end())
     {
-      //frame should be processed
-      RegistrationPointer reg = DoFrameRegistration(movingFrame, targetFrame, mask);
+      mitk::ImageReadAccessor inputAccessor(this->m_4DImage);
+      const char* inputBuffer = static_cast<const char*>(inputAccessor.GetData());
+      for (unsigned int i = 0; i < timeSteps; ++i)
+      {
+        if (i == 0 || std::find(frames.begin(), frames.end(), i) == frames.end())
+        {
+          std::memcpy(outputBuffer + i * frameSize, inputBuffer + i * frameSize, frameSize);
+        }
+      }
+    }
 
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameRegistrationEvent(nullptr,
-                        "Registred frame #" +::map::core::convert::toStr(i)));
+    for (std::size_t i = frames.size(); i < timeSteps - 1; ++i)
+    {
+      //ignored frames
+      this->AddProgress(3 * progressDelta, ::itk::ProgressEvent());
+    }
 
-      mappedFrame = DoFrameMapping(movingFrame, reg, targetFrame);
+    std::size_t algorithmCount = 1;
+    if (m_MaxConcurrentRegistrations > 1)
+    {
+      if (m_AlgorithmFactory)
+      {
+        algorithmCount = std::max<std::size_t>(std::min<std::size_t>(m_MaxConcurrentRegistrations, frames.size()), 1);
+      }
+      else
+      {
+        MITK_WARN << "No algorithm factory set. Frames are registered sequentially.";
+      }
+    }
 
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameMappingEvent(nullptr,
-                        "Mapped frame #" + ::map::core::convert::toStr(i)));
+    //without initializer every frame is handed out on its own. With initializer the frames are split into one block
+    //of consecutive frames per algorithm instance, so that each frame can be initialized with its temporal neighbor.
+    const std::size_t blockCount = m_AlgorithmInitializer ? algorithmCount : frames.size();
+    std::vector<std::vector<mitk::TimeStepType> > blocks(blockCount);
+    for (std::size_t block = 0; block < blockCount; ++block)
+    {
+      const std::size_t begin = block * frames.size() / blockCount;
+      const std::size_t end = (block + 1) * frames.size() / blockCount;
+      blocks[block].assign(frames.begin() + begin, frames.begin() + end);
+    }
+
+    //each block takes an idle algorithm instance and returns it afterwards
+    std::vector<RegistrationAlgorithmPointer> idleAlgorithms = this->CreateFrameAlgorithms(algorithmCount);
+    std::mutex algorithmMutex;
+    std::mutex frameMutex;
+
+    mitk::ParallelFor(blocks.size(), [&](std::size_t block)
+    {
+      RegistrationAlgorithmPointer algorithm;
+      {
+        std::lock_guard<std::mutex> lock(algorithmMutex);
+        algorithm = idleAlgorithms.back();
+        idleAlgorithms.pop_back();
+      }
+
+      try
+      {
+        RegistrationPointer previousReg;
+        for (const auto& frame : blocks[block])
+        {
+          //the moving frames are extracted when needed, so only the frames in progress are held in memory.
+          //The time selectors all access the same input and are therefore not run concurrently.
+          Image::Pointer movingFrame;
+          {
+            std::lock_guard<std::mutex> lock(frameMutex);
+            movingFrame = GetFrameImage(this->m_4DImage, frame);
+          }
+
+          //warm start with the registration of the temporal neighbor
+          if (m_AlgorithmInitializer && previousReg.IsNotNull())
+          {
+            m_AlgorithmInitializer(algorithm, previousReg);
+          }
+
+          previousReg = this->ProcessFrame(frame, algorithm, movingFrame, targetFrame, mask, outputBuffer, frameSize,
+                                           frameGeometries);
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(algorithmMutex);
+        idleAlgorithms.push_back(algorithm);
+        throw;
+      }
+
+      std::lock_guard<std::mutex> lock(algorithmMutex);
+      idleAlgorithms.push_back(algorithm);
+    }, static_cast<unsigned int>(algorithmCount));
+  }
+
+  for (const auto& frame : frames)
+  {
+    registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(frameGeometries[frame], frame);
+  }
 
-      mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
-                                       mitk::Image::ReferenceMemory));
+  this->m_Registered4DImage = registered4DImage;
+};
 
+std::vector<mitk::TimeFramesRegistrationHelper::RegistrationAlgorithmPointer>
+mitk::TimeFramesRegistrationHelper::CreateFrameAlgorithms(std::size_t count) const
+{
+  std::vector<RegistrationAlgorithmPointer> algorithms;
+  algorithms.push_back(m_Algorithm);
 
-      this->m_Registered4DImage->SetVolume(accessor.GetData(), i);
-      this->m_Registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(mappedFrame->GetGeometry(), i);
+  typedef ::map::algorithm::facet::MetaPropertyAlgorithmInterface MetaPropertyInterface;
+  const MetaPropertyInterface* pSourceMetaInterface = dynamic_cast<const MetaPropertyInterface*>(m_Algorithm.GetPointer());
 
-      m_Progress += progressDelta;
+  while (algorithms.size() < count)
+  {
+    RegistrationAlgorithmPointer algorithm = m_AlgorithmFactory();
+    if (algorithm.IsNull())
+    {
+      mitkThrow() << "Cannot register image. Algorithm factory did not create an algorithm.";
     }
-    else
+
+    //same configuration as the algorithm set by the user
+    MetaPropertyInterface* pMetaInterface = dynamic_cast<MetaPropertyInterface*>(algorithm.GetPointer());
+    if (pSourceMetaInterface && pMetaInterface)
     {
-      m_Progress += 3 * progressDelta;
+      for (const auto& info : pSourceMetaInterface->getPropertyInfos())
+      {
+        if (info->isReadable() && info->isWritable())
+        {
+          MetaPropertyInterface::MetaPropertyPointer property = pSourceMetaInterface->getProperty(info);
+          if (property)
+          {
+            pMetaInterface->setProperty(info, property);
+          }
+        }
+      }
     }
 
-    this->InvokeEvent(::itk::ProgressEvent());
+    algorithms.push_back(algorithm);
+  }
+
+  return algorithms;
+};
+
+mitk::TimeFramesRegistrationHelper::RegistrationPointer
+mitk::TimeFramesRegistrationHelper::ProcessFrame(mitk::TimeStepType frame, RegistrationAlgorithmBaseType* algorithm,
+    const mitk::Image* movingFrame, const mitk::Image* targetFrame, const mitk::Image* targetMask,
+    char* outputBuffer, std::size_t frameSize, std::vector<BaseGeometry::Pointer>& frameGeometries)
+{
+  const double progressDelta = 1.0 / ((this->m_4DImage->GetTimeSteps() - 1) * 3.0);
+
+  RegistrationPointer reg = DoFrameRegistration(algorithm, movingFrame, targetFrame, targetMask);
 
+  this->AddProgress(progressDelta, ::mitk::FrameRegistrationEvent(nullptr,
+                    "Registred frame #" +::map::core::convert::toStr(frame)));
+
+  Image::Pointer mappedFrame = DoFrameMapping(movingFrame, reg, targetFrame);
+
+  this->AddProgress(progressDelta, ::mitk::FrameMappingEvent(nullptr,
+                    "Mapped frame #" + ::map::core::convert::toStr(frame)));
+
+  mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
+                                   mitk::Image::ReferenceMemory));
+
+  const std::size_t mappedFrameSize = mappedFrame->GetPixelType().GetSize() * mappedFrame->GetDimension(0) *
+    mappedFrame->GetDimension(1) * mappedFrame->GetDimension(2);
+  if (mappedFrameSize != frameSize)
+  {
+    mitkThrow() << "Cannot register image. Mapped frame #" << frame << " does not match the frame size of the input image.";
   }
 
+  //each frame has its own part of the buffer, so the frames can be written concurrently
+  std::memcpy(outputBuffer + frame * frameSize, accessor.GetData(), frameSize);
+  frameGeometries[frame] = mappedFrame->GetGeometry();
+
+  this->AddProgress(progressDelta, ::itk::ProgressEvent());
+
+  return reg;
+};
+
+void
+mitk::TimeFramesRegistrationHelper::AddProgress(double delta, const ::itk::EventObject& event)
+{
+  std::lock_guard<std::mutex> lock(m_ProgressMutex);
+  m_Progress += delta;
+  this->InvokeEvent(event);
 };
 
 mitk::Image::Pointer
@@ -126,6 +296,20 @@ SetIgnoreList(const IgnoreListType& il)
   this->Modified();
 }
 
+void
+mitk::TimeFramesRegistrationHelper::SetAlgorithmFactory(const AlgorithmFactoryType& factory)
+{
+  m_AlgorithmFactory = factory;
+  this->Modified();
+}
+
+void
+mitk::TimeFramesRegistrationHelper::SetAlgorithmInitializer(const AlgorithmInitializerType& initializer)
+{
+  m_AlgorithmInitializer = initializer;
+  this->Modified();
+}
+
 void
 mitk::TimeFramesRegistrationHelper::ClearIgnoreList()
 {
@@ -135,16 +319,16 @@ mitk::TimeFramesRegistrationHelper::ClearIgnoreList()
 
 
 mitk::TimeFramesRegistrationHelper::RegistrationPointer
-mitk::TimeFramesRegistrationHelper::DoFrameRegistration(const mitk::Image* movingFrame,
-    const mitk::Image* targetFrame, const mitk::Image* targetMask) const
+mitk::TimeFramesRegistrationHelper::DoFrameRegistration(RegistrationAlgorithmBaseType* algorithm,
+    const mitk::Image* movingFrame, const mitk::Image* targetFrame, const mitk::Image* targetMask) const
 {
-  mitk::MITKAlgorithmHelper algHelper(m_Algorithm);
+  mitk::MITKAlgorithmHelper algHelper(algorithm);
   algHelper.SetAllowImageCasting(true);
   algHelper.SetData(movingFrame, targetFrame);
 
   if (targetMask)
   {
-    mitk::MaskedAlgorithmHelper maskHelper(m_Algorithm);
+    mitk::MaskedAlgorithmHelper maskHelper(algorithm);
     maskHelper.SetMasks(nullptr, targetMask);
   }
 
@@ -28,6 +28,9 @@
 
 #include "MitkMatchPointRegistrationExports.h"
 
+#include <functional>
+#include <mutex>
+
 namespace mitk
 {
 
@@ -39,6 +42,12 @@ namespace mitk
    * to the first frame of the image. The user can define frames that may be not registered. These frames will be copied directly.
    * Per default all frames will be registered.
    * The user may set a mask for the target frame (1st frame). If this mask image has mulitple time steps, the first time step will be used.
+   * The frames can be registered concurrently (see SetMaxConcurrentRegistrations). Each concurrent registration needs its
+   * own algorithm instance, therefore an algorithm factory has to be set in this case.
+   * Optionally each algorithm can be initialized with the registration of the previous frame (see SetAlgorithmInitializer),
+   * which speeds up the registration of series with smooth motion. In this case the frames are split into one block of
+   * consecutive frames per concurrent registration, and the first frame of each block is registered without warm start.
+   * Without initializer the result does not depend on the number of concurrent registrations.
    * The helper class invokes three eventtypes: \n
    * - mitk::FrameRegistrationEvent: when ever a frame was registered.
    * - mitk::FrameMappingEvent: when ever a frame was mapped registered.
@@ -58,6 +67,13 @@ namespace mitk
 
     typedef std::vector<mitk::TimeStepType> IgnoreListType;
 
+    /** Creates a new instance of the registration algorithm. The meta properties of the algorithm set via SetAlgorithm
+     * are transferred to each created instance.*/
+    typedef std::function<RegistrationAlgorithmPointer()> AlgorithmFactoryType;
+    /** Initializes an algorithm with the registration of the temporal neighbor of the next frame (warm start),
+     * e.g. by setting the initial transform parameters of the algorithm.*/
+    typedef std::function<void(RegistrationAlgorithmBaseType *, const RegistrationType *)> AlgorithmInitializerType;
+
     itkSetConstObjectMacro(4DImage, Image);
     itkGetConstObjectMacro(4DImage, Image);
 
@@ -82,6 +98,17 @@ namespace mitk
     itkSetMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
     itkGetConstMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
 
+    /** Maximum number of frames that are registered at the same time. Default is 1 (frames are registered sequentially).
+     * Values above 1 are only used if an algorithm factory is set.*/
+    itkSetMacro(MaxConcurrentRegistrations, unsigned int);
+    itkGetConstMacro(MaxConcurrentRegistrations, unsigned int);
+
+    void SetAlgorithmFactory(const AlgorithmFactoryType &factory);
+    /** Sets the warm start of the frame registrations. Not set by default, i.e. every frame is registered from the
+     * initial state of its algorithm instance. The initializer is called concurrently for different algorithm
+     * instances if frames are registered concurrently.*/
+    void SetAlgorithmInitializer(const AlgorithmInitializerType &initializer);
+
     /** cleares the ignore list. Therefore all frames will be processed.*/
     void ClearIgnoreList();
     void SetIgnoreList(const IgnoreListType& il);
@@ -114,6 +141,7 @@ namespace mitk
       m_AllowUnregPixels(true),
       m_ErrorValue(0),
       m_InterpolatorType(mitk::ImageMappingInterpolator::Linear),
+      m_MaxConcurrentRegistrations(1),
       m_Progress(0)
     {
       m_4DImage = nullptr;
@@ -123,7 +151,7 @@ namespace mitk
 
     ~TimeFramesRegistrationHelper() override {};
 
-    RegistrationPointer DoFrameRegistration(const mitk::Image* movingFrame,
+    RegistrationPointer DoFrameRegistration(RegistrationAlgorithmBaseType* algorithm, const mitk::Image* movingFrame,
                                             const mitk::Image* targetFrame, const mitk::Image* targetMask) const;
 
     mitk::Image::Pointer DoFrameMapping(const mitk::Image* movingFrame, const RegistrationType* reg,
@@ -136,6 +164,19 @@ namespace mitk
 
     mitk::Image::Pointer GetFrameImage(const mitk::Image* image, mitk::TimePointType timePoint) const;
 
+    /** Creates an algorithm instance for each concurrent registration. The first one is m_Algorithm.*/
+    std::vector<RegistrationAlgorithmPointer> CreateFrameAlgorithms(std::size_t count) const;
+
+    /** Registers and maps one frame. The mapped frame is written directly into its part of outputBuffer,
+    * its geometry into frameGeometries. Frames of different time steps can be processed concurrently
+    * with different algorithm instances. Returns the registration of the frame.*/
+    RegistrationPointer ProcessFrame(mitk::TimeStepType frame, RegistrationAlgorithmBaseType* algorithm,
+                                     const mitk::Image* movingFrame, const mitk::Image* targetFrame,
+                                     const mitk::Image* targetMask, char* outputBuffer, std::size_t frameSize,
+                                     std::vector<BaseGeometry::Pointer>& frameGeometries);
+
+    void AddProgress(double delta, const ::itk::EventObject& event);
+
     RegistrationAlgorithmPointer m_Algorithm;
 
   private:
@@ -156,7 +197,13 @@ namespace mitk
     /** Type of interpolator. Only relevant for images and if m_doGeometryRefinement is false. */
     mitk::ImageMappingInterpolator::Type m_InterpolatorType;
 
+    unsigned int m_MaxConcurrentRegistrations;
+    AlgorithmFactoryType m_AlgorithmFactory;
+    AlgorithmInitializerType m_AlgorithmInitializer;
+
     double m_Progress;
+    /** Guards m_Progress and serializes the events of concurrent registrations.*/
+    std::mutex m_ProgressMutex;
   };
 
 }
@@ -18,6 +18,30 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTestFixture.h"
 
 #include "mitkTimeFramesRegistrationHelper.h"
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+
+#include <mapAlgorithmIdentificationInterface.h>
+#include <mapDiscreteElements.h>
+#include <mapDummyImageRegistrationAlgorithm.h>
+
+#include <atomic>
+#include <cstring>
+
+namespace
+{
+  mapGenerateAlgorithmUIDPolicyMacro(TestIdentityRegIDPolicy, "de.dkfz.dipp", "TestIdentity", "1.0.0", "");
+
+  typedef map::core::discrete::Elements<3>::InternalImageType FrameImageType;
+  typedef map::algorithm::DummyImageRegistrationAlgorithm<FrameImageType, FrameImageType, TestIdentityRegIDPolicy>
+    IdentityAlgorithmType;
+
+  mitk::TimeFramesRegistrationHelper::RegistrationAlgorithmPointer CreateIdentityAlgorithm()
+  {
+    IdentityAlgorithmType::Pointer algorithm = IdentityAlgorithmType::New();
+    return algorithm.GetPointer();
+  }
+}
 
 class mitkTimeFramesRegistrationHelperTestSuite : public mitk::TestFixture
 {
@@ -29,10 +53,38 @@ class mitkTimeFramesRegistrationHelperTestSuite : public mitk::TestFixture
   MITK_TEST(SetAllowUnregPixels_GetAllowUnregPixels);
   MITK_TEST(SetInterpolatorType_GetInterpolatorType);
   MITK_TEST(Set_Get_Clear_IgnoreList);
+  MITK_TEST(SetMaxConcurrentRegistrations_GetMaxConcurrentRegistrations);
+  MITK_TEST(SetAlgorithmFactory);
+  MITK_TEST(Generate_ConcurrentSameAsSequential);
+  MITK_TEST(Generate_AlgorithmInitializer);
   CPPUNIT_TEST_SUITE_END();
 private:
   mitk::TimeFramesRegistrationHelper::Pointer frameRegHelper;
   mitk::TimeFramesRegistrationHelper::IgnoreListType ignoreList;
+  mitk::Image::Pointer image4D;
+
+  mitk::Image::Pointer GenerateRegisteredImage(unsigned int maxConcurrentRegistrations,
+    const mitk::TimeFramesRegistrationHelper::AlgorithmInitializerType& initializer = nullptr)
+  {
+    mitk::TimeFramesRegistrationHelper::Pointer helper = mitk::TimeFramesRegistrationHelper::New();
+    helper->Set4DImage(image4D);
+    helper->SetAlgorithm(CreateIdentityAlgorithm());
+    helper->SetAlgorithmFactory(&CreateIdentityAlgorithm);
+    helper->SetAlgorithmInitializer(initializer);
+    helper->SetMaxConcurrentRegistrations(maxConcurrentRegistrations);
+    mitk::TimeFramesRegistrationHelper::IgnoreListType frameIgnoreList = { 2, 5 };
+    helper->SetIgnoreList(frameIgnoreList);
+    return helper->GetRegisteredImage();
+  }
+
+  bool EqualFrames(mitk::Image* image, mitk::Image* otherImage, unsigned int timeStep)
+  {
+    mitk::ImageReadAccessor accessor(image, image->GetVolumeData(timeStep));
+    mitk::ImageReadAccessor otherAccessor(otherImage, otherImage->GetVolumeData(timeStep));
+    const std::size_t frameSize = image->GetPixelType().GetSize() * image->GetDimension(0) *
+      image->GetDimension(1) * image->GetDimension(2);
+    return std::memcmp(accessor.GetData(), otherAccessor.GetData(), frameSize) == 0;
+  }
 
 public:
   void setUp() override
@@ -41,6 +93,7 @@ public:
     ignoreList.clear();
     ignoreList.push_back(2);
     ignoreList.push_back(13);
+    image4D = mitk::ImageGenerator::GenerateRandomImage<float>(10, 9, 6, 7, 1.0, 1.5, 2.0);
   }
 
   void tearDown() override
@@ -106,6 +159,75 @@ public:
     CPPUNIT_ASSERT(frameRegHelper->GetIgnoreList().empty());
   }
 
+  void SetMaxConcurrentRegistrations_GetMaxConcurrentRegistrations()
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on default value", 1u,
+                                 frameRegHelper->GetMaxConcurrentRegistrations());
+    frameRegHelper->SetMaxConcurrentRegistrations(8);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on changed value", 8u,
+                                 frameRegHelper->GetMaxConcurrentRegistrations());
+  }
+
+  void SetAlgorithmFactory()
+  {
+    itk::ModifiedTimeType mtime = frameRegHelper->GetMTime();
+    frameRegHelper->SetAlgorithmFactory([]() { return mitk::TimeFramesRegistrationHelper::RegistrationAlgorithmPointer(); });
+    CPPUNIT_ASSERT(mtime < frameRegHelper->GetMTime());
+  }
+
+  void Generate_ConcurrentSameAsSequential()
+  {
+    mitk::Image::Pointer sequential = GenerateRegisteredImage(1);
+    mitk::Image::Pointer concurrent = GenerateRegisteredImage(4);
+
+    CPPUNIT_ASSERT(sequential.IsNotNull());
+    CPPUNIT_ASSERT(concurrent.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(image4D->GetTimeSteps(), concurrent->GetTimeSteps());
+
+    for (unsigned int t = 0; t < image4D->GetTimeSteps(); ++t)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Concurrent registration has the same frame geometries as sequential registration",
+        mitk::Equal(*(sequential->GetGeometry(t)), *(concurrent->GetGeometry(t)), mitk::eps, true));
+      CPPUNIT_ASSERT_MESSAGE("Concurrent registration has the same frames as sequential registration",
+        EqualFrames(sequential, concurrent, t));
+    }
+
+    //the target frame and the ignored frames are copied from the input
+    for (unsigned int t : { 0, 2, 5 })
+    {
+      CPPUNIT_ASSERT_MESSAGE("Target frame and ignored frames are copied from the input", EqualFrames(image4D, concurrent, t));
+    }
+  }
+
+  void Generate_AlgorithmInitializer()
+  {
+    std::atomic<unsigned int> initializations(0);
+    auto initializer = [&initializations](mitk::TimeFramesRegistrationHelper::RegistrationAlgorithmBaseType* algorithm,
+      const mitk::TimeFramesRegistrationHelper::RegistrationType* reg)
+    {
+      CPPUNIT_ASSERT(algorithm != nullptr);
+      CPPUNIT_ASSERT(reg != nullptr);
+      ++initializations;
+    };
+
+    mitk::Image::Pointer reference = GenerateRegisteredImage(1);
+
+    //frames 1, 3, 4 and 6 are registered, all but the first are initialized with their predecessor
+    mitk::Image::Pointer sequential = GenerateRegisteredImage(1, initializer);
+    CPPUNIT_ASSERT_EQUAL(3u, initializations.load());
+
+    //two blocks {1, 3} and {4, 6}, the first frame of each block is not initialized
+    initializations = 0;
+    mitk::Image::Pointer concurrent = GenerateRegisteredImage(2, initializer);
+    CPPUNIT_ASSERT_EQUAL(2u, initializations.load());
+
+    for (unsigned int t = 0; t < image4D->GetTimeSteps(); ++t)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Warm start with the identity algorithm does not change the frames",
+        EqualFrames(reference, sequential, t) && EqualFrames(reference, concurrent, t));
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkTimeFramesRegistrationHelper)
\ No newline at end of file
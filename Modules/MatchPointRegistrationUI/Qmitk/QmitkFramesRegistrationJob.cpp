@@ -153,7 +153,7 @@ void QmitkFramesRegistrationJob::OnMapAlgorithmEvent(::itk::Object *, const itk:
 }
 
 QmitkFramesRegistrationJob::QmitkFramesRegistrationJob(map::algorithm::RegistrationAlgorithmBase *pAlgorithm)
-  : m_TargetDataUID("Missing target UID"), m_spLoadedAlgorithm(pAlgorithm)
+  : m_TargetDataUID("Missing target UID"), m_MaxConcurrentRegistrations(1), m_spLoadedAlgorithm(pAlgorithm)
 {
   m_MappedName = "Unnamed RegJob";
 
@@ -179,6 +179,8 @@ void QmitkFramesRegistrationJob::run()
     m_helper->SetTargetMask(this->m_spTargetMask);
     m_helper->SetAlgorithm(this->m_spLoadedAlgorithm);
     m_helper->SetIgnoreList(this->m_IgnoreList);
+    m_helper->SetAlgorithmFactory(this->m_AlgorithmFactory);
+    m_helper->SetMaxConcurrentRegistrations(this->m_MaxConcurrentRegistrations);
 
     m_helper->SetAllowUndefPixels(this->m_allowUndefPixels);
     m_helper->SetAllowUnregPixels(this->m_allowUnregPixels);
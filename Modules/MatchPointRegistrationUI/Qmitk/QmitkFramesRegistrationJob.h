@@ -81,6 +81,10 @@ public:
   mitk::NodeUIDType m_TargetDataUID;
   mitk::NodeUIDType m_TargetMaskDataUID;
 
+  /** Creates further algorithm instances for concurrent frame registrations (see mitk::TimeFramesRegistrationHelper).*/
+  mitk::TimeFramesRegistrationHelper::AlgorithmFactoryType m_AlgorithmFactory;
+  unsigned int m_MaxConcurrentRegistrations;
+
   const map::algorithm::RegistrationAlgorithmBase *GetLoadedAlgorithm() const;
 
 private:
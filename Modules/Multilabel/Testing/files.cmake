@@ -1,8 +1,10 @@
 set(MODULE_TESTS
     mitkLabelTest.cpp
+    mitkCompressedLabelLayerTest.cpp
     mitkLabelSetTest.cpp
     mitkLabelSetImageTest.cpp
     mitkLabelSetImageIOTest.cpp
     mitkLabelSetImageSurfaceStampFilterTest.cpp
+    mitkLabelSetImageToSurfaceFilterTest.cpp
 )
 
@@ -0,0 +1,200 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkCompressedLabelLayer.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <algorithm>
+#include <vector>
+
+class mitkCompressedLabelLayerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkCompressedLabelLayerTestSuite);
+  MITK_TEST(TestInitialize);
+  MITK_TEST(TestSetAndGetBuffer);
+  MITK_TEST(TestGetRegionBuffer);
+  MITK_TEST(TestLabelBoundingBox);
+  MITK_TEST(TestLabelMedianIndex);
+  MITK_TEST(TestReplaceLabel);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::CompressedLabelLayer::Pointer m_Layer;
+  std::vector<mitk::CompressedLabelLayer::PixelType> m_Buffer;
+  unsigned int m_Dimensions[3];
+
+  std::size_t GetOffset(unsigned int x, unsigned int y, unsigned int z) const
+  {
+    return (static_cast<std::size_t>(z) * m_Dimensions[1] + y) * m_Dimensions[0] + x;
+  }
+
+public:
+  void setUp() override
+  {
+    // the sizes are no multiples of the block size to cover the border blocks
+    m_Dimensions[0] = 70;
+    m_Dimensions[1] = 45;
+    m_Dimensions[2] = 33;
+
+    m_Buffer.assign(static_cast<std::size_t>(m_Dimensions[0]) * m_Dimensions[1] * m_Dimensions[2], 0);
+
+    // label 1: a box crossing block borders
+    for (unsigned int z = 10; z < 20; ++z)
+      for (unsigned int y = 30; y < 40; ++y)
+        for (unsigned int x = 28; x < 66; ++x)
+          m_Buffer[GetOffset(x, y, z)] = 1;
+
+    // label 2: two single voxels
+    m_Buffer[GetOffset(3, 4, 5)] = 2;
+    m_Buffer[GetOffset(69, 44, 32)] = 2;
+
+    m_Layer = mitk::CompressedLabelLayer::New();
+    m_Layer->Initialize(3, m_Dimensions);
+    m_Layer->SetBuffer(m_Buffer.data());
+  }
+
+  void tearDown() override
+  {
+    m_Layer = nullptr;
+    m_Buffer.clear();
+  }
+
+  void TestInitialize()
+  {
+    mitk::CompressedLabelLayer::Pointer layer = mitk::CompressedLabelLayer::New();
+    unsigned int dimensions[4] = {40, 40, 40, 2};
+    layer->Initialize(4, dimensions, 5);
+
+    CPPUNIT_ASSERT_MESSAGE("Wrong number of voxels", layer->GetNumberOfVoxels() == 40 * 40 * 40 * 2);
+    CPPUNIT_ASSERT_MESSAGE("Initial value is missing", layer->ContainsLabel(5));
+    CPPUNIT_ASSERT_MESSAGE("Unexpected label", !layer->ContainsLabel(0));
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count", layer->GetLabelVoxelCount(5) == layer->GetNumberOfVoxels());
+    CPPUNIT_ASSERT_MESSAGE("Uniform layer should not store voxels",
+                           layer->GetMemorySize() < layer->GetNumberOfVoxels() * sizeof(mitk::Label::PixelType) / 10);
+
+    CPPUNIT_ASSERT_THROW(layer->Initialize(2, dimensions), mitk::Exception);
+  }
+
+  void TestSetAndGetBuffer()
+  {
+    std::vector<mitk::CompressedLabelLayer::PixelType> buffer(m_Layer->GetNumberOfVoxels(), 42);
+    m_Layer->GetBuffer(buffer.data());
+    CPPUNIT_ASSERT_MESSAGE("Decompressed buffer differs from original buffer", buffer == m_Buffer);
+
+    std::vector<mitk::CompressedLabelLayer::PixelType> expectedLabels = {0, 1, 2};
+    CPPUNIT_ASSERT_MESSAGE("Wrong labels", m_Layer->GetLabels() == expectedLabels);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of label 1", m_Layer->GetLabelVoxelCount(1) == 10 * 10 * 38);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of label 2", m_Layer->GetLabelVoxelCount(2) == 2);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of label 3", m_Layer->GetLabelVoxelCount(3) == 0);
+  }
+
+  void TestGetRegionBuffer()
+  {
+    // one slice in each direction, crossing block borders, and a box
+    const unsigned int begins[4][3] = {{0, 0, 15}, {0, 35, 0}, {65, 0, 0}, {20, 25, 8}};
+    const unsigned int sizes[4][3] = {{70, 45, 1}, {70, 1, 33}, {1, 45, 33}, {40, 17, 20}};
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+      mitk::CompressedLabelLayer::RegionType region;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        region.SetIndex(i, begins[r][i]);
+        region.SetSize(i, sizes[r][i]);
+      }
+      region.SetIndex(3, 0);
+      region.SetSize(3, 1);
+
+      std::vector<mitk::CompressedLabelLayer::PixelType> buffer(region.GetNumberOfPixels(), 42);
+      m_Layer->GetRegionBuffer(region, buffer.data());
+
+      std::vector<mitk::CompressedLabelLayer::PixelType> expected;
+      for (unsigned int z = begins[r][2]; z < begins[r][2] + sizes[r][2]; ++z)
+        for (unsigned int y = begins[r][1]; y < begins[r][1] + sizes[r][1]; ++y)
+          for (unsigned int x = begins[r][0]; x < begins[r][0] + sizes[r][0]; ++x)
+            expected.push_back(m_Buffer[GetOffset(x, y, z)]);
+      CPPUNIT_ASSERT_MESSAGE("Region buffer differs from the region of the original buffer", buffer == expected);
+    }
+
+    mitk::CompressedLabelLayer::RegionType outside;
+    outside.SetIndex(0, 60);
+    outside.SetSize(0, 20);
+    outside.SetSize(1, 1);
+    outside.SetSize(2, 1);
+    outside.SetSize(3, 1);
+    std::vector<mitk::CompressedLabelLayer::PixelType> buffer(outside.GetNumberOfPixels());
+    CPPUNIT_ASSERT_THROW(m_Layer->GetRegionBuffer(outside, buffer.data()), mitk::Exception);
+  }
+
+  void TestLabelBoundingBox()
+  {
+    mitk::CompressedLabelLayer::RegionType region;
+    CPPUNIT_ASSERT_MESSAGE("Bounding box of non-existing label", !m_Layer->GetLabelBoundingBox(3, region));
+
+    CPPUNIT_ASSERT(m_Layer->GetLabelBoundingBox(1, region));
+    CPPUNIT_ASSERT_MESSAGE("Wrong bounding box index of label 1",
+                           region.GetIndex(0) == 28 && region.GetIndex(1) == 30 && region.GetIndex(2) == 10 &&
+                             region.GetIndex(3) == 0);
+    CPPUNIT_ASSERT_MESSAGE("Wrong bounding box size of label 1",
+                           region.GetSize(0) == 38 && region.GetSize(1) == 10 && region.GetSize(2) == 10 &&
+                             region.GetSize(3) == 1);
+
+    CPPUNIT_ASSERT(m_Layer->GetLabelBoundingBox(2, region));
+    CPPUNIT_ASSERT_MESSAGE("Wrong bounding box index of label 2",
+                           region.GetIndex(0) == 3 && region.GetIndex(1) == 4 && region.GetIndex(2) == 5);
+    CPPUNIT_ASSERT_MESSAGE("Wrong bounding box size of label 2",
+                           region.GetSize(0) == 67 && region.GetSize(1) == 41 && region.GetSize(2) == 28);
+  }
+
+  void TestLabelMedianIndex()
+  {
+    // the median voxel of a dense buffer in buffer order
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < m_Buffer.size(); ++i)
+      if (m_Buffer[i] == 1)
+        offsets.push_back(i);
+    const std::size_t median = offsets[offsets.size() / 2];
+
+    mitk::CompressedLabelLayer::IndexType index;
+    CPPUNIT_ASSERT(m_Layer->GetLabelMedianIndex(1, index));
+    CPPUNIT_ASSERT_MESSAGE("Wrong median index of label 1",
+                           GetOffset(index[0], index[1], index[2]) == median && index[3] == 0);
+
+    CPPUNIT_ASSERT(m_Layer->GetLabelMedianIndex(2, index));
+    CPPUNIT_ASSERT_MESSAGE("Wrong median index of label 2", GetOffset(index[0], index[1], index[2]) == GetOffset(69, 44, 32));
+
+    CPPUNIT_ASSERT_MESSAGE("Median index of non-existing label", !m_Layer->GetLabelMedianIndex(3, index));
+  }
+
+  void TestReplaceLabel()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Wrong number of replaced voxels", m_Layer->ReplaceLabel(2, 1) == 2);
+    CPPUNIT_ASSERT_MESSAGE("Label 2 was not replaced", !m_Layer->ContainsLabel(2));
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of merged label", m_Layer->GetLabelVoxelCount(1) == 10 * 10 * 38 + 2);
+
+    CPPUNIT_ASSERT_MESSAGE("Wrong number of erased voxels", m_Layer->ReplaceLabel(1, 0) == 10 * 10 * 38 + 2);
+    CPPUNIT_ASSERT_MESSAGE("Layer should only contain background", m_Layer->GetLabels().size() == 1);
+    CPPUNIT_ASSERT_MESSAGE("Empty layer should not store voxels",
+                           m_Layer->GetMemorySize() < m_Layer->GetNumberOfVoxels() * sizeof(mitk::Label::PixelType) / 10);
+
+    std::vector<mitk::CompressedLabelLayer::PixelType> buffer(m_Layer->GetNumberOfVoxels(), 42);
+    m_Layer->GetBuffer(buffer.data());
+    CPPUNIT_ASSERT_MESSAGE("Erased layer is not empty",
+                           std::count(buffer.begin(), buffer.end(), 0) == static_cast<long>(buffer.size()));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkCompressedLabelLayer)
@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkIOUtil.h>
 #include <mitkImageStatisticsHolder.h>
+#include <mitkImagePixelReadAccessor.h>
 #include <mitkLabelSetImage.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
@@ -38,6 +39,8 @@ class mitkLabelSetImageTestSuite : public mitk::TestFixture
   MITK_TEST(TestRemoveLayer);
   MITK_TEST(TestRemoveLabels);
   MITK_TEST(TestMergeLabel);
+  MITK_TEST(TestEraseLabel_DefaultsToActiveLayer);
+  MITK_TEST(TestGetLayerSlice);
   // TODO check it these functionalities can be moved into a process object
   //  MITK_TEST(TestMergeLabels);
   //  MITK_TEST(TestConcatenate);
@@ -443,6 +446,72 @@ public:
     // Check if merge label has 507 + 823 = 1330 pixels
     CPPUNIT_ASSERT_MESSAGE("Label with value 7 was not remove from the image", m_LabelSetImage->GetStatistics()->GetCountOfMaxValuedVoxels() == 1330);
   }
+
+  void TestEraseLabel_DefaultsToActiveLayer()
+  {
+    mitk::Image::Pointer image =
+      mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Multilabel/LabelSetTestInitializeImage.nrrd"));
+    m_LabelSetImage->InitializeByLabeledImage(image);
+    m_LabelSetImage->AddLayer();
+
+    // without a layer the active (empty) layer is used, the labels of layer 0 stay
+    m_LabelSetImage->EraseLabel(7);
+    m_LabelSetImage->SetActiveLayer(0);
+    CPPUNIT_ASSERT_MESSAGE("Label with value 7 was removed from an inactive layer",
+                           m_LabelSetImage->GetStatistics()->GetScalarValueMax() == 7);
+
+    m_LabelSetImage->EraseLabel(7);
+    CPPUNIT_ASSERT_MESSAGE("Label with value 7 was not removed from the active layer",
+                           m_LabelSetImage->GetStatistics()->GetScalarValueMax() == 6);
+  }
+
+  void TestGetLayerSlice()
+  {
+    mitk::Image::Pointer image =
+      mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Multilabel/LabelSetTestInitializeImage.nrrd"));
+    m_LabelSetImage->InitializeByLabeledImage(image);
+    m_LabelSetImage->AddLayer();
+
+    typedef mitk::LabelSetImage::PixelType PixelType;
+    mitk::Image::ConstPointer layerImage = m_LabelSetImage->GetLayerImage(0);
+    mitk::ImagePixelReadAccessor<PixelType, 3> layerAccessor(layerImage);
+
+    const unsigned int z = m_LabelSetImage->GetDimension(2) / 2;
+    mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+    plane->InitializeStandardPlane(m_LabelSetImage->GetGeometry());
+    mitk::Point3D planeOrigin = plane->GetOrigin();
+    mitk::Point3D sliceIndex;
+    m_LabelSetImage->GetGeometry()->WorldToIndex(planeOrigin, sliceIndex);
+    sliceIndex[2] = z;
+    m_LabelSetImage->GetGeometry()->IndexToWorld(sliceIndex, planeOrigin);
+    plane->SetOrigin(planeOrigin);
+
+    mitk::Image::Pointer slice = m_LabelSetImage->GetLayerSlice(0, plane, 0);
+    CPPUNIT_ASSERT_MESSAGE("Slice of an axial plane is not one voxel thick", slice->GetDimension(2) == 1);
+
+    mitk::Point3D sliceOrigin;
+    m_LabelSetImage->GetGeometry()->WorldToIndex(slice->GetGeometry()->GetOrigin(), sliceOrigin);
+    CPPUNIT_ASSERT_MESSAGE("Slice has the wrong position", mitk::Equal(sliceOrigin[2], z));
+
+    mitk::ImagePixelReadAccessor<PixelType, 3> sliceAccessor(slice);
+    bool equal = true;
+    itk::Index<3> index;
+    itk::Index<3> layerIndex;
+    index[2] = 0;
+    layerIndex[2] = z;
+    for (unsigned int y = 0; y < slice->GetDimension(1); ++y)
+    {
+      index[1] = layerIndex[1] = y;
+      for (unsigned int x = 0; x < slice->GetDimension(0); ++x)
+      {
+        index[0] = layerIndex[0] = x;
+        equal &= sliceAccessor.GetPixelByIndex(index) == layerAccessor.GetPixelByIndex(layerIndex);
+      }
+    }
+    CPPUNIT_ASSERT_MESSAGE("Slice differs from the layer image", equal);
+
+    CPPUNIT_ASSERT_THROW(m_LabelSetImage->GetLayerSlice(1, plane, 0), mitk::Exception);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImage)
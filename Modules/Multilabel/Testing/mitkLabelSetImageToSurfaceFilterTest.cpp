@@ -0,0 +1,196 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImageWriteAccessor.h>
+#include <mitkLabelSetImageToSurfaceFilter.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <algorithm>
+
+#include <vtkPoints.h>
+
+class mitkLabelSetImageToSurfaceFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLabelSetImageToSurfaceFilterTestSuite);
+  MITK_TEST(AllLabels_OneSurfacePerLabel);
+  MITK_TEST(AllLabels_SameSurfaceAsRequestedLabel);
+  MITK_TEST(EditedLabel_OnlyEditedSurfaceRegenerated);
+  MITK_TEST(MovedVoxel_SameCountAndBounds_SurfaceRegenerated);
+  MITK_TEST(ModifiedOutput_CacheUnchanged);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef mitk::LabelSetImageToSurfaceFilter::LabelType LabelType;
+
+  mitk::Image::Pointer m_Image;
+
+  static const unsigned int Size = 30;
+
+  void FillBox(mitk::Image *image, LabelType label, unsigned int begin, unsigned int end)
+  {
+    mitk::ImageWriteAccessor accessor(image);
+    auto *data = static_cast<LabelType *>(accessor.GetData());
+    for (unsigned int z = begin; z < end; ++z)
+      for (unsigned int y = begin; y < end; ++y)
+        for (unsigned int x = begin; x < end; ++x)
+          data[(z * Size + y) * Size + x] = label;
+  }
+
+  void SetVoxel(unsigned int x, unsigned int y, unsigned int z, LabelType label)
+  {
+    mitk::ImageWriteAccessor accessor(m_Image);
+    static_cast<LabelType *>(accessor.GetData())[(z * Size + y) * Size + x] = label;
+  }
+
+  /** Checks that the surface lies within the box [begin, end) with a tolerance of one voxel */
+  bool IsInsideBox(vtkPolyData *polyData, double begin, double end)
+  {
+    double bounds[6];
+    polyData->GetBounds(bounds);
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      if (bounds[2 * d] < begin - 1 || bounds[2 * d + 1] > end + 1)
+        return false;
+    }
+    return true;
+  }
+
+public:
+  void setUp() override
+  {
+    unsigned int dimensions[3] = {Size, Size, Size};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<LabelType>(), 3, dimensions);
+    {
+      mitk::ImageWriteAccessor accessor(m_Image);
+      std::fill_n(static_cast<LabelType *>(accessor.GetData()), Size * Size * Size, 0);
+    }
+    this->FillBox(m_Image, 1, 3, 10);
+    this->FillBox(m_Image, 2, 15, 25);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void AllLabels_OneSurfacePerLabel()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("One output per label", 2u, static_cast<unsigned int>(filter->GetNumberOfIndexedOutputs()));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Output 0 is label 1", LabelType(1), filter->GetIndexToLabels().at(0));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Output 1 is label 2", LabelType(2), filter->GetIndexToLabels().at(1));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Voxels of label 2", 1000ul, filter->GetAvailableLabels().at(2));
+
+    vtkPolyData *first = filter->GetOutput(0)->GetVtkPolyData();
+    vtkPolyData *second = filter->GetOutput(1)->GetVtkPolyData();
+    CPPUNIT_ASSERT_MESSAGE("Surface of label 1 exists", first != nullptr && first->GetNumberOfPoints() > 0);
+    CPPUNIT_ASSERT_MESSAGE("Surface of label 2 exists", second != nullptr && second->GetNumberOfPoints() > 0);
+    CPPUNIT_ASSERT_MESSAGE("Surface of label 1 is at its voxels", this->IsInsideBox(first, 3, 10));
+    CPPUNIT_ASSERT_MESSAGE("Surface of label 2 is at its voxels", this->IsInsideBox(second, 15, 25));
+  }
+
+  void AllLabels_SameSurfaceAsRequestedLabel()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer allLabelsFilter = mitk::LabelSetImageToSurfaceFilter::New();
+    allLabelsFilter->SetInput(m_Image);
+    allLabelsFilter->GenerateAllLabelsOn();
+    allLabelsFilter->Update();
+
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->SetRequestedLabel(2);
+    filter->Update();
+
+    vtkPolyData *expected = allLabelsFilter->GetOutput(1)->GetVtkPolyData();
+    vtkPolyData *polyData = filter->GetOutput()->GetVtkPolyData();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(
+      "Same number of points", expected->GetNumberOfPoints(), polyData->GetNumberOfPoints());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Same number of cells", expected->GetNumberOfCells(), polyData->GetNumberOfCells());
+  }
+
+  void EditedLabel_OnlyEditedSurfaceRegenerated()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+
+    // the outputs are shallow copies of the cached surfaces, so a reused surface shares its points
+    vtkSmartPointer<vtkPoints> first = filter->GetOutput(0)->GetVtkPolyData()->GetPoints();
+    vtkSmartPointer<vtkPoints> second = filter->GetOutput(1)->GetVtkPolyData()->GetPoints();
+
+    this->FillBox(m_Image, 1, 3, 12);
+    m_Image->Modified();
+    filter->Update();
+
+    CPPUNIT_ASSERT_MESSAGE("Surface of the edited label is regenerated",
+                           filter->GetOutput(0)->GetVtkPolyData()->GetPoints() != first);
+    CPPUNIT_ASSERT_MESSAGE("Surface of the unchanged label is reused",
+                           filter->GetOutput(1)->GetVtkPolyData()->GetPoints() == second);
+    CPPUNIT_ASSERT_MESSAGE("Surface of the edited label follows the edit",
+                           this->IsInsideBox(filter->GetOutput(0)->GetVtkPolyData(), 3, 12));
+
+    filter->ClearLabelSurfaceCache();
+    filter->Update();
+    CPPUNIT_ASSERT_MESSAGE("Cleared cache regenerates all surfaces",
+                           filter->GetOutput(1)->GetVtkPolyData()->GetPoints() != second);
+  }
+
+  void MovedVoxel_SameCountAndBounds_SurfaceRegenerated()
+  {
+    this->SetVoxel(20, 20, 20, 0);
+
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+
+    vtkSmartPointer<vtkPoints> second = filter->GetOutput(1)->GetVtkPolyData()->GetPoints();
+
+    // moves the hole within label 2, voxel count and bounding box stay the same
+    this->SetVoxel(20, 20, 20, 2);
+    this->SetVoxel(21, 20, 20, 0);
+    m_Image->Modified();
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Voxels of label 2", 999ul, filter->GetAvailableLabels().at(2));
+    CPPUNIT_ASSERT_MESSAGE("Surface of the label with moved voxels is regenerated",
+                           filter->GetOutput(1)->GetVtkPolyData()->GetPoints() != second);
+  }
+
+  void ModifiedOutput_CacheUnchanged()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+
+    const vtkIdType numberOfPoints = filter->GetOutput(1)->GetVtkPolyData()->GetNumberOfPoints();
+    filter->GetOutput(1)->GetVtkPolyData()->SetPoints(vtkSmartPointer<vtkPoints>::New());
+
+    m_Image->Modified();
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Replacing the points of an output does not change the cached surface",
+                                 numberOfPoints,
+                                 filter->GetOutput(1)->GetVtkPolyData()->GetNumberOfPoints());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImageToSurfaceFilter)
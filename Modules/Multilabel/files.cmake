@@ -1,4 +1,5 @@
 set(CPP_FILES
+  mitkCompressedLabelLayer.cpp
   mitkLabel.cpp
   mitkLabelSet.cpp
   mitkLabelSetImage.cpp
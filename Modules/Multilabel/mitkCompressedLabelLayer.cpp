@@ -0,0 +1,583 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkCompressedLabelLayer.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+
+const unsigned int mitk::CompressedLabelLayer::BlockSize;
+
+mitk::CompressedLabelLayer::CompressedLabelLayer() : m_Dimension(0)
+{
+  std::fill(m_Dimensions, m_Dimensions + 4, 0);
+  std::fill(m_NumberOfBlocks, m_NumberOfBlocks + 4, 0);
+}
+
+mitk::CompressedLabelLayer::CompressedLabelLayer(const CompressedLabelLayer &other)
+  : itk::Object(), m_Dimension(other.m_Dimension), m_Blocks(other.m_Blocks), m_LabelBoxes(other.m_LabelBoxes)
+{
+  std::copy(other.m_Dimensions, other.m_Dimensions + 4, m_Dimensions);
+  std::copy(other.m_NumberOfBlocks, other.m_NumberOfBlocks + 4, m_NumberOfBlocks);
+}
+
+mitk::CompressedLabelLayer::~CompressedLabelLayer()
+{
+}
+
+void mitk::CompressedLabelLayer::Initialize(unsigned int dimension, const unsigned int *dimensions, PixelType value)
+{
+  if (dimension != 3 && dimension != 4)
+  {
+    mitkThrow() << dimension << "-dimensional label layers are not supported.";
+  }
+
+  m_Dimension = dimension;
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    m_Dimensions[i] = i < dimension ? dimensions[i] : 1;
+    m_NumberOfBlocks[i] = i < 3 ? (m_Dimensions[i] + BlockSize - 1) / BlockSize : m_Dimensions[i];
+  }
+
+  m_Blocks.clear();
+  m_Blocks.resize(static_cast<std::size_t>(m_NumberOfBlocks[0]) * m_NumberOfBlocks[1] * m_NumberOfBlocks[2] *
+                  m_NumberOfBlocks[3]);
+
+  unsigned int blockIndex[4];
+  unsigned int begin[3];
+  unsigned int size[3];
+  for (std::size_t blockId = 0; blockId < m_Blocks.size(); ++blockId)
+  {
+    this->GetBlockIndex(blockId, blockIndex);
+    this->GetBlockRegion(blockIndex, begin, size);
+
+    Block &block = m_Blocks[blockId];
+    block.m_UniformValue = value;
+    block.m_LabelCounts.assign(1, std::make_pair(value, size[0] * size[1] * size[2]));
+  }
+
+  this->UpdateLabelBoxes();
+  this->Modified();
+}
+
+void mitk::CompressedLabelLayer::SetBuffer(const PixelType *buffer)
+{
+  const std::size_t sliceSize = static_cast<std::size_t>(m_Dimensions[0]) * m_Dimensions[1];
+  const std::size_t volumeSize = sliceSize * m_Dimensions[2];
+
+  unsigned int blockIndex[4];
+  unsigned int begin[3];
+  unsigned int size[3];
+  for (std::size_t blockId = 0; blockId < m_Blocks.size(); ++blockId)
+  {
+    this->GetBlockIndex(blockId, blockIndex);
+    this->GetBlockRegion(blockIndex, begin, size);
+
+    Block &block = m_Blocks[blockId];
+    block.m_Voxels.resize(static_cast<std::size_t>(size[0]) * size[1] * size[2]);
+
+    auto target = block.m_Voxels.begin();
+    for (unsigned int z = 0; z < size[2]; ++z)
+    {
+      for (unsigned int y = 0; y < size[1]; ++y)
+      {
+        const PixelType *row = buffer + blockIndex[3] * volumeSize + (begin[2] + z) * sliceSize +
+                               static_cast<std::size_t>(begin[1] + y) * m_Dimensions[0] + begin[0];
+        target = std::copy(row, row + size[0], target);
+      }
+    }
+
+    CompactBlock(block);
+  }
+
+  this->UpdateLabelBoxes();
+  this->Modified();
+}
+
+void mitk::CompressedLabelLayer::GetBuffer(PixelType *buffer) const
+{
+  const std::size_t sliceSize = static_cast<std::size_t>(m_Dimensions[0]) * m_Dimensions[1];
+  const std::size_t volumeSize = sliceSize * m_Dimensions[2];
+
+  unsigned int blockIndex[4];
+  unsigned int begin[3];
+  unsigned int size[3];
+  for (std::size_t blockId = 0; blockId < m_Blocks.size(); ++blockId)
+  {
+    this->GetBlockIndex(blockId, blockIndex);
+    this->GetBlockRegion(blockIndex, begin, size);
+
+    const Block &block = m_Blocks[blockId];
+    auto source = block.m_Voxels.cbegin();
+    for (unsigned int z = 0; z < size[2]; ++z)
+    {
+      for (unsigned int y = 0; y < size[1]; ++y)
+      {
+        PixelType *row = buffer + blockIndex[3] * volumeSize + (begin[2] + z) * sliceSize +
+                         static_cast<std::size_t>(begin[1] + y) * m_Dimensions[0] + begin[0];
+        if (block.m_Voxels.empty())
+        {
+          std::fill(row, row + size[0], block.m_UniformValue);
+        }
+        else
+        {
+          std::copy(source, source + size[0], row);
+          source += size[0];
+        }
+      }
+    }
+  }
+}
+
+void mitk::CompressedLabelLayer::GetRegionBuffer(const RegionType &region, PixelType *buffer) const
+{
+  unsigned int regionBegin[4];
+  unsigned int regionEnd[4];
+  unsigned int firstBlock[4];
+  unsigned int lastBlock[4];
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    regionBegin[i] = static_cast<unsigned int>(region.GetIndex(i));
+    regionEnd[i] = regionBegin[i] + static_cast<unsigned int>(region.GetSize(i));
+    if (region.GetSize(i) == 0 || regionEnd[i] > m_Dimensions[i])
+    {
+      mitkThrow() << "Region is not inside the layer.";
+    }
+    const unsigned int blockSize = i < 3 ? BlockSize : 1;
+    firstBlock[i] = regionBegin[i] / blockSize;
+    lastBlock[i] = (regionEnd[i] - 1) / blockSize;
+  }
+
+  const std::size_t regionSliceSize = static_cast<std::size_t>(region.GetSize(0)) * region.GetSize(1);
+  const std::size_t regionVolumeSize = regionSliceSize * region.GetSize(2);
+
+  unsigned int blockIndex[4];
+  unsigned int begin[3];
+  unsigned int size[3];
+  for (blockIndex[3] = firstBlock[3]; blockIndex[3] <= lastBlock[3]; ++blockIndex[3])
+  {
+    for (blockIndex[2] = firstBlock[2]; blockIndex[2] <= lastBlock[2]; ++blockIndex[2])
+    {
+      for (blockIndex[1] = firstBlock[1]; blockIndex[1] <= lastBlock[1]; ++blockIndex[1])
+      {
+        for (blockIndex[0] = firstBlock[0]; blockIndex[0] <= lastBlock[0]; ++blockIndex[0])
+        {
+          this->GetBlockRegion(blockIndex, begin, size);
+          const Block &block = m_Blocks[this->GetBlockId(blockIndex)];
+
+          // the part of the block inside the region
+          unsigned int from[3];
+          unsigned int to[3];
+          for (unsigned int i = 0; i < 3; ++i)
+          {
+            from[i] = std::max(begin[i], regionBegin[i]);
+            to[i] = std::min(begin[i] + size[i], regionEnd[i]);
+          }
+
+          for (unsigned int z = from[2]; z < to[2]; ++z)
+          {
+            for (unsigned int y = from[1]; y < to[1]; ++y)
+            {
+              PixelType *row = buffer + (blockIndex[3] - regionBegin[3]) * regionVolumeSize +
+                               (z - regionBegin[2]) * regionSliceSize +
+                               static_cast<std::size_t>(y - regionBegin[1]) * region.GetSize(0) + (from[0] - regionBegin[0]);
+              if (block.m_Voxels.empty())
+              {
+                std::fill(row, row + (to[0] - from[0]), block.m_UniformValue);
+              }
+              else
+              {
+                auto source = block.m_Voxels.cbegin() +
+                              ((static_cast<std::size_t>(z - begin[2]) * size[1] + (y - begin[1])) * size[0] + (from[0] - begin[0]));
+                std::copy(source, source + (to[0] - from[0]), row);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+std::size_t mitk::CompressedLabelLayer::GetNumberOfVoxels() const
+{
+  return static_cast<std::size_t>(m_Dimensions[0]) * m_Dimensions[1] * m_Dimensions[2] * m_Dimensions[3];
+}
+
+std::size_t mitk::CompressedLabelLayer::GetMemorySize() const
+{
+  std::size_t memorySize = sizeof(Self) + m_Blocks.capacity() * sizeof(Block);
+  for (const Block &block : m_Blocks)
+  {
+    memorySize += block.m_Voxels.capacity() * sizeof(PixelType);
+    memorySize += block.m_LabelCounts.capacity() * sizeof(LabelCountsType::value_type);
+  }
+  // the map nodes carry about four pointers in addition to the value
+  memorySize += m_LabelBoxes.size() * (sizeof(std::pair<PixelType, BlockBox>) + 4 * sizeof(void *));
+  return memorySize;
+}
+
+bool mitk::CompressedLabelLayer::ContainsLabel(PixelType value) const
+{
+  return m_LabelBoxes.find(value) != m_LabelBoxes.end();
+}
+
+std::vector<mitk::CompressedLabelLayer::PixelType> mitk::CompressedLabelLayer::GetLabels() const
+{
+  std::vector<PixelType> labels;
+  labels.reserve(m_LabelBoxes.size());
+  for (auto it = m_LabelBoxes.cbegin(); it != m_LabelBoxes.cend(); ++it)
+  {
+    labels.push_back(it->first);
+  }
+  return labels;
+}
+
+std::size_t mitk::CompressedLabelLayer::GetLabelVoxelCount(PixelType value) const
+{
+  std::size_t count = 0;
+  for (std::size_t blockId : this->GetLabelBlockIds(value))
+  {
+    count += GetLabelCount(m_Blocks[blockId].m_LabelCounts, value);
+  }
+  return count;
+}
+
+bool mitk::CompressedLabelLayer::GetLabelBoundingBox(PixelType value, RegionType &region) const
+{
+  const std::vector<std::size_t> blockIds = this->GetLabelBlockIds(value);
+  if (blockIds.empty())
+  {
+    return false;
+  }
+
+  unsigned int minimum[4] = {m_Dimensions[0], m_Dimensions[1], m_Dimensions[2], m_Dimensions[3]};
+  unsigned int maximum[4] = {0, 0, 0, 0};
+
+  unsigned int blockIndex[4];
+  unsigned int begin[3];
+  unsigned int size[3];
+  for (std::size_t blockId : blockIds)
+  {
+    this->GetBlockIndex(blockId, blockIndex);
+    this->GetBlockRegion(blockIndex, begin, size);
+    minimum[3] = std::min(minimum[3], blockIndex[3]);
+    maximum[3] = std::max(maximum[3], blockIndex[3]);
+
+    const Block &block = m_Blocks[blockId];
+    if (block.m_Voxels.empty())
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        minimum[i] = std::min(minimum[i], begin[i]);
+        maximum[i] = std::max(maximum[i], begin[i] + size[i] - 1);
+      }
+      continue;
+    }
+
+    auto voxel = block.m_Voxels.cbegin();
+    for (unsigned int z = 0; z < size[2]; ++z)
+    {
+      for (unsigned int y = 0; y < size[1]; ++y)
+      {
+        for (unsigned int x = 0; x < size[0]; ++x, ++voxel)
+        {
+          if (*voxel == value)
+          {
+            const unsigned int position[3] = {begin[0] + x, begin[1] + y, begin[2] + z};
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+              minimum[i] = std::min(minimum[i], position[i]);
+              maximum[i] = std::max(maximum[i], position[i]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    region.SetIndex(i, minimum[i]);
+    region.SetSize(i, maximum[i] - minimum[i] + 1);
+  }
+  return true;
+}
+
+bool mitk::CompressedLabelLayer::GetLabelMedianIndex(PixelType value, IndexType &index) const
+{
+  auto boxIt = m_LabelBoxes.find(value);
+  if (boxIt == m_LabelBoxes.end())
+  {
+    return false;
+  }
+  const BlockBox &box = boxIt->second;
+
+  // the voxels of a label in buffer order are visited row by row, restricted to the blocks of the label
+  std::size_t remaining = this->GetLabelVoxelCount(value) / 2;
+
+  unsigned int blockIndex[4];
+  unsigned int begin[3];
+  unsigned int size[3];
+  for (unsigned int t = box.m_Min[3]; t <= box.m_Max[3]; ++t)
+  {
+    const unsigned int zBegin = box.m_Min[2] * BlockSize;
+    const unsigned int zEnd = std::min(m_Dimensions[2], (box.m_Max[2] + 1) * BlockSize);
+    for (unsigned int z = zBegin; z < zEnd; ++z)
+    {
+      const unsigned int yBegin = box.m_Min[1] * BlockSize;
+      const unsigned int yEnd = std::min(m_Dimensions[1], (box.m_Max[1] + 1) * BlockSize);
+      for (unsigned int y = yBegin; y < yEnd; ++y)
+      {
+        for (unsigned int bx = box.m_Min[0]; bx <= box.m_Max[0]; ++bx)
+        {
+          blockIndex[0] = bx;
+          blockIndex[1] = y / BlockSize;
+          blockIndex[2] = z / BlockSize;
+          blockIndex[3] = t;
+
+          const Block &block = m_Blocks[this->GetBlockId(blockIndex)];
+          if (GetLabelCount(block.m_LabelCounts, value) == 0)
+          {
+            continue;
+          }
+
+          this->GetBlockRegion(blockIndex, begin, size);
+          unsigned int x = 0;
+          if (block.m_Voxels.empty())
+          {
+            if (remaining >= size[0])
+            {
+              remaining -= size[0];
+              continue;
+            }
+            x = static_cast<unsigned int>(remaining);
+          }
+          else
+          {
+            auto row = block.m_Voxels.cbegin() +
+                       (static_cast<std::size_t>(z - begin[2]) * size[1] + (y - begin[1])) * size[0];
+            for (; x < size[0]; ++x)
+            {
+              if (row[x] == value)
+              {
+                if (remaining == 0)
+                {
+                  break;
+                }
+                --remaining;
+              }
+            }
+            if (x == size[0])
+            {
+              continue;
+            }
+          }
+
+          index[0] = begin[0] + x;
+          index[1] = y;
+          index[2] = z;
+          index[3] = t;
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+std::size_t mitk::CompressedLabelLayer::ReplaceLabel(PixelType oldValue, PixelType newValue)
+{
+  if (oldValue == newValue)
+  {
+    return 0;
+  }
+
+  std::size_t replaced = 0;
+  for (std::size_t blockId : this->GetLabelBlockIds(oldValue))
+  {
+    Block &block = m_Blocks[blockId];
+    const unsigned int count = GetLabelCount(block.m_LabelCounts, oldValue);
+    replaced += count;
+
+    if (block.m_Voxels.empty())
+    {
+      block.m_UniformValue = newValue;
+      block.m_LabelCounts.assign(1, std::make_pair(newValue, count));
+    }
+    else
+    {
+      std::replace(block.m_Voxels.begin(), block.m_Voxels.end(), oldValue, newValue);
+      CompactBlock(block);
+    }
+  }
+
+  if (replaced > 0)
+  {
+    this->UpdateLabelBoxes();
+    this->Modified();
+  }
+  return replaced;
+}
+
+std::size_t mitk::CompressedLabelLayer::GetBlockId(const unsigned int *blockIndex) const
+{
+  return ((static_cast<std::size_t>(blockIndex[3]) * m_NumberOfBlocks[2] + blockIndex[2]) * m_NumberOfBlocks[1] +
+          blockIndex[1]) *
+           m_NumberOfBlocks[0] +
+         blockIndex[0];
+}
+
+void mitk::CompressedLabelLayer::GetBlockIndex(std::size_t blockId, unsigned int *blockIndex) const
+{
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    blockIndex[i] = static_cast<unsigned int>(blockId % m_NumberOfBlocks[i]);
+    blockId /= m_NumberOfBlocks[i];
+  }
+  blockIndex[3] = static_cast<unsigned int>(blockId);
+}
+
+void mitk::CompressedLabelLayer::GetBlockRegion(const unsigned int *blockIndex,
+                                                unsigned int *begin,
+                                                unsigned int *size) const
+{
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    begin[i] = blockIndex[i] * BlockSize;
+    size[i] = std::min(BlockSize, m_Dimensions[i] - begin[i]);
+  }
+}
+
+std::vector<std::size_t> mitk::CompressedLabelLayer::GetLabelBlockIds(PixelType value) const
+{
+  std::vector<std::size_t> blockIds;
+
+  auto boxIt = m_LabelBoxes.find(value);
+  if (boxIt == m_LabelBoxes.end())
+  {
+    return blockIds;
+  }
+  const BlockBox &box = boxIt->second;
+
+  unsigned int blockIndex[4];
+  for (blockIndex[3] = box.m_Min[3]; blockIndex[3] <= box.m_Max[3]; ++blockIndex[3])
+  {
+    for (blockIndex[2] = box.m_Min[2]; blockIndex[2] <= box.m_Max[2]; ++blockIndex[2])
+    {
+      for (blockIndex[1] = box.m_Min[1]; blockIndex[1] <= box.m_Max[1]; ++blockIndex[1])
+      {
+        for (blockIndex[0] = box.m_Min[0]; blockIndex[0] <= box.m_Max[0]; ++blockIndex[0])
+        {
+          const std::size_t blockId = this->GetBlockId(blockIndex);
+          if (GetLabelCount(m_Blocks[blockId].m_LabelCounts, value) > 0)
+          {
+            blockIds.push_back(blockId);
+          }
+        }
+      }
+    }
+  }
+  return blockIds;
+}
+
+unsigned int mitk::CompressedLabelLayer::GetLabelCount(const LabelCountsType &labelCounts, PixelType value)
+{
+  auto it = std::lower_bound(
+    labelCounts.begin(), labelCounts.end(), value, [](const LabelCountsType::value_type &labelCount, PixelType v) {
+      return labelCount.first < v;
+    });
+  return (it != labelCounts.end() && it->first == value) ? it->second : 0;
+}
+
+void mitk::CompressedLabelLayer::CompactBlock(Block &block)
+{
+  block.m_LabelCounts.clear();
+  if (block.m_Voxels.empty())
+  {
+    return;
+  }
+
+  // labels form runs within a block, so the (short) list of counts is only searched at the end of a run
+  auto addRun = [&block](PixelType value, unsigned int length) {
+    for (auto &labelCount : block.m_LabelCounts)
+    {
+      if (labelCount.first == value)
+      {
+        labelCount.second += length;
+        return;
+      }
+    }
+    block.m_LabelCounts.push_back(std::make_pair(value, length));
+  };
+
+  PixelType runValue = block.m_Voxels.front();
+  unsigned int runLength = 0;
+  for (PixelType value : block.m_Voxels)
+  {
+    if (value == runValue)
+    {
+      ++runLength;
+    }
+    else
+    {
+      addRun(runValue, runLength);
+      runValue = value;
+      runLength = 1;
+    }
+  }
+  addRun(runValue, runLength);
+
+  std::sort(block.m_LabelCounts.begin(), block.m_LabelCounts.end());
+
+  if (block.m_LabelCounts.size() == 1)
+  {
+    block.m_UniformValue = runValue;
+    std::vector<PixelType>().swap(block.m_Voxels);
+  }
+}
+
+void mitk::CompressedLabelLayer::UpdateLabelBoxes()
+{
+  m_LabelBoxes.clear();
+
+  unsigned int blockIndex[4];
+  for (std::size_t blockId = 0; blockId < m_Blocks.size(); ++blockId)
+  {
+    this->GetBlockIndex(blockId, blockIndex);
+    for (const auto &labelCount : m_Blocks[blockId].m_LabelCounts)
+    {
+      auto boxIt = m_LabelBoxes.find(labelCount.first);
+      if (boxIt == m_LabelBoxes.end())
+      {
+        BlockBox box;
+        std::copy(blockIndex, blockIndex + 4, box.m_Min);
+        std::copy(blockIndex, blockIndex + 4, box.m_Max);
+        m_LabelBoxes.insert(std::make_pair(labelCount.first, box));
+      }
+      else
+      {
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+          boxIt->second.m_Min[i] = std::min(boxIt->second.m_Min[i], blockIndex[i]);
+          boxIt->second.m_Max[i] = std::max(boxIt->second.m_Max[i], blockIndex[i]);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,174 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkCompressedLabelLayer_H_
+#define __mitkCompressedLabelLayer_H_
+
+#include "MitkMultilabelExports.h"
+
+#include <mitkCommon.h>
+#include <mitkLabel.h>
+
+#include <itkImageRegion.h>
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  //
+  // Documentation
+  // @brief Memory efficient storage of one layer of a LabelSetImage.
+  //
+  // The layer (3D or 3D+t) is divided into blocks of BlockSize^3 voxels per time step. A block that contains
+  // a single label value is stored as that value only, all other blocks are stored densely. For each block the
+  // contained labels and their voxel counts are kept and for each label the bounding box of its blocks, so that
+  // per label operations only touch the blocks that contain the label. Layers that are mostly background
+  // therefore need memory in the order of their labeled voxels instead of the image size.
+  //
+  // Voxels are addressed in the order of a dense buffer (x fastest, then y, z and t).
+  // @ingroup Data
+  //
+  class MITKMULTILABEL_EXPORT CompressedLabelLayer : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(CompressedLabelLayer, itk::Object);
+    itkNewMacro(Self);
+
+    typedef mitk::Label::PixelType PixelType;
+    typedef itk::ImageRegion<4> RegionType;
+    typedef RegionType::IndexType IndexType;
+
+    /** Edge length of the blocks in voxels */
+    static const unsigned int BlockSize = 32;
+
+    /**
+     * @brief Initializes the layer with the given size, all voxels are set to value
+     * @param dimension 3 or 4
+     * @param dimensions size of the layer in voxels (x, y, z and, for 4 dimensions, t)
+     */
+    void Initialize(unsigned int dimension, const unsigned int *dimensions, PixelType value = 0);
+
+    /**
+     * @brief Replaces the content of the layer by a dense buffer of GetNumberOfVoxels() voxels
+     */
+    void SetBuffer(const PixelType *buffer);
+
+    /**
+     * @brief Writes the content of the layer into a dense buffer of GetNumberOfVoxels() voxels
+     */
+    void GetBuffer(PixelType *buffer) const;
+
+    /**
+     * @brief Writes the voxels of a region (time steps are the 4th dimension) into a dense buffer of
+     *        region.GetNumberOfPixels() voxels. Only the blocks that intersect the region are read.
+     */
+    void GetRegionBuffer(const RegionType &region, PixelType *buffer) const;
+
+    /**
+     * @brief Returns the number of voxels of the (uncompressed) layer
+     */
+    std::size_t GetNumberOfVoxels() const;
+
+    /**
+     * @brief Returns the approximate number of bytes used by the layer
+     */
+    std::size_t GetMemorySize() const;
+
+    /**
+     * @brief Returns true if at least one voxel has the given value
+     */
+    bool ContainsLabel(PixelType value) const;
+
+    /**
+     * @brief Returns all values that occur in the layer, in ascending order
+     */
+    std::vector<PixelType> GetLabels() const;
+
+    /**
+     * @brief Returns the number of voxels with the given value
+     */
+    std::size_t GetLabelVoxelCount(PixelType value) const;
+
+    /**
+     * @brief Determines the smallest region that contains all voxels of a label (time steps are the 4th dimension)
+     * @return false if the label does not occur in the layer
+     */
+    bool GetLabelBoundingBox(PixelType value, RegionType &region) const;
+
+    /**
+     * @brief Determines the voxel in the middle of the list of all voxels of a label (in buffer order)
+     * @return false if the label does not occur in the layer
+     */
+    bool GetLabelMedianIndex(PixelType value, IndexType &index) const;
+
+    /**
+     * @brief Replaces all voxels of value oldValue by newValue. Only touches the blocks that contain oldValue.
+     * @return the number of replaced voxels
+     */
+    std::size_t ReplaceLabel(PixelType oldValue, PixelType newValue);
+
+  protected:
+    mitkCloneMacro(Self)
+
+    CompressedLabelLayer();
+    CompressedLabelLayer(const CompressedLabelLayer &other);
+    ~CompressedLabelLayer() override;
+
+  private:
+    typedef std::vector<std::pair<PixelType, unsigned int>> LabelCountsType;
+
+    /** A uniform block (empty m_Voxels) has m_UniformValue in all its voxels */
+    struct Block
+    {
+      PixelType m_UniformValue;
+      std::vector<PixelType> m_Voxels;
+      LabelCountsType m_LabelCounts;
+    };
+
+    /** Bounding box of the blocks containing a label, in block coordinates (inclusive) */
+    struct BlockBox
+    {
+      unsigned int m_Min[4];
+      unsigned int m_Max[4];
+    };
+
+    std::size_t GetBlockId(const unsigned int *blockIndex) const;
+    void GetBlockIndex(std::size_t blockId, unsigned int *blockIndex) const;
+    void GetBlockRegion(const unsigned int *blockIndex, unsigned int *begin, unsigned int *size) const;
+
+    /** Returns the blocks that contain value, in buffer order */
+    std::vector<std::size_t> GetLabelBlockIds(PixelType value) const;
+
+    static unsigned int GetLabelCount(const LabelCountsType &labelCounts, PixelType value);
+
+    /** Determines the label counts of a dense block and makes it uniform if possible */
+    static void CompactBlock(Block &block);
+
+    void UpdateLabelBoxes();
+
+    unsigned int m_Dimension;
+    unsigned int m_Dimensions[4];
+    unsigned int m_NumberOfBlocks[4];
+    std::vector<Block> m_Blocks;
+    std::map<PixelType, BlockBox> m_LabelBoxes;
+  };
+} // namespace mitk
+
+#endif // __mitkCompressedLabelLayer_H_
@@ -16,9 +16,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkLabelSetImage.h"
 
+#include "mitkAbstractTransformGeometry.h"
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 #include "mitkInteractionConst.h"
 #include "mitkLookupTableProperty.h"
 #include "mitkPadImageFilter.h"
@@ -29,18 +31,61 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTransformPolyDataFilter.h>
 
 #include <itkImageRegionIterator.h>
+#include <itkMath.h>
 #include <itkQuadEdgeMesh.h>
 #include <itkTriangleMeshToBinaryImageFilter.h>
 //#include <itkRelabelComponentImageFilter.h>
 
 #include <itkCommand.h>
 
+#include <algorithm>
+#include <cmath>
+
 template <typename TPixel, unsigned int VDimensions>
 void SetToZero(itk::Image<TPixel, VDimensions> *source)
 {
   source->FillBuffer(0);
 }
 
+namespace
+{
+  // compressed layers always store mitk::Label::PixelType, images of other pixel types are converted
+
+  const mitk::Label::PixelType *GetLabelBuffer(const mitk::Label::PixelType *buffer,
+                                               std::size_t,
+                                               std::vector<mitk::Label::PixelType> &)
+  {
+    return buffer;
+  }
+
+  template <typename TPixel>
+  const mitk::Label::PixelType *GetLabelBuffer(const TPixel *buffer,
+                                               std::size_t size,
+                                               std::vector<mitk::Label::PixelType> &convertedBuffer)
+  {
+    convertedBuffer.resize(size);
+    std::transform(buffer, buffer + size, convertedBuffer.begin(), [](TPixel value) {
+      return static_cast<mitk::Label::PixelType>(value);
+    });
+    return convertedBuffer.data();
+  }
+
+  void SetLabelBuffer(const mitk::CompressedLabelLayer *layer, mitk::Label::PixelType *buffer, std::size_t)
+  {
+    layer->GetBuffer(buffer);
+  }
+
+  template <typename TPixel>
+  void SetLabelBuffer(const mitk::CompressedLabelLayer *layer, TPixel *buffer, std::size_t size)
+  {
+    std::vector<mitk::Label::PixelType> labelBuffer(size);
+    layer->GetBuffer(labelBuffer.data());
+    std::transform(labelBuffer.begin(), labelBuffer.end(), buffer, [](mitk::Label::PixelType value) {
+      return static_cast<TPixel>(value);
+    });
+  }
+}
+
 mitk::LabelSetImage::LabelSetImage()
   : mitk::Image(), m_ActiveLayer(0), m_activeLayerInvalid(false), m_ExteriorLabel(nullptr)
 {
@@ -71,9 +116,8 @@ mitk::LabelSetImage::LabelSetImage(const mitk::LabelSetImage &other)
     lsClone->AddObserver(itk::ModifiedEvent(), command);
     m_LabelSetContainer.push_back(lsClone);
 
-    // clone layer Image data
-    mitk::Image::Pointer liClone = other.GetLayerImage(i)->Clone();
-    m_LayerContainer.push_back(liClone);
+    // clone compressed layer data
+    m_LayerContainer.push_back(other.m_LayerContainer[i]->Clone());
   }
 }
 
@@ -132,14 +176,150 @@ mitk::LabelSetImage::~LabelSetImage()
   m_LabelSetContainer.clear();
 }
 
-mitk::Image *mitk::LabelSetImage::GetLayerImage(unsigned int layer)
+mitk::Image::ConstPointer mitk::LabelSetImage::GetLayerImage(unsigned int layer) const
+{
+  if (layer == GetActiveLayer())
+  {
+    return this;
+  }
+
+  mitk::Image::Pointer layerImage = mitk::Image::New();
+  layerImage->Initialize(this->GetPixelType(),
+                         this->GetDimension(),
+                         this->GetDimensions(),
+                         this->GetImageDescriptor()->GetNumberOfChannels());
+  layerImage->SetTimeGeometry(this->GetTimeGeometry()->Clone());
+  this->LayerContainerToImage(layer, layerImage);
+  return layerImage.GetPointer();
+}
+
+mitk::Image::Pointer mitk::LabelSetImage::GetLayerSlice(unsigned int layer,
+                                                        const PlaneGeometry *plane,
+                                                        unsigned int timeStep) const
+{
+  if (layer == GetActiveLayer() || m_LayerContainer.size() <= layer)
+  {
+    mitkThrow() << "Slices can only be created for existing inactive layers.";
+  }
+  if (timeStep >= this->GetTimeSteps())
+  {
+    mitkThrow() << "Time step " << timeStep << " does not exist.";
+  }
+
+  const BaseGeometry *geometry = this->GetGeometry(timeStep);
+
+  CompressedLabelLayer::RegionType region;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    region.SetIndex(i, 0);
+    region.SetSize(i, this->GetDimension(i));
+  }
+  region.SetIndex(3, timeStep);
+  region.SetSize(3, 1);
+
+  // a plane that is parallel to two image axes only intersects the voxels of one slice
+  if (plane != nullptr && dynamic_cast<const AbstractTransformGeometry *>(plane) == nullptr)
+  {
+    mitk::Vector3D normal;
+    geometry->WorldToIndex(plane->GetNormal(), normal);
+
+    unsigned int sliceDimension = 0;
+    for (unsigned int i = 1; i < 3; ++i)
+    {
+      if (std::abs(normal[i]) > std::abs(normal[sliceDimension]))
+        sliceDimension = i;
+    }
+
+    bool isAligned = true;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (i != sliceDimension && std::abs(normal[i]) > 1e-6 * std::abs(normal[sliceDimension]))
+        isAligned = false;
+    }
+
+    if (isAligned)
+    {
+      // the origin lies on the plane, the center of its bounding box does not
+      mitk::Point3D planeIndex;
+      geometry->WorldToIndex(plane->GetOrigin(), planeIndex);
+      const int lastSlice = static_cast<int>(this->GetDimension(sliceDimension)) - 1;
+      const int slice =
+        std::max(0, std::min(lastSlice, itk::Math::RoundHalfIntegerUp<int>(planeIndex[sliceDimension])));
+      region.SetIndex(sliceDimension, slice);
+      region.SetSize(sliceDimension, 1);
+    }
+  }
+
+  // same geometry as the time step, moved to the first voxel of the region
+  mitk::Point3D regionOrigin;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    regionOrigin[i] = region.GetIndex(i);
+  }
+  geometry->IndexToWorld(regionOrigin, regionOrigin);
+
+  BaseGeometry::Pointer sliceGeometry = geometry->Clone();
+  sliceGeometry->SetOrigin(regionOrigin);
+  BaseGeometry::BoundsArrayType bounds;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    bounds[2 * i] = 0;
+    bounds[2 * i + 1] = region.GetSize(i);
+  }
+  sliceGeometry->SetBounds(bounds);
+
+  mitk::Image::Pointer sliceImage = mitk::Image::New();
+  sliceImage->Initialize(mitk::MakeScalarPixelType<PixelType>(), *sliceGeometry);
+  {
+    mitk::ImageWriteAccessor accessor(sliceImage);
+    m_LayerContainer[layer]->GetRegionBuffer(region, static_cast<PixelType *>(accessor.GetData()));
+  }
+  return sliceImage;
+}
+
+const mitk::CompressedLabelLayer *mitk::LabelSetImage::GetCompressedLayer(unsigned int layer) const
 {
-  return m_LayerContainer[layer];
+  if (m_LayerContainer.size() <= layer)
+    return nullptr;
+  else
+    return m_LayerContainer[layer];
 }
 
-const mitk::Image *mitk::LabelSetImage::GetLayerImage(unsigned int layer) const
+mitk::CompressedLabelLayer::Pointer mitk::LabelSetImage::CreateCompressedLayer() const
 {
-  return m_LayerContainer[layer];
+  unsigned int dimensions[4] = {1, 1, 1, 1};
+  for (unsigned int i = 0; i < this->GetDimension() && i < 4; ++i)
+  {
+    dimensions[i] = this->GetDimension(i);
+  }
+
+  mitk::CompressedLabelLayer::Pointer layer = mitk::CompressedLabelLayer::New();
+  layer->Initialize(std::max(3u, this->GetDimension()), dimensions);
+  return layer;
+}
+
+void mitk::LabelSetImage::LayerContainerToImage(unsigned int layer, mitk::Image *image) const
+{
+  if (4 == image->GetDimension())
+  {
+    AccessFixedDimensionByItk_n(image, LayerContainerToImageProcessing, 4, (layer));
+  }
+  else
+  {
+    AccessByItk_1(image, LayerContainerToImageProcessing, layer);
+  }
+}
+
+void mitk::LabelSetImage::ImageToLayerContainer(const mitk::Image *image, unsigned int layer) const
+{
+  if (4 == image->GetDimension())
+  {
+    AccessFixedDimensionByItk_n(image, ImageToLayerContainerProcessing, 4, (layer));
+  }
+  else
+  {
+    AccessByItk_1(image, ImageToLayerContainerProcessing, layer);
+  }
 }
 
 unsigned int mitk::LabelSetImage::GetActiveLayer() const
@@ -147,6 +327,11 @@ unsigned int mitk::LabelSetImage::GetActiveLayer() const
   return m_ActiveLayer;
 }
 
+unsigned int mitk::LabelSetImage::GetLayerOrActiveLayer(int layer) const
+{
+  return layer < 0 ? GetActiveLayer() : static_cast<unsigned int>(layer);
+}
+
 unsigned int mitk::LabelSetImage::GetNumberOfLayers() const
 {
   return m_LabelSetContainer.size();
@@ -183,31 +368,30 @@ void mitk::LabelSetImage::RemoveLayer()
 
 unsigned int mitk::LabelSetImage::AddLayer(mitk::LabelSet::Pointer lset)
 {
-  mitk::Image::Pointer newImage = mitk::Image::New();
-  newImage->Initialize(this->GetPixelType(),
-                       this->GetDimension(),
-                       this->GetDimensions(),
-                       this->GetImageDescriptor()->GetNumberOfChannels());
-  newImage->SetTimeGeometry(this->GetTimeGeometry()->Clone());
-
-  if (newImage->GetDimension() < 4)
-  {
-    AccessByItk(newImage, SetToZero);
-  }
-  else
-  {
-    AccessFixedDimensionByItk(newImage, SetToZero, 4);
-  }
-
-  unsigned int newLabelSetId = this->AddLayer(newImage, lset);
-
-  return newLabelSetId;
+  // an empty compressed layer needs no memory per voxel, there is no need to create an image
+  return this->AddLayer(mitk::Image::Pointer(), lset);
 }
 
 unsigned int mitk::LabelSetImage::AddLayer(mitk::Image::Pointer layerImage, mitk::LabelSet::Pointer lset)
 {
   unsigned int newLabelSetId = m_LayerContainer.size();
 
+  // push a new compressed layer for the new layer
+  m_LayerContainer.push_back(this->CreateCompressedLayer());
+
+  if (layerImage.IsNotNull())
+  {
+    try
+    {
+      this->ImageToLayerContainer(layerImage, newLabelSetId);
+    }
+    catch (...)
+    {
+      m_LayerContainer.pop_back();
+      throw;
+    }
+  }
+
   // Add labelset to layer
   mitk::LabelSet::Pointer ls;
   if (lset.IsNotNull())
@@ -225,9 +409,6 @@ unsigned int mitk::LabelSetImage::AddLayer(mitk::Image::Pointer layerImage, mitk
   // Add exterior Label to label set
   // mitk::Label::Pointer exteriorLabel = CreateExteriorLabel();
 
-  // push a new working image for the new layer
-  m_LayerContainer.push_back(layerImage);
-
   // push a new labelset for the new layer
   m_LabelSetContainer.push_back(ls);
 
@@ -271,47 +452,23 @@ void mitk::LabelSetImage::SetActiveLayer(unsigned int layer)
 {
   try
   {
-    if (4 == this->GetDimension())
+    if ((layer != GetActiveLayer() || m_activeLayerInvalid) && (layer < this->GetNumberOfLayers()))
     {
-      if ((layer != GetActiveLayer() || m_activeLayerInvalid) && (layer < this->GetNumberOfLayers()))
+      BeforeChangeLayerEvent.Send();
+
+      if (m_activeLayerInvalid)
       {
-        BeforeChangeLayerEvent.Send();
-
-        if (m_activeLayerInvalid)
-        {
-          // We should not write the invalid layer back to the vector
-          m_activeLayerInvalid = false;
-        }
-        else
-        {
-          AccessFixedDimensionByItk_n(this, ImageToLayerContainerProcessing, 4, (GetActiveLayer()));
-        }
-        m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
-        AccessFixedDimensionByItk_n(this, LayerContainerToImageProcessing, 4, (GetActiveLayer()));
-
-        AfterChangeLayerEvent.Send();
+        // We should not write the invalid layer back to the vector
+        m_activeLayerInvalid = false;
       }
-    }
-    else
-    {
-      if ((layer != GetActiveLayer() || m_activeLayerInvalid) && (layer < this->GetNumberOfLayers()))
+      else
       {
-        BeforeChangeLayerEvent.Send();
-
-        if (m_activeLayerInvalid)
-        {
-          // We should not write the invalid layer back to the vector
-          m_activeLayerInvalid = false;
-        }
-        else
-        {
-          AccessByItk_1(this, ImageToLayerContainerProcessing, GetActiveLayer());
-        }
-        m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
-        AccessByItk_1(this, LayerContainerToImageProcessing, GetActiveLayer());
-
-        AfterChangeLayerEvent.Send();
+        this->ImageToLayerContainer(this, GetActiveLayer());
       }
+      m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
+      this->LayerContainerToImage(GetActiveLayer(), this);
+
+      AfterChangeLayerEvent.Send();
     }
   }
   catch (itk::ExceptionObject &e)
@@ -386,11 +543,24 @@ bool mitk::LabelSetImage::ExistLabelSet(unsigned int layer) const
   return layer < m_LabelSetContainer.size();
 }
 
-void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, unsigned int layer)
+void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, int layerOrActive)
 {
+  const unsigned int layer = GetLayerOrActiveLayer(layerOrActive);
+  if (m_LayerContainer.size() <= layer)
+  {
+    mitkThrow() << "Trying to merge labels in non-existing layer.";
+  }
+
   try
   {
-    AccessByItk_2(this, MergeLabelProcessing, pixelValue, sourcePixelValue);
+    if (layer == GetActiveLayer())
+    {
+      AccessByItk_2(this, MergeLabelProcessing, pixelValue, sourcePixelValue);
+    }
+    else
+    {
+      m_LayerContainer[layer]->ReplaceLabel(sourcePixelValue, pixelValue);
+    }
   }
   catch (itk::ExceptionObject &e)
   {
@@ -400,13 +570,26 @@ void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixel
   Modified();
 }
 
-void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, unsigned int layer)
+void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, int layerOrActive)
 {
+  const unsigned int layer = GetLayerOrActiveLayer(layerOrActive);
+  if (m_LayerContainer.size() <= layer)
+  {
+    mitkThrow() << "Trying to merge labels in non-existing layer.";
+  }
+
   try
   {
     for (unsigned int idx = 0; idx < vectorOfSourcePixelValues.size(); idx++)
     {
-      AccessByItk_2(this, MergeLabelProcessing, pixelValue, vectorOfSourcePixelValues[idx]);
+      if (layer == GetActiveLayer())
+      {
+        AccessByItk_2(this, MergeLabelProcessing, pixelValue, vectorOfSourcePixelValues[idx]);
+      }
+      else
+      {
+        m_LayerContainer[layer]->ReplaceLabel(vectorOfSourcePixelValues[idx], pixelValue);
+      }
     }
   }
   catch (itk::ExceptionObject &e)
@@ -417,8 +600,9 @@ void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelTyp
   Modified();
 }
 
-void mitk::LabelSetImage::RemoveLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer)
+void mitk::LabelSetImage::RemoveLabels(std::vector<PixelType> &VectorOfLabelPixelValues, int layerOrActive)
 {
+  const unsigned int layer = GetLayerOrActiveLayer(layerOrActive);
   for (unsigned int idx = 0; idx < VectorOfLabelPixelValues.size(); idx++)
   {
     GetLabelSet(layer)->RemoveLabel(VectorOfLabelPixelValues[idx]);
@@ -426,19 +610,33 @@ void mitk::LabelSetImage::RemoveLabels(std::vector<PixelType> &VectorOfLabelPixe
   }
 }
 
-void mitk::LabelSetImage::EraseLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer)
+void mitk::LabelSetImage::EraseLabels(std::vector<PixelType> &VectorOfLabelPixelValues, int layerOrActive)
 {
+  const unsigned int layer = GetLayerOrActiveLayer(layerOrActive);
   for (unsigned int i = 0; i < VectorOfLabelPixelValues.size(); i++)
   {
     this->EraseLabel(VectorOfLabelPixelValues[i], layer);
   }
 }
 
-void mitk::LabelSetImage::EraseLabel(PixelType pixelValue, unsigned int layer)
+void mitk::LabelSetImage::EraseLabel(PixelType pixelValue, int layerOrActive)
 {
+  const unsigned int layer = GetLayerOrActiveLayer(layerOrActive);
+  if (m_LayerContainer.size() <= layer)
+  {
+    mitkThrow() << "Trying to erase label in non-existing layer.";
+  }
+
   try
   {
-    AccessByItk_2(this, EraseLabelProcessing, pixelValue, layer);
+    if (layer == GetActiveLayer())
+    {
+      AccessByItk_2(this, EraseLabelProcessing, pixelValue, layer);
+    }
+    else
+    {
+      m_LayerContainer[layer]->ReplaceLabel(pixelValue, 0);
+    }
   }
   catch (itk::ExceptionObject &e)
   {
@@ -487,9 +685,35 @@ mitk::LabelSet *mitk::LabelSetImage::GetActiveLabelSet()
     return m_LabelSetContainer[GetActiveLayer()].GetPointer();
 }
 
-void mitk::LabelSetImage::UpdateCenterOfMass(PixelType pixelValue, unsigned int layer)
+void mitk::LabelSetImage::UpdateCenterOfMass(PixelType pixelValue, int layerOrActive)
 {
-  AccessByItk_2(this, CalculateCenterOfMassProcessing, pixelValue, layer);
+  const unsigned int layer = GetLayerOrActiveLayer(layerOrActive);
+  if (layer == GetActiveLayer())
+  {
+    AccessByItk_2(this, CalculateCenterOfMassProcessing, pixelValue, layer);
+    return;
+  }
+
+  if (m_LayerContainer.size() <= layer)
+  {
+    mitkThrow() << "Trying to update center of mass in non-existing layer.";
+  }
+
+  // same voxel as CalculateCenterOfMassProcessing, but only the blocks of the label are visited
+  mitk::Point3D pos;
+  pos.Fill(0.0);
+
+  mitk::CompressedLabelLayer::IndexType centerIndex;
+  if (m_LayerContainer[layer]->GetLabelMedianIndex(pixelValue, centerIndex))
+  {
+    pos[0] = centerIndex[0];
+    pos[1] = centerIndex[1];
+    pos[2] = centerIndex[2];
+  }
+
+  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassIndex(pos);
+  this->GetSlicedGeometry()->IndexToWorld(pos, pos); // TODO: TimeGeometry?
+  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassCoordinates(pos);
 }
 
 unsigned int mitk::LabelSetImage::GetNumberOfLabels(unsigned int layer) const
@@ -794,53 +1018,29 @@ void mitk::LabelSetImage::ConcatenateProcessing(ImageType *itkTarget, mitk::Labe
 
 template <typename TPixel, unsigned int VImageDimension>
 void mitk::LabelSetImage::LayerContainerToImageProcessing(itk::Image<TPixel, VImageDimension> *target,
-                                                          unsigned int layer)
+                                                          unsigned int layer) const
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typename ImageType::Pointer itkSource;
-  // mitk::CastToItkImage(m_LayerContainer[layer], itkSource);
-  itkSource = ImageToItkImage<TPixel, VImageDimension>(m_LayerContainer[layer]);
-  typedef itk::ImageRegionConstIterator<ImageType> SourceIteratorType;
-  typedef itk::ImageRegionIterator<ImageType> TargetIteratorType;
-
-  SourceIteratorType sourceIter(itkSource, itkSource->GetLargestPossibleRegion());
-  sourceIter.GoToBegin();
-
-  TargetIteratorType targetIter(target, target->GetLargestPossibleRegion());
-  targetIter.GoToBegin();
-
-  while (!sourceIter.IsAtEnd())
+  const std::size_t numberOfVoxels = target->GetLargestPossibleRegion().GetNumberOfPixels();
+  if (numberOfVoxels != m_LayerContainer[layer]->GetNumberOfVoxels())
   {
-    targetIter.Set(sourceIter.Get());
-    ++sourceIter;
-    ++targetIter;
+    mitkThrow() << "Size of layer image does not match the size of the label set image.";
   }
+
+  SetLabelBuffer(m_LayerContainer[layer], target->GetBufferPointer(), numberOfVoxels);
 }
 
 template <typename TPixel, unsigned int VImageDimension>
-void mitk::LabelSetImage::ImageToLayerContainerProcessing(itk::Image<TPixel, VImageDimension> *source,
+void mitk::LabelSetImage::ImageToLayerContainerProcessing(const itk::Image<TPixel, VImageDimension> *source,
                                                           unsigned int layer) const
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typename ImageType::Pointer itkTarget;
-  // mitk::CastToItkImage(m_LayerContainer[layer], itkTarget);
-  itkTarget = ImageToItkImage<TPixel, VImageDimension>(m_LayerContainer[layer]);
-
-  typedef itk::ImageRegionConstIterator<ImageType> SourceIteratorType;
-  typedef itk::ImageRegionIterator<ImageType> TargetIteratorType;
-
-  SourceIteratorType sourceIter(source, source->GetLargestPossibleRegion());
-  sourceIter.GoToBegin();
-
-  TargetIteratorType targetIter(itkTarget, itkTarget->GetLargestPossibleRegion());
-  targetIter.GoToBegin();
-
-  while (!sourceIter.IsAtEnd())
+  const std::size_t numberOfVoxels = source->GetLargestPossibleRegion().GetNumberOfPixels();
+  if (numberOfVoxels != m_LayerContainer[layer]->GetNumberOfVoxels())
   {
-    targetIter.Set(sourceIter.Get());
-    ++sourceIter;
-    ++targetIter;
+    mitkThrow() << "Size of layer image does not match the size of the label set image.";
   }
+
+  std::vector<PixelType> convertedBuffer;
+  m_LayerContainer[layer]->SetBuffer(GetLabelBuffer(source->GetBufferPointer(), numberOfVoxels, convertedBuffer));
 }
 
 template <typename ImageType>
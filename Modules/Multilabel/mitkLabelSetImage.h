@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef __mitkLabelSetImage_H_
 #define __mitkLabelSetImage_H_
 
+#include <mitkCompressedLabelLayer.h>
 #include <mitkImage.h>
 #include <mitkLabelSet.h>
 
@@ -28,6 +29,10 @@ namespace mitk
   //## @brief LabelSetImage class for handling labels and layers in a segmentation session.
   //##
   //## Handles operations for adding, removing, erasing and editing labels and layers.
+  //##
+  //## The image data of the LabelSetImage itself is the active layer. All other layers are kept in a
+  //## mitk::CompressedLabelLayer, so that mostly empty layers need little memory and per label operations
+  //## on them only touch the blocks that contain the label.
   //## @ingroup Data
 
   class MITKMULTILABEL_EXPORT LabelSetImage : public Image
@@ -72,46 +77,49 @@ namespace mitk
      *
      * @param pixelValue          the value of the label that should be the new merged label
      * @param sourcePixelValue    the value of the label that should be merged into the specified one
-     * @param layer               the layer in which the merge should be performed
+     * @param layer               the layer in which the merge should be performed, -1 for the active layer
      */
-    void MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, unsigned int layer = 0);
+    void MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, int layer = -1);
 
     /**
      * @brief Merges a list of mitk::Labels with the mitk::Label that has a specific value
      *
      * @param pixelValue                  the value of the label that should be the new merged label
      * @param vectorOfSourcePixelValues   the list of label values that should be merge into the specified one
-     * @param layer                       the layer in which the merge should be performed
+     * @param layer                       the layer in which the merge should be performed, -1 for the active layer
      */
-    void MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, unsigned int layer = 0);
+    void MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, int layer = -1);
 
     /**
-      * \brief  */
-    void UpdateCenterOfMass(PixelType pixelValue, unsigned int layer = 0);
+     * @brief Updates the center of mass of a label
+     * @param pixelValue the value of the label
+     * @param layer the layer of the label, -1 for the active layer
+     */
+    void UpdateCenterOfMass(PixelType pixelValue, int layer = -1);
 
     /**
      * @brief Removes labels from the mitk::LabelSet of given layer.
      *        Calls mitk::LabelSetImage::EraseLabels() which also removes the labels from within the image.
      * @param VectorOfLabelPixelValues a list of labels to be removed
-     * @param layer the layer in which the labels should be removed
+     * @param layer the layer in which the labels should be removed, -1 for the active layer
      */
-    void RemoveLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer = 0);
+    void RemoveLabels(std::vector<PixelType> &VectorOfLabelPixelValues, int layer = -1);
 
     /**
      * @brief Erases the label with the given value in the given layer from the underlying image.
      *        The label itself will not be erased from the respective mitk::LabelSet. In order to
      *        remove the label itself use mitk::LabelSetImage::RemoveLabels()
      * @param pixelValue the label which will be remove from the image
-     * @param layer the layer in which the label should be removed
+     * @param layer the layer in which the label should be removed, -1 for the active layer
      */
-    void EraseLabel(PixelType pixelValue, unsigned int layer = 0);
+    void EraseLabel(PixelType pixelValue, int layer = -1);
 
     /**
      * @brief Similar to mitk::LabelSetImage::EraseLabel() this funtion erase a list of labels from the image
      * @param VectorOfLabelPixelValues the list of labels that should be remove
-     * @param layer the layer for which the labels should be removed
+     * @param layer the layer for which the labels should be removed, -1 for the active layer
      */
-    void EraseLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer = 0);
+    void EraseLabels(std::vector<PixelType> &VectorOfLabelPixelValues, int layer = -1);
 
     /**
       * \brief  Returns true if the value exists in one of the labelsets*/
@@ -245,10 +253,31 @@ namespace mitk
     void RemoveLayer();
 
     /**
-      * \brief  */
-    mitk::Image *GetLayerImage(unsigned int layer);
+     * @brief Returns the image data of a layer
+     *
+     * For the active layer this is the LabelSetImage itself. For all other layers a new dense image is
+     * decompressed on each call and not kept by the LabelSetImage. To modify a layer, make it the active layer.
+     */
+    mitk::Image::ConstPointer GetLayerImage(unsigned int layer) const;
+
+    /**
+     * @brief Creates an image with the voxels of an inactive layer that are needed to reslice it along a plane
+     *
+     * If the plane is parallel to two axes of the image, only the slice of the layer at the plane is
+     * decompressed. The returned image is one voxel thick and has the geometry of this slice. For other
+     * planes the whole time step is decompressed. The image always has a single time step and is not
+     * kept by the LabelSetImage.
+     * @param layer an inactive layer, for the active layer use the LabelSetImage itself
+     * @param plane the plane to reslice along (nullptr for the whole time step)
+     * @param timeStep the time step of the layer
+     */
+    mitk::Image::Pointer GetLayerSlice(unsigned int layer, const PlaneGeometry *plane, unsigned int timeStep) const;
 
-    const mitk::Image *GetLayerImage(unsigned int layer) const;
+    /**
+     * @brief Returns the compressed storage of a layer or nullptr if the layer does not exist.
+     *        The storage of the active layer is only updated when another layer is activated.
+     */
+    const mitk::CompressedLabelLayer *GetCompressedLayer(unsigned int layer) const;
 
     void OnLabelSetModified();
 
@@ -277,10 +306,10 @@ namespace mitk
     void ChangeLayerProcessing(ImageType1 *source, ImageType2 *target);
 
     template <typename TPixel, unsigned int VImageDimension>
-    void LayerContainerToImageProcessing(itk::Image<TPixel, VImageDimension> *source, unsigned int layer);
+    void LayerContainerToImageProcessing(itk::Image<TPixel, VImageDimension> *target, unsigned int layer) const;
 
     template <typename TPixel, unsigned int VImageDimension>
-    void ImageToLayerContainerProcessing(itk::Image<TPixel, VImageDimension> *source, unsigned int layer) const;
+    void ImageToLayerContainerProcessing(const itk::Image<TPixel, VImageDimension> *source, unsigned int layer) const;
 
     template <typename ImageType>
     void CalculateCenterOfMassProcessing(ImageType *input, PixelType index, unsigned int layer);
@@ -309,8 +338,20 @@ namespace mitk
     template <typename LabelSetImageType, typename ImageType>
     void InitializeByLabeledImageProcessing(LabelSetImageType *input, ImageType *other);
 
+    /** Creates an empty compressed layer with the size of this image */
+    CompressedLabelLayer::Pointer CreateCompressedLayer() const;
+
+    /** Decompresses a layer into an image with the size of this image */
+    void LayerContainerToImage(unsigned int layer, mitk::Image *image) const;
+
+    /** Compresses an image with the size of this image into a layer */
+    void ImageToLayerContainer(const mitk::Image *image, unsigned int layer) const;
+
+    /** Replaces the layer -1 by the active layer */
+    unsigned int GetLayerOrActiveLayer(int layer) const;
+
     std::vector<LabelSet::Pointer> m_LabelSetContainer;
-    std::vector<Image::Pointer> m_LayerContainer;
+    std::vector<CompressedLabelLayer::Pointer> m_LayerContainer;
 
     int m_ActiveLayer;
 
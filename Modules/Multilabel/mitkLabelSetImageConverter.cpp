@@ -40,10 +40,14 @@ static void ConvertLabelSetImageToImage(const itk::Image<TPixel, VDimension> *,
     auto vectorImageComposer = ComposeFilterType::New();
     auto activeLayer = labelSetImage->GetActiveLayer();
 
+    // the inactive layers are decompressed on request, keep them until the composer ran
+    std::vector<mitk::Image::ConstPointer> layerImages;
+
     for (decltype(numberOfLayers) layer = 0; layer < numberOfLayers; ++layer)
     {
-      auto layerImage = mitk::ImageToItkImage<TPixel, VDimension>(
-        layer != activeLayer ? labelSetImage->GetLayerImage(layer) : labelSetImage);
+      layerImages.push_back(layer != activeLayer ? labelSetImage->GetLayerImage(layer)
+                                                 : mitk::Image::ConstPointer(labelSetImage.GetPointer()));
+      auto layerImage = mitk::ImageToItkImage<TPixel, VDimension>(layerImages.back());
 
       vectorImageComposer->SetInput(layer, layerImage);
     }
@@ -79,7 +83,7 @@ mitk::Image::Pointer mitk::ConvertLabelSetImageToImage(LabelSetImage::ConstPoint
     }
     else
     {
-      AccessByItk_2(labelSetImage->GetLayerImage(0), ::ConvertLabelSetImageToImage, labelSetImage, image);
+      AccessByItk_2(labelSetImage, ::ConvertLabelSetImageToImage, labelSetImage, image);
     }
   }
 
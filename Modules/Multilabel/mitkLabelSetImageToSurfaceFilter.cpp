@@ -17,27 +17,53 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkLabelSetImageToSurfaceFilter.h>
 
 #include <mitkImageAccessByItk.h>
-#include <mitkImageCast.h>
+#include <mitkParallelFor.h>
 
 // itk
 #include <itkAntiAliasBinaryImageFilter.h>
-#include <itkAutoCropLabelMapFilter.h>
-#include <itkBinaryThresholdImageFilter.h>
-#include <itkLabelImageToLabelMapFilter.h>
-#include <itkLabelMap.h>
-#include <itkLabelMapToLabelImageFilter.h>
-#include <itkLabelObject.h>
-#include <itkNumericTraits.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
 #include <itkSmoothingRecursiveGaussianImageFilter.h>
 
 // vtk
 #include <vtkCleanPolyData.h>
-#include <vtkImageChangeInformation.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
 #include <vtkMarchingCubes.h>
 #include <vtkSmartPointer.h>
 
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+  // border (in voxels) around the bounding box of a label, leaves room for the anti-aliasing
+  const long CropBorder = 3;
+
+  // the outputs get their own vtkPolyData, so they do not share the cached one
+  vtkSmartPointer<vtkPolyData> CopyOf(vtkPolyData *polyData)
+  {
+    vtkSmartPointer<vtkPolyData> copy = vtkSmartPointer<vtkPolyData>::New();
+    copy->ShallowCopy(polyData);
+    return copy;
+  }
+}
+
+mitk::LabelSetImageToSurfaceFilter::LabelExtent::LabelExtent() : NumberOfVoxels(0)
+{
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    Begin[d] = std::numeric_limits<long>::max();
+    End[d] = std::numeric_limits<long>::min();
+  }
+}
+
+bool mitk::LabelSetImageToSurfaceFilter::LabelExtent::operator==(const LabelExtent &other) const
+{
+  return NumberOfVoxels == other.NumberOfVoxels && std::equal(Begin, Begin + 3, other.Begin) &&
+         std::equal(End, End + 3, other.End) && Runs == other.Runs;
+}
+
 mitk::LabelSetImageToSurfaceFilter::LabelSetImageToSurfaceFilter()
   : m_GenerateAllLabels(false), m_RequestedLabel(1), m_BackgroundLabel(0), m_UseSmoothing(0), m_Sigma(0.1)
 {
@@ -68,6 +94,13 @@ const mitk::Image *mitk::LabelSetImageToSurfaceFilter::GetInput(void)
   return static_cast<const mitk::Image *>(this->ProcessObject::GetInput(0));
 }
 
+void mitk::LabelSetImageToSurfaceFilter::ClearLabelSurfaceCache()
+{
+  m_LabelSurfaceCache.clear();
+  m_LabelSurfaceCacheSettings.clear();
+  this->Modified();
+}
+
 void mitk::LabelSetImageToSurfaceFilter::GenerateOutputInformation()
 {
   itkDebugMacro(<< "GenerateOutputInformation()");
@@ -83,60 +116,225 @@ void mitk::LabelSetImageToSurfaceFilter::GenerateData()
   if (!outputSurface)
     return;
 
+  // the cached surfaces are only valid for the same smoothing and the same geometry
+  std::vector<double> settings;
+  settings.push_back(m_UseSmoothing);
+  settings.push_back(m_Sigma);
+  vtkSmartPointer<vtkMatrix4x4> vtkmatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  inputImage->GetGeometry()->GetVtkTransform()->GetMatrix(vtkmatrix);
+  settings.insert(settings.end(), &vtkmatrix->Element[0][0], &vtkmatrix->Element[0][0] + 16);
+
+  if (settings != m_LabelSurfaceCacheSettings)
+  {
+    m_LabelSurfaceCache.clear();
+    m_LabelSurfaceCacheSettings = settings;
+  }
+
   AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
 }
 
 template <typename TPixel, unsigned int VDimension>
 void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPixel, VDimension> *input,
                                                             mitk::Surface * /*surface*/)
+{
+  LabelExtentMapType extents;
+  this->ScanLabels(input, extents);
+
+  m_AvailableLabels.clear();
+  m_IndexToLabels.clear();
+  for (const auto &extent : extents)
+  {
+    m_AvailableLabels[extent.first] = extent.second.NumberOfVoxels;
+  }
+
+  if (!m_GenerateAllLabels && extents.empty())
+    throw itk::ExceptionObject(__FILE__, __LINE__, "requested label not found.");
+
+  // labels whose voxels changed since their surface was cached
+  std::vector<LabelType> labelsToProcess;
+  for (const auto &extent : extents)
+  {
+    auto cached = m_LabelSurfaceCache.find(extent.first);
+    if (cached == m_LabelSurfaceCache.end() || !(cached->second.Extent == extent.second))
+    {
+      labelsToProcess.push_back(extent.first);
+    }
+  }
+
+  const mitk::BaseGeometry *geometry = this->GetInput()->GetGeometry();
+  vtkSmartPointer<vtkMatrix4x4> vtkmatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  geometry->GetVtkTransform()->GetMatrix(vtkmatrix);
+  double indexToWorld[4][4];
+  std::copy(&vtkmatrix->Element[0][0], &vtkmatrix->Element[0][0] + 16, &indexToWorld[0][0]);
+
+  const mitk::Vector3D geometrySpacing = geometry->GetSpacing();
+  const double spacing[3] = {geometrySpacing[0], geometrySpacing[1], geometrySpacing[2]};
+
+  // the labels are processed concurrently, the itk filters of each label then use a single thread
+  const bool singleThreaded = labelsToProcess.size() > 1;
+  const LabelExtentMapType &constExtents = extents;
+  std::vector<vtkSmartPointer<vtkPolyData>> polyDatas(labelsToProcess.size());
+  mitk::ParallelFor(labelsToProcess.size(), [&](std::size_t i) {
+    const LabelType label = labelsToProcess[i];
+    polyDatas[i] =
+      this->CreateLabelSurface(input, label, constExtents.at(label), indexToWorld, spacing, singleThreaded);
+  });
+
+  for (std::size_t i = 0; i < labelsToProcess.size(); ++i)
+  {
+    CachedLabelSurface &cached = m_LabelSurfaceCache[labelsToProcess[i]];
+    cached.Extent = extents[labelsToProcess[i]];
+    cached.PolyData = polyDatas[i];
+  }
+
+  if (!m_GenerateAllLabels)
+  {
+    this->SetNumberOfIndexedOutputs(1);
+    this->GetOutput(0)->SetVtkPolyData(CopyOf(m_LabelSurfaceCache[extents.begin()->first].PolyData), 0);
+    return;
+  }
+
+  // labels that do not exist anymore
+  for (auto cached = m_LabelSurfaceCache.begin(); cached != m_LabelSurfaceCache.end();)
+  {
+    if (extents.find(cached->first) == extents.end())
+    {
+      cached = m_LabelSurfaceCache.erase(cached);
+    }
+    else
+    {
+      ++cached;
+    }
+  }
+
+  this->SetNumberOfIndexedOutputs(std::max<std::size_t>(1, extents.size()));
+  if (extents.empty())
+  {
+    this->GetOutput(0)->SetVtkPolyData(vtkSmartPointer<vtkPolyData>::New(), 0);
+    return;
+  }
+
+  unsigned int index = 0;
+  for (const auto &extent : extents)
+  {
+    if (this->GetOutput(index) == nullptr)
+    {
+      this->SetNthOutput(index, this->MakeOutput(index));
+    }
+    this->GetOutput(index)->SetVtkPolyData(CopyOf(m_LabelSurfaceCache[extent.first].PolyData), 0);
+    m_IndexToLabels[index] = extent.first;
+    ++index;
+  }
+}
+
+template <typename TPixel, unsigned int VDimension>
+void mitk::LabelSetImageToSurfaceFilter::ScanLabels(const itk::Image<TPixel, VDimension> *input,
+                                                    LabelExtentMapType &extents)
 {
   typedef itk::Image<TPixel, VDimension> ImageType;
 
-  typedef itk::BinaryThresholdImageFilter<ImageType, ImageType> BinaryThresholdFilterType;
-  typedef itk::LabelObject<TPixel, VDimension> LabelObjectType;
-  typedef itk::LabelMap<LabelObjectType> LabelMapType;
-  typedef itk::LabelImageToLabelMapFilter<ImageType, LabelMapType> Image2LabelMapType;
-  typedef itk::AutoCropLabelMapFilter<LabelMapType> AutoCropType;
-  typedef itk::LabelMapToLabelImageFilter<LabelMapType, ImageType> LabelMap2ImageType;
+  const typename ImageType::RegionType &region = input->GetBufferedRegion();
+  const typename ImageType::SizeType &size = region.GetSize();
+  const typename ImageType::IndexType &start = region.GetIndex();
+  const TPixel *buffer = input->GetBufferPointer();
+
+  const TPixel requestedLabel = static_cast<TPixel>(m_RequestedLabel);
+  const TPixel backgroundLabel = static_cast<TPixel>(m_BackgroundLabel);
+
+  // labels usually form runs, so the map is only searched when the label changes
+  auto current = extents.end();
+  TPixel currentLabel = TPixel();
 
+  uint64_t linearIndex = 0;
+  long index[3];
+  for (index[2] = start[2]; index[2] < start[2] + static_cast<long>(size[2]); ++index[2])
+  {
+    for (index[1] = start[1]; index[1] < start[1] + static_cast<long>(size[1]); ++index[1])
+    {
+      for (index[0] = start[0]; index[0] < start[0] + static_cast<long>(size[0]); ++index[0], ++linearIndex)
+      {
+        const TPixel value = buffer[linearIndex];
+        if (m_GenerateAllLabels ? value == backgroundLabel : value != requestedLabel)
+          continue;
+
+        if (current == extents.end() || value != currentLabel)
+        {
+          current = extents.insert(std::make_pair(static_cast<LabelType>(value), LabelExtent())).first;
+          currentLabel = value;
+        }
+
+        LabelExtent &extent = current->second;
+        for (unsigned int d = 0; d < 3; ++d)
+        {
+          extent.Begin[d] = std::min(extent.Begin[d], index[d]);
+          extent.End[d] = std::max(extent.End[d], index[d] + 1);
+        }
+        ++extent.NumberOfVoxels;
+        if (!extent.Runs.empty() && extent.Runs.back() == linearIndex)
+        {
+          ++extent.Runs.back();
+        }
+        else
+        {
+          extent.Runs.push_back(linearIndex);
+          extent.Runs.push_back(linearIndex + 1);
+        }
+      }
+    }
+  }
+}
+
+template <typename TPixel, unsigned int VDimension>
+vtkSmartPointer<vtkPolyData> mitk::LabelSetImageToSurfaceFilter::CreateLabelSurface(
+  const itk::Image<TPixel, VDimension> *input,
+  LabelType label,
+  const LabelExtent &extent,
+  const double indexToWorld[4][4],
+  const double spacing[3],
+  bool singleThreaded) const
+{
+  typedef itk::Image<TPixel, VDimension> ImageType;
   typedef itk::Image<float, VDimension> RealImageType;
 
   typedef itk::AntiAliasBinaryImageFilter<ImageType, RealImageType> AntiAliasFilterType;
   typedef itk::SmoothingRecursiveGaussianImageFilter<RealImageType, RealImageType> GaussianFilterType;
 
-  typename BinaryThresholdFilterType::Pointer thresholdFilter = BinaryThresholdFilterType::New();
-  thresholdFilter->SetInput(input);
-  thresholdFilter->SetLowerThreshold(m_RequestedLabel);
-  thresholdFilter->SetUpperThreshold(m_RequestedLabel);
-  thresholdFilter->SetOutsideValue(0);
-  thresholdFilter->SetInsideValue(1);
-  //  thresholdFilter->ReleaseDataFlagOn();
-  thresholdFilter->Update();
-
-  typename Image2LabelMapType::Pointer image2label = Image2LabelMapType::New();
-  image2label->SetInput(thresholdFilter->GetOutput());
-
-  typename AutoCropType::SizeType border;
-  border[0] = 3;
-  border[1] = 3;
-  border[2] = 3;
+  // bounding box of the label plus border, within the image
+  const typename ImageType::RegionType &largestRegion = input->GetLargestPossibleRegion();
+  typename ImageType::RegionType cropRegion;
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    const long begin = std::max(extent.Begin[d] - CropBorder, static_cast<long>(largestRegion.GetIndex(d)));
+    const long end = std::min(extent.End[d] + CropBorder,
+                              static_cast<long>(largestRegion.GetIndex(d) + largestRegion.GetSize(d)));
+    cropRegion.SetIndex(d, begin);
+    cropRegion.SetSize(d, end - begin);
+  }
 
-  typename AutoCropType::Pointer autoCropFilter = AutoCropType::New();
-  autoCropFilter->SetInput(image2label->GetOutput());
-  autoCropFilter->SetCropBorder(border);
-  autoCropFilter->InPlaceOn();
+  typename ImageType::RegionType binaryRegion;
+  binaryRegion.SetSize(cropRegion.GetSize());
 
-  typename LabelMap2ImageType::Pointer label2image = LabelMap2ImageType::New();
-  label2image->SetInput(autoCropFilter->GetOutput());
+  typename ImageType::Pointer binaryImage = ImageType::New();
+  binaryImage->SetRegions(binaryRegion);
+  binaryImage->SetSpacing(input->GetSpacing());
+  binaryImage->Allocate();
 
-  label2image->Update();
+  const TPixel labelValue = static_cast<TPixel>(label);
+  itk::ImageRegionConstIterator<ImageType> inputIt(input, cropRegion);
+  itk::ImageRegionIterator<ImageType> binaryIt(binaryImage, binaryRegion);
+  for (inputIt.GoToBegin(), binaryIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++binaryIt)
+  {
+    binaryIt.Set(inputIt.Get() == labelValue ? 1 : 0);
+  }
 
   typename AntiAliasFilterType::Pointer antiAliasFilter = AntiAliasFilterType::New();
-  antiAliasFilter->SetInput(label2image->GetOutput());
+  antiAliasFilter->SetInput(binaryImage);
   antiAliasFilter->SetMaximumRMSError(0.001);
   antiAliasFilter->SetNumberOfLayers(3);
   antiAliasFilter->SetUseImageSpacing(false);
   antiAliasFilter->SetNumberOfIterations(40);
+  if (singleThreaded)
+    antiAliasFilter->SetNumberOfThreads(1);
 
   antiAliasFilter->Update();
 
@@ -147,6 +345,8 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
     typename GaussianFilterType::Pointer gaussianFilter = GaussianFilterType::New();
     gaussianFilter->SetSigma(m_Sigma);
     gaussianFilter->SetInput(antiAliasFilter->GetOutput());
+    if (singleThreaded)
+      gaussianFilter->SetNumberOfThreads(1);
     gaussianFilter->Update();
     result = gaussianFilter->GetOutput();
   }
@@ -157,32 +357,22 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
 
   result->DisconnectPipeline();
 
-  typename ImageType::RegionType cropRegion;
-  cropRegion = autoCropFilter->GetOutput()->GetLargestPossibleRegion();
-
-  const typename ImageType::IndexType &cropIndex = cropRegion.GetIndex();
-
-  m_ResultImage = mitk::Image::New();
-  mitk::CastToMitkImage(result, m_ResultImage);
-
-  mitk::BaseGeometry *newGeometry = m_ResultImage->GetSlicedGeometry();
-  mitk::Point3D origin;
-  vtk2itk(cropIndex, origin);
-  this->GetInput()->GetGeometry()->IndexToWorld(origin, origin);
-  newGeometry->SetOrigin(origin);
-
-  auto *vtkimage = m_ResultImage->GetVtkImageData(0);
-
-  vtkSmartPointer<vtkImageChangeInformation> indexCoordinatesImageFilter =
-    vtkSmartPointer<vtkImageChangeInformation>::New();
-  indexCoordinatesImageFilter->SetInputData(vtkimage);
-  indexCoordinatesImageFilter->SetOutputOrigin(0.0, 0.0, 0.0);
+  // marching cubes in the crop region, with the spacing of the input and the origin at the first voxel
+  const typename RealImageType::SizeType &resultSize = result->GetLargestPossibleRegion().GetSize();
+  vtkSmartPointer<vtkImageData> vtkimage = vtkSmartPointer<vtkImageData>::New();
+  vtkimage->SetDimensions(resultSize[0], resultSize[1], resultSize[2]);
+  vtkimage->SetSpacing(spacing[0], spacing[1], spacing[2]);
+  vtkimage->SetOrigin(0.0, 0.0, 0.0);
+  vtkimage->AllocateScalars(VTK_FLOAT, 1);
+  std::copy(result->GetBufferPointer(),
+            result->GetBufferPointer() + result->GetLargestPossibleRegion().GetNumberOfPixels(),
+            static_cast<float *>(vtkimage->GetScalarPointer()));
 
   vtkSmartPointer<vtkMarchingCubes> marching = vtkSmartPointer<vtkMarchingCubes>::New();
   marching->ComputeScalarsOff();
   marching->ComputeNormalsOn();
   marching->ComputeGradientsOn();
-  marching->SetInputConnection(indexCoordinatesImageFilter->GetOutputPort());
+  marching->SetInputData(vtkimage);
   marching->SetValue(0, 0.0);
 
   marching->Update();
@@ -192,17 +382,18 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
   if ((!polydata) || (!polydata->GetNumberOfPoints()))
     throw itk::ExceptionObject(__FILE__, __LINE__, "marching cubes has failed.");
 
-  mitk::Vector3D spacing = newGeometry->GetSpacing();
-
-  vtkPoints *points = polydata->GetPoints();
-  vtkMatrix4x4 *vtkmatrix = vtkMatrix4x4::New();
-  newGeometry->GetVtkTransform()->GetMatrix(vtkmatrix);
-  double(*matrix)[4] = vtkmatrix->Element;
+  // index-to-world transform of the input, moved to the crop region and scaled back from the spacing
+  double matrix[4][4];
+  std::copy(&indexToWorld[0][0], &indexToWorld[0][0] + 16, &matrix[0][0]);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      matrix[i][3] += indexToWorld[i][j] * cropRegion.GetIndex(j);
 
   for (int i = 0; i < 3; ++i)
     for (int j = 0; j < 3; ++j)
       matrix[i][j] /= spacing[j];
 
+  vtkPoints *points = polydata->GetPoints();
   unsigned int n = points->GetNumberOfPoints();
   double point[3];
 
@@ -212,7 +403,6 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
     mitkVtkLinearTransformPoint(matrix, point, point);
     points->SetPoint(i, point);
   }
-  vtkmatrix->Delete();
 
   vtkSmartPointer<vtkCleanPolyData> cleanPolyDataFilter = vtkSmartPointer<vtkCleanPolyData>::New();
   cleanPolyDataFilter->SetInputData(polydata);
@@ -223,6 +413,5 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
   cleanPolyDataFilter->PointMergingOn();
   cleanPolyDataFilter->Update();
 
-  mitk::Surface::Pointer output = this->GetOutput(0);
-  output->SetVtkPolyData(cleanPolyDataFilter->GetOutput(), 0);
+  return cleanPolyDataFilter->GetOutput();
 }
@@ -23,17 +23,30 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkSurfaceSource.h>
 
 #include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
 
 #include <itkImage.h>
 
+#include <cstdint>
 #include <map>
+#include <vector>
 
 namespace mitk
 {
   /**
    * Generates surface meshes from a labelset image.
    * If you want to calculate a surface representation for all available labels,
-   * you may call GenerateAllLabelsOn().
+   * you may call GenerateAllLabelsOn(). In this case the filter has one output per label
+   * (see GetIndexToLabels()).
+   *
+   * The input is scanned once to find the bounding box of every label. Each label is then
+   * processed within its bounding box only, and several labels are processed concurrently.
+   *
+   * The surfaces are cached per label. A label whose voxels did not change since the last update
+   * is not processed again, so editing one label of a segmentation with many labels only
+   * regenerates the surface of that label. Each output gets a shallow copy of the cached surface,
+   * so replacing the points or cells of an output does not affect the cache or other outputs.
    */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceFilter : public SurfaceSource
   {
@@ -109,6 +122,22 @@ namespace mitk
      */
     itkSetMacro(Sigma, float);
 
+    /**
+     * Returns the number of voxels of each label found during the last update
+     * (only the requested label, if GenerateAllLabels() is false).
+     */
+    itkGetConstReferenceMacro(AvailableLabels, LabelMapType);
+
+    /**
+     * Returns the label of each output. Only set if GenerateAllLabels() is true.
+     */
+    itkGetConstReferenceMacro(IndexToLabels, IndexToLabelMapType);
+
+    /**
+     * Discards all cached label surfaces, the next update processes all labels.
+     */
+    void ClearLabelSurfaceCache();
+
   protected:
     LabelSetImageToSurfaceFilter();
 
@@ -118,7 +147,7 @@ namespace mitk
     * Transforms a point by a 4x4 matrix
     */
     template <class T1, class T2, class T3>
-    inline void mitkVtkLinearTransformPoint(T1 matrix[4][4], T2 in[3], T3 out[3])
+    inline void mitkVtkLinearTransformPoint(T1 matrix[4][4], T2 in[3], T3 out[3]) const
     {
       T3 x = matrix[0][0] * in[0] + matrix[0][1] * in[1] + matrix[0][2] * in[2] + matrix[0][3];
       T3 y = matrix[1][0] * in[0] + matrix[1][1] * in[1] + matrix[1][2] * in[2] + matrix[1][3];
@@ -128,11 +157,53 @@ namespace mitk
       out[2] = z;
     }
 
-    mitk::Image::Pointer m_ResultImage;
+    /**
+    * Bounding box (index coordinates, end exclusive) and voxels of one label. The voxels are stored as
+    * runs of consecutive linear indices (begin and end of each run), so two extents are equal exactly
+    * if the label consists of the same voxels.
+    */
+    struct LabelExtent
+    {
+      LabelExtent();
+      bool operator==(const LabelExtent &other) const;
+
+      unsigned long NumberOfVoxels;
+      long Begin[3];
+      long End[3];
+      std::vector<uint64_t> Runs;
+    };
+
+    struct CachedLabelSurface
+    {
+      LabelExtent Extent;
+      vtkSmartPointer<vtkPolyData> PolyData;
+    };
+
+    typedef std::map<LabelType, LabelExtent> LabelExtentMapType;
+
+    typedef std::map<LabelType, CachedLabelSurface> LabelSurfaceCacheType;
 
     template <typename TPixel, unsigned int VImageDimension>
     void InternalProcessing(const itk::Image<TPixel, VImageDimension> *input, mitk::Surface *surface);
 
+    /**
+    * Determines the extents of all labels (or the requested label only) in a single pass over the input.
+    */
+    template <typename TPixel, unsigned int VImageDimension>
+    void ScanLabels(const itk::Image<TPixel, VImageDimension> *input, LabelExtentMapType &extents);
+
+    /**
+    * Creates the surface of a single label within its (bordered) bounding box. Does not modify the filter,
+    * so several labels can be processed concurrently.
+    */
+    template <typename TPixel, unsigned int VImageDimension>
+    vtkSmartPointer<vtkPolyData> CreateLabelSurface(const itk::Image<TPixel, VImageDimension> *input,
+                                                    LabelType label,
+                                                    const LabelExtent &extent,
+                                                    const double indexToWorld[4][4],
+                                                    const double spacing[3],
+                                                    bool singleThreaded) const;
+
     bool m_GenerateAllLabels;
 
     int m_RequestedLabel;
@@ -149,6 +220,11 @@ namespace mitk
 
     mitk::Vector3D m_InputImageSpacing;
 
+    LabelSurfaceCacheType m_LabelSurfaceCache;
+
+    // smoothing parameters and index-to-world transform the cached surfaces were created with
+    std::vector<double> m_LabelSurfaceCacheSettings;
+
     void GenerateData() override;
 
     void GenerateOutputInformation() override;
@@ -21,7 +21,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace mitk
 {
-  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter() : m_RequestedLabel(1), m_Result(nullptr)
+  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter()
+    : m_RequestedLabel(1), m_GenerateAllLabels(false), m_Filter(LabelSetImageToSurfaceFilter::New())
   {
   }
 
@@ -74,16 +75,25 @@ namespace mitk
       MITK_WARN << "\"RequestedLabel\" parameter was not set: will use the default value (" << m_RequestedLabel << ").";
     }
 
-    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
-    filter->SetInput(image);
-    //  filter->SetObserver(obsv);
-    filter->SetGenerateAllLabels(false);
-    filter->SetRequestedLabel(m_RequestedLabel);
-    filter->SetUseSmoothing(useSmoothing);
+    m_GenerateAllLabels = false;
+    try
+    {
+      this->GetParameter("GenerateAllLabels", m_GenerateAllLabels);
+    }
+    catch (std::invalid_argument &)
+    {
+    }
+
+    // the filter is reused, it only regenerates the surfaces of changed labels
+    m_Filter->SetInput(image);
+    //  m_Filter->SetObserver(obsv);
+    m_Filter->SetGenerateAllLabels(m_GenerateAllLabels);
+    m_Filter->SetRequestedLabel(m_RequestedLabel);
+    m_Filter->SetUseSmoothing(useSmoothing);
 
     try
     {
-      filter->Update();
+      m_Filter->Update();
     }
     catch (itk::ExceptionObject &e)
     {
@@ -101,12 +111,27 @@ namespace mitk
       return false;
     }
 
-    m_Result = filter->GetOutput();
+    LabelSetImageToSurfaceFilter::IndexToLabelMapType outputLabels;
+    if (m_GenerateAllLabels)
+      outputLabels = m_Filter->GetIndexToLabels();
+    else
+      outputLabels[0] = m_RequestedLabel;
 
-    if (m_Result.IsNull() || !m_Result->GetVtkPolyData())
-      return false;
+    std::vector<Result> results;
+    for (const auto &outputLabel : outputLabels)
+    {
+      Surface::Pointer result = m_Filter->GetOutput(outputLabel.first);
+      if (result.IsNull() || !result->GetVtkPolyData())
+        return false;
+
+      // a new surface, the outputs of the filter are updated by the next run
+      Surface::Pointer surface = Surface::New();
+      surface->SetVtkPolyData(result->GetVtkPolyData());
+      results.push_back({static_cast<int>(outputLabel.second), m_GenerateAllLabels, surface});
+    }
 
-    m_Result->DisconnectPipeline();
+    std::lock_guard<std::mutex> lock(m_ResultsMutex);
+    m_Results.insert(m_Results.end(), results.begin(), results.end());
 
     return true;
   }
@@ -116,17 +141,34 @@ namespace mitk
     LabelSetImage::Pointer image;
     this->GetPointerParameter("Input", image);
 
-    std::string name = this->GetGroupNode()->GetName();
-    name.append("-surf");
+    std::vector<Result> results;
+    {
+      std::lock_guard<std::mutex> lock(m_ResultsMutex);
+      results.swap(m_Results);
+    }
+
+    for (const auto &result : results)
+    {
+      mitk::Label *label = image->GetLabel(result.Label, image->GetActiveLayer());
+
+      std::string name = this->GetGroupNode()->GetName();
+      if (result.AllLabels && label)
+      {
+        name.append("-").append(label->GetName());
+      }
+      name.append("-surf");
 
-    mitk::DataNode::Pointer node = mitk::DataNode::New();
-    node->SetData(m_Result);
-    node->SetName(name);
+      mitk::DataNode::Pointer node = mitk::DataNode::New();
+      node->SetData(result.Output);
+      node->SetName(name);
 
-    mitk::Color color = image->GetLabel(m_RequestedLabel, image->GetActiveLayer())->GetColor();
-    node->SetColor(color);
+      if (label)
+      {
+        node->SetColor(label->GetColor());
+      }
 
-    this->InsertBelowGroupNode(node);
+      this->InsertBelowGroupNode(node);
+    }
 
     Superclass::ThreadedUpdateSuccessful();
   }
@@ -17,12 +17,24 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef __mitkLabelSetImageToSurfaceThreadedFilter_H_
 #define __mitkLabelSetImageToSurfaceThreadedFilter_H_
 
+#include "mitkLabelSetImageToSurfaceFilter.h"
 #include "mitkSegmentationSink.h"
 #include "mitkSurface.h"
 #include <MitkMultilabelExports.h>
 
+#include <mutex>
+#include <vector>
+
 namespace mitk
 {
+  /**
+   * Creates the surface of the label "RequestedLabel" of the "Input" image in the background, or the surfaces
+   * of all labels if the parameter "GenerateAllLabels" is true. Each surface is inserted below the group node.
+   *
+   * The surface filter is kept between runs of the same instance, so running it again after editing
+   * a segmentation only regenerates the surfaces of the changed labels. If it is started again while running,
+   * the surfaces of both runs are inserted.
+   */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceThreadedFilter : public SegmentationSink
   {
   public:
@@ -41,8 +53,20 @@ namespace mitk
     void ThreadedUpdateSuccessful() override; // will be called from a thread after calling StartAlgorithm
 
   private:
+    struct Result
+    {
+      int Label;
+      bool AllLabels;
+      Surface::Pointer Output;
+    };
+
     int m_RequestedLabel;
-    Surface::Pointer m_Result;
+    bool m_GenerateAllLabels;
+    LabelSetImageToSurfaceFilter::Pointer m_Filter;
+
+    // written by the worker thread, inserted into the data storage by the GUI thread
+    std::vector<Result> m_Results;
+    std::mutex m_ResultsMutex;
   };
 
 } // namespace
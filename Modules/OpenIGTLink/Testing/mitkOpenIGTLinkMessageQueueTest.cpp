@@ -0,0 +1,142 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkIGTLMessageQueue.h>
+
+#include <igtlStringMessage.h>
+#include <igtlTransformMessage.h>
+
+#include <string>
+#include <thread>
+
+class mitkOpenIGTLinkMessageQueueTestSuite : public mitk::TestFixture {
+CPPUNIT_TEST_SUITE(mitkOpenIGTLinkMessageQueueTestSuite);
+MITK_TEST(Test_NoBuffering_KeepsLatestMessage);
+MITK_TEST(Test_DropOldest_KeepsNewestMessages);
+MITK_TEST(Test_DropNewest_KeepsOldestMessages);
+MITK_TEST(Test_MessageTypes_AreQueuedSeparately);
+MITK_TEST(Test_ConcurrentPushAndPull_KeepsOrder);
+CPPUNIT_TEST_SUITE_END();
+
+private:
+
+mitk::IGTLMessageQueue::Pointer m_MessageQueue;
+
+igtl::StringMessage::Pointer CreateStringMessage(int number)
+{
+  igtl::StringMessage::Pointer message = igtl::StringMessage::New();
+  message->SetString(std::to_string(number));
+  return message;
+}
+
+int GetNumber(igtl::StringMessage::Pointer message)
+{
+  return std::stoi(message->GetString());
+}
+
+public:
+
+void setUp() override
+{
+  m_MessageQueue = mitk::IGTLMessageQueue::New();
+}
+
+void tearDown() override
+{
+  m_MessageQueue = nullptr;
+}
+
+void Test_NoBuffering_KeepsLatestMessage()
+{
+  m_MessageQueue->EnableNoBufferingMode(true);
+  for (int i = 0; i < 5; ++i)
+    m_MessageQueue->PushMessage(CreateStringMessage(i).GetPointer());
+
+  CPPUNIT_ASSERT_EQUAL(1, m_MessageQueue->GetSize());
+  CPPUNIT_ASSERT_EQUAL(4, GetNumber(m_MessageQueue->PullStringMessage()));
+  CPPUNIT_ASSERT_MESSAGE("The queue should be empty", m_MessageQueue->PullStringMessage().IsNull());
+  CPPUNIT_ASSERT_EQUAL(4ull, m_MessageQueue->GetNumberOfDroppedMessages());
+}
+
+void Test_DropOldest_KeepsNewestMessages()
+{
+  m_MessageQueue->SetBufferSize(3);
+  m_MessageQueue->SetDropPolicy(mitk::IGTLMessageQueue::DropOldest);
+  for (int i = 0; i < 10; ++i)
+    m_MessageQueue->PushMessage(CreateStringMessage(i).GetPointer());
+
+  CPPUNIT_ASSERT_EQUAL(3, m_MessageQueue->GetSize());
+  for (int i = 7; i < 10; ++i)
+    CPPUNIT_ASSERT_EQUAL(i, GetNumber(m_MessageQueue->PullStringMessage()));
+}
+
+void Test_DropNewest_KeepsOldestMessages()
+{
+  m_MessageQueue->SetBufferSize(3);
+  m_MessageQueue->SetDropPolicy(mitk::IGTLMessageQueue::DropNewest);
+  for (int i = 0; i < 10; ++i)
+    m_MessageQueue->PushMessage(CreateStringMessage(i).GetPointer());
+
+  CPPUNIT_ASSERT_EQUAL(3, m_MessageQueue->GetSize());
+  for (int i = 0; i < 3; ++i)
+    CPPUNIT_ASSERT_EQUAL(i, GetNumber(m_MessageQueue->PullStringMessage()));
+  CPPUNIT_ASSERT_EQUAL(7ull, m_MessageQueue->GetNumberOfDroppedMessages());
+}
+
+void Test_MessageTypes_AreQueuedSeparately()
+{
+  m_MessageQueue->EnableNoBufferingMode(true);
+  m_MessageQueue->PushMessage(CreateStringMessage(1).GetPointer());
+  m_MessageQueue->PushMessage(igtl::TransformMessage::New().GetPointer());
+
+  CPPUNIT_ASSERT_EQUAL(2, m_MessageQueue->GetSize());
+  CPPUNIT_ASSERT_MESSAGE("The transform message was not queued", m_MessageQueue->PullTransformMessage().IsNotNull());
+  CPPUNIT_ASSERT_EQUAL(1, GetNumber(m_MessageQueue->PullStringMessage()));
+}
+
+void Test_ConcurrentPushAndPull_KeepsOrder()
+{
+  const int numberOfMessages = 10000;
+  m_MessageQueue->SetBufferSize(16);
+  m_MessageQueue->SetDropPolicy(mitk::IGTLMessageQueue::DropOldest);
+
+  std::thread producer([this, numberOfMessages]() {
+    for (int i = 0; i < numberOfMessages; ++i)
+      m_MessageQueue->PushMessage(CreateStringMessage(i).GetPointer());
+  });
+
+  int last = -1;
+  bool ordered = true;
+  while (last < numberOfMessages - 1)
+  {
+    igtl::StringMessage::Pointer message = m_MessageQueue->PullStringMessage();
+    if (message.IsNull())
+      continue;
+    int number = GetNumber(message);
+    ordered = ordered && number > last;
+    last = number;
+  }
+  producer.join();
+
+  CPPUNIT_ASSERT_MESSAGE("Messages were pulled out of order", ordered);
+  CPPUNIT_ASSERT_EQUAL(0, m_MessageQueue->GetSize());
+}
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOpenIGTLinkMessageQueue)
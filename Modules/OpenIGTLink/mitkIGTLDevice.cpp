@@ -31,6 +31,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 //TODO: Which timeout is acceptable and also needed to transmit image data? Is there a maximum data limit?
 static const int SOCKET_SEND_RECEIVE_TIMEOUT_MSEC = 100;
+//Number of received messages per device type that are kept for reuse
+static const std::size_t MAXIMUM_RECYCLED_MESSAGES = 4;
 typedef itk::MutexLockHolder<itk::FastMutexLock> MutexLockHolder;
 
 mitk::IGTLDevice::IGTLDevice(bool ReadFully) :
@@ -41,6 +43,7 @@ m_StopCommunication(false),
 m_Hostname("127.0.0.1"),
 m_PortNumber(-1),
 m_LogMessages(false),
+m_RecycleMessages(true),
 m_MultiThreader(nullptr), m_SendThreadID(0), m_ReceiveThreadID(0), m_ConnectThreadID(0)
 {
   m_ReadFully = ReadFully;
@@ -121,11 +124,33 @@ bool mitk::IGTLDevice::TestConnection()
   return true;
 }
 
+igtl::MessageBase::Pointer mitk::IGTLDevice::CreateMessage(igtl::MessageHeader* header)
+{
+  if (!m_RecycleMessages)
+    return m_MessageFactory->CreateInstance(header);
+
+  //a message that is only referenced by the recycle list was pulled and
+  //released by all consumers (or dropped by the queue), so its pack buffer can
+  //be filled again. AllocatePack() keeps the buffer if the size did not change.
+  std::vector<igtl::MessageBase::Pointer>& recycled = m_RecycledMessages[header->GetDeviceType()];
+  for (auto& message : recycled)
+  {
+    if (message->GetReferenceCount() == 1)
+      return message;
+  }
+
+  igtl::MessageBase::Pointer message = m_MessageFactory->CreateInstance(header);
+  if (message.IsNotNull() && recycled.size() < MAXIMUM_RECYCLED_MESSAGES)
+    recycled.push_back(message);
+  return message;
+}
+
 unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
 {
-  // Create a message buffer to receive header
-  igtl::MessageHeader::Pointer headerMsg;
-  headerMsg = igtl::MessageHeader::New();
+  // Reuse the header buffer unless the last header was queued as a command
+  if (m_ReceiveHeader.IsNull() || m_ReceiveHeader->GetReferenceCount() > 1)
+    m_ReceiveHeader = igtl::MessageHeader::New();
+  igtl::MessageHeader::Pointer headerMsg = m_ReceiveHeader;
 
   // Initialize receive buffer
   headerMsg->InitPack();
@@ -192,7 +217,7 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
 
       //Create a message according to the header message
       igtl::MessageBase::Pointer curMessage;
-      curMessage = m_MessageFactory->CreateInstance(headerMsg);
+      curMessage = this->CreateMessage(headerMsg);
 
       //check if the curMessage is created properly, if not the message type is
       //not supported and the message has to be skipped
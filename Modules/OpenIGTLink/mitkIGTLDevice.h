@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 //igtl
 #include "igtlSocket.h"
 #include "igtlMessageBase.h"
+#include "igtlMessageHeader.h"
 #include "igtlTransformMessage.h"
 
 //mitkIGTL
@@ -35,6 +36,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIGTLMessageQueue.h"
 #include "mitkIGTLMessage.h"
 
+#include <map>
+#include <vector>
+
 namespace mitk {
   /**
   * \brief Interface for all OpenIGTLink Devices
@@ -252,6 +256,13 @@ namespace mitk {
     itkGetMacro(LogMessages, bool);
     itkSetMacro(LogMessages, bool);
 
+    /**
+    * \brief Reuse received messages and their pack buffers once every consumer
+    * released them, instead of allocating a new message for every packet
+    */
+    itkGetMacro(RecycleMessages, bool);
+    itkSetMacro(RecycleMessages, bool);
+
   protected:
     /**
      * \brief Sends a message.
@@ -293,6 +304,12 @@ namespace mitk {
     */
     unsigned int ReceivePrivate(igtl::Socket* device);
 
+    /**
+    * \brief Returns a message for the given header, reusing a recycled one if
+    * it is not referenced anymore. Only called from the receiving thread.
+    */
+    igtl::MessageBase::Pointer CreateMessage(igtl::MessageHeader* header);
+
     /**
     * \brief Call this method to send a message. The message will be read from
     * the queue.
@@ -356,6 +373,14 @@ namespace mitk {
 
     bool m_LogMessages;
 
+    bool m_RecycleMessages;
+
+    /** header that is reused for every received packet */
+    igtl::MessageHeader::Pointer m_ReceiveHeader;
+
+    /** received messages per device type, reused once only this list references them */
+    std::map<std::string, std::vector<igtl::MessageBase::Pointer> > m_RecycledMessages;
+
   private:
 
     /** creates worker thread that continuously polls interface for new
@@ -27,6 +27,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <fstream>
 
 mitk::IGTLMeasurements::IGTLMeasurements()
+  : m_IsStarted(false),
+    m_NumberOfConsumedMessages(0),
+    m_NumberOfDroppedMessages(0),
+    m_AccumulatedLatency(0),
+    m_MaximumLatency(0)
 {
 }
 
@@ -118,9 +123,51 @@ bool mitk::IGTLMeasurements::ExportData(std::string filename)
 void mitk::IGTLMeasurements::Reset()
 {
   m_MeasurementPoints.clear();
+  m_NumberOfConsumedMessages = 0;
+  m_NumberOfDroppedMessages = 0;
+  m_AccumulatedLatency = 0;
+  m_MaximumLatency = 0;
 }
 
 void mitk::IGTLMeasurements::SetStarted(bool started)
 {
   m_IsStarted = started;
 }
+
+void mitk::IGTLMeasurements::AddReceiveToConsumeLatency(long long latency)
+{
+  m_NumberOfConsumedMessages++;
+  m_AccumulatedLatency += latency;
+  long long maximum = m_MaximumLatency.load(std::memory_order_relaxed);
+  while (latency > maximum && !m_MaximumLatency.compare_exchange_weak(maximum, latency, std::memory_order_relaxed))
+  {
+  }
+}
+
+void mitk::IGTLMeasurements::AddDroppedMessage()
+{
+  m_NumberOfDroppedMessages++;
+}
+
+unsigned long long mitk::IGTLMeasurements::GetNumberOfConsumedMessages() const
+{
+  return m_NumberOfConsumedMessages;
+}
+
+unsigned long long mitk::IGTLMeasurements::GetNumberOfDroppedMessages() const
+{
+  return m_NumberOfDroppedMessages;
+}
+
+double mitk::IGTLMeasurements::GetMeanReceiveToConsumeLatency() const
+{
+  unsigned long long numberOfMessages = m_NumberOfConsumedMessages;
+  if (numberOfMessages == 0)
+    return 0.0;
+  return m_AccumulatedLatency / 1e6 / numberOfMessages;
+}
+
+double mitk::IGTLMeasurements::GetMaximumReceiveToConsumeLatency() const
+{
+  return m_MaximumLatency / 1e6;
+}
@@ -25,6 +25,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkObject.h"
 #include "mitkCommon.h"
 
+#include <atomic>
+
 namespace mitk {
 
    ///**
@@ -99,6 +101,34 @@ namespace mitk {
 
     void SetStarted(bool started);
 
+    /**
+    * \brief Adds the time a received message waited in a message queue until
+    * it was pulled
+    *
+    * In contrast to AddMeasurement() the latency counters are always active,
+    * they are cheap enough to be updated from the communication threads.
+    * \param latency the latency in nanoseconds
+    */
+    void AddReceiveToConsumeLatency(long long latency);
+
+    /**
+    * \brief Counts a message that was discarded because its queue was full
+    */
+    void AddDroppedMessage();
+
+    unsigned long long GetNumberOfConsumedMessages() const;
+    unsigned long long GetNumberOfDroppedMessages() const;
+
+    /**
+    * \brief Returns the mean receive-to-consume latency in milliseconds
+    */
+    double GetMeanReceiveToConsumeLatency() const;
+
+    /**
+    * \brief Returns the maximum receive-to-consume latency in milliseconds
+    */
+    double GetMaximumReceiveToConsumeLatency() const;
+
   private:
     // Only our module activator class should be able to instantiate
     // a SingletonOneService object.
@@ -124,6 +154,11 @@ namespace mitk {
     MeasurementPoints                               m_MeasurementPoints;
 
     bool m_IsStarted;
+
+    std::atomic<unsigned long long> m_NumberOfConsumedMessages;
+    std::atomic<unsigned long long> m_NumberOfDroppedMessages;
+    std::atomic<long long> m_AccumulatedLatency;
+    std::atomic<long long> m_MaximumLatency;
   };
 } // namespace mitk
 #endif /* MITKIGTLMeasurements_H_HEADER_INCLUDED_ */
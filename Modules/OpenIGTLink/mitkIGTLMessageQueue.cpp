@@ -15,212 +15,138 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkIGTLMessageQueue.h"
+#include "mitkIGTLMeasurements.h"
+#include <algorithm>
 #include <string>
 #include "igtlMessageBase.h"
 
-void mitk::IGTLMessageQueue::PushSendMessage(mitk::IGTLMessage::Pointer message)
+template <typename TMessagePointer>
+void mitk::IGTLMessageQueue::Push(RingBuffer<TMessagePointer> &buffer, const TMessagePointer &message)
 {
-  this->m_Mutex->Lock();
-  if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-    m_SendQueue.clear();
+  const long long timeStamp = GetTimeStamp();
+  while (buffer.GetSize() >= m_BufferSize.load(std::memory_order_relaxed) || !buffer.TryPush(message, timeStamp))
+  {
+    if (m_DropPolicy.load(std::memory_order_relaxed) == IGTLMessageQueue::DropNewest)
+    {
+      this->m_NumberOfDroppedMessages++;
+      if (m_Measurements != nullptr)
+        m_Measurements->AddDroppedMessage();
+      return;
+    }
 
-  m_SendQueue.push_back(message);
-  this->m_Mutex->Unlock();
+    // make room by discarding the oldest message, if a consumer was faster
+    // there is nothing to discard and the push is simply retried
+    TMessagePointer oldest;
+    long long oldestTimeStamp;
+    if (buffer.TryPull(oldest, oldestTimeStamp))
+    {
+      this->m_NumberOfDroppedMessages++;
+      if (m_Measurements != nullptr)
+        m_Measurements->AddDroppedMessage();
+    }
+  }
 }
 
-void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer message)
+template <typename TMessagePointer>
+TMessagePointer mitk::IGTLMessageQueue::Pull(RingBuffer<TMessagePointer> &buffer, bool measureLatency)
 {
-  this->m_Mutex->Lock();
-  if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-    m_CommandQueue.clear();
-
-  m_CommandQueue.push_back(message);
-  this->m_Mutex->Unlock();
+  TMessagePointer ret = nullptr;
+  long long timeStamp;
+  if (buffer.TryPull(ret, timeStamp) && measureLatency && m_Measurements != nullptr)
+    m_Measurements->AddReceiveToConsumeLatency(GetTimeStamp() - timeStamp);
+  return ret;
 }
 
-void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
+void mitk::IGTLMessageQueue::PushSendMessage(mitk::IGTLMessage::Pointer message)
 {
-  this->m_Mutex->Lock();
-
-  std::stringstream infolog;
+  this->Push(m_SendQueue, message);
+}
 
-  infolog << "Received message of type ";
+void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer message)
+{
+  this->Push(m_CommandQueue, message);
+}
 
-  if (dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()) != nullptr)
+void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
+{
+  if (auto trackingMsg = dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()))
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_TrackingDataQueue.clear();
-
-    this->m_TrackingDataQueue.push_back(dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()));
-
-    infolog << "TDATA";
+    this->Push(m_TrackingDataQueue, igtl::TrackingDataMessage::Pointer(trackingMsg));
   }
-  else if (dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()) != nullptr)
+  else if (auto transformMsg = dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()))
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_TransformQueue.clear();
-
-    this->m_TransformQueue.push_back(dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()));
-
-    infolog << "TRANSFORM";
+    this->Push(m_TransformQueue, igtl::TransformMessage::Pointer(transformMsg));
   }
-  else if (dynamic_cast<igtl::StringMessage*>(msg.GetPointer()) != nullptr)
+  else if (auto stringMsg = dynamic_cast<igtl::StringMessage*>(msg.GetPointer()))
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_StringQueue.clear();
-
-    this->m_StringQueue.push_back(dynamic_cast<igtl::StringMessage*>(msg.GetPointer()));
-
-    infolog << "STRING";
+    this->Push(m_StringQueue, igtl::StringMessage::Pointer(stringMsg));
   }
-  else if (dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()) != nullptr)
+  else if (auto imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()))
   {
-    igtl::ImageMessage::Pointer imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer());
-    int* dim = new int[3];
+    // the message is queued as it is, the image data stays in the received
+    // pack buffer and is not copied
+    int dim[3];
     imageMsg->GetDimensions(dim);
     if (dim[2] > 1)
-    {
-      if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-        m_Image3dQueue.clear();
-
-      this->m_Image3dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE3D";
-    }
+      this->Push(m_Image3dQueue, igtl::ImageMessage::Pointer(imageMsg));
     else
-    {
-      if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-        m_Image2dQueue.clear();
-
-      this->m_Image2dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE2D";
-    }
+      this->Push(m_Image2dQueue, igtl::ImageMessage::Pointer(imageMsg));
   }
   else
   {
-    if (this->m_BufferingType == IGTLMessageQueue::NoBuffering)
-      m_MiscQueue.clear();
-
-    this->m_MiscQueue.push_back(msg);
-
-    infolog << "OTHER";
+    this->Push(m_MiscQueue, msg);
   }
 
-  m_Latest_Message = msg;
-
-  //MITK_INFO << infolog.str();
-
-  this->m_Mutex->Unlock();
+  // the latest message is only needed for information strings, so the
+  // receive thread skips the update instead of waiting for a reader
+  std::unique_lock<std::mutex> lock(m_LatestMessageMutex, std::try_to_lock);
+  if (lock.owns_lock())
+    m_Latest_Message = msg;
 }
 
 mitk::IGTLMessage::Pointer mitk::IGTLMessageQueue::PullSendMessage()
 {
-  mitk::IGTLMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_SendQueue.size() > 0)
-  {
-    ret = this->m_SendQueue.front();
-    this->m_SendQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_SendQueue, false);
 }
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullMiscMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_MiscQueue.size() > 0)
-  {
-    ret = this->m_MiscQueue.front();
-    this->m_MiscQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_MiscQueue, true);
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage2dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image2dQueue.size() > 0)
-  {
-    ret = this->m_Image2dQueue.front();
-    this->m_Image2dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_Image2dQueue, true);
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage3dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image3dQueue.size() > 0)
-  {
-    ret = this->m_Image3dQueue.front();
-    this->m_Image3dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_Image3dQueue, true);
 }
 
 igtl::TrackingDataMessage::Pointer mitk::IGTLMessageQueue::PullTrackingMessage()
 {
-  igtl::TrackingDataMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TrackingDataQueue.size() > 0)
-  {
-    ret = this->m_TrackingDataQueue.front();
-    this->m_TrackingDataQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_TrackingDataQueue, true);
 }
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullCommandMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_CommandQueue.size() > 0)
-  {
-    ret = this->m_CommandQueue.front();
-    this->m_CommandQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_CommandQueue, true);
 }
 
 igtl::StringMessage::Pointer mitk::IGTLMessageQueue::PullStringMessage()
 {
-  igtl::StringMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_StringQueue.size() > 0)
-  {
-    ret = this->m_StringQueue.front();
-    this->m_StringQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_StringQueue, true);
 }
 
 igtl::TransformMessage::Pointer mitk::IGTLMessageQueue::PullTransformMessage()
 {
-  igtl::TransformMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TransformQueue.size() > 0)
-  {
-    ret = this->m_TransformQueue.front();
-    this->m_TransformQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->Pull(m_TransformQueue, true);
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  std::lock_guard<std::mutex> lock(m_LatestMessageMutex);
   std::stringstream s;
   if (this->m_Latest_Message != nullptr)
   {
@@ -231,13 +157,12 @@ std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  std::lock_guard<std::mutex> lock(m_LatestMessageMutex);
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -247,13 +172,12 @@ std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  std::lock_guard<std::mutex> lock(m_LatestMessageMutex);
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -264,13 +188,12 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  std::lock_guard<std::mutex> lock(m_LatestMessageMutex);
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -280,33 +203,73 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 int mitk::IGTLMessageQueue::GetSize()
 {
-  return (this->m_CommandQueue.size() + this->m_Image2dQueue.size() + this->m_Image3dQueue.size() + this->m_MiscQueue.size()
-    + this->m_StringQueue.size() + this->m_TrackingDataQueue.size() + this->m_TransformQueue.size());
+  return (this->m_CommandQueue.GetSize() + this->m_Image2dQueue.GetSize() + this->m_Image3dQueue.GetSize() + this->m_MiscQueue.GetSize()
+    + this->m_StringQueue.GetSize() + this->m_TrackingDataQueue.GetSize() + this->m_TransformQueue.GetSize());
 }
 
 void mitk::IGTLMessageQueue::EnableNoBufferingMode(bool enable)
 {
-  this->m_Mutex->Lock();
   if (enable)
+  {
     this->m_BufferingType = IGTLMessageQueue::BufferingType::NoBuffering;
+    this->SetBufferSize(1);
+  }
   else
+  {
     this->m_BufferingType = IGTLMessageQueue::BufferingType::Infinit;
-  this->m_Mutex->Unlock();
+    this->SetBufferSize(MaximumBufferSize);
+  }
+}
+
+void mitk::IGTLMessageQueue::SetBufferSize(unsigned int bufferSize)
+{
+  // messages above a reduced size are dropped by the next push
+  const unsigned int maximumBufferSize = MaximumBufferSize;
+  this->m_BufferSize = std::max(1u, std::min(bufferSize, maximumBufferSize));
+}
+
+unsigned int mitk::IGTLMessageQueue::GetBufferSize() const
+{
+  return this->m_BufferSize;
+}
+
+void mitk::IGTLMessageQueue::SetDropPolicy(DropPolicy policy)
+{
+  this->m_DropPolicy = policy;
+}
+
+mitk::IGTLMessageQueue::DropPolicy mitk::IGTLMessageQueue::GetDropPolicy() const
+{
+  return this->m_DropPolicy;
+}
+
+unsigned long long mitk::IGTLMessageQueue::GetNumberOfDroppedMessages() const
+{
+  return this->m_NumberOfDroppedMessages;
 }
 
 mitk::IGTLMessageQueue::IGTLMessageQueue()
+  : m_CommandQueue(MaximumBufferSize),
+    m_Image2dQueue(MaximumBufferSize),
+    m_Image3dQueue(MaximumBufferSize),
+    m_TransformQueue(MaximumBufferSize),
+    m_TrackingDataQueue(MaximumBufferSize),
+    m_StringQueue(MaximumBufferSize),
+    m_MiscQueue(MaximumBufferSize),
+    m_SendQueue(MaximumBufferSize),
+    m_BufferingType(IGTLMessageQueue::NoBuffering),
+    m_BufferSize(1),
+    m_DropPolicy(IGTLMessageQueue::DropOldest),
+    m_NumberOfDroppedMessages(0),
+    m_Measurements(mitk::IGTLMeasurements::GetInstance())
 {
-  this->m_Mutex = itk::FastMutexLock::New();
-  this->m_BufferingType = IGTLMessageQueue::NoBuffering;
 }
 
 mitk::IGTLMessageQueue::~IGTLMessageQueue()
 {
-  this->m_Mutex->Unlock();
 }
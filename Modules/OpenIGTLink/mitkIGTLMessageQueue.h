@@ -20,10 +20,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "MitkOpenIGTLinkExports.h"
 
 #include "itkObject.h"
-#include "itkFastMutexLock.h"
 #include "mitkCommon.h"
 
-#include <deque>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <mitkIGTLMessage.h>
 
 //OpenIGTLink
@@ -34,10 +37,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "igtlTransformMessage.h"
 
 namespace mitk {
+  class IGTLMeasurements;
+
   /**
   * \class IGTLMessageQueue
   * \brief Thread safe message queue to store OpenIGTLink messages.
   *
+  * Every message type is stored in its own bounded ring buffer. Pushing and
+  * pulling does not take a lock, so the receive thread of a device is never
+  * blocked by a consumer that is busy with the previous message. When a ring
+  * buffer is full the drop policy decides whether the oldest buffered message
+  * or the incoming one is discarded.
+  *
+  * The time between pushing a received message and pulling it is reported to
+  * mitk::IGTLMeasurements as receive-to-consume latency.
+  *
   * \ingroup OpenIGTLink
   */
   class MITKOPENIGTLINK_EXPORT IGTLMessageQueue : public itk::Object
@@ -54,6 +68,18 @@ namespace mitk {
        */
     enum BufferingType { Infinit, NoBuffering };
 
+    /**
+     * \brief Defines which message is discarded if a buffer is full
+     * DropOldest removes the oldest buffered message to make room for the new one
+     * DropNewest discards the incoming message
+     */
+    enum DropPolicy { DropOldest, DropNewest };
+
+    /**
+     * \brief Number of messages each ring buffer can hold at most
+     */
+    static const unsigned int MaximumBufferSize = 1024;
+
     void PushSendMessage(mitk::IGTLMessage::Pointer message);
 
     /**
@@ -105,38 +131,180 @@ namespace mitk {
     std::string GetLatestMsgDeviceType();
 
     /**
-     */
+    * \brief Switches between buffering a single message (NoBuffering) and
+    * MaximumBufferSize messages (Infinit) per message type
+    */
     void EnableNoBufferingMode(bool enable);
 
+    /**
+    * \brief Sets the number of messages that are buffered per message type
+    *
+    * The value is clamped to [1, MaximumBufferSize]. It can be changed while
+    * the queue is in use.
+    */
+    void SetBufferSize(unsigned int bufferSize);
+    unsigned int GetBufferSize() const;
+
+    void SetDropPolicy(DropPolicy policy);
+    DropPolicy GetDropPolicy() const;
+
+    /**
+    * \brief Returns the number of messages that were discarded because their
+    * buffer was full
+    */
+    unsigned long long GetNumberOfDroppedMessages() const;
+
   protected:
     IGTLMessageQueue();
     ~IGTLMessageQueue() override;
 
-  protected:
     /**
-    * \brief Mutex to take car of the queue
+    * \brief Bounded multi-producer/multi-consumer ring buffer
+    *
+    * Every cell carries a sequence number that tells producers and consumers
+    * whether it is free or filled (D. Vyukov's bounded queue). With the
+    * single receive thread and a single consumer of a device no compare and
+    * swap ever fails, but additional producers or consumers stay safe.
     */
-    itk::FastMutexLock::Pointer m_Mutex;
+    template <typename TMessagePointer>
+    class RingBuffer
+    {
+    public:
+      explicit RingBuffer(std::size_t capacity)
+        : m_Cells(new Cell[capacity]), m_Mask(capacity - 1), m_EnqueuePosition(0), m_DequeuePosition(0)
+      {
+        // the capacity has to be a power of two
+        for (std::size_t i = 0; i < capacity; ++i)
+          m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+      }
+
+      bool TryPush(const TMessagePointer &message, long long timeStamp)
+      {
+        Cell *cell;
+        std::size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+          cell = &m_Cells[position & m_Mask];
+          std::size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+          std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+          if (difference == 0)
+          {
+            if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+              break;
+          }
+          else if (difference < 0)
+            return false;
+          else
+            position = m_EnqueuePosition.load(std::memory_order_relaxed);
+        }
+        cell->Message = message;
+        cell->TimeStamp = timeStamp;
+        cell->Sequence.store(position + 1, std::memory_order_release);
+        return true;
+      }
+
+      bool TryPull(TMessagePointer &message, long long &timeStamp)
+      {
+        Cell *cell;
+        std::size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+          cell = &m_Cells[position & m_Mask];
+          std::size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+          std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+          if (difference == 0)
+          {
+            if (m_DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+              break;
+          }
+          else if (difference < 0)
+            return false;
+          else
+            position = m_DequeuePosition.load(std::memory_order_relaxed);
+        }
+        message = cell->Message;
+        timeStamp = cell->TimeStamp;
+        // release the reference, otherwise the buffer keeps the message alive
+        cell->Message = nullptr;
+        cell->Sequence.store(position + m_Mask + 1, std::memory_order_release);
+        return true;
+      }
+
+      std::size_t GetSize() const
+      {
+        std::size_t dequeuePosition = m_DequeuePosition.load(std::memory_order_acquire);
+        std::size_t enqueuePosition = m_EnqueuePosition.load(std::memory_order_acquire);
+        return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+      }
+
+    private:
+      struct Cell
+      {
+        std::atomic<std::size_t> Sequence;
+        TMessagePointer Message;
+        long long TimeStamp;
+      };
+
+      std::unique_ptr<Cell[]> m_Cells;
+      const std::size_t m_Mask;
+      // keep the producer and the consumer position on different cache lines
+      char m_Padding0[64];
+      std::atomic<std::size_t> m_EnqueuePosition;
+      char m_Padding1[64];
+      std::atomic<std::size_t> m_DequeuePosition;
+    };
+
+    /**
+    * \brief Pushes the message, applying the buffer size and the drop policy
+    */
+    template <typename TMessagePointer>
+    void Push(RingBuffer<TMessagePointer> &buffer, const TMessagePointer &message);
+
+    /**
+    * \brief Pulls the oldest message, or nullptr if the buffer is empty
+    * \param measureLatency report the receive-to-consume latency of the message
+    */
+    template <typename TMessagePointer>
+    TMessagePointer Pull(RingBuffer<TMessagePointer> &buffer, bool measureLatency);
+
+    static long long GetTimeStamp()
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
 
     /**
-    * \brief the queue that stores pointer to the inserted messages
+    * \brief the buffers that store pointers to the inserted messages
     */
-    std::deque< igtl::MessageBase::Pointer > m_CommandQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image2dQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image3dQueue;
-    std::deque< igtl::TransformMessage::Pointer > m_TransformQueue;
-    std::deque< igtl::TrackingDataMessage::Pointer > m_TrackingDataQueue;
-    std::deque< igtl::StringMessage::Pointer > m_StringQueue;
-    std::deque< igtl::MessageBase::Pointer > m_MiscQueue;
+    RingBuffer< igtl::MessageBase::Pointer > m_CommandQueue;
+    RingBuffer< igtl::ImageMessage::Pointer > m_Image2dQueue;
+    RingBuffer< igtl::ImageMessage::Pointer > m_Image3dQueue;
+    RingBuffer< igtl::TransformMessage::Pointer > m_TransformQueue;
+    RingBuffer< igtl::TrackingDataMessage::Pointer > m_TrackingDataQueue;
+    RingBuffer< igtl::StringMessage::Pointer > m_StringQueue;
+    RingBuffer< igtl::MessageBase::Pointer > m_MiscQueue;
 
-    std::deque< mitk::IGTLMessage::Pointer > m_SendQueue;
+    RingBuffer< mitk::IGTLMessage::Pointer > m_SendQueue;
 
+    /**
+    * \brief Mutex that guards m_Latest_Message, the receive thread never waits for it
+    */
+    std::mutex m_LatestMessageMutex;
     igtl::MessageBase::Pointer m_Latest_Message;
 
     /**
     * \brief defines the kind of buffering
     */
     BufferingType m_BufferingType;
+
+    std::atomic<unsigned int> m_BufferSize;
+    std::atomic<DropPolicy> m_DropPolicy;
+    std::atomic<unsigned long long> m_NumberOfDroppedMessages;
+
+    /**
+    * \brief receives the latency and drop counters, may be nullptr
+    */
+    IGTLMeasurements *m_Measurements;
   };
 }
 
@@ -18,7 +18,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define MITK_PHOTOACOUSTICS_BEAMFORMING_FILTER
 
 #include "mitkImageToImageFilter.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MitkPhotoacousticsAlgorithmsExports.h"
 #include "./OpenCLFilter/mitkPhotoacousticOCLBeamformingFilter.h"
 #include "mitkPhotoacousticBeamformingSettings.h"
 
@@ -29,9 +36,11 @@ namespace mitk {
   *  The class must be given a configuration class instance of mitk::BeamformingSettings for beamforming parameters through mitk::BeamformingFilter::Configure(BeamformingSettings settings)
   *  Whether the GPU is used can be set in the configuration.
   *  For significant problems or important messages a string is written, which can be accessed via GetMessageString().
+  *  On CPU, the output lines of groups of frames are beamformed by a persistent pool of worker threads; the delays are kept in a table
+  *  as long as the configuration does not change.
   */
 
-  class BeamformingFilter : public ImageToImageFilter
+  class MITKPHOTOACOUSTICSALGORITHMS_EXPORT BeamformingFilter : public ImageToImageFilter
   {
   public:
     mitkClassMacro(BeamformingFilter, ImageToImageFilter);
@@ -98,27 +107,43 @@ namespace mitk {
     */
     float* BoxFunction(int samples);
 
-    /** \brief Function to perform beamforming on CPU for a single line, using DAS and quadratic delay
-    */
-    void DASQuadraticLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize);
-    /** \brief Function to perform beamforming on CPU for a single line, using DAS and spherical delay
-    */
-    void DASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize);
-    /** \brief Function to perform beamforming on CPU for a single line, using DMAS and quadratic delay
-    */
-    void DMASQuadraticLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize);
-    /** \brief Function to perform beamforming on CPU for a single line, using DMAS and spherical delay
+    /** \brief The delays of all samples of one output line, together with the apodization weights
+    *
+    *  Only the transducer lines with a valid delay are stored. The taps of sample s are [SampleBegin[s], SampleBegin[s + 1]).
     */
-    void DMASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize);
-    /** \brief Function to perform beamforming on CPU for a single line, using signed DMAS and quadratic delay
+    struct LineDelays
+    {
+      std::vector<unsigned int> SampleBegin;
+      /** \brief Offset of the delayed input sample within a frame */
+      std::vector<unsigned int> InputOffset;
+      /** \brief Transducer line of each tap */
+      std::vector<short> TransducerLine;
+      std::vector<float> Weight;
+      /** \brief The normalization count of each sample, which is the size of the line window minus the lines with invalid delays */
+      std::vector<short> UsedLines;
+      /** \brief The last line of the window of each sample, which does not contribute to the sign of sDMAS */
+      std::vector<short> MaxLine;
+    };
+
+    /** \brief Calculates the delays of a single output line for the current configuration
+    */
+    void CalculateLineDelays(short line, const float inputDim[2], const float outputDim[2], const float* apodisation, short apodArraySize, LineDelays& delays);
+    /** \brief Function to perform beamforming on CPU for a single line of several consecutive frames
+    *
+    *  The delayed input samples of each output sample are gathered into contiguous buffers, so the compiler can vectorize
+    *  the weighting and the sums over the taps.
     */
-    void sDMASQuadraticLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize);
-    /** \brief Function to perform beamforming on CPU for a single line, using signed DMAS and spherical delay
+    void BeamformLine(const float* input, float* output, const float inputDim[2], const float outputDim[2], unsigned int frames, short line, const LineDelays& delays);
+
+    /** \brief Runs job(0), ..., job(numberOfJobs - 1) on the persistent worker threads and returns when all jobs are finished
+    *
+    *  The workers are started by the first call and kept until the filter is destroyed. If a job throws, no further jobs are
+    *  started and the first exception is rethrown.
     */
-    void sDMASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize);
+    void ParallelFor(unsigned int numberOfJobs, const std::function<void(unsigned int)>& job);
+    void WorkerLoop();
+    void RunJobs();
 
-    float* m_OutputData;
-    float* m_InputData;
     float* m_InputDataPuffer;
 
     /** \brief Pointer holding the Von-Hann apodization window for beamforming
@@ -145,6 +170,27 @@ namespace mitk {
     /** \brief The message returned by mitk::BeamformingFilter::GetMessageString()
     */
     std::string m_Message;
+
+    /** \brief The delays of all output lines; empty if they do not fit into memory and are calculated for each group of frames instead
+    */
+    std::vector<LineDelays> m_DelayTable;
+    /** \brief The configuration and input dimensions the delay table was calculated for
+    */
+    BeamformingSettings m_DelayTableConf;
+    unsigned int m_DelayTableInputDim[2];
+    bool m_DelayTableValid;
+
+    std::vector<std::thread> m_Workers;
+    std::mutex m_WorkerMutex;
+    std::condition_variable m_WorkAvailable;
+    std::condition_variable m_WorkFinished;
+    const std::function<void(unsigned int)>* m_Job;
+    unsigned int m_NumberOfJobs;
+    std::atomic<unsigned int> m_NextJob;
+    unsigned int m_BusyWorkers;
+    unsigned long m_JobGeneration;
+    bool m_StopWorkers;
+    std::exception_ptr m_JobError;
   };
 } // namespace mitk
 
@@ -19,12 +19,67 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <algorithm>
 #include <itkImageIOBase.h>
 #include <chrono>
-#include <thread>
+#include <cmath>
 #include <itkImageIOBase.h>
 #include "mitkImageCast.h"
 #include "mitkPhotoacousticBeamformingFilter.h"
 
-mitk::BeamformingFilter::BeamformingFilter() : m_OutputData(nullptr), m_InputData(nullptr), m_Message("noMessage")
+namespace
+{
+  /** Upper bound for the number of delays that are kept between updates (8 bytes plus the line index each) */
+  const double MaximumDelayTableTaps = 32 * 1024 * 1024;
+
+  /** Number of partial sums of the reductions over the taps. Each partial sum has a fixed order, so the compiler
+  * may keep them in the lanes of one vector register without reassociating floating point additions.
+  */
+  const unsigned int Lanes = 8;
+
+  /** Returns values[0] + ... + values[count - 1] */
+  float SumOfTaps(const float* values, unsigned int count)
+  {
+    float lanes[Lanes] = {};
+    unsigned int i = 0;
+    for (; i + Lanes <= count; i += Lanes)
+    {
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+        lanes[lane] += values[i + lane];
+    }
+    for (; i < count; ++i)
+      lanes[0] += values[i];
+
+    float sum = 0;
+    for (unsigned int lane = 0; lane < Lanes; ++lane)
+      sum += lanes[lane];
+    return sum;
+  }
+
+  /** Returns the sum of sign(m) * sqrt(|m|) with m = weighted_2[i] * s_1 * apod_1 for all i in [0, count), the DMAS terms of one tap s_1 */
+  float SumOfSignedRoots(const float* weighted_2, unsigned int count, float s_1, float apod_1)
+  {
+    float lanes[Lanes] = {};
+    unsigned int i = 0;
+    for (; i + Lanes <= count; i += Lanes)
+    {
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+      {
+        const float mult = weighted_2[i + lane] * s_1 * apod_1;
+        lanes[lane] += std::copysign(std::sqrt(std::fabs(mult)), mult);
+      }
+    }
+    for (; i < count; ++i)
+    {
+      const float mult = weighted_2[i] * s_1 * apod_1;
+      lanes[0] += std::copysign(std::sqrt(std::fabs(mult)), mult);
+    }
+
+    float sum = 0;
+    for (unsigned int lane = 0; lane < Lanes; ++lane)
+      sum += lanes[lane];
+    return sum;
+  }
+}
+
+mitk::BeamformingFilter::BeamformingFilter() : m_Message("noMessage"), m_DelayTableValid(false), m_Job(nullptr), m_NumberOfJobs(0), m_NextJob(0), m_BusyWorkers(0), m_JobGeneration(0), m_StopWorkers(false)
 {
   this->SetNumberOfIndexedInputs(1);
   this->SetNumberOfRequiredInputs(1);
@@ -45,6 +100,14 @@ void mitk::BeamformingFilter::SetProgressHandle(std::function<void(int, std::str
 
 mitk::BeamformingFilter::~BeamformingFilter()
 {
+  {
+    std::lock_guard<std::mutex> lock(m_WorkerMutex);
+    m_StopWorkers = true;
+  }
+  m_WorkAvailable.notify_all();
+  for (std::thread& worker : m_Workers)
+    worker.join();
+
   delete[] m_VonHannFunction;
   delete[] m_HammFunction;
   delete[] m_BoxFunction;
@@ -134,107 +197,92 @@ void mitk::BeamformingFilter::GenerateData()
 
   if (!m_Conf.UseGPU)
   {
-    int progInterval = output->GetDimension(2) / 20 > 1 ? output->GetDimension(2) / 20 : 1;
-    // the interval at which we update the gui progress bar
+    // first, we check whether the data is float, other formats are unsupported
+    if (!(input->GetPixelType().GetTypeAsString() == "scalar (float)" || input->GetPixelType().GetTypeAsString() == " (float)"))
+    {
+      MITK_INFO << "Pixel type is not float, abort";
+      return;
+    }
+
+    unsigned int frames = output->GetDimension(2);
+    int progInterval = frames / 20 > 1 ? frames / 20 : 1;
+    // the interval at which we update the gui progress bar; the frames in between are beamformed together and share the delays
 
     float inputDim[2] = { (float)input->GetDimension(0), (float)input->GetDimension(1) };
     float outputDim[2] = { (float)output->GetDimension(0), (float)output->GetDimension(1) };
-
-    for (unsigned int i = 0; i < output->GetDimension(2); ++i) // seperate Slices should get Beamforming seperately applied
+    short lines = (short)outputDim[0];
+
+    // the delays only depend on the configuration, so they are kept for the following updates
+    bool delayTableValid = m_DelayTableValid &&
+      m_DelayTableInputDim[0] == input->GetDimension(0) && m_DelayTableInputDim[1] == input->GetDimension(1) &&
+      m_DelayTableConf.Angle == m_Conf.Angle && m_DelayTableConf.Pitch == m_Conf.Pitch &&
+      m_DelayTableConf.SpeedOfSound == m_Conf.SpeedOfSound && m_DelayTableConf.TimeSpacing == m_Conf.TimeSpacing &&
+      m_DelayTableConf.TransducerElements == m_Conf.TransducerElements && m_DelayTableConf.isPhotoacousticImage == m_Conf.isPhotoacousticImage &&
+      m_DelayTableConf.SamplesPerLine == m_Conf.SamplesPerLine && m_DelayTableConf.ReconstructionLines == m_Conf.ReconstructionLines &&
+      m_DelayTableConf.DelayCalculationMethod == m_Conf.DelayCalculationMethod && m_DelayTableConf.Algorithm == m_Conf.Algorithm &&
+      m_DelayTableConf.Apod == m_Conf.Apod && m_DelayTableConf.apodizationArraySize == m_Conf.apodizationArraySize;
+
+    if (!delayTableValid)
     {
-      mitk::ImageReadAccessor inputReadAccessor(input, input->GetSliceData(i));
-
-      // first, we check whether the dara is float, other formats are unsupported
-      if (input->GetPixelType().GetTypeAsString() == "scalar (float)" || input->GetPixelType().GetTypeAsString() == " (float)")
+      m_DelayTable.clear();
+      m_DelayTable.shrink_to_fit();
+
+      // estimate the size of the table from the sizes of the line windows; larger tables are not kept
+      float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
+      float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputDim[0] / (float)m_Conf.TransducerElements;
+      double taps = 0;
+      for (short sample = 0; sample < outputDim[1]; ++sample)
       {
-        m_InputData = (float*)inputReadAccessor.GetData();
+        float part = std::max(part_multiplicator * ((float)sample / outputDim[1] * inputDim[1] / 2), 1.0f);
+        taps += std::min(2 * part + 2, inputDim[0]);
       }
-      else
+      taps *= outputDim[0];
+
+      if (taps <= MaximumDelayTableTaps)
       {
-        MITK_INFO << "Pixel type is not float, abort";
-        return;
+        m_DelayTable.resize(lines);
+        ParallelFor(lines, [&](unsigned int line) {
+          CalculateLineDelays(line, inputDim, outputDim, ApodWindow, m_Conf.apodizationArraySize, m_DelayTable[line]);
+        });
       }
 
-      m_OutputData = new float[m_Conf.ReconstructionLines*m_Conf.SamplesPerLine];
+      m_DelayTableConf = m_Conf;
+      m_DelayTableInputDim[0] = input->GetDimension(0);
+      m_DelayTableInputDim[1] = input->GetDimension(1);
+      m_DelayTableValid = true;
+    }
 
-      // fill the image with zeros
-      for (int l = 0; l < outputDim[0]; ++l)
-      {
-        for (int s = 0; s < outputDim[1]; ++s)
-        {
-          m_OutputData[l*(short)outputDim[1] + s] = 0;
-        }
-      }
+    mitk::ImageReadAccessor inputReadAccessor(input);
+    const float* inputData = (const float*)inputReadAccessor.GetData();
+    const std::size_t inputFrameSize = (std::size_t)input->GetDimension(0) * input->GetDimension(1);
+    const std::size_t outputFrameSize = (std::size_t)m_Conf.ReconstructionLines * m_Conf.SamplesPerLine;
 
-      std::thread *threads = new std::thread[(short)outputDim[0]];
+    float* outputData = new float[outputFrameSize * frames];
 
-      // every line will be beamformed in a seperate thread
-      if (m_Conf.Algorithm == BeamformingSettings::BeamformingAlgorithm::DAS)
-      {
-        if (m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::QuadApprox)
-        {
-          for (short line = 0; line < outputDim[0]; ++line)
-          {
-            threads[line] = std::thread(&BeamformingFilter::DASQuadraticLine, this, m_InputData, m_OutputData, inputDim, outputDim, line, ApodWindow, m_Conf.apodizationArraySize);
-          }
-        }
-        else if (m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::Spherical)
-        {
-          for (short line = 0; line < outputDim[0]; ++line)
-          {
-            threads[line] = std::thread(&BeamformingFilter::DASSphericalLine, this, m_InputData, m_OutputData, inputDim, outputDim, line, ApodWindow, m_Conf.apodizationArraySize);
-          }
-        }
-      }
-      else if (m_Conf.Algorithm == BeamformingSettings::BeamformingAlgorithm::DMAS)
-      {
-        if (m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::QuadApprox)
-        {
-          for (short line = 0; line < outputDim[0]; ++line)
-          {
-            threads[line] = std::thread(&BeamformingFilter::DMASQuadraticLine, this, m_InputData, m_OutputData, inputDim, outputDim, line, ApodWindow, m_Conf.apodizationArraySize);
-          }
-        }
-        else if (m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::Spherical)
-        {
-          for (short line = 0; line < outputDim[0]; ++line)
-          {
-            threads[line] = std::thread(&BeamformingFilter::DMASSphericalLine, this, m_InputData, m_OutputData, inputDim, outputDim, line, ApodWindow, m_Conf.apodizationArraySize);
-          }
-        }
-      }
-      else if (m_Conf.Algorithm == BeamformingSettings::BeamformingAlgorithm::sDMAS)
-      {
-        if (m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::QuadApprox)
+    // every output line of a group of frames is one job of the worker pool
+    for (unsigned int firstFrame = 0; firstFrame < frames; firstFrame += progInterval)
+    {
+      unsigned int groupFrames = std::min(frames - firstFrame, (unsigned int)progInterval);
+      const float* groupInput = inputData + firstFrame * inputFrameSize;
+      float* groupOutput = outputData + firstFrame * outputFrameSize;
+
+      ParallelFor(lines, [&](unsigned int line) {
+        if (!m_DelayTable.empty())
         {
-          for (short line = 0; line < outputDim[0]; ++line)
-          {
-            threads[line] = std::thread(&BeamformingFilter::sDMASQuadraticLine, this, m_InputData, m_OutputData, inputDim, outputDim, line, ApodWindow, m_Conf.apodizationArraySize);
-          }
+          BeamformLine(groupInput, groupOutput, inputDim, outputDim, groupFrames, line, m_DelayTable[line]);
         }
-        else if (m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::Spherical)
+        else
         {
-          for (short line = 0; line < outputDim[0]; ++line)
-          {
-            threads[line] = std::thread(&BeamformingFilter::sDMASSphericalLine, this, m_InputData, m_OutputData, inputDim, outputDim, line, ApodWindow, m_Conf.apodizationArraySize);
-          }
+          LineDelays delays;
+          CalculateLineDelays(line, inputDim, outputDim, ApodWindow, m_Conf.apodizationArraySize, delays);
+          BeamformLine(groupInput, groupOutput, inputDim, outputDim, groupFrames, line, delays);
         }
-      }
-      // wait for all lines to finish
-      for (short line = 0; line < outputDim[0]; ++line)
-      {
-        threads[line].join();
-      }
-
-      output->SetSlice(m_OutputData, i);
-
-      if (i % progInterval == 0)
-        m_ProgressHandle((int)((i + 1) / (float)output->GetDimension(2) * 100), "performing reconstruction");
+      });
 
-      delete[] m_OutputData;
-      m_OutputData = nullptr;
-      m_InputData = nullptr;
+      m_ProgressHandle((int)((firstFrame + groupFrames) / (float)frames * 100), "performing reconstruction");
     }
+
+    output->SetImportVolume(outputData, 0, 0, mitk::Image::ImportMemoryManagementType::ManageMemory);
   }
   #if defined(PHOTOACOUSTICS_USE_GPU) || DOXYGEN
   else
@@ -365,15 +413,14 @@ float* mitk::BeamformingFilter::BoxFunction(int samples)
   return ApodWindow;
 }
 
-void mitk::BeamformingFilter::DASQuadraticLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize)
+void mitk::BeamformingFilter::CalculateLineDelays(short line, const float inputDim[2], const float outputDim[2], const float* apodisation, short apodArraySize, LineDelays& delays)
 {
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
+  const float& inputS = inputDim[1];
+  const float& inputL = inputDim[0];
 
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
+  const float& outputS = outputDim[1];
+  const float& outputL = outputDim[0];
 
-  short AddSample = 0;
   short maxLine = 0;
   short minLine = 0;
   float delayMultiplicator = 0;
@@ -382,65 +429,20 @@ void mitk::BeamformingFilter::DASQuadraticLine(float* input, float* output, floa
 
   float part = 0.07 * inputL;
   float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
-  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / m_Conf.TransducerElements;
+  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / (float)m_Conf.TransducerElements;
   float apod_mult = 1;
 
   short usedLines = (maxLine - minLine);
-
-  //quadratic delay
-  l_i = line / outputL * inputL;
-
-  for (short sample = 0; sample < outputS; ++sample)
-  {
-    s_i = (float)sample / outputS * inputS / 2;
-
-    part = part_multiplicator*s_i;
-
-    if (part < 1)
-      part = 1;
-
-    maxLine = (short)std::min((l_i + part) + 1, inputL);
-    minLine = (short)std::max((l_i - part), 0.0f);
-    usedLines = (maxLine - minLine);
-
-    apod_mult = (float)apodArraySize / (float)usedLines;
-
-    delayMultiplicator = pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (m_Conf.Pitch*m_Conf.TransducerElements) / inputL), 2) / s_i / 2;
-
-    for (short l_s = minLine; l_s < maxLine; ++l_s)
-    {
-      AddSample = delayMultiplicator * pow((l_s - l_i), 2) + s_i + (1 - m_Conf.isPhotoacousticImage)*s_i;
-      if (AddSample < inputS && AddSample >= 0) 
-        output[sample*(short)outputL + line] += input[l_s + AddSample*(short)inputL] * apodisation[(short)((l_s - minLine)*apod_mult)];
-      else
-        --usedLines;
-    }
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / usedLines;
-  }
-}
-
-void mitk::BeamformingFilter::DASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize)
-{
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
-
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
-
   short AddSample = 0;
-  short maxLine = 0;
-  short minLine = 0;
-  float l_i = 0;
-  float s_i = 0;
 
-  float part = 0.07 * inputL;
-  float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
-  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / (float)m_Conf.TransducerElements;
-  float apod_mult = 1;
+  bool DAS = m_Conf.Algorithm == BeamformingSettings::BeamformingAlgorithm::DAS;
 
-  short usedLines = (maxLine - minLine);
-
-  //exact delay
+  delays.SampleBegin.assign(1, 0);
+  delays.InputOffset.clear();
+  delays.TransducerLine.clear();
+  delays.Weight.clear();
+  delays.UsedLines.clear();
+  delays.MaxLine.clear();
 
   l_i = (float)line / outputL * inputL;
 
@@ -459,343 +461,174 @@ void mitk::BeamformingFilter::DASSphericalLine(float* input, float* output, floa
 
     apod_mult = (float)apodArraySize / (float)usedLines;
 
-    for (short l_s = minLine; l_s < maxLine; ++l_s)
-    {
-      AddSample = (int)sqrt(
-        pow(s_i, 2)
-        +
-        pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (((float)l_s - l_i)*m_Conf.Pitch*(float)m_Conf.TransducerElements) / inputL), 2)
-      ) + (1 - m_Conf.isPhotoacousticImage)*s_i;
-      if (AddSample < inputS && AddSample >= 0) 
-        output[sample*(short)outputL + line] += input[l_s + AddSample*(short)inputL] * apodisation[(short)((l_s - minLine)*apod_mult)];
-      else
-        --usedLines;
-    }
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / usedLines;
-  }
-}
-
-
-void mitk::BeamformingFilter::DMASQuadraticLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize)
-{
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
-
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
-
-  short maxLine = 0;
-  short minLine = 0;
-  float delayMultiplicator = 0;
-  float l_i = 0;
-  float s_i = 0;
-
-  float part = 0.07 * inputL;
-  float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
-  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / (float)m_Conf.TransducerElements;
-  float apod_mult = 1;
-
-  float mult = 0;
-  short usedLines = (maxLine - minLine);
-
-  //quadratic delay
-  l_i = line / outputL * inputL;
-
-  for (short sample = 0; sample < outputS; ++sample)
-  {
-    s_i = sample / outputS * inputS / 2;
-
-    part = part_multiplicator*s_i;
-
-    if (part < 1)
-      part = 1;
-
-    maxLine = (short)std::min((l_i + part) + 1, inputL);
-    minLine = (short)std::max((l_i - part), 0.0f);
-    usedLines = (maxLine - minLine);
-
-    apod_mult = (float)apodArraySize / (float)usedLines;
-
     delayMultiplicator = pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (m_Conf.Pitch*m_Conf.TransducerElements) / inputL), 2) / s_i / 2;
 
-    //calculate the AddSamples beforehand to save some time
-    short* AddSample = new short[maxLine - minLine];
-    for (short l_s = 0; l_s < maxLine - minLine; ++l_s)
-    {
-      AddSample[l_s] = (short)(delayMultiplicator * pow((minLine + l_s - l_i), 2) + s_i) + (1 - m_Conf.isPhotoacousticImage)*s_i;
-    }
-
-    float s_1 = 0;
-    float s_2 = 0;
-
-    for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
+    for (short l_s = minLine; l_s < maxLine; ++l_s)
     {
-      if (AddSample[l_s1 - minLine] < inputS && AddSample[l_s1 - minLine] >= 0)
+      if (m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::QuadApprox)
       {
-        for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
-        {
-          if (AddSample[l_s2 - minLine] < inputS && AddSample[l_s2 - minLine] >= 0)
-          {
-            s_2 = input[l_s2 + AddSample[l_s2 - minLine] * (short)inputL];
-            s_1 = input[l_s1 + AddSample[l_s1 - minLine] * (short)inputL];
-
-            mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
-            output[sample*(short)outputL + line] += sqrt(fabs(mult)) * ((mult > 0) - (mult < 0));
-          }
-        }
+        // DAS rounds the complete delay, DMAS rounds before adding the ultrasound offset
+        if (DAS)
+          AddSample = delayMultiplicator * pow((l_s - l_i), 2) + s_i + (1 - m_Conf.isPhotoacousticImage)*s_i;
+        else
+          AddSample = (short)(delayMultiplicator * pow((l_s - l_i), 2) + s_i) + (1 - m_Conf.isPhotoacousticImage)*s_i;
       }
       else
+      {
+        AddSample = (int)sqrt(
+          pow(s_i, 2)
+          +
+          pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (((float)l_s - l_i)*m_Conf.Pitch*(float)m_Conf.TransducerElements) / inputL), 2)
+        ) + (1 - m_Conf.isPhotoacousticImage)*s_i;
+      }
+
+      if (AddSample < inputS && AddSample >= 0)
+      {
+        delays.InputOffset.push_back(l_s + AddSample*(short)inputL);
+        delays.TransducerLine.push_back(l_s);
+        delays.Weight.push_back(apodisation[(int)((l_s - minLine)*apod_mult)]);
+      }
+      else if (DAS || l_s < maxLine - 1) // DMAS never checks the last line of the window on its own
         --usedLines;
     }
 
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / (float)(pow(usedLines, 2) - (usedLines - 1));
-
-    delete[] AddSample;
+    delays.SampleBegin.push_back(delays.InputOffset.size());
+    delays.UsedLines.push_back(usedLines);
+    delays.MaxLine.push_back(maxLine);
   }
 }
 
-void mitk::BeamformingFilter::DMASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize)
+void mitk::BeamformingFilter::BeamformLine(const float* input, float* output, const float inputDim[2], const float outputDim[2], unsigned int frames, short line, const LineDelays& delays)
 {
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
-
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
-
-  short maxLine = 0;
-  short minLine = 0;
-  float l_i = 0;
-  float s_i = 0;
+  const std::size_t inputFrameSize = (std::size_t)inputDim[0] * (std::size_t)inputDim[1];
+  const std::size_t outputFrameSize = (std::size_t)outputDim[0] * (std::size_t)outputDim[1];
 
-  float part = 0.07 * inputL;
-  float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
-  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / (float)m_Conf.TransducerElements;
-  float apod_mult = 1;
+  const float& outputS = outputDim[1];
+  const float& outputL = outputDim[0];
 
-  float mult = 0;
+  const bool DAS = m_Conf.Algorithm == BeamformingSettings::BeamformingAlgorithm::DAS;
 
-  short usedLines = (maxLine - minLine);
-
-  //exact delay
-
-  l_i = (float)line / outputL * inputL;
+  // the delayed input samples of one output sample are gathered into contiguous buffers, the sums over the taps run on these
+  std::vector<float> samples;
+  std::vector<float> weightedSamples;
 
-  for (short sample = 0; sample < outputS; ++sample)
+  for (unsigned int frame = 0; frame < frames; ++frame)
   {
-    s_i = (float)sample / outputS * inputS / 2;
+    const float* frameInput = input + frame * inputFrameSize;
+    float* frameOutput = output + frame * outputFrameSize;
 
-    part = part_multiplicator*s_i;
+    for (short sample = 0; sample < outputS; ++sample)
+    {
+      const unsigned int begin = delays.SampleBegin[sample];
+      const unsigned int taps = delays.SampleBegin[sample + 1] - begin;
+      const short usedLines = delays.UsedLines[sample];
 
-    if (part < 1)
-      part = 1;
+      samples.resize(taps);
+      weightedSamples.resize(taps);
 
-    maxLine = (short)std::min((l_i + part) + 1, inputL);
-    minLine = (short)std::max((l_i - part), 0.0f);
-    usedLines = (maxLine - minLine);
+      float sign = 0;
+      for (unsigned int tap = 0; tap < taps; ++tap)
+      {
+        samples[tap] = frameInput[delays.InputOffset[begin + tap]];
+        if (!DAS && delays.TransducerLine[begin + tap] < delays.MaxLine[sample] - 1)
+          sign += samples[tap];
+      }
 
-    apod_mult = (float)apodArraySize / (float)usedLines;
+      const float* weights = &delays.Weight[begin];
+      for (unsigned int tap = 0; tap < taps; ++tap)
+        weightedSamples[tap] = samples[tap] * weights[tap];
 
-    //calculate the AddSamples beforehand to save some time
-    short* AddSample = new short[maxLine - minLine];
-    for (short l_s = 0; l_s < maxLine - minLine; ++l_s)
-    {
-      AddSample[l_s] = (short)sqrt(
-        pow(s_i, 2)
-        +
-        pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (((float)minLine + (float)l_s - l_i)*m_Conf.Pitch*(float)m_Conf.TransducerElements) / inputL), 2)
-      ) + (1 - m_Conf.isPhotoacousticImage)*s_i;
-    }
+      float& out = frameOutput[sample*(short)outputL + line];
 
-    float s_1 = 0;
-    float s_2 = 0;
-
-    for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
-    {
-      if (AddSample[l_s1 - minLine] < inputS && AddSample[l_s1 - minLine] >= 0)
+      if (DAS)
       {
-        for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
-        {
-          if (AddSample[l_s2 - minLine] < inputS && AddSample[l_s2 - minLine] >= 0)
-          {
-            s_2 = input[l_s2 + AddSample[l_s2 - minLine] * (short)inputL];
-            s_1 = input[l_s1 + AddSample[l_s1 - minLine] * (short)inputL];
-
-            mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
-            output[sample*(short)outputL + line] += sqrt(fabs(mult)) * ((mult > 0) - (mult < 0));
-          }
-        }
+        out = SumOfTaps(weightedSamples.data(), taps) / usedLines;
+        continue;
       }
-      else
-        --usedLines;
-    }
 
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / (float)(pow(usedLines, 2) - (usedLines - 1));
+      // all pairs of taps, multiplied in the same order as s_2 * apod_2 * s_1 * apod_1
+      float sum = 0;
+      for (unsigned int tap1 = 0; tap1 + 1 < taps; ++tap1)
+        sum += SumOfSignedRoots(weightedSamples.data() + tap1 + 1, taps - tap1 - 1, samples[tap1], weights[tap1]);
 
-    delete[] AddSample;
+      out = sum / (float)(pow(usedLines, 2) - (usedLines - 1));
+      if (m_Conf.Algorithm == BeamformingSettings::BeamformingAlgorithm::sDMAS)
+        out = out * ((sign > 0) - (sign < 0));
+    }
   }
 }
 
-void mitk::BeamformingFilter::sDMASQuadraticLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize)
+void mitk::BeamformingFilter::ParallelFor(unsigned int numberOfJobs, const std::function<void(unsigned int)>& job)
 {
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
-
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
-
-  short maxLine = 0;
-  short minLine = 0;
-  float delayMultiplicator = 0;
-  float l_i = 0;
-  float s_i = 0;
-
-  float part = 0.07 * inputL;
-  float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
-  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / (float)m_Conf.TransducerElements;
-  float apod_mult = 1;
-
-  float mult = 0;
-  short usedLines = (maxLine - minLine);
-
-  //quadratic delay
-  l_i = line / outputL * inputL;
-
-  for (short sample = 0; sample < outputS; ++sample)
+  if (m_Workers.empty())
   {
-    s_i = sample / outputS * inputS / 2;
-
-    part = part_multiplicator*s_i;
-
-    if (part < 1)
-      part = 1;
-
-    maxLine = (short)std::min((l_i + part) + 1, inputL);
-    minLine = (short)std::max((l_i - part), 0.0f);
-    usedLines = (maxLine - minLine);
+    // the calling thread works on the jobs as well
+    unsigned int numberOfWorkers = std::thread::hardware_concurrency();
+    for (unsigned int i = 1; i < numberOfWorkers; ++i)
+      m_Workers.push_back(std::thread(&BeamformingFilter::WorkerLoop, this));
+  }
 
-    apod_mult = (float)apodArraySize / (float)usedLines;
+  {
+    std::lock_guard<std::mutex> lock(m_WorkerMutex);
+    m_Job = &job;
+    m_NumberOfJobs = numberOfJobs;
+    m_NextJob = 0;
+    m_BusyWorkers = m_Workers.size();
+    m_JobError = nullptr;
+    ++m_JobGeneration;
+  }
+  m_WorkAvailable.notify_all();
 
-    delayMultiplicator = pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (m_Conf.Pitch*m_Conf.TransducerElements) / inputL), 2) / s_i / 2;
+  this->RunJobs();
 
-    //calculate the AddSamples beforehand to save some time
-    short* AddSample = new short[maxLine - minLine];
-    for (short l_s = 0; l_s < maxLine - minLine; ++l_s)
-    {
-      AddSample[l_s] = (short)(delayMultiplicator * pow((minLine + l_s - l_i), 2) + s_i) + (1 - m_Conf.isPhotoacousticImage)*s_i;
-    }
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(m_WorkerMutex);
+    m_WorkFinished.wait(lock, [this] { return m_BusyWorkers == 0; });
+    m_Job = nullptr;
+    std::swap(error, m_JobError);
+  }
 
-    float s_1 = 0;
-    float s_2 = 0;
-    float sign = 0;
+  if (error)
+    std::rethrow_exception(error);
+}
 
-    for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
+void mitk::BeamformingFilter::WorkerLoop()
+{
+  unsigned long generation = 0;
+  while (true)
+  {
     {
-      if (AddSample[l_s1 - minLine] < inputS && AddSample[l_s1 - minLine] >= 0)
-      {
-        s_1 = input[l_s1 + AddSample[l_s1 - minLine] * (short)inputL];
-        sign += s_1;
-
-        for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
-        {
-          if (AddSample[l_s2 - minLine] < inputS && AddSample[l_s2 - minLine] >= 0)
-          {
-            s_2 = input[l_s2 + AddSample[l_s2 - minLine] * (short)inputL];
-
-            mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
-            output[sample*(short)outputL + line] += sqrt(fabs(mult)) * ((mult > 0) - (mult < 0));
-          }
-        }
-      }
-      else
-        --usedLines;
+      std::unique_lock<std::mutex> lock(m_WorkerMutex);
+      m_WorkAvailable.wait(lock, [this, generation] { return m_StopWorkers || m_JobGeneration != generation; });
+      if (m_StopWorkers)
+        return;
+      generation = m_JobGeneration;
     }
 
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / (float)(pow(usedLines, 2) - (usedLines - 1)) * ((sign > 0) - (sign < 0));
+    this->RunJobs();
 
-    delete[] AddSample;
+    std::lock_guard<std::mutex> lock(m_WorkerMutex);
+    if (--m_BusyWorkers == 0)
+      m_WorkFinished.notify_one();
   }
 }
 
-void mitk::BeamformingFilter::sDMASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize)
+void mitk::BeamformingFilter::RunJobs()
 {
-  float& inputS = inputDim[1];
-  float& inputL = inputDim[0];
-
-  float& outputS = outputDim[1];
-  float& outputL = outputDim[0];
-
-  short maxLine = 0;
-  short minLine = 0;
-  float l_i = 0;
-  float s_i = 0;
-
-  float part = 0.07 * inputL;
-  float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
-  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / (float)m_Conf.TransducerElements;
-  float apod_mult = 1;
-
-  float mult = 0;
-
-  short usedLines = (maxLine - minLine);
-
-  //exact delay
-
-  l_i = (float)line / outputL * inputL;
-
-  for (short sample = 0; sample < outputS; ++sample)
+  for (unsigned int job = m_NextJob++; job < m_NumberOfJobs; job = m_NextJob++)
   {
-    s_i = (float)sample / outputS * inputS / 2;
-
-    part = part_multiplicator*s_i;
-
-    if (part < 1)
-      part = 1;
-
-    maxLine = (short)std::min((l_i + part) + 1, inputL);
-    minLine = (short)std::max((l_i - part), 0.0f);
-    usedLines = (maxLine - minLine);
-
-    apod_mult = (float)apodArraySize / (float)usedLines;
-
-    //calculate the AddSamples beforehand to save some time
-    short* AddSample = new short[maxLine - minLine];
-    for (short l_s = 0; l_s < maxLine - minLine; ++l_s)
+    try
     {
-      AddSample[l_s] = (short)sqrt(
-        pow(s_i, 2)
-        +
-        pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (((float)minLine + (float)l_s - l_i)*m_Conf.Pitch*(float)m_Conf.TransducerElements) / inputL), 2)
-      ) + (1 - m_Conf.isPhotoacousticImage)*s_i;
+      (*m_Job)(job);
     }
-
-    float s_1 = 0;
-    float s_2 = 0;
-    float sign = 0;
-
-    for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
+    catch (...)
     {
-      if (AddSample[l_s1 - minLine] < inputS && AddSample[l_s1 - minLine] >= 0)
-      {
-        s_1 = input[l_s1 + AddSample[l_s1 - minLine] * (short)inputL];
-        sign += s_1;
-
-        for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
-        {
-          if (AddSample[l_s2 - minLine] < inputS && AddSample[l_s2 - minLine] >= 0)
-          {
-            s_2 = input[l_s2 + AddSample[l_s2 - minLine] * (short)inputL];
-
-            mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
-            output[sample*(short)outputL + line] += sqrt(fabs(mult)) * ((mult > 0) - (mult < 0));
-          }
-        }
-      }
-      else
-        --usedLines;
+      std::lock_guard<std::mutex> lock(m_WorkerMutex);
+      if (!m_JobError)
+        m_JobError = std::current_exception();
+      // the remaining jobs are skipped
+      m_NextJob = m_NumberOfJobs;
     }
-
-    output[sample*(short)outputL + line] = output[sample*(short)outputL + line] / (float)(pow(usedLines, 2) - (usedLines - 1)) * ((sign > 0) - (sign < 0));
-
-    delete[] AddSample;
   }
 }
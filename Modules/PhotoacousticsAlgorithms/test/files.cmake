@@ -0,0 +1,3 @@
+set(MODULE_CUSTOM_TESTS
+  mitkBeamformingFilterBenchmarkTest.cpp
+)
@@ -0,0 +1,271 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+
+#include <mitkImageReadAccessor.h>
+#include <mitkPhotoacousticBeamformingFilter.h>
+
+#include <itkTimeProbe.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/**
+ * Compares the CPU beamforming of mitk::BeamformingFilter with the previous implementation, which started one
+ * thread per output line and frame, on synthetic raw data and reports the frame rates of both.
+ *
+ * The raw data has as many transducer elements as reconstructed lines (argv[1]), argv[2] samples per line and
+ * argv[3] frames. A 128 element probe with 2048 samples is the typical real-time setting; the frame rates of the
+ * two implementations only become comparable to the acquisition rate at that size.
+ */
+namespace
+{
+  mitk::BeamformingSettings CreateSettings(unsigned int lines, unsigned int samples, unsigned int frames)
+  {
+    mitk::BeamformingSettings settings;
+    settings.UseGPU = false;
+    settings.Pitch = 0.0003;
+    settings.SpeedOfSound = 1540;
+    settings.TimeSpacing = 0.000000025;
+    settings.Angle = 27;
+    settings.TransducerElements = lines;
+    settings.ReconstructionLines = lines;
+    settings.SamplesPerLine = samples;
+    settings.inputDim[0] = lines;
+    settings.inputDim[1] = samples;
+    settings.inputDim[2] = frames;
+    settings.Apod = mitk::BeamformingSettings::Apodization::Hann;
+    return settings;
+  }
+
+  /** Point sources in noise, so that the delay and sign calculations are not trivial */
+  mitk::Image::Pointer CreateRawData(unsigned int lines, unsigned int samples, unsigned int frames)
+  {
+    float *data = new float[lines * samples * frames];
+    unsigned int state = 42;
+    for (unsigned int i = 0; i < lines * samples * frames; ++i)
+    {
+      state = state * 1664525u + 1013904223u;
+      data[i] = (float)(state >> 16) / 65536.f - 0.5f;
+    }
+    for (unsigned int frame = 0; frame < frames; ++frame)
+      for (unsigned int line = 0; line < lines; ++line)
+        data[(frame * samples + (samples / 4 + frame % 7)) * lines + line] += 10;
+
+    unsigned int dimensions[3] = { lines, samples, frames };
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    image->SetImportVolume(data, 0, 0, mitk::Image::ImportMemoryManagementType::ManageMemory);
+    return image;
+  }
+
+  /** The per line delay and sum loops as they were implemented before the worker pool */
+  void PreviousLine(const mitk::BeamformingSettings &conf, float *input, float *output, float inputDim[2],
+                    float outputDim[2], short line, const float *apodisation, short apodArraySize)
+  {
+    float &inputS = inputDim[1];
+    float &inputL = inputDim[0];
+    float &outputS = outputDim[1];
+    float &outputL = outputDim[0];
+
+    bool DAS = conf.Algorithm == mitk::BeamformingSettings::BeamformingAlgorithm::DAS;
+    float tan_phi = std::tan(conf.Angle / 360 * 2 * itk::Math::pi);
+    float part_multiplicator = tan_phi * conf.TimeSpacing * conf.SpeedOfSound / conf.Pitch * inputL / (float)conf.TransducerElements;
+    float l_i = (float)line / outputL * inputL;
+
+    for (short sample = 0; sample < outputS; ++sample)
+    {
+      float s_i = (float)sample / outputS * inputS / 2;
+      float part = std::max(part_multiplicator * s_i, 1.0f);
+      short maxLine = (short)std::min((l_i + part) + 1, inputL);
+      short minLine = (short)std::max((l_i - part), 0.0f);
+      short usedLines = (maxLine - minLine);
+      float apod_mult = (float)apodArraySize / (float)usedLines;
+      float delayMultiplicator = pow((1 / (conf.TimeSpacing*conf.SpeedOfSound) * (conf.Pitch*conf.TransducerElements) / inputL), 2) / s_i / 2;
+
+      std::vector<short> AddSample(maxLine - minLine);
+      for (short l_s = minLine; l_s < maxLine; ++l_s)
+      {
+        if (conf.DelayCalculationMethod == mitk::BeamformingSettings::DelayCalc::QuadApprox)
+        {
+          if (DAS)
+            AddSample[l_s - minLine] = delayMultiplicator * pow((l_s - l_i), 2) + s_i + (1 - conf.isPhotoacousticImage)*s_i;
+          else
+            AddSample[l_s - minLine] = (short)(delayMultiplicator * pow((l_s - l_i), 2) + s_i) + (1 - conf.isPhotoacousticImage)*s_i;
+        }
+        else
+        {
+          AddSample[l_s - minLine] = (short)sqrt(pow(s_i, 2) +
+            pow((1 / (conf.TimeSpacing*conf.SpeedOfSound) * (((float)l_s - l_i)*conf.Pitch*(float)conf.TransducerElements) / inputL), 2)
+          ) + (1 - conf.isPhotoacousticImage)*s_i;
+        }
+      }
+
+      float &out = output[sample*(short)outputL + line];
+      out = 0;
+
+      if (DAS)
+      {
+        for (short l_s = minLine; l_s < maxLine; ++l_s)
+        {
+          if (AddSample[l_s - minLine] < inputS && AddSample[l_s - minLine] >= 0)
+            out += input[l_s + AddSample[l_s - minLine] * (short)inputL] * apodisation[(short)((l_s - minLine)*apod_mult)];
+          else
+            --usedLines;
+        }
+        out = out / usedLines;
+        continue;
+      }
+
+      float sign = 0;
+      for (short l_s1 = minLine; l_s1 < maxLine - 1; ++l_s1)
+      {
+        if (AddSample[l_s1 - minLine] < inputS && AddSample[l_s1 - minLine] >= 0)
+        {
+          float s_1 = input[l_s1 + AddSample[l_s1 - minLine] * (short)inputL];
+          sign += s_1;
+          for (short l_s2 = l_s1 + 1; l_s2 < maxLine; ++l_s2)
+          {
+            if (AddSample[l_s2 - minLine] < inputS && AddSample[l_s2 - minLine] >= 0)
+            {
+              float s_2 = input[l_s2 + AddSample[l_s2 - minLine] * (short)inputL];
+              float mult = s_2 * apodisation[(int)((l_s2 - minLine)*apod_mult)] * s_1 * apodisation[(int)((l_s1 - minLine)*apod_mult)];
+              out += sqrt(fabs(mult)) * ((mult > 0) - (mult < 0));
+            }
+          }
+        }
+        else
+          --usedLines;
+      }
+
+      out = out / (float)(pow(usedLines, 2) - (usedLines - 1));
+      if (conf.Algorithm == mitk::BeamformingSettings::BeamformingAlgorithm::sDMAS)
+        out = out * ((sign > 0) - (sign < 0));
+    }
+  }
+
+  std::vector<float> BeamformPrevious(const mitk::BeamformingSettings &conf, mitk::Image *input)
+  {
+    unsigned int frames = input->GetDimension(2);
+    float inputDim[2] = { (float)input->GetDimension(0), (float)input->GetDimension(1) };
+    float outputDim[2] = { (float)conf.ReconstructionLines, (float)conf.SamplesPerLine };
+    unsigned int frameSize = conf.ReconstructionLines * conf.SamplesPerLine;
+
+    std::vector<float> apodisation(conf.apodizationArraySize);
+    for (int n = 0; n < conf.apodizationArraySize; ++n)
+      apodisation[n] = (1 - cos(2 * itk::Math::pi * n / (conf.apodizationArraySize - 1))) / 2;
+
+    mitk::ImageReadAccessor inputAccessor(input);
+    float *inputData = (float *)inputAccessor.GetData();
+    std::vector<float> output(frameSize * frames);
+
+    for (unsigned int frame = 0; frame < frames; ++frame)
+    {
+      std::vector<std::thread> threads;
+      for (short line = 0; line < outputDim[0]; ++line)
+      {
+        threads.push_back(std::thread(PreviousLine, std::cref(conf), inputData + frame * (unsigned int)(inputDim[0] * inputDim[1]),
+                                      &output[frame * frameSize], inputDim, outputDim, line, apodisation.data(),
+                                      (short)conf.apodizationArraySize));
+      }
+      for (std::thread &thread : threads)
+        thread.join();
+    }
+    return output;
+  }
+
+  void CompareWithPreviousImplementation(mitk::BeamformingSettings conf, mitk::Image *input, const std::string &name)
+  {
+    unsigned int frames = input->GetDimension(2);
+
+    itk::TimeProbe previousProbe;
+    previousProbe.Start();
+    std::vector<float> expected = BeamformPrevious(conf, input);
+    previousProbe.Stop();
+
+    mitk::BeamformingFilter::Pointer filter = mitk::BeamformingFilter::New();
+    filter->Configure(conf);
+    filter->SetInput(input);
+
+    itk::TimeProbe filterProbe;
+    filterProbe.Start();
+    filter->Update();
+    filterProbe.Stop();
+
+    // a second update reuses the delay table
+    itk::TimeProbe cachedProbe;
+    filter->Modified();
+    cachedProbe.Start();
+    filter->Update();
+    cachedProbe.Stop();
+
+    MITK_TEST_OUTPUT(<< name << ": previous implementation " << frames / previousProbe.GetTotal()
+                     << " frames/s, BeamformingFilter " << frames / filterProbe.GetTotal()
+                     << " frames/s, with cached delays " << frames / cachedProbe.GetTotal() << " frames/s");
+
+    mitk::Image::Pointer output = filter->GetOutput();
+    MITK_TEST_CONDITION_REQUIRED(output->GetDimension(0) == conf.ReconstructionLines &&
+                                 output->GetDimension(1) == conf.SamplesPerLine && output->GetDimension(2) == frames,
+                                 name << ": output has the expected dimensions");
+
+    mitk::ImageReadAccessor outputAccessor(output);
+    const float *outputData = (const float *)outputAccessor.GetData();
+
+    unsigned int mismatches = 0;
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      if (std::isnan(expected[i]) ? !std::isnan(outputData[i])
+                                  : std::abs(expected[i] - outputData[i]) > 1e-5f * std::max(1.f, std::abs(expected[i])))
+        ++mismatches;
+    }
+    MITK_TEST_CONDITION(mismatches == 0, name << ": output equals the previous implementation (" << mismatches
+                                              << " mismatches)");
+  }
+}
+
+int mitkBeamformingFilterBenchmarkTest(int argc, char *argv[])
+{
+  MITK_TEST_BEGIN("mitkBeamformingFilterBenchmarkTest")
+
+  MITK_TEST_CONDITION_REQUIRED(argc == 4, "Test is invoked with exactly 3 parameters (lines, samples per line, frames)");
+
+  const unsigned int lines = static_cast<unsigned int>(std::atoi(argv[1]));
+  const unsigned int samples = static_cast<unsigned int>(std::atoi(argv[2]));
+  const unsigned int frames = static_cast<unsigned int>(std::atoi(argv[3]));
+
+  mitk::Image::Pointer input = CreateRawData(lines, samples, frames);
+  mitk::BeamformingSettings conf = CreateSettings(lines, samples, frames);
+
+  conf.Algorithm = mitk::BeamformingSettings::BeamformingAlgorithm::DAS;
+  conf.DelayCalculationMethod = mitk::BeamformingSettings::DelayCalc::QuadApprox;
+  CompareWithPreviousImplementation(conf, input, "DAS, quadratic delays");
+  conf.DelayCalculationMethod = mitk::BeamformingSettings::DelayCalc::Spherical;
+  CompareWithPreviousImplementation(conf, input, "DAS, spherical delays");
+
+  conf.Algorithm = mitk::BeamformingSettings::BeamformingAlgorithm::DMAS;
+  conf.DelayCalculationMethod = mitk::BeamformingSettings::DelayCalc::QuadApprox;
+  CompareWithPreviousImplementation(conf, input, "DMAS, quadratic delays");
+
+  conf.Algorithm = mitk::BeamformingSettings::BeamformingAlgorithm::sDMAS;
+  conf.DelayCalculationMethod = mitk::BeamformingSettings::DelayCalc::Spherical;
+  CompareWithPreviousImplementation(conf, input, "sDMAS, spherical delays");
+
+  MITK_TEST_END()
+}
@@ -34,6 +34,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <time.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <memory>
 
 #include <vector>
 #include <iostream>
@@ -610,9 +613,270 @@ public:
   }
 };
 
+/***********************************************************
+ *  Counter based random numbers for the batched photon transport.
+ *  Every photon owns a key and draws its n-th random number by
+ *  hashing key and n (splitmix64 finalizer), so that photons in
+ *  different lanes never share generator state and the streams do
+ *  not depend on the order in which lanes are processed.
+ *  Only integer arithmetic and bit copies are used, so that the
+ *  lane loops drawing random numbers can be vectorized.
+ *  Returns 0 < rnd <= 1.
+ ****/
+inline unsigned long long MixBits(unsigned long long z)
+{
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+inline double BitsToDouble(unsigned long long bits)
+{
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline unsigned long long DoubleToBits(double value)
+{
+  unsigned long long bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline double CounterBasedRandom(unsigned long long key, unsigned long long counter)
+{
+  /* 52 random mantissa bits give 1 <= value < 2 */
+  return 2.0 - BitsToDouble(0x3FF0000000000000ULL | (MixBits(key + counter * 0x9E3779B97F4A7C15ULL) >> 12));
+}
+
+/***********************************************************
+ *  Branch free log, exp and sincos for the lane loops of the
+ *  batched transport. The library functions are not vectorized
+ *  by the compiler without fast math flags. Rounding to integers
+ *  adds and subtracts 1.5 * 2^52 instead of calling floor or
+ *  converting between integers and doubles, which also need
+ *  newer instruction sets to vectorize. All three are accurate
+ *  to a few units in the last place for the arguments used here.
+ ****/
+const double RoundingShift = 6755399441055744.0; /* 1.5 * 2^52 */
+
+/* floor(value) for |value| < 2^51 */
+inline double FloorLane(double value)
+{
+  const double rounded = (value + RoundingShift) - RoundingShift;
+  return rounded - (rounded > value ? 1.0 : 0.0);
+}
+
+/* log(value) for normal value > 0 */
+inline double LogLane(double value)
+{
+  const unsigned long long bits = DoubleToBits(value);
+  /* the biased exponent is below 2^11, so it is read exactly from the mantissa of 2^52 + exponent */
+  double exponent = (BitsToDouble(0x4330000000000000ULL | (bits >> 52)) - 4503599627370496.0) - 1023.0;
+  double mantissa = BitsToDouble((bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+  const bool large = mantissa > 1.4142135623730951;
+  mantissa *= large ? 0.5 : 1.0;
+  exponent += large ? 1.0 : 0.0;
+
+  /* log(mantissa) = 2 atanh(f) with |f| <= 0.1716 */
+  const double f = (mantissa - 1.0) / (mantissa + 1.0);
+  const double f2 = f * f;
+  double series = 1.0 / 21.0;
+  series = series * f2 + 1.0 / 19.0;
+  series = series * f2 + 1.0 / 17.0;
+  series = series * f2 + 1.0 / 15.0;
+  series = series * f2 + 1.0 / 13.0;
+  series = series * f2 + 1.0 / 11.0;
+  series = series * f2 + 1.0 / 9.0;
+  series = series * f2 + 1.0 / 7.0;
+  series = series * f2 + 1.0 / 5.0;
+  series = series * f2 + 1.0 / 3.0;
+  series = series * f2 + 1.0;
+  return 2.0 * f * series + exponent * 0.69314718055994531;
+}
+
+/* exp(value) for value <= 0, flushed to exp(-708) below that */
+inline double ExpLane(double value)
+{
+  value = value < -708.0 ? -708.0 : value;
+  const double shifted = value * 1.4426950408889634 + RoundingShift;
+  const double n = shifted - RoundingShift;
+  /* ln(2) split into a part exact in n * ln(2) and the rest */
+  const double r = (value - n * 6.93147180369123816490e-01) - n * 1.90821492927058770002e-10;
+
+  /* |r| <= ln(2) / 2 */
+  double series = 1.0 / 6227020800.0;
+  series = series * r + 1.0 / 479001600.0;
+  series = series * r + 1.0 / 39916800.0;
+  series = series * r + 1.0 / 3628800.0;
+  series = series * r + 1.0 / 362880.0;
+  series = series * r + 1.0 / 40320.0;
+  series = series * r + 1.0 / 5040.0;
+  series = series * r + 1.0 / 720.0;
+  series = series * r + 1.0 / 120.0;
+  series = series * r + 1.0 / 24.0;
+  series = series * r + 1.0 / 6.0;
+  series = series * r + 0.5;
+  series = series * r + 1.0;
+  series = series * r + 1.0;
+
+  /* the low bits of shifted hold n, 2^n is built from the biased exponent n + 1023 */
+  return series * BitsToDouble((DoubleToBits(shifted) - 0x4338000000000000ULL + 1023) << 52);
+}
+
+/* cos(2 PI turns) and sin(2 PI turns) for 0 <= turns <= 1 */
+inline void SinCosLane(double turns, double& cosine, double& sine)
+{
+  const double quarters = 4.0 * turns;
+  const double shifted = quarters + RoundingShift;
+  const unsigned long long quadrant = DoubleToBits(shifted) & 3;
+  /* |r| <= PI / 4 */
+  const double r = (quarters - (shifted - RoundingShift)) * 1.5707963267948966;
+  const double r2 = r * r;
+
+  double s = -1.0 / 1307674368000.0;
+  s = s * r2 + 1.0 / 6227020800.0;
+  s = s * r2 - 1.0 / 39916800.0;
+  s = s * r2 + 1.0 / 362880.0;
+  s = s * r2 - 1.0 / 5040.0;
+  s = s * r2 + 1.0 / 120.0;
+  s = s * r2 - 1.0 / 6.0;
+  s = (s * r2 + 1.0) * r;
+
+  double c = 1.0 / 20922789888000.0;
+  c = c * r2 - 1.0 / 87178291200.0;
+  c = c * r2 + 1.0 / 479001600.0;
+  c = c * r2 - 1.0 / 3628800.0;
+  c = c * r2 + 1.0 / 40320.0;
+  c = c * r2 - 1.0 / 720.0;
+  c = c * r2 + 1.0 / 24.0;
+  c = c * r2 - 0.5;
+  c = c * r2 + 1.0;
+
+  cosine = quadrant == 0 ? c : quadrant == 1 ? -s : quadrant == 2 ? -c : s;
+  sine = quadrant == 0 ? s : quadrant == 1 ? c : quadrant == 2 ? -s : -c;
+}
+
+/***********************************************************
+ *  Fluence grid shared by all threads of the batched mode,
+ *  instead of one full grid per thread. Deposits are added
+ *  atomically.
+ ****/
+class SharedFluence
+{
+public:
+  SharedFluence(long totalNumberOfVoxels) : m_Fluence(totalNumberOfVoxels)
+  {
+    for (auto& value : m_Fluence)
+      value.store(0);
+  }
+
+  void Add(long voxel, double absorb)
+  {
+    double current = m_Fluence[voxel].load(std::memory_order_relaxed);
+    while (!m_Fluence[voxel].compare_exchange_weak(current, current + absorb, std::memory_order_relaxed));
+  }
+
+  double GetValue(long voxel) const
+  {
+    return m_Fluence[voxel].load();
+  }
+
+private:
+  std::vector<std::atomic<double>> m_Fluence;
+};
+
+/***********************************************************
+ *  Thread local accumulation of deposits in front of the
+ *  shared grid. A photon deposits into the same and the
+ *  neighbouring voxels many times, so these deposits are
+ *  summed in a small direct mapped table and only evicted
+ *  entries are added to the shared grid.
+ ****/
+class LocalFluence
+{
+public:
+  LocalFluence(SharedFluence* fluence) : m_SharedFluence(fluence), m_Voxels(TableSize, -1), m_Values(TableSize, 0)
+  {
+  }
+
+  ~LocalFluence()
+  {
+    for (unsigned int slot = 0; slot < TableSize; ++slot)
+      if (m_Voxels[slot] >= 0)
+        m_SharedFluence->Add(m_Voxels[slot], m_Values[slot]);
+  }
+
+  void Add(long voxel, double absorb)
+  {
+    unsigned int slot = (unsigned int)(((unsigned long long)voxel * 0x9E3779B97F4A7C15ULL) >> (64 - TableBits));
+    if (m_Voxels[slot] == voxel)
+    {
+      m_Values[slot] += absorb;
+      return;
+    }
+    if (m_Voxels[slot] >= 0)
+      m_SharedFluence->Add(m_Voxels[slot], m_Values[slot]);
+    m_Voxels[slot] = voxel;
+    m_Values[slot] = absorb;
+  }
+
+private:
+  static const unsigned int TableBits = 14;
+  static const unsigned int TableSize = 1 << TableBits;
+
+  SharedFluence* m_SharedFluence;
+  std::vector<long> m_Voxels;
+  std::vector<double> m_Values;
+};
+
+/***********************************************************
+ *  Structure of arrays state of a block of photons that are
+ *  propagated side by side in the batched mode. Each lane holds
+ *  one photon. The arrays have a fixed size and are members of
+ *  one object, so the compiler knows that they do not overlap
+ *  and vectorizes the lane loops without run time alias checks.
+ ****/
+struct PhotonLanes
+{
+  static const unsigned int Size = 64;
+
+  double x[Size], y[Size], z[Size];      /* photon position */
+  double ux[Size], uy[Size], uz[Size];   /* photon trajectory as cosines */
+  double W[Size];                        /* photon weight, 0 = lane is free */
+  double sleft[Size];                    /* dimensionless step remaining, 0 = draw a new step */
+  long i[Size];                          /* index of the current voxel */
+  double bflag[Size];                    /* 1 = photon inside volume */
+  unsigned long long key[Size], counter[Size];
+
+  /* optical properties of the current voxels and deposits of the current pass */
+  double mua[Size], mus[Size], g[Size];
+  double absorb[Size];
+  long absorbVoxel[Size];
+
+  PhotonLanes()
+  {
+    for (unsigned int lane = 0; lane < Size; ++lane)
+    {
+      x[lane] = y[lane] = z[lane] = 0;
+      ux[lane] = uy[lane] = 0;
+      uz[lane] = 1;
+      W[lane] = sleft[lane] = 0;
+      i[lane] = 0;
+      bflag[lane] = 0;
+      key[lane] = counter[lane] = 0;
+      mua[lane] = g[lane] = absorb[lane] = 0;
+      mus[lane] = 1;
+      absorbVoxel[lane] = 0;
+    }
+  }
+};
+
 /* DECLARE FUNCTIONS */
 
 void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thread, mitk::pa::MonteCarloThreadHandler::Pointer threadHandler);
+void runMonteCarloBatched(InputValues* inputValues, ReturnValues* returnValue, int thread, mitk::pa::MonteCarloThreadHandler::Pointer threadHandler, SharedFluence* fluence);
 
 int detector_x = -1;
 int detector_z = -1;
@@ -628,6 +892,161 @@ std::string inputFilename;
 std::string outputFilename;
 
 mitk::pa::Probe::Pointer m_PhotoacousticProbe;
+unsigned int batchSize = 0;
+
+/***********************************************************
+ *  LAUNCH
+ *  Initialize photon position and trajectory, drawing random
+ *  numbers from random().
+ ****/
+template <typename TRandom>
+void LaunchPhoton(InputValues* inputValues, TRandom& random, double& x, double& y, double& z, double& ux, double& uy, double& uz)
+{
+  double  rnd;                    /* assigned random value 0-1 */
+  double  r, phi;                 /* dummy values */
+  double  temp;                   /* dummy variable */
+  double  costheta, sintheta;     /* cos(theta), sin(theta) */
+  double  psi, cospsi, sinpsi;    /* azimuthal angle, cos(psi), sin(psi) */
+
+  if (m_PhotoacousticProbe.IsNotNull())
+  {
+    double rnd1 = -1;
+    double rnd2 = -1;
+    double rnd3 = -1;
+    double rnd4 = -1;
+    double rnd5 = -1;
+    double rnd6 = -1;
+    double rnd7 = -1;
+    double rnd8 = -1;
+
+    while ((rnd1 = random()) <= 0.0);
+    while ((rnd2 = random()) <= 0.0);
+    while ((rnd3 = random()) <= 0.0);
+    while ((rnd4 = random()) <= 0.0);
+    while ((rnd5 = random()) <= 0.0);
+    while ((rnd6 = random()) <= 0.0);
+    while ((rnd7 = random()) <= 0.0);
+    while ((rnd8 = random()) <= 0.0);
+
+    mitk::pa::LightSource::PhotonInformation info = m_PhotoacousticProbe->GetNextPhoton(rnd1, rnd2, rnd3, rnd4, rnd5, rnd6, rnd7, rnd8);
+    x = info.xPosition;
+    y = yOffset + info.yPosition;
+    z = info.zPosition;
+    ux = info.xAngle;
+    uy = info.yAngle;
+    uz = info.zAngle;
+    if (verbose)
+      std::cout << "Created photon at position (" << x << "|" << y << "|" << z << ") with angles (" << ux << "|" << uy << "|" << uz << ")." << std::endl;
+  }
+  else
+  {
+    /* trajectory */
+    if (inputValues->launchflag == 1) // manually set launch
+    {
+      x = inputValues->xs;
+      y = inputValues->ys;
+      z = inputValues->zs;
+      ux = inputValues->ux0;
+      uy = inputValues->uy0;
+      uz = inputValues->uz0;
+    }
+    else // use mcflag
+    {
+      if (inputValues->mcflag == 0) // uniform beam
+      {
+        // set launch point and width of beam
+        while ((rnd = random()) <= 0.0); // avoids rnd = 0
+        r = inputValues->radius*sqrt(rnd); // radius of beam at launch point
+        while ((rnd = random()) <= 0.0); // avoids rnd = 0
+        phi = rnd*2.0*PI;
+        x = inputValues->xs + r*cos(phi);
+        y = inputValues->ys + r*sin(phi);
+        z = inputValues->zs;
+        // set trajectory toward focus
+        while ((rnd = random()) <= 0.0); // avoids rnd = 0
+        r = inputValues->waist*sqrt(rnd); // radius of beam at focus
+        while ((rnd = random()) <= 0.0); // avoids rnd = 0
+        phi = rnd*2.0*PI;
+
+        // !!!!!!!!!!!!!!!!!!!!!!! setting input values will braek
+
+        inputValues->xfocus = r*cos(phi);
+        inputValues->yfocus = r*sin(phi);
+        temp = sqrt((x - inputValues->xfocus)*(x - inputValues->xfocus)
+          + (y - inputValues->yfocus)*(y - inputValues->yfocus) + inputValues->zfocus*inputValues->zfocus);
+        ux = -(x - inputValues->xfocus) / temp;
+        uy = -(y - inputValues->yfocus) / temp;
+        uz = sqrt(1 - ux*ux + uy*uy);
+      }
+      else if (inputValues->mcflag == 5) // Multispectral DKFZ prototype
+      {
+        // set launch point and width of beam
+        while ((rnd = random()) <= 0.0);
+
+        //offset in x direction in cm (random)
+        x = (rnd*2.5) - 1.25;
+
+        while ((rnd = random()) <= 0.0);
+        double b = ((rnd)-0.5);
+        y = (b > 0 ? yOffset + 1.5 : yOffset - 1.5);
+        z = 0.1;
+        ux = 0;
+
+        while ((rnd = random()) <= 0.0);
+
+        //Angle of beam in y direction
+        uy = sin((rnd*0.42) - 0.21 + (b < 0 ? 1.0 : -1.0) * 0.436);
+
+        while ((rnd = random()) <= 0.0);
+
+        // angle of beam in x direction
+        ux = sin((rnd*0.42) - 0.21);
+        uz = sqrt(1 - ux*ux - uy*uy);
+      }
+      else if (inputValues->mcflag == 4) // Monospectral prototype DKFZ
+      {
+        // set launch point and width of beam
+        while ((rnd = random()) <= 0.0);
+
+        //offset in x direction in cm (random)
+        x = (rnd*2.5) - 1.25;
+
+        while ((rnd = random()) <= 0.0);
+        double b = ((rnd)-0.5);
+        y = (b > 0 ? yOffset + 0.83 : yOffset - 0.83);
+        z = 0.1;
+        ux = 0;
+
+        while ((rnd = random()) <= 0.0);
+
+        //Angle of beam in y direction
+        uy = sin((rnd*0.42) - 0.21 + (b < 0 ? 1.0 : -1.0) * 0.375);
+
+        while ((rnd = random()) <= 0.0);
+
+        // angle of beam in x direction
+        ux = sin((rnd*0.42) - 0.21);
+        uz = sqrt(1 - ux*ux - uy*uy);
+      }
+      else { // isotropic pt source
+        costheta = 1.0 - 2.0 * random();
+        sintheta = sqrt(1.0 - costheta*costheta);
+        psi = 2.0 * PI * random();
+        cospsi = cos(psi);
+        if (psi < PI)
+          sinpsi = sqrt(1.0 - cospsi*cospsi);
+        else
+          sinpsi = -sqrt(1.0 - cospsi*cospsi);
+        x = inputValues->xs;
+        y = inputValues->ys;
+        z = inputValues->zs;
+        ux = sintheta*cospsi;
+        uy = sintheta*sinpsi;
+        uz = costheta;
+      }
+    } // end  use mcflag
+  }
+}
 
 int main(int argc, char * argv[]) {
   mitkCommandLineParser parser;
@@ -676,6 +1095,9 @@ int main(int argc, char * argv[]) {
   parser.addArgument(
     "probe-xml", "p", mitkCommandLineParser::InputFile,
     "Xml definition of the probe", "Specifies the absolute path of the location of the xml definition file of the probe design.");
+  parser.addArgument(
+    "batch-size", "b", mitkCommandLineParser::Int,
+    "Photons per batch", "Propagates this many photons side by side in each job, rounded up to a multiple of 64, with one fluence grid shared by all jobs (default: 0 = one photon after the other with a fluence grid per job). The batched transport is vectorized when built for AVX2 or newer. Not used for PVFC calculations.");
   parser.addArgument("normalization-file", "nf", mitkCommandLineParser::InputFile,
     "Input normalization file", "The input normalization file is used for normalization of the number of photons in the PVFC calculations.");
   parser.endGroup();
@@ -738,6 +1160,11 @@ int main(int argc, char * argv[]) {
       return EXIT_FAILURE;
     }
   }
+  if (parsedArgs.count("batch-size"))
+  {
+    int requestedBatchSize = us::any_cast<int>(parsedArgs["batch-size"]);
+    batchSize = requestedBatchSize > 0 ? requestedBatchSize : 0;
+  }
   if (parsedArgs.count("normalization-file"))
   {
     normalizationFilename = us::any_cast<std::string>(parsedArgs["normalization-file"]);
@@ -758,6 +1185,11 @@ int main(int argc, char * argv[]) {
     if (verbose)
       std::cout << "Performing PVFC calculation for x=" << detector_x << " and z=" << detector_z << std::endl;
     simulatePVFC = true;
+    if (batchSize > 0)
+    {
+      std::cout << "Batched photon propagation is not available for PVFC calculations. Propagating one photon after the other." << std::endl;
+      batchSize = 0;
+    }
   }
   else
   {
@@ -801,9 +1233,16 @@ int main(int argc, char * argv[]) {
 
   auto simulationStartTime = std::chrono::system_clock::now();
 
+  std::unique_ptr<SharedFluence> sharedFluence;
+  if (batchSize > 0)
+    sharedFluence.reset(new SharedFluence(allInput.totalNumberOfVoxels));
+
   for (int i = 0; i < concurentThreadsSupported; i++)
   {
-    threads[i] = std::thread(runMonteCarlo, &allInput, &allValues[i], (i + 1), threadHandler);
+    if (batchSize > 0)
+      threads[i] = std::thread(runMonteCarloBatched, &allInput, &allValues[i], (i + 1), threadHandler, sharedFluence.get());
+    else
+      threads[i] = std::thread(runMonteCarlo, &allInput, &allValues[i], (i + 1), threadHandler);
   }
 
   for (int i = 0; i < concurentThreadsSupported; i++)
@@ -818,6 +1257,12 @@ int main(int argc, char * argv[]) {
   std::cout << "total time for simulation: "
     << (int)std::chrono::duration_cast<std::chrono::seconds>(simulationTimeElapsed).count() << "sec " << std::endl;
 
+  long long simulatedPhotons = 0;
+  for (int t = 0; t < concurentThreadsSupported; t++)
+    simulatedPhotons += allValues[t].Nphotons;
+  std::cout << "photons per second: "
+    << simulatedPhotons / std::chrono::duration<double>(simulationTimeElapsed).count() << std::endl;
+
   /**** SAVE
    Convert data to relative fluence rate [cm^-2] and save.
    *****/
@@ -842,10 +1287,18 @@ int main(int argc, char * argv[]) {
       tdy = allInput.ySpacing;
       tdz = allInput.zSpacing;
       tNphotons += allValues[t].Nphotons;
+      if (sharedFluence)
+        continue;
       for (int voxelNumber = 0; voxelNumber < allInput.totalNumberOfVoxels; voxelNumber++) {
         finalTotalFluence[voxelNumber] += allValues[t].totalFluence[voxelNumber];
       }
     }
+    if (sharedFluence)
+    {
+      for (int voxelNumber = 0; voxelNumber < allInput.totalNumberOfVoxels; voxelNumber++) {
+        finalTotalFluence[voxelNumber] = sharedFluence->GetValue(voxelNumber);
+      }
+    }
     if (verbose) std::cout << "[OK]" << std::endl;
     std::cout << "total number of photons simulated: "
       << tNphotons << std::endl;
@@ -1012,7 +1465,6 @@ void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thre
 
   /* dummy variables */
   double  rnd;         /* assigned random value 0-1 */
-  double  r, phi;      /* dummy values */
   long    i, j;         /* dummy indices */
   double  tempx, tempy, tempz; /* temporary variables, used during photon step. */
   int     ix, iy, iz;  /* Added. Used to track photons */
@@ -1048,6 +1500,7 @@ void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thre
   /**** RUN Launch N photons, initializing each one before progation. *****/
 
   long photonsToSimulate = 0;
+  auto random = [returnValue]() { return returnValue->RandomGen(1, 0, nullptr); };
 
   do {
     photonsToSimulate = threadHandler->GetNextWorkPackage();
@@ -1071,146 +1524,8 @@ void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thre
 
       /**** SET SOURCE* Launch collimated beam at x,y center.****/
       /****************************/
-      /* Initial position. */
-
-      if (m_PhotoacousticProbe.IsNotNull())
-      {
-        double rnd1 = -1;
-        double rnd2 = -1;
-        double rnd3 = -1;
-        double rnd4 = -1;
-        double rnd5 = -1;
-        double rnd6 = -1;
-        double rnd7 = -1;
-        double rnd8 = -1;
-
-        while ((rnd1 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-        while ((rnd2 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-        while ((rnd3 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-        while ((rnd4 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-        while ((rnd5 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-        while ((rnd6 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-        while ((rnd7 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-        while ((rnd8 = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-
-        mitk::pa::LightSource::PhotonInformation info = m_PhotoacousticProbe->GetNextPhoton(rnd1, rnd2, rnd3, rnd4, rnd5, rnd6, rnd7, rnd8);
-        x = info.xPosition;
-        y = yOffset + info.yPosition;
-        z = info.zPosition;
-        ux = info.xAngle;
-        uy = info.yAngle;
-        uz = info.zAngle;
-        if (verbose)
-          std::cout << "Created photon at position (" << x << "|" << y << "|" << z << ") with angles (" << ux << "|" << uy << "|" << uz << ")." << std::endl;
-      }
-      else
-      {
-        /* trajectory */
-        if (inputValues->launchflag == 1) // manually set launch
-        {
-          x = inputValues->xs;
-          y = inputValues->ys;
-          z = inputValues->zs;
-          ux = inputValues->ux0;
-          uy = inputValues->uy0;
-          uz = inputValues->uz0;
-        }
-        else // use mcflag
-        {
-          if (inputValues->mcflag == 0) // uniform beam
-          {
-            // set launch point and width of beam
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0); // avoids rnd = 0
-            r = inputValues->radius*sqrt(rnd); // radius of beam at launch point
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0); // avoids rnd = 0
-            phi = rnd*2.0*PI;
-            x = inputValues->xs + r*cos(phi);
-            y = inputValues->ys + r*sin(phi);
-            z = inputValues->zs;
-            // set trajectory toward focus
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0); // avoids rnd = 0
-            r = inputValues->waist*sqrt(rnd); // radius of beam at focus
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0); // avoids rnd = 0
-            phi = rnd*2.0*PI;
-
-            // !!!!!!!!!!!!!!!!!!!!!!! setting input values will braek
-
-            inputValues->xfocus = r*cos(phi);
-            inputValues->yfocus = r*sin(phi);
-            temp = sqrt((x - inputValues->xfocus)*(x - inputValues->xfocus)
-              + (y - inputValues->yfocus)*(y - inputValues->yfocus) + inputValues->zfocus*inputValues->zfocus);
-            ux = -(x - inputValues->xfocus) / temp;
-            uy = -(y - inputValues->yfocus) / temp;
-            uz = sqrt(1 - ux*ux + uy*uy);
-          }
-          else if (inputValues->mcflag == 5) // Multispectral DKFZ prototype
-          {
-            // set launch point and width of beam
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-
-            //offset in x direction in cm (random)
-            x = (rnd*2.5) - 1.25;
-
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-            double b = ((rnd)-0.5);
-            y = (b > 0 ? yOffset + 1.5 : yOffset - 1.5);
-            z = 0.1;
-            ux = 0;
-
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-
-            //Angle of beam in y direction
-            uy = sin((rnd*0.42) - 0.21 + (b < 0 ? 1.0 : -1.0) * 0.436);
-
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-
-            // angle of beam in x direction
-            ux = sin((rnd*0.42) - 0.21);
-            uz = sqrt(1 - ux*ux - uy*uy);
-          }
-          else if (inputValues->mcflag == 4) // Monospectral prototype DKFZ
-          {
-            // set launch point and width of beam
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-
-            //offset in x direction in cm (random)
-            x = (rnd*2.5) - 1.25;
-
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-            double b = ((rnd)-0.5);
-            y = (b > 0 ? yOffset + 0.83 : yOffset - 0.83);
-            z = 0.1;
-            ux = 0;
-
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-
-            //Angle of beam in y direction
-            uy = sin((rnd*0.42) - 0.21 + (b < 0 ? 1.0 : -1.0) * 0.375);
-
-            while ((rnd = returnValue->RandomGen(1, 0, nullptr)) <= 0.0);
-
-            // angle of beam in x direction
-            ux = sin((rnd*0.42) - 0.21);
-            uz = sqrt(1 - ux*ux - uy*uy);
-          }
-          else { // isotropic pt source
-            costheta = 1.0 - 2.0 * returnValue->RandomGen(1, 0, nullptr);
-            sintheta = sqrt(1.0 - costheta*costheta);
-            psi = 2.0 * PI * returnValue->RandomGen(1, 0, nullptr);
-            cospsi = cos(psi);
-            if (psi < PI)
-              sinpsi = sqrt(1.0 - cospsi*cospsi);
-            else
-              sinpsi = -sqrt(1.0 - cospsi*cospsi);
-            x = inputValues->xs;
-            y = inputValues->ys;
-            z = inputValues->zs;
-            ux = sintheta*cospsi;
-            uy = sintheta*sinpsi;
-            uz = costheta;
-          }
-        } // end  use mcflag
-      }
+      /* Initial position and trajectory. */
+      LaunchPhoton(inputValues, random, x, y, z, ux, uy, uz);
       /****************************/
 
       /* Get tissue voxel properties of launchpoint.
@@ -1470,3 +1785,212 @@ void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thre
   if (verbose) std::cout << "------------------------------------------------------" << std::endl;
   if (verbose) std::cout << "Thread " << thread << " is finished." << std::endl;
 }
+
+/* BATCHED CORE FUNCTION
+ * Propagates batchSize photons side by side, in blocks of PhotonLanes::Size.
+ * Every pass of the major cycle advances each lane by one voxel step, i.e. up
+ * to the next voxel face or to the end of the current hop, followed by SPIN
+ * and ROULETTE for the lanes that completed their hop. Apart from the launch,
+ * the lookup of the optical properties and the fluence deposits, every stage
+ * is a loop over the lanes of a block without branches or library calls, so
+ * that the compiler vectorizes it. Lanes of terminated photons are refilled
+ * from the work packages of the thread handler, and all threads deposit into
+ * one shared fluence grid. */
+void runMonteCarloBatched(InputValues* inputValues, ReturnValues* returnValue, int thread, mitk::pa::MonteCarloThreadHandler::Pointer threadHandler, SharedFluence* fluence)
+{
+  const unsigned int Lanes = PhotonLanes::Size;
+  std::vector<PhotonLanes> blocks((batchSize + Lanes - 1) / Lanes);
+  LocalFluence localFluence(fluence);
+
+  const int Nx = inputValues->Nx;
+  const int Ny = inputValues->Ny;
+  const int Nz = inputValues->Nz;
+  const double dx = inputValues->xSpacing;
+  const double dy = inputValues->ySpacing;
+  const double dz = inputValues->zSpacing;
+  const double* muaVector = inputValues->muaVector;
+  const double* musVector = inputValues->musVector;
+  const double* gVector = inputValues->gVector;
+  const int boundaryflag = inputValues->boundaryflag;
+
+  auto duration = std::chrono::system_clock::now().time_since_epoch();
+  const unsigned long long seed = MixBits(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() + thread);
+  unsigned long long launchedPhotons = 0;
+
+  long photonsToSimulate = 0;
+  long photonIterator = 0;
+  bool workRemaining = true;
+
+  if (verbose) std::cout << "Thread " << thread << " propagates " << blocks.size() * Lanes << " photons per batch." << std::endl;
+
+  /**** ======================== MAJOR CYCLE ============================ *****/
+  while (true)
+  {
+    unsigned int aliveLanes = 0;
+
+    for (auto& p : blocks)
+    {
+      /**** LAUNCH new photons into the lanes of terminated ones *****/
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+      {
+        if (p.W[lane] == 0 && workRemaining)
+        {
+          if (photonIterator == photonsToSimulate)
+          {
+            photonsToSimulate = threadHandler->GetNextWorkPackage();
+            photonIterator = 0;
+            if (photonsToSimulate <= 0)
+            {
+              workRemaining = false;
+              continue;
+            }
+            returnValue->Nphotons += photonsToSimulate;
+          }
+          ++photonIterator;
+
+          p.key[lane] = MixBits(seed + ++launchedPhotons * 0x9E3779B97F4A7C15ULL);
+          p.counter[lane] = 0;
+          auto random = [&p, lane]() { return CounterBasedRandom(p.key[lane], p.counter[lane]++); };
+          LaunchPhoton(inputValues, random, p.x[lane], p.y[lane], p.z[lane], p.ux[lane], p.uy[lane], p.uz[lane]);
+
+          int ix = (int)(Nx / 2 + p.x[lane] / dx);
+          int iy = (int)(Ny / 2 + p.y[lane] / dy);
+          int iz = (int)(p.z[lane] / dz);
+          ix = std::max(0, std::min(ix, Nx - 1));
+          iy = std::max(0, std::min(iy, Ny - 1));
+          iz = std::max(0, std::min(iz, Nz - 1));
+          p.i[lane] = (long)(iz*Ny*Nx + ix*Ny + iy);
+          p.W[lane] = 1.0;
+          p.sleft[lane] = 0;
+          p.bflag[lane] = 1;
+        }
+        aliveLanes += p.W[lane] > 0;
+      }
+
+      /* optical properties of the current voxels */
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+      {
+        p.mua[lane] = muaVector[p.i[lane]];
+        p.mus[lane] = musVector[p.i[lane]];
+      }
+
+      /**** HOP
+       Draw a new dimensionless step for the lanes that completed their hop.
+       *****/
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+      {
+        const bool newHop = p.sleft[lane] == 0;
+        const double hop = -LogLane(CounterBasedRandom(p.key[lane], p.counter[lane]));
+        p.sleft[lane] = newHop ? hop : p.sleft[lane];
+        p.counter[lane] += newHop ? 1 : 0;
+      }
+
+      /**** HOP_DROP
+       Step to the end of the hop if it stays in the current voxel, otherwise
+       to the voxel face + "littlest step", and drop photon weight there.
+       *****/
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+      {
+        const double s = p.sleft[lane] / p.mus[lane];
+
+        /* distance to the nearest face of the current voxel, as in FindVoxelFace2 */
+        const double cellX = FloorLane(p.x[lane] / dx);
+        const double cellY = FloorLane(p.y[lane] / dy);
+        const double cellZ = FloorLane(p.z[lane] / dz);
+        const double sx = fabs(((cellX + (p.ux[lane] >= 0 ? 1.0 : 0.0)) * dx - p.x[lane]) / p.ux[lane]);
+        const double sy = fabs(((cellY + (p.uy[lane] >= 0 ? 1.0 : 0.0)) * dy - p.y[lane]) / p.uy[lane]);
+        const double sz = fabs(((cellZ + (p.uz[lane] >= 0 ? 1.0 : 0.0)) * dz - p.z[lane]) / p.uz[lane]);
+        const double sface = std::min(sx, std::min(sy, sz));
+
+        const bool crossed = s > sface;
+        const double step = p.W[lane] > 0 ? (crossed ? sface + ls : s) : 0.0;
+
+        /**** DROP
+         Drop photon weight (W) into local bin.
+         *****/
+        const double dropped = p.W[lane] * (1 - ExpLane(-p.mua[lane] * step));
+        p.W[lane] -= dropped;
+        p.absorb[lane] = p.bflag[lane] * dropped;
+        p.absorbVoxel[lane] = p.i[lane];
+
+        double remaining = crossed ? p.sleft[lane] - step*p.mus[lane] : 0.0;
+        remaining = remaining <= ls ? 0.0 : remaining;
+
+        p.x[lane] += step*p.ux[lane];
+        p.y[lane] += step*p.uy[lane];
+        p.z[lane] += step*p.uz[lane];
+
+        int ix = (int)(Nx / 2 + p.x[lane] / dx);
+        int iy = (int)(Ny / 2 + p.y[lane] / dy);
+        int iz = (int)(p.z[lane] / dz);
+
+        /* boundaryflag 0: let photon wander outside, but do not deposit
+         * boundaryflag 1: escape at boundaries
+         * boundaryflag 2: escape at top surface only */
+        const bool outside = iz >= Nz || ix >= Nx || iy >= Ny || iz < 0 || ix < 0 || iy < 0;
+        const bool escaped = outside && (boundaryflag == 1 || (boundaryflag == 2 && iz < 0));
+        p.W[lane] = escaped ? 0.0 : p.W[lane];
+        p.bflag[lane] = outside ? 0.0 : 1.0;
+        p.sleft[lane] = escaped ? 0.0 : remaining;
+
+        ix = ix < 0 ? 0 : (ix >= Nx ? Nx - 1 : ix);
+        iy = iy < 0 ? 0 : (iy >= Ny ? Ny - 1 : iy);
+        iz = iz < 0 ? 0 : (iz >= Nz ? Nz - 1 : iz);
+        p.i[lane] = (long)(iz*Ny*Nx + ix*Ny + iy);
+      }
+
+      /* deposits scatter into the grid and stay scalar */
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+      {
+        if (p.absorb[lane] > 0)
+          localFluence.Add(p.absorbVoxel[lane], p.absorb[lane]);
+        p.g[lane] = gVector[p.i[lane]];
+      }
+
+      /**** SPIN_CHECK
+       Scatter the photons that completed their hop into a new trajectory
+       (Henyey-Greenstein) and apply the roulette.
+       *****/
+      for (unsigned int lane = 0; lane < Lanes; ++lane)
+      {
+        const bool spin = (p.W[lane] > 0) & (p.sleft[lane] == 0);
+        const double rndTheta = CounterBasedRandom(p.key[lane], p.counter[lane]);
+        const double rndPsi = CounterBasedRandom(p.key[lane], p.counter[lane] + 1);
+        const double rndRoulette = CounterBasedRandom(p.key[lane], p.counter[lane] + 2);
+        p.counter[lane] += spin ? 3 : 0;
+
+        const double g = p.g[lane] == 0.0 ? 1.0 : p.g[lane];
+        const double temp = (1.0 - g * g) / (1.0 - g + 2 * g * rndTheta);
+        const double costheta = p.g[lane] == 0.0 ? 2.0 * rndTheta - 1.0 : (1.0 + g * g - temp*temp) / (2.0*g);
+        const double sintheta = sqrt(1.0 - costheta*costheta);
+
+        double cospsi, sinpsi;
+        SinCosLane(rndPsi, cospsi, sinpsi);
+
+        const double ux = p.ux[lane];
+        const double uy = p.uy[lane];
+        const double uz = p.uz[lane];
+        const bool perpendicular = 1 - fabs(uz) <= ONE_MINUS_COSZERO;
+        const double norm = perpendicular ? 1.0 : sqrt(1.0 - uz * uz);
+        const double uxx = perpendicular ? sintheta * cospsi : sintheta * (ux * uz * cospsi - uy * sinpsi) / norm + ux * costheta;
+        const double uyy = perpendicular ? sintheta * sinpsi : sintheta * (uy * uz * cospsi + ux * sinpsi) / norm + uy * costheta;
+        const double uzz = perpendicular ? costheta * SIGN(uz) : -sintheta * cospsi * norm + uz * costheta;
+
+        p.ux[lane] = spin ? uxx : ux;
+        p.uy[lane] = spin ? uyy : uy;
+        p.uz[lane] = spin ? uzz : uz;
+
+        /**** CHECK ROULETTE *****/
+        const bool roulette = spin & (p.W[lane] < THRESHOLD);
+        const bool survives = rndRoulette <= CHANCE;
+        p.W[lane] = roulette ? (survives ? p.W[lane] / CHANCE : 0.0) : p.W[lane];
+      }
+    }
+
+    if (aliveLanes == 0)
+      break;
+  }
+
+  if (verbose) std::cout << "------------------------------------------------------" << std::endl;
+  if (verbose) std::cout << "Thread " << thread << " is finished." << std::endl;
+}
@@ -34,7 +34,8 @@ mitk::DiffSliceOperation::DiffSliceOperation(mitk::Image *imageVolume,
                                              Image *slice,
                                              SlicedGeometry3D *sliceGeometry,
                                              unsigned int timestep,
-                                             BaseGeometry *currentWorldGeometry)
+                                             BaseGeometry *currentWorldGeometry,
+                                             const DiffSliceOperation *reference)
   : Operation(1)
 
 {
@@ -52,7 +53,7 @@ mitk::DiffSliceOperation::DiffSliceOperation(mitk::Image *imageVolume,
   m_TimeStep = timestep;
 
   m_zlibSliceContainer = CompressedImageContainer::New();
-  m_zlibSliceContainer->SetImage(slice);
+  m_zlibSliceContainer->SetImage(slice, reference ? reference->m_zlibSliceContainer.GetPointer() : nullptr);
 
   m_Image = imageVolume;
 
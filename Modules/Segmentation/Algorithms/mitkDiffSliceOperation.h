@@ -54,12 +54,16 @@ namespace mitk
     */
     DiffSliceOperation();
 
-    /** \brief */
+    /** \brief
+      \param reference Operation for another state of the same slice (e.g. the undo operation of an edit), unchanged
+      parts of the compressed slice are shared with it (optional).
+    */
     DiffSliceOperation(mitk::Image *imageVolume,
                        mitk::Image *slice,
                        SlicedGeometry3D *sliceGeometry,
                        unsigned int timestep,
-                       BaseGeometry *currentWorldGeometry);
+                       BaseGeometry *currentWorldGeometry,
+                       const DiffSliceOperation *reference = nullptr);
 
     /** \brief Check if it is a valid operation.*/
     bool IsValid();
@@ -31,6 +31,8 @@ mitk::ImageLiveWireContourModelFilter::ImageLiveWireContourModelFilter()
   m_CostFunction = CostFunctionType::New();
   m_ShortestPathFilter = ShortestPathImageFilterType::New();
   m_ShortestPathFilter->SetCostFunction(m_CostFunction);
+  // only the end point follows the mouse, all updates with the same start point share one shortest path tree
+  m_ShortestPathFilter->SetKeepShortestPathTree(true);
   m_UseDynamicCostMap = false;
   m_TimeStep = 0;
 }
@@ -177,27 +179,12 @@ void mitk::ImageLiveWireContourModelFilter::UpdateLiveWire()
   endPoint[0] = m_EndPointInIndex[0];
   endPoint[1] = m_EndPointInIndex[1];
 
-  // minimum value in each direction for startRegion
-  InternalImageType::IndexType startRegion;
-  startRegion[0] = startPoint[0] < endPoint[0] ? startPoint[0] : endPoint[0];
-  startRegion[1] = startPoint[1] < endPoint[1] ? startPoint[1] : endPoint[1];
-
-  // maximum value in each direction for size
-  InternalImageType::SizeType size;
-  size[0] = std::abs(startPoint[0] - endPoint[0]) + 1;
-  size[1] = std::abs(startPoint[1] - endPoint[1]) + 1;
-
-  CostFunctionType::RegionType region;
-  region.SetSize(size);
-  region.SetIndex(startRegion);
-
-  // inputImage->SetRequestedRegion(region);
-
   // extracts features from image and calculates costs
   // m_CostFunction->SetImage(m_InternalImage);
+  // (no requested region is set, the costs are computed once for the whole slice and a modified cost function would
+  // discard the shortest path tree of the start point)
   m_CostFunction->SetStartIndex(startPoint);
   m_CostFunction->SetEndIndex(endPoint);
-  m_CostFunction->SetRequestedRegion(region);
   m_CostFunction->SetUseCostMap(m_UseDynamicCostMap);
 
   // calculate shortest path between start and end point
@@ -136,7 +136,8 @@ void mitk::OverwriteSliceImageFilter::GenerateData()
                                               m_SliceDifferenceImage,
                                               m_TimeStep,
                                               m_SliceDimension,
-                                              m_SliceIndex);
+                                              m_SliceIndex,
+                                              doOp);
     undoOp->SetFactor(-1.0);
     OperationEvent *undoStackItem =
       new OperationEvent(DiffImageApplier::GetInstanceForUndo(),
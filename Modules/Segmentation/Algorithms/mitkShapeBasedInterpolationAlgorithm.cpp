@@ -35,12 +35,29 @@ mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::Interpolate(
   unsigned int /*timeStep*/,
   Image::ConstPointer /*referenceImage*/)
 {
-  mitk::Image::Pointer lowerDistanceImage = mitk::Image::New();
-  AccessFixedDimensionByItk_1(lowerSlice, ComputeDistanceMap, 2, lowerDistanceImage);
+  return this->InterpolateFromDistanceMaps(this->CreateDistanceMap(lowerSlice),
+                                           lowerSliceIndex,
+                                           this->CreateDistanceMap(upperSlice),
+                                           upperSliceIndex,
+                                           requestedIndex,
+                                           resultImage);
+}
 
-  mitk::Image::Pointer upperDistanceImage = mitk::Image::New();
-  AccessFixedDimensionByItk_1(upperSlice, ComputeDistanceMap, 2, upperDistanceImage);
+mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::CreateDistanceMap(Image::ConstPointer binarySlice)
+{
+  mitk::Image::Pointer distanceImage = mitk::Image::New();
+  AccessFixedDimensionByItk_1(binarySlice, ComputeDistanceMap, 2, distanceImage);
+  return distanceImage;
+}
 
+mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::InterpolateFromDistanceMaps(
+  Image::Pointer lowerDistanceImage,
+  unsigned int lowerSliceIndex,
+  Image::Pointer upperDistanceImage,
+  unsigned int upperSliceIndex,
+  unsigned int requestedIndex,
+  Image::Pointer resultImage)
+{
   // calculate where the current slice is in comparison to the lower and upper neighboring slices
   float ratio = (float)(requestedIndex - lowerSliceIndex) / (float)(upperSliceIndex - lowerSliceIndex);
   AccessFixedDimensionByItk_3(
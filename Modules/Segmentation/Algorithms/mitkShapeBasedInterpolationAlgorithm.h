@@ -50,6 +50,26 @@ namespace mitk
                                  unsigned int timeStep,
                                  Image::ConstPointer referenceImage) override;
 
+    /**
+     * \brief Signed distance map of a binary slice (negative inside the segmentation).
+     *
+     * The distance map only depends on the slice itself, so it can be reused for all slices
+     * that are interpolated from this slice (see InterpolateFromDistanceMaps()).
+     */
+    Image::Pointer CreateDistanceMap(Image::ConstPointer binarySlice);
+
+    /**
+     * \brief Interpolates a slice from the distance maps of its two neighboring segmented slices.
+     *
+     * Yields the same result as Interpolate() for the slices the distance maps were created from.
+     */
+    Image::Pointer InterpolateFromDistanceMaps(Image::Pointer lowerDistanceImage,
+                                               unsigned int lowerSliceIndex,
+                                               Image::Pointer upperDistanceImage,
+                                               unsigned int upperSliceIndex,
+                                               unsigned int requestedIndex,
+                                               Image::Pointer resultImage);
+
   private:
     typedef itk::Image<mitk::ScalarType, 2> DistanceFilterImageType;
 
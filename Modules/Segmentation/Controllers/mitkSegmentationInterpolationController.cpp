@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageTimeSelector.h"
 #include <mitkExtractSliceFilter.h>
 #include <mitkImageAccessByItk.h>
+#include <mitkParallelFor.h>
 //#include <mitkPlaneGeometry.h>
 
 #include "mitkShapeBasedInterpolationAlgorithm.h"
@@ -29,6 +30,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImage.h>
 #include <itkImageSliceConstIteratorWithIndex.h>
 
+#include <algorithm>
+
 mitk::SegmentationInterpolationController::InterpolatorMapType
   mitk::SegmentationInterpolationController::s_InterpolatorForImage; // static member initialization
 
@@ -46,7 +49,8 @@ mitk::SegmentationInterpolationController *mitk::SegmentationInterpolationContro
   }
 }
 
-mitk::SegmentationInterpolationController::SegmentationInterpolationController() : m_BlockModified(false)
+mitk::SegmentationInterpolationController::SegmentationInterpolationController()
+  : m_BlockModified(false), m_NumberOfSliceChanges(0), m_CacheGeneration(0), m_AbortPrecomputation(false)
 {
 }
 
@@ -68,6 +72,8 @@ mitk::SegmentationInterpolationController *mitk::SegmentationInterpolationContro
 
 mitk::SegmentationInterpolationController::~SegmentationInterpolationController()
 {
+  this->StopPrecomputation();
+
   // remove this from the list of interpolators
   for (auto iter = s_InterpolatorForImage.begin(); iter != s_InterpolatorForImage.end(); ++iter)
   {
@@ -96,6 +102,9 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
 {
   // clear old information (remove all time steps
   m_SegmentationCountInSlice.clear();
+  m_SliceVersions.clear();
+  this->StopPrecomputation();
+  this->ResetCache();
 
   // delete this from the list of interpolators
   auto iter = s_InterpolatorForImage.find(segmentation);
@@ -123,14 +132,17 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
   m_Segmentation = segmentation;
 
   m_SegmentationCountInSlice.resize(m_Segmentation->GetTimeSteps());
+  m_SliceVersions.resize(m_Segmentation->GetTimeSteps());
   for (unsigned int timeStep = 0; timeStep < m_Segmentation->GetTimeSteps(); ++timeStep)
   {
     m_SegmentationCountInSlice[timeStep].resize(3);
+    m_SliceVersions[timeStep].resize(3);
     for (unsigned int dim = 0; dim < 3; ++dim)
     {
       m_SegmentationCountInSlice[timeStep][dim].clear();
       m_SegmentationCountInSlice[timeStep][dim].resize(m_Segmentation->GetDimension(dim));
       m_SegmentationCountInSlice[timeStep][dim].assign(m_Segmentation->GetDimension(dim), 0);
+      m_SliceVersions[timeStep][dim].assign(m_Segmentation->GetDimension(dim), 0);
     }
   }
 
@@ -193,6 +205,9 @@ void mitk::SegmentationInterpolationController::SetChangedVolume(const Image *sl
 
   AccessFixedDimensionByItk_1(sliceDiff, ScanChangedVolume, 3, timeStep);
 
+  // any slice may have changed
+  this->ResetCache();
+
   // PrintStatus();
   Modified();
 }
@@ -267,6 +282,10 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
   unsigned int dim0max = m_SegmentationCountInSlice[timeStep][dim0].size();
   unsigned int dim1max = m_SegmentationCountInSlice[timeStep][dim1].size();
 
+  // rows and columns of the slice that contain changed pixels, i.e. slices of the other two dimensions that changed
+  std::vector<bool> changed0(dim0max, false);
+  std::vector<bool> changed1(dim1max, false);
+
   // scan the slice from two directions
   // and set the flags for the two dimensions of the slice
   for (unsigned int v = 0; v < dim1max; ++v)
@@ -284,6 +303,12 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
       m_SegmentationCountInSlice[timeStep][dim1][v] =
         static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][dim1][v] + value);
       numberOfPixels += static_cast<int>(value);
+
+      if (value != 0)
+      {
+        changed0[u] = true;
+        changed1[v] = true;
+      }
     }
   }
 
@@ -291,6 +316,22 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
   assert((signed)m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] + numberOfPixels >= 0);
   m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] += numberOfPixels;
 
+  // invalidate the cached slices that changed
+  if (std::find(changed1.begin(), changed1.end(), true) != changed1.end())
+  {
+    this->IncreaseSliceVersion(timeStep, sliceDimension, sliceIndex);
+    for (unsigned int u = 0; u < dim0max; ++u)
+    {
+      if (changed0[u])
+        this->IncreaseSliceVersion(timeStep, dim0, u);
+    }
+    for (unsigned int v = 0; v < dim1max; ++v)
+    {
+      if (changed1[v])
+        this->IncreaseSliceVersion(timeStep, dim1, v);
+    }
+  }
+
   // MITK_INFO << "scan t=" << timeStep << " from (0,0) to (" << dim0max << "," << dim1max << ") (" << pixelData << "-"
   // << pixelData+dim0max*dim1max-1 <<  ") in slice " << sliceIndex << " found " << numberOfPixels << " pixels" <<
   // std::endl;
@@ -495,70 +536,67 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   // MITK_INFO << "Interpolate in timestep " << timeStep << ", dimension " << sliceDimension << ": estimate slice " <<
   // sliceIndex << " from slices " << lowerBound << " and " << upperBound << std::endl;
 
+  this->PrepareCache(sliceDimension, currentPlane, timeStep);
+
+  const unsigned long lowerVersion = m_SliceVersions[timeStep][sliceDimension][lowerBound];
+  const unsigned long upperVersion = m_SliceVersions[timeStep][sliceDimension][upperBound];
+
+  mitk::Image::Pointer cachedResult;
+  mitk::Image::Pointer lowerDistanceImage;
+  mitk::Image::Pointer upperDistanceImage;
+  unsigned long generation(0);
+  {
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+    generation = m_CacheGeneration;
+
+    auto interpolation = m_Cache.Interpolations.find(sliceIndex);
+    if (interpolation != m_Cache.Interpolations.end() && interpolation->second.LowerBound == lowerBound &&
+        interpolation->second.UpperBound == upperBound && interpolation->second.LowerVersion == lowerVersion &&
+        interpolation->second.UpperVersion == upperVersion)
+    {
+      cachedResult = interpolation->second.Result;
+    }
+
+    auto lowerDistanceMap = m_Cache.DistanceMaps.find(lowerBound);
+    if (lowerDistanceMap != m_Cache.DistanceMaps.end() && lowerDistanceMap->second.Version == lowerVersion)
+      lowerDistanceImage = lowerDistanceMap->second.DistanceMap;
+
+    auto upperDistanceMap = m_Cache.DistanceMaps.find(upperBound);
+    if (upperDistanceMap != m_Cache.DistanceMaps.end() && upperDistanceMap->second.Version == upperVersion)
+      upperDistanceImage = upperDistanceMap->second.DistanceMap;
+  }
+
+  if (cachedResult.IsNotNull())
+  {
+    this->PrecomputeInterpolations(sliceDimension, currentPlane, timeStep, false);
+    return cachedResult;
+  }
+
   mitk::Image::Pointer lowerMITKSlice;
   mitk::Image::Pointer upperMITKSlice;
   mitk::Image::Pointer resultImage;
 
   try
   {
-    // Setting up the ExtractSliceFilter
-    mitk::ExtractSliceFilter::Pointer extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
-    extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
-    extractor->SetVtkOutputRequest(false);
-
     // Reslicing the current plane
-    extractor->SetWorldGeometry(currentPlane);
-    extractor->Modified();
-    extractor->Update();
-    resultImage = extractor->GetOutput();
-    resultImage->DisconnectPipeline();
-
-    // Creating PlaneGeometry for lower slice
-    mitk::PlaneGeometry::Pointer reslicePlane = currentPlane->Clone();
-
-    // Transforming the current origin so that it matches the lower slice
-    mitk::Point3D origin = currentPlane->GetOrigin();
-    m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
-    origin[sliceDimension] = lowerBound;
-    m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
-    reslicePlane->SetOrigin(origin);
-
-    // Extract the lower slice
-    extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
-    extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
-    extractor->SetVtkOutputRequest(false);
-
-    extractor->SetWorldGeometry(reslicePlane);
-    extractor->Modified();
-    extractor->Update();
-    lowerMITKSlice = extractor->GetOutput();
-    lowerMITKSlice->DisconnectPipeline();
-
-    // Transforming the current origin so that it matches the upper slice
-    m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
-    origin[sliceDimension] = upperBound;
-    m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
-    reslicePlane->SetOrigin(origin);
-
-    // Extract the upper slice
-    extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
-    extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
-    extractor->SetVtkOutputRequest(false);
-
-    extractor->SetWorldGeometry(reslicePlane);
-    extractor->Modified();
-    extractor->Update();
-    upperMITKSlice = extractor->GetOutput();
-    upperMITKSlice->DisconnectPipeline();
-
-    if (lowerMITKSlice.IsNull() || upperMITKSlice.IsNull())
-      return nullptr;
+    resultImage = this->ExtractSlice(currentPlane, timeStep);
+
+    // Extract the lower and upper slice, unless their distance maps are cached
+    if (lowerDistanceImage.IsNull())
+    {
+      lowerMITKSlice =
+        this->ExtractSlice(this->GetSlicePlane(currentPlane, sliceDimension, lowerBound, timeStep), timeStep);
+      if (lowerMITKSlice.IsNull())
+        return nullptr;
+    }
+
+    if (upperDistanceImage.IsNull())
+    {
+      upperMITKSlice =
+        this->ExtractSlice(this->GetSlicePlane(currentPlane, sliceDimension, upperBound, timeStep), timeStep);
+      if (upperMITKSlice.IsNull())
+        return nullptr;
+    }
   }
   catch (const std::exception &e)
   {
@@ -574,16 +612,341 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   //
   // interpolation algorithm can use e.g. itk::ImageSliceConstIteratorWithIndex to
   //   inspect the original patient image at appropriate positions
+  //
+  // the shape based algorithm does not use the original image, so the distance maps of the bounding slices
+  // can be cached and reused for all slices of a gap
+
+  mitk::ShapeBasedInterpolationAlgorithm::Pointer algorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+  if (lowerDistanceImage.IsNull())
+    lowerDistanceImage = algorithm->CreateDistanceMap(lowerMITKSlice.GetPointer());
+  if (upperDistanceImage.IsNull())
+    upperDistanceImage = algorithm->CreateDistanceMap(upperMITKSlice.GetPointer());
+
+  resultImage = algorithm->InterpolateFromDistanceMaps(
+    lowerDistanceImage, lowerBound, upperDistanceImage, upperBound, sliceIndex, resultImage);
+
+  {
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+    if (generation == m_CacheGeneration)
+    {
+      CachedDistanceMap lowerDistanceMap = {lowerVersion, lowerDistanceImage};
+      m_Cache.DistanceMaps[lowerBound] = lowerDistanceMap;
+      CachedDistanceMap upperDistanceMap = {upperVersion, upperDistanceImage};
+      m_Cache.DistanceMaps[upperBound] = upperDistanceMap;
+
+      CachedInterpolation interpolation = {lowerBound, upperBound, lowerVersion, upperVersion, resultImage};
+      m_Cache.Interpolations[sliceIndex] = interpolation;
+
+      if (m_Cache.TemplateSlice.IsNull() && lowerMITKSlice.IsNotNull())
+      {
+        m_Cache.TemplateSlice = lowerMITKSlice;
+        m_Cache.TemplateSliceIndex = lowerBound;
+      }
+    }
+  }
+
+  this->PrecomputeInterpolations(sliceDimension, currentPlane, timeStep, false);
+
+  return resultImage;
+}
+
+void mitk::SegmentationInterpolationController::PrecomputeInterpolations(unsigned int sliceDimension,
+                                                                         const mitk::PlaneGeometry *currentPlane,
+                                                                         unsigned int timeStep,
+                                                                         bool wait)
+{
+  if (m_Segmentation.IsNull() || !currentPlane || timeStep >= m_SegmentationCountInSlice.size() || sliceDimension > 2)
+    return;
+
+  this->PrepareCache(sliceDimension, currentPlane, timeStep);
+
+  std::vector<unsigned long> stamp;
+  {
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+    stamp.push_back(m_CacheGeneration);
+  }
+  stamp.push_back(m_NumberOfSliceChanges);
+
+  // a background precomputation for the current state is already running (or done)
+  if (!wait && stamp == m_PrecomputationStamp)
+    return;
+
+  this->StopPrecomputation();
+  m_PrecomputationStamp = stamp;
+
+  PrecomputationTask task;
+  try
+  {
+    if (!this->CreatePrecomputationTask(currentPlane, task))
+      return;
+  }
+  catch (const std::exception &e)
+  {
+    MITK_ERROR << "Error in 2D interpolation: " << e.what();
+    return;
+  }
+
+  if (wait)
+  {
+    this->RunPrecomputation(task, 0);
+  }
+  else
+  {
+    m_PrecomputationThread = std::thread([this, task]() { this->RunPrecomputation(task, 1); });
+  }
+}
+
+mitk::PlaneGeometry::Pointer mitk::SegmentationInterpolationController::GetSlicePlane(const PlaneGeometry *plane,
+                                                                                      unsigned int sliceDimension,
+                                                                                      unsigned int sliceIndex,
+                                                                                      unsigned int timeStep)
+{
+  mitk::PlaneGeometry::Pointer reslicePlane = plane->Clone();
+
+  // Transforming the current origin so that it matches the requested slice
+  mitk::Point3D origin = plane->GetOrigin();
+  m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
+  origin[sliceDimension] = sliceIndex;
+  m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
+  reslicePlane->SetOrigin(origin);
+
+  return reslicePlane;
+}
+
+mitk::Image::Pointer mitk::SegmentationInterpolationController::ExtractSlice(const PlaneGeometry *plane,
+                                                                            unsigned int timeStep)
+{
+  // Setting up the ExtractSliceFilter
+  mitk::ExtractSliceFilter::Pointer extractor = ExtractSliceFilter::New();
+  extractor->SetInput(m_Segmentation);
+  extractor->SetTimeStep(timeStep);
+  extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
+  extractor->SetVtkOutputRequest(false);
+
+  extractor->SetWorldGeometry(plane);
+  extractor->Modified();
+  extractor->Update();
+  mitk::Image::Pointer slice = extractor->GetOutput();
+  if (slice.IsNotNull())
+    slice->DisconnectPipeline();
+
+  return slice;
+}
+
+void mitk::SegmentationInterpolationController::ResetCache()
+{
+  std::lock_guard<std::mutex> lock(m_CacheMutex);
+  m_Cache = InterpolationCache();
+  ++m_CacheGeneration;
+}
+
+void mitk::SegmentationInterpolationController::PrepareCache(unsigned int sliceDimension,
+                                                             const PlaneGeometry *plane,
+                                                             unsigned int timeStep)
+{
+  const Vector3D axis0 = plane->GetAxisVector(0);
+  const Vector3D axis1 = plane->GetAxisVector(1);
+
+  std::lock_guard<std::mutex> lock(m_CacheMutex);
+  if (m_Cache.Valid && m_Cache.TimeStep == timeStep && m_Cache.SliceDimension == sliceDimension &&
+      mitk::Equal(m_Cache.Axes[0], axis0, mitk::eps, false) && mitk::Equal(m_Cache.Axes[1], axis1, mitk::eps, false))
+  {
+    return;
+  }
+
+  // only one orientation is cached
+  m_Cache = InterpolationCache();
+  m_Cache.Valid = true;
+  m_Cache.TimeStep = timeStep;
+  m_Cache.SliceDimension = sliceDimension;
+  m_Cache.Axes[0] = axis0;
+  m_Cache.Axes[1] = axis1;
+  ++m_CacheGeneration;
+}
+
+void mitk::SegmentationInterpolationController::IncreaseSliceVersion(unsigned int timeStep,
+                                                                     unsigned int sliceDimension,
+                                                                     unsigned int sliceIndex)
+{
+  if (timeStep >= m_SliceVersions.size() || sliceIndex >= m_SliceVersions[timeStep][sliceDimension].size())
+    return;
+
+  ++m_SliceVersions[timeStep][sliceDimension][sliceIndex];
+  ++m_NumberOfSliceChanges;
+}
 
-  mitk::SegmentationInterpolationAlgorithm::Pointer algorithm =
-    mitk::ShapeBasedInterpolationAlgorithm::New().GetPointer();
-  return algorithm->Interpolate(lowerMITKSlice.GetPointer(),
-                                lowerBound,
-                                upperMITKSlice.GetPointer(),
-                                upperBound,
-                                sliceIndex,
-                                sliceDimension,
-                                resultImage,
-                                timeStep,
-                                m_ReferenceImage);
+bool mitk::SegmentationInterpolationController::CreatePrecomputationTask(const PlaneGeometry *plane,
+                                                                         PrecomputationTask &task)
+{
+  std::vector<unsigned int> slicesToExtract;
+  unsigned int sliceDimension(0);
+  unsigned int timeStep(0);
+  {
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+    sliceDimension = m_Cache.SliceDimension;
+    timeStep = m_Cache.TimeStep;
+    const std::vector<unsigned int> &counts = m_SegmentationCountInSlice[timeStep][sliceDimension];
+    const std::vector<unsigned long> &versions = m_SliceVersions[timeStep][sliceDimension];
+
+    task.Generation = m_CacheGeneration;
+    task.TemplateSlice = m_Cache.TemplateSlice;
+    task.TemplateSliceIndex = m_Cache.TemplateSliceIndex;
+
+    // all gaps between two segmented slices
+    bool hasLowerBound(false);
+    unsigned int lowerBound(0);
+    for (unsigned int upperBound = 0; upperBound < counts.size(); ++upperBound)
+    {
+      if (counts[upperBound] == 0)
+        continue;
+
+      for (unsigned int index = lowerBound + 1; hasLowerBound && index < upperBound; ++index)
+      {
+        auto interpolation = m_Cache.Interpolations.find(index);
+        if (interpolation != m_Cache.Interpolations.end() && interpolation->second.LowerBound == lowerBound &&
+            interpolation->second.UpperBound == upperBound &&
+            interpolation->second.LowerVersion == versions[lowerBound] &&
+            interpolation->second.UpperVersion == versions[upperBound])
+        {
+          continue;
+        }
+
+        PrecomputationTask::EmptySlice emptySlice = {index, lowerBound, upperBound};
+        task.EmptySlices.push_back(emptySlice);
+        task.Versions[lowerBound] = versions[lowerBound];
+        task.Versions[upperBound] = versions[upperBound];
+      }
+
+      hasLowerBound = true;
+      lowerBound = upperBound;
+    }
+
+    for (const auto &version : task.Versions)
+    {
+      auto distanceMap = m_Cache.DistanceMaps.find(version.first);
+      if (distanceMap != m_Cache.DistanceMaps.end() && distanceMap->second.Version == version.second)
+        task.DistanceMaps[version.first] = distanceMap->second.DistanceMap;
+      else
+        slicesToExtract.push_back(version.first);
+    }
+  }
+
+  if (task.EmptySlices.empty())
+    return false;
+
+  // the extraction needs the segmentation and is therefore done here
+  for (unsigned int sliceIndex : slicesToExtract)
+  {
+    mitk::Image::Pointer slice =
+      this->ExtractSlice(this->GetSlicePlane(plane, sliceDimension, sliceIndex, timeStep), timeStep);
+    if (slice.IsNull())
+      return false;
+    task.Slices[sliceIndex] = slice;
+  }
+
+  if (task.TemplateSlice.IsNull())
+  {
+    task.TemplateSliceIndex = task.EmptySlices.front().LowerBound;
+    auto slice = task.Slices.find(task.TemplateSliceIndex);
+    task.TemplateSlice = slice != task.Slices.end() ?
+      slice->second :
+      this->ExtractSlice(this->GetSlicePlane(plane, sliceDimension, task.TemplateSliceIndex, timeStep), timeStep);
+    if (task.TemplateSlice.IsNull())
+      return false;
+
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+    if (task.Generation == m_CacheGeneration && m_Cache.TemplateSlice.IsNull())
+    {
+      m_Cache.TemplateSlice = task.TemplateSlice;
+      m_Cache.TemplateSliceIndex = task.TemplateSliceIndex;
+    }
+  }
+
+  task.SliceOffset = this->GetSlicePlane(plane, sliceDimension, 1, timeStep)->GetOrigin() -
+                     this->GetSlicePlane(plane, sliceDimension, 0, timeStep)->GetOrigin();
+
+  return true;
+}
+
+void mitk::SegmentationInterpolationController::RunPrecomputation(const PrecomputationTask &task,
+                                                                  unsigned int numberOfThreads)
+{
+  try
+  {
+    // distance maps of the bounding slices
+    std::vector<std::pair<unsigned int, Image::Pointer>> slices(task.Slices.begin(), task.Slices.end());
+    std::vector<Image::Pointer> distanceImages(slices.size());
+    mitk::ParallelFor(slices.size(), [&](std::size_t i) {
+      if (m_AbortPrecomputation)
+        return;
+      mitk::ShapeBasedInterpolationAlgorithm::Pointer algorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+      distanceImages[i] = algorithm->CreateDistanceMap(slices[i].second.GetPointer());
+    }, numberOfThreads);
+
+    if (m_AbortPrecomputation)
+      return;
+
+    std::map<unsigned int, Image::Pointer> distanceMaps(task.DistanceMaps);
+    {
+      std::lock_guard<std::mutex> lock(m_CacheMutex);
+      for (std::size_t i = 0; i < slices.size(); ++i)
+      {
+        distanceMaps[slices[i].first] = distanceImages[i];
+        if (task.Generation == m_CacheGeneration)
+        {
+          CachedDistanceMap distanceMap = {task.Versions.at(slices[i].first), distanceImages[i]};
+          m_Cache.DistanceMaps[slices[i].first] = distanceMap;
+        }
+      }
+    }
+
+    // the empty slices, each one is available as soon as it is interpolated
+    const PlaneGeometry *templatePlane = task.TemplateSlice->GetSlicedGeometry()->GetPlaneGeometry(0);
+    mitk::ParallelFor(task.EmptySlices.size(), [&](std::size_t i) {
+      if (m_AbortPrecomputation)
+        return;
+
+      const PrecomputationTask::EmptySlice &emptySlice = task.EmptySlices[i];
+
+      // same pixel type and extent as the template, moved to the empty slice
+      mitk::Image::Pointer resultImage = task.TemplateSlice->Clone();
+      mitk::PlaneGeometry::Pointer resultPlane = templatePlane->Clone();
+      const double offset = static_cast<double>(emptySlice.Index) - static_cast<double>(task.TemplateSliceIndex);
+      resultPlane->SetOrigin(templatePlane->GetOrigin() + task.SliceOffset * offset);
+      resultImage->SetGeometry(resultPlane);
+
+      mitk::ShapeBasedInterpolationAlgorithm::Pointer algorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+      resultImage = algorithm->InterpolateFromDistanceMaps(distanceMaps.at(emptySlice.LowerBound),
+                                                           emptySlice.LowerBound,
+                                                           distanceMaps.at(emptySlice.UpperBound),
+                                                           emptySlice.UpperBound,
+                                                           emptySlice.Index,
+                                                           resultImage);
+
+      std::lock_guard<std::mutex> lock(m_CacheMutex);
+      if (task.Generation == m_CacheGeneration)
+      {
+        CachedInterpolation interpolation = {emptySlice.LowerBound,
+                                             emptySlice.UpperBound,
+                                             task.Versions.at(emptySlice.LowerBound),
+                                             task.Versions.at(emptySlice.UpperBound),
+                                             resultImage};
+        m_Cache.Interpolations[emptySlice.Index] = interpolation;
+      }
+    }, numberOfThreads);
+  }
+  catch (const std::exception &e)
+  {
+    MITK_ERROR << "Error in 2D interpolation: " << e.what();
+  }
+}
+
+void mitk::SegmentationInterpolationController::StopPrecomputation()
+{
+  if (m_PrecomputationThread.joinable())
+  {
+    m_AbortPrecomputation = true;
+    m_PrecomputationThread.join();
+  }
+  m_AbortPrecomputation = false;
 }
@@ -24,7 +24,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImage.h>
 #include <itkObjectFactory.h>
 
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace mitk
@@ -69,6 +72,13 @@ namespace mitk
 
     \image html slice_based_segmentation_interpolator.png
 
+    The distance maps of the segmented slices and the interpolated slices are cached for one orientation at a time.
+    Each slice has a version that is increased whenever SetChangedSlice() reports a change of this slice (or of
+    a row/column of it, for the two other orientations). A cached interpolation stays valid as long as its two
+    bounding slices keep their versions, so changing a slice only invalidates the gaps next to it.
+    After each call of Interpolate(), the remaining gaps of the orientation are interpolated in a background
+    thread (see PrecomputeInterpolations()).
+
     $Author$
   */
   class MITKSEGMENTATION_EXPORT SegmentationInterpolationController : public itk::Object
@@ -148,6 +158,19 @@ namespace mitk
                                const mitk::PlaneGeometry *currentPlane,
                                unsigned int timeStep);
 
+    /**
+      \brief Interpolates all empty slices between segmented slices of the orientation of currentPlane.
+
+      The results are cached, so following calls of Interpolate() for these slices return immediately.
+
+      \param wait If true, the slices are interpolated using all cores and the method returns when all
+             interpolations are available. Otherwise the interpolation is done in a background thread.
+    */
+    void PrecomputeInterpolations(unsigned int sliceDimension,
+                                  const mitk::PlaneGeometry *currentPlane,
+                                  unsigned int timeStep,
+                                  bool wait);
+
     void OnImageModified(const itk::EventObject &);
 
     /**
@@ -181,6 +204,61 @@ namespace mitk
       const void *pixelData;
     };
 
+    /// distance map of a segmented slice, valid as long as the slice keeps its version
+    struct CachedDistanceMap
+    {
+      unsigned long Version;
+      Image::Pointer DistanceMap;
+    };
+
+    /// interpolation of an empty slice, valid as long as both bounding slices keep their versions
+    struct CachedInterpolation
+    {
+      unsigned int LowerBound;
+      unsigned int UpperBound;
+      unsigned long LowerVersion;
+      unsigned long UpperVersion;
+      Image::Pointer Result;
+    };
+
+    /// cached slices of one orientation
+    struct InterpolationCache
+    {
+      InterpolationCache() : Valid(false), TimeStep(0), SliceDimension(0), TemplateSliceIndex(0) {}
+
+      bool Valid;
+      unsigned int TimeStep;
+      unsigned int SliceDimension;
+      Vector3D Axes[2]; // axes of the plane the slices are extracted with
+
+      Image::Pointer TemplateSlice; // any extracted slice, provides pixel type and geometry of new slices
+      unsigned int TemplateSliceIndex;
+
+      std::map<unsigned int, CachedDistanceMap> DistanceMaps;
+      std::map<unsigned int, CachedInterpolation> Interpolations;
+    };
+
+    /// work of a precomputation, independent of the segmentation image
+    struct PrecomputationTask
+    {
+      struct EmptySlice
+      {
+        unsigned int Index;
+        unsigned int LowerBound;
+        unsigned int UpperBound;
+      };
+
+      unsigned long Generation;
+      Image::Pointer TemplateSlice;
+      unsigned int TemplateSliceIndex;
+      Vector3D SliceOffset; // world offset between two neighboring slices
+
+      std::map<unsigned int, unsigned long> Versions;          // versions of the bounding slices
+      std::map<unsigned int, Image::Pointer> Slices;           // bounding slices without cached distance map
+      std::map<unsigned int, Image::Pointer> DistanceMaps;     // cached distance maps of the bounding slices
+      std::vector<EmptySlice> EmptySlices;                     // slices to interpolate
+    };
+
     typedef std::vector<unsigned int> DirtyVectorType;
     // typedef std::vector< DirtyVectorType[3] > TimeResolvedDirtyVectorType; // cannot work with C++, so next line is
     // used for implementation
@@ -202,6 +280,30 @@ namespace mitk
 
     void PrintStatus();
 
+    /// plane of the given slice, with the orientation of plane
+    PlaneGeometry::Pointer GetSlicePlane(const PlaneGeometry *plane,
+                                         unsigned int sliceDimension,
+                                         unsigned int sliceIndex,
+                                         unsigned int timeStep);
+
+    Image::Pointer ExtractSlice(const PlaneGeometry *plane, unsigned int timeStep);
+
+    /// discards all cached slices
+    void ResetCache();
+
+    /// makes the cache hold the slices of the given orientation, discards the cached slices of other orientations
+    void PrepareCache(unsigned int sliceDimension, const PlaneGeometry *plane, unsigned int timeStep);
+
+    void IncreaseSliceVersion(unsigned int timeStep, unsigned int sliceDimension, unsigned int sliceIndex);
+
+    /// collects the slices of the cached orientation that still have to be interpolated
+    bool CreatePrecomputationTask(const PlaneGeometry *plane, PrecomputationTask &task);
+
+    /// computes the task with the given number of threads, may run in a background thread
+    void RunPrecomputation(const PrecomputationTask &task, unsigned int numberOfThreads);
+
+    void StopPrecomputation();
+
     /**
       An array of flags. One for each dimension of the image. A flag is set, when a slice in a certain dimension
       has at least one pixel that is not 0 (which would mean that it has to be considered by the interpolation
@@ -219,6 +321,19 @@ namespace mitk
     Image::ConstPointer m_ReferenceImage;
     bool m_BlockModified;
     bool m_2DInterpolationActivated;
+
+    /// version of each slice, m_SliceVersions[timeStep][sliceDimension][sliceIndex]
+    std::vector<std::vector<std::vector<unsigned long>>> m_SliceVersions;
+    unsigned long m_NumberOfSliceChanges;
+
+    /// guards m_Cache and m_CacheGeneration, which are shared with the precomputation thread
+    std::mutex m_CacheMutex;
+    InterpolationCache m_Cache;
+    unsigned long m_CacheGeneration; // increased whenever m_Cache is reset
+
+    std::thread m_PrecomputationThread;
+    std::atomic<bool> m_AbortPrecomputation;
+    std::vector<unsigned long> m_PrecomputationStamp; // what the last precomputation was started for
   };
 
 } // namespace
@@ -67,14 +67,18 @@ mitk::SliceBasedInterpolationController::~SliceBasedInterpolationController()
 void mitk::SliceBasedInterpolationController::ResetLabelCount()
 {
   m_LabelCountInSlice.clear();
+  m_SliceVersions.clear();
   int numberOfLabels = m_WorkingImage->GetNumberOfLabels();
   m_LabelCountInSlice.resize(m_WorkingImage->GetTimeSteps());
+  m_SliceVersions.resize(m_WorkingImage->GetTimeSteps());
 
   for (unsigned int timeStep = 0; timeStep < m_WorkingImage->GetTimeSteps(); ++timeStep)
   {
     m_LabelCountInSlice[timeStep].resize(3);
+    m_SliceVersions[timeStep].resize(3);
     for (unsigned int dim = 0; dim < 3; ++dim)
     {
+      m_SliceVersions[timeStep][dim].assign(m_WorkingImage->GetDimension(dim), 0);
       m_LabelCountInSlice[timeStep][dim].clear();
       m_LabelCountInSlice[timeStep][dim].resize(m_WorkingImage->GetDimension(dim));
       for (unsigned int slice = 0; slice < m_WorkingImage->GetDimension(dim); ++slice)
@@ -104,6 +108,7 @@ void mitk::SliceBasedInterpolationController::SetWorkingImage(LabelSetImage *new
   }
 
   this->ResetLabelCount();
+  this->ResetCache();
 
   AccessFixedDimensionByItk_1(m_WorkingImage, ScanImageITKProcessing, 3, 0);
 
@@ -168,7 +173,10 @@ void mitk::SliceBasedInterpolationController::SetChangedSlice(const Image *slice
   // check if the number of labels has changed
   auto numberOfLabels = m_WorkingImage->GetNumberOfLabels();
   if (m_LabelCountInSlice[0][0][0].size() != numberOfLabels)
+  {
+    this->ResetCache();
     return;
+  }
 
   unsigned int dim0(0);
   unsigned int dim1(1);
@@ -194,6 +202,17 @@ void mitk::SliceBasedInterpolationController::SetChangedSlice(const Image *slice
   AccessFixedDimensionByItk_1(
     slice, ScanSliceITKProcessing, 2, SetChangedSliceOptions(sliceDimension, sliceIndex, dim0, dim1, timeStep));
 
+  // invalidate the cached slices: the changed slice itself and every slice of the other two orientations,
+  // which all intersect it
+  if (timeStep < m_SliceVersions.size() && sliceIndex < m_SliceVersions[timeStep][sliceDimension].size())
+  {
+    ++m_SliceVersions[timeStep][sliceDimension][sliceIndex];
+    for (auto &version : m_SliceVersions[timeStep][dim0])
+      ++version;
+    for (auto &version : m_SliceVersions[timeStep][dim1])
+      ++version;
+  }
+
   //  this->Modified();
 }
 
@@ -350,70 +369,53 @@ mitk::Image::Pointer mitk::SliceBasedInterpolationController::Interpolate(unsign
 
   // ok, we have found two neighboring slices with the active label
   // (and we made sure that the current slice does NOT contain the active label
-  // Setting up the ExtractSliceFilter
-  mitk::ExtractSliceFilter::Pointer extractor = ExtractSliceFilter::New();
-  extractor->SetInput(m_WorkingImage);
-  extractor->SetTimeStep(timeStep);
-  extractor->SetResliceTransformByGeometry(m_WorkingImage->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
-  extractor->SetVtkOutputRequest(false);
+  this->PrepareCache(sliceDimension, currentPlane, timeStep, pixelValue);
 
-  // Reslicing the current plane
-  extractor->SetWorldGeometry(currentPlane);
-  extractor->Modified();
+  const unsigned long lowerVersion = m_SliceVersions[timeStep][sliceDimension][lowerBound];
+  const unsigned long upperVersion = m_SliceVersions[timeStep][sliceDimension][upperBound];
 
-  try
+  auto interpolation = m_Cache.Interpolations.find(sliceIndex);
+  if (interpolation != m_Cache.Interpolations.end() && interpolation->second.LowerBound == lowerBound &&
+      interpolation->second.UpperBound == upperBound && interpolation->second.LowerVersion == lowerVersion &&
+      interpolation->second.UpperVersion == upperVersion)
   {
-    extractor->Update();
-  }
-  catch (const std::exception &e)
-  {
-    MITK_ERROR << "Error in 2D interpolation: " << e.what();
-    return nullptr;
+    return interpolation->second.Result;
   }
 
-  mitk::Image::Pointer resultImage = extractor->GetOutput();
-  resultImage->DisconnectPipeline();
+  mitk::Image::Pointer lowerDistanceImage;
+  mitk::Image::Pointer upperDistanceImage;
 
-  // Creating PlaneGeometry for lower slice
-  mitk::PlaneGeometry::Pointer reslicePlane = currentPlane->Clone();
+  auto lowerDistanceMap = m_Cache.DistanceMaps.find(lowerBound);
+  if (lowerDistanceMap != m_Cache.DistanceMaps.end() && lowerDistanceMap->second.Version == lowerVersion)
+    lowerDistanceImage = lowerDistanceMap->second.DistanceMap;
 
-  // Transforming the current origin so that it matches the lower slice
-  mitk::Point3D origin = currentPlane->GetOrigin();
-  m_WorkingImage->GetSlicedGeometry()->WorldToIndex(origin, origin);
-  origin[sliceDimension] = lowerBound;
-  m_WorkingImage->GetSlicedGeometry()->IndexToWorld(origin, origin);
-  reslicePlane->SetOrigin(origin);
+  auto upperDistanceMap = m_Cache.DistanceMaps.find(upperBound);
+  if (upperDistanceMap != m_Cache.DistanceMaps.end() && upperDistanceMap->second.Version == upperVersion)
+    upperDistanceImage = upperDistanceMap->second.DistanceMap;
 
-  // Extract the lower slice
-  extractor->SetWorldGeometry(reslicePlane);
-  extractor->Modified();
+  mitk::Image::Pointer lowerMITKSlice;
+  mitk::Image::Pointer upperMITKSlice;
+  mitk::Image::Pointer resultImage;
 
   try
   {
-    extractor->Update();
-  }
-  catch (const std::exception &e)
-  {
-    MITK_ERROR << "Error in 2D interpolation: " << e.what();
-    return nullptr;
-  }
-
-  mitk::Image::Pointer lowerMITKSlice = extractor->GetOutput();
-  lowerMITKSlice->DisconnectPipeline();
+    // Reslicing the current plane
+    resultImage = this->ExtractSlice(currentPlane, timeStep);
 
-  // Transforming the current origin so that it matches the upper slice
-  m_WorkingImage->GetSlicedGeometry()->WorldToIndex(origin, origin);
-  origin[sliceDimension] = upperBound;
-  m_WorkingImage->GetSlicedGeometry()->IndexToWorld(origin, origin);
-  reslicePlane->SetOrigin(origin);
-
-  // Extract the upper slice
-  extractor->SetWorldGeometry(reslicePlane);
-  extractor->Modified();
+    // Extract the lower and upper slice, unless their distance maps are cached
+    if (lowerDistanceImage.IsNull())
+    {
+      lowerMITKSlice = this->ExtractSlice(this->GetSlicePlane(currentPlane, sliceDimension, lowerBound), timeStep);
+      if (lowerMITKSlice.IsNull())
+        return nullptr;
+    }
 
-  try
-  {
-    extractor->Update();
+    if (upperDistanceImage.IsNull())
+    {
+      upperMITKSlice = this->ExtractSlice(this->GetSlicePlane(currentPlane, sliceDimension, upperBound), timeStep);
+      if (upperMITKSlice.IsNull())
+        return nullptr;
+    }
   }
   catch (const std::exception &e)
   {
@@ -421,10 +423,7 @@ mitk::Image::Pointer mitk::SliceBasedInterpolationController::Interpolate(unsign
     return nullptr;
   }
 
-  mitk::Image::Pointer upperMITKSlice = extractor->GetOutput();
-  upperMITKSlice->DisconnectPipeline();
-
-  if (lowerMITKSlice.IsNull() || upperMITKSlice.IsNull())
+  if (resultImage.IsNull())
     return nullptr;
 
   // interpolation algorithm gets some inputs
@@ -435,12 +434,92 @@ mitk::Image::Pointer mitk::SliceBasedInterpolationController::Interpolate(unsign
   //
   // interpolation algorithm can use e.g. itk::ImageSliceConstIteratorWithIndex to
   //   inspect the original patient image at appropriate positions
+  //
+  // the shape based algorithm does not use the original image, so the distance maps of the bounding slices
+  // can be cached and reused for all slices of a gap
+
+  mitk::ShapeBasedInterpolationAlgorithm::Pointer algorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+  if (lowerDistanceImage.IsNull())
+    lowerDistanceImage = algorithm->CreateDistanceMap(lowerMITKSlice.GetPointer());
+  if (upperDistanceImage.IsNull())
+    upperDistanceImage = algorithm->CreateDistanceMap(upperMITKSlice.GetPointer());
 
-  mitk::SegmentationInterpolationAlgorithm::Pointer algorithm =
-    mitk::ShapeBasedInterpolationAlgorithm::New().GetPointer();
+  resultImage = algorithm->InterpolateFromDistanceMaps(
+    lowerDistanceImage, lowerBound, upperDistanceImage, upperBound, sliceIndex, resultImage);
 
-  algorithm->Interpolate(
-    lowerMITKSlice.GetPointer(), lowerBound, upperMITKSlice.GetPointer(), upperBound, sliceIndex, 0, resultImage);
+  CachedDistanceMap lowerCachedDistanceMap = {lowerVersion, lowerDistanceImage};
+  m_Cache.DistanceMaps[lowerBound] = lowerCachedDistanceMap;
+  CachedDistanceMap upperCachedDistanceMap = {upperVersion, upperDistanceImage};
+  m_Cache.DistanceMaps[upperBound] = upperCachedDistanceMap;
+
+  CachedInterpolation cachedInterpolation = {lowerBound, upperBound, lowerVersion, upperVersion, resultImage};
+  m_Cache.Interpolations[sliceIndex] = cachedInterpolation;
 
   return resultImage;
 }
+
+mitk::PlaneGeometry::Pointer mitk::SliceBasedInterpolationController::GetSlicePlane(const PlaneGeometry *plane,
+                                                                                   unsigned int sliceDimension,
+                                                                                   unsigned int sliceIndex)
+{
+  mitk::PlaneGeometry::Pointer reslicePlane = plane->Clone();
+
+  // Transforming the current origin so that it matches the requested slice
+  mitk::Point3D origin = plane->GetOrigin();
+  m_WorkingImage->GetSlicedGeometry()->WorldToIndex(origin, origin);
+  origin[sliceDimension] = sliceIndex;
+  m_WorkingImage->GetSlicedGeometry()->IndexToWorld(origin, origin);
+  reslicePlane->SetOrigin(origin);
+
+  return reslicePlane;
+}
+
+mitk::Image::Pointer mitk::SliceBasedInterpolationController::ExtractSlice(const PlaneGeometry *plane,
+                                                                         unsigned int timeStep)
+{
+  // Setting up the ExtractSliceFilter
+  mitk::ExtractSliceFilter::Pointer extractor = ExtractSliceFilter::New();
+  extractor->SetInput(m_WorkingImage);
+  extractor->SetTimeStep(timeStep);
+  extractor->SetResliceTransformByGeometry(m_WorkingImage->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
+  extractor->SetVtkOutputRequest(false);
+
+  extractor->SetWorldGeometry(plane);
+  extractor->Modified();
+  extractor->Update();
+  mitk::Image::Pointer slice = extractor->GetOutput();
+  if (slice.IsNotNull())
+    slice->DisconnectPipeline();
+
+  return slice;
+}
+
+void mitk::SliceBasedInterpolationController::ResetCache()
+{
+  m_Cache = InterpolationCache();
+}
+
+void mitk::SliceBasedInterpolationController::PrepareCache(unsigned int sliceDimension,
+                                                           const PlaneGeometry *plane,
+                                                           unsigned int timeStep,
+                                                           int pixelValue)
+{
+  const Vector3D axis0 = plane->GetAxisVector(0);
+  const Vector3D axis1 = plane->GetAxisVector(1);
+
+  if (m_Cache.Valid && m_Cache.TimeStep == timeStep && m_Cache.SliceDimension == sliceDimension &&
+      m_Cache.PixelValue == pixelValue && mitk::Equal(m_Cache.Axes[0], axis0, mitk::eps, false) &&
+      mitk::Equal(m_Cache.Axes[1], axis1, mitk::eps, false))
+  {
+    return;
+  }
+
+  // only one orientation and label is cached
+  m_Cache = InterpolationCache();
+  m_Cache.Valid = true;
+  m_Cache.TimeStep = timeStep;
+  m_Cache.SliceDimension = sliceDimension;
+  m_Cache.PixelValue = pixelValue;
+  m_Cache.Axes[0] = axis0;
+  m_Cache.Axes[1] = axis1;
+}
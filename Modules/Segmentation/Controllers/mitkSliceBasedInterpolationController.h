@@ -68,6 +68,11 @@ namespace mitk
 
     \image html slice_based_segmentation_interpolator.png
 
+    Interpolate() caches the distance maps of the bounding slices and the interpolated slices of the most recently
+    used orientation. All slices between two segmented slices are interpolated from the same two distance maps, so
+    scrolling through a gap or accepting all interpolations computes each distance map only once. Cached slices are
+    invalidated by SetChangedSlice() and dropped by SetWorkingImage().
+
     $Author$
   */
   class MITKSEGMENTATION_EXPORT SliceBasedInterpolationController : public itk::Object
@@ -171,6 +176,38 @@ namespace mitk
       //        void* pixelData;
     };
 
+    /// distance map of a slice containing the active label, valid as long as the slice keeps its version
+    struct CachedDistanceMap
+    {
+      unsigned long Version;
+      Image::Pointer DistanceMap;
+    };
+
+    /// interpolation of a slice without the active label, valid as long as both bounding slices keep their versions
+    struct CachedInterpolation
+    {
+      unsigned int LowerBound;
+      unsigned int UpperBound;
+      unsigned long LowerVersion;
+      unsigned long UpperVersion;
+      Image::Pointer Result;
+    };
+
+    /// cached slices of one orientation and label
+    struct InterpolationCache
+    {
+      InterpolationCache() : Valid(false), TimeStep(0), SliceDimension(0), PixelValue(0) {}
+
+      bool Valid;
+      unsigned int TimeStep;
+      unsigned int SliceDimension;
+      int PixelValue;
+      Vector3D Axes[2]; // axes of the plane the slices are extracted with
+
+      std::map<unsigned int, CachedDistanceMap> DistanceMaps;
+      std::map<unsigned int, CachedInterpolation> Interpolations;
+    };
+
     typedef std::vector<unsigned int> LabelCounterVectorType;
     typedef std::vector<LabelCounterVectorType> LabelCounterSliceVectorType;
     typedef std::vector<std::vector<LabelCounterSliceVectorType>> LabelCounterSliceTimeVectorType;
@@ -187,6 +224,19 @@ namespace mitk
     template <typename TPixel, unsigned int VImageDimension>
     void ScanImageITKProcessing(itk::Image<TPixel, VImageDimension> *, unsigned int timeStep);
 
+    /// plane of the given slice, with the orientation of plane
+    PlaneGeometry::Pointer GetSlicePlane(const PlaneGeometry *plane,
+                                         unsigned int sliceDimension,
+                                         unsigned int sliceIndex);
+
+    Image::Pointer ExtractSlice(const PlaneGeometry *plane, unsigned int timeStep);
+
+    /// discards all cached slices
+    void ResetCache();
+
+    /// makes the cache hold the slices of the given orientation and label, discards all other cached slices
+    void PrepareCache(unsigned int sliceDimension, const PlaneGeometry *plane, unsigned int timeStep, int pixelValue);
+
     /**
       An array that of flags. One for each dimension of the image. A flag is set, when a slice in a certain dimension
       has at least one pixel that is not 0 (which would mean that it has to be considered by the interpolation
@@ -196,6 +246,11 @@ namespace mitk
     */
     LabelCounterSliceTimeVectorType m_LabelCountInSlice;
 
+    /// version of each slice, m_SliceVersions[timeStep][sliceDimension][sliceIndex]
+    std::vector<std::vector<std::vector<unsigned long>>> m_SliceVersions;
+
+    InterpolationCache m_Cache;
+
     static InterpolatorMapType s_InterpolatorForImage;
 
     LabelSetImage::Pointer m_WorkingImage;
@@ -409,13 +409,14 @@ void mitk::SegTool2D::WriteSliceToVolume(mitk::SegTool2D::SliceInformation slice
   image->GetVtkImageData()->Modified();
 
   /*============= BEGIN undo/redo feature block ========================*/
-  // specify the undo operation with the edited slice
+  // specify the undo operation with the edited slice, the parts that were not edited are shared with the undo operation
   auto *doOperation =
     new DiffSliceOperation(image,
                            extractor->GetOutput(),
                            dynamic_cast<SlicedGeometry3D *>(sliceInfo.slice->GetGeometry()),
                            sliceInfo.timestep,
-                           sliceInfo.plane);
+                           sliceInfo.plane,
+                           undoOperation);
 
   // create an operation event for the undo stack
   OperationEvent *undoStackItem =
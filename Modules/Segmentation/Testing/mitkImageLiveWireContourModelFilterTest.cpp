@@ -0,0 +1,195 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkImageLiveWireContourModelFilter.h>
+#include <mitkTestFixture.h>
+
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <algorithm>
+#include <cmath>
+
+class mitkImageLiveWireContourModelFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageLiveWireContourModelFilterTestSuite);
+  MITK_TEST(KeptShortestPathTree_SameCostsAsNewSearch);
+  MITK_TEST(RepulsivePoints_DiscardKeptShortestPathTree);
+  MITK_TEST(LiveWireFilter_PathConnectsStartAndEnd);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef mitk::ImageLiveWireContourModelFilter::InternalImageType ImageType;
+  typedef mitk::ImageLiveWireContourModelFilter::ShortestPathImageFilterType ShortestPathFilterType;
+  typedef mitk::ImageLiveWireContourModelFilter::CostFunctionType CostFunctionType;
+  typedef mitk::ImageLiveWireContourModelFilter::ShortestPathType PathType;
+
+  ImageType::Pointer m_Image;
+
+  /** Ramp with a bright blob. The ramp is steeper than the blob, so the gradient magnitude is nowhere zero. */
+  ImageType::Pointer CreateImage()
+  {
+    ImageType::RegionType region;
+    region.SetSize(0, 64);
+    region.SetSize(1, 64);
+
+    ImageType::Pointer image = ImageType::New();
+    image->SetRegions(region);
+    image->Allocate();
+
+    itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const double x = it.GetIndex()[0];
+      const double y = it.GetIndex()[1];
+      const double r2 = (x - 32) * (x - 32) + (y - 28) * (y - 28);
+      it.Set(x + 2 * y + 20 * std::exp(-r2 / 200));
+    }
+    return image;
+  }
+
+  ShortestPathFilterType::Pointer CreateFilter(CostFunctionType *costFunction, bool keepShortestPathTree)
+  {
+    ShortestPathFilterType::Pointer filter = ShortestPathFilterType::New();
+    filter->SetCostFunction(costFunction);
+    filter->SetInput(m_Image);
+    filter->SetFullNeighborsMode(true);
+    filter->SetMakeOutputImage(false);
+    filter->SetKeepShortestPathTree(keepShortestPathTree);
+    return filter;
+  }
+
+  PathType FindPath(ShortestPathFilterType *filter, const itk::Index<2> &start, const itk::Index<2> &end)
+  {
+    filter->SetStartIndex(start);
+    filter->SetEndIndex(end);
+    filter->Update();
+    return filter->GetVectorPath();
+  }
+
+  double GetPathCosts(CostFunctionType *costFunction, const PathType &path)
+  {
+    double costs = 0.0;
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+      costs += costFunction->GetCost(path[i - 1], path[i]);
+    }
+    return costs;
+  }
+
+  itk::Index<2> MakeIndex(long x, long y)
+  {
+    itk::Index<2> index;
+    index[0] = x;
+    index[1] = y;
+    return index;
+  }
+
+public:
+  void setUp() override { m_Image = this->CreateImage(); }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void KeptShortestPathTree_SameCostsAsNewSearch()
+  {
+    CostFunctionType::Pointer keptCosts = CostFunctionType::New();
+    keptCosts->SetImage(m_Image);
+    ShortestPathFilterType::Pointer keptFilter = this->CreateFilter(keptCosts, true);
+
+    const itk::Index<2> start = MakeIndex(10, 10);
+    const itk::Index<2> ends[] = {
+      MakeIndex(50, 12), MakeIndex(32, 55), MakeIndex(12, 40), MakeIndex(10, 10), MakeIndex(63, 63), MakeIndex(11, 11)};
+
+    for (const auto &end : ends)
+    {
+      PathType keptPath = this->FindPath(keptFilter, start, end);
+
+      CostFunctionType::Pointer costs = CostFunctionType::New();
+      costs->SetImage(m_Image);
+      ShortestPathFilterType::Pointer filter = this->CreateFilter(costs, false);
+      PathType path = this->FindPath(filter, start, end);
+
+      CPPUNIT_ASSERT_MESSAGE("Path of kept tree should start at the start point", keptPath.front() == start);
+      CPPUNIT_ASSERT_MESSAGE("Path of kept tree should end at the end point", keptPath.back() == end);
+      CPPUNIT_ASSERT_MESSAGE("Path of new search should end at the end point", path.back() == end);
+
+      const double keptPathCosts = this->GetPathCosts(keptCosts, keptPath);
+      const double pathCosts = this->GetPathCosts(costs, path);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(
+        "Kept tree should yield a shortest path", pathCosts, keptPathCosts, 1e-9 * std::max(1.0, pathCosts));
+    }
+  }
+
+  void RepulsivePoints_DiscardKeptShortestPathTree()
+  {
+    CostFunctionType::Pointer costs = CostFunctionType::New();
+    costs->SetImage(m_Image);
+    ShortestPathFilterType::Pointer filter = this->CreateFilter(costs, true);
+
+    const itk::Index<2> start = MakeIndex(5, 30);
+    const itk::Index<2> end = MakeIndex(58, 30);
+    PathType firstPath = this->FindPath(filter, start, end);
+    CPPUNIT_ASSERT_MESSAGE("Path should have interior points", firstPath.size() > 2);
+
+    for (std::size_t i = 1; i + 1 < firstPath.size(); ++i)
+    {
+      costs->AddRepulsivePoint(firstPath[i]);
+    }
+
+    PathType secondPath = this->FindPath(filter, start, end);
+    CPPUNIT_ASSERT_MESSAGE("Path should avoid the repulsive points", secondPath != firstPath);
+    CPPUNIT_ASSERT_MESSAGE("Path should not cross repulsive points", this->GetPathCosts(costs, secondPath) < 1000);
+  }
+
+  void LiveWireFilter_PathConnectsStartAndEnd()
+  {
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->InitializeByItk(m_Image.GetPointer());
+    image->SetVolume(m_Image->GetBufferPointer());
+
+    mitk::ImageLiveWireContourModelFilter::Pointer liveWire = mitk::ImageLiveWireContourModelFilter::New();
+    liveWire->SetInput(image);
+
+    mitk::Point3D startIndex, start, end;
+    startIndex[0] = 10;
+    startIndex[1] = 10;
+    startIndex[2] = 0;
+    image->GetGeometry()->IndexToWorld(startIndex, start);
+    liveWire->SetStartPoint(start);
+
+    // several mouse moves with the same start point
+    for (int i = 0; i < 3; ++i)
+    {
+      mitk::Point3D endIndex;
+      endIndex[0] = 40 + 5 * i;
+      endIndex[1] = 50 - 10 * i;
+      endIndex[2] = 0;
+      image->GetGeometry()->IndexToWorld(endIndex, end);
+      liveWire->SetEndPoint(end);
+      liveWire->Update();
+
+      mitk::ContourModel::Pointer contour = liveWire->GetOutput();
+      CPPUNIT_ASSERT_MESSAGE("Contour should not be empty", contour->GetNumberOfVertices() > 1);
+
+      mitk::Point3D first = contour->GetVertexAt(0)->Coordinates;
+      mitk::Point3D last = contour->GetVertexAt(contour->GetNumberOfVertices() - 1)->Coordinates;
+      CPPUNIT_ASSERT_MESSAGE("Contour should start at the start point", first.EuclideanDistanceTo(start) < mitk::eps);
+      CPPUNIT_ASSERT_MESSAGE("Contour should end at the end point", last.EuclideanDistanceTo(end) < mitk::eps);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageLiveWireContourModelFilter)
@@ -29,12 +29,44 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTool.h>
 #include <mitkVtkImageOverwrite.h>
 
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+  /** Gives the tests access to the cached interpolations */
+  class TestSegmentationInterpolationController : public mitk::SegmentationInterpolationController
+  {
+  public:
+    mitkClassMacro(TestSegmentationInterpolationController, mitk::SegmentationInterpolationController);
+    itkFactorylessNewMacro(Self);
+
+    /** Whether the cache holds a valid interpolation of the given axial slice of time step 0 */
+    bool IsInterpolationCached(unsigned int sliceIndex)
+    {
+      std::lock_guard<std::mutex> lock(m_CacheMutex);
+      auto interpolation = m_Cache.Interpolations.find(sliceIndex);
+      if (interpolation == m_Cache.Interpolations.end())
+        return false;
+
+      const std::vector<unsigned long> &versions = m_SliceVersions[0][2];
+      return versions[interpolation->second.LowerBound] == interpolation->second.LowerVersion &&
+             versions[interpolation->second.UpperBound] == interpolation->second.UpperVersion;
+    }
+  };
+}
+
 class mitkSegmentationInterpolationTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkSegmentationInterpolationTestSuite);
   MITK_TEST(Equal_Axial_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Frontal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Sagittal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
+  MITK_TEST(Interpolate_CachedResult_EqualsUncachedResult);
+  MITK_TEST(SetChangedSlice_InvalidatesOnlyAdjacentGaps);
+  MITK_TEST(PrecomputeInterpolations_Wait_EqualsSequentialInterpolation);
+  MITK_TEST(Destructor_DuringPrecomputation_StopsPrecomputation);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -148,6 +180,76 @@ private:
     }
   }
 
+  /** Creates an empty segmentation of the given size */
+  mitk::Image::Pointer CreateSegmentation(unsigned int size, unsigned int numberOfSlices)
+  {
+    unsigned int dimensions[3] = {size, size, numberOfSlices};
+    mitk::Image::Pointer segmentation = mitk::Image::New();
+    segmentation->Initialize(mitk::MakeScalarPixelType<mitk::Tool::DefaultSegmentationDataType>(), 3, dimensions);
+    mitk::ImageWriteAccessor accessor(segmentation);
+    memset(accessor.GetData(), 0, size * size * numberOfSlices * sizeof(mitk::Tool::DefaultSegmentationDataType));
+    return segmentation;
+  }
+
+  /** Segments a centered square with the given half width in an axial slice */
+  void FillSquare(mitk::Image *segmentation, unsigned int sliceIndex, int halfWidth)
+  {
+    const int center = segmentation->GetDimension(0) / 2;
+    mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(segmentation);
+    itk::Index<3> index;
+    index[2] = sliceIndex;
+    for (index[1] = center - halfWidth; index[1] <= center + halfWidth; ++index[1])
+    {
+      for (index[0] = center - halfWidth; index[0] <= center + halfWidth; ++index[0])
+      {
+        writeAccessor.SetPixelByIndexSafe(index, 1);
+      }
+    }
+  }
+
+  /** Segmentation with segmented axial slices 1, 4, 8 and 12, i.e. the gaps 2-3, 5-7 and 9-11 */
+  mitk::Image::Pointer CreateSegmentationWithGaps()
+  {
+    mitk::Image::Pointer segmentation = this->CreateSegmentation(32, 14);
+    this->FillSquare(segmentation, 1, 3);
+    this->FillSquare(segmentation, 4, 8);
+    this->FillSquare(segmentation, 8, 2);
+    this->FillSquare(segmentation, 12, 10);
+    return segmentation;
+  }
+
+  mitk::PlaneGeometry::Pointer GetAxialPlane(mitk::Image *segmentation, unsigned int sliceIndex)
+  {
+    mitk::SliceNavigationController::Pointer navigationController = mitk::SliceNavigationController::New();
+    navigationController->SetInputWorldTimeGeometry(segmentation->GetTimeGeometry());
+    navigationController->Update(mitk::SliceNavigationController::Axial);
+    mitk::Point3D indexPoint;
+    indexPoint[0] = segmentation->GetDimension(0) / 2;
+    indexPoint[1] = segmentation->GetDimension(1) / 2;
+    indexPoint[2] = sliceIndex;
+    mitk::Point3D pointMM;
+    segmentation->GetGeometry()->IndexToWorld(indexPoint, pointMM);
+    navigationController->SelectSliceByPoint(pointMM);
+    return navigationController->GetCurrentPlaneGeometry()->Clone();
+  }
+
+  /** Interpolates a slice with a new controller, i.e. without any cached results */
+  mitk::Image::Pointer InterpolateUncached(mitk::Image *segmentation, unsigned int sliceIndex)
+  {
+    mitk::SegmentationInterpolationController::Pointer controller = mitk::SegmentationInterpolationController::New();
+    controller->SetSegmentationVolume(segmentation);
+    return controller->Interpolate(2, sliceIndex, this->GetAxialPlane(segmentation, sliceIndex), 0);
+  }
+
+  void AssertEqualSlices(const std::string &message, mitk::Image *expected, mitk::Image *actual)
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message + " (both slices interpolated)", expected != nullptr, actual != nullptr);
+    if (expected)
+    {
+      CPPUNIT_ASSERT_MESSAGE(message, mitk::Equal(*expected, *actual, mitk::eps, true));
+    }
+  }
+
   mitk::Image::Pointer m_ReferenceImage;
   mitk::Image::Pointer m_SegmentationImage;
   itk::Index<3> m_CenterPoint;
@@ -203,6 +305,120 @@ public:
     mitk::SliceNavigationController::ViewDirection viewDirection = mitk::SliceNavigationController::Sagittal;
     testRoutine(viewDirection);
   }
+
+  void Interpolate_CachedResult_EqualsUncachedResult()
+  {
+    mitk::Image::Pointer segmentation = this->CreateSegmentationWithGaps();
+    mitk::SegmentationInterpolationController::Pointer controller = mitk::SegmentationInterpolationController::New();
+    controller->SetSegmentationVolume(segmentation);
+
+    // caches the distance maps of slices 1 and 4, the remaining gaps are interpolated in the background
+    controller->Interpolate(2, 2, this->GetAxialPlane(segmentation, 2), 0);
+    controller->PrecomputeInterpolations(2, this->GetAxialPlane(segmentation, 2), 0, true);
+
+    for (unsigned int sliceIndex : {3u, 6u, 10u})
+    {
+      mitk::Image::Pointer cached =
+        controller->Interpolate(2, sliceIndex, this->GetAxialPlane(segmentation, sliceIndex), 0);
+      mitk::Image::Pointer uncached = this->InterpolateUncached(segmentation, sliceIndex);
+      std::ostringstream message;
+      message << "Cached interpolation of slice " << sliceIndex << " equals the uncached one";
+      this->AssertEqualSlices(message.str(), uncached, cached);
+    }
+  }
+
+  void SetChangedSlice_InvalidatesOnlyAdjacentGaps()
+  {
+    mitk::Image::Pointer segmentation = this->CreateSegmentationWithGaps();
+    TestSegmentationInterpolationController::Pointer controller = TestSegmentationInterpolationController::New();
+    controller->SetSegmentationVolume(segmentation);
+    controller->PrecomputeInterpolations(2, this->GetAxialPlane(segmentation, 2), 0, true);
+
+    for (unsigned int sliceIndex : {2u, 3u, 5u, 6u, 7u, 9u, 10u, 11u})
+    {
+      std::ostringstream message;
+      message << "Slice " << sliceIndex << " is cached after the precomputation";
+      CPPUNIT_ASSERT_MESSAGE(message.str(), controller->IsInterpolationCached(sliceIndex));
+    }
+
+    // adds a pixel to slice 4 and reports the difference
+    const unsigned int size = segmentation->GetDimension(0);
+    unsigned int sliceDimensions[2] = {size, size};
+    mitk::Image::Pointer sliceDiff = mitk::Image::New();
+    sliceDiff->Initialize(mitk::MakeScalarPixelType<mitk::Tool::DefaultSegmentationDataType>(), 2, sliceDimensions);
+    {
+      mitk::ImageWriteAccessor accessor(sliceDiff);
+      auto *diff = static_cast<mitk::Tool::DefaultSegmentationDataType *>(accessor.GetData());
+      std::fill_n(diff, size * size, 0);
+      diff[1 * size + 1] = 1;
+    }
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(segmentation);
+      itk::Index<3> index = {{1, 1, 4}};
+      writeAccessor.SetPixelByIndexSafe(index, 1);
+    }
+    controller->SetChangedSlice(sliceDiff, 2, 4, 0);
+
+    for (unsigned int sliceIndex : {2u, 3u, 5u, 6u, 7u})
+    {
+      std::ostringstream message;
+      message << "Slice " << sliceIndex << " next to the changed slice is invalidated";
+      CPPUNIT_ASSERT_MESSAGE(message.str(), !controller->IsInterpolationCached(sliceIndex));
+    }
+    for (unsigned int sliceIndex : {9u, 10u, 11u})
+    {
+      std::ostringstream message;
+      message << "Slice " << sliceIndex << " of another gap stays cached";
+      CPPUNIT_ASSERT_MESSAGE(message.str(), controller->IsInterpolationCached(sliceIndex));
+    }
+
+    mitk::Image::Pointer interpolation = controller->Interpolate(2, 3, this->GetAxialPlane(segmentation, 3), 0);
+    this->AssertEqualSlices("Interpolation after the change equals the uncached one",
+                            this->InterpolateUncached(segmentation, 3),
+                            interpolation);
+  }
+
+  void PrecomputeInterpolations_Wait_EqualsSequentialInterpolation()
+  {
+    mitk::Image::Pointer segmentation = this->CreateSegmentationWithGaps();
+
+    // like "accept all": precompute all slices with all cores, then interpolate each slice
+    mitk::SegmentationInterpolationController::Pointer controller = mitk::SegmentationInterpolationController::New();
+    controller->SetSegmentationVolume(segmentation);
+    controller->PrecomputeInterpolations(2, this->GetAxialPlane(segmentation, 0), 0, true);
+
+    for (unsigned int sliceIndex = 0; sliceIndex < segmentation->GetDimension(2); ++sliceIndex)
+    {
+      mitk::Image::Pointer precomputed =
+        controller->Interpolate(2, sliceIndex, this->GetAxialPlane(segmentation, sliceIndex), 0);
+      std::ostringstream message;
+      message << "Precomputed interpolation of slice " << sliceIndex << " equals the sequential one";
+      this->AssertEqualSlices(message.str(), this->InterpolateUncached(segmentation, sliceIndex), precomputed);
+    }
+  }
+
+  void Destructor_DuringPrecomputation_StopsPrecomputation()
+  {
+    // large enough that the background precomputation is still running when the controller is destroyed
+    mitk::Image::Pointer segmentation = this->CreateSegmentation(256, 60);
+    for (unsigned int sliceIndex = 0; sliceIndex < 60; sliceIndex += 6)
+    {
+      this->FillSquare(segmentation, sliceIndex, 20 + sliceIndex);
+    }
+
+    mitk::SegmentationInterpolationController::Pointer controller = mitk::SegmentationInterpolationController::New();
+    controller->SetSegmentationVolume(segmentation);
+    mitk::Image::Pointer interpolation = controller->Interpolate(2, 3, this->GetAxialPlane(segmentation, 3), 0);
+    CPPUNIT_ASSERT_MESSAGE("Slice between two segmented slices is interpolated", interpolation.IsNotNull());
+
+    controller = nullptr;
+    CPPUNIT_ASSERT_MESSAGE("Destroyed controller is not registered for the image anymore",
+                           mitk::SegmentationInterpolationController::InterpolatorForImage(segmentation) == nullptr);
+
+    this->AssertEqualSlices("Segmentation is usable with a new controller",
+                            interpolation,
+                            this->InterpolateUncached(segmentation, 3));
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkSegmentationInterpolation)
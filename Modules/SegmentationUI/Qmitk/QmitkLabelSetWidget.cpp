@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // mitk
 #include <mitkAutoCropImageFilter.h>
 #include <mitkCoreObjectFactory.h>
+#include <mitkDataStorage.h>
 #include <mitkIOUtil.h>
 #include <mitkLabelSetImage.h>
 #include <mitkLabelSetImageToSurfaceThreadedFilter.h>
@@ -89,6 +90,7 @@ QmitkLabelSetWidget::QmitkLabelSetWidget(QWidget *parent)
 
 QmitkLabelSetWidget::~QmitkLabelSetWidget()
 {
+  this->SetDataStorage(nullptr);
 }
 
 void QmitkLabelSetWidget::OnTableViewContextMenuRequested(const QPoint& /*pos*/)
@@ -190,9 +192,14 @@ void QmitkLabelSetWidget::OnTableViewContextMenuRequested(const QPoint& /*pos*/)
 
     QAction *tmp1 = createSurfaceAction->menu()->addAction(QString("Detailed"));
     QAction *tmp2 = createSurfaceAction->menu()->addAction(QString("Smoothed"));
+    createSurfaceAction->menu()->addSeparator();
+    QAction *tmp3 = createSurfaceAction->menu()->addAction(QString("Detailed (all labels)"));
+    QAction *tmp4 = createSurfaceAction->menu()->addAction(QString("Smoothed (all labels)"));
 
     QObject::connect(tmp1, SIGNAL(triggered(bool)), this, SLOT(OnCreateDetailedSurface(bool)));
     QObject::connect(tmp2, SIGNAL(triggered(bool)), this, SLOT(OnCreateSmoothedSurface(bool)));
+    QObject::connect(tmp3, SIGNAL(triggered(bool)), this, SLOT(OnCreateDetailedSurfaces(bool)));
+    QObject::connect(tmp4, SIGNAL(triggered(bool)), this, SLOT(OnCreateSmoothedSurfaces(bool)));
 
     menu->addAction(createSurfaceAction);
 
@@ -921,7 +928,30 @@ void QmitkLabelSetWidget::setEnabled(bool enabled)
 
 void QmitkLabelSetWidget::SetDataStorage(mitk::DataStorage *storage)
 {
+  if (m_DataStorage == storage)
+  {
+    return;
+  }
+
+  if (m_DataStorage != nullptr)
+  {
+    m_DataStorage->RemoveNodeEvent.RemoveListener(
+      mitk::MessageDelegate1<QmitkLabelSetWidget, const mitk::DataNode *>(this, &QmitkLabelSetWidget::OnNodeRemoved));
+  }
+
   m_DataStorage = storage;
+  m_SurfaceFilters.clear();
+
+  if (m_DataStorage != nullptr)
+  {
+    m_DataStorage->RemoveNodeEvent.AddListener(
+      mitk::MessageDelegate1<QmitkLabelSetWidget, const mitk::DataNode *>(this, &QmitkLabelSetWidget::OnNodeRemoved));
+  }
+}
+
+void QmitkLabelSetWidget::OnNodeRemoved(const mitk::DataNode *node)
+{
+  m_SurfaceFilters.erase(node);
 }
 
 void QmitkLabelSetWidget::OnSearchLabel()
@@ -1118,47 +1148,25 @@ void QmitkLabelSetWidget::OnToggleOutline(bool value)
 
 void QmitkLabelSetWidget::OnCreateSmoothedSurface(bool /*triggered*/)
 {
-  m_ToolManager->ActivateTool(-1);
-
-  mitk::DataNode::Pointer workingNode = GetWorkingNode();
-  mitk::LabelSetImage *workingImage = GetWorkingImage();
-  int pixelValue = GetPixelValueOfSelectedItem();
-
-  mitk::LabelSetImageToSurfaceThreadedFilter::Pointer surfaceFilter = mitk::LabelSetImageToSurfaceThreadedFilter::New();
-
-  itk::SimpleMemberCommand<QmitkLabelSetWidget>::Pointer successCommand =
-    itk::SimpleMemberCommand<QmitkLabelSetWidget>::New();
-  successCommand->SetCallbackFunction(this, &QmitkLabelSetWidget::OnThreadedCalculationDone);
-  surfaceFilter->AddObserver(mitk::ResultAvailable(), successCommand);
-
-  itk::SimpleMemberCommand<QmitkLabelSetWidget>::Pointer errorCommand =
-    itk::SimpleMemberCommand<QmitkLabelSetWidget>::New();
-  errorCommand->SetCallbackFunction(this, &QmitkLabelSetWidget::OnThreadedCalculationDone);
-  surfaceFilter->AddObserver(mitk::ProcessingError(), errorCommand);
+  this->CreateSurface(true, false);
+}
 
-  mitk::DataNode::Pointer groupNode = workingNode;
-  surfaceFilter->SetPointerParameter("Group node", groupNode);
-  surfaceFilter->SetPointerParameter("Input", workingImage);
-  surfaceFilter->SetParameter("RequestedLabel", pixelValue);
-  surfaceFilter->SetParameter("Smooth", true);
-  surfaceFilter->SetDataStorage(*m_DataStorage);
+void QmitkLabelSetWidget::OnCreateDetailedSurface(bool /*triggered*/)
+{
+  this->CreateSurface(false, false);
+}
 
-  mitk::StatusBar::GetInstance()->DisplayText("Surface creation is running in background...");
+void QmitkLabelSetWidget::OnCreateSmoothedSurfaces(bool /*triggered*/)
+{
+  this->CreateSurface(true, true);
+}
 
-  try
-  {
-    surfaceFilter->StartAlgorithm();
-  }
-  catch (mitk::Exception &e)
-  {
-    MITK_ERROR << "Exception caught: " << e.GetDescription();
-    QMessageBox::information(this,
-                             "Create Surface",
-                             "Could not create a surface mesh out of the selected label. See error log for details.\n");
-  }
+void QmitkLabelSetWidget::OnCreateDetailedSurfaces(bool /*triggered*/)
+{
+  this->CreateSurface(false, true);
 }
 
-void QmitkLabelSetWidget::OnCreateDetailedSurface(bool /*triggered*/)
+void QmitkLabelSetWidget::CreateSurface(bool smooth, bool allLabels)
 {
   m_ToolManager->ActivateTool(-1);
 
@@ -1166,23 +1174,30 @@ void QmitkLabelSetWidget::OnCreateDetailedSurface(bool /*triggered*/)
   mitk::LabelSetImage *workingImage = GetWorkingImage();
   int pixelValue = GetPixelValueOfSelectedItem();
 
-  mitk::LabelSetImageToSurfaceThreadedFilter::Pointer surfaceFilter = mitk::LabelSetImageToSurfaceThreadedFilter::New();
+  // one filter per segmentation, it keeps the surfaces of unchanged labels between runs,
+  // OnNodeRemoved() drops it when the segmentation is removed from the data storage
+  mitk::LabelSetImageToSurfaceThreadedFilter::Pointer &surfaceFilter = m_SurfaceFilters[workingNode.GetPointer()];
+  if (surfaceFilter.IsNull())
+  {
+    surfaceFilter = mitk::LabelSetImageToSurfaceThreadedFilter::New();
 
-  itk::SimpleMemberCommand<QmitkLabelSetWidget>::Pointer successCommand =
-    itk::SimpleMemberCommand<QmitkLabelSetWidget>::New();
-  successCommand->SetCallbackFunction(this, &QmitkLabelSetWidget::OnThreadedCalculationDone);
-  surfaceFilter->AddObserver(mitk::ResultAvailable(), successCommand);
+    itk::SimpleMemberCommand<QmitkLabelSetWidget>::Pointer successCommand =
+      itk::SimpleMemberCommand<QmitkLabelSetWidget>::New();
+    successCommand->SetCallbackFunction(this, &QmitkLabelSetWidget::OnThreadedCalculationDone);
+    surfaceFilter->AddObserver(mitk::ResultAvailable(), successCommand);
 
-  itk::SimpleMemberCommand<QmitkLabelSetWidget>::Pointer errorCommand =
-    itk::SimpleMemberCommand<QmitkLabelSetWidget>::New();
-  errorCommand->SetCallbackFunction(this, &QmitkLabelSetWidget::OnThreadedCalculationDone);
-  surfaceFilter->AddObserver(mitk::ProcessingError(), errorCommand);
+    itk::SimpleMemberCommand<QmitkLabelSetWidget>::Pointer errorCommand =
+      itk::SimpleMemberCommand<QmitkLabelSetWidget>::New();
+    errorCommand->SetCallbackFunction(this, &QmitkLabelSetWidget::OnThreadedCalculationDone);
+    surfaceFilter->AddObserver(mitk::ProcessingError(), errorCommand);
+  }
 
   mitk::DataNode::Pointer groupNode = workingNode;
   surfaceFilter->SetPointerParameter("Group node", groupNode);
   surfaceFilter->SetPointerParameter("Input", workingImage);
   surfaceFilter->SetParameter("RequestedLabel", pixelValue);
-  surfaceFilter->SetParameter("Smooth", false);
+  surfaceFilter->SetParameter("GenerateAllLabels", allLabels);
+  surfaceFilter->SetParameter("Smooth", smooth);
   surfaceFilter->SetDataStorage(*m_DataStorage);
 
   mitk::StatusBar::GetInstance()->DisplayText("Surface creation is running in background...");
@@ -24,6 +24,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNumericTypes.h"
 #include <ui_QmitkLabelSetWidgetControls.h>
 
+#include <itkSmartPointer.h>
+
+#include <map>
+
 class QmitkDataStorageComboBox;
 class QCompleter;
 
@@ -35,6 +39,7 @@ namespace mitk
   class DataStorage;
   class ToolManager;
   class DataNode;
+  class LabelSetImageToSurfaceThreadedFilter;
 }
 
 class MITKSEGMENTATIONUI_EXPORT QmitkLabelSetWidget : public QWidget
@@ -110,6 +115,9 @@ private slots:
   // LabelSetImage Dependet
   void OnCreateDetailedSurface(bool);
   void OnCreateSmoothedSurface(bool);
+  // surfaces of all labels of the working image
+  void OnCreateDetailedSurfaces(bool);
+  void OnCreateSmoothedSurfaces(bool);
   // reaction to the signal "createMask" from QmitkLabelSetTableWidget
   void OnCreateMask(bool);
   void OnCreateMasks(bool);
@@ -149,6 +157,11 @@ private:
 
   void OnThreadedCalculationDone();
 
+  /** \brief Drops the surface filter of a removed segmentation, so that a node that is created later at the same address does not get it. */
+  void OnNodeRemoved(const mitk::DataNode *node);
+
+  void CreateSurface(bool smooth, bool allLabels);
+
   void InitializeTableWidget();
 
   int GetPixelValueOfSelectedItem();
@@ -170,6 +183,8 @@ private:
   QStringList m_OrganColors;
 
   QStringList m_LabelStringList;
+
+  std::map<const mitk::DataNode *, itk::SmartPointer<mitk::LabelSetImageToSurfaceThreadedFilter>> m_SurfaceFilters;
 };
 
 #endif
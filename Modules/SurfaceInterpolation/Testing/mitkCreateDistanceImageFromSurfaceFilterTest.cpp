@@ -29,6 +29,7 @@ class mitkCreateDistanceImageFromSurfaceFilterTestSuite : public mitk::TestFixtu
   vtkDebugLeaks::SetExitError(0);
   MITK_TEST(TestCreateDistanceImageForLiver);
   MITK_TEST(TestCreateDistanceImageForTube);
+  MITK_TEST(TestCreateDistanceImageForLiverIncrementally);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -131,6 +132,67 @@ public:
     CPPUNIT_ASSERT_MESSAGE("HolesDistanceImages are not equal!",
                            mitk::Equal(*(holesDistanceImageReference), *(holeDistanceImage), 0.0001, true));
   }
+
+  // Interpolate the shape of a liver, adding one contour in a second update
+  void TestCreateDistanceImageForLiverIncrementally()
+  {
+    unsigned int NUMBER_OF_LIVER_CONTOURS = 18;
+    unsigned int ADDED_CONTOUR = 9;
+
+    for (unsigned int i = 0; i <= NUMBER_OF_LIVER_CONTOURS; ++i)
+    {
+      if (i == ADDED_CONTOUR)
+        continue;
+
+      std::stringstream s;
+      s << "SurfaceInterpolation/InterpolateLiver/LiverContourWithNormals_";
+      s << i;
+      s << ".vtk";
+      mitk::Surface::Pointer contour = mitk::IOUtil::Load<mitk::Surface>(GetTestDataFilePath(s.str()));
+      contourList.push_back(contour);
+    }
+
+    std::stringstream s;
+    s << "SurfaceInterpolation/InterpolateLiver/LiverContourWithNormals_";
+    s << ADDED_CONTOUR;
+    s << ".vtk";
+    contourList.push_back(mitk::IOUtil::Load<mitk::Surface>(GetTestDataFilePath(s.str())));
+
+    mitk::Image::Pointer segmentationImage =
+      mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("SurfaceInterpolation/Reference/LiverSegmentation.nrrd"));
+
+    mitk::ComputeContourSetNormalsFilter::Pointer m_NormalsFilter = mitk::ComputeContourSetNormalsFilter::New();
+    mitk::CreateDistanceImageFromSurfaceFilter::Pointer m_InterpolateSurfaceFilter =
+      mitk::CreateDistanceImageFromSurfaceFilter::New();
+
+    itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+    AccessFixedDimensionByItk_1(segmentationImage, GetImageBase, 3, itkImage);
+    m_InterpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
+
+    for (unsigned int j = 0; j < contourList.size(); j++)
+    {
+      m_NormalsFilter->SetInput(j, contourList.at(j));
+    }
+
+    for (unsigned int j = 0; j + 1 < contourList.size(); j++)
+    {
+      m_InterpolateSurfaceFilter->SetInput(j, m_NormalsFilter->GetOutput(j));
+    }
+    m_InterpolateSurfaceFilter->Update();
+
+    // The second update reuses the equation system of the first one
+    m_InterpolateSurfaceFilter->SetInput(contourList.size() - 1, m_NormalsFilter->GetOutput(contourList.size() - 1));
+    m_InterpolateSurfaceFilter->Update();
+
+    mitk::Image::Pointer liverDistanceImage = m_InterpolateSurfaceFilter->GetOutput();
+
+    CPPUNIT_ASSERT(liverDistanceImage.IsNotNull());
+    mitk::Image::Pointer liverDistanceImageReference =
+      mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("SurfaceInterpolation/Reference/LiverDistanceImage.nrrd"));
+
+    CPPUNIT_ASSERT_MESSAGE("LiverDistanceImages are not equal!",
+                           mitk::Equal(*(liverDistanceImageReference), *(liverDistanceImage), 0.0001, true));
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkCreateDistanceImageFromSurfaceFilter)
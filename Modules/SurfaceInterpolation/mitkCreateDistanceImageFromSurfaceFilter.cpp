@@ -24,9 +24,26 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkSmartPointer.h"
 
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkNeighborhoodIterator.h"
 
-#include <queue>
+#include <map>
+#include <set>
+
+namespace
+{
+  // Lexicographic order of points, used to find duplicated and already factorized centers
+  struct PointLess
+  {
+    bool operator()(const mitk::CreateDistanceImageFromSurfaceFilter::PointType &p1,
+                    const mitk::CreateDistanceImageFromSurfaceFilter::PointType &p2) const
+    {
+      if (p1[0] != p2[0])
+        return p1[0] < p2[0];
+      if (p1[1] != p2[1])
+        return p1[1] < p2[1];
+      return p1[2] < p2[2];
+    }
+  };
+}
 
 void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 {
@@ -111,6 +128,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 mitk::CreateDistanceImageFromSurfaceFilter::CreateDistanceImageFromSurfaceFilter()
 {
   m_DistanceImageVolume = 50000;
+  m_NumberOfFactorizedCenters = 0;
   this->m_UseProgressBar = false;
   this->m_ProgressStepSize = 5;
 
@@ -133,7 +151,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::GenerateData()
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(1);
 
-  m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  this->SolveEquationSystem();
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(2);
@@ -171,6 +189,8 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
   PointType currentPoint;
   PointType normal;
 
+  std::set<PointType, PointLess> existingCenters;
+
   for (unsigned int i = 0; i < numberOfInputs; i++)
   {
     auto currentSurface = this->GetInput(i);
@@ -202,9 +222,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
 
         currentPoint.copy_in(p);
 
-        int count = std::count(m_Centers.begin(), m_Centers.end(), currentPoint);
-
-        if (count == 0)
+        if (existingCenters.insert(currentPoint).second)
         {
           double currentNormal[3];
           currentCellNormals->GetTuple(cell[j], currentNormal);
@@ -264,6 +282,9 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateSolutionMatrixAndFunction
     m_FunctionValues[numberOfCenters * 2 + i] = m_DistanceImageSpacing;
   }
 
+  // If the centers of a previous update are still present they have to lead the equation system
+  m_NumberOfFactorizedCenters = this->ArrangeCentersForIncrementalSolution();
+
   // Now we have created all centers and all function values. Next step is to create the solution matrix
   numberOfCenters = m_Centers.size();
 
@@ -271,22 +292,114 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateSolutionMatrixAndFunction
 
   m_Weights.resize(numberOfCenters);
 
-  PointType p1;
-  PointType p2;
-  double norm;
-
   for (unsigned int i = 0; i < numberOfCenters; i++)
   {
-    for (unsigned int j = 0; j < numberOfCenters; j++)
+    m_SolutionMatrix(i, i) = 0.0;
+
+    for (unsigned int j = i + 1; j < numberOfCenters; j++)
     {
-      // Calculate the RBF value. Currently using Phi(r) = r with r is the euclidian distance between two points
-      p1 = m_Centers.at(i);
-      p2 = m_Centers.at(j);
-      p1 = p1 - p2;
-      norm = p1.two_norm();
+      // Calculate the RBF value. Currently using Phi(r) = r with r is the euclidian distance between two points.
+      // The matrix is symmetric, so each value is calculated only once
+      double norm = (m_Centers[i] - m_Centers[j]).two_norm();
       m_SolutionMatrix(i, j) = norm;
+      m_SolutionMatrix(j, i) = norm;
+    }
+  }
+}
+
+unsigned int mitk::CreateDistanceImageFromSurfaceFilter::ArrangeCentersForIncrementalSolution()
+{
+  const std::size_t numberOfFactorizedCenters = m_FactorizedCenters.size();
+  const std::size_t numberOfCenters = m_Centers.size();
+
+  // Solving the new part of the system costs O(n^2 * m) for n factorized and m new centers, if there are
+  // many new centers a new factorization of the whole system pays off for the following updates
+  if (numberOfFactorizedCenters == 0 || numberOfCenters < numberOfFactorizedCenters ||
+      2 * (numberOfCenters - numberOfFactorizedCenters) > numberOfFactorizedCenters)
+  {
+    return 0;
+  }
+
+  std::map<PointType, std::size_t, PointLess> factorizedCenterIds;
+  for (std::size_t i = 0; i < numberOfFactorizedCenters; ++i)
+  {
+    factorizedCenterIds[m_FactorizedCenters[i]] = i;
+  }
+
+  // order[k] is the current position of the center that has to be at position k
+  std::vector<std::size_t> order(numberOfCenters, numberOfCenters);
+  std::size_t nextNewCenter = numberOfFactorizedCenters;
+
+  for (std::size_t i = 0; i < numberOfCenters; ++i)
+  {
+    auto it = factorizedCenterIds.find(m_Centers[i]);
+    if (it != factorizedCenterIds.end() && order[it->second] == numberOfCenters &&
+        m_FactorizedFunctionValues[it->second] == m_FunctionValues[i])
+    {
+      order[it->second] = i;
+    }
+    else if (nextNewCenter < numberOfCenters)
+    {
+      order[nextNewCenter++] = i;
+    }
+    else
+    {
+      // a center of the factorized system is missing, e.g. because a contour was changed or removed
+      return 0;
     }
   }
+
+  CenterList centers(numberOfCenters);
+  Eigen::VectorXd functionValues(numberOfCenters);
+  for (std::size_t k = 0; k < numberOfCenters; ++k)
+  {
+    centers[k] = m_Centers[order[k]];
+    functionValues[k] = m_FunctionValues[order[k]];
+  }
+  m_Centers.swap(centers);
+  m_FunctionValues.swap(functionValues);
+
+  return numberOfFactorizedCenters;
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::SolveEquationSystem()
+{
+  if (m_NumberOfFactorizedCenters == 0)
+  {
+    m_FactorizedSolutionMatrix.compute(m_SolutionMatrix);
+    m_FactorizedCenters = m_Centers;
+    m_FactorizedFunctionValues = m_FunctionValues;
+
+    m_Weights = m_FactorizedSolutionMatrix.solve(m_FunctionValues);
+    return;
+  }
+
+  // The system has the block structure [A B; B^T D] with the already factorized matrix A of the previous
+  // update. Its solution is obtained from A and the Schur complement S = D - B^T A^-1 B of the new centers.
+  const Eigen::Index numberOfFactorizedCenters = m_NumberOfFactorizedCenters;
+  const Eigen::Index numberOfNewCenters = m_SolutionMatrix.rows() - numberOfFactorizedCenters;
+
+  Eigen::VectorXd factorizedSolution =
+    m_FactorizedSolutionMatrix.solve(m_FunctionValues.head(numberOfFactorizedCenters));
+
+  if (numberOfNewCenters == 0)
+  {
+    m_Weights = factorizedSolution;
+    return;
+  }
+
+  const auto B = m_SolutionMatrix.topRightCorner(numberOfFactorizedCenters, numberOfNewCenters);
+  const auto D = m_SolutionMatrix.bottomRightCorner(numberOfNewCenters, numberOfNewCenters);
+
+  Eigen::MatrixXd inverseAB = m_FactorizedSolutionMatrix.solve(B);
+  Eigen::MatrixXd schurComplement = D - B.transpose() * inverseAB;
+
+  Eigen::VectorXd newWeights = schurComplement.partialPivLu().solve(m_FunctionValues.tail(numberOfNewCenters) -
+                                                                    B.transpose() * factorizedSolution);
+
+  m_Weights.resize(m_SolutionMatrix.rows());
+  m_Weights.head(numberOfFactorizedCenters) = factorizedSolution - inverseAB * newWeights;
+  m_Weights.tail(numberOfNewCenters) = newWeights;
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
@@ -295,17 +408,26 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   * Now we must calculate the distance for each pixel. But instead of calculating the distance value
   * for all of the image's pixels we proceed similar to the region growing algorithm:
   *
-  * 1. Take the first pixel from the narrowband_point_list and calculate the distance for each neighbor (6er)
-  * 2. If the current index's distance value is below a certain threshold push it into the list
-  * 3. Next iteration take the next index from the list and originAsIndex with 1. again
+  * 1. Collect the not yet visited neighbors (6er) of all pixels of the current narrowband front
+  * 2. Calculate the distance of all these neighbors in parallel
+  * 3. The neighbors whose distance value is below a certain threshold form the next front
   *
-  * This is done until the narrowband_point_list is empty.
+  * This is done until the front is empty.
   */
 
   typedef itk::ImageRegionIteratorWithIndex<DistanceImageType> ImageIterator;
-  typedef itk::NeighborhoodIterator<DistanceImageType> NeighborhoodImageIterator;
 
-  std::queue<DistanceImageType::IndexType> narrowbandPoints;
+  const unsigned int numberOfCenters = m_Centers.size();
+  m_CenterX.resize(numberOfCenters);
+  m_CenterY.resize(numberOfCenters);
+  m_CenterZ.resize(numberOfCenters);
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+  {
+    m_CenterX[i] = m_Centers[i][0];
+    m_CenterY[i] = m_Centers[i][1];
+    m_CenterZ[i] = m_Centers[i][2];
+  }
+
   PointType currentPoint = m_Centers.at(0);
   double distance = this->CalculateDistanceValue(currentPoint);
 
@@ -319,52 +441,71 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   DistanceImageType::IndexType currentIndex;
   m_DistanceImageITK->TransformPhysicalPointToIndex(currentPointAsPoint, currentIndex);
 
-  assert(
-    m_DistanceImageITK->GetLargestPossibleRegion().IsInside(currentIndex)); // we are quite certain this should hold
+  const DistanceImageType::RegionType region = m_DistanceImageITK->GetLargestPossibleRegion();
+  assert(region.IsInside(currentIndex)); // we are quite certain this should hold
+
+  // The region starts at index 0,0,0 (see CreateEmptyDistanceImage())
+  const DistanceImageType::SizeType regionSize = region.GetSize();
+  auto toOffset = [&regionSize](const DistanceImageType::IndexType &index) {
+    return (static_cast<std::size_t>(index[2]) * regionSize[1] + index[1]) * regionSize[0] + index[0];
+  };
+  std::vector<bool> isVisited(region.GetNumberOfPixels(), false);
 
-  narrowbandPoints.push(currentIndex);
+  std::vector<DistanceImageType::IndexType> narrowbandPoints(1, currentIndex);
+  std::vector<DistanceImageType::IndexType> neighbors;
+  isVisited[toOffset(currentIndex)] = true;
   m_DistanceImageITK->SetPixel(currentIndex, distance);
 
-  NeighborhoodImageIterator::RadiusType radius;
-  radius.Fill(1);
-  NeighborhoodImageIterator nIt(radius, m_DistanceImageITK, m_DistanceImageITK->GetLargestPossibleRegion());
-  unsigned int relativeNbIdx[] = {4, 10, 12, 14, 16, 22};
+  DistanceImageType::OffsetType neighborOffsets[6];
+  for (unsigned int i = 0; i < 6; ++i)
+  {
+    neighborOffsets[i].Fill(0);
+    neighborOffsets[i][i / 2] = (i % 2 == 0) ? -1 : 1;
+  }
 
-  bool isInBounds = false;
   while (!narrowbandPoints.empty())
   {
-    nIt.SetLocation(narrowbandPoints.front());
-    narrowbandPoints.pop();
+    neighbors.clear();
+    m_EvaluationPoints.clear();
 
-    unsigned int *relativeNb = &relativeNbIdx[0];
-    for (int i = 0; i < 6; i++)
+    for (const auto &narrowbandPoint : narrowbandPoints)
     {
-      nIt.GetPixel(*relativeNb, isInBounds);
-      if (isInBounds && nIt.GetPixel(*relativeNb) == m_DistanceImageDefaultBufferValue)
+      for (const auto &neighborOffset : neighborOffsets)
       {
-        currentIndex = nIt.GetIndex(*relativeNb);
+        currentIndex = narrowbandPoint + neighborOffset;
+        if (!region.IsInside(currentIndex) || isVisited[toOffset(currentIndex)])
+          continue;
+
+        isVisited[toOffset(currentIndex)] = true;
+        neighbors.push_back(currentIndex);
 
         // Transform the currently checked point from index-coordinates to
         // world-coordinates
         m_DistanceImageITK->TransformIndexToPhysicalPoint(currentIndex, currentPointAsPoint);
-
-        // create a vnl_vector
         currentPoint[0] = currentPointAsPoint[0];
         currentPoint[1] = currentPointAsPoint[1];
         currentPoint[2] = currentPointAsPoint[2];
+        m_EvaluationPoints.push_back(currentPoint);
+      }
+    }
 
-        // and check the distance
-        distance = this->CalculateDistanceValue(currentPoint);
-        if (std::fabs(distance) <= m_DistanceImageSpacing * 2)
-        {
-          nIt.SetPixel(*relativeNb, distance);
-          narrowbandPoints.push(currentIndex);
-        }
+    // and check the distances
+    this->EvaluateDistanceValues();
+
+    narrowbandPoints.clear();
+    for (std::size_t i = 0; i < neighbors.size(); ++i)
+    {
+      if (std::fabs(m_EvaluationValues[i]) <= m_DistanceImageSpacing * 2)
+      {
+        m_DistanceImageITK->SetPixel(neighbors[i], m_EvaluationValues[i]);
+        narrowbandPoints.push_back(neighbors[i]);
       }
-      relativeNb++;
     }
   }
 
+  m_EvaluationPoints.clear();
+  m_EvaluationValues.clear();
+
   ImageIterator imgRegionIterator(m_DistanceImageITK, m_DistanceImageITK->GetLargestPossibleRegion());
   imgRegionIterator.GoToBegin();
 
@@ -422,25 +563,48 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   CastToMitkImage(m_DistanceImageITK, resultImage);
 }
 
-double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(PointType p)
+double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(const PointType &p) const
+{
+  // Evaluating all centers at once allows Eigen to vectorize the calculation
+  return (((m_CenterX - p[0]).square() + (m_CenterY - p[1]).square() + (m_CenterZ - p[2]).square()).sqrt() *
+          m_Weights.array())
+    .sum();
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::EvaluateDistanceValues()
+{
+  m_EvaluationValues.resize(m_EvaluationPoints.size());
+
+  // Small fronts are not worth starting the threads
+  if (m_EvaluationPoints.size() * m_Centers.size() < 100000)
+  {
+    for (std::size_t i = 0; i < m_EvaluationPoints.size(); ++i)
+    {
+      m_EvaluationValues[i] = this->CalculateDistanceValue(m_EvaluationPoints[i]);
+    }
+    return;
+  }
+
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(EvaluateDistanceValuesThreaded, this);
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+ITK_THREAD_RETURN_TYPE mitk::CreateDistanceImageFromSurfaceFilter::EvaluateDistanceValuesThreaded(void *threadInfo)
 {
-  double distanceValue(0);
-  PointType p1;
-  PointType p2;
-  double norm;
+  auto *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(threadInfo);
+  auto *self = static_cast<CreateDistanceImageFromSurfaceFilter *>(info->UserData);
 
-  CenterList::iterator centerIter;
+  const std::size_t numberOfPoints = self->m_EvaluationPoints.size();
+  const std::size_t begin = numberOfPoints * info->ThreadID / info->NumberOfThreads;
+  const std::size_t end = numberOfPoints * (info->ThreadID + 1) / info->NumberOfThreads;
 
-  unsigned int count(0);
-  for (centerIter = m_Centers.begin(); centerIter != m_Centers.end(); centerIter++)
+  for (std::size_t i = begin; i < end; ++i)
   {
-    p1 = *centerIter;
-    p2 = p - p1;
-    norm = p2.two_norm();
-    distanceValue = distanceValue + (norm * m_Weights[count]);
-    ++count;
+    self->m_EvaluationValues[i] = self->CalculateDistanceValue(self->m_EvaluationPoints[i]);
   }
-  return distanceValue;
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::GenerateOutputInformation()
@@ -516,6 +680,11 @@ void mitk::CreateDistanceImageFromSurfaceFilter::RemoveInputs(mitk::Surface *inp
 
 void mitk::CreateDistanceImageFromSurfaceFilter::Reset()
 {
+  m_FactorizedCenters.clear();
+  m_FactorizedFunctionValues.resize(0);
+  m_FactorizedSolutionMatrix = Eigen::PartialPivLU<Eigen::MatrixXd>();
+  m_NumberOfFactorizedCenters = 0;
+
   for (unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); i++)
   {
     this->PopBackInput();
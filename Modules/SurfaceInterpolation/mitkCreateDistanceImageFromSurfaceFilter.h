@@ -26,6 +26,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/vnl_vector_fixed.h"
 
 #include "itkImageBase.h"
+#include "itkMultiThreader.h"
 
 #include <Eigen/Dense>
 
@@ -56,6 +57,12 @@ namespace mitk
          with the marching cubes algorithm. (Within the  distance image the surface goes exactly where the pixelvalues
   are zero)
 
+         The equation system is factorized once and kept by the filter. If the filter is updated again with
+  additional contours while all previous edge points stay the same (e.g. because a single contour was added in
+  the mitkSurfaceInterpolationController), only the system of the new points is solved via the Schur complement
+  of the factorized system. The distance image is filled in parallel, evaluating the whole narrow band front at
+  once.
+
          Note that the obtained distance image has always an isotropig spacing. The size (in this case volume) of the
   image can be
          adjusted by calling SetDistanceImageVolume(unsigned int volume) which specifies the number ob pixels enclosed
@@ -132,10 +139,30 @@ namespace mitk
 
   private:
     void CreateSolutionMatrixAndFunctionValues();
-    double CalculateDistanceValue(PointType p);
+    double CalculateDistanceValue(const PointType &p) const;
+
+    /**
+    * \brief Moves the centers of the factorized system of a previous update to the front of m_Centers.
+    *
+    * \return the number of centers of the factorized system or 0 if it cannot be reused because a center
+    * is missing or because the number of new centers is too large
+    */
+    unsigned int ArrangeCentersForIncrementalSolution();
+
+    /**
+    * \brief Calculates m_Weights, either from scratch or from the factorized system of a previous update
+    */
+    void SolveEquationSystem();
 
     void FillDistanceImage();
 
+    /**
+    * \brief Calculates the distance values of m_EvaluationPoints using the multi threader
+    */
+    void EvaluateDistanceValues();
+
+    static ITK_THREAD_RETURN_TYPE EvaluateDistanceValuesThreaded(void *threadInfo);
+
     /**
     * \brief This method fills the given variables with the minimum and
     * maximum coordinates that contain all input-points in index- and
@@ -166,6 +193,20 @@ namespace mitk
     Eigen::VectorXd m_FunctionValues;
     Eigen::VectorXd m_Weights;
 
+    // The coordinates of the centers in separate arrays for the vectorized evaluation of the distance function
+    Eigen::ArrayXd m_CenterX;
+    Eigen::ArrayXd m_CenterY;
+    Eigen::ArrayXd m_CenterZ;
+
+    std::vector<PointType> m_EvaluationPoints;
+    std::vector<double> m_EvaluationValues;
+
+    // The factorized equation system of a previous update, reused if only centers are added
+    CenterList m_FactorizedCenters;
+    Eigen::VectorXd m_FactorizedFunctionValues;
+    Eigen::PartialPivLU<Eigen::MatrixXd> m_FactorizedSolutionMatrix;
+    unsigned int m_NumberOfFactorizedCenters;
+
     DistanceImageType::Pointer m_DistanceImageITK;
     itk::ImageBase<3>::Pointer m_ReferenceImage;
 
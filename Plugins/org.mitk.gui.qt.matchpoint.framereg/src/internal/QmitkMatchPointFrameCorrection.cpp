@@ -45,6 +45,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <QErrorMessage>
 #include <QThreadPool>
 #include <QDateTime>
+#include <QThread>
+
+#include <algorithm>
 
 // MatchPoint
 #include <mapImageRegistrationAlgorithmInterface.h>
@@ -632,6 +635,11 @@ void QmitkMatchPointFrameCorrection::OnStartRegBtnPushed()
   pJob->m_TargetDataUID = mitk::EnsureUID(this->m_spSelectedTargetNode->GetData());
   pJob->m_IgnoreList = this->GenerateIgnoreList();
 
+  // further instances of the loaded algorithm allow to register several frames concurrently
+  ::map::deployment::DLLHandle::Pointer dllHandle = this->m_LoadedDLLHandle;
+  pJob->m_AlgorithmFactory = [dllHandle]() { return ::map::deployment::getRegistrationAlgorithm(dllHandle); };
+  pJob->m_MaxConcurrentRegistrations = std::max(1, QThread::idealThreadCount());
+
   if (m_spSelectedTargetMaskData.IsNotNull())
   {
     pJob->m_spTargetMask = m_spSelectedTargetMaskData;